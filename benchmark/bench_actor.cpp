@@ -6,6 +6,7 @@
 //
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
+#include "td/actor/MultiTimeout.h"
 #include "td/actor/PromiseFuture.h"
 
 #include "td/utils/benchmark.h"
@@ -73,6 +74,98 @@ class CreateActorBench final : public td::Benchmark {
   }
 };
 
+class MultiTimeoutBench final : public td::Benchmark {
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  td::unique_ptr<td::MultiTimeout> multi_timeout_;
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(0, 0);
+    scheduler_->start();
+    auto guard = scheduler_->get_main_guard();
+    multi_timeout_ = td::make_unique<td::MultiTimeout>("MultiTimeout");
+  }
+
+  void tear_down() final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      multi_timeout_.reset();
+    }
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ public:
+  td::string get_description() const final {
+    return "MultiTimeout set/cancel";
+  }
+
+  void run(int n) final {
+    auto guard = scheduler_->get_main_guard();
+    static constexpr int KEY_COUNT = 10000;
+    for (int i = 0; i < n; i += KEY_COUNT) {
+      for (td::int64 j = 0; j < KEY_COUNT; j++) {
+        multi_timeout_->set_timeout_in(j * 1000003, 100.0 + static_cast<double>(j * 7 % 1000));
+      }
+      for (td::int64 j = 0; j < KEY_COUNT; j++) {
+        multi_timeout_->cancel_timeout(j * 1000003);
+      }
+    }
+  }
+};
+
+class MailboxBench final : public td::Benchmark {
+  struct ReceiverActor final : public td::Actor {
+    int received_event_count_ = 0;
+
+    void on_event(int value) {
+      received_event_count_++;
+    }
+  };
+
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  td::ActorOwn<ReceiverActor> receiver_;
+  ReceiverActor *receiver_ptr_ = nullptr;
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(0, 0);
+    scheduler_->start();
+    auto guard = scheduler_->get_main_guard();
+    receiver_ = td::create_actor<ReceiverActor>("ReceiverActor");
+    receiver_ptr_ = receiver_.get_actor_unsafe();
+  }
+
+  void tear_down() final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      receiver_.reset();
+    }
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ public:
+  td::string get_description() const final {
+    return "Mailbox burst";
+  }
+
+  void run(int n) final {
+    // events are sent in bursts, so they are added to the mailbox of the receiver and processed later
+    static constexpr int BURST_SIZE = 1000;
+    for (int i = 0; i < n; i += BURST_SIZE) {
+      auto expected_event_count = receiver_ptr_->received_event_count_ + BURST_SIZE;
+      {
+        auto guard = scheduler_->get_main_guard();
+        for (int j = 0; j < BURST_SIZE; j++) {
+          td::send_closure_later(receiver_, &ReceiverActor::on_event, j);
+        }
+      }
+      while (receiver_ptr_->received_event_count_ < expected_event_count) {
+        scheduler_->run_main(0);
+      }
+    }
+  }
+};
+
 template <int type>
 class RingBench final : public td::Benchmark {
  public:
@@ -81,6 +174,7 @@ class RingBench final : public td::Benchmark {
  private:
   int actor_n_ = -1;
   int thread_n_ = -1;
+  double busy_poll_time_ = 0.0;
   td::vector<td::ActorId<PassActor>> actor_array_;
   td::unique_ptr<td::ConcurrentScheduler> scheduler_;
 
@@ -88,7 +182,8 @@ class RingBench final : public td::Benchmark {
   td::string get_description() const final {
     static const char *types[] = {"later", "immediate", "raw", "tail", "lambda"};
     static_assert(0 <= type && type < 5, "");
-    return PSTRING() << "Ring (send_" << types[type] << ") (threads_n = " << thread_n_ << ")";
+    return PSTRING() << "Ring (send_" << types[type] << ") (threads_n = " << thread_n_
+                     << ", busy_poll_time = " << busy_poll_time_ << ")";
   }
 
   struct PassActor final : public td::Actor {
@@ -137,11 +232,15 @@ class RingBench final : public td::Benchmark {
     }
   };
 
-  RingBench(int actor_n, int thread_n) : actor_n_(actor_n), thread_n_(thread_n) {
+  RingBench(int actor_n, int thread_n, double busy_poll_time = 0.0)
+      : actor_n_(actor_n), thread_n_(thread_n), busy_poll_time_(busy_poll_time) {
   }
 
   void start_up() final {
     scheduler_ = td::make_unique<td::ConcurrentScheduler>(thread_n_, 0);
+    if (busy_poll_time_ > 0.0) {
+      scheduler_->set_busy_poll_time(busy_poll_time_);
+    }
 
     actor_array_ = td::vector<td::ActorId<PassActor>>(actor_n_);
     for (int i = 0; i < actor_n_; i++) {
@@ -328,6 +427,8 @@ int main() {
   td::init_openssl_threads();
 
   bench(CreateActorBench());
+  bench(MultiTimeoutBench());
+  bench(MailboxBench());
   bench(RingBench<4>(504, 0));
   bench(RingBench<3>(504, 0));
   bench(RingBench<0>(504, 0));
@@ -346,4 +447,6 @@ int main() {
   bench(RingBench<0>(504, 2));
   bench(RingBench<1>(504, 2));
   bench(RingBench<2>(504, 2));
+  bench(RingBench<1>(2, 2));
+  bench(RingBench<1>(2, 2, 1e-4));
 }
@@ -0,0 +1,155 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/Client.h"
+#include "td/telegram/td_api.h"
+
+#include "td/utils/common.h"
+#include "td/utils/filesystem.h"
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/Stat.h"
+#include "td/utils/Slice.h"
+#include "td/utils/StringBuilder.h"
+#include "td/utils/Time.h"
+
+#include <algorithm>
+#include <map>
+
+// measures scaling of ClientManager with the number of clients; clients aren't initialized, so no network is used,
+// but all requests pass through MultiImpl sharding, Td instances and the response fan-in
+class ClientManagerBench {
+ public:
+  explicit ClientManagerBench(int client_count) : client_count_(client_count) {
+  }
+
+  void run(int wave_count) {
+    auto memory_before = get_resident_size();
+    auto start_time = td::Time::now();
+    for (int i = 0; i < client_count_; i++) {
+      client_ids_.push_back(client_manager_.create_client_id());
+    }
+    // the first request to a client creates its Td instance
+    run_wave(0);
+    auto creation_time = td::Time::now() - start_time;
+    auto memory_after = get_resident_size();
+
+    latencies_.clear();
+    start_time = td::Time::now();
+    for (int i = 1; i <= wave_count; i++) {
+      run_wave(i);
+    }
+    auto passed_time = td::max(td::Time::now() - start_time, 1e-9);
+
+    std::sort(latencies_.begin(), latencies_.end());
+    auto get_percentile = [&](size_t percent) {
+      return td::StringBuilder::FixedDouble(latencies_[(latencies_.size() - 1) * percent / 100] * 1e3, 3);
+    };
+    auto memory_per_client = (memory_after - td::min(memory_before, memory_after)) / client_count_;
+    LOG(PLAIN) << td::tag("clients", client_count_) << td::tag("threads", get_thread_count())
+               << td::tag("creation_time", td::format::as_time(creation_time))
+               << td::tag("memory_per_client", td::format::as_size(memory_per_client))
+               << td::tag("requests_per_second",
+                          td::StringBuilder::FixedDouble(static_cast<double>(latencies_.size()) / passed_time, 0))
+               << " latency p50 = " << get_percentile(50) << "ms, p99 = " << get_percentile(99) << "ms";
+
+    close_clients();
+  }
+
+ private:
+  int client_count_;
+  td::ClientManager client_manager_;
+  td::vector<td::ClientManager::ClientId> client_ids_;
+  td::ClientManager::RequestId last_request_id_ = 0;
+  std::map<td::ClientManager::RequestId, double> request_send_times_;
+  td::vector<double> latencies_;
+
+  static td::uint64 get_resident_size() {
+    auto r_mem_stat = td::mem_stat();
+    return r_mem_stat.is_ok() ? r_mem_stat.ok().resident_size_ : 0;
+  }
+
+  static td::int32 get_thread_count() {
+    auto r_status = td::read_file_str("/proc/self/status");
+    if (r_status.is_error()) {
+      return 0;
+    }
+    for (auto line : td::full_split(td::Slice(r_status.ok()), '\n')) {
+      if (td::begins_with(line, "Threads:")) {
+        return td::to_integer<td::int32>(td::trim(line.substr(8)));
+      }
+    }
+    return 0;
+  }
+
+  static td::td_api::object_ptr<td::td_api::Function> get_request(int index) {
+    switch (index % 4) {
+      case 0:
+        return td::td_api::make_object<td::td_api::testSquareInt>(index);
+      case 1:
+        return td::td_api::make_object<td::td_api::testCallString>("test");
+      case 2:
+        return td::td_api::make_object<td::td_api::testCallVectorInt>(td::vector<td::int32>{1, 2, 3});
+      default:
+        return td::td_api::make_object<td::td_api::getOption>("version");
+    }
+  }
+
+  // sends a request to every client and waits for all responses
+  void run_wave(int wave) {
+    for (int i = 0; i < client_count_; i++) {
+      auto request_id = ++last_request_id_;
+      request_send_times_[request_id] = td::Time::now();
+      client_manager_.send(client_ids_[i], request_id, get_request(wave + i));
+    }
+    while (!request_send_times_.empty()) {
+      auto response = client_manager_.receive(10.0);
+      LOG_CHECK(response.object != nullptr) << "Receive timeout expired";
+      if (response.request_id == 0) {
+        continue;
+      }
+      LOG_CHECK(response.object->get_id() != td::td_api::error::ID) << td::td_api::to_string(response.object);
+      auto it = request_send_times_.find(response.request_id);
+      CHECK(it != request_send_times_.end());
+      latencies_.push_back(td::Time::now() - it->second);
+      request_send_times_.erase(it);
+    }
+  }
+
+  void close_clients() {
+    for (auto client_id : client_ids_) {
+      client_manager_.send(client_id, ++last_request_id_, td::td_api::make_object<td::td_api::close>());
+    }
+    size_t closed_count = 0;
+    while (closed_count < client_ids_.size()) {
+      auto response = client_manager_.receive(10.0);
+      LOG_CHECK(response.object != nullptr) << "Receive timeout expired";
+      if (response.request_id == 0 && response.object->get_id() == td::td_api::updateAuthorizationState::ID &&
+          static_cast<const td::td_api::updateAuthorizationState &>(*response.object).authorization_state_->get_id() ==
+              td::td_api::authorizationStateClosed::ID) {
+        closed_count++;
+      }
+    }
+  }
+};
+
+int main(int argc, char *argv[]) {
+  td::ClientManager::execute(td::td_api::make_object<td::td_api::setLogVerbosityLevel>(0));
+
+  int max_client_count = 10000;
+  int wave_count = 20;
+  if (argc > 1) {
+    max_client_count = td::max(td::to_integer<int>(td::Slice(argv[1])), 1);
+  }
+  if (argc > 2) {
+    wave_count = td::max(td::to_integer<int>(td::Slice(argv[2])), 1);
+  }
+
+  for (int client_count = 1; client_count <= max_client_count; client_count *= 10) {
+    ClientManagerBench(client_count).run(wave_count);
+  }
+}
@@ -233,6 +233,37 @@ class AesIgeDecryptBench final : public td::Benchmark {
   }
 };
 
+template <std::size_t LANE_COUNT>
+class AesIgeDecryptMultiBench final : public td::Benchmark {
+ public:
+  alignas(64) unsigned char data[LANE_COUNT][DATA_SIZE];
+  td::UInt256 keys[LANE_COUNT];
+  td::UInt256 ivs[LANE_COUNT];
+  std::vector<td::AesIgeDecryptionQuery> queries;
+
+  std::string get_description() const final {
+    return PSTRING() << "AES IGE decrypt " << LANE_COUNT << " lanes [" << LANE_COUNT << "x" << (DATA_SIZE >> 10)
+                     << "KB]";
+  }
+
+  void start_up() final {
+    queries.clear();
+    for (std::size_t i = 0; i < LANE_COUNT; i++) {
+      std::fill(std::begin(data[i]), std::end(data[i]), static_cast<unsigned char>(123));
+      td::Random::secure_bytes(keys[i].raw, sizeof(keys[i]));
+      td::Random::secure_bytes(ivs[i].raw, sizeof(ivs[i]));
+      td::MutableSlice data_slice(data[i], DATA_SIZE);
+      queries.push_back({as_slice(keys[i]), as_mutable_slice(ivs[i]), data_slice, data_slice});
+    }
+  }
+
+  void run(int n) final {
+    for (int i = 0; i < n; i++) {
+      td::aes_ige_decrypt_multi(queries);
+    }
+  }
+};
+
 class AesCtrBench final : public td::Benchmark {
  public:
   alignas(64) unsigned char data[DATA_SIZE];
@@ -501,6 +532,9 @@ int main() {
   td::bench(AesIgeShortBench<false>());
   td::bench(AesIgeEncryptBench());
   td::bench(AesIgeDecryptBench());
+  td::bench(AesIgeDecryptMultiBench<1>());
+  td::bench(AesIgeDecryptMultiBench<4>());
+  td::bench(AesIgeDecryptMultiBench<8>());
   td::bench(AesEcbBench());
 
   td::bench(Pbkdf2Bench());
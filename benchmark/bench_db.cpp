@@ -13,6 +13,7 @@
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteKeyValueAsync.h"
 #include "td/db/SqliteKeyValueSafe.h"
+#include "td/db/TQueue.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
@@ -21,7 +22,9 @@
 #include "td/utils/common.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 
@@ -230,8 +233,56 @@ class BinlogKeyValueBench final : public td::Benchmark {
   }
 };
 
+class TQueueBench final : public td::Benchmark {
+ public:
+  TQueueBench(bool use_ring_buffers, int queue_count, int unconfirmed_count)
+      : use_ring_buffers_(use_ring_buffers), queue_count_(queue_count), unconfirmed_count_(unconfirmed_count) {
+  }
+
+ private:
+  td::string get_description() const final {
+    return PSTRING() << "TQueue " << td::tag("use_ring_buffers", use_ring_buffers_) << td::tag("queues", queue_count_)
+                     << td::tag("unconfirmed", unconfirmed_count_);
+  }
+
+  bool use_ring_buffers_;
+  int queue_count_;
+  int unconfirmed_count_;
+  td::unique_ptr<td::TQueue> tqueue_;
+
+  void start_up() final {
+    tqueue_ = td::TQueue::create(use_ring_buffers_);
+  }
+  void run(int n) final {
+    td::TQueue::Event events[10];
+    for (int i = 0; i < n; i++) {
+      auto queue_id = i % queue_count_ + 1;
+      auto event_id = tqueue_->push(queue_id, "data", 1 << 30, 0, td::TQueue::EventId()).move_as_ok();
+      if (i % 3 == 0) {
+        // receive some events, confirming all events except the last unconfirmed_count_
+        auto head_id = tqueue_->get_head(queue_id);
+        auto from_id =
+            td::TQueue::EventId::from_int32(td::max(head_id.value(), event_id.value() - unconfirmed_count_)).move_as_ok();
+        td::MutableSpan<td::TQueue::Event> span(events, 10);
+        tqueue_->get(queue_id, from_id, true, 0, span).ensure();
+      }
+      if (i % 100000 == 99999) {
+        tqueue_->clear(queue_id, unconfirmed_count_ / 2);
+      }
+    }
+  }
+  void tear_down() final {
+    tqueue_ = nullptr;
+  }
+};
+
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(WARNING));
+  for (auto use_ring_buffers : {false, true}) {
+    bench(TQueueBench(use_ring_buffers, 100000, 5));
+    bench(TQueueBench(use_ring_buffers, 100, 1000));
+  }
+
   bench(TdKvBench<td::BinlogKeyValue<td::Binlog>>("BinlogKeyValue<Binlog>"));
   bench(TdKvBench<td::BinlogKeyValue<td::ConcurrentBinlog>>("BinlogKeyValue<ConcurrentBinlog>"));
 
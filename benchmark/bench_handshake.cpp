@@ -6,12 +6,21 @@
 //
 #include "td/mtproto/DhCallback.h"
 #include "td/mtproto/DhHandshake.h"
+#include "td/mtproto/RSA.h"
 
 #include "td/utils/base64.h"
 #include "td/utils/benchmark.h"
 #include "td/utils/common.h"
+#include "td/utils/crypto.h"
+#include "td/utils/logging.h"
+#include "td/utils/Random.h"
 #include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
 
+#include <openssl/opensslv.h>
+
+#include <algorithm>
+#include <limits>
 #include <map>
 
 #if TD_LINUX || TD_ANDROID || TD_TIZEN
@@ -25,28 +34,177 @@ static td::string prime_base64 =
     "WC2xF40WnGvEZbDW_5yjko_vW5rk5Bj8Feg-vqD4f6n_Xu1wBQ3tKEn0e_lZ2VaFDOkphR8NgRX2NbEF7i5OFdBLJFS_b0-t8DSxBAMRnNjjuS_MW"
     "w";
 
-class HandshakeBench final : public td::Benchmark {
+static td::Slice rsa_public_key_pem =
+    "-----BEGIN RSA PUBLIC KEY-----\n"
+    "MIIBCgKCAQEAyMEdY1aR+sCR3ZSJrtztKTKqigvO/vBfqACJLZtS7QMgCGXJ6XIR\n"
+    "yy7mx66W0/sOFa7/1mAZtEoIokDP3ShoqF4fVNb6XeqgQfaUHd8wJpDWHcR2OFwv\n"
+    "plUUI1PLTktZ9uW2WE23b+ixNwJjJGwBDJPQEQFBE+vfmH0JP503wr5INS1poWg/\n"
+    "j25sIWeYPHYeOrFp/eXaqhISP6G+q2IeTaWTXpwZj4LzXq5YOpk4bYEQ6mvRq7D1\n"
+    "aHWfYmlEGepfaYR8Q0YqvvhYtMte3ITnuSJs171+GDqpdKcSwHnd6FudwGO4pcCO\n"
+    "j4WcDuXc2CTHgH8gFTNhp/Y8/SpDOhvn9QIDAQAB\n"
+    "-----END RSA PUBLIC KEY-----";
+
+class FakeDhCallback final : public td::mtproto::DhCallback {
+ public:
+  explicit FakeDhCallback(bool use_cache = true) : use_cache_(use_cache) {
+  }
+  int is_good_prime(td::Slice prime_str) const final {
+    auto it = cache_.find(prime_str.str());
+    if (it == cache_.end()) {
+      return -1;
+    }
+    return it->second;
+  }
+  void add_good_prime(td::Slice prime_str) const final {
+    if (use_cache_) {
+      cache_[prime_str.str()] = 1;
+    }
+  }
+  void add_bad_prime(td::Slice prime_str) const final {
+    if (use_cache_) {
+      cache_[prime_str.str()] = 0;
+    }
+  }
+
+ private:
+  bool use_cache_;
+  mutable std::map<td::string, int> cache_;
+};
+
+static td::string to_binary(td::uint64 x) {
+  td::string result;
+  do {
+    result = static_cast<char>(x & 255) + result;
+    x >>= 8;
+  } while (x > 0);
+  return result;
+}
+
+static bool is_prime(td::uint64 x) {
+  for (td::uint64 d = 2; d * d <= x; d++) {
+    if (x % d == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// step 1: factorization of pq, which is a product of two primes below 2^31 like the ones sent by servers
+class PqFactorizeBench final : public td::Benchmark {
+  td::vector<td::string> pqs_;
+
   td::string get_description() const final {
-    return "Handshake";
+    return "Handshake step 1: pq_factorize";
   }
 
-  class FakeDhCallback final : public td::mtproto::DhCallback {
-   public:
-    int is_good_prime(td::Slice prime_str) const final {
-      auto it = cache.find(prime_str.str());
-      if (it == cache.end()) {
-        return -1;
+  void start_up() final {
+    auto random_prime = [] {
+      while (true) {
+        auto x = static_cast<td::uint64>(td::Random::fast(1 << 30, std::numeric_limits<td::int32>::max()));
+        if (is_prime(x)) {
+          return x;
+        }
       }
-      return it->second;
+    };
+    pqs_.clear();
+    for (int i = 0; i < 64; i++) {
+      pqs_.push_back(to_binary(random_prime() * random_prime()));
     }
-    void add_good_prime(td::Slice prime_str) const final {
-      cache[prime_str.str()] = 1;
+  }
+
+  void run(int n) final {
+    td::string p;
+    td::string q;
+    for (int i = 0; i < n; i++) {
+      CHECK(td::pq_factorize(pqs_[i % pqs_.size()], &p, &q) == 0);
     }
-    void add_bad_prime(td::Slice prime_str) const final {
-      cache[prime_str.str()] = 0;
+  }
+};
+
+// step 1: RSA_PAD encryption of p_q_inner_data with the server public key
+class RsaEncryptBench final : public td::Benchmark {
+  td::string get_description() const final {
+    return "Handshake step 1: RSA_PAD";
+  }
+
+  void run(int n) final {
+    auto rsa = td::mtproto::RSA::from_pem_public_key(rsa_public_key_pem).move_as_ok();
+    td::string data(192, '\0');
+    td::string encrypted_data(256, '\0');
+    for (int i = 0; i < n; i++) {
+      td::Random::secure_bytes(data);
+      while (true) {
+        td::string aes_key(32, '\0');
+        td::Random::secure_bytes(aes_key);
+
+        td::string data_with_hash = PSTRING() << data << td::sha256(aes_key + data);
+        std::reverse(data_with_hash.begin(), data_with_hash.begin() + data.size());
+
+        td::string decrypted_data(256, '\0');
+        td::string aes_iv(32, '\0');
+        td::aes_ige_encrypt(aes_key, aes_iv, data_with_hash, td::MutableSlice(decrypted_data).substr(32));
+
+        auto hash = td::sha256(td::MutableSlice(decrypted_data).substr(32));
+        for (size_t j = 0; j < 32; j++) {
+          decrypted_data[j] = static_cast<char>(aes_key[j] ^ hash[j]);
+        }
+
+        if (rsa.encrypt(decrypted_data, encrypted_data)) {
+          break;
+        }
+      }
+    }
+  }
+};
+
+// step 2: check of the DH prime received from the server; the result is usually cached in DhCache
+template <bool use_cache>
+class DhCheckConfigBench final : public td::Benchmark {
+  td::string get_description() const final {
+    return PSTRING() << "Handshake step 2: DhHandshake::check_config " << (use_cache ? "cached" : "uncached");
+  }
+
+  void run(int n) final {
+    FakeDhCallback dh_callback(use_cache);
+    auto prime = td::base64url_decode(prime_base64).move_as_ok();
+    for (int i = 0; i < n; i++) {
+      td::mtproto::DhHandshake::check_config(g, prime, &dh_callback).ensure();
     }
-    mutable std::map<td::string, int> cache;
-  } dh_callback;
+  }
+};
+
+// step 2: client part of the DH exchange: generation of b and g_b, checks of g_a and computation of the auth key
+class DhClientBench final : public td::Benchmark {
+  td::string get_description() const final {
+    return "Handshake step 2: DH g_b, run_checks and gen_key";
+  }
+
+  void run(int n) final {
+    FakeDhCallback dh_callback;
+    auto prime = td::base64url_decode(prime_base64).move_as_ok();
+    td::mtproto::DhHandshake::check_config(g, prime, &dh_callback).ensure();
+    td::mtproto::DhHandshake server;
+    server.set_config(g, prime);
+    auto g_a = server.get_g_b();
+    for (int i = 0; i < n; i++) {
+      td::mtproto::DhHandshake client;
+      client.set_config(g, prime);
+      client.set_g_a(g_a);
+      client.run_checks(true, &dh_callback).ensure();
+      auto g_b = client.get_g_b();
+      CHECK(!g_b.empty());
+      auto key = client.gen_key();
+      CHECK(key.second.size() == 256);
+    }
+  }
+};
+
+class HandshakeBench final : public td::Benchmark {
+  td::string get_description() const final {
+    return "Handshake";
+  }
+
+  FakeDhCallback dh_callback;
 
   void run(int n) final {
     td::mtproto::DhHandshake a;
@@ -68,5 +226,11 @@ class HandshakeBench final : public td::Benchmark {
 };
 
 int main() {
+  LOG(PLAIN) << "Using " << OPENSSL_VERSION_TEXT;
+  td::bench(PqFactorizeBench());
+  td::bench(RsaEncryptBench());
+  td::bench(DhCheckConfigBench<false>());
+  td::bench(DhCheckConfigBench<true>());
+  td::bench(DhClientBench());
   td::bench(HandshakeBench());
 }
@@ -14,11 +14,15 @@
 
 #include "td/utils/buffer.h"
 #include "td/utils/BufferedFd.h"
+#include "td/utils/common.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/port/SocketFd.h"
 #include "td/utils/Slice.h"
 
-static int cnt = 0;
+#include <atomic>
+
+static std::atomic<td::uint64> query_count{0};
 
 class HelloWorld final : public td::HttpInboundConnection::Callback {
  public:
@@ -38,29 +42,38 @@ class HelloWorld final : public td::HttpInboundConnection::Callback {
     LOG_IF(FATAL, res.is_error()) << res.error();
     send_closure(connection, &td::HttpInboundConnection::write_next, td::BufferSlice(res.ok()));
     send_closure(connection.release(), &td::HttpInboundConnection::write_ok);
+    query_count.fetch_add(1, std::memory_order_relaxed);
   }
   void hangup() final {
-    LOG(ERROR) << "CLOSE " << cnt--;
     stop();
   }
 };
 
-const int N = 0;
+// each scheduler has its own listener on the same port and handles accepted connections itself;
+// the kernel balances incoming connections between the listeners because of SO_REUSEPORT
 class Server final : public td::TcpListener::Callback {
  public:
+  explicit Server(bool print_stats) : print_stats_(print_stats) {
+  }
+
   void start_up() final {
     listener_ =
         td::create_actor<td::TcpListener>("Listener", 8082, td::ActorOwn<td::TcpListener::Callback>(actor_id(this)));
+    if (print_stats_) {
+      set_timeout_in(1.0);
+    }
   }
   void accept(td::SocketFd fd) final {
-    LOG(ERROR) << "ACCEPT " << cnt++;
-    pos_++;
-    auto scheduler_id = pos_ % (N != 0 ? N : 1) + (N != 0);
-    td::create_actor_on_scheduler<td::HttpInboundConnection>(
-        "HttpInboundConnection", scheduler_id, td::BufferedFd<td::SocketFd>(std::move(fd)), 1024 * 1024, 0, 0,
-        td::create_actor_on_scheduler<HelloWorld>("HelloWorld", scheduler_id))
+    td::create_actor<td::HttpInboundConnection>("HttpInboundConnection", td::BufferedFd<td::SocketFd>(std::move(fd)),
+                                                1024 * 1024, 0, 0, td::create_actor<HelloWorld>("HelloWorld"))
         .release();
   }
+  void timeout_expired() final {
+    auto count = query_count.load(std::memory_order_relaxed);
+    LOG(ERROR) << "Handled " << count - last_query_count_ << " queries per second";
+    last_query_count_ = count;
+    set_timeout_in(1.0);
+  }
   void hangup() final {
     // may be it should be default?..
     LOG(ERROR) << "Hanging up..";
@@ -69,13 +82,18 @@ class Server final : public td::TcpListener::Callback {
 
  private:
   td::ActorOwn<td::TcpListener> listener_;
-  int pos_{0};
+  bool print_stats_;
+  td::uint64 last_query_count_ = 0;
 };
 
-int main() {
+int main(int argc, char *argv[]) {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
-  auto scheduler = td::make_unique<td::ConcurrentScheduler>(N, 0);
-  scheduler->create_actor_unsafe<Server>(0, "Server").release();
+  // compare the throughput with 1, 4 and 16 threads under the same external load, for example, from wrk
+  auto thread_count = td::clamp(argc > 1 ? td::to_integer<int>(td::Slice(argv[1])) : 1, 1, 64);
+  auto scheduler = td::make_unique<td::ConcurrentScheduler>(thread_count - 1, 0);
+  for (int i = 0; i < thread_count; i++) {
+    scheduler->create_actor_unsafe<Server>(i, "Server", i == 0).release();
+  }
   scheduler->start();
   while (scheduler->run_main(10)) {
     // empty
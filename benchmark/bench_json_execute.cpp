@@ -0,0 +1,86 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/Client.h"
+#include "td/telegram/td_api.h"
+#include "td/telegram/td_json_client.h"
+
+#include "td/utils/benchmark.h"
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/SliceBuilder.h"
+
+#include <cstring>
+#include <utility>
+
+class JsonExecuteBench final : public td::Benchmark {
+  td::string name_;
+  td::string request_;
+  int thread_count_;
+
+ public:
+  JsonExecuteBench(td::string name, td::string request, int thread_count)
+      : name_(std::move(name)), request_(std::move(request)), thread_count_(thread_count) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "td_execute " << name_ << " with " << thread_count_ << " threads";
+  }
+
+  void run(int n) final {
+    td::vector<td::thread> threads;
+    for (int i = 0; i < thread_count_; i++) {
+      threads.emplace_back([&] {
+        for (int j = 0; j < n; j++) {
+          auto result = td_execute(request_.c_str());
+          CHECK(result != nullptr && std::strncmp(result, "{\"@type\":\"error\"", 16) != 0);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+};
+
+class ObjectExecuteBench final : public td::Benchmark {
+ public:
+  td::string get_description() const final {
+    return "ClientManager::execute parseTextEntities";
+  }
+
+  void run(int n) final {
+    for (int i = 0; i < n; i++) {
+      auto parse_mode = td::td_api::make_object<td::td_api::textParseModeMarkdown>(2);
+      auto result = td::ClientManager::execute(td::td_api::make_object<td::td_api::parseTextEntities>(
+          "*bold* _italic_ `code` [link](https://telegram.org)", std::move(parse_mode)));
+      CHECK(result->get_id() == td::td_api::formattedText::ID);
+    }
+  }
+};
+
+int main() {
+  td::ClientManager::execute(td::td_api::make_object<td::td_api::setLogVerbosityLevel>(0));
+
+  const td::string parse_text_entities =
+      "{\"@type\":\"parseTextEntities\",\"text\":\"*bold* _italic_ `code` [link](https://telegram.org)\","
+      "\"parse_mode\":{\"@type\":\"textParseModeMarkdown\",\"version\":2}}";
+  const td::string get_markdown_text =
+      "{\"@type\":\"getMarkdownText\",\"text\":{\"@type\":\"formattedText\",\"text\":\"bold italic\",\"entities\":["
+      "{\"@type\":\"textEntity\",\"offset\":0,\"length\":4,\"type\":{\"@type\":\"textEntityTypeBold\"}},"
+      "{\"@type\":\"textEntity\",\"offset\":5,\"length\":6,\"type\":{\"@type\":\"textEntityTypeItalic\"}}]}}";
+  const td::string get_json_value =
+      "{\"@type\":\"getJsonValue\",\"json\":\"{\\\"a\\\":[1,2,3],\\\"b\\\":{\\\"c\\\":\\\"d\\\"},\\\"e\\\":true}\","
+      "\"@extra\":42}";
+
+  for (int thread_count : {1, 4}) {
+    td::bench(JsonExecuteBench("parseTextEntities", parse_text_entities, thread_count));
+    td::bench(JsonExecuteBench("getMarkdownText", get_markdown_text, thread_count));
+    td::bench(JsonExecuteBench("getJsonValue", get_json_value, thread_count));
+  }
+  td::bench(ObjectExecuteBench());
+}
@@ -4,13 +4,18 @@
 // Distributed under the Boost Software License, Version 1.0. (See accompanying
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
+#include "td/utils/AsyncFileLog.h"
 #include "td/utils/benchmark.h"
 #include "td/utils/common.h"
+#include "td/utils/FileLog.h"
 #include "td/utils/logging.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/TsFileLog.h"
 
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <ostream>
 #include <streambuf>
 #include <string>
@@ -150,8 +155,76 @@ class LogWriteBench final : public td::Benchmark {
   }
 };
 
+// writes log lines from a separate td::thread, which has a thread identifier like threads of td::Scheduler
+class LogInterfaceWriteBench final : public td::Benchmark {
+ public:
+  enum class Type : td::int32 { File, TsFile, AsyncFile };
+
+  explicit LogInterfaceWriteBench(Type type) : type_(type) {
+  }
+
+  std::string get_description() const final {
+    switch (type_) {
+      case Type::File:
+        return "FileLog";
+      case Type::TsFile:
+        return "TsFileLog";
+      case Type::AsyncFile:
+        return "AsyncFileLog";
+      default:
+        UNREACHABLE();
+        return std::string();
+    }
+  }
+
+  void start_up() final {
+    auto file_name = create_tmp_file();
+    switch (type_) {
+      case Type::File:
+        log_ = td::FileLog::create(file_name, std::numeric_limits<td::int64>::max(), false).move_as_ok();
+        break;
+      case Type::TsFile:
+        log_ = td::TsFileLog::create(file_name, std::numeric_limits<td::int64>::max(), false).move_as_ok();
+        break;
+      case Type::AsyncFile: {
+        auto log = td::make_unique<td::AsyncFileLog>();
+        log->init(file_name, std::numeric_limits<td::int64>::max(), false).ensure();
+        log_ = std::move(log);
+        break;
+      }
+      default:
+        UNREACHABLE();
+    }
+  }
+
+  void run(int n) final {
+    td::thread thread([&] {
+      for (int i = 0; i < n; i++) {
+        log_->append(VERBOSITY_NAME(DEBUG),
+                     "[ 4][t 1][1700000000.123456789][MessagesManager.cpp:12345][#1][!Td]\tThis is just for test\n");
+      }
+    });
+    thread.join();
+  }
+
+  void tear_down() final {
+    auto file_paths = log_->get_file_paths();
+    log_.reset();
+    for (auto &file_path : file_paths) {
+      unlink(file_path.c_str());
+    }
+  }
+
+ private:
+  Type type_;
+  td::unique_ptr<td::LogInterface> log_;
+};
+
 int main() {
   td::bench(LogWriteBench());
+  td::bench(LogInterfaceWriteBench(LogInterfaceWriteBench::Type::File));
+  td::bench(LogInterfaceWriteBench(LogInterfaceWriteBench::Type::TsFile));
+  td::bench(LogInterfaceWriteBench(LogInterfaceWriteBench::Type::AsyncFile));
 #if TD_ANDROID
   td::bench(ALogWriteBench());
 #endif
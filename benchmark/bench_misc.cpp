@@ -4,13 +4,22 @@
 // Distributed under the Boost Software License, Version 1.0. (See accompanying
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
+#include "td/telegram/files/FileLocation.h"
+#include "td/telegram/files/FileType.h"
+#include "td/telegram/MessageEntity.h"
+#include "td/telegram/MessageId.h"
+#include "td/telegram/OrderedMessage.h"
+#include "td/telegram/ServerMessageId.h"
 #include "td/telegram/td_api.h"
 #include "td/telegram/telegram_api.h"
 #include "td/telegram/telegram_api.hpp"
 
 #include "td/utils/algorithm.h"
 #include "td/utils/benchmark.h"
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
+#include "td/utils/Hints.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/Clocks.h"
 #include "td/utils/port/EventFd.h"
@@ -26,6 +35,9 @@
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/ThreadSafeCounter.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/tl_storers.h"
+#include "td/utils/utf8.h"
 
 #if !TD_WINDOWS
 #include <unistd.h>
@@ -40,6 +52,7 @@
 #include <array>
 #include <atomic>
 #include <cstdint>
+#include <map>
 #include <set>
 
 class F {
@@ -65,6 +78,83 @@ BENCH(TlCall, "TL Call") {
   td::do_not_optimize_away(res);
 }
 
+class TlParseMessagesBench final : public td::Benchmark {
+  static constexpr td::int32 MESSAGE_COUNT = 100;
+  static constexpr td::int32 USER_COUNT = 10;
+  static constexpr td::int32 VECTOR_ID = 0x1cb5c415;
+
+  td::BufferSlice serialized_;
+
+  template <class StorerT>
+  static void store_messages(StorerT &storer) {
+    using namespace td::telegram_api;
+    storer.store_int(messages_messages::ID);
+    storer.store_int(VECTOR_ID);
+    storer.store_int(MESSAGE_COUNT);
+    for (td::int32 i = 0; i < MESSAGE_COUNT; i++) {
+      storer.store_int(message::ID);
+      storer.store_int((1 << 7) | (1 << 8) | (1 << 10));  // entities, from_id, views and forwards
+      storer.store_int(0);
+      storer.store_int(i + 1);
+      storer.store_int(peerUser::ID);
+      storer.store_long(i % USER_COUNT + 1);
+      storer.store_int(peerUser::ID);
+      storer.store_long(USER_COUNT + 1);
+      storer.store_int(1700000000 + i);
+      storer.store_string(td::Slice("Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor"));
+      storer.store_int(VECTOR_ID);
+      storer.store_int(2);
+      for (td::int32 j = 0; j < 2; j++) {
+        storer.store_int(messageEntityBold::ID);
+        storer.store_int(j * 6);
+        storer.store_int(5);
+      }
+      storer.store_int(i);
+      storer.store_int(0);
+    }
+    storer.store_int(VECTOR_ID);
+    storer.store_int(0);
+    storer.store_int(VECTOR_ID);
+    storer.store_int(USER_COUNT);
+    for (td::int32 i = 0; i < USER_COUNT; i++) {
+      storer.store_int(user::ID);
+      storer.store_int((1 << 0) | (1 << 1) | (1 << 2) | (1 << 6));  // access_hash, first_name, last_name, status
+      storer.store_int(0);
+      storer.store_long(i + 1);
+      storer.store_long(i * 1000000007ll);
+      storer.store_string(td::Slice("First name"));
+      storer.store_string(td::Slice("Last name"));
+      storer.store_int(userStatusRecently::ID);
+      storer.store_int(0);
+    }
+  }
+
+ public:
+  td::string get_description() const final {
+    return PSTRING() << "Parse messages.messages with " << MESSAGE_COUNT << " messages";
+  }
+
+  void start_up() final {
+    td::TlStorerCalcLength storer_calc_length;
+    store_messages(storer_calc_length);
+    serialized_ = td::BufferSlice(storer_calc_length.get_length());
+    td::TlStorerUnsafe storer_unsafe(serialized_.as_mutable_slice().ubegin());
+    store_messages(storer_unsafe);
+  }
+
+  void run(int n) final {
+    size_t result = 0;
+    for (int i = 0; i < n; i++) {
+      td::TlBufferParser parser(&serialized_);
+      auto messages = td::telegram_api::messages_Messages::fetch(parser);
+      parser.fetch_end();
+      CHECK(parser.get_error() == nullptr);
+      result += static_cast<const td::telegram_api::messages_messages *>(messages.get())->messages_.size();
+    }
+    td::do_not_optimize_away(result);
+  }
+};
+
 static td::td_api::object_ptr<td::td_api::file> get_file_object() {
   return td::td_api::make_object<td::td_api::file>(
       12345, 123456, 123456,
@@ -752,9 +842,230 @@ BENCH(AnyOfTd, "any_of td") {
   td::do_not_optimize_away(res);
 }
 
+template <bool use_tree>
+class OrderedMessagesFindNewerBench final : public td::Benchmark {
+  static constexpr int MESSAGE_COUNT = 50000;
+  td::OrderedMessages ordered_messages_;
+
+ public:
+  td::string get_description() const final {
+    return PSTRING() << "OrderedMessages::find_newer_messages " << (use_tree ? "tree" : "index");
+  }
+
+  void start_up() final {
+    for (int i = 1; i <= MESSAGE_COUNT; i++) {
+      ordered_messages_.insert(td::MessageId(td::ServerMessageId(i)), true, td::MessageId(), "bench");
+    }
+  }
+
+  void run(int n) final {
+    size_t result = 0;
+    for (int i = 0; i < n; i++) {
+      auto min_message_id = td::MessageId(td::ServerMessageId(MESSAGE_COUNT - td::Random::fast(0, 100)));
+      if (use_tree) {
+        td::vector<td::MessageId> message_ids;
+        ordered_messages_.traverse_messages(
+            [&](td::MessageId message_id) { return message_id > min_message_id; },
+            [&](td::MessageId message_id) {
+              if (message_id > min_message_id) {
+                message_ids.push_back(message_id);
+              }
+              return true;
+            });
+        result += message_ids.size();
+      } else {
+        result += ordered_messages_.find_newer_messages(min_message_id).size();
+      }
+    }
+    td::do_not_optimize_away(result);
+  }
+};
+
+// registration of new files and lookups of existing files, which are done before merging, in an index of
+// 1000000 local file locations, keyed either by full locations in std::map or by compact keys in FlatHashMap
+template <bool use_hash_index, bool is_register>
+class LocalFileLocationIndexBench final : public td::Benchmark {
+  static constexpr size_t FILE_COUNT = 1000000;
+  td::string base_dir_ = "/data/user/0/org.telegram.messenger/files/tdlib/";
+  td::vector<td::FullLocalFileLocation> locations_;
+  std::map<td::FullLocalFileLocation, td::int32> map_index_;
+  td::FlatHashMap<td::FullLocalFileLocationKey, td::int32, td::FullLocalFileLocationKeyHash> hash_index_;
+  size_t next_location_ = 0;
+
+  td::int32 &get_file_id(const td::FullLocalFileLocation &location) {
+    if (use_hash_index) {
+      return hash_index_[td::FullLocalFileLocationKey(location, base_dir_)];
+    } else {
+      return map_index_[location];
+    }
+  }
+
+ public:
+  td::string get_description() const final {
+    return PSTRING() << "LocalFileLocationIndex " << (is_register ? "register" : "lookup") << ' '
+                     << (use_hash_index ? "FlatHashMap" : "std::map");
+  }
+
+  void start_up() final {
+    const td::FileType file_types[] = {td::FileType::Photo, td::FileType::Document, td::FileType::Video,
+                                       td::FileType::VoiceNote};
+    map_index_.clear();
+    hash_index_.clear();
+    next_location_ = 0;
+    locations_.clear();
+    for (size_t i = 0; i < FILE_COUNT; i++) {
+      auto file_type = file_types[i % 4];
+      auto path = PSTRING() << base_dir_ << td::get_file_type_name(file_type) << "/file_" << i << ".jpg";
+      locations_.emplace_back(file_type, std::move(path), 1700000000000000000 + td::Random::fast_uint32());
+    }
+    if (!is_register) {
+      for (size_t i = 0; i < FILE_COUNT; i++) {
+        get_file_id(locations_[i]) = static_cast<td::int32>(i + 1);
+      }
+    }
+  }
+
+  void run(int n) final {
+    td::int64 result = 0;
+    for (int i = 0; i < n; i++) {
+      if (is_register) {
+        if (next_location_ == FILE_COUNT) {
+          map_index_.clear();
+          hash_index_.clear();
+          next_location_ = 0;
+        }
+        auto &file_id = get_file_id(locations_[next_location_++]);
+        result += file_id;
+        file_id = i + 1;
+      } else {
+        result += get_file_id(locations_[td::Random::fast(0, static_cast<int>(FILE_COUNT) - 1)]);
+      }
+    }
+    td::do_not_optimize_away(result);
+  }
+};
+
+template <bool is_ascii>
+class Utf8Bench final : public td::Benchmark {
+  td::string text_;
+
+ public:
+  td::string get_description() const final {
+    return PSTRING() << "check_utf8 + utf8_length + utf8_utf16_length " << (is_ascii ? "ASCII" : "mixed");
+  }
+
+  void start_up() final {
+    text_.clear();
+    while (text_.size() < 4096) {
+      text_ += "Hello, world! ";
+      if (!is_ascii) {
+        text_ += "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xf0\x9f\x98\x80 ";
+      }
+    }
+  }
+
+  void run(int n) final {
+    size_t result = 0;
+    for (int i = 0; i < n; i++) {
+      result += td::check_utf8(text_);
+      result += td::utf8_length(text_);
+      result += td::utf8_utf16_length(text_);
+    }
+    td::do_not_optimize_away(result);
+  }
+};
+
+template <bool is_html>
+class ParseFormattedTextBench final : public td::Benchmark {
+  td::string text_;
+
+ public:
+  td::string get_description() const final {
+    return PSTRING() << (is_html ? "parse_html" : "parse_markdown_v2") << " of a long post";
+  }
+
+  void start_up() final {
+    text_.clear();
+    for (int i = 0; i < 50; i++) {
+      if (is_html) {
+        text_ += "<b>News item</b> &amp; <i>summary</i> with <a href=\"https://example.com/news?id=12345\">link</a>, "
+                 "<code>code</code> and <tg-spoiler>spoiler</tg-spoiler>\n";
+      } else {
+        text_ += "*News item* & _summary_ with [link](https://example.com/news?id=12345), `code` and ||spoiler||\n";
+      }
+    }
+  }
+
+  void run(int n) final {
+    size_t result = 0;
+    for (int i = 0; i < n; i++) {
+      auto text = text_;
+      auto r_entities = is_html ? td::parse_html(text) : td::parse_markdown_v2(text);
+      CHECK(r_entities.is_ok());
+      result += r_entities.ok().size();
+    }
+    td::do_not_optimize_away(result);
+  }
+};
+
+class HintsSearchBench final : public td::Benchmark {
+  static constexpr int KEY_COUNT = 200000;
+  td::Hints hints_;
+
+  static td::string get_random_word() {
+    td::string result;
+    auto length = td::Random::fast(3, 8);
+    for (int i = 0; i < length; i++) {
+      result += static_cast<char>('a' + td::Random::fast(0, 9));
+    }
+    return result;
+  }
+
+ public:
+  td::string get_description() const final {
+    return PSTRING() << "Hints::search among " << KEY_COUNT << " names";
+  }
+
+  void start_up() final {
+    for (int i = 1; i <= KEY_COUNT; i++) {
+      hints_.add(i, PSLICE() << get_random_word() << ' ' << get_random_word());
+      hints_.set_rating(i, td::Random::fast(0, 1000));
+    }
+  }
+
+  void run(int n) final {
+    size_t result = 0;
+    for (int i = 0; i < n; i++) {
+      auto query = get_random_word().substr(0, 3);
+      if (i % 2 == 0) {
+        query += ' ';
+        query += get_random_word().substr(0, 2);
+      }
+      result += hints_.search(query, 50).first;
+    }
+    td::do_not_optimize_away(result);
+  }
+};
+
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(DEBUG));
 
+  td::bench(HintsSearchBench());
+
+  td::bench(ParseFormattedTextBench<true>());
+  td::bench(ParseFormattedTextBench<false>());
+
+  td::bench(LocalFileLocationIndexBench<false, true>());
+  td::bench(LocalFileLocationIndexBench<true, true>());
+  td::bench(LocalFileLocationIndexBench<false, false>());
+  td::bench(LocalFileLocationIndexBench<true, false>());
+
+  td::bench(Utf8Bench<true>());
+  td::bench(Utf8Bench<false>());
+
+  td::bench(OrderedMessagesFindNewerBench<true>());
+  td::bench(OrderedMessagesFindNewerBench<false>());
+
   td::bench(AnyOfStdBench());
   td::bench(AnyOfTdBench());
 
@@ -824,6 +1135,7 @@ int main() {
   td::bench(PwriteBench());
 
   td::bench(TlCallBench());
+  td::bench(TlParseMessagesBench());
 #if !TD_THREAD_UNSUPPORTED
   td::bench(ThreadNewBench());
 #endif
@@ -0,0 +1,188 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/Client.h"
+#include "td/telegram/td_api.h"
+
+#include "td/utils/common.h"
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/path.h"
+#include "td/utils/port/Stat.h"
+#include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/StringBuilder.h"
+#include "td/utils/Time.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+// macro benchmark of Td instances, which works without network: measures startup time with new and existing databases,
+// latency and throughput of requests, which pass through all Td layers, and memory used by a Td instance
+class TdBench {
+ public:
+  TdBench(td::string directory, int client_count) : directory_(std::move(directory)), client_count_(client_count) {
+  }
+
+  void run(int request_count) {
+    td::rmrf(directory_).ignore();
+    td::mkdir(directory_).ensure();
+
+    auto memory_before = get_resident_size();
+    auto startup_times = start_clients();
+    auto memory_after = get_resident_size();
+    print_times("Startup with new database", startup_times);
+    LOG(PLAIN) << "Memory per client: "
+               << td::format::as_size((memory_after - td::min(memory_before, memory_after)) / client_count_);
+
+    print_times("Request latency", measure_latency(request_count));
+    measure_throughput(request_count);
+
+    close_clients();
+    print_times("Startup with existing database", start_clients());
+    close_clients();
+
+    td::rmrf(directory_).ignore();
+  }
+
+ private:
+  td::string directory_;
+  int client_count_;
+  td::ClientManager client_manager_;
+  td::vector<td::ClientManager::ClientId> client_ids_;
+  td::ClientManager::RequestId last_request_id_ = 0;
+  std::map<td::ClientManager::ClientId, td::int32> authorization_states_;
+
+  static td::uint64 get_resident_size() {
+    auto r_mem_stat = td::mem_stat();
+    return r_mem_stat.is_ok() ? r_mem_stat.ok().resident_size_ : 0;
+  }
+
+  static void print_times(td::Slice name, td::vector<double> times) {
+    CHECK(!times.empty());
+    std::sort(times.begin(), times.end());
+    auto get_percentile = [&](size_t percent) {
+      return td::StringBuilder::FixedDouble(times[(times.size() - 1) * percent / 100] * 1e3, 3);
+    };
+    LOG(PLAIN) << name << ": p50 = " << get_percentile(50) << "ms, p99 = " << get_percentile(99)
+               << "ms, max = " << get_percentile(100) << "ms";
+  }
+
+  td::ClientManager::RequestId send(td::ClientManager::ClientId client_id,
+                                    td::td_api::object_ptr<td::td_api::Function> function) {
+    auto request_id = ++last_request_id_;
+    client_manager_.send(client_id, request_id, std::move(function));
+    return request_id;
+  }
+
+  td::ClientManager::Response receive() {
+    auto response = client_manager_.receive(10.0);
+    LOG_CHECK(response.object != nullptr) << "Receive timeout expired";
+    if (response.request_id == 0 && response.object->get_id() == td::td_api::updateAuthorizationState::ID) {
+      auto &state = static_cast<const td::td_api::updateAuthorizationState &>(*response.object).authorization_state_;
+      authorization_states_[response.client_id] = state->get_id();
+      if (state->get_id() == td::td_api::authorizationStateWaitTdlibParameters::ID) {
+        send(response.client_id, get_parameters(response.client_id));
+      }
+    }
+    if (response.request_id != 0) {
+      LOG_CHECK(response.object->get_id() != td::td_api::error::ID) << td::td_api::to_string(response.object);
+    }
+    return response;
+  }
+
+  void wait_authorization_state(td::ClientManager::ClientId client_id, td::int32 state_id) {
+    while (authorization_states_[client_id] != state_id) {
+      receive();
+    }
+  }
+
+  td::td_api::object_ptr<td::td_api::setTdlibParameters> get_parameters(td::ClientManager::ClientId client_id) const {
+    auto client_index = std::find(client_ids_.begin(), client_ids_.end(), client_id) - client_ids_.begin();
+    auto request = td::td_api::make_object<td::td_api::setTdlibParameters>();
+    request->use_test_dc_ = true;
+    request->database_directory_ = PSTRING() << directory_ << TD_DIR_SLASH << client_index;
+    request->use_message_database_ = true;
+    request->use_secret_chats_ = true;
+    request->api_id_ = 94575;
+    request->api_hash_ = "a3406de8d171bb422bb6ddf3bbd800e2";
+    request->system_language_code_ = "en";
+    request->device_model_ = "Desktop";
+    request->application_version_ = "bench_td";
+    return request;
+  }
+
+  td::vector<double> start_clients() {
+    td::vector<double> startup_times;
+    for (int i = 0; i < client_count_; i++) {
+      auto start_time = td::Time::now();
+      auto client_id = client_manager_.create_client_id();
+      client_ids_.push_back(client_id);
+      send(client_id, td::td_api::make_object<td::td_api::getOption>("version"));
+      wait_authorization_state(client_id, td::td_api::authorizationStateWaitPhoneNumber::ID);
+      startup_times.push_back(td::Time::now() - start_time);
+    }
+    return startup_times;
+  }
+
+  void close_clients() {
+    for (auto client_id : client_ids_) {
+      send(client_id, td::td_api::make_object<td::td_api::close>());
+    }
+    for (auto client_id : client_ids_) {
+      wait_authorization_state(client_id, td::td_api::authorizationStateClosed::ID);
+    }
+    client_ids_.clear();
+    authorization_states_.clear();
+  }
+
+  td::vector<double> measure_latency(int request_count) {
+    td::vector<double> latencies;
+    for (int i = 0; i < request_count; i++) {
+      auto client_id = client_ids_[i % client_ids_.size()];
+      auto start_time = td::Time::now();
+      auto request_id = send(client_id, td::td_api::make_object<td::td_api::testSquareInt>(i));
+      while (receive().request_id != request_id) {
+      }
+      latencies.push_back(td::Time::now() - start_time);
+    }
+    return latencies;
+  }
+
+  void measure_throughput(int request_count) {
+    auto start_time = td::Time::now();
+    for (int i = 0; i < request_count; i++) {
+      send(client_ids_[i % client_ids_.size()], td::td_api::make_object<td::td_api::testCallEmpty>());
+    }
+    int received_count = 0;
+    while (received_count < request_count) {
+      if (receive().request_id != 0) {
+        received_count++;
+      }
+    }
+    auto passed_time = td::Time::now() - start_time;
+    LOG(PLAIN) << "Request throughput: "
+               << td::StringBuilder::FixedDouble(request_count / td::max(passed_time, 1e-9), 0) << " requests/s";
+  }
+};
+
+int main(int argc, char *argv[]) {
+  td::ClientManager::execute(td::td_api::make_object<td::td_api::setLogVerbosityLevel>(0));
+
+  int client_count = 10;
+  int request_count = 100000;
+  if (argc > 1) {
+    client_count = td::max(td::to_integer<int>(td::Slice(argv[1])), 1);
+  }
+  if (argc > 2) {
+    request_count = td::max(td::to_integer<int>(td::Slice(argv[2])), 1);
+  }
+  LOG(PLAIN) << "Benchmark " << client_count << " clients with " << request_count << " requests";
+
+  TdBench("bench_td_db", client_count).run(request_count);
+}
@@ -7,10 +7,13 @@
 #include "td/telegram/DialogId.h"
 #include "td/telegram/MessageDb.h"
 #include "td/telegram/MessageId.h"
+#include "td/telegram/MessageSearchFilter.h"
 #include "td/telegram/NotificationId.h"
 #include "td/telegram/ServerMessageId.h"
 #include "td/telegram/UserId.h"
 
+#include "td/db/binlog/Binlog.h"
+#include "td/db/binlog/BinlogEvent.h"
 #include "td/db/DbKey.h"
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
@@ -20,10 +23,18 @@
 #include "td/utils/benchmark.h"
 #include "td/utils/buffer.h"
 #include "td/utils/common.h"
+#include "td/utils/format.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/Stat.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Random.h"
+#include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
+#include "td/utils/Storer.h"
+#include "td/utils/Time.h"
+#include "td/utils/tl_storers.h"
 
 #include <memory>
 
@@ -107,7 +118,420 @@ class MessageDbBench final : public td::Benchmark {
   }
 };
 
-int main() {
+class MessageDbAddMessagesBench final : public td::Benchmark {
+ public:
+  explicit MessageDbAddMessagesBench(int batch_size) : batch_size_(batch_size) {
+  }
+  ~MessageDbAddMessagesBench() final {
+    if (database_message_count_ > 0) {
+      LOG(ERROR) << "Database size is " << td::format::as_size(database_size_) << " for " << database_message_count_
+                 << " messages";
+    }
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "MessageDb add_messages " << td::tag("batch_size", batch_size_);
+  }
+
+  void start_up() final {
+    last_message_id_ = 0;
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(0, 0);
+    scheduler_->start();
+    auto guard = scheduler_->get_main_guard();
+
+    td::SqliteDb::destroy(sql_db_name_).ignore();
+    td::SqliteDb::open_with_key(sql_db_name_, true, td::DbKey::empty()).ensure();
+    sql_connection_ = std::make_shared<td::SqliteConnectionSafe>(sql_db_name_.str(), td::DbKey::empty());
+    auto &db = sql_connection_->get();
+    init_db(db).ensure();
+    db.exec("BEGIN TRANSACTION").ensure();
+    init_message_db(db, 0).ensure();
+    db.exec("COMMIT TRANSACTION").ensure();
+
+    message_db_sync_safe_ = td::create_message_db_sync(sql_connection_);
+  }
+
+  void run(int n) final {
+    auto guard = scheduler_->get_main_guard();
+    auto &message_db = message_db_sync_safe_->get();
+    for (int i = 0; i < n; i += batch_size_) {
+      td::vector<td::MessageDbAddMessageQuery> messages;
+      for (int j = 0; j < batch_size_; j++) {
+        td::MessageDbAddMessageQuery message;
+        auto dialog_id = td::DialogId(td::UserId(static_cast<td::int64>(td::Random::fast(1, 100))));
+        message.message_full_id = {dialog_id, td::MessageId{td::ServerMessageId{++last_message_id_}}};
+        message.unique_message_id = td::ServerMessageId{last_message_id_};
+        message.sender_dialog_id = td::DialogId(td::UserId(static_cast<td::int64>(td::Random::fast(1, 1000))));
+        message.random_id = last_message_id_;
+        // a third of messages are added to one or two media indices
+        if (td::Random::fast(0, 2) == 0) {
+          message.index_mask = (1 << td::Random::fast(0, 29)) | (1 << td::Random::fast(0, 29));
+        }
+        message.data = td::BufferSlice(td::Random::fast(100, 299));
+        messages.push_back(std::move(message));
+      }
+
+      message_db.begin_write_transaction().ensure();
+      if (batch_size_ == 1) {
+        auto &message = messages[0];
+        message_db.add_message(message.message_full_id, message.unique_message_id, message.sender_dialog_id,
+                               message.random_id, message.ttl_expires_at, message.index_mask, message.search_id,
+                               std::move(message.text), message.notification_id, message.top_thread_message_id,
+                               std::move(message.data));
+      } else {
+        message_db.add_messages(std::move(messages));
+      }
+      message_db.commit_transaction().ensure();
+    }
+  }
+
+  void tear_down() final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      message_db_sync_safe_.reset();
+      sql_connection_->get().exec("PRAGMA wal_checkpoint(TRUNCATE)").ensure();
+      auto r_stat = td::stat(sql_db_name_);
+      if (r_stat.is_ok() && last_message_id_ > 0) {
+        database_size_ = r_stat.ok().size_;
+        database_message_count_ = last_message_id_;
+      }
+      sql_connection_->close_and_destroy();
+      sql_connection_.reset();
+    }
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  int batch_size_;
+  td::int32 last_message_id_ = 0;
+  td::int64 database_size_ = 0;
+  td::int32 database_message_count_ = 0;
+  td::CSlice sql_db_name_ = "bench_message_db.sqlite";
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  std::shared_ptr<td::SqliteConnectionSafe> sql_connection_;
+  std::shared_ptr<td::MessageDbSyncSafeInterface> message_db_sync_safe_;
+};
+
+// message history with realistic data, shared by the MessageDb query benchmarks, because it is too slow to recreate
+class MessageDbHistory {
+ public:
+  static constexpr int DIALOG_COUNT = 100;
+  static constexpr int SENDERS_PER_DIALOG = 20;
+  static constexpr int BATCH_SIZE = 1000;
+
+  MessageDbHistory(int message_count, bool is_encrypted) : is_encrypted_(is_encrypted) {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(0, 0);
+    scheduler_->start();
+    auto guard = scheduler_->get_main_guard();
+
+    auto db_key = is_encrypted ? td::DbKey::raw_key(td::string(32, 'a')) : td::DbKey::empty();
+    td::SqliteDb::destroy(sql_db_name_).ignore();
+    td::SqliteDb::open_with_key(sql_db_name_, true, db_key).ensure();
+    sql_connection_ = std::make_shared<td::SqliteConnectionSafe>(sql_db_name_.str(), std::move(db_key));
+    auto &db = sql_connection_->get();
+    init_db(db).ensure();
+    db.exec("BEGIN TRANSACTION").ensure();
+    init_message_db(db, 0).ensure();
+    db.exec("COMMIT TRANSACTION").ensure();
+    message_db_sync_safe_ = td::create_message_db_sync(sql_connection_);
+
+    auto start_time = td::Time::now();
+    auto &message_db = message_db_sync_safe_->get();
+    while (message_count_ < message_count) {
+      td::vector<td::MessageDbAddMessageQuery> messages;
+      for (int j = 0; j < BATCH_SIZE && message_count_ < message_count; j++) {
+        messages.push_back(create_message());
+      }
+      message_db.begin_write_transaction().ensure();
+      message_db.add_messages(std::move(messages));
+      message_db.commit_transaction().ensure();
+    }
+    db.exec("PRAGMA wal_checkpoint(TRUNCATE)").ensure();
+    LOG(ERROR) << "Added " << message_count_ << " messages to " << (is_encrypted ? "encrypted " : "")
+               << "MessageDb in " << td::format::as_time(td::Time::now() - start_time) << ", database size is "
+               << td::format::as_size(td::stat(sql_db_name_).ok().size_);
+  }
+  MessageDbHistory(const MessageDbHistory &) = delete;
+  MessageDbHistory &operator=(const MessageDbHistory &) = delete;
+  MessageDbHistory(MessageDbHistory &&) = delete;
+  MessageDbHistory &operator=(MessageDbHistory &&) = delete;
+  ~MessageDbHistory() {
+    {
+      auto guard = scheduler_->get_main_guard();
+      message_db_sync_safe_.reset();
+      sql_connection_->close_and_destroy();
+      sql_connection_.reset();
+    }
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+  bool is_encrypted() const {
+    return is_encrypted_;
+  }
+
+  td::int32 get_message_count() const {
+    return message_count_;
+  }
+
+  td::ConcurrentScheduler &get_scheduler() {
+    return *scheduler_;
+  }
+
+  td::MessageDbSyncInterface &get_message_db() {
+    return message_db_sync_safe_->get();
+  }
+
+  static td::DialogId get_random_dialog_id() {
+    return td::DialogId(td::UserId(static_cast<td::int64>(td::Random::fast(1, DIALOG_COUNT))));
+  }
+
+  static td::DialogId get_random_sender_dialog_id() {
+    return td::DialogId(td::UserId(static_cast<td::int64>(td::Random::fast(1, DIALOG_COUNT * SENDERS_PER_DIALOG))));
+  }
+
+  static td::Slice get_random_word() {
+    static const td::Slice words[] = {"hello", "world",  "meeting", "tomorrow", "photo",  "document",
+                                      "video", "launch", "release", "report",   "budget", "weekend"};
+    return words[td::Random::fast(0, static_cast<int>(sizeof(words) / sizeof(words[0])) - 1)];
+  }
+
+ private:
+  bool is_encrypted_;
+  td::int32 message_count_ = 0;
+  td::CSlice sql_db_name_ = "bench_message_db_history.sqlite";
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  std::shared_ptr<td::SqliteConnectionSafe> sql_connection_;
+  std::shared_ptr<td::MessageDbSyncSafeInterface> message_db_sync_safe_;
+
+  td::MessageDbAddMessageQuery create_message() {
+    auto message_id = td::MessageId{td::ServerMessageId{++message_count_}};
+    // one message per minute
+    auto date = 1600000000 + message_count_ * 60;
+
+    td::MessageDbAddMessageQuery message;
+    message.message_full_id = {get_random_dialog_id(), message_id};
+    message.unique_message_id = td::ServerMessageId{message_count_};
+    message.sender_dialog_id = get_random_sender_dialog_id();
+    message.random_id = message_count_;
+    // a third of messages are added to a media index
+    if (td::Random::fast(0, 2) == 0) {
+      message.index_mask = td::message_search_filter_index_mask(
+          td::Random::fast_bool() ? td::MessageSearchFilter::Photo : td::MessageSearchFilter::Document);
+    }
+    message.search_id = (static_cast<td::int64>(date) << 32) | static_cast<td::uint32>(td::Random::secure_int32());
+    for (int i = td::Random::fast(2, 8); i > 0; i--) {
+      message.text += get_random_word().str();
+      message.text += ' ';
+    }
+
+    // the beginning of serialized message, which is parsed by MessageDb to get the message date
+    auto data_size = td::Random::fast(100, 299);
+    message.data = td::BufferSlice(data_size);
+    message.data.as_mutable_slice().fill('\0');
+    td::TlStorerUnsafe storer(message.data.as_mutable_slice().ubegin());
+    storer.store_int(0);
+    storer.store_long(message_id.get());
+    storer.store_int(date);
+    return message;
+  }
+};
+
+class MessageDbQueryBench final : public td::Benchmark {
+ public:
+  enum class Type : td::int32 { GetMessages, GetMessagesByFilter, FtsDialog, FtsGlobal, Calendar };
+
+  MessageDbQueryBench(MessageDbHistory &history, Type type) : history_(history), type_(type) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "MessageDb " << get_type_name() << " for " << history_.get_message_count() << " messages"
+                     << (history_.is_encrypted() ? " encrypted" : "");
+  }
+
+  void run(int n) final {
+    auto guard = history_.get_scheduler().get_main_guard();
+    auto &message_db = history_.get_message_db();
+    for (int i = 0; i < n; i++) {
+      switch (type_) {
+        case Type::GetMessages:
+        case Type::GetMessagesByFilter: {
+          td::MessageDbMessagesQuery query;
+          query.dialog_id = MessageDbHistory::get_random_dialog_id();
+          query.filter = type_ == Type::GetMessages ? td::MessageSearchFilter::Empty : td::MessageSearchFilter::Photo;
+          query.from_message_id =
+              td::MessageId{td::ServerMessageId{td::Random::fast(1, history_.get_message_count() + 1)}};
+          query.limit = 100;
+          message_db.get_messages(std::move(query));
+          break;
+        }
+        case Type::FtsDialog:
+        case Type::FtsGlobal: {
+          td::MessageDbFtsQuery query;
+          query.query = PSTRING() << MessageDbHistory::get_random_word() << ' ' << MessageDbHistory::get_random_word();
+          if (type_ == Type::FtsDialog) {
+            query.dialog_id = MessageDbHistory::get_random_dialog_id();
+          }
+          query.limit = 100;
+          message_db.get_messages_fts(std::move(query));
+          break;
+        }
+        case Type::Calendar: {
+          td::MessageDbDialogCalendarQuery query;
+          query.dialog_id = MessageDbHistory::get_random_dialog_id();
+          query.filter = td::MessageSearchFilter::Photo;
+          query.from_message_id = td::MessageId::max();
+          message_db.get_dialog_message_calendar(std::move(query));
+          break;
+        }
+        default:
+          UNREACHABLE();
+      }
+    }
+  }
+
+ private:
+  MessageDbHistory &history_;
+  Type type_;
+
+  td::Slice get_type_name() const {
+    switch (type_) {
+      case Type::GetMessages:
+        return td::Slice("get_messages");
+      case Type::GetMessagesByFilter:
+        return td::Slice("get_messages by filter");
+      case Type::FtsDialog:
+        return td::Slice("get_messages_fts in a chat");
+      case Type::FtsGlobal:
+        return td::Slice("get_messages_fts");
+      case Type::Calendar:
+        return td::Slice("get_dialog_message_calendar");
+      default:
+        UNREACHABLE();
+        return td::Slice();
+    }
+  }
+};
+
+// deletions change the history, so they are measured once after all other benchmarks
+static void bench_delete_messages_by_sender(MessageDbHistory &history) {
+  auto guard = history.get_scheduler().get_main_guard();
+  auto &message_db = history.get_message_db();
+  constexpr int DELETE_COUNT = 100;
+  auto start_time = td::Time::now();
+  for (int i = 0; i < DELETE_COUNT; i++) {
+    message_db.begin_write_transaction().ensure();
+    message_db.delete_dialog_messages_by_sender(MessageDbHistory::get_random_dialog_id(),
+                                                MessageDbHistory::get_random_sender_dialog_id());
+    message_db.commit_transaction().ensure();
+  }
+  LOG(ERROR) << "MessageDb delete_dialog_messages_by_sender for " << history.get_message_count() << " messages"
+             << (history.is_encrypted() ? " encrypted" : "") << " takes "
+             << td::format::as_time((td::Time::now() - start_time) / DELETE_COUNT);
+}
+
+class BinlogWriteBench final : public td::Benchmark {
+ public:
+  BinlogWriteBench(bool is_encrypted, int events_per_flush)
+      : is_encrypted_(is_encrypted), events_per_flush_(events_per_flush) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "Binlog write" << (is_encrypted_ ? " encrypted" : "") << " by " << events_per_flush_
+                     << " events per flush";
+  }
+
+  void start_up() final {
+    td::Binlog::destroy(binlog_name_).ignore();
+    binlog_ = td::make_unique<td::Binlog>();
+    auto db_key = is_encrypted_ ? td::DbKey::raw_key(td::string(32, 'a')) : td::DbKey::empty();
+    binlog_->init(binlog_name_.str(), [](const td::BinlogEvent &) {}, std::move(db_key)).ensure();
+  }
+
+  void run(int n) final {
+    td::string data(64, 'a');
+    for (int i = 0; i < n; i++) {
+      binlog_->add(1, td::create_storer(data));
+      if ((i + 1) % events_per_flush_ == 0) {
+        binlog_->flush("bench");
+      }
+    }
+    binlog_->flush("bench");
+  }
+
+  void tear_down() final {
+    binlog_->close().ensure();
+    binlog_.reset();
+    td::Binlog::destroy(binlog_name_).ignore();
+  }
+
+ private:
+  bool is_encrypted_;
+  int events_per_flush_;
+  td::CSlice binlog_name_ = "bench_binlog";
+  td::unique_ptr<td::Binlog> binlog_;
+};
+
+class BinlogEventValidateBench final : public td::Benchmark {
+ public:
+  BinlogEventValidateBench(bool use_crc32c, size_t data_size) : use_crc32c_(use_crc32c), data_size_(data_size) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "BinlogEvent validate with " << (use_crc32c_ ? "CRC-32C" : "CRC-32") << " of size "
+                     << data_size_;
+  }
+
+  void start_up() final {
+    td::BinlogEvent::set_use_crc32c(use_crc32c_);
+    td::string data(data_size_, 'a');
+    event_ = td::BinlogEvent(td::BinlogEvent::create_raw(1, 1, 0, td::create_storer(data)), {});
+    td::BinlogEvent::set_use_crc32c(false);
+  }
+
+  void run(int n) final {
+    for (int i = 0; i < n; i++) {
+      event_.validate().ensure();
+    }
+  }
+
+ private:
+  bool use_crc32c_;
+  size_t data_size_;
+  td::BinlogEvent event_;
+};
+
+int main(int argc, char *argv[]) {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(WARNING));
+  int history_message_count = 100000;
+  if (argc > 1) {
+    history_message_count = td::max(td::to_integer<int>(td::Slice(argv[1])), 1);
+  }
+  for (auto is_encrypted : {false, true}) {
+    for (auto events_per_flush : {1, 100, 10000}) {
+      td::bench(BinlogWriteBench(is_encrypted, events_per_flush));
+    }
+  }
+  for (auto use_crc32c : {false, true}) {
+    if (use_crc32c && !td::BinlogEvent::is_crc32c_supported()) {
+      continue;
+    }
+    for (size_t data_size : {64, 4096}) {
+      td::bench(BinlogEventValidateBench(use_crc32c, data_size));
+    }
+  }
+  for (auto batch_size : {1, 100}) {
+    td::bench(MessageDbAddMessagesBench(batch_size));
+  }
   td::bench(MessageDbBench());
+  for (auto is_encrypted : {false, true}) {
+    MessageDbHistory history(history_message_count, is_encrypted);
+    for (auto type : {MessageDbQueryBench::Type::GetMessages, MessageDbQueryBench::Type::GetMessagesByFilter,
+                      MessageDbQueryBench::Type::FtsDialog, MessageDbQueryBench::Type::FtsGlobal,
+                      MessageDbQueryBench::Type::Calendar}) {
+      td::bench(MessageDbQueryBench(history, type));
+    }
+    bench_delete_messages_by_sender(history);
+  }
 }
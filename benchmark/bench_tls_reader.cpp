@@ -0,0 +1,122 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/mtproto/TcpTransport.h"
+#include "td/mtproto/TlsReaderByteFlow.h"
+
+#include "td/utils/AesCtrByteFlow.h"
+#include "td/utils/benchmark.h"
+#include "td/utils/buffer.h"
+#include "td/utils/ByteFlow.h"
+#include "td/utils/common.h"
+#include "td/utils/crypto.h"
+#include "td/utils/logging.h"
+#include "td/utils/Random.h"
+#include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/UInt.h"
+
+// a stream of MTProto packets received from a proxy with an "ee" secret
+class TlsReaderBench final : public td::Benchmark {
+ public:
+  TlsReaderBench(bool use_combined_reader, size_t packet_size)
+      : use_combined_reader_(use_combined_reader), packet_size_(packet_size) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "Read " << packet_size_ << "-byte packets through fake TLS "
+                     << (use_combined_reader_ ? "with combined reader" : "with TlsReaderByteFlow >> AesCtrByteFlow")
+                     << " [" << (STREAM_SIZE >> 20) << "MB]";
+  }
+
+  void start_up() final {
+    td::Random::secure_bytes(key_.raw, sizeof(key_));
+    td::Random::secure_bytes(iv_.raw, sizeof(iv_));
+
+    td::string data;
+    while (data.size() + packet_size_ + 4 <= STREAM_SIZE) {
+      auto size = static_cast<td::uint32>(packet_size_);
+      data += td::Slice(reinterpret_cast<const char *>(&size), sizeof(size)).str();
+      data += td::string(packet_size_, 'a');
+    }
+    td::AesCtrState state;
+    state.init(as_slice(key_), as_slice(iv_));
+    state.encrypt(data, data);
+
+    stream_.clear();
+    td::Slice left_data = data;
+    while (!left_data.empty()) {
+      auto record_size = td::min(MAX_RECORD_SIZE, left_data.size());
+      stream_ += "\x17\x03\x03";
+      stream_ += static_cast<char>(record_size >> 8);
+      stream_ += static_cast<char>(record_size & 255);
+      stream_ += left_data.substr(0, record_size).str();
+      left_data.remove_prefix(record_size);
+    }
+    packet_count_ = data.size() / (packet_size_ + 4);
+  }
+
+  void run(int n) final {
+    for (int i = 0; i < n; i++) {
+      td::ChainBufferWriter input_writer;
+      auto input = input_writer.extract_reader();
+      td::ByteFlowSource source(&input);
+      td::mtproto::TlsReaderByteFlow tls_reader;
+      td::AesCtrByteFlow aes_ctr;
+      td::mtproto::TlsAesCtrReaderByteFlow combined_reader;
+      td::ByteFlowSink sink;
+      if (use_combined_reader_) {
+        combined_reader.init(key_, iv_);
+        source >> combined_reader >> sink;
+      } else {
+        aes_ctr.init(key_, iv_);
+        source >> tls_reader >> aes_ctr >> sink;
+      }
+      td::mtproto::tcp::IntermediateTransport transport(false);
+
+      size_t received_packet_count = 0;
+      td::Slice left_stream = stream_;
+      while (!left_stream.empty()) {
+        auto read_size = td::min(READ_SIZE, left_stream.size());
+        auto dest = input_writer.prepare_append_at_least(read_size).truncate(read_size);
+        dest.copy_from(left_stream.substr(0, read_size));
+        input_writer.confirm_append(read_size);
+        left_stream.remove_prefix(read_size);
+        source.wakeup();
+
+        while (true) {
+          td::BufferSlice packet;
+          if (transport.read_from_stream(sink.get_output(), &packet, nullptr) != 0) {
+            break;
+          }
+          CHECK(packet.size() == packet_size_);
+          received_packet_count++;
+        }
+      }
+      CHECK(received_packet_count == packet_count_);
+    }
+  }
+
+ private:
+  static constexpr size_t STREAM_SIZE = 1 << 22;
+  static constexpr size_t MAX_RECORD_SIZE = 1 << 14;
+  static constexpr size_t READ_SIZE = 1 << 16;
+
+  bool use_combined_reader_;
+  size_t packet_size_;
+  size_t packet_count_ = 0;
+  td::UInt256 key_;
+  td::UInt128 iv_;
+  td::string stream_;
+};
+
+int main() {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(WARNING));
+  for (size_t packet_size : {1 << 8, 1 << 12, 1 << 16, 1 << 19}) {
+    td::bench(TlsReaderBench(false, packet_size));
+    td::bench(TlsReaderBench(true, packet_size));
+  }
+}
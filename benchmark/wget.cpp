@@ -5,6 +5,7 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 #include "td/net/HttpQuery.h"
+#include "td/net/SslCtx.h"
 #include "td/net/Wget.h"
 
 #include "td/actor/actor.h"
@@ -12,29 +13,74 @@
 
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/Promise.h"
+#include "td/utils/Slice.h"
 #include "td/utils/Status.h"
+#include "td/utils/Time.h"
+
+#include <utility>
+
+class WgetRunner final : public td::Actor {
+ public:
+  WgetRunner(td::string url, bool prefer_ipv6, int request_count)
+      : url_(std::move(url)), prefer_ipv6_(prefer_ipv6), request_count_(request_count) {
+  }
+
+ private:
+  td::string url_;
+  bool prefer_ipv6_;
+  int request_count_;
+  int finished_count_ = 0;
+  double start_time_ = 0.0;
+  double request_start_time_ = 0.0;
+
+  void start_up() final {
+    start_time_ = td::Time::now();
+    send_request();
+  }
+
+  void send_request() {
+    auto timeout = 10;
+    auto ttl = 3;
+    request_start_time_ = td::Time::now();
+    td::create_actor<td::Wget>("Client",
+                               td::PromiseCreator::lambda([actor_id = actor_id(this)](
+                                                              td::Result<td::unique_ptr<td::HttpQuery>> res) {
+                                 send_closure(actor_id, &WgetRunner::on_result, std::move(res));
+                               }),
+                               url_, td::Auto(), timeout, ttl, prefer_ipv6_)
+        .release();
+  }
+
+  void on_result(td::Result<td::unique_ptr<td::HttpQuery>> res) {
+    if (res.is_error()) {
+      LOG(FATAL) << res.error();
+    }
+    auto now = td::Time::now();
+    if (finished_count_ == 0) {
+      LOG(ERROR) << *res.ok();
+    }
+    LOG(ERROR) << "Request " << finished_count_ << " took " << now - request_start_time_ << " seconds";
+    if (++finished_count_ < request_count_) {
+      return send_request();
+    }
+    LOG(ERROR) << "Finished " << request_count_ << " requests in " << now - start_time_ << " seconds with "
+               << td::SslCtx::get_session_cache_stats();
+    td::Scheduler::instance()->finish();
+    stop();
+  }
+};
 
 int main(int argc, char *argv[]) {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(DEBUG));
   td::VERBOSITY_NAME(fd) = VERBOSITY_NAME(INFO);
 
   td::string url = (argc > 1 ? argv[1] : "https://telegram.org");
-  auto timeout = 10;
-  auto ttl = 3;
   auto prefer_ipv6 = (argc > 2 && td::string(argv[2]) == "-6");
+  auto request_count = td::max(argc > 3 ? td::to_integer<int>(td::Slice(argv[3])) : 1, 1);
   auto scheduler = td::make_unique<td::ConcurrentScheduler>(0, 0);
-  scheduler
-      ->create_actor_unsafe<td::Wget>(0, "Client",
-                                      td::PromiseCreator::lambda([](td::Result<td::unique_ptr<td::HttpQuery>> res) {
-                                        if (res.is_error()) {
-                                          LOG(FATAL) << res.error();
-                                        }
-                                        LOG(ERROR) << *res.ok();
-                                        td::Scheduler::instance()->finish();
-                                      }),
-                                      url, td::Auto(), timeout, ttl, prefer_ipv6)
-      .release();
+  scheduler->create_actor_unsafe<WgetRunner>(0, "WgetRunner", url, prefer_ipv6, request_count).release();
   scheduler->start();
   while (scheduler->run_main(10)) {
     // empty
@@ -6,6 +6,8 @@
 //
 package org.drinkless.tdlib;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.concurrent.ConcurrentHashMap;
 import java.util.concurrent.atomic.AtomicLong;
 
@@ -161,12 +163,28 @@ public final class Client {
         nativeClientSetLogMessageHandler(maxVerbosityLevel, logMessageHandler);
     }
 
+    /**
+     * Changes the way in which updates and query results are passed from TDLib to Java.
+     * If enabled, TDLib serializes received objects to a direct ByteBuffer, which is then decoded in Java
+     * instead of creating the objects through JNI calls. This is usually much faster for big objects.
+     * Disabled by default.
+     *
+     * @param isEnabled Pass true to enable receiving of objects through a direct ByteBuffer.
+     */
+    public static void setDirectBufferReceiveEnabled(boolean isEnabled) {
+        isDirectBufferReceiveEnabled = isEnabled;
+    }
+
     private static class ResponseReceiver implements Runnable {
         public boolean isRun = false;
 
         @Override
         public void run() {
             while (true) {
+                if (isDirectBufferReceiveEnabled) {
+                    receiveDirect();
+                    continue;
+                }
                 int resultN = nativeClientReceive(clientIds, eventIds, events, 100000.0 /*seconds*/);
                 for (int i = 0; i < resultN; i++) {
                     processResult(clientIds[i], eventIds[i], events[i]);
@@ -175,6 +193,22 @@ public final class Client {
             }
         }
 
+        private void receiveDirect() {
+            int size = nativeClientReceiveDirect(buffer, 100000.0 /*seconds*/);
+            if (size < 0) {
+                // the buffer is too small for the next response
+                buffer = ByteBuffer.allocateDirect(Math.max(-size, 2 * buffer.capacity())).order(ByteOrder.nativeOrder());
+                return;
+            }
+            buffer.clear();
+            buffer.limit(size);
+            while (buffer.hasRemaining()) {
+                int clientId = buffer.getInt();
+                long id = buffer.getLong();
+                processResult(clientId, id, TdApi.Object.fetch(buffer));
+            }
+        }
+
         private void processResult(int clientId, long id, TdApi.Object object) {
             boolean isClosed = false;
             if (id == 0 && object instanceof TdApi.UpdateAuthorizationState) {
@@ -213,6 +247,7 @@ public final class Client {
         private final int[] clientIds = new int[MAX_EVENTS];
         private final long[] eventIds = new long[MAX_EVENTS];
         private final TdApi.Object[] events = new TdApi.Object[MAX_EVENTS];
+        private ByteBuffer buffer = ByteBuffer.allocateDirect(1 << 20).order(ByteOrder.nativeOrder());
     }
 
     private final int nativeClientId;
@@ -224,6 +259,7 @@ public final class Client {
     private static final AtomicLong clientCount = new AtomicLong();
 
     private static final ResponseReceiver responseReceiver = new ResponseReceiver();
+    private static volatile boolean isDirectBufferReceiveEnabled = false;
 
     private static class Handler {
         final ResultHandler resultHandler;
@@ -253,6 +289,8 @@ public final class Client {
 
     private static native int nativeClientReceive(int[] clientIds, long[] eventIds, TdApi.Object[] events, double timeout);
 
+    private static native int nativeClientReceiveDirect(ByteBuffer buffer, double timeout);
+
     private static native TdApi.Object nativeClientExecute(TdApi.Function function);
 
     private static native void nativeClientSetLogMessageHandler(int maxVerbosityLevel, LogMessageHandler logMessageHandler);
@@ -13,6 +13,10 @@
 
 #include <td/tl/tl_jni_object.h>
 
+#ifndef TD_JSON_JAVA
+#include <td/utils/tl_storers.h>
+#endif
+
 #include <cstdint>
 #include <cstdlib>
 #include <string>
@@ -67,6 +71,10 @@ static void Client_nativeClientSend(JNIEnv *env, jclass clazz, jint client_id, j
                       fetch_function(env, function));
 }
 
+// the response, which didn't fit in the buffer passed to the previous call of Client_nativeClientReceiveDirect;
+// responses are received only by a single thread, so no synchronization is needed
+static td::ClientManager::Response pending_response;
+
 static jint Client_nativeClientReceive(JNIEnv *env, jclass clazz, jintArray client_ids, jlongArray ids,
                                        jobjectArray events, jdouble timeout) {
   jsize events_size = env->GetArrayLength(ids);  // client_ids, ids and events must be of equal size
@@ -76,7 +84,7 @@ static jint Client_nativeClientReceive(JNIEnv *env, jclass clazz, jintArray clie
   jsize result_size = 0;
 
   auto *manager = get_manager();
-  auto response = manager->receive(timeout);
+  auto response = pending_response.object ? std::move(pending_response) : manager->receive(timeout);
   while (response.object) {
     auto client_id = static_cast<jint>(response.client_id);
     env->SetIntArrayRegion(client_ids, result_size, 1, &client_id);
@@ -99,6 +107,45 @@ static jint Client_nativeClientReceive(JNIEnv *env, jclass clazz, jintArray clie
   return result_size;
 }
 
+template <class StorerT>
+static void store_response(StorerT &storer, const td::ClientManager::Response &response) {
+  storer.store_binary(static_cast<std::int32_t>(response.client_id));
+  storer.store_binary(static_cast<std::int64_t>(response.request_id));
+  td::jni::store_to_buffer(storer, response.object);
+}
+
+static jint Client_nativeClientReceiveDirect(JNIEnv *env, jclass clazz, jobject buffer, jdouble timeout) {
+  auto *buffer_begin = static_cast<unsigned char *>(env->GetDirectBufferAddress(buffer));
+  auto buffer_size = static_cast<std::int64_t>(env->GetDirectBufferCapacity(buffer));
+  if (buffer_begin == nullptr || buffer_size <= 0) {
+    return 0;
+  }
+  std::int64_t result_size = 0;
+
+  auto *manager = get_manager();
+  auto response = pending_response.object ? std::move(pending_response) : manager->receive(timeout);
+  while (response.object) {
+    td::TlStorerCalcLength calc_length;
+    store_response(calc_length, response);
+    auto response_size = static_cast<std::int64_t>(calc_length.get_length());
+    if (response_size > buffer_size - result_size) {
+      pending_response = std::move(response);
+      if (result_size == 0) {
+        // the buffer is too small even for a single response; return the needed size
+        return static_cast<jint>(-response_size);
+      }
+      break;
+    }
+
+    td::TlStorerUnsafe storer(buffer_begin + result_size);
+    store_response(storer, response);
+    result_size += response_size;
+
+    response = manager->receive(0);
+  }
+  return static_cast<jint>(result_size);
+}
+
 static jobject Client_nativeClientExecute(JNIEnv *env, jclass clazz, jobject function) {
   jobject result;
   td::ClientManager::execute(fetch_function(env, function))->store(env, result);
@@ -205,6 +252,8 @@ static jint register_native(JavaVM *vm) {
   register_method(client_class, "createNativeClient", "()I", Client_createNativeClient);
   register_method(client_class, "nativeClientSend", "(IJ" TD_FUNCTION ")V", Client_nativeClientSend);
   register_method(client_class, "nativeClientReceive", "([I[J[" TD_OBJECT "D)I", Client_nativeClientReceive);
+  register_method(client_class, "nativeClientReceiveDirect", "(Ljava/nio/ByteBuffer;D)I",
+                  Client_nativeClientReceiveDirect);
   register_method(client_class, "nativeClientExecute", "(" TD_FUNCTION ")" TD_OBJECT, Client_nativeClientExecute);
   register_method(client_class, "nativeClientSetLogMessageHandler", "(IL" PACKAGE_NAME "/Client$LogMessageHandler;)V",
                   Client_nativeClientSetLogMessageHandler);
@@ -9,6 +9,8 @@
 #include "td/utils/port/platform.h"
 
 #if (TD_DARWIN || TD_LINUX) && defined(USE_MEMPROF)
+#include "td/utils/AllocationTag.h"
+
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
@@ -27,6 +29,11 @@ bool is_memprof_on() {
   return true;
 }
 
+static const bool is_allocation_tag_enabled = [] {
+  td::AllocationTag::set_enabled(true);
+  return true;
+}();
+
 #define my_assert(f) \
   if (!(f)) {        \
     std::abort();    \
@@ -127,6 +134,7 @@ struct malloc_info {
   std::int32_t magic;
   std::int32_t size;
   std::int32_t ht_pos;
+  std::int32_t tag;
 };
 
 static std::uint64_t get_hash(const Backtrace &bt) {
@@ -202,6 +210,7 @@ void dump_alloc(const std::function<void(const AllocInfo &)> &func) {
 
 void register_xalloc(malloc_info *info, std::int32_t diff) {
   my_assert(info->size >= 0);
+  td::AllocationTag::on_memory_allocated(info->tag, diff > 0 ? info->size : -static_cast<std::int64_t>(info->size));
   if (diff > 0) {
     ht[info->ht_pos].size.fetch_add(info->size, std::memory_order_relaxed);
   } else {
@@ -228,6 +237,7 @@ static void *malloc_with_frame(std::size_t size, const Backtrace &frame) {
   info->magic = MALLOC_INFO_MAGIC;
   info->size = static_cast<std::int32_t>(size);
   info->ht_pos = get_ht_pos(frame);
+  info->tag = td::AllocationTag::get_current_tag();
 
   register_xalloc(info, +1);
 
@@ -13,6 +13,7 @@
 #include "td/tl/tl_config.h"
 #include "td/tl/tl_generate.h"
 
+#include <cstdlib>
 #include <string>
 #include <vector>
 
@@ -20,10 +21,11 @@ template <bool generate_multiple_headers = false, class WriterCpp = td::TD_TL_wr
           class WriterH = td::TD_TL_writer_h, class WriterHpp = td::TD_TL_writer_hpp>
 static void generate_cpp(const std::string &directory, const std::string &tl_name, const std::string &string_type,
                          const std::string &bytes_type, const std::vector<std::string> &ext_cpp_includes,
-                         const std::vector<std::string> &ext_h_includes) {
+                         const std::vector<std::string> &ext_h_includes, int cpp_part_count = 1) {
   std::string path = directory + "/" + tl_name;
   td::tl::tl_config config = td::tl::read_tl_config_from_file("tlo/" + tl_name + ".tlo");
-  td::tl::write_tl_to_file(config, path + ".cpp", WriterCpp(tl_name, string_type, bytes_type, ext_cpp_includes));
+  td::tl::write_tl_to_split_files(config, path, ".cpp", cpp_part_count,
+                                  WriterCpp(tl_name, string_type, bytes_type, ext_cpp_includes));
   if (generate_multiple_headers) {
     td::tl::write_tl_to_multiple_files(config, path, ".h", WriterH(tl_name, string_type, bytes_type, ext_h_includes));
   } else {
@@ -32,17 +34,26 @@ static void generate_cpp(const std::string &directory, const std::string &tl_nam
   td::tl::write_tl_to_file(config, path + ".hpp", WriterHpp(tl_name, string_type, bytes_type));
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+  // the largest generated source files can be split into several translation units to speed up their compilation
+  int part_count = argc > 1 ? std::atoi(argv[1]) : 1;
+  if (part_count < 1) {
+    part_count = 1;
+  }
+
   generate_cpp<>("td/telegram", "telegram_api", "std::string", "BufferSlice",
-                 {"\"td/tl/tl_object_parse.h\"", "\"td/tl/tl_object_store.h\""}, {"\"td/utils/buffer.h\""});
+                 {"\"td/tl/tl_object_parse.h\"", "\"td/tl/tl_object_store.h\""},
+                 {"\"td/utils/buffer.h\"", "\"td/utils/SmallObjectAllocator.h\""}, part_count);
 
   generate_cpp<>("td/telegram", "secret_api", "std::string", "BufferSlice",
                  {"\"td/tl/tl_object_parse.h\"", "\"td/tl/tl_object_store.h\""}, {"\"td/utils/buffer.h\""});
 
 #ifdef TD_ENABLE_JNI
   generate_cpp<false, td::TD_TL_writer_jni_cpp, td::TD_TL_writer_jni_h>(
-      "td/telegram", "td_api", "std::string", "std::string", {"\"td/tl/tl_jni_object.h\""}, {"<string>"});
+      "td/telegram", "td_api", "std::string", "std::string", {"\"td/tl/tl_jni_object.h\""}, {"<string>"},
+      part_count);
 #else
-  generate_cpp<>("td/telegram", "td_api", "std::string", "std::string", {}, {"<string>"});
+  generate_cpp<>("td/telegram", "td_api", "std::string", "std::string", {"\"td/tl/tl_object_store.h\""},
+                 {"<string>"}, part_count);
 #endif
 }
@@ -31,12 +31,15 @@ void gen_to_json_constructor(StringBuilder &sb, const T *constructor, bool is_he
   }
   sb << " {\n";
   sb << "  auto jo = jv.enter_object();\n";
-  sb << "  jo(\"@type\", \"" << tl::simple::gen_cpp_name(constructor->name) << "\");\n";
+  // keys and type names are known in advance and don't need to be escaped
+  sb << "  jo(JsonRaw(\"\\\"@type\\\"\"), JsonRaw(\"\\\"" << tl::simple::gen_cpp_name(constructor->name)
+     << "\\\"\"));\n";
   for (auto &arg : constructor->args) {
     auto field_name = tl::simple::gen_cpp_field_name(arg.name);
     bool is_custom = arg.type->type == tl::simple::Type::Custom;
 
     auto object = PSTRING() << "object." << field_name;
+    auto key = PSTRING() << "JsonRaw(\"\\\"" << arg.name << "\\\"\")";
     if (is_custom) {
       sb << "  if (" << object << ") {\n  ";
     }
@@ -51,11 +54,11 @@ void gen_to_json_constructor(StringBuilder &sb, const T *constructor, bool is_he
       object = PSTRING() << "JsonVectorInt64{" << object << "}";
     }
     if (is_custom) {
-      sb << "  jo(\"" << arg.name << "\", ToJson(*" << object << "));\n";
+      sb << "  jo(" << key << ", ToJson(*" << object << "));\n";
     } else if (arg.type->type == tl::simple::Type::Int64 || arg.type->type == tl::simple::Type::Vector) {
-      sb << "  jo(\"" << arg.name << "\", ToJson(" << object << "));\n";
+      sb << "  jo(" << key << ", ToJson(" << object << "));\n";
     } else {
-      sb << "  jo(\"" << arg.name << "\", " << object << ");\n";
+      sb << "  jo(" << key << ", " << object << ");\n";
     }
     if (is_custom) {
       sb << "  }\n";
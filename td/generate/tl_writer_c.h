@@ -49,8 +49,8 @@ class TlWriterCCommon final : public tl::TL_writer {
     return {};
   }
   std::vector<std::string> get_additional_functions() const final {
-    return {"TdConvertToInternal", "TdConvertFromInternal", "TdSerialize",    "TdToString",
-            "TdDestroyObject",     "TdStackStorer",         "TdStackFetcher", "enum"};
+    return {"TdConvertToInternal", "TdConvertFromInternal", "TdSerialize",    "TdToString", "TdDestroyObject",
+            "TdStackStorer",       "TdStackFetcher",        "TdHandleGetter", "enum"};
   }
   int get_storer_type(const tl::tl_combinator *t, const std::string &name) const final {
     return name == "to_string" || name == "to_cpp_string";
@@ -255,6 +255,7 @@ class TlWriterCCommon final : public tl::TL_writer {
              "TDC_VECTOR(Long,long long)\n"
              "TDC_VECTOR(String,char *)\n"
              "TDC_VECTOR(Bytes,struct TdBytes)\n"
+             "struct TdHandle;\n"
              "struct TdStackStorerMethods {\n"
              "  void (*pack_string)(const char *s);\n"
              "  void (*pack_bytes)(const unsigned char *s, int len);\n"
@@ -516,9 +517,94 @@ class TlWriterCCommon final : public tl::TL_writer {
       gen_object_fetch(ss, t, M);
       return ss.str();
     }
+    if (function_name == "TdHandleGetter" && is_header_ != -1 && !is_function) {
+      for (auto &it : t->args) {
+        gen_handle_getters(ss, t, it);
+      }
+      return ss.str();
+    }
     return ss.str();
   }
 
+  // getters read fields of a td_api object, to which a TdHandle points, directly without conversion
+  std::string gen_handle_getter_type(const tl::tl_tree_type *tree_type) const {
+    const std::string &name = tree_type->type->name;
+    if (name == "Bool" || name == "Int32") {
+      return "int ";
+    }
+    if (name == "Int53" || name == "Int64") {
+      return "long long ";
+    }
+    if (name == "Double") {
+      return "double ";
+    }
+    if (name == "String") {
+      return "const char *";
+    }
+    if (name == "Bytes") {
+      return "const unsigned char *";
+    }
+    assert(!is_built_in_complex_type(name));
+    return "const struct TdHandle *";
+  }
+
+  std::string gen_handle_getter_value(const tl::tl_tree_type *tree_type, const std::string &var) const {
+    const std::string &name = tree_type->type->name;
+    if (name == "Bool") {
+      return var + " ? 1 : 0";
+    }
+    if (name == "String") {
+      return var + ".c_str ()";
+    }
+    if (name == "Bytes") {
+      return "(*len = static_cast<int>(" + var + ".size ()), reinterpret_cast<const unsigned char *>(" + var +
+             ".data ()))";
+    }
+    if (is_built_in_simple_type(name)) {
+      return var;
+    }
+    return "reinterpret_cast<const struct TdHandle *>(static_cast<const td::td_api::Object *>(" + var + ".get ()))";
+  }
+
+  void gen_handle_getter(std::stringstream &ss, const std::string &return_type, const std::string &function_name,
+                         const std::string &parameters, const std::string &native_class_name,
+                         const std::string &value) const {
+    ss << return_type << function_name << " (const struct TdHandle *handle" << parameters << ")";
+    if (is_header_ == 1) {
+      ss << ";\n";
+      return;
+    }
+    ss << " {\n"
+       << "  const auto &object = static_cast<const td::td_api::" << native_class_name
+       << " &>(*reinterpret_cast<const td::td_api::Object *>(handle));\n"
+       << "  return " << value << ";\n"
+       << "}\n";
+  }
+
+  void gen_handle_getters(std::stringstream &ss, const tl::tl_combinator *t, const tl::arg &a) const {
+    auto function_name = "Td" + gen_class_name(t->name) + "Get" + to_CamelCase(a.name);
+    auto native_class_name = gen_native_class_name(t->name);
+    std::string var = "object." + gen_native_field_name(a.name);
+    std::string parameters;
+    std::string count_suffix = "Count";
+    const tl::tl_tree_type *tree_type = static_cast<const tl::tl_tree_type *>(a.type);
+    for (int depth = 0; is_built_in_complex_type(tree_type->type->name); depth++) {
+      // vector elements are accessed by their indices, one for each nesting level
+      gen_handle_getter(ss, "int ", function_name + count_suffix, parameters, native_class_name,
+                        "static_cast<int>(" + var + ".size ())");
+      count_suffix = "Element" + count_suffix;
+      auto index = "i" + int_to_string(depth);
+      parameters += ", int " + index;
+      var += "[" + index + "]";
+      tree_type = static_cast<const tl::tl_tree_type *>(tree_type->children[0]);
+    }
+    if (tree_type->type->name == "Bytes") {
+      parameters += ", int *len";
+    }
+    gen_handle_getter(ss, gen_handle_getter_type(tree_type), function_name, parameters, native_class_name,
+                      gen_handle_getter_value(tree_type, var));
+  }
+
   struct file_store_methods {
     file_store_methods() = default;
     file_store_methods(const file_store_methods &) = delete;
@@ -1103,6 +1189,9 @@ class TlWriterCCommon final : public tl::TL_writer {
     if (is_header_ == 1 && function_name == "TdConvertToInternal" && type != nullptr && !is_function) {
       ss << "};\n";
     }
+    if (function_name == "TdHandleGetter") {
+      return ss.str();
+    }
 
     if (function_name == "enum") {
       if (is_header_ != 1) {
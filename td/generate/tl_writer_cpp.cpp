@@ -375,6 +375,12 @@ std::string TD_TL_writer_cpp::gen_full_store_class_name(const tl::tl_tree_type *
 
   assert(!(t->flags & tl::FLAG_DEFAULT_CONSTRUCTOR));  // Not supported yet
 
+  if (tl_name == "td_api" && t->name != "#" && !is_built_in_simple_type(t->name) &&
+      !is_built_in_complex_type(t->name)) {
+    // TDLib API objects can be null, so they are always stored together with their constructor identifier
+    return "TlStoreBoxedNullable<" + gen_store_class_name(tree_type) + ">";
+  }
+
   if ((tree_type->flags & tl::FLAG_BARE) != 0 || t->name == "#" || t->name == "Bool") {
     return gen_store_class_name(tree_type);
   }
@@ -265,9 +265,20 @@ std::string TD_TL_writer_h::gen_forward_class_declaration(const std::string &cla
 std::string TD_TL_writer_h::gen_class_begin(const std::string &class_name, const std::string &base_class_name,
                                             bool is_proxy, const tl::tl_tree *result) const {
   if (is_proxy) {
-    return "class " + class_name + ": public " + base_class_name +
-           " {\n"
-           " public:\n";
+    std::string result = "class " + class_name + ": public " + base_class_name +
+                         " {\n"
+                         " public:\n";
+    if (tl_name == "telegram_api" && base_class_name == gen_base_tl_class_name()) {
+      // received objects are small and are created and destroyed in bulk
+      result +=
+          "  static void *operator new(std::size_t size) {\n"
+          "    return td::SmallObjectAllocator::allocate(size);\n"
+          "  }\n\n"
+          "  static void operator delete(void *ptr, std::size_t size) noexcept {\n"
+          "    td::SmallObjectAllocator::deallocate(ptr, size);\n"
+          "  }\n";
+    }
+    return result;
   }
   return "class " + class_name + " final : public " + base_class_name +
          " {\n"
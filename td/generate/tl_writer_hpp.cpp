@@ -19,13 +19,14 @@ bool TD_TL_writer_hpp::is_documentation_generated() const {
 }
 
 int TD_TL_writer_hpp::get_additional_function_type(const std::string &additional_function_name) const {
-  assert(additional_function_name == "downcast_call");
+  assert(additional_function_name == "downcast_call" || additional_function_name == "for_each_function_type");
   return 2;
 }
 
 std::vector<std::string> TD_TL_writer_hpp::get_additional_functions() const {
   std::vector<std::string> additional_functions;
   additional_functions.push_back("downcast_call");
+  additional_functions.push_back("for_each_function_type");
   return additional_functions;
 }
 
@@ -197,7 +198,7 @@ std::string TD_TL_writer_hpp::gen_fetch_switch_end() const {
 
 std::string TD_TL_writer_hpp::gen_additional_function(const std::string &function_name, const tl::tl_combinator *t,
                                                       bool is_function) const {
-  assert(function_name == "downcast_call");
+  assert(function_name == "downcast_call" || function_name == "for_each_function_type");
   return "";
 }
 
@@ -205,6 +206,22 @@ std::string TD_TL_writer_hpp::gen_additional_proxy_function_begin(const std::str
                                                                   const tl::tl_type *type,
                                                                   const std::string &class_name, int arity,
                                                                   bool is_function) const {
+  if (function_name == "for_each_function_type") {
+    if (!is_function) {
+      return "";
+    }
+    return
+#ifndef DISABLE_HPP_DOCUMENTATION
+        "/**\n"
+        " * Calls the specified function object with a null pointer to each class derived from " +
+        class_name +
+        ".\n"
+        " * \\param[in] func Function object to which the pointers will be passed.\n"
+        " */\n"
+#endif
+        "template <class T>\n"
+        "void for_each_function_type(const T &func) {\n";
+  }
   assert(function_name == "downcast_call");
   return
 #ifndef DISABLE_HPP_DOCUMENTATION
@@ -233,6 +250,12 @@ std::string TD_TL_writer_hpp::gen_additional_proxy_function_case(const std::stri
 std::string TD_TL_writer_hpp::gen_additional_proxy_function_case(const std::string &function_name,
                                                                  const tl::tl_type *type, const tl::tl_combinator *t,
                                                                  int arity, bool is_function) const {
+  if (function_name == "for_each_function_type") {
+    if (!is_function) {
+      return "";
+    }
+    return "  func(static_cast<" + gen_class_name(t->name) + " *>(nullptr));\n";
+  }
   assert(function_name == "downcast_call");
   return "    case " + gen_class_name(t->name) +
          "::ID:\n"
@@ -244,6 +267,9 @@ std::string TD_TL_writer_hpp::gen_additional_proxy_function_case(const std::stri
 
 std::string TD_TL_writer_hpp::gen_additional_proxy_function_end(const std::string &function_name,
                                                                 const tl::tl_type *type, bool is_function) const {
+  if (function_name == "for_each_function_type") {
+    return is_function ? "}\n\n" : "";
+  }
   assert(function_name == "downcast_call");
   return "    default:\n"
          "      return false;\n"
@@ -56,9 +56,14 @@ int TD_TL_writer_java::get_storer_type(const tl::tl_combinator *t, const std::st
   return 0;
 }
 
+tl::TL_writer::Mode TD_TL_writer_java::get_parser_mode(int type) const {
+  // objects are fetched only from buffers filled by TDLib, so only results of functions need to be fetched
+  return Client;
+}
+
 std::vector<std::string> TD_TL_writer_java::get_parsers() const {
   std::vector<std::string> parsers;
-  parsers.push_back("<inlined>");
+  parsers.push_back("java.nio.ByteBuffer");
   return parsers;
 }
 
@@ -208,6 +213,50 @@ std::string TD_TL_writer_java::gen_output_begin_once() const {
          "    private " +
          tl_name +
          "() {\n"
+         "    }\n\n"
+         "    private static final java.nio.charset.Charset UTF_8 = java.nio.charset.Charset.forName(\"UTF-8\");\n\n"
+         "    static byte[] fetchBytes(java.nio.ByteBuffer buffer) {\n"
+         "        byte[] result = new byte[buffer.getInt()];\n"
+         "        buffer.get(result);\n"
+         "        return result;\n"
+         "    }\n\n"
+         "    static String fetchString(java.nio.ByteBuffer buffer) {\n"
+         "        return new String(fetchBytes(buffer), UTF_8);\n"
+         "    }\n\n"
+         "    static int[] fetchIntArray(java.nio.ByteBuffer buffer) {\n"
+         "        int[] result = new int[buffer.getInt()];\n"
+         "        for (int i = 0; i < result.length; i++) {\n"
+         "            result[i] = buffer.getInt();\n"
+         "        }\n"
+         "        return result;\n"
+         "    }\n\n"
+         "    static long[] fetchLongArray(java.nio.ByteBuffer buffer) {\n"
+         "        long[] result = new long[buffer.getInt()];\n"
+         "        for (int i = 0; i < result.length; i++) {\n"
+         "            result[i] = buffer.getLong();\n"
+         "        }\n"
+         "        return result;\n"
+         "    }\n\n"
+         "    static double[] fetchDoubleArray(java.nio.ByteBuffer buffer) {\n"
+         "        double[] result = new double[buffer.getInt()];\n"
+         "        for (int i = 0; i < result.length; i++) {\n"
+         "            result[i] = buffer.getDouble();\n"
+         "        }\n"
+         "        return result;\n"
+         "    }\n\n"
+         "    static String[] fetchStringArray(java.nio.ByteBuffer buffer) {\n"
+         "        String[] result = new String[buffer.getInt()];\n"
+         "        for (int i = 0; i < result.length; i++) {\n"
+         "            result[i] = fetchString(buffer);\n"
+         "        }\n"
+         "        return result;\n"
+         "    }\n\n"
+         "    @SuppressWarnings(\"unchecked\")\n"
+         "    static <T extends Object> T[] fetchArray(java.nio.ByteBuffer buffer, T[] result) {\n"
+         "        for (int i = 0; i < result.length; i++) {\n"
+         "            result[i] = (T) Object.fetch(buffer);\n"
+         "        }\n"
+         "        return result;\n"
          "    }\n\n";
 }
 
@@ -342,7 +391,82 @@ std::string TD_TL_writer_java::gen_field_fetch(int field_num, const tl::arg &a,
 
   assert(a.var_num == -1);
   assert(a.type->get_type() == tl::NODE_TYPE_TYPE);
-  return "";
+  const tl::tl_tree_type *tree_type = static_cast<const tl::tl_tree_type *>(a.type);
+  return gen_buffer_fetch("this." + gen_field_name(a.name), tree_type, "            ", 0);
+}
+
+std::string TD_TL_writer_java::gen_buffer_fetch_expression(const tl::tl_tree_type *tree_type) const {
+  const tl::tl_type *t = tree_type->type;
+  const std::string &name = t->name;
+
+  if (name == "Bool") {
+    return "buffer.get() != 0";
+  }
+  if (name == "Int32") {
+    return "buffer.getInt()";
+  }
+  if (name == "Int53" || name == "Int64") {
+    return "buffer.getLong()";
+  }
+  if (name == "Double") {
+    return "buffer.getDouble()";
+  }
+  if (name == "String") {
+    return "fetchString(buffer)";
+  }
+  if (name == "Bytes") {
+    return "fetchBytes(buffer)";
+  }
+
+  if (name == "Vector") {
+    assert(tree_type->children.size() == 1);
+    const tl::tl_tree_type *child = static_cast<const tl::tl_tree_type *>(tree_type->children[0]);
+    const std::string &child_name = child->type->name;
+    if (child_name == "Bool" || child_name == "Bytes") {
+      assert(false);  // TODO
+    }
+    if (child_name == "Int32") {
+      return "fetchIntArray(buffer)";
+    }
+    if (child_name == "Int53" || child_name == "Int64") {
+      return "fetchLongArray(buffer)";
+    }
+    if (child_name == "Double") {
+      return "fetchDoubleArray(buffer)";
+    }
+    if (child_name == "String") {
+      return "fetchStringArray(buffer)";
+    }
+    if (child_name == "Vector") {
+      return "";
+    }
+    return "fetchArray(buffer, new " + gen_type_name(child) + "[buffer.getInt()])";
+  }
+
+  std::string class_name = gen_type_name(tree_type);
+  if (t->simple_constructors == 1) {
+    return "(" + class_name + ") Object.fetch(buffer)";
+  }
+  return class_name + ".fetch(buffer)";
+}
+
+std::string TD_TL_writer_java::gen_buffer_fetch(const std::string &target, const tl::tl_tree_type *tree_type,
+                                                const std::string &offset, int depth) const {
+  std::string expression = gen_buffer_fetch_expression(tree_type);
+  if (!expression.empty()) {
+    return offset + target + " = " + expression + ";\n";
+  }
+
+  // vector of vectors
+  const tl::tl_tree_type *child = static_cast<const tl::tl_tree_type *>(tree_type->children[0]);
+  std::string child_type_name = gen_type_name(child);
+  auto bracket_pos = child_type_name.find('[');
+  assert(bracket_pos != std::string::npos);
+  std::string index = "i" + int_to_string(depth);
+  return offset + target + " = new " + child_type_name.substr(0, bracket_pos) + "[buffer.getInt()]" +
+         child_type_name.substr(bracket_pos) + ";\n" + offset + "for (int " + index + " = 0; " + index + " < " +
+         target + ".length; " + index + "++) {\n" +
+         gen_buffer_fetch(target + "[" + index + "]", child, offset + "    ", depth + 1) + offset + "}\n";
 }
 
 std::string TD_TL_writer_java::gen_field_store(const tl::arg &a, std::vector<tl::var_description> &vars, bool flat,
@@ -388,13 +512,21 @@ std::string TD_TL_writer_java::gen_fetch_function_begin(const std::string &parse
                                                         const std::string &parent_class_name, int arity,
                                                         int field_count, std::vector<tl::var_description> &vars,
                                                         int parser_type) const {
-  return "";
+  if (parser_type == -1) {
+    return "\n"
+           "        static " +
+           class_name +
+           " fetch(java.nio.ByteBuffer buffer) {\n";
+  }
+  return "\n"
+         "        " +
+         class_name + "(java.nio.ByteBuffer buffer) {\n";
 }
 
 std::string TD_TL_writer_java::gen_fetch_function_end(bool has_parent, int field_count,
                                                       const std::vector<tl::var_description> &vars,
                                                       int parser_type) const {
-  return "";
+  return "        }\n";
 }
 
 std::string TD_TL_writer_java::gen_fetch_function_result_begin(const std::string &parser_name,
@@ -430,16 +562,26 @@ std::string TD_TL_writer_java::gen_store_function_end(const std::vector<tl::var_
 }
 
 std::string TD_TL_writer_java::gen_fetch_switch_begin() const {
-  return "";
+  return "            int constructor = buffer.getInt();\n"
+         "            if (constructor == 0) {\n"
+         "                return null;\n"
+         "            }\n"
+         "            switch (constructor) {\n";
 }
 
 std::string TD_TL_writer_java::gen_fetch_switch_case(const tl::tl_combinator *t, int arity) const {
   assert(arity == 0);
-  return "";
+  std::string class_name = gen_class_name(t->name);
+  return "                case " + class_name +
+         ".CONSTRUCTOR:\n"
+         "                    return new " +
+         class_name + "(buffer);\n";
 }
 
 std::string TD_TL_writer_java::gen_fetch_switch_end() const {
-  return "";
+  return "                default:\n"
+         "                    throw new IllegalArgumentException(\"Unknown constructor \" + constructor);\n"
+         "            }\n";
 }
 
 std::string TD_TL_writer_java::gen_constructor_begin(int field_count, const std::string &class_name,
@@ -23,6 +23,11 @@ class TD_TL_writer_java final : public tl::TL_writer {
 
   const std::string package_name;
 
+  std::string gen_buffer_fetch_expression(const tl::tl_tree_type *tree_type) const;
+
+  std::string gen_buffer_fetch(const std::string &target, const tl::tl_tree_type *tree_type, const std::string &offset,
+                               int depth) const;
+
  public:
   TD_TL_writer_java(const std::string &tl_name, const std::string &package_name)
       : TL_writer(tl_name), package_name(package_name) {
@@ -37,6 +42,7 @@ class TD_TL_writer_java final : public tl::TL_writer {
 
   int get_parser_type(const tl::tl_combinator *t, const std::string &parser_name) const final;
   int get_storer_type(const tl::tl_combinator *t, const std::string &storer_name) const final;
+  Mode get_parser_mode(int type) const final;
   std::vector<std::string> get_parsers() const final;
   std::vector<std::string> get_storers() const final;
 
@@ -32,6 +32,16 @@ int TD_TL_writer_jni_cpp::get_parser_type(const tl::tl_combinator *t, const std:
   return 1;
 }
 
+int TD_TL_writer_jni_cpp::get_storer_type(const tl::tl_combinator *t, const std::string &storer_name) const {
+  if (storer_name == "TlStorerToString") {
+    return 1;
+  }
+  if (storer_name == "TlStorerCalcLength" || storer_name == "TlStorerUnsafe") {
+    return 2;
+  }
+  return 0;
+}
+
 int TD_TL_writer_jni_cpp::get_additional_function_type(const std::string &additional_function_name) const {
   return 1;
 }
@@ -46,6 +56,8 @@ std::vector<std::string> TD_TL_writer_jni_cpp::get_storers() const {
   std::vector<std::string> storers;
   storers.push_back("JNIEnv *env, jobject");
   storers.push_back("TlStorerToString");
+  storers.push_back("TlStorerCalcLength");
+  storers.push_back("TlStorerUnsafe");
   return storers;
 }
 
@@ -287,6 +299,10 @@ std::string TD_TL_writer_jni_cpp::gen_type_store(const std::string &field_name,
 
   assert(!(t->flags & tl::FLAG_DEFAULT_CONSTRUCTOR));
 
+  if (storer_type == 2) {
+    return "jni::store_to_buffer(s, " + field_name + ");";
+  }
+
   if (!(tree_type->flags & tl::FLAG_BARE)) {
     if (storer_type == 0) {
       if (is_type_bare(t)) {
@@ -467,6 +483,9 @@ std::string TD_TL_writer_jni_cpp::gen_store_function_begin(const std::string &st
   if (storer_type == -1) {
     return "";
   }
+  if (storer_type == 2) {
+    return TD_TL_writer_cpp::gen_store_function_begin(storer_name, class_name, arity, vars, 0);
+  }
 
   assert(arity == 0);
   return "\n"
@@ -481,6 +500,11 @@ std::string TD_TL_writer_jni_cpp::gen_store_function_begin(const std::string &st
                                  get_pretty_class_name(class_name) + "\");\n");
 }
 
+std::string TD_TL_writer_jni_cpp::gen_store_function_end(const std::vector<tl::var_description> &vars,
+                                                         int storer_type) const {
+  return TD_TL_writer_cpp::gen_store_function_end(vars, storer_type == 2 ? 0 : storer_type);
+}
+
 std::string TD_TL_writer_jni_cpp::gen_fetch_switch_begin() const {
   return "  if (p == nullptr) { return nullptr; }\n"
          "  switch (env->CallIntMethod(p, jni::GetConstructorID)) {\n";
@@ -46,6 +46,7 @@ class TD_TL_writer_jni_cpp final : public TD_TL_writer_cpp {
   bool is_built_in_complex_type(const std::string &name) const final;
 
   int get_parser_type(const tl::tl_combinator *t, const std::string &parser_name) const final;
+  int get_storer_type(const tl::tl_combinator *t, const std::string &storer_name) const final;
   int get_additional_function_type(const std::string &additional_function_name) const final;
   std::vector<std::string> get_parsers() const final;
   std::vector<std::string> get_storers() const final;
@@ -88,6 +89,7 @@ class TD_TL_writer_jni_cpp final : public TD_TL_writer_cpp {
 
   std::string gen_store_function_begin(const std::string &storer_name, const std::string &class_name, int arity,
                                        std::vector<tl::var_description> &vars, int storer_type) const final;
+  std::string gen_store_function_end(const std::vector<tl::var_description> &vars, int storer_type) const final;
 
   std::string gen_fetch_switch_begin() const final;
   std::string gen_fetch_switch_case(const tl::tl_combinator *t, int arity) const final;
@@ -40,6 +40,8 @@ std::vector<std::string> TD_TL_writer_jni_h::get_storers() const {
   std::vector<std::string> storers;
   storers.push_back("JNIEnv *env, jobject");
   storers.push_back("TlStorerToString");
+  storers.push_back("TlStorerCalcLength");
+  storers.push_back("TlStorerUnsafe");
   return storers;
 }
 
@@ -71,7 +73,8 @@ std::string TD_TL_writer_jni_h::gen_output_begin(const std::string &additional_i
          "#include <jni.h>\n\n" +
          ext_include_str + "\n" + additional_imports +
 
-         "namespace td {\n" + forward_declaration("TlStorerToString") +
+         "namespace td {\n" + forward_declaration("TlStorerCalcLength") + forward_declaration("TlStorerToString") +
+         forward_declaration("TlStorerUnsafe") +
          "\n"
          "namespace " +
          tl_name + " {\n\n";
@@ -103,6 +106,10 @@ std::string TD_TL_writer_jni_h::gen_class_begin(const std::string &class_name, c
            "  virtual void store(JNIEnv *env, jobject &s) const {\n"
            "  }\n\n"
            "  virtual void store(TlStorerToString &s, const char *field_name) const = 0;\n\n"
+           "  virtual void store(TlStorerCalcLength &s) const {\n"
+           "  }\n\n"
+           "  virtual void store(TlStorerUnsafe &s) const {\n"
+           "  }\n\n"
            "  static jclass Class;\n";
   }
   return TD_TL_writer_h::gen_class_begin(class_name, base_class_name, is_proxy, result) + "  static jclass Class;\n";
@@ -144,6 +144,8 @@ class RawConnectionDefault final : public RawConnection {
 
   ConnectionManager::ConnectionToken connection_token_;
 
+  size_t expected_packet_size_ = 0;
+
   void on_read(size_t size, Callback &callback) {
     if (size <= 0) {
       return;
@@ -155,7 +157,17 @@ class RawConnectionDefault final : public RawConnection {
     callback.on_read(size);
   }
 
+  void reserve_input_buffer() {
+    // large packets are read into a contiguous buffer with a space for the next packets of the same size,
+    // so they can be cut from the stream and passed to the caller without copying
+    constexpr size_t MIN_RESERVED_PACKET_SIZE = 1 << 14;
+    if (expected_packet_size_ >= MIN_RESERVED_PACKET_SIZE) {
+      socket_fd_.reserve_input_buffer(2 * expected_packet_size_);
+    }
+  }
+
   Status flush_read(const AuthKey &auth_key, Callback &callback) {
+    reserve_input_buffer();
     auto r = socket_fd_.flush_read();
     if (r.is_ok()) {
       on_read(r.ok(), callback);
@@ -169,6 +181,7 @@ class RawConnectionDefault final : public RawConnection {
         if (wait_size > MAX_PACKET_SIZE) {
           return Status::Error(PSLICE() << "Expected packet size is too big: " << wait_size);
         }
+        expected_packet_size_ = max(expected_packet_size_, wait_size);
         break;
       }
       if (quick_ack != 0) {
@@ -176,6 +189,8 @@ class RawConnectionDefault final : public RawConnection {
         continue;
       }
 
+      expected_packet_size_ = packet.size();
+
       auto old_pointer = packet.as_slice().ubegin();
       if (!is_aligned_pointer<4>(old_pointer)) {
         BufferSlice new_packet(packet.size());
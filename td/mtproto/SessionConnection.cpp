@@ -12,6 +12,7 @@
 #include "td/mtproto/mtproto_api.h"
 #include "td/mtproto/mtproto_api.hpp"
 #include "td/mtproto/PacketStorer.h"
+#include "td/mtproto/SessionConnectionStats.h"
 #include "td/mtproto/Transport.h"
 #include "td/mtproto/utils.h"
 
@@ -351,6 +352,7 @@ Status SessionConnection::on_packet(const MsgInfo &info,
       LOG(WARNING) << bad_info << ": MessageId is too high. Session will be closed";
       // All this queries will be re-sent by parent
       to_send_.clear();
+      to_send_size_ = 0;
       reset_server_time_difference(info.message_id);
       callback_->on_session_failed(Status::Error("MessageId is too high"));
       return Status::Error("MessageId is too high");
@@ -802,11 +804,13 @@ void SessionConnection::do_close(Status status) {
   callback_->on_closed(std::move(status));
 }
 
-void SessionConnection::send_crypto(const Storer &storer, uint64 quick_ack_token) {
+size_t SessionConnection::send_crypto(const Storer &storer, uint64 quick_ack_token) {
   CHECK(state_ != Closed);
-  last_write_size_ += raw_connection_->send_crypto(storer, auth_data_->get_session_id(),
-                                                   auth_data_->get_server_salt(Time::now_cached()),
-                                                   auth_data_->get_auth_key(), quick_ack_token);
+  auto size = raw_connection_->send_crypto(storer, auth_data_->get_session_id(),
+                                           auth_data_->get_server_salt(Time::now_cached()), auth_data_->get_auth_key(),
+                                           quick_ack_token);
+  last_write_size_ += size;
+  return size;
 }
 
 Result<MessageId> SessionConnection::send_query(BufferSlice buffer, bool gzip_flag, MessageId message_id,
@@ -817,10 +821,15 @@ Result<MessageId> SessionConnection::send_query(BufferSlice buffer, bool gzip_fl
   }
   auto seq_no = auth_data_->next_seq_no(true);
   if (to_send_.empty()) {
-    send_before(Time::now_cached() + QUERY_DELAY);
+    send_before(Time::now_cached() + get_query_delay());
   }
   to_send_.push_back(MtprotoQuery{message_id, seq_no, std::move(buffer), gzip_flag, std::move(invoke_after_message_ids),
                                   use_quick_ack});
+  to_send_size_ += to_send_.back().packet.size();
+  if (to_send_.size() >= MAX_CONTAINER_QUERY_COUNT || to_send_size_ >= MAX_CONTAINER_SIZE) {
+    // the container is full, so there is no reason to wait for more queries
+    send_before(Time::now_cached());
+  }
   VLOG(mtproto) << "Invoke query with " << message_id << " and seq_no " << seq_no << " of size "
                 << to_send_.back().packet.size() << " after " << invoke_after_message_ids
                 << (use_quick_ack ? " with quick ack" : "");
@@ -884,10 +893,27 @@ void SessionConnection::force_ack() {
   }
 }
 
+bool SessionConnection::is_busy() const {
+  return average_packet_interval_ < BUSY_PACKET_INTERVAL && last_packet_sent_at_ + IDLE_DELAY > Time::now_cached();
+}
+
+double SessionConnection::get_query_delay() const {
+  // send queries immediately if nothing was sent for a long time, and collect them into larger containers
+  // for a small part of RTT if the connection is busy
+  if (last_packet_sent_at_ + IDLE_DELAY < Time::now_cached()) {
+    return 0.0;
+  }
+  if (!is_busy()) {
+    return QUERY_DELAY;
+  }
+  return clamp(raw_connection_->extra().rtt * 0.05, QUERY_DELAY, MAX_QUERY_DELAY);
+}
+
 void SessionConnection::send_ack(MessageId message_id) {
   VLOG(mtproto) << "Send ack for " << message_id;
   if (to_ack_message_ids_.empty()) {
     send_before(Time::now_cached() + ACK_DELAY);
+    first_ack_at_ = Time::now_cached();
   }
   // an easiest way to eliminate duplicated acknowledgements for gzipped packets
   if (to_ack_message_ids_.empty() || to_ack_message_ids_.back() != message_id) {
@@ -895,7 +921,8 @@ void SessionConnection::send_ack(MessageId message_id) {
 
     constexpr size_t MAX_UNACKED_PACKETS = 100;
     if (to_ack_message_ids_.size() >= MAX_UNACKED_PACKETS) {
-      send_before(Time::now_cached());
+      // if the connection is busy, then the acknowledgements can wait for the next queries
+      send_before(Time::now_cached() + (is_busy() ? get_query_delay() : 0.0));
     }
   }
 }
@@ -945,19 +972,20 @@ void SessionConnection::flush_packet() {
     }
   }
 
-  static constexpr size_t MAX_QUERY_COUNT = 1000;
   size_t send_till = 0;
   size_t send_size = 0;
   if (has_salt) {
-    // send at most MAX_QUERY_COUNT queries, of total size up to 2^15
-    while (send_till < to_send_.size() && send_till < MAX_QUERY_COUNT && send_size < (1 << 15)) {
+    // send at most MAX_CONTAINER_QUERY_COUNT queries, of total size up to MAX_CONTAINER_SIZE
+    while (send_till < to_send_.size() && send_till < MAX_CONTAINER_QUERY_COUNT && send_size < MAX_CONTAINER_SIZE) {
       send_size += to_send_[send_till].packet.size();
       send_till++;
     }
   }
   vector<MtprotoQuery> queries;
+  to_send_size_ -= send_size;
   if (send_till == to_send_.size()) {
     queries = std::move(to_send_);
+    to_send_size_ = 0;
   } else if (send_till != 0) {
     queries.reserve(send_till);
     std::move(to_send_.begin(), to_send_.begin() + send_till, std::back_inserter(queries));
@@ -1005,11 +1033,14 @@ void SessionConnection::flush_packet() {
   // no more than 8192 message identifiers per container..
   auto to_resend_answer = cut_tail(to_resend_answer_message_ids_, 8192, "resend_answer");
   MessageId resend_answer_message_id;
-  CHECK(queries.size() <= MAX_QUERY_COUNT);
-  auto to_cancel_answer = cut_tail(to_cancel_answer_message_ids_, MAX_QUERY_COUNT - queries.size(), "cancel_answer");
+  CHECK(queries.size() <= MAX_CONTAINER_QUERY_COUNT);
+  auto to_cancel_answer =
+      cut_tail(to_cancel_answer_message_ids_, MAX_CONTAINER_QUERY_COUNT - queries.size(), "cancel_answer");
   auto to_get_state_info = cut_tail(to_get_state_info_message_ids_, 8192, "get_state_info");
   MessageId get_state_info_message_id;
+  auto ack_delay = to_ack_message_ids_.empty() ? 0.0 : Time::now_cached() - first_ack_at_;
   auto to_ack = cut_tail(to_ack_message_ids_, 8192, "ack");
+  auto ack_count = to_ack.size();
   MessageId ping_message_id;
 
   bool use_quick_ack = any_of(queries, [](const auto &query) { return query.use_quick_ack; });
@@ -1024,7 +1055,18 @@ void SessionConnection::flush_packet() {
         &ping_message_id, &parent_message_id);
 
     auto quick_ack_token = use_quick_ack ? parent_message_id.get() : 0;
-    send_crypto(storer, quick_ack_token);
+    auto packet_size = send_crypto(storer, quick_ack_token);
+    SessionConnectionStats::on_packet_sent(queries.size(), packet_size, ack_count, ack_delay);
+  }
+
+  auto now = Time::now_cached();
+  if (last_packet_sent_at_ != 0) {
+    auto packet_interval = min(now - last_packet_sent_at_, IDLE_DELAY);
+    average_packet_interval_ = 0.9 * average_packet_interval_ + 0.1 * packet_interval;
+  }
+  last_packet_sent_at_ = now;
+  if (!to_ack_message_ids_.empty()) {
+    first_ack_at_ = now;
   }
 
   if (resend_answer_message_id != MessageId()) {
@@ -118,9 +118,14 @@ class SessionConnection final
   void force_close(SessionConnection::Callback *callback);
 
  private:
-  static constexpr int ACK_DELAY = 30;                  // 30s
-  static constexpr double QUERY_DELAY = 0.001;          // 0.001s
-  static constexpr double RESEND_ANSWER_DELAY = 0.001;  // 0.001s
+  static constexpr int ACK_DELAY = 30;                   // 30s
+  static constexpr double QUERY_DELAY = 0.001;           // 0.001s
+  static constexpr double MAX_QUERY_DELAY = 0.01;        // 0.01s
+  static constexpr double RESEND_ANSWER_DELAY = 0.001;   // 0.001s
+  static constexpr double IDLE_DELAY = 1.0;              // 1s
+  static constexpr double BUSY_PACKET_INTERVAL = 0.01;   // 0.01s
+  static constexpr size_t MAX_CONTAINER_QUERY_COUNT = 1000;
+  static constexpr size_t MAX_CONTAINER_SIZE = 1 << 15;
 
   struct MsgInfo {
     MessageId message_id;
@@ -161,9 +166,14 @@ class SessionConnection final
   static constexpr int HTTP_MAX_DELAY = 30;  // 0.03s
 
   vector<MtprotoQuery> to_send_;
+  size_t to_send_size_ = 0;
   vector<MessageId> to_ack_message_ids_;
+  double first_ack_at_ = 0;
   double force_send_at_ = 0;
 
+  double last_packet_sent_at_ = 0;
+  double average_packet_interval_ = IDLE_DELAY;
+
   struct ServiceQuery {
     enum Type { GetStateInfo, ResendAnswer } type_;
     MessageId container_message_id_;
@@ -259,8 +269,11 @@ class SessionConnection final
 
   void do_close(Status status);
 
+  bool is_busy() const;
+  double get_query_delay() const;
+
   void send_ack(MessageId message_id);
-  void send_crypto(const Storer &storer, uint64 quick_ack_token);
+  size_t send_crypto(const Storer &storer, uint64 quick_ack_token);
   void send_before(double tm);
   bool may_ping() const;
   bool must_ping() const;
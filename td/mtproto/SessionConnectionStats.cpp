@@ -0,0 +1,60 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/mtproto/SessionConnectionStats.h"
+
+#include "td/utils/Time.h"
+
+#include <mutex>
+
+namespace td {
+namespace mtproto {
+
+namespace {
+
+struct StatisticsStorage {
+  std::mutex mutex;
+  SessionConnectionStats::Statistics statistics;
+  double start_time = Time::now();
+};
+
+StatisticsStorage &get_statistics_storage() {
+  static StatisticsStorage storage;
+  return storage;
+}
+
+}  // namespace
+
+void SessionConnectionStats::on_packet_sent(size_t query_count, size_t size, size_t ack_count, double ack_delay) {
+  auto &storage = get_statistics_storage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  auto &statistics = storage.statistics;
+  statistics.packet_count++;
+  statistics.query_count += query_count;
+  statistics.byte_count += size;
+  if (ack_count != 0) {
+    statistics.ack_count += ack_count;
+    statistics.ack_packet_count++;
+    statistics.total_ack_delay += ack_delay;
+    statistics.max_ack_delay = max(statistics.max_ack_delay, ack_delay);
+  }
+}
+
+SessionConnectionStats::Statistics SessionConnectionStats::get_statistics(bool reset) {
+  auto &storage = get_statistics_storage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  auto now = Time::now();
+  auto result = storage.statistics;
+  result.duration = now - storage.start_time;
+  if (reset) {
+    storage.statistics = Statistics();
+    storage.start_time = now;
+  }
+  return result;
+}
+
+}  // namespace mtproto
+}  // namespace td
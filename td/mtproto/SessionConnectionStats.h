@@ -0,0 +1,35 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+namespace td {
+namespace mtproto {
+
+// process-wide statistics about packets sent by all SessionConnections
+class SessionConnectionStats {
+ public:
+  struct Statistics {
+    double duration = 0.0;
+    uint64 packet_count = 0;
+    uint64 query_count = 0;
+    uint64 byte_count = 0;
+    uint64 ack_count = 0;
+    uint64 ack_packet_count = 0;
+    double total_ack_delay = 0.0;
+    double max_ack_delay = 0.0;
+  };
+
+  // ack_delay is the time passed since the oldest acknowledgement in the packet was scheduled
+  static void on_packet_sent(size_t query_count, size_t size, size_t ack_count, double ack_delay);
+
+  static Statistics get_statistics(bool reset);
+};
+
+}  // namespace mtproto
+}  // namespace td
@@ -125,14 +125,15 @@ void ObfuscatedTransport::init(ChainBufferReader *input, ChainBufferWriter *outp
     }
   };
   fix_key(key);
-  aes_ctr_byte_flow_.init(key, as<UInt128>(rheader.data() + 8 + 32));
   if (secret_.emulate_tls()) {
+    tls_reader_byte_flow_.init(key, as<UInt128>(rheader.data() + 8 + 32));
     tls_reader_byte_flow_.set_input(input_);
-    tls_reader_byte_flow_ >> aes_ctr_byte_flow_;
+    tls_reader_byte_flow_ >> byte_flow_sink_;
   } else {
+    aes_ctr_byte_flow_.init(key, as<UInt128>(rheader.data() + 8 + 32));
     aes_ctr_byte_flow_.set_input(input_);
+    aes_ctr_byte_flow_ >> byte_flow_sink_;
   }
-  aes_ctr_byte_flow_ >> byte_flow_sink_;
 
   output_key_ = as<UInt256>(header.data() + 8);
   fix_key(output_key_);
@@ -167,7 +168,7 @@ void ObfuscatedTransport::do_write_main(BufferWriter &&message) {
     builder.prepend(header_);
     header_ = {};
   }
-  do_write(builder.extract());
+  do_write(std::move(builder));
 }
 
 void ObfuscatedTransport::do_write_tls(BufferWriter &&message) {
@@ -209,11 +210,12 @@ void ObfuscatedTransport::do_write_tls(BufferBuilder &&builder) {
     builder.prepend(first_prefix);
   }
 
-  do_write(builder.extract());
+  do_write(std::move(builder));
 }
 
-void ObfuscatedTransport::do_write(BufferSlice &&message) {
-  output_->append(std::move(message));
+void ObfuscatedTransport::do_write(BufferBuilder &&builder) {
+  // parts of the packet are appended separately without concatenation and are sent by a single writev
+  std::move(builder).for_each([&](BufferSlice slice) { output_->append(std::move(slice)); });
 }
 
 }  // namespace tcp
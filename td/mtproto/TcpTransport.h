@@ -154,7 +154,7 @@ class ObfuscatedTransport final : public IStreamTransport {
   ProxySecret secret_;
   std::string header_;
   IntermediateTransport impl_;
-  TlsReaderByteFlow tls_reader_byte_flow_;
+  TlsAesCtrReaderByteFlow tls_reader_byte_flow_;
   AesCtrByteFlow aes_ctr_byte_flow_;
   ByteFlowSink byte_flow_sink_;
   ChainBufferReader *input_ = nullptr;
@@ -171,7 +171,7 @@ class ObfuscatedTransport final : public IStreamTransport {
   void do_write_tls(BufferWriter &&message);
   void do_write_tls(BufferBuilder &&builder);
   void do_write_main(BufferWriter &&message);
-  void do_write(BufferSlice &&message);
+  void do_write(BufferBuilder &&builder);
 };
 
 using Transport = ObfuscatedTransport;
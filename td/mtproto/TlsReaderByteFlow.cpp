@@ -36,5 +36,45 @@ bool TlsReaderByteFlow::loop() {
   return true;
 }
 
+bool TlsAesCtrReaderByteFlow::loop() {
+  bool result = false;
+  while (true) {
+    if (left_record_size_ == 0) {
+      if (input_->size() < 5) {
+        set_need_size(5);
+        break;
+      }
+
+      uint8 buf[5];
+      input_->advance(5, MutableSlice(buf, 5));
+      if (Slice(buf, 3) != Slice("\x17\x03\x03")) {
+        close_input(Status::Error("Invalid bytes at the beginning of a packet (emulated tls)"));
+        return false;
+      }
+      left_record_size_ = (buf[3] << 8) | buf[4];
+      result = true;
+      continue;
+    }
+
+    auto ready = input_->prepare_read();
+    if (ready.empty()) {
+      break;
+    }
+    ready.truncate(left_record_size_);
+    auto size = ready.size();
+    while (!ready.empty()) {
+      auto dest = output_.prepare_append(max(left_record_size_, MIN_OUTPUT_BUFFER_SIZE));
+      dest.truncate(ready.size());
+      state_.encrypt(ready.substr(0, dest.size()), dest);
+      output_.confirm_append(dest.size());
+      ready.remove_prefix(dest.size());
+    }
+    input_->confirm_read(size);
+    left_record_size_ -= size;
+    result = true;
+  }
+  return result;
+}
+
 }  // namespace mtproto
 }  // namespace td
@@ -7,6 +7,9 @@
 #pragma once
 
 #include "td/utils/ByteFlow.h"
+#include "td/utils/common.h"
+#include "td/utils/crypto.h"
+#include "td/utils/UInt.h"
 
 namespace td {
 namespace mtproto {
@@ -16,5 +19,23 @@ class TlsReaderByteFlow final : public ByteFlowBase {
   bool loop() final;
 };
 
+// combines TlsReaderByteFlow and AesCtrByteFlow
+// record payloads are decrypted directly from the input into contiguous output buffers as soon as they are received,
+// so there are no intermediate buffers and no need to wait for the whole record
+class TlsAesCtrReaderByteFlow final : public ByteFlowBase {
+ public:
+  void init(const UInt256 &key, const UInt128 &iv) {
+    state_.init(as_slice(key), as_slice(iv));
+  }
+
+  bool loop() final;
+
+ private:
+  AesCtrState state_;
+  size_t left_record_size_ = 0;
+
+  static constexpr size_t MIN_OUTPUT_BUFFER_SIZE = 1 << 14;
+};
+
 }  // namespace mtproto
 }  // namespace td
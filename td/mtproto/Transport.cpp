@@ -145,13 +145,20 @@ size_t Transport::calc_crypto_size(size_t data_size) {
 }
 
 // MTProto v2.0
-std::pair<uint32, UInt128> Transport::calc_message_key2(const AuthKey &auth_key, int X, Slice to_encrypt) {
+void Transport::init_message_key2_state(const AuthKey &auth_key, int X, Sha256State &state) {
   // msg_key_large = SHA256 (substr (auth_key, 88+x, 32) + plaintext + random_padding);
-  Sha256State state;
   state.init();
   state.feed(Slice(auth_key.key()).substr(88 + X, 32));
+}
+
+std::pair<uint32, UInt128> Transport::calc_message_key2(const AuthKey &auth_key, int X, Slice to_encrypt) {
+  Sha256State state;
+  init_message_key2_state(auth_key, X, state);
   state.feed(to_encrypt);
+  return extract_message_key2(state);
+}
 
+std::pair<uint32, UInt128> Transport::extract_message_key2(Sha256State &state) {
   uint8 msg_key_large_raw[32];
   MutableSlice msg_key_large(msg_key_large_raw, sizeof(msg_key_large_raw));
   state.extract(msg_key_large, true);
@@ -238,7 +245,14 @@ Status Transport::read_crypto_impl(int X, MutableSlice message, const AuthKey &a
     KDF2(auth_key.key(), header->message_key, X, &aes_key, &aes_iv);
   }
 
-  aes_ige_decrypt(as_slice(aes_key), as_mutable_slice(aes_iv), to_decrypt, to_decrypt);
+  Sha256State message_key_state;
+  if (packet_info->version == 1) {
+    aes_ige_decrypt(as_slice(aes_key), as_mutable_slice(aes_iv), to_decrypt, to_decrypt);
+  } else {
+    // hash the plaintext while decrypting to read the message from memory only once
+    init_message_key2_state(auth_key, X, message_key_state);
+    aes_ige_decrypt_sha256(as_slice(aes_key), as_mutable_slice(aes_iv), to_decrypt, to_decrypt, message_key_state);
+  }
 
   size_t tail_size = message.end() - reinterpret_cast<char *>(header->data);
   if (tail_size < sizeof(PrefixT)) {
@@ -258,7 +272,7 @@ Status Transport::read_crypto_impl(int X, MutableSlice message, const AuthKey &a
     auto check_size = data_size * (1 - is_length_bad) + tail_size * is_length_bad;
     std::tie(packet_info->message_ack, real_message_key) = calc_message_ack_and_key(*header, check_size);
   } else {
-    std::tie(packet_info->message_ack, real_message_key) = calc_message_key2(auth_key, X, to_decrypt);
+    std::tie(packet_info->message_ack, real_message_key) = extract_message_key2(message_key_state);
   }
 
   int is_key_bad = false;
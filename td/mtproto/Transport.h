@@ -20,6 +20,8 @@
 
 namespace td {
 
+class Sha256State;
+
 extern int VERBOSITY_NAME(raw_mtproto);
 
 namespace mtproto {
@@ -100,6 +102,10 @@ class Transport {
   template <class HeaderT>
   static std::pair<uint32, UInt128> calc_message_ack_and_key(const HeaderT &head, size_t data_size);
 
+  static void init_message_key2_state(const AuthKey &auth_key, int X, Sha256State &state);
+
+  static std::pair<uint32, UInt128> extract_message_key2(Sha256State &state);
+
   template <class HeaderT>
   static size_t calc_crypto_size(size_t data_size);
 
@@ -0,0 +1,16 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+namespace td {
+
+// frequently used boolean and integer options, which can be read from any thread without name lookup and locking
+enum class CachedOption : int32 { IsPremium, MyId, PreferIpv6, SessionCount, UseQuickAck, Size };
+
+}  // namespace td
@@ -89,6 +89,14 @@ ChannelParticipantFilter::ChannelParticipantFilter(const tl_object_ptr<td_api::S
   }
 }
 
+bool operator==(const ChannelParticipantFilter &lhs, const ChannelParticipantFilter &rhs) {
+  return lhs.type_ == rhs.type_ && lhs.query_ == rhs.query_ && lhs.top_thread_message_id_ == rhs.top_thread_message_id_;
+}
+
+bool operator!=(const ChannelParticipantFilter &lhs, const ChannelParticipantFilter &rhs) {
+  return !(lhs == rhs);
+}
+
 StringBuilder &operator<<(StringBuilder &string_builder, const ChannelParticipantFilter &filter) {
   switch (filter.type_) {
     case ChannelParticipantFilter::Type::Recent:
@@ -21,6 +21,8 @@ class ChannelParticipantFilter {
   string query_;
   MessageId top_thread_message_id_;
 
+  friend bool operator==(const ChannelParticipantFilter &lhs, const ChannelParticipantFilter &rhs);
+
   friend StringBuilder &operator<<(StringBuilder &string_builder, const ChannelParticipantFilter &filter);
 
  public:
@@ -57,6 +59,10 @@ class ChannelParticipantFilter {
   }
 };
 
+bool operator==(const ChannelParticipantFilter &lhs, const ChannelParticipantFilter &rhs);
+
+bool operator!=(const ChannelParticipantFilter &lhs, const ChannelParticipantFilter &rhs);
+
 StringBuilder &operator<<(StringBuilder &string_builder, const ChannelParticipantFilter &filter);
 
 }  // namespace td
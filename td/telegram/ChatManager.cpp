@@ -22,6 +22,7 @@
 #include "td/telegram/InputGroupCallId.h"
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/logevent/LogEventHelper.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageSender.h"
 #include "td/telegram/MessagesManager.h"
 #include "td/telegram/MessageTtl.h"
@@ -4333,12 +4334,48 @@ void ChatManager::save_channel_to_database_impl(Channel *c, ChannelId channel_id
   c->is_being_saved = true;
   c->is_saved = true;
   LOG(INFO) << "Trying to save to database " << channel_id;
-  G()->td_db()->get_sqlite_pmc()->set(
-      get_channel_database_key(channel_id), std::move(value), PromiseCreator::lambda([channel_id](Result<> result) {
-        send_closure(G()->chat_manager(), &ChatManager::on_save_channel_to_database, channel_id, result.is_ok());
+  if (pending_saved_channels_.empty()) {
+    set_timeout_in(MAX_SAVE_TO_DATABASE_DELAY);
+  }
+  pending_saved_channels_.emplace_back(channel_id, std::move(value));
+  if (pending_saved_channels_.size() >= MAX_SAVE_TO_DATABASE_BATCH_SIZE) {
+    flush_pending_saved_channels();
+  }
+}
+
+void ChatManager::timeout_expired() {
+  flush_pending_saved_channels();
+}
+
+void ChatManager::flush_pending_saved_channels() {
+  if (pending_saved_channels_.empty()) {
+    return;
+  }
+  cancel_timeout();
+
+  FlatHashMap<string, string> key_values;
+  vector<ChannelId> channel_ids;
+  for (auto &channel : pending_saved_channels_) {
+    key_values.emplace(get_channel_database_key(channel.first), std::move(channel.second));
+    channel_ids.push_back(channel.first);
+  }
+  pending_saved_channels_.clear();
+
+  LOG(INFO) << "Save " << channel_ids.size() << " channels to database";
+  G()->td_db()->get_sqlite_pmc()->set_all(
+      std::move(key_values),
+      PromiseCreator::lambda([channel_ids = std::move(channel_ids)](Result<Unit> result) mutable {
+        send_closure(G()->chat_manager(), &ChatManager::on_save_channels_to_database, std::move(channel_ids),
+                     result.is_ok());
       }));
 }
 
+void ChatManager::on_save_channels_to_database(vector<ChannelId> channel_ids, bool success) {
+  for (auto channel_id : channel_ids) {
+    on_save_channel_to_database(channel_id, success);
+  }
+}
+
 void ChatManager::on_save_channel_to_database(ChannelId channel_id, bool success) {
   if (G()->close_flag()) {
     return;
@@ -8228,10 +8265,10 @@ void ChatManager::on_get_chat_empty(telegram_api::chatEmpty &chat, const char *s
 }
 
 void ChatManager::on_get_chat(telegram_api::chat &chat, const char *source) {
-  auto debug_str = PSTRING() << " from " << source << " in " << oneline(to_string(chat));
+  auto debug_str = PSTRING() << " from " << source;
   ChatId chat_id(chat.id_);
   if (!chat_id.is_valid()) {
-    LOG(ERROR) << "Receive invalid " << chat_id << debug_str;
+    LOG(ERROR) << "Receive invalid " << chat_id << debug_str << " in " << oneline(to_string(chat));
     return;
   }
 
@@ -8256,7 +8293,8 @@ void ChatManager::on_get_chat(telegram_api::chat &chat, const char *source) {
     switch (chat.migrated_to_->get_id()) {
       case telegram_api::inputChannelFromMessage::ID:
       case telegram_api::inputChannelEmpty::ID:
-        LOG(ERROR) << "Receive invalid information about upgraded supergroup for " << chat_id << debug_str;
+        LOG(ERROR) << "Receive invalid information about upgraded supergroup for " << chat_id << debug_str << " in "
+                   << oneline(to_string(chat));
         break;
       case telegram_api::inputChannel::ID: {
         auto input_channel = move_tl_object_as<telegram_api::inputChannel>(chat.migrated_to_);
@@ -8929,6 +8967,14 @@ tl_object_ptr<td_api::supergroupFullInfo> ChatManager::get_supergroup_full_info_
       channel_full->migrated_from_max_message_id.get());
 }
 
+void ChatManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  statistics.add_objects<Chat>("chat_manager.chats", chats_.calc_size());
+  statistics.add_objects<ChatFull>("chat_manager.chats_full", chats_full_.calc_size());
+  statistics.add_objects<MinChannel>("chat_manager.min_channels", min_channels_.calc_size());
+  statistics.add_objects<Channel>("chat_manager.channels", channels_.calc_size());
+  statistics.add_objects<ChannelFull>("chat_manager.channels_full", channels_full_.calc_size());
+}
+
 void ChatManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   for (auto chat_id : unknown_chats_) {
     if (!have_chat(chat_id)) {
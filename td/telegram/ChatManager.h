@@ -54,6 +54,7 @@
 namespace td {
 
 struct BinlogEvent;
+class MemoryStatistics;
 struct MinChannel;
 class Td;
 
@@ -383,6 +384,8 @@ class ChatManager final : public Actor {
 
   void repair_chat_participants(ChatId chat_id);
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
  private:
@@ -622,6 +625,10 @@ class ChatManager final : public Actor {
 
   static constexpr int32 MAX_ACTIVE_STORY_ID_RELOAD_TIME = 3600;  // some reasonable limit
 
+  // objects are saved to the database in batches to write them in one transaction
+  static constexpr double MAX_SAVE_TO_DATABASE_DELAY = 0.05;
+  static constexpr size_t MAX_SAVE_TO_DATABASE_BATCH_SIZE = 1000;
+
   static constexpr int32 CHAT_FLAG_USER_IS_CREATOR = 1 << 0;
   static constexpr int32 CHAT_FLAG_USER_HAS_LEFT = 1 << 2;
   // static constexpr int32 CHAT_FLAG_ADMINISTRATORS_ENABLED = 1 << 3;
@@ -806,6 +813,8 @@ class ChatManager final : public Actor {
   void save_channel_to_database(Channel *c, ChannelId channel_id);
   void save_channel_to_database_impl(Channel *c, ChannelId channel_id, string value);
   void on_save_channel_to_database(ChannelId channel_id, bool success);
+  void flush_pending_saved_channels();
+  void on_save_channels_to_database(vector<ChannelId> channel_ids, bool success);
   void load_channel_from_database(Channel *c, ChannelId channel_id, Promise<Unit> promise);
   void load_channel_from_database_impl(ChannelId channel_id, Promise<Unit> promise);
   void on_load_channel_from_database(ChannelId channel_id, string value, bool force);
@@ -903,6 +912,8 @@ class ChatManager final : public Actor {
 
   void tear_down() final;
 
+  void timeout_expired() final;
+
   Td *td_;
   ActorShared<> parent_;
 
@@ -950,6 +961,9 @@ class ChatManager final : public Actor {
   MultiTimeout channel_emoji_status_timeout_{"ChannelEmojiStatusTimeout"};
   MultiTimeout channel_unban_timeout_{"ChannelUnbanTimeout"};
   MultiTimeout slow_mode_delay_timeout_{"SlowModeDelayTimeout"};
+
+  // channels, which will be saved to the database together in one transaction
+  vector<std::pair<ChannelId, string>> pending_saved_channels_;
 };
 
 }  // namespace td
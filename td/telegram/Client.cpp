@@ -8,6 +8,7 @@
 
 #include "td/telegram/Td.h"
 #include "td/telegram/TdCallback.h"
+#include "td/telegram/UpdateDeliveryStats.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
@@ -20,12 +21,13 @@
 #include "td/utils/FlatHashSet.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
-#include "td/utils/MpscPollableQueue.h"
 #include "td/utils/port/RwMutex.h"
 #include "td/utils/port/thread.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/StringBuilder.h"
+#include "td/utils/StripedMpscPollableQueue.h"
+#include "td/utils/Time.h"
 #include "td/utils/utf8.h"
 
 #include <algorithm>
@@ -107,6 +109,12 @@ class ClientManager::Impl final {
     requests_.push_back({client_id, request_id, std::move(request)});
   }
 
+  void send_many(ClientId client_id, vector<ClientManager::Request> &&requests) {
+    for (auto &request : requests) {
+      send(client_id, request.request_id, std::move(request.function));
+    }
+  }
+
   Response receive(double timeout) {
     if (!requests_.empty()) {
       for (size_t i = 0; i < requests_.size(); i++) {
@@ -137,6 +145,49 @@ class ClientManager::Impl final {
     } else {
       ConcurrentScheduler::emscripten_clear_main_timeout();
     }
+    on_response(response);
+    return response;
+  }
+
+  vector<Response> receive_many(size_t max_count, double timeout) {
+    vector<Response> responses;
+    auto response = receive(timeout);
+    while (response.object != nullptr) {
+      responses.push_back(std::move(response));
+      if (responses.size() >= max_count) {
+        break;
+      }
+      response = receive(0);
+    }
+    return responses;
+  }
+
+  Impl() = default;
+  Impl(const Impl &) = delete;
+  Impl &operator=(const Impl &) = delete;
+  Impl(Impl &&) = delete;
+  Impl &operator=(Impl &&) = delete;
+  ~Impl() {
+    if (concurrent_scheduler_ == nullptr) {
+      return;
+    }
+
+    {
+      auto guard = concurrent_scheduler_->get_main_guard();
+      for (auto &td : tds_) {
+        td.second.reset();
+      }
+    }
+    while (!tds_.empty() && !ExitGuard::is_exited()) {
+      receive(0.1);
+    }
+    if (concurrent_scheduler_ != nullptr) {
+      concurrent_scheduler_->finish();
+    }
+  }
+
+ private:
+  void on_response(Response &response) {
     if (response.request_id == 0 && response.object != nullptr &&
         response.object->get_id() == td_api::updateAuthorizationState::ID &&
         static_cast<const td_api::updateAuthorizationState *>(response.object.get())->authorization_state_->get_id() ==
@@ -168,34 +219,8 @@ class ClientManager::Impl final {
         reset_to_empty(tds_);
       }
     }
-    return response;
   }
 
-  Impl() = default;
-  Impl(const Impl &) = delete;
-  Impl &operator=(const Impl &) = delete;
-  Impl(Impl &&) = delete;
-  Impl &operator=(Impl &&) = delete;
-  ~Impl() {
-    if (concurrent_scheduler_ == nullptr) {
-      return;
-    }
-
-    {
-      auto guard = concurrent_scheduler_->get_main_guard();
-      for (auto &td : tds_) {
-        td.second.reset();
-      }
-    }
-    while (!tds_.empty() && !ExitGuard::is_exited()) {
-      receive(0.1);
-    }
-    if (concurrent_scheduler_ != nullptr) {
-      concurrent_scheduler_->finish();
-    }
-  }
-
- private:
   TdReceiver receiver_;
   struct Request {
     ClientId client_id;
@@ -259,6 +284,14 @@ class MultiTd final : public Actor {
     send_closure(td, &Td::request, request_id, std::move(request));
   }
 
+  void send_many(ClientManager::ClientId client_id, vector<ClientManager::Request> &&requests) {
+    auto &td = tds_[client_id];
+    CHECK(!td.empty());
+    for (auto &request : requests) {
+      send_closure(td, &Td::request, request.request_id, std::move(request.function));
+    }
+  }
+
   void close(int32 td_id) {
     size_t erased_count = tds_.erase(td_id);
     CHECK(erased_count > 0);
@@ -295,6 +328,32 @@ class TdReceiver {
     return response;
   }
 
+  void receive_many(size_t max_count, double timeout, vector<ClientManager::Response> &responses) {
+    VLOG(td_requests) << "Begin to wait for up to " << max_count << " updates with timeout " << timeout;
+    auto is_locked = receive_lock_.exchange(true);
+    if (is_locked) {
+      LOG(FATAL) << "Receive must not be called simultaneously from two different threads, but this has just "
+                    "happened. Call it from a fixed thread, dedicated for updates and response processing.";
+    }
+    auto response = receive_unlocked(clamp(timeout, 0.0, 1000000.0));
+    if (response.client_id != 0 || response.request_id != 0 || response.object != nullptr) {
+      responses.push_back(std::move(response));
+      while (responses.size() < max_count) {
+        if (output_queue_ready_cnt_ == 0) {
+          output_queue_ready_cnt_ = output_queue_->reader_wait_nonblock();
+          if (output_queue_ready_cnt_ == 0) {
+            break;
+          }
+        }
+        output_queue_ready_cnt_--;
+        responses.push_back(pop_response());
+      }
+    }
+    is_locked = receive_lock_.exchange(false);
+    CHECK(is_locked);
+    VLOG(td_requests) << "End to wait for updates, returning " << responses.size() << " objects";
+  }
+
   unique_ptr<TdCallback> create_callback(ClientManager::ClientId client_id) {
     class Callback final : public TdCallback {
      public:
@@ -302,17 +361,17 @@ class TdReceiver {
           : client_id_(client_id), output_queue_(std::move(output_queue)) {
       }
       void on_result(uint64 id, td_api::object_ptr<td_api::Object> result) final {
-        output_queue_->writer_put({client_id_, id, std::move(result)});
+        output_queue_->writer_put({{client_id_, id, std::move(result)}, get_send_time(id)});
       }
       void on_error(uint64 id, td_api::object_ptr<td_api::error> error) final {
-        output_queue_->writer_put({client_id_, id, std::move(error)});
+        output_queue_->writer_put({{client_id_, id, std::move(error)}, 0.0});
       }
       Callback(const Callback &) = delete;
       Callback &operator=(const Callback &) = delete;
       Callback(Callback &&) = delete;
       Callback &operator=(Callback &&) = delete;
       ~Callback() final {
-        output_queue_->writer_put({client_id_, 0, nullptr});
+        output_queue_->writer_put({{client_id_, 0, nullptr}, 0.0});
       }
 
      private:
@@ -323,11 +382,28 @@ class TdReceiver {
   }
 
   void add_response(ClientManager::ClientId client_id, uint64 id, td_api::object_ptr<td_api::Object> result) {
-    output_queue_->writer_put({client_id, id, std::move(result)});
+    output_queue_->writer_put({{client_id, id, std::move(result)}, 0.0});
   }
 
  private:
-  using OutputQueue = MpscPollableQueue<ClientManager::Response>;
+  struct QueuedResponse {
+    ClientManager::Response response;
+    double send_time;  // non-zero only for updates if collection of update delivery statistics is enabled
+  };
+
+  static double get_send_time(uint64 request_id) {
+    return request_id == 0 && UpdateDeliveryStats::is_enabled() ? Time::now() : 0.0;
+  }
+
+  ClientManager::Response pop_response() {
+    auto queued_response = output_queue_->reader_get_unsafe();
+    if (queued_response.send_time != 0.0) {
+      UpdateDeliveryStats::on_update_received(queued_response.send_time);
+    }
+    return std::move(queued_response.response);
+  }
+
+  using OutputQueue = StripedMpscPollableQueue<QueuedResponse>;
   std::shared_ptr<OutputQueue> output_queue_;
   int output_queue_ready_cnt_{0};
   std::atomic<bool> receive_lock_{false};
@@ -338,7 +414,7 @@ class TdReceiver {
     }
     if (output_queue_ready_cnt_ > 0) {
       output_queue_ready_cnt_--;
-      return output_queue_->reader_get_unsafe();
+      return pop_response();
     }
     if (timeout != 0) {
       output_queue_->reader_get_event_fd().wait(static_cast<int>(timeout * 1000));
@@ -350,10 +426,11 @@ class TdReceiver {
 
 class MultiImpl {
  public:
-  static constexpr int32 ADDITIONAL_THREAD_COUNT = 3;
+  static constexpr int32 MAX_ADDITIONAL_THREAD_COUNT = 3;
 
-  explicit MultiImpl(std::shared_ptr<NetQueryStats> net_query_stats) {
-    concurrent_scheduler_ = std::make_shared<ConcurrentScheduler>(ADDITIONAL_THREAD_COUNT, 0);
+  MultiImpl(std::shared_ptr<NetQueryStats> net_query_stats, int32 additional_thread_count,
+            uint64 thread_affinity_mask) {
+    concurrent_scheduler_ = std::make_shared<ConcurrentScheduler>(additional_thread_count, thread_affinity_mask);
     concurrent_scheduler_->start();
 
     {
@@ -363,7 +440,14 @@ class MultiImpl {
       multi_td_ = create_actor<MultiTd>("MultiTd", std::move(options));
     }
 
-    scheduler_thread_ = thread([concurrent_scheduler = concurrent_scheduler_] {
+    scheduler_thread_ = thread([concurrent_scheduler = concurrent_scheduler_, thread_affinity_mask] {
+#if TD_HAVE_THREAD_AFFINITY
+      if (thread_affinity_mask != 0) {
+        thread::set_affinity_mask(this_thread::get_id(), thread_affinity_mask).ignore();
+      }
+#else
+      (void)thread_affinity_mask;
+#endif
       while (concurrent_scheduler->run_main(10)) {
       }
     });
@@ -395,6 +479,11 @@ class MultiImpl {
     send_closure(multi_td_, &MultiTd::send, client_id, request_id, std::move(request));
   }
 
+  void send_many(ClientManager::ClientId client_id, vector<ClientManager::Request> &&requests) {
+    auto guard = concurrent_scheduler_->get_send_guard();
+    send_closure(multi_td_, &MultiTd::send_many, client_id, std::move(requests));
+  }
+
   void close(ClientManager::ClientId client_id) {
     LOG(INFO) << "Close client";
     auto guard = concurrent_scheduler_->get_send_guard();
@@ -423,31 +512,60 @@ class MultiImpl {
   static std::atomic<uint32> current_id_;
 };
 
-constexpr int32 MultiImpl::ADDITIONAL_THREAD_COUNT;
+constexpr int32 MultiImpl::MAX_ADDITIONAL_THREAD_COUNT;
 std::atomic<uint32> MultiImpl::current_id_{1};
 
 class MultiImplPool {
  public:
+  struct Topology {
+    int32 shard_count = 0;
+    int32 additional_thread_count = MultiImpl::MAX_ADDITIONAL_THREAD_COUNT;
+    vector<uint64> thread_affinity_masks;
+  };
+
+  static void set_topology(Topology topology) {
+    std::unique_lock<std::mutex> lock(topology_mutex_);
+    topology_ = std::move(topology);
+  }
+
   std::shared_ptr<MultiImpl> get() {
     std::unique_lock<std::mutex> lock(mutex_);
     if (impls_.empty()) {
       init_openssl_threads();
 
-      auto max_client_threads = clamp(thread::hardware_concurrency(), 8u, 20u) * 5 / 4;
+      {
+        std::unique_lock<std::mutex> topology_lock(topology_mutex_);
+        topology_snapshot_ = topology_;
+      }
+
+      auto max_client_threads = static_cast<uint32>(topology_snapshot_.shard_count);
+      if (max_client_threads == 0) {
+        max_client_threads = clamp(thread::hardware_concurrency(), 8u, 20u) * 5 / 4;
 #if TD_OPENBSD
-      max_client_threads = td::min(max_client_threads, 4u);
+        max_client_threads = td::min(max_client_threads, 4u);
 #endif
+      }
+      // the total number of threads must be less than 128
+      auto threads_per_impl = static_cast<uint32>(1 + topology_snapshot_.additional_thread_count + 1 /* IOCP */);
+      max_client_threads = clamp(max_client_threads, 1u, 127u / threads_per_impl);
       impls_.resize(max_client_threads);
-      CHECK(impls_.size() * (1 + MultiImpl::ADDITIONAL_THREAD_COUNT + 1 /* IOCP */) < 128);
+      CHECK(impls_.size() * threads_per_impl < 128);
 
       net_query_stats_ = std::make_shared<NetQueryStats>();
     }
-    auto &impl = *std::min_element(impls_.begin(), impls_.end(),
-                                   [](auto &a, auto &b) { return a.lock().use_count() < b.lock().use_count(); });
-    auto result = impl.lock();
+    auto impl_it = std::min_element(impls_.begin(), impls_.end(),
+                                    [](auto &a, auto &b) { return a.lock().use_count() < b.lock().use_count(); });
+    auto result = impl_it->lock();
     if (!result) {
-      result = std::make_shared<MultiImpl>(net_query_stats_);
-      impl = result;
+      uint64 thread_affinity_mask = 0;
+      const auto &thread_affinity_masks = topology_snapshot_.thread_affinity_masks;
+      if (!thread_affinity_masks.empty()) {
+        auto shard_id = static_cast<size_t>(impl_it - impls_.begin());
+        thread_affinity_mask = thread_affinity_masks[shard_id % thread_affinity_masks.size()];
+      }
+      result = std::make_shared<MultiImpl>(net_query_stats_, topology_snapshot_.additional_thread_count,
+                                           thread_affinity_mask);
+      *impl_it = result;
     }
     return result;
   }
@@ -474,8 +592,15 @@ class MultiImplPool {
   std::mutex mutex_;
   std::vector<std::weak_ptr<MultiImpl>> impls_;
   std::shared_ptr<NetQueryStats> net_query_stats_;
+  Topology topology_snapshot_;
+
+  static std::mutex topology_mutex_;
+  static Topology topology_;
 };
 
+std::mutex MultiImplPool::topology_mutex_;
+MultiImplPool::Topology MultiImplPool::topology_;
+
 class ClientManager::Impl final {
  public:
   ClientId create_client_id() {
@@ -489,37 +614,42 @@ class ClientManager::Impl final {
   }
 
   void send(ClientId client_id, RequestId request_id, td_api::object_ptr<td_api::Function> &&request) {
-    auto lock = impls_mutex_.lock_read().move_as_ok();
-    if (!MultiImpl::is_valid_client_id(client_id)) {
-      receiver_.add_response(client_id, request_id,
-                             td_api::make_object<td_api::error>(400, "Invalid TDLib instance specified"));
-      return;
+    auto error = do_send(client_id, [&](MultiImpl &impl) { impl.send(client_id, request_id, std::move(request)); });
+    if (error != nullptr) {
+      receiver_.add_response(client_id, request_id, std::move(error));
     }
+  }
 
-    auto it = impls_.find(client_id);
-    if (it != impls_.end() && it->second.impl == nullptr) {
-      lock.reset();
-
-      auto write_lock = impls_mutex_.lock_write().move_as_ok();
-      it = impls_.find(client_id);
-      if (it != impls_.end() && it->second.impl == nullptr) {
-        it->second.impl = pool_.get();
-        it->second.impl->create(client_id, receiver_.create_callback(client_id));
-      }
-      write_lock.reset();
-
-      lock = impls_mutex_.lock_read().move_as_ok();
-      it = impls_.find(client_id);
-    }
-    if (it == impls_.end() || it->second.is_closed) {
-      receiver_.add_response(client_id, request_id, td_api::make_object<td_api::error>(500, "Request aborted"));
+  void send_many(ClientId client_id, vector<ClientManager::Request> &&requests) {
+    if (requests.empty()) {
       return;
     }
-    it->second.impl->send(client_id, request_id, std::move(request));
+    auto error = do_send(client_id, [&](MultiImpl &impl) { impl.send_many(client_id, std::move(requests)); });
+    if (error != nullptr) {
+      for (auto &request : requests) {
+        receiver_.add_response(client_id, request.request_id,
+                               td_api::make_object<td_api::error>(error->code_, error->message_));
+      }
+    }
   }
 
   Response receive(double timeout) {
     auto response = receiver_.receive(timeout, true);
+    on_response(response);
+    return response;
+  }
+
+  vector<Response> receive_many(size_t max_count, double timeout) {
+    vector<Response> responses;
+    receiver_.receive_many(max_count, timeout, responses);
+    for (auto &response : responses) {
+      on_response(response);
+    }
+    td::remove_if(responses, [](const Response &response) { return response.object == nullptr; });
+    return responses;
+  }
+
+  void on_response(Response &response) {
     if (response.request_id == 0 && response.object != nullptr &&
         response.object->get_id() == td_api::updateAuthorizationState::ID &&
         static_cast<const td_api::updateAuthorizationState *>(response.object.get())->authorization_state_->get_id() ==
@@ -546,7 +676,6 @@ class ClientManager::Impl final {
         pool_.try_clear();
       }
     }
-    return response;
   }
 
   void close_impl(ClientId client_id) {
@@ -581,6 +710,36 @@ class ClientManager::Impl final {
   }
 
  private:
+  // passes the MultiImpl of the client to send_requests or returns an error, which must be sent for the requests
+  template <class F>
+  td_api::object_ptr<td_api::error> do_send(ClientId client_id, F &&send_requests) {
+    auto lock = impls_mutex_.lock_read().move_as_ok();
+    if (!MultiImpl::is_valid_client_id(client_id)) {
+      return td_api::make_object<td_api::error>(400, "Invalid TDLib instance specified");
+    }
+
+    auto it = impls_.find(client_id);
+    if (it != impls_.end() && it->second.impl == nullptr) {
+      lock.reset();
+
+      auto write_lock = impls_mutex_.lock_write().move_as_ok();
+      it = impls_.find(client_id);
+      if (it != impls_.end() && it->second.impl == nullptr) {
+        it->second.impl = pool_.get();
+        it->second.impl->create(client_id, receiver_.create_callback(client_id));
+      }
+      write_lock.reset();
+
+      lock = impls_mutex_.lock_read().move_as_ok();
+      it = impls_.find(client_id);
+    }
+    if (it == impls_.end() || it->second.is_closed) {
+      return td_api::make_object<td_api::error>(500, "Request aborted");
+    }
+    send_requests(*it->second.impl);
+    return nullptr;
+  }
+
   MultiImplPool pool_;
   RwMutex impls_mutex_;
   struct MultiImplInfo {
@@ -675,10 +834,19 @@ void ClientManager::send(ClientId client_id, RequestId request_id, td_api::objec
   impl_->send(client_id, request_id, std::move(request));
 }
 
+void ClientManager::send_many(ClientId client_id, vector<Request> &&requests) {
+  impl_->send_many(client_id, std::move(requests));
+}
+
 ClientManager::Response ClientManager::receive(double timeout) {
   return impl_->receive(timeout);
 }
 
+vector<ClientManager::Response> ClientManager::receive_many(size_t max_count, double timeout) {
+  CHECK(max_count > 0);
+  return impl_->receive_many(max_count, timeout);
+}
+
 td_api::object_ptr<td_api::Object> ClientManager::execute(td_api::object_ptr<td_api::Function> &&request) {
   return Td::static_request(std::move(request));
 }
@@ -713,6 +881,19 @@ void ClientManager::set_log_message_callback(int max_verbosity_level, LogMessage
   }
 }
 
+void ClientManager::set_thread_topology(int32 shard_count, int32 additional_thread_count,
+                                        vector<uint64> thread_affinity_masks) {
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  MultiImplPool::Topology topology;
+  topology.shard_count = max(shard_count, 0);
+  if (additional_thread_count >= 0) {
+    topology.additional_thread_count = min(additional_thread_count, MultiImpl::MAX_ADDITIONAL_THREAD_COUNT);
+  }
+  topology.thread_affinity_masks = std::move(thread_affinity_masks);
+  MultiImplPool::set_topology(std::move(topology));
+#endif
+}
+
 ClientManager::ClientManager(ClientManager &&) noexcept = default;
 ClientManager &ClientManager::operator=(ClientManager &&) noexcept = default;
 ClientManager::~ClientManager() = default;
@@ -11,8 +11,10 @@
 #include "td/telegram/td_api.h"
 #include "td/telegram/td_api.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace td {
 
@@ -24,7 +26,10 @@ namespace td {
  * New updates and responses to requests can be received using the method ClientManager::receive from any thread after
  * the first request has been sent to the client instance. ClientManager::receive must not be called simultaneously from
  * two different threads. Also, note that all updates and responses to requests should be applied in the same order as
- * they were received, to ensure consistency.
+ * they were received, to ensure consistency. Updates and responses for the same client instance are always received
+ * in the order they were sent, but there is no order guarantee between different client instances.
+ * If responses must be processed by several threads, then create a separate ClientManager for each of the threads.
+ * Each client manager has its own client instances, TDLib threads and queue of received responses.
  * Some TDLib requests can be executed synchronously from any thread using the method ClientManager::execute.
  *
  * General pattern of usage:
@@ -86,6 +91,31 @@ class ClientManager final {
    */
   void send(ClientId client_id, RequestId request_id, td_api::object_ptr<td_api::Function> &&request);
 
+  /**
+   * A request to TDLib, which is sent together with other requests.
+   */
+  struct Request {
+    /**
+     * Request identifier. Must be non-zero.
+     */
+    RequestId request_id;
+
+    /**
+     * Request to TDLib.
+     */
+    td_api::object_ptr<td_api::Function> function;
+  };
+
+  /**
+   * Sends several requests to the same TDLib instance at once. May be called from any thread.
+   * The requests are passed to the TDLib instance together, which is cheaper than sending them one by one.
+   * Each request is handled independently and gets its own response, which can be received together with other
+   * responses using ClientManager::receive_many.
+   * \param[in] client_id TDLib client instance identifier.
+   * \param[in] requests Requests to TDLib.
+   */
+  void send_many(ClientId client_id, std::vector<Request> &&requests);
+
   /**
    * A response to a request, or an incoming update from TDLib.
    */
@@ -115,6 +145,17 @@ class ClientManager final {
    */
   Response receive(double timeout);
 
+  /**
+   * Receives up to max_count incoming updates and responses to requests from TDLib at once. Waits for new data only
+   * if there are no pending responses. May be called from any thread, but must not be called simultaneously with
+   * ClientManager::receive or ClientManager::receive_many from two different threads.
+   * \param[in] max_count The maximum number of responses to return. Must be positive.
+   * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+   * \return Incoming updates and responses to requests in the order they were received. The vector is empty
+   *         if the timeout expires. Returned responses always have non-null objects.
+   */
+  std::vector<Response> receive_many(std::size_t max_count, double timeout);
+
   /**
    * Synchronously executes a TDLib request.
    * A request can be executed synchronously, only if it is documented with "Can be called synchronously".
@@ -144,6 +185,23 @@ class ClientManager final {
    */
   static void set_log_message_callback(int max_verbosity_level, LogMessageCallbackPtr callback);
 
+  /**
+   * Changes the layout of threads, which are used to run TDLib instances of all client managers.
+   * The new layout is applied when the first request is sent to a TDLib instance after all previously active
+   * TDLib instances have been closed. By default the layout is chosen based on the number of available CPU cores.
+   *
+   * \param[in] shard_count The number of independent groups of threads between which TDLib instances are distributed.
+   *                        Pass 0 to choose the number automatically.
+   * \param[in] additional_thread_count The number of additional threads in each group, which are used for database,
+   *                                    garbage collection and slow network operations; 0-3. Pass -1 to use the default
+   *                                    number of additional threads.
+   * \param[in] thread_affinity_masks CPU affinity masks for threads of each group. Threads of the group i use the mask
+   *                                  thread_affinity_masks[i % thread_affinity_masks.size()]; 0 keeps the default
+   *                                  affinity. Pass an empty vector to keep the default affinity for all threads.
+   */
+  static void set_thread_topology(std::int32_t shard_count, std::int32_t additional_thread_count,
+                                  std::vector<std::uint64_t> thread_affinity_masks);
+
   /**
    * Destroys the client manager and all TDLib client instances managed by it.
    */
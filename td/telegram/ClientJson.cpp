@@ -9,14 +9,18 @@
 #include "td/telegram/td_api.h"
 #include "td/telegram/td_api_json.h"
 
+#include "td/tl/TlObject.h"
+
 #include "td/utils/common.h"
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/JsonBuilder.h"
+#include "td/utils/misc.h"
 #include "td/utils/port/thread_local.h"
 #include "td/utils/SliceBuilder.h"
-#include "td/utils/StackAllocator.h"
 #include "td/utils/StringBuilder.h"
+#include "td/utils/tl_storers.h"
 
+#include <cstring>
 #include <utility>
 
 namespace td {
@@ -26,8 +30,16 @@ static td_api::object_ptr<td_api::Function> get_return_error_function(Slice erro
   return td_api::make_object<td_api::testReturnError>(std::move(error));
 }
 
+// JSON is decoded in place, so requests are copied to a per-thread buffer, which keeps its capacity between calls
+static TD_THREAD_LOCAL string *current_request;
+
 static std::pair<td_api::object_ptr<td_api::Function>, string> to_request(Slice request) {
-  auto request_str = request.str();
+  init_thread_local<string>(current_request);
+  auto &request_str = *current_request;
+  if (request_str.capacity() > (1 << 22) && request.size() <= (1 << 22)) {
+    string().swap(request_str);
+  }
+  request_str.assign(request.data(), request.size());
   auto r_json_value = json_decode(request_str);
   if (r_json_value.is_error()) {
     return {get_return_error_function(PSLICE()
@@ -53,32 +65,69 @@ static std::pair<td_api::object_ptr<td_api::Function>, string> to_request(Slice
   return std::make_pair(std::move(func), std::move(extra));
 }
 
-static string from_response(const td_api::Object &object, const string &extra, int client_id) {
-  auto buf = StackAllocator::alloc(1 << 18);
-  JsonBuilder jb(StringBuilder(buf.as_slice(), true), -1);
-  jb.enter_value() << ToJson(object);
-  auto &sb = jb.string_builder();
-  auto slice = sb.as_cslice();
-  CHECK(!slice.empty() && slice.back() == '}');
-  sb.pop_back();
-  if (!extra.empty()) {
-    sb << ",\"@extra\":" << extra;
-  }
-  if (client_id != 0) {
-    sb << ",\"@client_id\":" << client_id;
-  }
-  sb << '}';
-  return sb.as_cslice().str();
-}
+// output buffers are reused between calls to avoid allocation and copying of responses
+class OutputBuffer {
+ public:
+  void clear() {
+    if (buffer_.size() > MAX_KEPT_BUFFER_SIZE) {
+      string().swap(buffer_);
+    }
+    size_ = 0;
+  }
+
+  // appends null-terminated JSON representation of the response and returns its offset in the buffer
+  size_t append_response(const td_api::Object &object, const string &extra, int client_id) {
+    if (buffer_.size() < size_ + MIN_FREE_SIZE) {
+      buffer_.resize(max(buffer_.size() * 2, size_ + MIN_FREE_SIZE));
+    }
+    auto offset = size_;
+    MutableSlice free_space(&buffer_[offset], buffer_.size() - offset);
+    JsonBuilder jb(StringBuilder(free_space, true), -1);
+    jb.enter_value() << ToJson(object);
+    auto &sb = jb.string_builder();
+    auto slice = sb.as_cslice();
+    CHECK(!slice.empty() && slice.back() == '}');
+    sb.pop_back();
+    if (!extra.empty()) {
+      sb << ",\"@extra\":" << extra;
+    }
+    if (client_id != 0) {
+      sb << ",\"@client_id\":" << client_id;
+    }
+    sb << '}';
+    auto result = sb.as_cslice();
+    if (result.begin() != free_space.begin()) {
+      // the response didn't fit into the buffer and was stored in a temporary one
+      buffer_.resize(max(buffer_.size() * 2, offset + result.size() + MIN_FREE_SIZE));
+      std::memcpy(&buffer_[offset], result.begin(), result.size() + 1);
+    }
+    size_ = offset + result.size() + 1;
+    return offset;
+  }
+
+  const char *get(size_t offset) const {
+    CHECK(offset < size_);
+    return buffer_.c_str() + offset;
+  }
+
+ private:
+  static constexpr size_t MIN_FREE_SIZE = 1 << 16;
+  static constexpr size_t MAX_KEPT_BUFFER_SIZE = 1 << 22;
 
-static TD_THREAD_LOCAL string *current_output;
+  string buffer_;
+  size_t size_ = 0;
+};
 
-static const char *store_string(string str) {
-  init_thread_local<string>(current_output);
-  *current_output = std::move(str);
-  return current_output->c_str();
+static TD_THREAD_LOCAL OutputBuffer *current_output;
+
+static const char *store_response(const td_api::Object &object, const string &extra, int client_id) {
+  init_thread_local<OutputBuffer>(current_output);
+  current_output->clear();
+  return current_output->get(current_output->append_response(object, extra, client_id));
 }
 
+static TD_THREAD_LOCAL OutputBuffer *current_batch_output;
+
 void ClientJson::send(Slice request) {
   auto parsed_request = to_request(request);
   std::uint64_t extra_id = extra_id_.fetch_add(1, std::memory_order_relaxed);
@@ -104,13 +153,13 @@ const char *ClientJson::receive(double timeout) {
       extra_.erase(it);
     }
   }
-  return store_string(from_response(*response.object, extra, 0));
+  return store_response(*response.object, extra, 0);
 }
 
 const char *ClientJson::execute(Slice request) {
   auto parsed_request = to_request(request);
-  return store_string(from_response(*Client::execute(Client::Request{0, std::move(parsed_request.first)}).object,
-                                    parsed_request.second, 0));
+  return store_response(*Client::execute(Client::Request{0, std::move(parsed_request.first)}).object,
+                        parsed_request.second, 0);
 }
 
 static ClientManager *get_manager() {
@@ -135,28 +184,94 @@ void json_send(int client_id, Slice request) {
   get_manager()->send(client_id, request_id, std::move(parsed_request.first));
 }
 
+static string extract_extra(ClientManager::RequestId request_id) {
+  string extra_str;
+  if (request_id != 0) {
+    std::lock_guard<std::mutex> guard(extra_mutex);
+    auto it = extra.find(request_id);
+    if (it != extra.end()) {
+      extra_str = std::move(it->second);
+      extra.erase(it);
+    }
+  }
+  return extra_str;
+}
+
 const char *json_receive(double timeout) {
   auto response = get_manager()->receive(timeout);
   if (!response.object) {
     return nullptr;
   }
 
-  string extra_str;
-  if (response.request_id != 0) {
-    std::lock_guard<std::mutex> guard(extra_mutex);
-    auto it = extra.find(response.request_id);
-    if (it != extra.end()) {
-      extra_str = std::move(it->second);
-      extra.erase(it);
+  return store_response(*response.object, extract_extra(response.request_id), response.client_id);
+}
+
+int json_receive_batch(double timeout, const char **responses, int max_count) {
+  if (responses == nullptr || max_count <= 0) {
+    return 0;
+  }
+
+  init_thread_local<OutputBuffer>(current_batch_output);
+  auto &output = *current_batch_output;
+  output.clear();
+
+  auto received_responses = get_manager()->receive_many(static_cast<size_t>(max_count), timeout);
+  vector<size_t> offsets;
+  offsets.reserve(received_responses.size());
+  for (auto &response : received_responses) {
+    offsets.push_back(
+        output.append_response(*response.object, extract_extra(response.request_id), response.client_id));
+  }
+  for (size_t i = 0; i < offsets.size(); i++) {
+    responses[i] = output.get(offsets[i]);
+  }
+  return static_cast<int>(offsets.size());
+}
+
+template <class StorerT>
+static void store_binary_response(StorerT &storer, const td_api::Object &object, const string &extra,
+                                  int client_id) {
+  storer.store_binary(static_cast<int32>(client_id));
+  storer.store_string(extra);
+  storer.store_binary(static_cast<const TlObject &>(object).get_id());
+  object.store(storer);
+}
+
+static TD_THREAD_LOCAL string *current_binary_output;
+
+const char *json_receive_binary(double timeout, int *size) {
+  auto response = get_manager()->receive(timeout);
+  if (!response.object) {
+    if (size != nullptr) {
+      *size = 0;
     }
+    return nullptr;
+  }
+
+  auto extra_str = extract_extra(response.request_id);
+  TlStorerCalcLength calc_length;
+  store_binary_response(calc_length, *response.object, extra_str, response.client_id);
+  auto length = calc_length.get_length();
+
+  init_thread_local<string>(current_binary_output);
+  auto &output = *current_binary_output;
+  if (output.size() < length || output.size() > max(length, static_cast<size_t>(1 << 22))) {
+    output.resize(length);
+  }
+  auto begin = MutableSlice(output).ubegin();
+  TlStorerUnsafe storer(begin);
+  store_binary_response(storer, *response.object, extra_str, response.client_id);
+  CHECK(storer.get_buf() == begin + length);
+
+  if (size != nullptr) {
+    *size = narrow_cast<int>(length);
   }
-  return store_string(from_response(*response.object, extra_str, response.client_id));
+  return output.data();
 }
 
 const char *json_execute(Slice request) {
   auto parsed_request = to_request(request);
-  return store_string(
-      from_response(*ClientManager::execute(std::move(parsed_request.first)), parsed_request.second, 0));
+  return store_response(*ClientManager::execute(std::move(parsed_request.first)), parsed_request.second, 0);
 }
 
 }  // namespace td
@@ -40,6 +40,10 @@ void json_send(int client_id, Slice request);
 
 const char *json_receive(double timeout);
 
+int json_receive_batch(double timeout, const char **responses, int max_count);
+
+const char *json_receive_binary(double timeout, int *size);
+
 const char *json_execute(Slice request);
 
 }  // namespace td
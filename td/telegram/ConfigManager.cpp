@@ -769,7 +769,7 @@ class ConfigRecoverer final : public Actor {
             return get_simple_config_mozilla_dns;
         }
       }();
-      simple_config_query_ = get_simple_config(std::move(promise), G()->get_option_boolean("prefer_ipv6"),
+      simple_config_query_ = get_simple_config(std::move(promise), G()->get_option_boolean(CachedOption::PreferIpv6),
                                                G()->get_option_string("dc_txt_domain_name"), G()->is_test_dc(),
                                                G()->get_gc_scheduler_id());
       simple_config_turn_++;
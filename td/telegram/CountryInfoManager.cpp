@@ -25,6 +25,8 @@
 #include "td/utils/tl_parsers.h"
 #include "td/utils/utf8.h"
 
+#include <array>
+
 namespace td {
 
 class GetNearestDcQuery final : public Td::ResultHandler {
@@ -107,7 +109,15 @@ struct CountryInfoManager::CountryInfo {
 };
 
 struct CountryInfoManager::CountryList {
+  // node of the trie of all concatenations of a calling code and a phone number prefix
+  struct PrefixNode {
+    std::array<int32, 10> children{};  // 0 if there is no child, because the root isn't a child of any node
+    int32 country_pos = -1;            // the first country with the calling code and the prefix ending at the node
+    int32 calling_code_pos = -1;
+  };
+
   vector<CountryInfo> countries;
+  vector<PrefixNode> prefix_nodes;
   int32 hash = 0;
   double next_reload_time = 0.0;
 
@@ -115,6 +125,43 @@ struct CountryInfoManager::CountryList {
     return td_api::make_object<td_api::countries>(
         transform(countries, [](const CountryInfo &info) { return info.get_country_info_object(); }));
   }
+
+  void build_prefix_trie() {
+    prefix_nodes.clear();
+    prefix_nodes.emplace_back();
+    for (size_t country_pos = 0; country_pos < countries.size(); country_pos++) {
+      const auto &calling_codes = countries[country_pos].calling_codes;
+      for (size_t calling_code_pos = 0; calling_code_pos < calling_codes.size(); calling_code_pos++) {
+        const auto &calling_code = calling_codes[calling_code_pos];
+        for (auto &prefix : calling_code.prefixes) {
+          auto node_pos = add_prefix_nodes(0, calling_code.calling_code);
+          if (node_pos >= 0) {
+            node_pos = add_prefix_nodes(node_pos, prefix);
+          }
+          if (node_pos >= 0 && prefix_nodes[node_pos].country_pos == -1) {
+            prefix_nodes[node_pos].country_pos = narrow_cast<int32>(country_pos);
+            prefix_nodes[node_pos].calling_code_pos = narrow_cast<int32>(calling_code_pos);
+          }
+        }
+      }
+    }
+  }
+
+  // returns -1 if the string contains a non-digit, because cleaned phone numbers can't match the string then
+  int32 add_prefix_nodes(int32 node_pos, Slice str) {
+    for (auto c : str) {
+      if (!is_digit(c)) {
+        return -1;
+      }
+      auto &child_pos = prefix_nodes[node_pos].children[c - '0'];
+      if (child_pos == 0) {
+        child_pos = narrow_cast<int32>(prefix_nodes.size());
+        prefix_nodes.emplace_back();
+      }
+      node_pos = child_pos;
+    }
+    return node_pos;
+  }
 };
 
 CountryInfoManager::CountryInfoManager(Td *td, ActorShared<> parent) : td_(td), parent_(std::move(parent)) {
@@ -262,6 +309,59 @@ void CountryInfoManager::do_get_phone_number_info(string phone_number_prefix, st
                     }));
 }
 
+void CountryInfoManager::get_phone_numbers_info(vector<string> phone_number_prefixes,
+                                                Promise<td_api::object_ptr<td_api::phoneNumbersInfo>> &&promise) {
+  if (phone_number_prefixes.size() > MAX_PHONE_NUMBER_INFO_BATCH_SIZE) {
+    return promise.set_error(Status::Error(400, "Too many phone number prefixes specified"));
+  }
+  for (auto &phone_number_prefix : phone_number_prefixes) {
+    clean_phone_number(phone_number_prefix);
+  }
+  do_get_phone_numbers_info(std::move(phone_number_prefixes), get_main_language_code(), false, std::move(promise));
+}
+
+void CountryInfoManager::do_get_phone_numbers_info(vector<string> phone_number_prefixes, string language_code,
+                                                   bool is_recursive,
+                                                   Promise<td_api::object_ptr<td_api::phoneNumbersInfo>> &&promise) {
+  if (is_recursive) {
+    auto main_language_code = get_main_language_code();
+    if (language_code != main_language_code) {
+      language_code = std::move(main_language_code);
+      is_recursive = false;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> country_lock(country_mutex_);
+    auto list = get_country_list(this, language_code);
+    if (list != nullptr) {
+      auto phone_number_infos = transform(phone_number_prefixes, [list](const string &phone_number_prefix) {
+        if (phone_number_prefix.empty()) {
+          return td_api::make_object<td_api::phoneNumberInfo>(nullptr, string(), string(), false);
+        }
+        return get_phone_number_info_object(list, phone_number_prefix);
+      });
+      return promise.set_value(td_api::make_object<td_api::phoneNumbersInfo>(std::move(phone_number_infos)));
+    }
+  }
+
+  if (is_recursive) {
+    return promise.set_error(Status::Error(500, "Requested data is inaccessible"));
+  }
+  if (language_code.empty()) {
+    return promise.set_error(Status::Error(400, "Invalid language code specified"));
+  }
+  load_country_list(
+      language_code, 0,
+      PromiseCreator::lambda([actor_id = actor_id(this), phone_number_prefixes = std::move(phone_number_prefixes),
+                              language_code, promise = std::move(promise)](Result<Unit> &&result) mutable {
+        if (result.is_error()) {
+          return promise.set_error(result.move_as_error());
+        }
+        send_closure(actor_id, &CountryInfoManager::do_get_phone_numbers_info, std::move(phone_number_prefixes),
+                     std::move(language_code), true, std::move(promise));
+      }));
+}
+
 td_api::object_ptr<td_api::phoneNumberInfo> CountryInfoManager::get_phone_number_info_sync(const string &language_code,
                                                                                            string phone_number_prefix) {
   clean_phone_number(phone_number_prefix);
@@ -281,30 +381,26 @@ td_api::object_ptr<td_api::phoneNumberInfo> CountryInfoManager::get_phone_number
 td_api::object_ptr<td_api::phoneNumberInfo> CountryInfoManager::get_phone_number_info_object(const CountryList *list,
                                                                                              Slice phone_number) {
   CHECK(list != nullptr);
+  CHECK(!list->prefix_nodes.empty());
   const CountryInfo *best_country = nullptr;
   const CallingCodeInfo *best_calling_code = nullptr;
-  size_t best_length = 0;
-  bool is_prefix = false;  // is phone number a prefix of a valid country_code + prefix
+  bool is_prefix = true;  // is phone number a prefix of a valid country_code + prefix
   bool is_anonymous = is_fragment_phone_number(phone_number.str());
-  for (auto &country : list->countries) {
-    for (auto &calling_code : country.calling_codes) {
-      if (begins_with(phone_number, calling_code.calling_code)) {
-        auto calling_code_size = calling_code.calling_code.size();
-        for (auto &prefix : calling_code.prefixes) {
-          if (begins_with(prefix, phone_number.substr(calling_code_size))) {
-            is_prefix = true;
-          }
-          if (calling_code_size + prefix.size() > best_length &&
-              begins_with(phone_number.substr(calling_code_size), prefix)) {
-            best_country = &country;
-            best_calling_code = &calling_code;
-            best_length = calling_code_size + prefix.size();
-          }
-        }
-      }
-      if (begins_with(calling_code.calling_code, phone_number)) {
-        is_prefix = true;
-      }
+  int32 node_pos = 0;
+  for (auto c : phone_number) {
+    if (!is_digit(c)) {
+      is_prefix = false;
+      break;
+    }
+    node_pos = list->prefix_nodes[node_pos].children[c - '0'];
+    if (node_pos == 0) {
+      is_prefix = false;
+      break;
+    }
+    const auto &node = list->prefix_nodes[node_pos];
+    if (node.country_pos >= 0) {
+      best_country = &list->countries[node.country_pos];
+      best_calling_code = &best_country->calling_codes[node.calling_code_pos];
     }
   }
   if (best_country == nullptr) {
@@ -471,6 +567,7 @@ void CountryInfoManager::on_get_country_list_impl(const string &language_code,
 
         countries->countries.push_back(std::move(info));
       }
+      countries->build_prefix_trie();
       countries->hash = list->hash_;
       countries->next_reload_time = Time::now() + Random::fast(86400, 2 * 86400);
       break;
@@ -34,6 +34,9 @@ class CountryInfoManager final : public Actor {
   void get_phone_number_info(string phone_number_prefix,
                              Promise<td_api::object_ptr<td_api::phoneNumberInfo>> &&promise);
 
+  void get_phone_numbers_info(vector<string> phone_number_prefixes,
+                              Promise<td_api::object_ptr<td_api::phoneNumbersInfo>> &&promise);
+
   static td_api::object_ptr<td_api::phoneNumberInfo> get_phone_number_info_sync(const string &language_code,
                                                                                 string phone_number_prefix);
 
@@ -65,6 +68,9 @@ class CountryInfoManager final : public Actor {
   void do_get_phone_number_info(string phone_number_prefix, string language_code, bool is_recursive,
                                 Promise<td_api::object_ptr<td_api::phoneNumberInfo>> &&promise);
 
+  void do_get_phone_numbers_info(vector<string> phone_number_prefixes, string language_code, bool is_recursive,
+                                 Promise<td_api::object_ptr<td_api::phoneNumbersInfo>> &&promise);
+
   void load_country_list(string language_code, int32 hash, Promise<Unit> &&promise);
 
   void on_get_country_list(const string &language_code,
@@ -78,6 +84,8 @@ class CountryInfoManager final : public Actor {
   static td_api::object_ptr<td_api::phoneNumberInfo> get_phone_number_info_object(const CountryList *list,
                                                                                   Slice phone_number);
 
+  static constexpr size_t MAX_PHONE_NUMBER_INFO_BATCH_SIZE = 100000;
+
   static std::mutex country_mutex_;
 
   static int32 manager_count_;
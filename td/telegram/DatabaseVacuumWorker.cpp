@@ -0,0 +1,76 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/DatabaseVacuumWorker.h"
+
+#include "td/db/SqliteConnectionSafe.h"
+#include "td/db/SqliteDb.h"
+
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/Status.h"
+#include "td/utils/Time.h"
+
+namespace td {
+
+void DatabaseVacuumWorker::start_up() {
+  set_timeout_in(FIRST_CHECK_DELAY);
+}
+
+void DatabaseVacuumWorker::hangup() {
+  stop();
+}
+
+Result<int64> DatabaseVacuumWorker::get_free_page_count() {
+  TRY_RESULT(free_page_count, connection_->get().get_pragma("freelist_count"));
+  return to_integer<int64>(free_page_count);
+}
+
+void DatabaseVacuumWorker::timeout_expired() {
+  auto &db = connection_->get();
+  if (!is_vacuum_active_) {
+    auto r_auto_vacuum = db.get_pragma("auto_vacuum");
+    if (r_auto_vacuum.is_error() || r_auto_vacuum.ok() != "2") {
+      // the database was created without incremental vacuum support; it can't be changed without a full VACUUM
+      LOG(INFO) << "Incremental vacuum isn't supported by the database";
+      return stop();
+    }
+
+    auto r_free_page_count = get_free_page_count();
+    if (r_free_page_count.is_error() || r_free_page_count.ok() < MIN_FREE_PAGE_COUNT) {
+      return set_timeout_in(CHECK_PERIOD);
+    }
+    LOG(INFO) << "Start incremental vacuum of " << r_free_page_count.ok() << " free database pages";
+    is_vacuum_active_ = true;
+    freed_page_count_ = 0;
+    vacuum_start_time_ = Time::now();
+  }
+
+  auto r_old_free_page_count = get_free_page_count();
+  auto status = r_old_free_page_count.is_error() ? r_old_free_page_count.move_as_error()
+                                                 : db.exec(PSLICE() << "PRAGMA incremental_vacuum(" << STEP_PAGE_COUNT
+                                                                    << ')');
+  auto r_free_page_count = get_free_page_count();
+  if (status.is_ok() && r_free_page_count.is_ok()) {
+    freed_page_count_ += r_old_free_page_count.ok() - r_free_page_count.ok();
+    if (r_free_page_count.ok() > 0 && r_free_page_count.ok() < r_old_free_page_count.ok()) {
+      // give the database thread a chance to take the write lock between the steps
+      return set_timeout_in(STEP_DELAY);
+    }
+  } else {
+    // the database can be locked by a long write transaction; the vacuum will be continued during the next check
+    LOG(INFO) << "Failed to run incremental vacuum: " << (status.is_error() ? status : r_free_page_count.error());
+  }
+
+  LOG(INFO) << "Finish incremental vacuum of " << freed_page_count_ << " database pages in "
+            << format::as_time(Time::now() - vacuum_start_time_);
+  is_vacuum_active_ = false;
+  set_timeout_in(CHECK_PERIOD);
+}
+
+}  // namespace td
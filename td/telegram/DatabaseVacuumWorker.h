@@ -0,0 +1,51 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/actor/actor.h"
+
+#include "td/utils/common.h"
+#include "td/utils/Status.h"
+
+#include <memory>
+
+namespace td {
+
+class SqliteConnectionSafe;
+
+// periodically returns free pages of the database to the file system in small steps,
+// so that the database thread is never blocked for a long time
+// works only for databases with auto_vacuum=INCREMENTAL
+class DatabaseVacuumWorker final : public Actor {
+ public:
+  DatabaseVacuumWorker(ActorShared<> parent, std::shared_ptr<SqliteConnectionSafe> connection)
+      : parent_(std::move(parent)), connection_(std::move(connection)) {
+  }
+
+ private:
+  static constexpr double CHECK_PERIOD = 15 * 60;
+  static constexpr double FIRST_CHECK_DELAY = 60;
+  static constexpr double STEP_DELAY = 0.05;
+  static constexpr int32 STEP_PAGE_COUNT = 128;
+  static constexpr int64 MIN_FREE_PAGE_COUNT = 256;
+
+  ActorShared<> parent_;
+  std::shared_ptr<SqliteConnectionSafe> connection_;
+  bool is_vacuum_active_ = false;
+  int64 freed_page_count_ = 0;
+  double vacuum_start_time_ = 0.0;
+
+  void start_up() final;
+
+  void timeout_expired() final;
+
+  void hangup() final;
+
+  Result<int64> get_free_page_count();
+};
+
+}  // namespace td
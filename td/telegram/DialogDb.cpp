@@ -377,6 +377,8 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
 
     void add_dialog(DialogId dialog_id, FolderId folder_id, int64 order, BufferSlice data,
                     vector<NotificationGroupKey> notification_groups, Promise<Unit> promise) {
+      // the prefetched page could contain the dialog or must contain it after the change
+      prefetched_dialogs_ = {};
       add_write_query([this, dialog_id, folder_id, order, promise = std::move(promise), data = std::move(data),
                        notification_groups = std::move(notification_groups)](Unit) mutable {
         sync_db_->add_dialog(dialog_id, folder_id, order, std::move(data), std::move(notification_groups));
@@ -413,7 +415,23 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
     void get_dialogs(FolderId folder_id, int64 order, DialogId dialog_id, int32 limit,
                      Promise<DialogDbGetDialogsResult> promise) {
       add_read_query();
-      promise.set_value(sync_db_->get_dialogs(folder_id, order, dialog_id, limit));
+      GetDialogsQuery query{folder_id, order, dialog_id, limit};
+      DialogDbGetDialogsResult result;
+      if (prefetched_dialogs_.is_ready && prefetched_dialogs_.query == query) {
+        LOG(INFO) << "Use prefetched " << prefetched_dialogs_.result.dialogs.size() << " chats from " << folder_id;
+        result = std::move(prefetched_dialogs_.result);
+      } else {
+        result = sync_db_->get_dialogs(folder_id, order, dialog_id, limit);
+      }
+      prefetched_dialogs_ = {};
+
+      // chat lists are loaded page by page, so load the next page while the current one is being processed
+      if (limit > 0 && result.dialogs.size() == static_cast<size_t>(limit)) {
+        prefetched_dialogs_.query = GetDialogsQuery{folder_id, result.next_order, result.next_dialog_id, limit};
+        prefetched_dialogs_.is_pending = true;
+        send_closure_later(actor_id(this), &Impl::prefetch_dialogs);
+      }
+      promise.set_value(std::move(result));
     }
 
     void close(Promise<Unit> promise) {
@@ -433,6 +451,37 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
     std::shared_ptr<DialogDbSyncSafeInterface> sync_db_safe_;
     DialogDbSyncInterface *sync_db_ = nullptr;
 
+    struct GetDialogsQuery {
+      FolderId folder_id;
+      int64 order = 0;
+      DialogId dialog_id;
+      int32 limit = 0;
+
+      bool operator==(const GetDialogsQuery &other) const {
+        return folder_id == other.folder_id && order == other.order && dialog_id == other.dialog_id &&
+               limit == other.limit;
+      }
+    };
+    struct PrefetchedDialogs {
+      GetDialogsQuery query;
+      bool is_pending = false;
+      bool is_ready = false;
+      DialogDbGetDialogsResult result;
+    };
+    PrefetchedDialogs prefetched_dialogs_;
+
+    void prefetch_dialogs() {
+      if (!prefetched_dialogs_.is_pending) {
+        // the prefetch was cancelled by a write or has already been replaced by a direct request
+        return;
+      }
+      add_read_query();
+      const auto &query = prefetched_dialogs_.query;
+      prefetched_dialogs_.result = sync_db_->get_dialogs(query.folder_id, query.order, query.dialog_id, query.limit);
+      prefetched_dialogs_.is_pending = false;
+      prefetched_dialogs_.is_ready = true;
+    }
+
     static constexpr size_t MAX_PENDING_QUERIES_COUNT{50};
     static constexpr double MAX_PENDING_QUERIES_DELAY{0.01};
 
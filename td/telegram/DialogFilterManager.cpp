@@ -667,7 +667,7 @@ void DialogFilterManager::init() {
         are_tags_enabled_ = log_event.are_tags_enabled;
         server_main_dialog_list_position_ = log_event.server_main_dialog_list_position;
         main_dialog_list_position_ = log_event.main_dialog_list_position;
-        if (!td_->option_manager_->get_option_boolean("is_premium")) {
+        if (!td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
           if (server_main_dialog_list_position_ != 0 || main_dialog_list_position_ != 0) {
             LOG(INFO) << "Ignore main chat list position " << server_main_dialog_list_position_ << '/'
                       << main_dialog_list_position_;
@@ -1281,11 +1281,11 @@ void DialogFilterManager::on_get_dialog_filters(
     LOG(ERROR) << "Receive no dialogFilterDefault";
     server_main_dialog_list_position = 0;
   }
-  if (server_main_dialog_list_position != 0 && !td_->option_manager_->get_option_boolean("is_premium")) {
+  if (server_main_dialog_list_position != 0 && !td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
     LOG(INFO) << "Ignore server main chat list position " << server_main_dialog_list_position;
     server_main_dialog_list_position = 0;
   }
-  if (server_are_tags_enabled && !td_->option_manager_->get_option_boolean("is_premium")) {
+  if (server_are_tags_enabled && !td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
     LOG(INFO) << "Ignore server enabled tags";
     server_are_tags_enabled = false;
   }
@@ -1798,7 +1798,7 @@ void DialogFilterManager::reorder_dialog_filters(vector<DialogFilterId> dialog_f
   if (main_dialog_list_position < 0 || main_dialog_list_position > static_cast<int32>(dialog_filters_.size())) {
     return promise.set_error(Status::Error(400, "Invalid main chat list position specified"));
   }
-  if (!td_->option_manager_->get_option_boolean("is_premium")) {
+  if (!td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
     main_dialog_list_position = 0;
   }
 
@@ -1845,7 +1845,7 @@ void DialogFilterManager::on_reorder_dialog_filters(vector<DialogFilterId> dialo
 }
 
 void DialogFilterManager::toggle_dialog_filter_tags(bool are_tags_enabled, Promise<Unit> &&promise) {
-  if (!td_->option_manager_->get_option_boolean("is_premium")) {
+  if (!td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
     if (!are_tags_enabled) {
       return promise.set_value(Unit());
     }
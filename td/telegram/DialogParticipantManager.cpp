@@ -1786,10 +1786,89 @@ void DialogParticipantManager::get_channel_participants(ChannelId channel_id,
                        std::move(promise));
         }
       });
+  if (get_prefetched_channel_participants(channel_id, participant_filter, offset, limit,
+                                          get_channel_participants_promise)) {
+    return;
+  }
   td_->create_handler<GetChannelParticipantsQuery>(std::move(get_channel_participants_promise))
       ->send(channel_id, participant_filter, offset, limit);
 }
 
+bool DialogParticipantManager::get_prefetched_channel_participants(
+    ChannelId channel_id, const ChannelParticipantFilter &filter, int32 offset, int32 limit,
+    Promise<telegram_api::object_ptr<telegram_api::channels_channelParticipants>> &promise) {
+  auto it = prefetched_channel_participants_.find(channel_id);
+  if (it == prefetched_channel_participants_.end()) {
+    return false;
+  }
+  auto &prefetched = *it->second;
+  bool is_expired =
+      prefetched.is_received_ && prefetched.receive_time_ < Time::now() - PREFETCHED_CHANNEL_PARTICIPANTS_CACHE_TIME;
+  if (prefetched.filter_ != filter || prefetched.offset_ != offset || prefetched.limit_ != limit || is_expired) {
+    if (!prefetched.promise_) {
+      prefetched_channel_participants_.erase(it);
+    }
+    return false;
+  }
+  if (!prefetched.is_received_) {
+    if (prefetched.promise_) {
+      return false;
+    }
+    LOG(INFO) << "Wait for prefetched " << filter << " members in " << channel_id << " with offset " << offset;
+    prefetched.promise_ = std::move(promise);
+    return true;
+  }
+
+  LOG(INFO) << "Use prefetched " << filter << " members in " << channel_id << " with offset " << offset;
+  auto result = std::move(prefetched.result_);
+  prefetched_channel_participants_.erase(it);
+  promise.set_result(std::move(result));
+  return true;
+}
+
+void DialogParticipantManager::prefetch_channel_participants(ChannelId channel_id,
+                                                             const ChannelParticipantFilter &filter, int32 offset,
+                                                             int32 limit) {
+  auto &prefetched = prefetched_channel_participants_[channel_id];
+  if (prefetched != nullptr && prefetched->promise_) {
+    // the previous prefetched page is still needed
+    return;
+  }
+
+  LOG(INFO) << "Prefetch " << filter << " members in " << channel_id << " with offset " << offset;
+  auto prefetch_id = ++current_prefetch_channel_participants_id_;
+  prefetched = make_unique<PrefetchedChannelParticipants>(filter, offset, limit, prefetch_id);
+  auto query_promise = PromiseCreator::lambda(
+      [actor_id = actor_id(this), channel_id,
+       prefetch_id](Result<telegram_api::object_ptr<telegram_api::channels_channelParticipants>> &&result) {
+        send_closure(actor_id, &DialogParticipantManager::on_prefetch_channel_participants, channel_id, prefetch_id,
+                     std::move(result));
+      });
+  td_->create_handler<GetChannelParticipantsQuery>(std::move(query_promise))->send(channel_id, filter, offset, limit);
+}
+
+void DialogParticipantManager::on_prefetch_channel_participants(
+    ChannelId channel_id, uint64 prefetch_id,
+    Result<telegram_api::object_ptr<telegram_api::channels_channelParticipants>> &&result) {
+  auto it = prefetched_channel_participants_.find(channel_id);
+  if (it == prefetched_channel_participants_.end() || it->second->prefetch_id_ != prefetch_id) {
+    return;
+  }
+  auto &prefetched = *it->second;
+  if (prefetched.promise_) {
+    auto promise = std::move(prefetched.promise_);
+    prefetched_channel_participants_.erase(it);
+    return promise.set_result(std::move(result));
+  }
+  if (result.is_error()) {
+    prefetched_channel_participants_.erase(it);
+    return;
+  }
+  prefetched.is_received_ = true;
+  prefetched.receive_time_ = Time::now();
+  prefetched.result_ = std::move(result);
+}
+
 void DialogParticipantManager::on_get_channel_participants(
     ChannelId channel_id, ChannelParticipantFilter &&filter, int32 offset, int32 limit, string additional_query,
     int32 additional_limit, telegram_api::object_ptr<telegram_api::channels_channelParticipants> &&channel_participants,
@@ -1802,6 +1881,12 @@ void DialogParticipantManager::on_get_channel_participants(
   auto participants = std::move(channel_participants->participants_);
   LOG(INFO) << "Receive " << participants.size() << " " << filter << " members in " << channel_id;
 
+  if (limit == MAX_GET_CHANNEL_PARTICIPANTS && additional_query.empty() &&
+      static_cast<int32>(participants.size()) == limit && offset + limit < total_count) {
+    // the members are likely to be enumerated page by page, so request the next page while this one is processed
+    prefetch_channel_participants(channel_id, filter, offset + limit, limit);
+  }
+
   bool is_full = offset == 0 && static_cast<int32>(participants.size()) < limit && total_count < limit;
   bool has_hidden_participants =
       td_->chat_manager_->get_channel_effective_has_hidden_participants(channel_id, "on_get_channel_participants");
@@ -1810,7 +1895,6 @@ void DialogParticipantManager::on_get_channel_participants(
   auto channel_type = td_->chat_manager_->get_channel_type(channel_id);
   vector<DialogParticipant> result;
   for (auto &participant_ptr : participants) {
-    auto debug_participant = to_string(participant_ptr);
     result.emplace_back(std::move(participant_ptr), channel_type);
     const auto &participant = result.back();
     UserId participant_user_id;
@@ -1828,7 +1912,7 @@ void DialogParticipantManager::on_get_channel_participants(
                         (filter.is_contacts() && participant_user_id == td_->user_manager_->get_my_id());
       if (!skip_error) {
         LOG(ERROR) << "Receive " << participant << ", while searching for " << filter << " in " << channel_id
-                   << " with offset " << offset << " and limit " << limit << ": " << oneline(debug_participant);
+                   << " with offset " << offset << " and limit " << limit;
       }
       result.pop_back();
       total_count--;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "td/telegram/ChannelId.h"
+#include "td/telegram/ChannelParticipantFilter.h"
 #include "td/telegram/ChatId.h"
 #include "td/telegram/DialogAdministrator.h"
 #include "td/telegram/DialogId.h"
@@ -29,8 +30,6 @@
 
 namespace td {
 
-class ChannelParticipantFilter;
-
 class Td;
 
 class DialogParticipantManager final : public Actor {
@@ -161,6 +160,8 @@ class DialogParticipantManager final : public Actor {
 
   static constexpr int32 MAX_GET_CHANNEL_PARTICIPANTS = 200;  // server side limit
 
+  static constexpr double PREFETCHED_CHANNEL_PARTICIPANTS_CACHE_TIME = 60.0;
+
   void tear_down() final;
 
   static void on_update_dialog_online_member_count_timeout_callback(void *dialog_participant_manager_ptr,
@@ -222,6 +223,17 @@ class DialogParticipantManager final : public Actor {
       telegram_api::object_ptr<telegram_api::channels_channelParticipants> &&channel_participants,
       Promise<DialogParticipants> &&promise);
 
+  bool get_prefetched_channel_participants(
+      ChannelId channel_id, const ChannelParticipantFilter &filter, int32 offset, int32 limit,
+      Promise<telegram_api::object_ptr<telegram_api::channels_channelParticipants>> &promise);
+
+  void prefetch_channel_participants(ChannelId channel_id, const ChannelParticipantFilter &filter, int32 offset,
+                                     int32 limit);
+
+  void on_prefetch_channel_participants(
+      ChannelId channel_id, uint64 prefetch_id,
+      Result<telegram_api::object_ptr<telegram_api::channels_channelParticipants>> &&result);
+
   void set_chat_participant_status(ChatId chat_id, UserId user_id, DialogParticipantStatus status, bool is_recursive,
                                    Promise<Unit> &&promise);
 
@@ -309,6 +321,24 @@ class DialogParticipantManager final : public Actor {
   FlatHashMap<ChannelId, vector<Promise<td_api::object_ptr<td_api::failedToAddMembers>>>, ChannelIdHash>
       join_channel_queries_;
 
+  // the next page of members, requested in advance while all members of a supergroup are enumerated page by page
+  struct PrefetchedChannelParticipants {
+    ChannelParticipantFilter filter_;
+    int32 offset_ = 0;
+    int32 limit_ = 0;
+    uint64 prefetch_id_ = 0;
+    bool is_received_ = false;
+    double receive_time_ = 0.0;
+    Result<telegram_api::object_ptr<telegram_api::channels_channelParticipants>> result_;
+    Promise<telegram_api::object_ptr<telegram_api::channels_channelParticipants>> promise_;
+
+    PrefetchedChannelParticipants(ChannelParticipantFilter filter, int32 offset, int32 limit, uint64 prefetch_id)
+        : filter_(std::move(filter)), offset_(offset), limit_(limit), prefetch_id_(prefetch_id) {
+    }
+  };
+  FlatHashMap<ChannelId, unique_ptr<PrefetchedChannelParticipants>, ChannelIdHash> prefetched_channel_participants_;
+  uint64 current_prefetch_channel_participants_id_ = 0;
+
   MultiTimeout update_dialog_online_member_count_timeout_{"UpdateDialogOnlineMemberCountTimeout"};
   MultiTimeout channel_participant_cache_timeout_{"ChannelParticipantCacheTimeout"};
 
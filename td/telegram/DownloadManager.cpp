@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <functional>
 #include <limits>
+#include <map>
 #include <set>
 
 namespace td {
@@ -91,6 +92,7 @@ class DownloadManagerImpl final : public DownloadManager {
 
   void toggle_all_is_paused(bool is_paused, Promise<Unit> promise) final {
     TRY_STATUS_PROMISE(promise, check_is_active("toggle_all_is_paused"));
+    BatchGuard batch_guard(this);
 
     vector<FileId> to_toggle;
     for (auto &it : files_) {
@@ -116,12 +118,25 @@ class DownloadManagerImpl final : public DownloadManager {
     promise.set_value(Unit());
   }
 
+  void remove_files(vector<FileId> file_ids, bool delete_from_cache, Promise<Unit> promise) final {
+    TRY_STATUS_PROMISE(promise, check_is_active("remove_files"));
+    BatchGuard batch_guard(this);
+    for (auto file_id : file_ids) {
+      auto r_file_info_ptr = get_file_info_ptr(file_id);
+      if (r_file_info_ptr.is_ok()) {
+        remove_file_impl(*r_file_info_ptr.ok(), delete_from_cache, "remove_files");
+      }
+    }
+    promise.set_value(Unit());
+  }
+
   void remove_file_if_finished(FileId file_id) final {
     remove_file_if_finished_impl(file_id).ignore();
   }
 
   void remove_all_files(bool only_active, bool only_completed, bool delete_from_cache, Promise<Unit> promise) final {
     TRY_STATUS_PROMISE(promise, check_is_active("remove_all_files"));
+    BatchGuard batch_guard(this);
     vector<const FileInfo *> to_remove;
     for (auto &it : files_) {
       FileInfo &file_info = *it.second;
@@ -142,10 +157,23 @@ class DownloadManagerImpl final : public DownloadManager {
   void add_file(FileId file_id, FileSourceId file_source_id, string search_text, int8 priority,
                 Promise<td_api::object_ptr<td_api::file>> promise) final {
     TRY_STATUS_PROMISE(promise, check_is_active("add_file"));
+    add_file_impl(file_id, file_source_id, search_text, priority);
+    promise.set_value(callback_->get_file_object(file_id));
+  }
 
+  void add_files(vector<FileToAdd> files, int8 priority, Promise<Unit> promise) final {
+    TRY_STATUS_PROMISE(promise, check_is_active("add_files"));
+    BatchGuard batch_guard(this);
+    for (auto &file : files) {
+      add_file_impl(file.file_id, file.file_source_id, file.search_text, priority);
+    }
+    promise.set_value(Unit());
+  }
+
+  void add_file_impl(FileId file_id, FileSourceId file_source_id, const string &search_text, int8 priority) {
     auto old_file_info_ptr = get_file_info_ptr(file_id);
     if (old_file_info_ptr.is_ok()) {
-      remove_file_impl(*old_file_info_ptr.ok(), false, "add_file");
+      remove_file_impl(*old_file_info_ptr.ok(), false, "add_file_impl");
     }
 
     auto download_id = next_download_id();
@@ -160,8 +188,6 @@ class DownloadManagerImpl final : public DownloadManager {
     file_info->need_save_to_database = true;
 
     add_file_info(std::move(file_info), search_text);
-
-    promise.set_value(callback_->get_file_object(file_id));
   }
 
   void change_search_text(FileId file_id, FileSourceId file_source_id, string search_text) final {
@@ -227,8 +253,46 @@ class DownloadManagerImpl final : public DownloadManager {
       }
       offset_int64 = r_offset.move_as_ok();
     }
-    auto download_ids = hints_.search(query, 10000, true).second;
+    vector<int64> download_ids;
     FileCounters counters;
+    if (query.empty()) {
+      // all downloads match the query, so they can be enumerated in the order of download identifiers
+      counters = file_counters_;
+      auto it = files_.lower_bound(offset_int64);
+      while (it != files_.begin() && static_cast<int32>(download_ids.size()) < limit) {
+        --it;
+        if (only_active && is_completed(*it->second)) {
+          continue;
+        }
+        if (only_completed && !is_completed(*it->second)) {
+          continue;
+        }
+        download_ids.push_back(it->first);
+      }
+    } else {
+      download_ids = search_download_ids(query, only_active, only_completed, offset_int64, limit, counters);
+    }
+    auto file_downloads = transform(download_ids, [&](int64 download_id) {
+      on_file_viewed(download_id);
+
+      auto it = files_.find(download_id);
+      CHECK(it != files_.end());
+      const FileInfo &file_info = *it->second;
+      return callback_->get_file_download_object(file_info.file_id, file_info.file_source_id, file_info.created_at,
+                                                 file_info.completed_at, file_info.is_paused);
+    });
+    td::remove_if(file_downloads, [](const auto &file_download) { return file_download->message_ == nullptr; });
+    string next_offset;
+    if (!download_ids.empty()) {
+      next_offset = to_string(download_ids.back());
+    }
+    promise.set_value(td_api::make_object<td_api::foundFileDownloads>(counters.get_downloaded_file_counts_object(),
+                                                                      std::move(file_downloads), next_offset));
+  }
+
+  vector<int64> search_download_ids(const string &query, bool only_active, bool only_completed, int64 offset,
+                                    int32 limit, FileCounters &counters) {
+    auto download_ids = hints_.search(query, std::numeric_limits<int32>::max(), true).second;
     td::remove_if(download_ids, [&](int64 download_id) {
       auto r_file_info_ptr = get_file_info_ptr(download_id);
       CHECK(r_file_info_ptr.is_ok());
@@ -247,7 +311,7 @@ class DownloadManagerImpl final : public DownloadManager {
           return true;
         }
       }
-      if (download_id >= offset_int64) {
+      if (download_id >= offset) {
         return true;
       }
       return false;
@@ -256,22 +320,7 @@ class DownloadManagerImpl final : public DownloadManager {
     if (static_cast<int32>(download_ids.size()) > limit) {
       download_ids.resize(limit);
     }
-    auto file_downloads = transform(download_ids, [&](int64 download_id) {
-      on_file_viewed(download_id);
-
-      auto it = files_.find(download_id);
-      CHECK(it != files_.end());
-      const FileInfo &file_info = *it->second;
-      return callback_->get_file_download_object(file_info.file_id, file_info.file_source_id, file_info.created_at,
-                                                 file_info.completed_at, file_info.is_paused);
-    });
-    td::remove_if(file_downloads, [](const auto &file_download) { return file_download->message_ == nullptr; });
-    string next_offset;
-    if (!download_ids.empty()) {
-      next_offset = to_string(download_ids.back());
-    }
-    promise.set_value(td_api::make_object<td_api::foundFileDownloads>(counters.get_downloaded_file_counts_object(),
-                                                                      std::move(file_downloads), next_offset));
+    return download_ids;
   }
 
   void update_file_download_state(FileId internal_file_id, int64 downloaded_size, int64 size, int64 expected_size,
@@ -343,7 +392,7 @@ class DownloadManagerImpl final : public DownloadManager {
 
   FlatHashMap<FileId, int64, FileIdHash> by_file_id_;
   FlatHashMap<FileId, int64, FileIdHash> by_internal_file_id_;
-  FlatHashMap<int64, unique_ptr<FileInfo>> files_;
+  std::map<int64, unique_ptr<FileInfo>> files_;
   std::set<int64> completed_download_ids_;
   FlatHashSet<int64> unviewed_completed_download_ids_;
   Hints hints_;
@@ -359,6 +408,39 @@ class DownloadManagerImpl final : public DownloadManager {
   uint64 last_link_token_{0};
   MultiPromiseActor load_search_text_multipromise_{"LoadFileSearchTextMultiPromiseActor"};
 
+  // database removals and counter updates are postponed until the end of a batch
+  int32 batch_depth_ = 0;
+  vector<string> batch_removed_keys_;
+
+  class BatchGuard {
+   public:
+    explicit BatchGuard(DownloadManagerImpl *download_manager) : download_manager_(download_manager) {
+      download_manager_->batch_depth_++;
+    }
+    BatchGuard(const BatchGuard &) = delete;
+    BatchGuard &operator=(const BatchGuard &) = delete;
+    BatchGuard(BatchGuard &&) = delete;
+    BatchGuard &operator=(BatchGuard &&) = delete;
+    ~BatchGuard() {
+      download_manager_->finish_batch();
+    }
+
+   private:
+    DownloadManagerImpl *download_manager_;
+  };
+
+  void finish_batch() {
+    CHECK(batch_depth_ > 0);
+    if (--batch_depth_ != 0) {
+      return;
+    }
+    if (!batch_removed_keys_.empty()) {
+      G()->td_db()->get_binlog_pmc()->erase_batch(std::move(batch_removed_keys_));
+      batch_removed_keys_.clear();
+    }
+    update_counters();
+  }
+
   int64 next_download_id() {
     return ++max_download_id_;
   }
@@ -402,11 +484,15 @@ class DownloadManagerImpl final : public DownloadManager {
     G()->td_db()->get_binlog_pmc()->set(pmc_key(file_info), log_event_store(to_save).as_slice().str());
   }
 
-  static void remove_from_database(const FileInfo &file_info) {
+  void remove_from_database(const FileInfo &file_info) {
     if (!is_database_enabled()) {
       return;
     }
 
+    if (batch_depth_ > 0) {
+      batch_removed_keys_.push_back(pmc_key(file_info));
+      return;
+    }
     G()->td_db()->get_binlog_pmc()->erase(pmc_key(file_info));
   }
 
@@ -470,6 +556,7 @@ class DownloadManagerImpl final : public DownloadManager {
 
     LOG(INFO) << "Start Download Manager database loading";
 
+    BatchGuard batch_guard(this);
     auto downloads_in_kv = G()->td_db()->get_binlog_pmc()->prefix_get("dlds#");
     for (auto &it : downloads_in_kv) {
       Slice key = it.first;
@@ -649,7 +736,7 @@ class DownloadManagerImpl final : public DownloadManager {
   }
 
   void update_counters() {
-    if (!is_database_loaded_) {
+    if (!is_database_loaded_ || batch_depth_ > 0) {
       return;
     }
     if (counters_ == sent_counters_) {
@@ -82,6 +82,12 @@ class DownloadManager : public Actor {
                                                                               bool is_paused) = 0;
   };
 
+  struct FileToAdd {
+    FileId file_id;
+    FileSourceId file_source_id;
+    string search_text;
+  };
+
   static unique_ptr<DownloadManager> create(unique_ptr<Callback> callback);
 
   //
@@ -89,12 +95,14 @@ class DownloadManager : public Actor {
   //
   virtual void add_file(FileId file_id, FileSourceId file_source_id, string search_text, int8 priority,
                         Promise<td_api::object_ptr<td_api::file>> promise) = 0;
+  virtual void add_files(vector<FileToAdd> files, int8 priority, Promise<Unit> promise) = 0;
   virtual void toggle_is_paused(FileId file_id, bool is_paused, Promise<Unit> promise) = 0;
   virtual void toggle_all_is_paused(bool is_paused, Promise<Unit> promise) = 0;
   virtual void search(string query, bool only_active, bool only_completed, string offset, int32 limit,
                       Promise<td_api::object_ptr<td_api::foundFileDownloads>> promise) = 0;
   virtual void remove_file(FileId file_id, FileSourceId file_source_id, bool delete_from_cache,
                            Promise<Unit> promise) = 0;
+  virtual void remove_files(vector<FileId> file_ids, bool delete_from_cache, Promise<Unit> promise) = 0;
   virtual void remove_all_files(bool only_active, bool only_completed, bool delete_from_cache,
                                 Promise<Unit> promise) = 0;
 
@@ -339,13 +339,115 @@ void FileReferenceManager::send_query(Destination dest, FileSourceId file_source
     send_closure(file_manager_actor_id, &FileManager::on_file_reference_repaired, dest.node_id, file_source_id,
                  std::move(result), std::move(new_promise));
   });
+
+  auto &promises = source_query_promises_[file_source_id];
+  promises.push_back(std::move(promise));
+  if (promises.size() > 1) {
+    VLOG(file_references) << "Wait for the sent repair query from " << file_source_id;
+    return;
+  }
+
+  auto index = static_cast<size_t>(file_source_id.get()) - 1;
+  CHECK(index < file_sources_.size());
+  const auto &file_source = file_sources_[index];
+  if (file_source.get_offset() == 0) {
+    auto dialog_id = file_source.get<FileSourceMessage>().message_full_id.get_dialog_id();
+    auto &message_source_ids = pending_message_source_ids_[dialog_id];
+    message_source_ids.push_back(file_source_id);
+    if (message_source_ids.size() > 1) {
+      // the message will be repaired together with the previous messages from the chat
+      return;
+    }
+  }
+  pending_source_ids_.push(file_source_id);
+
+  if (!is_send_source_queries_scheduled_) {
+    // wait for other repair queries, which may be created simultaneously
+    is_send_source_queries_scheduled_ = true;
+    send_closure_later(actor_id(this), &FileReferenceManager::send_pending_source_queries);
+  }
+}
+
+void FileReferenceManager::send_pending_source_queries() {
+  is_send_source_queries_scheduled_ = false;
+  while (active_source_query_count_ < MAX_ACTIVE_SOURCE_QUERIES && !pending_source_ids_.empty()) {
+    auto file_source_id = pending_source_ids_.pop();
+    active_source_query_count_++;
+
+    auto index = static_cast<size_t>(file_source_id.get()) - 1;
+    CHECK(index < file_sources_.size());
+    const auto &file_source = file_sources_[index];
+    if (file_source.get_offset() != 0) {
+      send_source_query(file_source_id);
+      continue;
+    }
+
+    auto dialog_id = file_source.get<FileSourceMessage>().message_full_id.get_dialog_id();
+    auto it = pending_message_source_ids_.find(dialog_id);
+    CHECK(it != pending_message_source_ids_.end());
+    CHECK(!it->second.empty() && it->second[0] == file_source_id);
+    vector<FileSourceId> file_source_ids;
+    if (it->second.size() > MAX_MESSAGE_SOURCE_BATCH_SIZE) {
+      auto batch_end = it->second.begin() + MAX_MESSAGE_SOURCE_BATCH_SIZE;
+      file_source_ids.assign(it->second.begin(), batch_end);
+      it->second.erase(it->second.begin(), batch_end);
+      pending_source_ids_.push(it->second[0]);
+    } else {
+      file_source_ids = std::move(it->second);
+      pending_message_source_ids_.erase(it);
+    }
+    send_message_source_queries(std::move(file_source_ids));
+  }
+}
+
+void FileReferenceManager::send_message_source_queries(vector<FileSourceId> file_source_ids) {
+  vector<MessageFullId> message_full_ids;
+  for (auto file_source_id : file_source_ids) {
+    auto index = static_cast<size_t>(file_source_id.get()) - 1;
+    CHECK(index < file_sources_.size());
+    message_full_ids.push_back(file_sources_[index].get<FileSourceMessage>().message_full_id);
+  }
+  VLOG(file_references) << "Repair file references from " << message_full_ids.size() << " messages in "
+                        << message_full_ids[0].get_dialog_id();
+  auto promise = PromiseCreator::lambda(
+      [actor_id = actor_id(this), file_source_ids = std::move(file_source_ids)](Result<Unit> result) mutable {
+        send_closure(actor_id, &FileReferenceManager::on_source_query_result, std::move(file_source_ids),
+                     std::move(result));
+      });
+  send_closure_later(G()->messages_manager(), &MessagesManager::get_messages_from_server, std::move(message_full_ids),
+                     std::move(promise), "FileSourceMessage", nullptr);
+}
+
+void FileReferenceManager::on_source_query_result(vector<FileSourceId> file_source_ids, Result<Unit> result) {
+  CHECK(active_source_query_count_ > 0);
+  active_source_query_count_--;
+
+  for (auto file_source_id : file_source_ids) {
+    auto it = source_query_promises_.find(file_source_id);
+    CHECK(it != source_query_promises_.end());
+    auto promises = std::move(it->second);
+    source_query_promises_.erase(it);
+    for (auto &promise : promises) {
+      if (result.is_error()) {
+        promise.set_error(result.error().clone());
+      } else {
+        promise.set_value(Unit());
+      }
+    }
+  }
+
+  send_pending_source_queries();
+}
+
+void FileReferenceManager::send_source_query(FileSourceId file_source_id) {
+  auto promise = PromiseCreator::lambda([actor_id = actor_id(this), file_source_id](Result<Unit> result) {
+    send_closure(actor_id, &FileReferenceManager::on_source_query_result, vector<FileSourceId>{file_source_id},
+                 std::move(result));
+  });
   auto index = static_cast<size_t>(file_source_id.get()) - 1;
   CHECK(index < file_sources_.size());
   file_sources_[index].visit(overloaded(
-      [&](const FileSourceMessage &source) {
-        send_closure_later(G()->messages_manager(), &MessagesManager::get_message_from_server, source.message_full_id,
-                           std::move(promise), "FileSourceMessage", nullptr);
-      },
+      [&](const FileSourceMessage &source) { UNREACHABLE(); },
       [&](const FileSourceUserPhoto &source) {
         send_closure_later(G()->user_manager(), &UserManager::reload_user_profile_photo, source.user_id,
                            source.photo_id, std::move(promise));
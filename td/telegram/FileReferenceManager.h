@@ -23,11 +23,13 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/logging.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 #include "td/utils/Variant.h"
+#include "td/utils/VectorQueue.h"
 #include "td/utils/WaitFreeHashMap.h"
 #include "td/utils/WaitFreeVector.h"
 
@@ -210,12 +212,31 @@ class FileReferenceManager final : public Actor {
 
   WaitFreeHashMap<NodeId, unique_ptr<Node>, FileIdHash> nodes_;
 
+  // repair queries from the same file source are shared between files, message file sources from the same chat
+  // are repaired by a single query, and the number of simultaneously sent queries is limited
+  static constexpr size_t MAX_ACTIVE_SOURCE_QUERIES = 10;
+  static constexpr size_t MAX_MESSAGE_SOURCE_BATCH_SIZE = 100;
+
+  FlatHashMap<FileSourceId, vector<Promise<Unit>>, FileSourceIdHash> source_query_promises_;
+  FlatHashMap<DialogId, vector<FileSourceId>, DialogIdHash> pending_message_source_ids_;
+  VectorQueue<FileSourceId> pending_source_ids_;
+  size_t active_source_query_count_ = 0;
+  bool is_send_source_queries_scheduled_ = false;
+
   ActorShared<> parent_;
 
   Node &add_node(NodeId node_id);
 
   void run_node(NodeId node);
   void send_query(Destination dest, FileSourceId file_source_id);
+
+  void send_pending_source_queries();
+
+  void send_source_query(FileSourceId file_source_id);
+
+  void send_message_source_queries(vector<FileSourceId> file_source_ids);
+
+  void on_source_query_result(vector<FileSourceId> file_source_ids, Result<Unit> result);
   Destination on_query_result(Destination dest, FileSourceId file_source_id, Status status, int32 sub = 0);
 
   template <class T>
@@ -305,6 +305,14 @@ int64 Global::get_option_integer(Slice name, int64 default_value) const {
   return get_option_manager()->get_option_integer(name, default_value);
 }
 
+bool Global::get_option_boolean(CachedOption option) const {
+  return get_option_manager()->get_option_boolean(option);
+}
+
+int64 Global::get_option_integer(CachedOption option) const {
+  return get_option_manager()->get_option_integer(option);
+}
+
 string Global::get_option_string(Slice name, string default_value) const {
   return get_option_manager()->get_option_string(name, std::move(default_value));
 }
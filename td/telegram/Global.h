@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/telegram/CachedOption.h"
 #include "td/telegram/DhConfig.h"
 #include "td/telegram/net/DcId.h"
 #include "td/telegram/net/MtprotoHeader.h"
@@ -162,6 +163,10 @@ class Global final : public ActorContext {
 
   string get_option_string(Slice name, string default_value = "") const;
 
+  bool get_option_boolean(CachedOption option) const;
+
+  int64 get_option_integer(CachedOption option) const;
+
   bool is_server_time_reliable() const {
     return server_time_difference_was_updated_.load(std::memory_order_relaxed);
   }
@@ -36,9 +36,17 @@ void HashtagHints::hashtag_used(const string &hashtag) {
   if (!sync_with_db_) {
     return;
   }
+  auto key = Hash<string>()(hashtag);
+  if (key == last_used_key_ && hints_.has_key(key)) {
+    // the hashtag is already the most recently used
+    return;
+  }
   hashtag_used_impl(hashtag);
-  G()->td_db()->get_sqlite_pmc()->set(get_key(), serialize(keys_to_strings(hints_.search_empty(101).second)),
-                                      Promise<Unit>());
+
+  // frequently used hashtags are saved at most once in SAVE_DELAY seconds
+  if (!has_timeout()) {
+    set_timeout_in(SAVE_DELAY);
+  }
 }
 
 void HashtagHints::remove_hashtag(string hashtag, Promise<Unit> promise) {
@@ -51,8 +59,7 @@ void HashtagHints::remove_hashtag(string hashtag, Promise<Unit> promise) {
   auto key = Hash<string>()(hashtag);
   if (hints_.has_key(key)) {
     hints_.remove(key);
-    G()->td_db()->get_sqlite_pmc()->set(get_key(), serialize(keys_to_strings(hints_.search_empty(101).second)),
-                                        Promise<Unit>());
+    save_to_db();
     promise.set_value(Unit());  // set promise explicitly, because sqlite_pmc waits for too long before setting promise
   } else {
     promise.set_value(Unit());
@@ -64,7 +71,7 @@ void HashtagHints::clear(Promise<Unit> promise) {
     return promise.set_value(Unit());
   }
   hints_ = {};
-  G()->td_db()->get_sqlite_pmc()->set(get_key(), serialize(vector<string>()), Promise<Unit>());
+  save_to_db();
   promise.set_value(Unit());
 }
 
@@ -83,6 +90,23 @@ string HashtagHints::get_key() const {
   return "hashtag_hints#" + mode_;
 }
 
+void HashtagHints::timeout_expired() {
+  save_to_db();
+}
+
+void HashtagHints::hangup() {
+  if (has_timeout()) {
+    save_to_db();
+  }
+  stop();
+}
+
+void HashtagHints::save_to_db() {
+  cancel_timeout();
+  G()->td_db()->get_sqlite_pmc()->set(
+      get_key(), serialize(keys_to_strings(hints_.search_empty(MAX_SAVED_HASHTAGS).second)), Promise<Unit>());
+}
+
 void HashtagHints::hashtag_used_impl(const string &hashtag) {
   if (!check_utf8(hashtag)) {
     LOG(ERROR) << "Trying to add invalid UTF-8 hashtag \"" << hashtag << '"';
@@ -92,6 +116,7 @@ void HashtagHints::hashtag_used_impl(const string &hashtag) {
   auto key = Hash<string>()(hashtag);
   hints_.add(key, hashtag);
   hints_.set_rating(key, -++counter_);
+  last_used_key_ = key;
 }
 
 void HashtagHints::from_db(Result<string> data, bool dummy) {
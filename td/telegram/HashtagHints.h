@@ -33,13 +33,23 @@ class HashtagHints final : public Actor {
   char first_character_ = '#';
   bool sync_with_db_ = false;
   int64 counter_ = 0;
+  int64 last_used_key_ = 0;
 
   ActorShared<> parent_;
 
+  static constexpr double SAVE_DELAY = 1.0;  // seconds
+  static constexpr int32 MAX_SAVED_HASHTAGS = 101;
+
   string get_key() const;
 
   void start_up() final;
 
+  void timeout_expired() final;
+
+  void hangup() final;
+
+  void save_to_db();
+
   void hashtag_used_impl(const string &hashtag);
   void from_db(Result<string> data, bool dummy);
   vector<string> keys_to_strings(const vector<int64> &keys);
@@ -303,7 +303,7 @@ void InlineMessageManager::edit_inline_message_media(
     return promise.set_error(Status::Error(400, "Unsupported input message content type"));
   }
 
-  bool is_premium = td_->option_manager_->get_option_boolean("is_premium");
+  bool is_premium = td_->option_manager_->get_option_boolean(CachedOption::IsPremium);
   TRY_RESULT_PROMISE(promise, content,
                      get_input_message_content(DialogId(), std::move(input_message_content), td_, is_premium));
   if (!content.ttl.is_empty()) {
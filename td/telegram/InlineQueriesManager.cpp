@@ -60,13 +60,72 @@
 #include "td/utils/Time.h"
 #include "td/utils/tl_helpers.h"
 
+#include <mutex>
+
 namespace td {
 
+namespace {
+
+// messages.botResults responses, shared between all clients in the process, which use the same bots;
+// only raw responses can be shared, because parsed results reference client file identifiers
+struct SharedInlineQueryResults {
+  struct Entry {
+    double expire_time = 0.0;
+    string packet;
+  };
+  std::mutex mutex;
+  FlatHashMap<uint64, Entry> entries;  // query_hash -> response
+};
+
+constexpr size_t MAX_SHARED_INLINE_QUERY_RESULTS = 1000;
+
+SharedInlineQueryResults &get_shared_inline_query_results() {
+  static SharedInlineQueryResults inline_query_results;
+  return inline_query_results;
+}
+
+// returns the response and the time for which it can be cached
+std::pair<BufferSlice, int32> get_shared_inline_query_results_packet(uint64 query_hash) {
+  auto &inline_query_results = get_shared_inline_query_results();
+  std::lock_guard<std::mutex> lock(inline_query_results.mutex);
+  auto it = inline_query_results.entries.find(query_hash);
+  if (it == inline_query_results.entries.end()) {
+    return {};
+  }
+  auto cache_time = static_cast<int32>(it->second.expire_time - Time::now());
+  if (cache_time <= 0) {
+    inline_query_results.entries.erase(it);
+    return {};
+  }
+  return {BufferSlice(it->second.packet), cache_time};
+}
+
+void add_shared_inline_query_results_packet(uint64 query_hash, int32 cache_time, Slice packet) {
+  auto &inline_query_results = get_shared_inline_query_results();
+  std::lock_guard<std::mutex> lock(inline_query_results.mutex);
+  if (inline_query_results.entries.size() >= MAX_SHARED_INLINE_QUERY_RESULTS &&
+      inline_query_results.entries.count(query_hash) == 0) {
+    auto first_expiring_it = inline_query_results.entries.begin();
+    for (auto it = inline_query_results.entries.begin(); it != inline_query_results.entries.end(); ++it) {
+      if (it->second.expire_time < first_expiring_it->second.expire_time) {
+        first_expiring_it = it;
+      }
+    }
+    inline_query_results.entries.erase(first_expiring_it);
+  }
+  auto &entry = inline_query_results.entries[query_hash];
+  entry.expire_time = Time::now() + cache_time;
+  entry.packet = packet.str();
+}
+
+}  // namespace
+
 class GetInlineBotResultsQuery final : public Td::ResultHandler {
   Promise<td_api::object_ptr<td_api::inlineQueryResults>> promise_;
   DialogId dialog_id_;
   UserId bot_user_id_;
   uint64 query_hash_;
+  int32 shared_cache_time_ = 0;
 
   static constexpr int32 GET_INLINE_BOT_RESULTS_FLAG_HAS_LOCATION = 1 << 0;
 
@@ -96,14 +155,30 @@ class GetInlineBotResultsQuery final : public Td::ResultHandler {
     return result;
   }
 
+  void send_shared(UserId bot_user_id, DialogId dialog_id, uint64 query_hash, BufferSlice packet, int32 cache_time) {
+    CHECK(cache_time > 0);
+    bot_user_id_ = bot_user_id;
+    dialog_id_ = dialog_id;
+    query_hash_ = query_hash;
+    shared_cache_time_ = cache_time;
+    on_result(std::move(packet));
+  }
+
   void on_result(BufferSlice packet) final {
     auto result_ptr = fetch_result<telegram_api::messages_getInlineBotResults>(packet);
     if (result_ptr.is_error()) {
       return on_error(result_ptr.move_as_error());
     }
 
+    auto results = result_ptr.move_as_ok();
+    if (shared_cache_time_ > 0) {
+      // the results must not be cached longer than by the client, which received them from the server
+      results->cache_time_ = shared_cache_time_;
+    } else if (results->cache_time_ > 0 && G()->get_option_boolean("use_shared_inline_query_cache")) {
+      add_shared_inline_query_results_packet(query_hash_, results->cache_time_, packet.as_slice());
+    }
     td_->inline_queries_manager_->on_get_inline_query_results(dialog_id_, bot_user_id_, query_hash_,
-                                                              result_ptr.move_as_ok(), std::move(promise_));
+                                                              std::move(results), std::move(promise_));
   }
 
   void on_error(Status status) final {
@@ -1046,6 +1121,12 @@ void InlineQueriesManager::on_get_weather(td_api::object_ptr<td_api::inlineQuery
 void InlineQueriesManager::send_inline_query(UserId bot_user_id, DialogId dialog_id, Location user_location,
                                              const string &query, const string &offset,
                                              Promise<td_api::object_ptr<td_api::inlineQueryResults>> &&promise) {
+  do_send_inline_query(bot_user_id, dialog_id, user_location, query, offset, false, std::move(promise));
+}
+
+void InlineQueriesManager::do_send_inline_query(UserId bot_user_id, DialogId dialog_id, Location user_location,
+                                                const string &query, const string &offset, bool is_prefetch,
+                                                Promise<td_api::object_ptr<td_api::inlineQueryResults>> &&promise) {
   CHECK(!td_->auth_manager_->is_bot());
 
   auto r_bot_data = td_->user_manager_->get_bot_data(bot_user_id);
@@ -1095,13 +1176,57 @@ void InlineQueriesManager::send_inline_query(UserId bot_user_id, DialogId dialog
   }
 
   auto it = inline_query_results_.find(query_hash);
-  if (it != inline_query_results_.end()) {
-    it->second.pending_request_count++;
-    if (Time::now() < it->second.cache_expire_time) {
-      return promise.set_value(get_inline_query_results_object(query_hash));
+  if (is_prefetch) {
+    if (it != inline_query_results_.end() || pending_inline_query_ != nullptr) {
+      // the page is already loaded or is being loaded, or the user has sent another query
+      return;
     }
-  } else {
+    LOG(INFO) << "Prefetch inline query " << query_hash;
     inline_query_results_[query_hash] = {nullptr, -1.0, 1};
+    prefetch_queries_[query_hash];
+    promise = PromiseCreator::lambda(
+        [actor_id = actor_id(this), query_hash](Result<td_api::object_ptr<td_api::inlineQueryResults>> r_results) {
+          send_closure(actor_id, &InlineQueriesManager::on_prefetch_inline_query_results, query_hash,
+                       std::move(r_results));
+        });
+  } else {
+    if (it != inline_query_results_.end()) {
+      it->second.pending_request_count++;
+      if (Time::now() < it->second.cache_expire_time) {
+        return promise.set_value(get_inline_query_results_object(query_hash));
+      }
+      auto prefetch_it = prefetch_queries_.find(query_hash);
+      if (prefetch_it != prefetch_queries_.end()) {
+        LOG(INFO) << "Wait for prefetched inline query " << query_hash;
+        prefetch_it->second.push_back(std::move(promise));
+        return;
+      }
+    } else {
+      inline_query_results_[query_hash] = {nullptr, -1.0, 1};
+    }
+
+    last_user_query_hash_ = query_hash;
+    if (G()->get_option_boolean("prefetch_inline_query_results")) {
+      promise = PromiseCreator::lambda([actor_id = actor_id(this), bot_user_id, dialog_id, user_location, query,
+                                        query_hash, promise = std::move(promise)](
+                                           Result<td_api::object_ptr<td_api::inlineQueryResults>> r_results) mutable {
+        if (r_results.is_ok() && !r_results.ok()->next_offset_.empty()) {
+          send_closure(actor_id, &InlineQueriesManager::prefetch_inline_query_results, bot_user_id, dialog_id,
+                       user_location, query, r_results.ok()->next_offset_, query_hash);
+        }
+        promise.set_result(std::move(r_results));
+      });
+    }
+  }
+
+  if (G()->get_option_boolean("use_shared_inline_query_cache")) {
+    auto shared_results = get_shared_inline_query_results_packet(query_hash);
+    if (!shared_results.first.empty()) {
+      LOG(INFO) << "Receive inline query " << query_hash << " from the shared cache";
+      td_->create_handler<GetInlineBotResultsQuery>(std::move(promise))
+          ->send_shared(bot_user_id, dialog_id, query_hash, std::move(shared_results.first), shared_results.second);
+      return;
+    }
   }
 
   if (pending_inline_query_ != nullptr) {
@@ -1117,6 +1242,39 @@ void InlineQueriesManager::send_inline_query(UserId bot_user_id, DialogId dialog
   loop();
 }
 
+void InlineQueriesManager::prefetch_inline_query_results(UserId bot_user_id, DialogId dialog_id,
+                                                         Location user_location, const string &query,
+                                                         const string &offset, uint64 previous_query_hash) {
+  if (G()->close_flag() || previous_query_hash != last_user_query_hash_) {
+    // the user has already sent another query
+    return;
+  }
+  auto it = inline_query_results_.find(previous_query_hash);
+  if (it == inline_query_results_.end() || it->second.cache_expire_time <= Time::now()) {
+    // the results must not be cached by the client, so the next page must not be cached either
+    return;
+  }
+  do_send_inline_query(bot_user_id, dialog_id, user_location, query, offset, true, Auto());
+}
+
+void InlineQueriesManager::on_prefetch_inline_query_results(
+    uint64 query_hash, Result<td_api::object_ptr<td_api::inlineQueryResults>> r_results) {
+  auto it = prefetch_queries_.find(query_hash);
+  CHECK(it != prefetch_queries_.end());
+  auto promises = std::move(it->second);
+  prefetch_queries_.erase(it);
+
+  LOG(INFO) << "Receive prefetched inline query " << query_hash << " awaited by " << promises.size() << " requests";
+  for (auto &promise : promises) {
+    auto results = get_inline_query_results_object(query_hash);
+    if (r_results.is_error()) {
+      promise.set_error(r_results.error().clone());
+    } else {
+      promise.set_value(std::move(results));
+    }
+  }
+}
+
 void InlineQueriesManager::loop() {
   if (pending_inline_query_ == nullptr) {
     return;
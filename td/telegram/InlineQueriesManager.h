@@ -123,6 +123,16 @@ class InlineQueriesManager final : public Actor {
   void on_get_weather(td_api::object_ptr<td_api::inlineQueryResults> results,
                       Promise<td_api::object_ptr<td_api::currentWeather>> &&promise);
 
+  void do_send_inline_query(UserId bot_user_id, DialogId dialog_id, Location user_location, const string &query,
+                            const string &offset, bool is_prefetch,
+                            Promise<td_api::object_ptr<td_api::inlineQueryResults>> &&promise);
+
+  void prefetch_inline_query_results(UserId bot_user_id, DialogId dialog_id, Location user_location,
+                                     const string &query, const string &offset, uint64 previous_query_hash);
+
+  void on_prefetch_inline_query_results(uint64 query_hash,
+                                        Result<td_api::object_ptr<td_api::inlineQueryResults>> r_results);
+
   td_api::object_ptr<td_api::inlineQueryResults> get_inline_query_results_object(uint64 query_hash);
 
   static void on_drop_inline_query_result_timeout_callback(void *inline_queries_manager_ptr, int64 query_hash);
@@ -160,6 +170,10 @@ class InlineQueriesManager final : public Actor {
   MultiTimeout drop_inline_query_result_timeout_{"DropInlineQueryResultTimeout"};
   FlatHashMap<uint64, InlineQueryResult> inline_query_results_;  // query_hash -> result
 
+  uint64 last_user_query_hash_ = 0;
+  FlatHashMap<uint64, vector<Promise<td_api::object_ptr<td_api::inlineQueryResults>>>>
+      prefetch_queries_;  // query_hash -> requests, waiting for the prefetched results
+
   FlatHashMap<int64, FlatHashMap<string, InlineMessageContent>>
       inline_message_contents_;  // query_id -> [result_id -> inline_message_content]
 
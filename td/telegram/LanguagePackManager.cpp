@@ -21,6 +21,8 @@
 #include "td/utils/FlatHashSet.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
+#include "td/utils/PathView.h"
+#include "td/utils/port/path.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 
@@ -155,9 +157,10 @@ static int32 load_database_language_key_count(SqliteKeyValue *kv) {
   if (str_key_count.empty()) {
     // calculate key count once for the database and cache it
     int key_count = 0;
-    for (auto &str : kv->get_all()) {
-      key_count += str.first[0] != '!' && (str.second[0] == '1' || str.second[0] == '2');
-    }
+    kv->get_all([&key_count](Slice key, Slice value) {
+      key_count += key[0] != '!' && !value.empty() && (value[0] == '1' || value[0] == '2');
+      return true;
+    });
     LOG(INFO) << "Set language pack key count in database to " << key_count;
     kv->set("!key_count", to_string(key_count));
     return key_count;
@@ -174,7 +177,28 @@ static string load_database_language_base_language_code(SqliteKeyValue *kv) {
   return kv->get("!base_language_code");
 }
 
+// returns canonical path to the database to share it between all clients, which use the same database file
+static string get_canonical_database_path(const string &path) {
+  if (path.empty()) {
+    return path;
+  }
+  auto r_path = realpath(path, true);
+  if (r_path.is_ok()) {
+    return r_path.move_as_ok();
+  }
+
+  // the database hasn't been created yet
+  PathView path_view(path);
+  auto parent_dir = path_view.parent_dir();
+  auto r_parent_dir = realpath(parent_dir.empty() ? string("./") : parent_dir.str(), true);
+  if (r_parent_dir.is_error()) {
+    return path;
+  }
+  return PSTRING() << r_parent_dir.ok() << path_view.file_name();
+}
+
 LanguagePackManager::LanguageDatabase *LanguagePackManager::add_language_database(string path) {
+  path = get_canonical_database_path(path);
   auto it = language_databases_.find(path);
   if (it != language_databases_.end()) {
     return it->second.get();
@@ -744,17 +768,18 @@ bool LanguagePackManager::load_language_strings(LanguageDatabase *database, Lang
       return false;
     }
 
-    auto all_strings = language->kv_.get_all();
-    for (auto &str : all_strings) {
-      if (str.first[0] == '!') {
-        continue;
+    language->kv_.get_all([language](Slice key, Slice value) {
+      if (key[0] == '!') {
+        return true;
       }
 
-      if (!language_has_string_unsafe(language, str.first)) {
-        LOG(DEBUG) << "Load string with key " << str.first << " from database";
-        load_language_string_unsafe(language, str.first, str.second);
+      auto str_key = key.str();
+      if (!language_has_string_unsafe(language, str_key)) {
+        LOG(DEBUG) << "Load string with key " << str_key << " from database";
+        load_language_string_unsafe(language, str_key, value.str());
       }
-    }
+      return true;
+    });
     language->was_loaded_full_ = true;
 
     if (language->version_ == -1) {
@@ -0,0 +1,48 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/MemoryStatistics.h"
+
+#include "td/db/SqliteDb.h"
+
+#include "td/utils/algorithm.h"
+#include "td/utils/buffer.h"
+#include "td/utils/misc.h"
+
+#include <utility>
+
+namespace td {
+
+constexpr size_t MemoryStatistics::HASH_TABLE_NODE_SIZE;
+
+void MemoryStatistics::add_component(Slice name, size_t object_count, size_t size) {
+  Component component;
+  component.name_ = name.str();
+  component.object_count_ = static_cast<int64>(object_count);
+  component.size_ = static_cast<int64>(size);
+  components_.push_back(std::move(component));
+}
+
+void MemoryStatistics::add_process_components() {
+  add_component("process.buffers", 0, BufferAllocator::get_buffer_mem());
+  add_component("process.buffer_cache", 0, BufferAllocator::get_buffer_cache_mem());
+  auto sqlite_memory_used = SqliteDb::get_memory_used();
+  add_component("process.sqlite", 0, static_cast<size_t>(max(sqlite_memory_used, static_cast<int64>(0))));
+}
+
+td_api::object_ptr<td_api::memoryStatistics> MemoryStatistics::get_memory_statistics_object() const {
+  int64 total_size = 0;
+  auto components = transform(components_, [&total_size](const Component &component) {
+    if (!begins_with(component.name_, "process.")) {
+      total_size += component.size_;
+    }
+    return td_api::make_object<td_api::componentMemoryUsage>(component.name_, component.object_count_,
+                                                             component.size_);
+  });
+  return td_api::make_object<td_api::memoryStatistics>(std::move(components), total_size);
+}
+
+}  // namespace td
@@ -0,0 +1,45 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/telegram/td_api.h"
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+namespace td {
+
+// estimates of memory used by components of a TDLib instance; each manager adds its components
+// in get_memory_statistics, accounting for the main structures, but not for memory owned by them indirectly
+class MemoryStatistics {
+ public:
+  void add_component(Slice name, size_t object_count, size_t size);
+
+  // adds size of objects of type T, which are stored in a hash table by a unique_ptr
+  template <class T>
+  void add_objects(Slice name, size_t object_count) {
+    add_component(name, object_count, object_count * (sizeof(T) + HASH_TABLE_NODE_SIZE));
+  }
+
+  // adds memory used by components, which are shared between all TDLib instances in the process
+  void add_process_components();
+
+  td_api::object_ptr<td_api::memoryStatistics> get_memory_statistics_object() const;
+
+ private:
+  // a key, a pointer to the object and a free space in the hash table for them
+  static constexpr size_t HASH_TABLE_NODE_SIZE = 3 * sizeof(void *);
+
+  struct Component {
+    string name_;
+    int64 object_count_ = 0;
+    int64 size_ = 0;
+  };
+  vector<Component> components_;
+};
+
+}  // namespace td
@@ -10,11 +10,13 @@
 #include "td/telegram/UserId.h"
 #include "td/telegram/Version.h"
 
+#include "td/db/BlobCompression.h"
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteStatement.h"
 
 #include "td/actor/actor.h"
+#include "td/actor/MultiPromise.h"
 #include "td/actor/SchedulerLocalStorage.h"
 
 #include "td/utils/format.h"
@@ -39,7 +41,6 @@
 namespace td {
 
 static constexpr int32 MESSAGE_DB_INDEX_COUNT = 30;
-static constexpr int32 MESSAGE_DB_INDEX_COUNT_OLD = 9;
 
 // NB: must happen inside a transaction
 Status init_message_db(SqliteDb &db, int32 version) {
@@ -54,11 +55,37 @@ Status init_message_db(SqliteDb &db, int32 version) {
     version = 0;
   }
 
-  auto add_media_indices = [&db](int begin, int end) {
-    for (int i = begin; i < end; i++) {
-      TRY_STATUS(db.exec(PSLICE() << "CREATE INDEX IF NOT EXISTS message_index_" << i
-                                  << " ON messages (dialog_id, message_id) WHERE (index_mask & " << (1 << i)
-                                  << ") != 0"));
+  // message_index contains a row for each bit set in index_mask of a message and replaces partial indices
+  // message_index_0..29, predicates of which had to be checked for every added message
+  auto add_index_table = [&db] {
+    TRY_STATUS(
+        db.exec("CREATE TABLE IF NOT EXISTS message_index (dialog_id INT8, index_id INT4, message_id INT8, "
+                "PRIMARY KEY (dialog_id, index_id, message_id)) WITHOUT ROWID"));
+
+    string delete_trigger;
+    for (int i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
+      delete_trigger += PSTRING() << " DELETE FROM message_index WHERE dialog_id = OLD.dialog_id AND index_id = " << i
+                                  << " AND message_id = OLD.message_id AND (OLD.index_mask & " << (1 << i)
+                                  << ") != 0;";
+    }
+    // rows are added to message_index by MessageDbImpl::add_message
+    TRY_STATUS(db.exec(PSLICE() << "CREATE TRIGGER IF NOT EXISTS trigger_message_index_delete AFTER DELETE ON "
+                                   "messages WHEN OLD.index_mask IS NOT NULL BEGIN"
+                                << delete_trigger << " END"));
+    return Status::OK();
+  };
+
+  auto move_media_indices_to_index_table = [&db] {
+    string index_ids;
+    for (int i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
+      index_ids += PSTRING() << (i == 0 ? "" : ", ") << '(' << i << ')';
+    }
+    TRY_STATUS(db.exec(PSLICE() << "INSERT OR IGNORE INTO message_index SELECT dialog_id, column1, message_id FROM "
+                                   "messages, (VALUES "
+                                << index_ids
+                                << ") WHERE index_mask IS NOT NULL AND (index_mask & (1 << column1)) != 0"));
+    for (int i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
+      TRY_STATUS(db.exec(PSLICE() << "DROP INDEX IF EXISTS message_index_" << i));
     }
     return Status::OK();
   };
@@ -130,7 +157,7 @@ Status init_message_db(SqliteDb &db, int32 version) {
         db.exec("CREATE INDEX IF NOT EXISTS message_by_ttl ON messages "
                 "(ttl_expires_at) WHERE ttl_expires_at IS NOT NULL"));
 
-    TRY_STATUS(add_media_indices(0, MESSAGE_DB_INDEX_COUNT));
+    TRY_STATUS(add_index_table());
 
     TRY_STATUS(add_fts());
 
@@ -144,11 +171,8 @@ Status init_message_db(SqliteDb &db, int32 version) {
   }
   if (version < static_cast<int32>(DbVersion::AddMessageDbMediaIndex)) {
     TRY_STATUS(db.exec("ALTER TABLE messages ADD COLUMN index_mask INT4"));
-    TRY_STATUS(add_media_indices(0, MESSAGE_DB_INDEX_COUNT_OLD));
-  }
-  if (version < static_cast<int32>(DbVersion::AddMessageDb30MediaIndex)) {
-    TRY_STATUS(add_media_indices(MESSAGE_DB_INDEX_COUNT_OLD, MESSAGE_DB_INDEX_COUNT));
   }
+  // media indices created by AddMessageDbMediaIndex and AddMessageDb30MediaIndex are replaced with message_index
   if (version < static_cast<int32>(DbVersion::AddMessageDbFts)) {
     TRY_STATUS(db.exec("ALTER TABLE messages ADD COLUMN search_id INT8"));
     TRY_STATUS(db.exec("ALTER TABLE messages ADD COLUMN text STRING"));
@@ -167,6 +191,10 @@ Status init_message_db(SqliteDb &db, int32 version) {
   if (version < static_cast<int32>(DbVersion::AddMessageThreadSupport)) {
     TRY_STATUS(db.exec("ALTER TABLE messages ADD COLUMN top_thread_message_id INT8"));
   }
+  if (version < static_cast<int32>(DbVersion::AddMessageDbIndexTable)) {
+    TRY_STATUS(add_index_table());
+    TRY_STATUS(move_media_indices_to_index_table());
+  }
   return Status::OK();
 }
 
@@ -174,12 +202,13 @@ Status init_message_db(SqliteDb &db, int32 version) {
 Status drop_message_db(SqliteDb &db, int32 version) {
   LOG(WARNING) << "Drop message database " << tag("version", version)
                << tag("current_db_version", current_db_version());
+  TRY_STATUS(db.exec("DROP TABLE IF EXISTS message_index"));
   return db.exec("DROP TABLE IF EXISTS messages");
 }
 
 class MessageDbImpl final : public MessageDbSyncInterface {
  public:
-  explicit MessageDbImpl(SqliteDb db) : db_(std::move(db)) {
+  MessageDbImpl(SqliteDb db, bool compress_data) : db_(std::move(db)), compress_data_(compress_data) {
     init().ensure();
   }
 
@@ -187,6 +216,8 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     TRY_RESULT_ASSIGN(
         add_message_stmt_,
         db_.get_statement("INSERT OR REPLACE INTO messages VALUES(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12)"));
+    TRY_RESULT_ASSIGN(add_message_index_stmt_,
+                      db_.get_statement("INSERT OR IGNORE INTO message_index VALUES(?1, ?2, ?3)"));
     TRY_RESULT_ASSIGN(delete_message_stmt_,
                       db_.get_statement("DELETE FROM messages WHERE dialog_id = ?1 AND message_id = ?2"));
     TRY_RESULT_ASSIGN(delete_all_dialog_messages_stmt_,
@@ -228,23 +259,24 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     for (int32 i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
       TRY_RESULT_ASSIGN(
           get_message_ids_stmts_[i],
-          db_.get_statement(
-              PSLICE() << "SELECT message_id FROM messages WHERE dialog_id = ?1 AND message_id < ?2 AND (index_mask & "
-                       << (1 << i) << ") != 0 ORDER BY message_id DESC LIMIT 1000000"));
+          db_.get_statement(PSLICE() << "SELECT message_id FROM message_index WHERE dialog_id = ?1 AND index_id = " << i
+                                     << " AND message_id < ?2 ORDER BY message_id DESC LIMIT 1000000"));
 
       TRY_RESULT_ASSIGN(
           get_messages_from_index_stmts_[i].desc_stmt_,
-          db_.get_statement(
-              PSLICE()
-              << "SELECT data, message_id FROM messages WHERE dialog_id = ?1 AND message_id < ?2 AND (index_mask & "
-              << (1 << i) << ") != 0 ORDER BY message_id DESC LIMIT ?3"));
+          db_.get_statement(PSLICE() << "SELECT data, messages.message_id FROM message_index JOIN messages USING "
+                                        "(dialog_id, message_id) WHERE message_index.dialog_id = ?1 AND index_id = "
+                                     << i
+                                     << " AND message_index.message_id < ?2 ORDER BY message_index.message_id DESC "
+                                        "LIMIT ?3"));
 
       TRY_RESULT_ASSIGN(
           get_messages_from_index_stmts_[i].asc_stmt_,
-          db_.get_statement(
-              PSLICE()
-              << "SELECT data, message_id FROM messages WHERE dialog_id = ?1 AND message_id > ?2 AND (index_mask & "
-              << (1 << i) << ") != 0 ORDER BY message_id ASC LIMIT ?3"));
+          db_.get_statement(PSLICE() << "SELECT data, messages.message_id FROM message_index JOIN messages USING "
+                                        "(dialog_id, message_id) WHERE message_index.dialog_id = ?1 AND index_id = "
+                                     << i
+                                     << " AND message_index.message_id > ?2 ORDER BY message_index.message_id ASC "
+                                        "LIMIT ?3"));
 
       // LOG(ERROR) << get_messages_from_index_stmts_[i].desc_stmt_.explain().ok();
       // LOG(ERROR) << get_messages_from_index_stmts_[i].asc_stmt_.explain().ok();
@@ -319,6 +351,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       add_message_stmt_.bind_null(5).ensure();
     }
 
+    maybe_compress(data);
     add_message_stmt_.bind_blob(6, data.as_slice()).ensure();
 
     if (ttl_expires_at != 0) {
@@ -364,6 +397,26 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     }
 
     add_message_stmt_.step().ensure();
+
+    for (int i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
+      if ((index_mask & (1 << i)) != 0) {
+        SCOPE_EXIT {
+          add_message_index_stmt_.reset();
+        };
+        add_message_index_stmt_.bind_int64(1, dialog_id.get()).ensure();
+        add_message_index_stmt_.bind_int32(2, i).ensure();
+        add_message_index_stmt_.bind_int64(3, message_id.get()).ensure();
+        add_message_index_stmt_.step().ensure();
+      }
+    }
+  }
+
+  void add_messages(vector<MessageDbAddMessageQuery> messages) final {
+    for (auto &message : messages) {
+      add_message(message.message_full_id, message.unique_message_id, message.sender_dialog_id, message.random_id,
+                  message.ttl_expires_at, message.index_mask, message.search_id, std::move(message.text),
+                  message.notification_id, message.top_thread_message_id, std::move(message.data));
+    }
   }
 
   void add_scheduled_message(MessageFullId message_full_id, BufferSlice data) final {
@@ -384,6 +437,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       add_scheduled_message_stmt_.bind_null(3).ensure();
     }
 
+    maybe_compress(data);
     add_scheduled_message_stmt_.bind_blob(4, data.as_slice()).ensure();
 
     add_scheduled_message_stmt_.step().ensure();
@@ -463,16 +517,17 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       return Status::Error("Not found");
     }
     MessageId received_message_id(stmt.view_int64(0));
-    Slice data = stmt.view_blob(1);
+    auto data = decompress_blob(stmt.view_blob(1));
     if (is_scheduled_server) {
       CHECK(received_message_id.is_scheduled());
       CHECK(received_message_id.is_scheduled_server());
       CHECK(received_message_id.get_scheduled_server_message_id() == message_id.get_scheduled_server_message_id());
     } else {
       LOG_CHECK(received_message_id == message_id)
-          << received_message_id << ' ' << message_id << ' ' << get_message_info(received_message_id, data, true).first;
+          << received_message_id << ' ' << message_id << ' '
+          << get_message_info(received_message_id, data.as_slice(), true).first;
     }
-    return MessageDbDialogMessage{received_message_id, BufferSlice(data)};
+    return MessageDbDialogMessage{received_message_id, std::move(data)};
   }
 
   Result<MessageDbMessage> get_message_by_unique_message_id(ServerMessageId unique_message_id) final {
@@ -489,7 +544,8 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     }
     DialogId dialog_id(get_message_by_unique_message_id_stmt_.view_int64(0));
     MessageId message_id(get_message_by_unique_message_id_stmt_.view_int64(1));
-    return MessageDbMessage{dialog_id, message_id, BufferSlice(get_message_by_unique_message_id_stmt_.view_blob(2))};
+    auto data = decompress_blob(get_message_by_unique_message_id_stmt_.view_blob(2));
+    return MessageDbMessage{dialog_id, message_id, std::move(data)};
   }
 
   Result<MessageDbDialogMessage> get_message_by_random_id(DialogId dialog_id, int64 random_id) final {
@@ -503,7 +559,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       return Status::Error("Not found");
     }
     MessageId message_id(get_message_by_random_id_stmt_.view_int64(0));
-    return MessageDbDialogMessage{message_id, BufferSlice(get_message_by_random_id_stmt_.view_blob(1))};
+    return MessageDbDialogMessage{message_id, decompress_blob(get_message_by_random_id_stmt_.view_blob(1))};
   }
 
   Result<MessageDbDialogMessage> get_dialog_message_by_date(DialogId dialog_id, MessageId first_message_id,
@@ -581,7 +637,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     while (get_expiring_messages_stmt_.has_row()) {
       DialogId dialog_id(get_expiring_messages_stmt_.view_int64(0));
       MessageId message_id(get_expiring_messages_stmt_.view_int64(1));
-      BufferSlice data(get_expiring_messages_stmt_.view_blob(2));
+      auto data = decompress_blob(get_expiring_messages_stmt_.view_blob(2));
       messages.push_back(MessageDbMessage{dialog_id, message_id, std::move(data)});
       get_expiring_messages_stmt_.step().ensure();
     }
@@ -604,16 +660,16 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     stmt.step().ensure();
     int32 current_day = std::numeric_limits<int32>::max();
     while (stmt.has_row()) {
-      auto data_slice = stmt.view_blob(0);
+      auto data = decompress_blob(stmt.view_blob(0));
       MessageId message_id(stmt.view_int64(1));
-      auto info = get_message_info(message_id, data_slice, false);
+      auto info = get_message_info(message_id, data.as_slice(), false);
       auto day = (query.tz_offset + info.second) / 86400;
       if (day >= current_day) {
         CHECK(!total_counts.empty());
         total_counts.back()++;
       } else {
         current_day = day;
-        messages.push_back(MessageDbDialogMessage{message_id, BufferSlice(data_slice)});
+        messages.push_back(MessageDbDialogMessage{message_id, std::move(data)});
         total_counts.push_back(1);
       }
       stmt.step().ensure();
@@ -681,7 +737,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     while (stmt.has_row()) {
       auto data_slice = stmt.view_blob(0);
       MessageId message_id(stmt.view_int64(1));
-      result.push_back(MessageDbDialogMessage{message_id, BufferSlice(data_slice)});
+      result.push_back(MessageDbDialogMessage{message_id, decompress_blob(data_slice)});
       LOG(INFO) << "Load " << message_id << " in " << dialog_id << " from database";
       stmt.step().ensure();
     }
@@ -774,7 +830,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       auto data_slice = stmt.view_blob(2);
       auto search_id = stmt.view_int64(3);
       result.next_search_id = search_id;
-      result.messages.push_back(MessageDbMessage{dialog_id, message_id, BufferSlice(data_slice)});
+      result.messages.push_back(MessageDbMessage{dialog_id, message_id, decompress_blob(data_slice)});
       stmt.step().ensure();
     }
     return result;
@@ -810,12 +866,76 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       DialogId dialog_id(stmt.view_int64(0));
       MessageId message_id(stmt.view_int64(1));
       auto data_slice = stmt.view_blob(2);
-      result.messages.push_back(MessageDbMessage{dialog_id, message_id, BufferSlice(data_slice)});
+      result.messages.push_back(MessageDbMessage{dialog_id, message_id, decompress_blob(data_slice)});
       stmt.step().ensure();
     }
     return result;
   }
 
+  Result<MessageDbFtsStatistics> get_fts_statistics() final {
+    MessageDbFtsStatistics result;
+    {
+      TRY_RESULT(stmt, db_.get_statement("SELECT COUNT(*), SUM(length(block)) FROM messages_fts_data"));
+      TRY_STATUS(stmt.step());
+      CHECK(stmt.has_row());
+      result.page_count = stmt.view_int64(0);
+      result.size = stmt.view_int64(1);
+    }
+
+    // the structure record consists of a 4-byte cookie followed by varints with level and segment counts
+    TRY_RESULT(stmt, db_.get_statement("SELECT block FROM messages_fts_data WHERE id = 10"));
+    TRY_STATUS(stmt.step());
+    if (!stmt.has_row()) {
+      return result;
+    }
+    auto structure = stmt.view_blob(0);
+    if (structure.size() < 4) {
+      return Status::Error("Invalid full-text index structure record");
+    }
+    structure.remove_prefix(4);
+    TRY_RESULT_ASSIGN(result.level_count, get_fts_varint(structure));
+    TRY_RESULT_ASSIGN(result.segment_count, get_fts_varint(structure));
+    return result;
+  }
+
+  Status set_fts_merge_parameters(int32 automerge, int32 crisis_merge) final {
+    if (automerge < 0 || automerge == 1 || automerge > 16) {
+      return Status::Error("Invalid automerge value specified");
+    }
+    if (crisis_merge < 0 || crisis_merge == 1) {
+      return Status::Error("Invalid crisismerge value specified");
+    }
+    if (automerge != 0) {
+      TRY_STATUS(
+          db_.exec(PSLICE() << "INSERT INTO messages_fts(messages_fts, rank) VALUES('automerge', " << automerge << ')'));
+    }
+    if (crisis_merge != 0) {
+      TRY_STATUS(db_.exec(PSLICE() << "INSERT INTO messages_fts(messages_fts, rank) VALUES('crisismerge', "
+                                   << crisis_merge << ')'));
+    }
+    return Status::OK();
+  }
+
+  Result<bool> merge_fts_segments(int32 page_count) final {
+    if (page_count <= 0) {
+      return Status::Error("Invalid page count specified");
+    }
+    TRY_RESULT(old_total_changes, get_total_changes());
+    TRY_STATUS(
+        db_.exec(PSLICE() << "INSERT INTO messages_fts(messages_fts, rank) VALUES('merge', " << page_count << ')'));
+    TRY_RESULT(new_total_changes, get_total_changes());
+    // a merge, which did nothing, changes only the structure record
+    return new_total_changes - old_total_changes >= 2;
+  }
+
+  Status optimize_fts() final {
+    return db_.exec("INSERT INTO messages_fts(messages_fts) VALUES('optimize')");
+  }
+
+  Status rebuild_fts() final {
+    return db_.exec("INSERT INTO messages_fts(messages_fts) VALUES('rebuild')");
+  }
+
   Status begin_write_transaction() final {
     return db_.begin_write_transaction();
   }
@@ -825,8 +945,43 @@ class MessageDbImpl final : public MessageDbSyncInterface {
 
  private:
   SqliteDb db_;
+  bool compress_data_ = false;
+
+  void maybe_compress(BufferSlice &data) const {
+    if (!compress_data_) {
+      return;
+    }
+    auto compressed_data = compress_blob(data.as_slice());
+    if (!compressed_data.empty()) {
+      data = std::move(compressed_data);
+    }
+  }
+
+  static Result<int32> get_fts_varint(Slice &data) {
+    uint32 result = 0;
+    for (int i = 0; i < 5; i++) {
+      if (data.empty()) {
+        break;
+      }
+      auto c = static_cast<unsigned char>(data[0]);
+      data.remove_prefix(1);
+      result = (result << 7) | (c & 0x7F);
+      if ((c & 0x80) == 0) {
+        return static_cast<int32>(result);
+      }
+    }
+    return Status::Error("Invalid varint in full-text index structure record");
+  }
+
+  Result<int64> get_total_changes() {
+    TRY_RESULT(stmt, db_.get_statement("SELECT total_changes()"));
+    TRY_STATUS(stmt.step());
+    CHECK(stmt.has_row());
+    return stmt.view_int64(0);
+  }
 
   SqliteStatement add_message_stmt_;
+  SqliteStatement add_message_index_stmt_;
 
   SqliteStatement delete_message_stmt_;
   SqliteStatement delete_all_dialog_messages_stmt_;
@@ -925,7 +1080,7 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     while (stmt.has_row()) {
       auto data_slice = stmt.view_blob(0);
       MessageId message_id(stmt.view_int64(1));
-      result.push_back(MessageDbDialogMessage{message_id, BufferSlice(data_slice)});
+      result.push_back(MessageDbDialogMessage{message_id, decompress_blob(data_slice)});
       LOG(INFO) << "Loaded " << message_id << " in " << dialog_id << " from database";
       stmt.step().ensure();
     }
@@ -964,12 +1119,12 @@ class MessageDbImpl final : public MessageDbSyncInterface {
 };
 
 std::shared_ptr<MessageDbSyncSafeInterface> create_message_db_sync(
-    std::shared_ptr<SqliteConnectionSafe> sqlite_connection) {
+    std::shared_ptr<SqliteConnectionSafe> sqlite_connection, bool compress_data) {
   class MessageDbSyncSafe final : public MessageDbSyncSafeInterface {
    public:
-    explicit MessageDbSyncSafe(std::shared_ptr<SqliteConnectionSafe> sqlite_connection)
-        : lsls_db_([safe_connection = std::move(sqlite_connection)] {
-          return make_unique<MessageDbImpl>(safe_connection->get().clone());
+    MessageDbSyncSafe(std::shared_ptr<SqliteConnectionSafe> sqlite_connection, bool compress_data)
+        : lsls_db_([safe_connection = std::move(sqlite_connection), compress_data] {
+          return make_unique<MessageDbImpl>(safe_connection->get().clone(), compress_data);
         }) {
     }
     MessageDbSyncInterface &get() final {
@@ -979,13 +1134,15 @@ std::shared_ptr<MessageDbSyncSafeInterface> create_message_db_sync(
    private:
     LazySchedulerLocalStorage<unique_ptr<MessageDbSyncInterface>> lsls_db_;
   };
-  return std::make_shared<MessageDbSyncSafe>(std::move(sqlite_connection));
+  return std::make_shared<MessageDbSyncSafe>(std::move(sqlite_connection), compress_data);
 }
 
 class MessageDbAsync final : public MessageDbAsyncInterface {
  public:
-  MessageDbAsync(std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id) {
-    impl_ = create_actor_on_scheduler<Impl>("MessageDbActor", scheduler_id, std::move(sync_db));
+  MessageDbAsync(std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id,
+                 std::shared_ptr<MessageDbSyncSafeInterface> read_only_sync_db, vector<int32> reader_scheduler_ids) {
+    impl_ = create_actor_on_scheduler<Impl>("MessageDbActor", scheduler_id, std::move(sync_db),
+                                            std::move(read_only_sync_db), std::move(reader_scheduler_ids));
   }
 
   void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
@@ -996,6 +1153,9 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
                        ttl_expires_at, index_mask, search_id, std::move(text), notification_id, top_thread_message_id,
                        std::move(data), std::move(promise));
   }
+  void add_messages(vector<MessageDbAddMessageQuery> messages, Promise<> promise) final {
+    send_closure_later(impl_, &Impl::add_messages, std::move(messages), std::move(promise));
+  }
   void add_scheduled_message(MessageFullId message_full_id, BufferSlice data, Promise<> promise) final {
     send_closure_later(impl_, &Impl::add_scheduled_message, message_full_id, std::move(data), std::move(promise));
   }
@@ -1055,6 +1215,22 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
     send_closure_later(impl_, &Impl::get_expiring_messages, expires_till, limit, std::move(promise));
   }
 
+  void get_fts_statistics(Promise<MessageDbFtsStatistics> promise) final {
+    send_closure_later(impl_, &Impl::get_fts_statistics, std::move(promise));
+  }
+  void set_fts_merge_parameters(int32 automerge, int32 crisis_merge, Promise<> promise) final {
+    send_closure_later(impl_, &Impl::set_fts_merge_parameters, automerge, crisis_merge, std::move(promise));
+  }
+  void merge_fts_segments(int32 page_count, Promise<MessageDbFtsStatistics> promise) final {
+    send_closure_later(impl_, &Impl::merge_fts_segments, page_count, std::move(promise));
+  }
+  void optimize_fts(Promise<> promise) final {
+    send_closure_later(impl_, &Impl::optimize_fts, std::move(promise));
+  }
+  void rebuild_fts(Promise<> promise) final {
+    send_closure_later(impl_, &Impl::rebuild_fts, std::move(promise));
+  }
+
   void close(Promise<> promise) final {
     send_closure_later(impl_, &Impl::close, std::move(promise));
   }
@@ -1064,9 +1240,56 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
   }
 
  private:
+  // runs heavy read queries through a read-only connection in parallel with the writer
+  class Reader final : public Actor {
+   public:
+    explicit Reader(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe) : sync_db_safe_(std::move(sync_db_safe)) {
+    }
+
+    void get_dialog_message_calendar(MessageDbDialogCalendarQuery query, Promise<MessageDbCalendar> promise) {
+      promise.set_value(sync_db_->get_dialog_message_calendar(std::move(query)));
+    }
+
+    void get_dialog_sparse_message_positions(MessageDbGetDialogSparseMessagePositionsQuery query,
+                                             Promise<MessageDbMessagePositions> promise) {
+      promise.set_result(sync_db_->get_dialog_sparse_message_positions(std::move(query)));
+    }
+
+    void get_messages(MessageDbMessagesQuery query, Promise<vector<MessageDbDialogMessage>> promise) {
+      promise.set_value(sync_db_->get_messages(std::move(query)));
+    }
+
+    void get_calls(MessageDbCallsQuery query, Promise<MessageDbCallsResult> promise) {
+      promise.set_value(sync_db_->get_calls(std::move(query)));
+    }
+
+    void get_messages_fts(MessageDbFtsQuery query, Promise<MessageDbFtsResult> promise) {
+      promise.set_value(sync_db_->get_messages_fts(std::move(query)));
+    }
+
+    void close(Promise<> promise) {
+      sync_db_safe_.reset();
+      sync_db_ = nullptr;
+      promise.set_value(Unit());
+      stop();
+    }
+
+   private:
+    std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe_;
+    MessageDbSyncInterface *sync_db_ = nullptr;
+
+    void start_up() final {
+      sync_db_ = &sync_db_safe_->get();
+    }
+  };
+
   class Impl final : public Actor {
    public:
-    explicit Impl(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe) : sync_db_safe_(std::move(sync_db_safe)) {
+    Impl(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe,
+         std::shared_ptr<MessageDbSyncSafeInterface> read_only_sync_db_safe, vector<int32> reader_scheduler_ids)
+        : sync_db_safe_(std::move(sync_db_safe))
+        , read_only_sync_db_safe_(std::move(read_only_sync_db_safe))
+        , reader_scheduler_ids_(std::move(reader_scheduler_ids)) {
     }
     void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
                      int64 random_id, int32 ttl_expires_at, int32 index_mask, int64 search_id, string text,
@@ -1081,6 +1304,16 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
         on_write_result(std::move(promise));
       });
     }
+    void add_messages(vector<MessageDbAddMessageQuery> messages, Promise<> promise) {
+      add_write_query([this, messages = std::move(messages), promise = std::move(promise)](Unit) mutable {
+        auto start_time = Time::now();
+        auto message_count = messages.size();
+        sync_db_->add_messages(std::move(messages));
+        LOG(INFO) << "Added " << message_count << " messages to database in "
+                  << format::as_time(Time::now() - start_time);
+        on_write_result(std::move(promise));
+      });
+    }
     void add_scheduled_message(MessageFullId message_full_id, BufferSlice data, Promise<> promise) {
       add_write_query([this, message_full_id, promise = std::move(promise), data = std::move(data)](Unit) mutable {
         sync_db_->add_scheduled_message(message_full_id, std::move(data));
@@ -1132,17 +1365,26 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
 
     void get_dialog_message_calendar(MessageDbDialogCalendarQuery query, Promise<MessageDbCalendar> promise) {
       add_read_query();
+      if (!readers_.empty()) {
+        return send_closure(get_reader(), &Reader::get_dialog_message_calendar, std::move(query), std::move(promise));
+      }
       promise.set_value(sync_db_->get_dialog_message_calendar(std::move(query)));
     }
 
     void get_dialog_sparse_message_positions(MessageDbGetDialogSparseMessagePositionsQuery query,
                                              Promise<MessageDbMessagePositions> promise) {
       add_read_query();
+      if (!readers_.empty()) {
+        return send_closure(get_reader(), &Reader::get_dialog_sparse_message_positions, std::move(query), std::move(promise));
+      }
       promise.set_result(sync_db_->get_dialog_sparse_message_positions(std::move(query)));
     }
 
     void get_messages(MessageDbMessagesQuery query, Promise<vector<MessageDbDialogMessage>> promise) {
       add_read_query();
+      if (!readers_.empty()) {
+        return send_closure(get_reader(), &Reader::get_messages, std::move(query), std::move(promise));
+      }
       promise.set_value(sync_db_->get_messages(std::move(query)));
     }
     void get_scheduled_messages(DialogId dialog_id, int32 limit, Promise<vector<MessageDbDialogMessage>> promise) {
@@ -1156,10 +1398,16 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
     }
     void get_calls(MessageDbCallsQuery query, Promise<MessageDbCallsResult> promise) {
       add_read_query();
+      if (!readers_.empty()) {
+        return send_closure(get_reader(), &Reader::get_calls, std::move(query), std::move(promise));
+      }
       promise.set_value(sync_db_->get_calls(std::move(query)));
     }
     void get_messages_fts(MessageDbFtsQuery query, Promise<MessageDbFtsResult> promise) {
       add_read_query();
+      if (!readers_.empty()) {
+        return send_closure(get_reader(), &Reader::get_messages_fts, std::move(query), std::move(promise));
+      }
       promise.set_value(sync_db_->get_messages_fts(std::move(query)));
     }
     void get_expiring_messages(int32 expires_till, int32 limit, Promise<vector<MessageDbMessage>> promise) {
@@ -1167,11 +1415,47 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
       promise.set_value(sync_db_->get_expiring_messages(expires_till, limit));
     }
 
+    void get_fts_statistics(Promise<MessageDbFtsStatistics> promise) {
+      add_read_query();
+      promise.set_result(sync_db_->get_fts_statistics());
+    }
+    void set_fts_merge_parameters(int32 automerge, int32 crisis_merge, Promise<> promise) {
+      add_read_query();
+      promise.set_result(sync_db_->set_fts_merge_parameters(automerge, crisis_merge));
+    }
+    void merge_fts_segments(int32 page_count, Promise<MessageDbFtsStatistics> promise) {
+      add_read_query();
+      auto r_has_more = sync_db_->merge_fts_segments(page_count);
+      if (r_has_more.is_error()) {
+        return promise.set_error(r_has_more.move_as_error());
+      }
+      if (r_has_more.ok()) {
+        // let queries received in the meantime run before the next step
+        return send_closure_later(actor_id(this), &Impl::merge_fts_segments, page_count, std::move(promise));
+      }
+      promise.set_result(sync_db_->get_fts_statistics());
+    }
+    void optimize_fts(Promise<> promise) {
+      add_read_query();
+      promise.set_result(sync_db_->optimize_fts());
+    }
+    void rebuild_fts(Promise<> promise) {
+      add_read_query();
+      promise.set_result(sync_db_->rebuild_fts());
+    }
+
     void close(Promise<> promise) {
       do_flush();
       sync_db_safe_.reset();
       sync_db_ = nullptr;
-      promise.set_value(Unit());
+
+      MultiPromiseActorSafe mpas{"MessageDbCloseMultiPromiseActor"};
+      mpas.add_promise(std::move(promise));
+      auto lock = mpas.get_promise();
+      for (auto &reader : readers_) {
+        send_closure(reader, &Reader::close, mpas.get_promise());
+      }
+      lock.set_value(Unit());
       stop();
     }
 
@@ -1184,6 +1468,11 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
     std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe_;
     MessageDbSyncInterface *sync_db_ = nullptr;
 
+    std::shared_ptr<MessageDbSyncSafeInterface> read_only_sync_db_safe_;
+    vector<int32> reader_scheduler_ids_;
+    vector<ActorOwn<Reader>> readers_;
+    size_t next_reader_ = 0;
+
     static constexpr size_t MAX_PENDING_QUERIES_COUNT{50};
     static constexpr double MAX_PENDING_QUERIES_DELAY{0.01};
 
@@ -1206,8 +1495,16 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
       }
     }
     void add_read_query() {
+      // pending writes must be committed to be visible through other connections
       do_flush();
     }
+
+    const ActorOwn<Reader> &get_reader() {
+      CHECK(!readers_.empty());
+      auto &reader = readers_[next_reader_];
+      next_reader_ = (next_reader_ + 1) % readers_.size();
+      return reader;
+    }
     void do_flush() {
       if (pending_writes_.empty()) {
         return;
@@ -1224,14 +1521,23 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
 
     void start_up() final {
       sync_db_ = &sync_db_safe_->get();
+      if (read_only_sync_db_safe_ != nullptr) {
+        for (auto scheduler_id : reader_scheduler_ids_) {
+          readers_.push_back(
+              create_actor_on_scheduler<Reader>("MessageDbReaderActor", scheduler_id, read_only_sync_db_safe_));
+        }
+        read_only_sync_db_safe_.reset();
+      }
     }
   };
   ActorOwn<Impl> impl_;
 };
 
-std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(std::shared_ptr<MessageDbSyncSafeInterface> sync_db,
-                                                                 int32 scheduler_id) {
-  return std::make_shared<MessageDbAsync>(std::move(sync_db), scheduler_id);
+std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(
+    std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id,
+    std::shared_ptr<MessageDbSyncSafeInterface> read_only_sync_db, vector<int32> reader_scheduler_ids) {
+  return std::make_shared<MessageDbAsync>(std::move(sync_db), scheduler_id, std::move(read_only_sync_db),
+                                          std::move(reader_scheduler_ids));
 }
 
 }  // namespace td
@@ -26,6 +26,20 @@ namespace td {
 class SqliteConnectionSafe;
 class SqliteDb;
 
+struct MessageDbAddMessageQuery {
+  MessageFullId message_full_id;
+  ServerMessageId unique_message_id;
+  DialogId sender_dialog_id;
+  int64 random_id{0};
+  int32 ttl_expires_at{0};
+  int32 index_mask{0};
+  int64 search_id{0};
+  string text;
+  NotificationId notification_id;
+  MessageId top_thread_message_id;
+  BufferSlice data;
+};
+
 struct MessageDbMessagesQuery {
   DialogId dialog_id;
   MessageSearchFilter filter{MessageSearchFilter::Empty};
@@ -87,6 +101,13 @@ struct MessageDbFtsResult {
   int64 next_search_id{1};
 };
 
+struct MessageDbFtsStatistics {
+  int32 level_count{0};
+  int32 segment_count{0};
+  int64 page_count{0};
+  int64 size{0};
+};
+
 struct MessageDbCallsQuery {
   MessageSearchFilter filter{MessageSearchFilter::Empty};
   int32 from_unique_message_id{0};
@@ -107,6 +128,8 @@ class MessageDbSyncInterface {
   virtual void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
                            int64 random_id, int32 ttl_expires_at, int32 index_mask, int64 search_id, string text,
                            NotificationId notification_id, MessageId top_thread_message_id, BufferSlice data) = 0;
+  // adds the messages one by one using the same prepared statement; must be called inside a write transaction
+  virtual void add_messages(vector<MessageDbAddMessageQuery> messages) = 0;
   virtual void add_scheduled_message(MessageFullId message_full_id, BufferSlice data) = 0;
 
   virtual void delete_message(MessageFullId message_full_id) = 0;
@@ -134,6 +157,14 @@ class MessageDbSyncInterface {
   virtual MessageDbCallsResult get_calls(MessageDbCallsQuery query) = 0;
   virtual MessageDbFtsResult get_messages_fts(MessageDbFtsQuery query) = 0;
 
+  virtual Result<MessageDbFtsStatistics> get_fts_statistics() = 0;
+  // the values are stored in the database; 0 keeps the current value
+  virtual Status set_fts_merge_parameters(int32 automerge, int32 crisis_merge) = 0;
+  // merges at most about page_count pages of full-text index segments; returns false if there was nothing to merge
+  virtual Result<bool> merge_fts_segments(int32 page_count) = 0;
+  virtual Status optimize_fts() = 0;
+  virtual Status rebuild_fts() = 0;
+
   virtual Status begin_write_transaction() = 0;
   virtual Status commit_transaction() = 0;
 };
@@ -159,6 +190,7 @@ class MessageDbAsyncInterface {
                            int64 random_id, int32 ttl_expires_at, int32 index_mask, int64 search_id, string text,
                            NotificationId notification_id, MessageId top_thread_message_id, BufferSlice data,
                            Promise<> promise) = 0;
+  virtual void add_messages(vector<MessageDbAddMessageQuery> messages, Promise<> promise) = 0;
   virtual void add_scheduled_message(MessageFullId message_full_id, BufferSlice data, Promise<> promise) = 0;
 
   virtual void delete_message(MessageFullId message_full_id, Promise<> promise) = 0;
@@ -187,6 +219,13 @@ class MessageDbAsyncInterface {
   virtual void get_calls(MessageDbCallsQuery, Promise<MessageDbCallsResult> promise) = 0;
   virtual void get_messages_fts(MessageDbFtsQuery query, Promise<MessageDbFtsResult> promise) = 0;
 
+  virtual void get_fts_statistics(Promise<MessageDbFtsStatistics> promise) = 0;
+  virtual void set_fts_merge_parameters(int32 automerge, int32 crisis_merge, Promise<> promise) = 0;
+  // merges full-text index segments step by step until there is nothing to merge, running other queries between steps
+  virtual void merge_fts_segments(int32 page_count, Promise<MessageDbFtsStatistics> promise) = 0;
+  virtual void optimize_fts(Promise<> promise) = 0;
+  virtual void rebuild_fts(Promise<> promise) = 0;
+
   virtual void get_expiring_messages(int32 expires_till, int32 limit, Promise<vector<MessageDbMessage>> promise) = 0;
 
   virtual void close(Promise<> promise) = 0;
@@ -196,10 +235,13 @@ class MessageDbAsyncInterface {
 Status init_message_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
 Status drop_message_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
 
+// if compress_data is true, then large message blobs are stored compressed; compressed blobs are always readable
 std::shared_ptr<MessageDbSyncSafeInterface> create_message_db_sync(
-    std::shared_ptr<SqliteConnectionSafe> sqlite_connection);
+    std::shared_ptr<SqliteConnectionSafe> sqlite_connection, bool compress_data = false);
 
-std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(std::shared_ptr<MessageDbSyncSafeInterface> sync_db,
-                                                                 int32 scheduler_id = -1);
+// if read_only_sync_db is provided, then heavy read queries are run on reader_scheduler_ids in parallel with writes
+std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(
+    std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id = -1,
+    std::shared_ptr<MessageDbSyncSafeInterface> read_only_sync_db = nullptr, vector<int32> reader_scheduler_ids = {});
 
 }  // namespace td
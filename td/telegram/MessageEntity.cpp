@@ -30,6 +30,7 @@
 #include "td/utils/utf8.h"
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <limits>
 #include <tuple>
@@ -1689,9 +1690,60 @@ static void fix_entity_offsets(Slice text, vector<MessageEntity> &entities) {
   }
 }
 
+namespace {
+// characters, which must be present in a text for entities of the corresponding type to be found
+enum EntityTriggerFlag : uint8 {
+  ENTITY_TRIGGER_AT = 1 << 0,
+  ENTITY_TRIGGER_SLASH = 1 << 1,
+  ENTITY_TRIGGER_HASH = 1 << 2,
+  ENTITY_TRIGGER_DOLLAR = 1 << 3,
+  ENTITY_TRIGGER_COLON = 1 << 4,
+  ENTITY_TRIGGER_DOT = 1 << 5,
+  ENTITY_TRIGGER_DIGIT = 1 << 6
+};
+
+struct EntityTriggers {
+  uint8 flags = 0;
+  size_t digit_count = 0;
+};
+}  // namespace
+
+// scans the text once to find out which entity matchers can have a result
+static EntityTriggers get_entity_triggers(Slice text) {
+  static const auto trigger_flags = [] {
+    std::array<uint8, 256> result{};
+    result['@'] = ENTITY_TRIGGER_AT;
+    result['/'] = ENTITY_TRIGGER_SLASH;
+    result['#'] = ENTITY_TRIGGER_HASH;
+    result['$'] = ENTITY_TRIGGER_DOLLAR;
+    result[':'] = ENTITY_TRIGGER_COLON;
+    result['.'] = ENTITY_TRIGGER_DOT;
+    for (int c = '0'; c <= '9'; c++) {
+      result[c] = ENTITY_TRIGGER_DIGIT;
+    }
+    return result;
+  }();
+
+  EntityTriggers result;
+  for (auto c : text) {
+    auto flags = trigger_flags[static_cast<unsigned char>(c)];
+    result.flags |= flags;
+    result.digit_count += flags == ENTITY_TRIGGER_DIGIT;
+  }
+  return result;
+}
+
 vector<MessageEntity> find_entities(Slice text, bool skip_bot_commands, bool skip_media_timestamps) {
   vector<MessageEntity> entities;
 
+  auto triggers = get_entity_triggers(text);
+  if (triggers.flags == 0) {
+    return entities;
+  }
+  auto has_trigger = [&triggers](uint8 flag) {
+    return (triggers.flags & flag) != 0;
+  };
+
   auto add_entities = [&entities, &text](MessageEntity::Type type, vector<Slice> (*find_entities_f)(Slice)) mutable {
     auto new_entities = find_entities_f(text);
     for (auto &entity : new_entities) {
@@ -1700,23 +1752,35 @@ vector<MessageEntity> find_entities(Slice text, bool skip_bot_commands, bool ski
       entities.emplace_back(type, offset, length);
     }
   };
-  add_entities(MessageEntity::Type::Mention, find_mentions);
-  if (!skip_bot_commands) {
+  if (has_trigger(ENTITY_TRIGGER_AT)) {
+    add_entities(MessageEntity::Type::Mention, find_mentions);
+  }
+  if (!skip_bot_commands && has_trigger(ENTITY_TRIGGER_SLASH)) {
     add_entities(MessageEntity::Type::BotCommand, find_bot_commands);
   }
-  add_entities(MessageEntity::Type::Hashtag, find_hashtags);
-  add_entities(MessageEntity::Type::Cashtag, find_cashtags);
+  if (has_trigger(ENTITY_TRIGGER_HASH)) {
+    add_entities(MessageEntity::Type::Hashtag, find_hashtags);
+  }
+  if (has_trigger(ENTITY_TRIGGER_DOLLAR)) {
+    add_entities(MessageEntity::Type::Cashtag, find_cashtags);
+  }
   // TODO find_phone_numbers
-  add_entities(MessageEntity::Type::BankCardNumber, find_bank_card_numbers);
-  add_entities(MessageEntity::Type::Url, find_tg_urls);
-  auto urls = find_urls(text);
-  for (auto &url : urls) {
-    auto type = url.second ? MessageEntity::Type::EmailAddress : MessageEntity::Type::Url;
-    auto offset = narrow_cast<int32>(url.first.begin() - text.begin());
-    auto length = narrow_cast<int32>(url.first.size());
-    entities.emplace_back(type, offset, length);
-  }
-  if (!skip_media_timestamps) {
+  if (triggers.digit_count >= 13) {
+    add_entities(MessageEntity::Type::BankCardNumber, find_bank_card_numbers);
+  }
+  if (has_trigger(ENTITY_TRIGGER_COLON)) {
+    add_entities(MessageEntity::Type::Url, find_tg_urls);
+  }
+  if (has_trigger(ENTITY_TRIGGER_DOT)) {
+    auto urls = find_urls(text);
+    for (auto &url : urls) {
+      auto type = url.second ? MessageEntity::Type::EmailAddress : MessageEntity::Type::Url;
+      auto offset = narrow_cast<int32>(url.first.begin() - text.begin());
+      auto length = narrow_cast<int32>(url.first.size());
+      entities.emplace_back(type, offset, length);
+    }
+  }
+  if (!skip_media_timestamps && has_trigger(ENTITY_TRIGGER_COLON)) {
     auto media_timestamps = find_media_timestamps(text);
     for (auto &entity : media_timestamps) {
       auto offset = narrow_cast<int32>(entity.first.begin() - text.begin());
@@ -1782,6 +1846,7 @@ static bool is_plain_domain(Slice url) {
 }
 
 Slice get_first_url(const FormattedText &text) {
+  Utf8Utf16SubstrFinder substr_finder(text.text);
   for (auto &entity : text.entities) {
     switch (entity.type) {
       case MessageEntity::Type::Mention:
@@ -1794,7 +1859,7 @@ Slice get_first_url(const FormattedText &text) {
         if (entity.length <= 4) {
           continue;
         }
-        auto url = utf8_utf16_substr(text.text, entity.offset, entity.length);
+        auto url = substr_finder.substr(entity.offset, entity.length);
         string scheme = to_lower(url.substr(0, 8));
         if (scheme == "ton:" || begins_with(scheme, "tg:") || scheme == "ftp:" || scheme == "tonsite:" ||
             is_plain_domain(url)) {
@@ -1993,6 +2058,28 @@ Result<vector<MessageEntity>> parse_markdown(string &text) {
   return std::move(entities);
 }
 
+static bool is_pre_or_code_entity(MessageEntity::Type type) {
+  switch (type) {
+    case MessageEntity::Type::Code:
+    case MessageEntity::Type::Pre:
+    case MessageEntity::Type::PreCode:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool is_markdown_v2_reserved_character(unsigned char c) {
+  static const auto is_reserved = [] {
+    std::array<bool, 256> result{};
+    for (auto reserved_c : Slice("_*[]()~`>#+-=|{}.!\n")) {
+      result[static_cast<unsigned char>(reserved_c)] = true;
+    }
+    return result;
+  }();
+  return is_reserved[c];
+}
+
 Result<vector<MessageEntity>> parse_markdown_v2(string &text) {
   size_t result_size = 0;
   vector<MessageEntity> entities;
@@ -2030,20 +2117,14 @@ Result<vector<MessageEntity>> parse_markdown_v2(string &text) {
       continue;
     }
 
-    Slice reserved_characters("_*[]()~`>#+-=|{}.!\n");
-    if (!nested_entities.empty()) {
-      switch (nested_entities.back().type) {
-        case MessageEntity::Type::Code:
-        case MessageEntity::Type::Pre:
-        case MessageEntity::Type::PreCode:
-          reserved_characters = Slice("`");
-          break;
-        default:
-          break;
-      }
+    bool is_reserved = false;
+    if (!nested_entities.empty() && is_pre_or_code_entity(nested_entities.back().type)) {
+      is_reserved = c == '`';
+    } else {
+      is_reserved = is_markdown_v2_reserved_character(c);
     }
 
-    if (reserved_characters.find(text[i]) == Slice::npos) {
+    if (!is_reserved) {
       if (is_utf8_character_first_code_unit(c)) {
         utf16_offset += 1 + (c >= 0xf0);  // >= 4 bytes in symbol => surrogate pair
         if (c != '\r') {
@@ -3221,6 +3302,54 @@ static uint32 decode_html_entity(CSlice text, size_t &pos) {
   return res;
 }
 
+namespace {
+enum class HtmlTag : int32 {
+  A,
+  B,
+  Strong,
+  I,
+  Em,
+  S,
+  Strike,
+  Del,
+  U,
+  Ins,
+  TgSpoiler,
+  TgEmoji,
+  Span,
+  Pre,
+  Code,
+  BlockQuote,
+  Unsupported
+};
+}  // namespace
+
+static Slice get_html_tag_name(HtmlTag tag) {
+  static const Slice tag_names[] = {"a",   "b",   "strong",     "i",        "em",   "s",   "strike", "del",
+                                    "u",   "ins", "tg-spoiler", "tg-emoji", "span", "pre", "code",   "blockquote"};
+  CHECK(tag != HtmlTag::Unsupported);
+  return tag_names[static_cast<int32>(tag)];
+}
+
+// tag names are case-insensitive
+static HtmlTag get_html_tag(Slice tag_name) {
+  char lowered_tag_name[16];
+  if (tag_name.size() > sizeof(lowered_tag_name)) {
+    return HtmlTag::Unsupported;
+  }
+  for (size_t i = 0; i < tag_name.size(); i++) {
+    lowered_tag_name[i] = to_lower(tag_name[i]);
+  }
+  Slice lowered(lowered_tag_name, tag_name.size());
+  for (int32 i = 0; i < static_cast<int32>(HtmlTag::Unsupported); i++) {
+    auto tag = static_cast<HtmlTag>(i);
+    if (get_html_tag_name(tag) == lowered) {
+      return tag;
+    }
+  }
+  return HtmlTag::Unsupported;
+}
+
 Result<vector<MessageEntity>> parse_html(string &str) {
   auto str_size = str.size();
   const char *text = str.c_str();
@@ -3232,13 +3361,13 @@ Result<vector<MessageEntity>> parse_html(string &str) {
   bool need_recheck_utf8 = false;
 
   struct EntityInfo {
-    string tag_name;
+    HtmlTag tag;
     string argument;
     int32 entity_offset;
     size_t entity_begin_pos;
 
-    EntityInfo(string &&tag_name, string &&argument, int32 entity_offset, size_t entity_begin_pos)
-        : tag_name(std::move(tag_name))
+    EntityInfo(HtmlTag tag, string &&argument, int32 entity_offset, size_t entity_begin_pos)
+        : tag(tag)
         , argument(std::move(argument))
         , entity_offset(entity_offset)
         , entity_begin_pos(entity_begin_pos) {
@@ -3280,14 +3409,13 @@ Result<vector<MessageEntity>> parse_html(string &str) {
         return Status::Error(400, PSLICE() << "Unclosed start tag at byte offset " << begin_pos);
       }
 
-      string tag_name = to_lower(Slice(text + begin_pos + 1, i - begin_pos - 1));
-      if (tag_name != "a" && tag_name != "b" && tag_name != "strong" && tag_name != "i" && tag_name != "em" &&
-          tag_name != "s" && tag_name != "strike" && tag_name != "del" && tag_name != "u" && tag_name != "ins" &&
-          tag_name != "tg-spoiler" && tag_name != "tg-emoji" && tag_name != "span" && tag_name != "pre" &&
-          tag_name != "code" && tag_name != "blockquote") {
-        return Status::Error(400, PSLICE()
-                                      << "Unsupported start tag \"" << tag_name << "\" at byte offset " << begin_pos);
+      Slice original_tag_name(text + begin_pos + 1, i - begin_pos - 1);
+      auto tag = get_html_tag(original_tag_name);
+      if (tag == HtmlTag::Unsupported) {
+        return Status::Error(400, PSLICE() << "Unsupported start tag \"" << to_lower(original_tag_name)
+                                           << "\" at byte offset " << begin_pos);
       }
+      auto tag_name = get_html_tag_name(tag);
 
       string argument;
       while (text[i] != '>') {
@@ -3315,7 +3443,7 @@ Result<vector<MessageEntity>> parse_html(string &str) {
             return Status::Error(400, PSLICE()
                                           << "Unclosed start tag \"" << tag_name << "\" at byte offset " << begin_pos);
           }
-          if (tag_name == "blockquote" && attribute_name == Slice("expandable")) {
+          if (tag == HtmlTag::BlockQuote && attribute_name == Slice("expandable")) {
             argument = "1";
           }
           continue;
@@ -3366,26 +3494,26 @@ Result<vector<MessageEntity>> parse_html(string &str) {
           return Status::Error(400, PSLICE() << "Unclosed start tag at byte offset " << begin_pos);
         }
 
-        if (tag_name == "a" && attribute_name == Slice("href")) {
+        if (tag == HtmlTag::A && attribute_name == Slice("href")) {
           argument = std::move(attribute_value);
-        } else if (tag_name == "code" && attribute_name == Slice("class") &&
+        } else if (tag == HtmlTag::Code && attribute_name == Slice("class") &&
                    begins_with(attribute_value, "language-")) {
           argument = attribute_value.substr(9);
-        } else if (tag_name == "span" && attribute_name == Slice("class") && begins_with(attribute_value, "tg-")) {
+        } else if (tag == HtmlTag::Span && attribute_name == Slice("class") && begins_with(attribute_value, "tg-")) {
           argument = attribute_value.substr(3);
-        } else if (tag_name == "tg-emoji" && attribute_name == Slice("emoji-id")) {
+        } else if (tag == HtmlTag::TgEmoji && attribute_name == Slice("emoji-id")) {
           argument = std::move(attribute_value);
-        } else if (tag_name == "blockquote" && attribute_name == Slice("expandable")) {
+        } else if (tag == HtmlTag::BlockQuote && attribute_name == Slice("expandable")) {
           argument = "1";
         }
       }
 
-      if (tag_name == "span" && argument != "spoiler") {
+      if (tag == HtmlTag::Span && argument != "spoiler") {
         return Status::Error(400, PSLICE()
                                       << "Tag \"span\" must have class \"tg-spoiler\" at byte offset " << begin_pos);
       }
 
-      nested_entities.emplace_back(std::move(tag_name), std::move(argument), utf16_offset, result_end - result_begin);
+      nested_entities.emplace_back(tag, std::move(argument), utf16_offset, result_end - result_begin);
     } else {
       // end of an entity
       if (nested_entities.empty()) {
@@ -3395,7 +3523,7 @@ Result<vector<MessageEntity>> parse_html(string &str) {
       while (!is_space(text[i]) && text[i] != '>') {
         i++;
       }
-      string end_tag_name = to_lower(Slice(text + begin_pos + 2, i - begin_pos - 2));
+      Slice end_tag_name(text + begin_pos + 2, i - begin_pos - 2);
       while (is_space(text[i]) && text[i] != 0) {
         i++;
       }
@@ -3403,33 +3531,35 @@ Result<vector<MessageEntity>> parse_html(string &str) {
         return Status::Error(400, PSLICE() << "Unclosed end tag at byte offset " << begin_pos);
       }
 
-      const string &tag_name = nested_entities.back().tag_name;
-      if (!end_tag_name.empty() && end_tag_name != tag_name) {
+      auto tag = nested_entities.back().tag;
+      if (!end_tag_name.empty() && get_html_tag(end_tag_name) != tag) {
         return Status::Error(400, PSLICE() << "Unmatched end tag at byte offset " << begin_pos << ", expected \"</"
-                                           << tag_name << ">\", found \"</" << end_tag_name << ">\"");
+                                           << get_html_tag_name(tag) << ">\", found \"</" << to_lower(end_tag_name)
+                                           << ">\"");
       }
 
       if (utf16_offset > nested_entities.back().entity_offset) {
         auto entity_offset = nested_entities.back().entity_offset;
         auto entity_length = utf16_offset - entity_offset;
-        if (tag_name == "i" || tag_name == "em") {
+        if (tag == HtmlTag::I || tag == HtmlTag::Em) {
           entities.emplace_back(MessageEntity::Type::Italic, entity_offset, entity_length);
-        } else if (tag_name == "b" || tag_name == "strong") {
+        } else if (tag == HtmlTag::B || tag == HtmlTag::Strong) {
           entities.emplace_back(MessageEntity::Type::Bold, entity_offset, entity_length);
-        } else if (tag_name == "s" || tag_name == "strike" || tag_name == "del") {
+        } else if (tag == HtmlTag::S || tag == HtmlTag::Strike || tag == HtmlTag::Del) {
           entities.emplace_back(MessageEntity::Type::Strikethrough, entity_offset, entity_length);
-        } else if (tag_name == "u" || tag_name == "ins") {
+        } else if (tag == HtmlTag::U || tag == HtmlTag::Ins) {
           entities.emplace_back(MessageEntity::Type::Underline, entity_offset, entity_length);
-        } else if (tag_name == "tg-spoiler" || (tag_name == "span" && nested_entities.back().argument == "spoiler")) {
+        } else if (tag == HtmlTag::TgSpoiler ||
+                   (tag == HtmlTag::Span && nested_entities.back().argument == "spoiler")) {
           entities.emplace_back(MessageEntity::Type::Spoiler, entity_offset, entity_length);
-        } else if (tag_name == "tg-emoji") {
+        } else if (tag == HtmlTag::TgEmoji) {
           auto r_document_id = to_integer_safe<int64>(nested_entities.back().argument);
           if (r_document_id.is_error() || r_document_id.ok() == 0) {
             return Status::Error(400, "Invalid custom emoji identifier specified");
           }
           entities.emplace_back(MessageEntity::Type::CustomEmoji, entity_offset, entity_length,
                                 CustomEmojiId(r_document_id.ok()));
-        } else if (tag_name == "a") {
+        } else if (tag == HtmlTag::A) {
           auto url = std::move(nested_entities.back().argument);
           if (url.empty()) {
             url = Slice(result_begin + nested_entities.back().entity_begin_pos, result_end).str();
@@ -3443,7 +3573,7 @@ Result<vector<MessageEntity>> parse_html(string &str) {
               entities.emplace_back(MessageEntity::Type::TextUrl, entity_offset, entity_length, std::move(url));
             }
           }
-        } else if (tag_name == "pre") {
+        } else if (tag == HtmlTag::Pre) {
           if (!entities.empty() && entities.back().type == MessageEntity::Type::Code &&
               entities.back().offset == entity_offset && entities.back().length == entity_length &&
               !entities.back().argument.empty()) {
@@ -3451,7 +3581,7 @@ Result<vector<MessageEntity>> parse_html(string &str) {
           } else {
             entities.emplace_back(MessageEntity::Type::Pre, entity_offset, entity_length);
           }
-        } else if (tag_name == "code") {
+        } else if (tag == HtmlTag::Code) {
           if (!entities.empty() && entities.back().type == MessageEntity::Type::Pre &&
               entities.back().offset == entity_offset && entities.back().length == entity_length &&
               !nested_entities.back().argument.empty()) {
@@ -3461,7 +3591,7 @@ Result<vector<MessageEntity>> parse_html(string &str) {
             entities.emplace_back(MessageEntity::Type::Code, entity_offset, entity_length,
                                   nested_entities.back().argument);
           }
-        } else if (tag_name == "blockquote") {
+        } else if (tag == HtmlTag::BlockQuote) {
           if (!nested_entities.back().argument.empty()) {
             entities.emplace_back(MessageEntity::Type::ExpandableBlockQuote, entity_offset, entity_length);
           } else {
@@ -3475,8 +3605,8 @@ Result<vector<MessageEntity>> parse_html(string &str) {
     }
   }
   if (!nested_entities.empty()) {
-    return Status::Error(
-        400, PSLICE() << "Can't find end tag corresponding to start tag \"" << nested_entities.back().tag_name << '"');
+    return Status::Error(400, PSLICE() << "Can't find end tag corresponding to start tag \""
+                                       << get_html_tag_name(nested_entities.back().tag) << '"');
   }
 
   for (auto &entity : entities) {
@@ -4555,7 +4685,7 @@ Result<FormattedText> get_formatted_text(const Td *td, DialogId dialog_id,
   TRY_RESULT(entities, get_message_entities(td->user_manager_.get(), std::move(text->entities_)));
   auto need_skip_bot_commands = need_always_skip_bot_commands(td->user_manager_.get(), dialog_id, is_bot);
   bool parse_markdown = td->option_manager_->get_option_boolean("always_parse_markdown");
-  bool skip_new_entities = is_bot && td->option_manager_->get_option_integer("session_count") > 1;
+  bool skip_new_entities = is_bot && td->option_manager_->get_option_integer(CachedOption::SessionCount) > 1;
   TRY_STATUS(fix_formatted_text(text->text_, entities, allow_empty, skip_new_entities || parse_markdown,
                                 skip_new_entities || need_skip_bot_commands,
                                 is_bot || skip_media_timestamps || parse_markdown, skip_trim, ltrim_count));
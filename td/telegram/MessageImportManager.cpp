@@ -96,26 +96,24 @@ class CheckHistoryImportPeerQuery final : public Td::ResultHandler {
 };
 
 class InitHistoryImportQuery final : public Td::ResultHandler {
-  Promise<Unit> promise_;
+  Promise<int64> promise_;
   FileId file_id_;
   DialogId dialog_id_;
-  vector<FileId> attached_file_ids_;
 
  public:
-  explicit InitHistoryImportQuery(Promise<Unit> &&promise) : promise_(std::move(promise)) {
+  explicit InitHistoryImportQuery(Promise<int64> &&promise) : promise_(std::move(promise)) {
   }
 
   void send(DialogId dialog_id, FileId file_id, tl_object_ptr<telegram_api::InputFile> &&input_file,
-            vector<FileId> attached_file_ids) {
+            int32 attached_file_count) {
     CHECK(input_file != nullptr);
     file_id_ = file_id;
     dialog_id_ = dialog_id;
-    attached_file_ids_ = std::move(attached_file_ids);
 
     auto input_peer = td_->dialog_manager_->get_input_peer(dialog_id, AccessRights::Write);
     CHECK(input_peer != nullptr);
-    send_query(G()->net_query_creator().create(telegram_api::messages_initHistoryImport(
-        std::move(input_peer), std::move(input_file), narrow_cast<int32>(attached_file_ids_.size()))));
+    send_query(G()->net_query_creator().create(
+        telegram_api::messages_initHistoryImport(std::move(input_peer), std::move(input_file), attached_file_count)));
   }
 
   void on_result(BufferSlice packet) final {
@@ -125,8 +123,7 @@ class InitHistoryImportQuery final : public Td::ResultHandler {
     }
 
     auto ptr = result_ptr.move_as_ok();
-    td_->message_import_manager_->start_import_messages(dialog_id_, ptr->id_, std::move(attached_file_ids_),
-                                                        std::move(promise_));
+    promise_.set_value(std::move(ptr->id_));
 
     td_->file_manager_->delete_partial_remote_location(file_id_);
   }
@@ -344,17 +341,43 @@ void MessageImportManager::import_messages(DialogId dialog_id,
     attached_file_ids.push_back(attached_file_id);
   }
 
-  upload_imported_messages(dialog_id, td_->file_manager_->dup_file_id(file_id, "import_messages"),
-                           std::move(attached_file_ids), false, std::move(promise));
+  auto pending_message_import = make_unique<PendingMessageImport>();
+  pending_message_import->dialog_id = dialog_id;
+  pending_message_import->attached_file_ids = std::move(attached_file_ids);
+  pending_message_import->promise = std::move(promise);
+
+  auto &multipromise = pending_message_import->upload_files_multipromise;
+
+  int64 random_id;
+  do {
+    random_id = Random::secure_int64();
+  } while (random_id == 0 || pending_message_imports_.count(random_id) > 0);
+
+  multipromise.add_promise(PromiseCreator::lambda([actor_id = actor_id(this), random_id](Result<Unit> result) {
+    send_closure_later(actor_id, &MessageImportManager::on_imported_message_attachments_uploaded, random_id,
+                       std::move(result));
+  }));
+  pending_message_import->lock_promise = multipromise.get_promise();
+  auto upload_promise = PromiseCreator::lambda(
+      [actor_id = actor_id(this), random_id, promise = multipromise.get_promise()](Result<Unit> result) mutable {
+        if (result.is_error()) {
+          send_closure(actor_id, &MessageImportManager::on_message_import_failed, random_id, result.error().clone());
+        }
+        promise.set_result(std::move(result));
+      });
+  pending_message_imports_[random_id] = std::move(pending_message_import);
+
+  // attached files are uploaded simultaneously with the message file, but imported only after the import is created
+  upload_imported_messages(dialog_id, td_->file_manager_->dup_file_id(file_id, "import_messages"), random_id, false,
+                           std::move(upload_promise));
+  upload_next_imported_message_attachments(random_id);
 }
 
-void MessageImportManager::upload_imported_messages(DialogId dialog_id, FileId file_id,
-                                                    vector<FileId> attached_file_ids, bool is_reupload,
-                                                    Promise<Unit> &&promise, vector<int> bad_parts) {
+void MessageImportManager::upload_imported_messages(DialogId dialog_id, FileId file_id, int64 random_id,
+                                                    bool is_reupload, Promise<Unit> &&promise, vector<int> bad_parts) {
   CHECK(file_id.is_valid());
   LOG(INFO) << "Ask to upload imported messages file " << file_id;
-  auto info = td::make_unique<UploadedImportedMessagesInfo>(dialog_id, std::move(attached_file_ids), is_reupload,
-                                                            std::move(promise));
+  auto info = td::make_unique<UploadedImportedMessagesInfo>(dialog_id, random_id, is_reupload, std::move(promise));
   bool is_inserted = being_uploaded_imported_messages_.emplace(file_id, std::move(info)).second;
   CHECK(is_inserted);
   // TODO use force_reupload if is_reupload
@@ -374,7 +397,7 @@ void MessageImportManager::on_upload_imported_messages(FileId file_id,
 
   CHECK(it->second != nullptr);
   DialogId dialog_id = it->second->dialog_id;
-  vector<FileId> attached_file_ids = std::move(it->second->attached_file_ids);
+  int64 random_id = it->second->random_id;
   bool is_reupload = it->second->is_reupload;
   Promise<Unit> promise = std::move(it->second->promise);
 
@@ -383,6 +406,12 @@ void MessageImportManager::on_upload_imported_messages(FileId file_id,
   TRY_STATUS_PROMISE(promise,
                      td_->dialog_manager_->check_dialog_access_in_memory(dialog_id, false, AccessRights::Write));
 
+  auto pending_it = pending_message_imports_.find(random_id);
+  if (pending_it == pending_message_imports_.end()) {
+    return promise.set_error(Status::Error(500, "Request aborted"));
+  }
+  auto attached_file_count = narrow_cast<int32>(pending_it->second->attached_file_ids.size());
+
   FileView file_view = td_->file_manager_->get_file_view(file_id);
   CHECK(!file_view.is_encrypted());
   if (input_file == nullptr && file_view.has_remote_location()) {
@@ -397,13 +426,18 @@ void MessageImportManager::on_upload_imported_messages(FileId file_id,
     // delete file reference and forcely reupload the file
     auto file_reference = FileManager::extract_file_reference(file_view.main_remote_location().as_input_document());
     td_->file_manager_->delete_file_reference(file_id, file_reference);
-    upload_imported_messages(dialog_id, file_id, std::move(attached_file_ids), true, std::move(promise), {-1});
+    upload_imported_messages(dialog_id, file_id, random_id, true, std::move(promise), {-1});
     return;
   }
   CHECK(input_file != nullptr);
 
-  td_->create_handler<InitHistoryImportQuery>(std::move(promise))
-      ->send(dialog_id, file_id, std::move(input_file), std::move(attached_file_ids));
+  auto query_promise = PromiseCreator::lambda([actor_id = actor_id(this), random_id, promise = std::move(promise)](
+                                                  Result<int64> r_import_id) mutable {
+    send_closure(actor_id, &MessageImportManager::on_init_history_import, random_id, std::move(r_import_id),
+                 std::move(promise));
+  });
+  td_->create_handler<InitHistoryImportQuery>(std::move(query_promise))
+      ->send(dialog_id, file_id, std::move(input_file), attached_file_count);
 }
 
 void MessageImportManager::on_upload_imported_messages_error(FileId file_id, Status status) {
@@ -428,47 +462,71 @@ void MessageImportManager::on_upload_imported_messages_error(FileId file_id, Sta
   promise.set_error(std::move(status));
 }
 
-void MessageImportManager::start_import_messages(DialogId dialog_id, int64 import_id,
-                                                 vector<FileId> &&attached_file_ids, Promise<Unit> &&promise) {
-  TRY_STATUS_PROMISE(promise, G()->close_status());
-  TRY_STATUS_PROMISE(promise,
-                     td_->dialog_manager_->check_dialog_access_in_memory(dialog_id, false, AccessRights::Write));
-
-  auto pending_message_import = make_unique<PendingMessageImport>();
-  pending_message_import->dialog_id = dialog_id;
-  pending_message_import->import_id = import_id;
-  pending_message_import->promise = std::move(promise);
-
-  auto &multipromise = pending_message_import->upload_files_multipromise;
-
-  int64 random_id;
-  do {
-    random_id = Random::secure_int64();
-  } while (random_id == 0 || pending_message_imports_.count(random_id) > 0);
-  pending_message_imports_[random_id] = std::move(pending_message_import);
+void MessageImportManager::on_init_history_import(int64 random_id, Result<int64> r_import_id,
+                                                  Promise<Unit> &&promise) {
+  G()->ignore_result_if_closing(r_import_id);
+  if (r_import_id.is_error()) {
+    return promise.set_error(r_import_id.move_as_error());
+  }
 
-  multipromise.add_promise(PromiseCreator::lambda([actor_id = actor_id(this), random_id](Result<Unit> result) {
-    send_closure_later(actor_id, &MessageImportManager::on_imported_message_attachments_uploaded, random_id,
-                       std::move(result));
-  }));
-  auto lock_promise = multipromise.get_promise();
+  auto it = pending_message_imports_.find(random_id);
+  if (it == pending_message_imports_.end()) {
+    return promise.set_error(Status::Error(500, "Request aborted"));
+  }
+  auto &pending_message_import = *it->second;
+  CHECK(pending_message_import.import_id == 0);
+  pending_message_import.import_id = r_import_id.ok();
+  LOG(INFO) << "Started import " << pending_message_import.import_id << " to " << pending_message_import.dialog_id;
 
-  for (auto attached_file_id : attached_file_ids) {
-    upload_imported_message_attachment(dialog_id, import_id,
-                                       td_->file_manager_->dup_file_id(attached_file_id, "start_import_messages"),
-                                       false, multipromise.get_promise());
+  auto uploaded_attachments = std::move(pending_message_import.uploaded_attachments);
+  for (auto &uploaded_attachment : uploaded_attachments) {
+    send_imported_message_attachment(pending_message_import, std::move(uploaded_attachment));
   }
+  promise.set_value(Unit());
+}
 
-  lock_promise.set_value(Unit());
+void MessageImportManager::upload_next_imported_message_attachments(int64 random_id) {
+  auto it = pending_message_imports_.find(random_id);
+  if (it == pending_message_imports_.end()) {
+    return;
+  }
+  auto &pending_message_import = *it->second;
+  const auto &attached_file_ids = pending_message_import.attached_file_ids;
+  while (pending_message_import.error.is_ok() &&
+         pending_message_import.active_upload_count < MAX_ACTIVE_ATTACHMENT_UPLOADS &&
+         pending_message_import.started_upload_count < attached_file_ids.size()) {
+    auto file_id = attached_file_ids[pending_message_import.started_upload_count++];
+    pending_message_import.active_upload_count++;
+    auto promise = PromiseCreator::lambda(
+        [actor_id = actor_id(this), random_id,
+         promise = pending_message_import.upload_files_multipromise.get_promise()](Result<Unit> result) mutable {
+          if (result.is_error()) {
+            send_closure(actor_id, &MessageImportManager::on_message_import_failed, random_id,
+                         result.error().clone());
+          } else {
+            send_closure(actor_id, &MessageImportManager::on_imported_message_attachment, random_id);
+          }
+          promise.set_result(std::move(result));
+        });
+    upload_imported_message_attachment(pending_message_import.dialog_id, random_id,
+                                       td_->file_manager_->dup_file_id(file_id, "import_messages"), false,
+                                       std::move(promise));
+  }
+
+  bool is_finished = pending_message_import.error.is_error() ||
+                     pending_message_import.started_upload_count == attached_file_ids.size();
+  if (is_finished && pending_message_import.lock_promise) {
+    pending_message_import.lock_promise.set_value(Unit());
+  }
 }
 
-void MessageImportManager::upload_imported_message_attachment(DialogId dialog_id, int64 import_id, FileId file_id,
+void MessageImportManager::upload_imported_message_attachment(DialogId dialog_id, int64 random_id, FileId file_id,
                                                               bool is_reupload, Promise<Unit> &&promise,
                                                               vector<int> bad_parts) {
   CHECK(file_id.is_valid());
   LOG(INFO) << "Ask to upload imported message attached file " << file_id;
   auto info =
-      td::make_unique<UploadedImportedMessageAttachmentInfo>(dialog_id, import_id, is_reupload, std::move(promise));
+      td::make_unique<UploadedImportedMessageAttachmentInfo>(dialog_id, random_id, is_reupload, std::move(promise));
   bool is_inserted = being_uploaded_imported_message_attachments_.emplace(file_id, std::move(info)).second;
   CHECK(is_inserted);
   // TODO use force_reupload if is_reupload
@@ -488,7 +546,7 @@ void MessageImportManager::on_upload_imported_message_attachment(FileId file_id,
 
   CHECK(it->second != nullptr);
   DialogId dialog_id = it->second->dialog_id;
-  int64 import_id = it->second->import_id;
+  int64 random_id = it->second->random_id;
   bool is_reupload = it->second->is_reupload;
   Promise<Unit> promise = std::move(it->second->promise);
 
@@ -498,9 +556,11 @@ void MessageImportManager::on_upload_imported_message_attachment(FileId file_id,
   CHECK(!file_view.is_encrypted());
   if (input_file == nullptr && file_view.has_remote_location()) {
     if (file_view.main_remote_location().is_web()) {
+      on_imported_message_attachment_upload_finished(random_id);
       return promise.set_error(Status::Error(400, "Can't use web file"));
     }
     if (is_reupload) {
+      on_imported_message_attachment_upload_finished(random_id);
       return promise.set_error(Status::Error(400, "Failed to reupload the file"));
     }
 
@@ -510,16 +570,34 @@ void MessageImportManager::on_upload_imported_message_attachment(FileId file_id,
             ? FileManager::extract_file_reference(file_view.main_remote_location().as_input_photo())
             : FileManager::extract_file_reference(file_view.main_remote_location().as_input_document());
     td_->file_manager_->delete_file_reference(file_id, file_reference);
-    upload_imported_message_attachment(dialog_id, import_id, file_id, true, std::move(promise), {-1});
+    upload_imported_message_attachment(dialog_id, random_id, file_id, true, std::move(promise), {-1});
     return;
   }
   CHECK(input_file != nullptr);
+  on_imported_message_attachment_upload_finished(random_id);
+
+  auto pending_it = pending_message_imports_.find(random_id);
+  if (pending_it == pending_message_imports_.end()) {
+    return promise.set_error(Status::Error(500, "Request aborted"));
+  }
+  auto &pending_message_import = *pending_it->second;
+  if (pending_message_import.error.is_error()) {
+    return promise.set_error(pending_message_import.error.clone());
+  }
 
   auto suggested_path = file_view.suggested_path();
   const PathView path_view(suggested_path);
-  td_->create_handler<UploadImportedMediaQuery>(std::move(promise))
-      ->send(dialog_id, import_id, path_view.file_name().str(), file_id,
-             get_message_content_fake_input_media(td_, std::move(input_file), file_id));
+  UploadedImportedMessageAttachment uploaded_attachment;
+  uploaded_attachment.file_id = file_id;
+  uploaded_attachment.file_name = path_view.file_name().str();
+  uploaded_attachment.input_media = get_message_content_fake_input_media(td_, std::move(input_file), file_id);
+  uploaded_attachment.promise = std::move(promise);
+  if (pending_message_import.import_id == 0) {
+    LOG(INFO) << "Wait for the import to be created to import file " << file_id;
+    pending_message_import.uploaded_attachments.push_back(std::move(uploaded_attachment));
+    return;
+  }
+  send_imported_message_attachment(pending_message_import, std::move(uploaded_attachment));
 }
 
 void MessageImportManager::on_upload_imported_message_attachment_error(FileId file_id, Status status) {
@@ -537,13 +615,68 @@ void MessageImportManager::on_upload_imported_message_attachment_error(FileId fi
     return;
   }
 
+  int64 random_id = it->second->random_id;
   Promise<Unit> promise = std::move(it->second->promise);
 
   being_uploaded_imported_message_attachments_.erase(it);
 
+  on_imported_message_attachment_upload_finished(random_id);
   promise.set_error(std::move(status));
 }
 
+void MessageImportManager::on_imported_message_attachment_upload_finished(int64 random_id) {
+  auto it = pending_message_imports_.find(random_id);
+  if (it == pending_message_imports_.end()) {
+    return;
+  }
+  CHECK(it->second->active_upload_count > 0);
+  it->second->active_upload_count--;
+  upload_next_imported_message_attachments(random_id);
+}
+
+void MessageImportManager::send_imported_message_attachment(const PendingMessageImport &pending_message_import,
+                                                            UploadedImportedMessageAttachment &&uploaded_attachment) {
+  CHECK(pending_message_import.import_id != 0);
+  td_->create_handler<UploadImportedMediaQuery>(std::move(uploaded_attachment.promise))
+      ->send(pending_message_import.dialog_id, pending_message_import.import_id, uploaded_attachment.file_name,
+             uploaded_attachment.file_id, std::move(uploaded_attachment.input_media));
+}
+
+void MessageImportManager::on_imported_message_attachment(int64 random_id) {
+  auto it = pending_message_imports_.find(random_id);
+  if (it == pending_message_imports_.end()) {
+    return;
+  }
+  auto &pending_message_import = *it->second;
+  pending_message_import.imported_file_count++;
+  send_closure(G()->td(), &Td::send_update,
+               td_api::make_object<td_api::updateMessageImportProgress>(
+                   td_->dialog_manager_->get_chat_id_object(pending_message_import.dialog_id,
+                                                            "updateMessageImportProgress"),
+                   pending_message_import.imported_file_count,
+                   narrow_cast<int32>(pending_message_import.attached_file_ids.size())));
+}
+
+void MessageImportManager::on_message_import_failed(int64 random_id, Status error) {
+  auto it = pending_message_imports_.find(random_id);
+  if (it == pending_message_imports_.end()) {
+    return;
+  }
+  auto &pending_message_import = *it->second;
+  if (pending_message_import.error.is_error()) {
+    return;
+  }
+  LOG(INFO) << "Failed to import messages to " << pending_message_import.dialog_id << ": " << error;
+
+  // there is no need to upload and import the remaining files
+  pending_message_import.error = std::move(error);
+  auto uploaded_attachments = std::move(pending_message_import.uploaded_attachments);
+  for (auto &uploaded_attachment : uploaded_attachments) {
+    uploaded_attachment.promise.set_error(pending_message_import.error.clone());
+  }
+  upload_next_imported_message_attachments(random_id);
+}
+
 void MessageImportManager::on_imported_message_attachments_uploaded(int64 random_id, Result<Unit> &&result) {
   G()->ignore_result_if_closing(result);
 
@@ -561,6 +694,7 @@ void MessageImportManager::on_imported_message_attachments_uploaded(int64 random
   }
 
   CHECK(pending_message_import->upload_files_multipromise.promise_count() == 0);
+  CHECK(pending_message_import->import_id != 0);
 
   auto promise = std::move(pending_message_import->promise);
   auto dialog_id = pending_message_import->dialog_id;
@@ -37,28 +37,61 @@ class MessageImportManager final : public Actor {
   void import_messages(DialogId dialog_id, const td_api::object_ptr<td_api::InputFile> &message_file,
                        const vector<td_api::object_ptr<td_api::InputFile>> &attached_files, Promise<Unit> &&promise);
 
-  void start_import_messages(DialogId dialog_id, int64 import_id, vector<FileId> &&attached_file_ids,
-                             Promise<Unit> &&promise);
-
  private:
+  static constexpr size_t MAX_ACTIVE_ATTACHMENT_UPLOADS = 8;
+
+  struct UploadedImportedMessageAttachment {
+    FileId file_id;
+    string file_name;
+    tl_object_ptr<telegram_api::InputMedia> input_media;
+    Promise<Unit> promise;
+  };
+
+  struct PendingMessageImport {
+    MultiPromiseActor upload_files_multipromise{"UploadAttachedFilesMultiPromiseActor"};
+    DialogId dialog_id;
+    int64 import_id = 0;
+    vector<FileId> attached_file_ids;
+    size_t started_upload_count = 0;
+    size_t active_upload_count = 0;
+    int32 imported_file_count = 0;
+    vector<UploadedImportedMessageAttachment> uploaded_attachments;  // waiting for the import to be created
+    Status error;
+    Promise<Unit> lock_promise;
+    Promise<Unit> promise;
+  };
+
   void tear_down() final;
 
   Status can_import_messages(DialogId dialog_id);
 
-  void upload_imported_messages(DialogId dialog_id, FileId file_id, vector<FileId> attached_file_ids, bool is_reupload,
+  void upload_imported_messages(DialogId dialog_id, FileId file_id, int64 random_id, bool is_reupload,
                                 Promise<Unit> &&promise, vector<int> bad_parts = {});
 
   void on_upload_imported_messages(FileId file_id, tl_object_ptr<telegram_api::InputFile> input_file);
 
   void on_upload_imported_messages_error(FileId file_id, Status status);
 
-  void upload_imported_message_attachment(DialogId dialog_id, int64 import_id, FileId file_id, bool is_reupload,
+  void on_init_history_import(int64 random_id, Result<int64> r_import_id, Promise<Unit> &&promise);
+
+  void upload_next_imported_message_attachments(int64 random_id);
+
+  void upload_imported_message_attachment(DialogId dialog_id, int64 random_id, FileId file_id, bool is_reupload,
                                           Promise<Unit> &&promise, vector<int> bad_parts = {});
 
   void on_upload_imported_message_attachment(FileId file_id, tl_object_ptr<telegram_api::InputFile> input_file);
 
   void on_upload_imported_message_attachment_error(FileId file_id, Status status);
 
+  void on_imported_message_attachment_upload_finished(int64 random_id);
+
+  void send_imported_message_attachment(const PendingMessageImport &pending_message_import,
+                                        UploadedImportedMessageAttachment &&uploaded_attachment);
+
+  void on_imported_message_attachment(int64 random_id);
+
+  void on_message_import_failed(int64 random_id, Status error);
+
   void on_imported_message_attachments_uploaded(int64 random_id, Result<Unit> &&result);
 
   class UploadImportedMessagesCallback;
@@ -69,40 +102,30 @@ class MessageImportManager final : public Actor {
 
   struct UploadedImportedMessagesInfo {
     DialogId dialog_id;
-    vector<FileId> attached_file_ids;
+    int64 random_id;
     bool is_reupload;
     Promise<Unit> promise;
 
-    UploadedImportedMessagesInfo(DialogId dialog_id, vector<FileId> &&attached_file_ids, bool is_reupload,
-                                 Promise<Unit> &&promise)
-        : dialog_id(dialog_id)
-        , attached_file_ids(std::move(attached_file_ids))
-        , is_reupload(is_reupload)
-        , promise(std::move(promise)) {
+    UploadedImportedMessagesInfo(DialogId dialog_id, int64 random_id, bool is_reupload, Promise<Unit> &&promise)
+        : dialog_id(dialog_id), random_id(random_id), is_reupload(is_reupload), promise(std::move(promise)) {
     }
   };
   FlatHashMap<FileId, unique_ptr<UploadedImportedMessagesInfo>, FileIdHash> being_uploaded_imported_messages_;
 
   struct UploadedImportedMessageAttachmentInfo {
     DialogId dialog_id;
-    int64 import_id;
+    int64 random_id;
     bool is_reupload;
     Promise<Unit> promise;
 
-    UploadedImportedMessageAttachmentInfo(DialogId dialog_id, int64 import_id, bool is_reupload,
+    UploadedImportedMessageAttachmentInfo(DialogId dialog_id, int64 random_id, bool is_reupload,
                                           Promise<Unit> &&promise)
-        : dialog_id(dialog_id), import_id(import_id), is_reupload(is_reupload), promise(std::move(promise)) {
+        : dialog_id(dialog_id), random_id(random_id), is_reupload(is_reupload), promise(std::move(promise)) {
     }
   };
   FlatHashMap<FileId, unique_ptr<UploadedImportedMessageAttachmentInfo>, FileIdHash>
       being_uploaded_imported_message_attachments_;
 
-  struct PendingMessageImport {
-    MultiPromiseActor upload_files_multipromise{"UploadAttachedFilesMultiPromiseActor"};
-    DialogId dialog_id;
-    int64 import_id = 0;
-    Promise<Unit> promise;
-  };
   FlatHashMap<int64, unique_ptr<PendingMessageImport>> pending_message_imports_;
 
   Td *td_;
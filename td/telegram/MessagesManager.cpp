@@ -46,6 +46,7 @@
 #include "td/telegram/LinkManager.h"
 #include "td/telegram/Location.h"
 #include "td/telegram/logevent/LogEvent.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageContent.h"
 #include "td/telegram/MessageDb.h"
 #include "td/telegram/MessageEntity.h"
@@ -62,6 +63,7 @@
 #include "td/telegram/misc.h"
 #include "td/telegram/MissingInvitee.h"
 #include "td/telegram/net/DcId.h"
+#include "td/telegram/net/NetQueryDispatcher.h"
 #include "td/telegram/NotificationGroupInfo.hpp"
 #include "td/telegram/NotificationGroupType.h"
 #include "td/telegram/NotificationManager.h"
@@ -73,6 +75,7 @@
 #include "td/telegram/OptionManager.h"
 #include "td/telegram/Photo.h"
 #include "td/telegram/PollId.h"
+#include "td/telegram/PollManager.h"
 #include "td/telegram/PublicDialogType.h"
 #include "td/telegram/QuickReplyManager.h"
 #include "td/telegram/ReactionManager.h"
@@ -2928,8 +2931,9 @@ class SendMessageQuery final : public Td::ResultHandler {
                                            std::move(reply_markup), std::move(entities), schedule_date,
                                            std::move(as_input_peer), nullptr, effect_id.get()),
         {{dialog_id, MessageContentType::Text},
-         {dialog_id, is_copy ? MessageContentType::Photo : MessageContentType::Text}});
-    if (td_->option_manager_->get_option_boolean("use_quick_ack")) {
+         {dialog_id, is_copy ? MessageContentType::Photo : MessageContentType::Text}},
+        DcId::main(), NetQuery::Type::Common, NetQuery::Priority::Interactive);
+    if (td_->option_manager_->get_option_boolean(CachedOption::UseQuickAck)) {
       query->quick_ack_promise_ = PromiseCreator::lambda([random_id](Result<Unit> result) {
         if (result.is_ok()) {
           send_closure(G()->messages_manager(), &MessagesManager::on_send_message_get_quick_ack, random_id);
@@ -2998,7 +3002,7 @@ class StartBotQuery final : public Td::ResultHandler {
     auto query = G()->net_query_creator().create(
         telegram_api::messages_startBot(std::move(bot_input_user), std::move(input_peer), random_id, parameter),
         {{dialog_id, MessageContentType::Text}, {dialog_id, MessageContentType::Photo}});
-    if (td_->option_manager_->get_option_boolean("use_quick_ack")) {
+    if (td_->option_manager_->get_option_boolean(CachedOption::UseQuickAck)) {
       query->quick_ack_promise_ = PromiseCreator::lambda([random_id](Result<Unit> result) {
         if (result.is_ok()) {
           send_closure(G()->messages_manager(), &MessagesManager::on_send_message_get_quick_ack, random_id);
@@ -3131,7 +3135,8 @@ class SendMultiMediaQuery final : public Td::ResultHandler {
                                               std::move(input_peer), std::move(reply_to), std::move(input_single_media),
                                               schedule_date, std::move(as_input_peer), nullptr, effect_id.get()),
         {{dialog_id, is_copy ? MessageContentType::Text : MessageContentType::Photo},
-         {dialog_id, MessageContentType::Photo}}));
+         {dialog_id, MessageContentType::Photo}},
+        DcId::main(), NetQuery::Type::Common, NetQuery::Priority::Interactive));
   }
 
   void on_result(BufferSlice packet) final {
@@ -3253,8 +3258,9 @@ class SendMediaQuery final : public Td::ResultHandler {
                                          std::move(reply_to), std::move(input_media), text, random_id,
                                          std::move(reply_markup), std::move(entities), schedule_date,
                                          std::move(as_input_peer), nullptr, effect_id.get()),
-        {{dialog_id, content_type}, {dialog_id, is_copy ? MessageContentType::Text : content_type}});
-    if (td_->option_manager_->get_option_boolean("use_quick_ack") && was_uploaded_) {
+        {{dialog_id, content_type}, {dialog_id, is_copy ? MessageContentType::Text : content_type}}, DcId::main(),
+        NetQuery::Type::Common, NetQuery::Priority::Interactive);
+    if (td_->option_manager_->get_option_boolean(CachedOption::UseQuickAck) && was_uploaded_) {
       query->quick_ack_promise_ = PromiseCreator::lambda([random_id](Result<Unit> result) {
         if (result.is_ok()) {
           send_closure(G()->messages_manager(), &MessagesManager::on_send_message_get_quick_ack, random_id);
@@ -3585,7 +3591,7 @@ class ForwardMessagesQuery final : public Td::ResultHandler {
             std::move(random_ids), std::move(to_input_peer), top_thread_message_id.get_server_message_id().get(),
             schedule_date, std::move(as_input_peer), nullptr),
         {{to_dialog_id, MessageContentType::Text}, {to_dialog_id, MessageContentType::Photo}});
-    if (td_->option_manager_->get_option_boolean("use_quick_ack")) {
+    if (td_->option_manager_->get_option_boolean(CachedOption::UseQuickAck)) {
       query->quick_ack_promise_ = PromiseCreator::lambda([random_ids = random_ids_](Result<Unit> result) {
         if (result.is_ok()) {
           for (auto random_id : random_ids) {
@@ -3693,7 +3699,7 @@ class SendQuickReplyMessagesQuery final : public Td::ResultHandler {
                                                       MessageId::get_server_message_ids(message_ids),
                                                       std::move(random_ids)),
         {{dialog_id, MessageContentType::Text}, {dialog_id, MessageContentType::Photo}});
-    if (td_->option_manager_->get_option_boolean("use_quick_ack")) {
+    if (td_->option_manager_->get_option_boolean(CachedOption::UseQuickAck)) {
       query->quick_ack_promise_ = PromiseCreator::lambda([random_ids = random_ids_](Result<Unit> result) {
         if (result.is_ok()) {
           for (auto random_id : random_ids) {
@@ -4163,9 +4169,11 @@ class GetChannelDifferenceQuery final : public Td::ResultHandler {
     if (force) {
       flags |= telegram_api::updates_getChannelDifference::FORCE_MASK;
     }
-    send_query(G()->net_query_creator().create(telegram_api::updates_getChannelDifference(
-        flags, false /*ignored*/, std::move(input_channel), make_tl_object<telegram_api::channelMessagesFilterEmpty>(),
-        pts, limit)));
+    send_query(G()->net_query_creator().create(
+        telegram_api::updates_getChannelDifference(flags, false /*ignored*/, std::move(input_channel),
+                                                   make_tl_object<telegram_api::channelMessagesFilterEmpty>(), pts,
+                                                   limit),
+        {}, DcId::main(), NetQuery::Type::Common, NetQuery::Priority::Background));
   }
 
   void on_result(BufferSlice packet) final {
@@ -4237,7 +4245,7 @@ void MessagesManager::Message::store(StorerT &storer) const {
   bool has_send_date = message_id.is_yet_unsent() && send_date != 0;
   bool has_flags2 = true;
   bool has_notification_id = notification_id.is_valid();
-  bool has_send_error_code = send_error_code != 0;
+  bool has_send_error_code = send_error != nullptr && send_error->code != 0;
   bool has_real_forward_from = real_forward_from_dialog_id.is_valid() && real_forward_from_message_id.is_valid();
   bool has_legacy_layer = legacy_layer != 0;
   bool has_restriction_reasons = !restriction_reasons.empty();
@@ -4399,10 +4407,10 @@ void MessagesManager::Message::store(StorerT &storer) const {
     store_time(ttl_expires_at, storer);
   }
   if (has_send_error_code) {
-    store(send_error_code, storer);
-    store(send_error_message, storer);
-    if (send_error_code == 429) {
-      store_time(try_resend_at, storer);
+    store(send_error->code, storer);
+    store(send_error->message, storer);
+    if (send_error->code == 429) {
+      store_time(send_error->try_resend_at, storer);
     }
   }
   if (has_author_signature) {
@@ -4730,10 +4738,11 @@ void MessagesManager::Message::parse(ParserT &parser) {
     parse_time(ttl_expires_at, parser);
   }
   if (has_send_error_code) {
-    parse(send_error_code, parser);
-    parse(send_error_message, parser);
-    if (send_error_code == 429) {
-      parse_time(try_resend_at, parser);
+    send_error = make_unique<MessageSendError>();
+    parse(send_error->code, parser);
+    parse(send_error->message, parser);
+    if (send_error->code == 429) {
+      parse_time(send_error->try_resend_at, parser);
     }
   }
   if (has_author_signature) {
@@ -5559,6 +5568,9 @@ MessagesManager::MessagesManager(Td *td, ActorShared<> parent)
   send_update_chat_read_inbox_timeout_.set_callback(on_send_update_chat_read_inbox_timeout_callback);
   send_update_chat_read_inbox_timeout_.set_callback_data(static_cast<void *>(this));
 
+  send_update_message_interaction_info_timeout_.set_callback(on_send_update_message_interaction_info_timeout_callback);
+  send_update_message_interaction_info_timeout_.set_callback_data(static_cast<void *>(this));
+
   send_paid_reactions_timeout_.set_callback(on_send_paid_reactions_timeout_callback);
   send_paid_reactions_timeout_.set_callback_data(static_cast<void *>(this));
 }
@@ -5573,7 +5585,8 @@ MessagesManager::~MessagesManager() {
       active_get_channel_differences_, get_channel_difference_to_log_event_id_, channel_get_difference_retry_timeouts_,
       is_channel_difference_finished_, expected_channel_pts_, expected_channel_max_message_id_,
       dialog_bot_command_message_ids_, message_full_id_to_file_source_id_, last_outgoing_forwarded_message_date_,
-      dialog_viewed_messages_, previous_repaired_read_inbox_max_message_id_, failed_to_load_dialogs_);
+      dialog_viewed_messages_, previous_repaired_read_inbox_max_message_id_, failed_to_load_dialogs_,
+      postponed_message_interaction_info_updates_);
 }
 
 MessagesManager::AddDialogData::AddDialogData(int32 dependent_dialog_count, unique_ptr<Message> &&last_message,
@@ -5704,6 +5717,17 @@ void MessagesManager::on_send_update_chat_read_inbox_timeout_callback(void *mess
                      &MessagesManager::on_send_update_chat_read_inbox_timeout, DialogId(dialog_id_int));
 }
 
+void MessagesManager::on_send_update_message_interaction_info_timeout_callback(void *messages_manager_ptr,
+                                                                               int64 dialog_id_int) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  auto messages_manager = static_cast<MessagesManager *>(messages_manager_ptr);
+  send_closure_later(messages_manager->actor_id(messages_manager),
+                     &MessagesManager::on_send_update_message_interaction_info_timeout, DialogId(dialog_id_int));
+}
+
 void MessagesManager::on_send_paid_reactions_timeout_callback(void *messages_manager_ptr, int64 task_id) {
   if (G()->close_flag()) {
     return;
@@ -6790,7 +6814,15 @@ bool MessagesManager::update_message_interaction_info(Dialog *d, Message *m, int
       }
     }
     if (need_update) {
-      send_update_message_interaction_info(dialog_id, m);
+      if (need_update_reply_info || !m->is_update_sent) {
+        send_update_message_interaction_info(dialog_id, m);
+      } else {
+        // popular messages can receive many changes of the counters in a short time, so send only the last state
+        LOG(DEBUG) << "Postpone updateMessageInteractionInfo for " << message_full_id;
+        postponed_message_interaction_info_updates_[dialog_id].insert(m->message_id);
+        send_update_message_interaction_info_timeout_.add_timeout_in(dialog_id.get(),
+                                                                     MESSAGE_INTERACTION_INFO_UPDATE_DELAY);
+      }
     }
     if (new_dialog_unread_reaction_count >= 0) {
       send_update_message_unread_reactions(dialog_id, m, new_dialog_unread_reaction_count);
@@ -8413,7 +8445,7 @@ void MessagesManager::do_send_media(DialogId dialog_id, const Message *m, int32
   const MessageContent *content = nullptr;
   if (m->message_id.is_any_server()) {
     CHECK(media_pos == -1);
-    content = m->edited_content.get();
+    content = m->edited_media == nullptr ? nullptr : m->edited_media->content.get();
     if (content == nullptr) {
       LOG(ERROR) << "Message has no edited content";
       return;
@@ -8560,7 +8592,7 @@ void MessagesManager::on_upload_thumbnail(FileId thumbnail_file_id,
   bool is_edit = m->message_id.is_any_server();
 
   if (thumbnail_input_file == nullptr) {
-    delete_message_content_thumbnail(is_edit ? m->edited_content.get() : m->content.get(), td_, media_pos);
+    delete_message_content_thumbnail(is_edit ? m->edited_media->content.get() : m->content.get(), td_, media_pos);
   }
 
   auto dialog_id = message_full_id.get_dialog_id();
@@ -8921,6 +8953,7 @@ void MessagesManager::on_get_history(DialogId dialog_id, MessageId from_message_
   MessageId first_added_message_id;
   MessageId last_added_message_id;
   bool have_next = false;
+  vector<MessageId> added_message_ids;
 
   if (narrow_cast<int32>(messages.size()) < limit + offset && messages.size() <= 1) {
     MessageId first_received_message_id = MessageId::get_message_id(messages.back(), false);
@@ -8995,8 +9028,11 @@ void MessagesManager::on_get_history(DialogId dialog_id, MessageId from_message_
         d->ordered_messages.attach_message_to_previous(first_added_message_id, "on_get_history");
       }
       first_added_message_id = message_id;
+      added_message_ids.push_back(message_id);
     }
   }
+  get_history_replied_messages(d, added_message_ids);
+  warm_up_history_media_dcs(d, added_message_ids);
 
   if (from_the_end && last_added_message_id.is_valid() && last_added_message_id != last_received_message_id) {
     CHECK(last_added_message_id < last_received_message_id);
@@ -9128,6 +9164,66 @@ void MessagesManager::on_get_history(DialogId dialog_id, MessageId from_message_
   promise.set_value(Unit());
 }
 
+void MessagesManager::get_history_replied_messages(Dialog *d, const vector<MessageId> &message_ids) {
+  // replied messages are likely to be requested soon after the history is shown,
+  // so all unknown messages replied from the chunk are fetched with a single request instead of one request per reply
+  // replies to messages from other chats are skipped, because they are received with the replied message content
+  vector<MessageFullId> replied_message_full_ids;
+  FlatHashSet<MessageId, MessageIdHash> replied_message_ids;
+  for (auto message_id : message_ids) {
+    const Message *m = get_message(d, message_id);
+    if (m == nullptr) {
+      continue;
+    }
+    auto reply_message_full_id = m->replied_message_info.get_reply_message_full_id(d->dialog_id, true);
+    auto reply_message_id = reply_message_full_id.get_message_id();
+    if (reply_message_full_id.get_dialog_id() != d->dialog_id || !reply_message_id.is_valid() ||
+        !reply_message_id.is_server() || reply_message_id <= d->last_clear_history_message_id ||
+        reply_message_id <= d->max_unavailable_message_id || is_deleted_message(d, reply_message_id) ||
+        replied_message_ids.count(reply_message_id) != 0 ||
+        get_message_force(d, reply_message_id, "get_history_replied_messages") != nullptr) {
+      continue;
+    }
+    replied_message_ids.insert(reply_message_id);
+    replied_message_full_ids.emplace_back(d->dialog_id, reply_message_id);
+  }
+  if (replied_message_full_ids.empty()) {
+    return;
+  }
+
+  LOG(INFO) << "Prefetch " << replied_message_full_ids.size() << " replied messages in " << d->dialog_id;
+  get_messages_from_server(std::move(replied_message_full_ids), Promise<Unit>(), "get_history_replied_messages");
+}
+
+void MessagesManager::warm_up_history_media_dcs(const Dialog *d, const vector<MessageId> &message_ids) {
+  // media previews are likely to be downloaded soon after the history is shown, so authorization in the DCs
+  // storing the files is imported in advance instead of delaying the first download by several round trips
+  vector<DcId> dc_ids;
+  for (auto message_id : message_ids) {
+    const Message *m = get_message(d, message_id);
+    if (m == nullptr) {
+      continue;
+    }
+    for (auto file_id : get_message_content_file_ids(m->content.get(), td_)) {
+      auto file_view = td_->file_manager_->get_file_view(file_id);
+      if (file_view.empty() || file_view.has_local_location() || !file_view.has_active_download_remote_location()) {
+        continue;
+      }
+      const auto &remote_location = file_view.remote_location();
+      if (remote_location.is_web()) {
+        continue;
+      }
+      auto dc_id = remote_location.get_dc_id();
+      if (dc_id.is_exact() && dc_id.is_internal() && !td::contains(dc_ids, dc_id)) {
+        dc_ids.push_back(dc_id);
+      }
+    }
+  }
+  for (auto dc_id : dc_ids) {
+    G()->net_query_dispatcher().warm_up_dc(dc_id);
+  }
+}
+
 void MessagesManager::on_get_public_dialogs_search_result(const string &query,
                                                           vector<tl_object_ptr<telegram_api::Peer>> &&my_peers,
                                                           vector<tl_object_ptr<telegram_api::Peer>> &&peers) {
@@ -10910,6 +11006,53 @@ void MessagesManager::unload_dialog(DialogId dialog_id, int32 delay) {
   }
 }
 
+void MessagesManager::on_loaded_message_count_changed() {
+  if (is_loaded_message_count_check_scheduled_ || !is_message_unload_enabled() || G()->close_flag()) {
+    return;
+  }
+  auto max_loaded_message_count = td_->option_manager_->get_option_integer("max_loaded_message_count");
+  if (max_loaded_message_count <= 0 || loaded_message_count_ <= max_loaded_message_count) {
+    return;
+  }
+  is_loaded_message_count_check_scheduled_ = true;
+  send_closure_later(actor_id(this), &MessagesManager::unload_least_recently_used_messages);
+}
+
+void MessagesManager::unload_least_recently_used_messages() {
+  is_loaded_message_count_check_scheduled_ = false;
+  if (G()->close_flag()) {
+    return;
+  }
+  auto max_loaded_message_count = td_->option_manager_->get_option_integer("max_loaded_message_count");
+  if (max_loaded_message_count <= 0 || loaded_message_count_ <= max_loaded_message_count) {
+    return;
+  }
+
+  // unload 10% more messages than needed to avoid unloading on each new message
+  auto target_message_count = max_loaded_message_count - max_loaded_message_count / 10;
+  LOG(INFO) << "Have " << loaded_message_count_ << " loaded messages with limit " << max_loaded_message_count;
+
+  // messages are unloaded from dialogs in the order of the last access to their least recently used message
+  vector<std::pair<int32, DialogId>> dialogs;
+  dialogs_.foreach([&](const DialogId &dialog_id, unique_ptr<Dialog> &dialog) {
+    const Dialog *d = dialog.get();
+    if (!d->has_unload_timeout || d->message_lru_list.empty()) {
+      return;
+    }
+    const auto *m = static_cast<const Message *>(d->message_lru_list.next);
+    dialogs.emplace_back(m->last_access_date, dialog_id);
+  });
+  std::sort(dialogs.begin(), dialogs.end(), [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+  for (auto &dialog : dialogs) {
+    if (loaded_message_count_ <= target_message_count) {
+      break;
+    }
+    unload_dialog(dialog.second, 0);
+  }
+  LOG(INFO) << "Have " << loaded_message_count_ << " loaded messages after unloading";
+}
+
 void MessagesManager::clear_dialog_message_list(Dialog *d, bool remove_from_dialog_list, int32 last_message_date) {
   if (d->server_unread_count + d->local_unread_count > 0) {
     MessageId max_message_id =
@@ -11001,6 +11144,7 @@ void MessagesManager::delete_all_dialog_messages(Dialog *d, bool remove_from_dia
       d->deleted_message_ids.insert(m->message_id);
     }
   });
+  loaded_message_count_ -= static_cast<int64>(d->messages.calc_size());
   Scheduler::instance()->destroy_on_scheduler(G()->get_gc_scheduler_id(), d->messages, d->ordered_messages);
 
   if (was_live_location_deleted) {
@@ -12123,6 +12267,28 @@ void MessagesManager::on_send_update_chat_read_inbox_timeout(DialogId dialog_id)
   }
 }
 
+void MessagesManager::on_send_update_message_interaction_info_timeout(DialogId dialog_id) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  auto it = postponed_message_interaction_info_updates_.find(dialog_id);
+  if (it == postponed_message_interaction_info_updates_.end()) {
+    return;
+  }
+  auto message_ids = std::move(it->second);
+  postponed_message_interaction_info_updates_.erase(it);
+
+  Dialog *d = get_dialog(dialog_id);
+  CHECK(d != nullptr);
+  for (auto message_id : message_ids) {
+    const Message *m = get_message(d, message_id);
+    if (m != nullptr) {
+      send_update_message_interaction_info(dialog_id, m);
+    }
+  }
+}
+
 void MessagesManager::on_send_paid_reactions_timeout(int64 task_id) {
   if (G()->close_flag()) {
     return;
@@ -15033,7 +15199,7 @@ bool MessagesManager::can_unload_message(const Dialog *d, const Message *m) cons
   MessageFullId message_full_id{d->dialog_id, m->message_id};
   if (td_->auth_manager_->is_bot() && !G()->use_message_database()) {
     return !m->message_id.is_yet_unsent() && replied_by_yet_unsent_messages_.count(message_full_id) == 0 &&
-           m->edited_content == nullptr && m->message_id != d->last_pinned_message_id &&
+           m->edited_media == nullptr && m->message_id != d->last_pinned_message_id &&
            m->message_id != d->last_edited_message_id;
   }
   // don't want to unload messages from opened dialogs
@@ -15052,7 +15218,7 @@ bool MessagesManager::can_unload_message(const Dialog *d, const Message *m) cons
   }
   return d->open_count == 0 && m->message_id != d->last_message_id && m->message_id != d->last_database_message_id &&
          !m->message_id.is_yet_unsent() && active_live_location_message_full_ids_.count(message_full_id) == 0 &&
-         replied_by_yet_unsent_messages_.count(message_full_id) == 0 && m->edited_content == nullptr &&
+         replied_by_yet_unsent_messages_.count(message_full_id) == 0 && m->edited_media == nullptr &&
          m->message_id != d->reply_markup_message_id && m->message_id != d->last_pinned_message_id &&
          m->message_id != d->last_edited_message_id &&
          (m->media_album_id != d->last_media_album_id || m->media_album_id == 0);
@@ -15441,6 +15607,7 @@ unique_ptr<MessagesManager::Message> MessagesManager::do_delete_message(Dialog *
   auto result = std::move(d->messages[message_id]);
   CHECK(m == result.get());
   d->messages.erase(message_id);
+  loaded_message_count_--;
 
   static_cast<ListNode *>(result.get())->remove();
 
@@ -15888,7 +16055,7 @@ vector<DialogId> MessagesManager::get_dialogs(DialogListId dialog_list_id, Dialo
   update_list_last_pinned_dialog_date(list);
 
   vector<const DialogFolder *> folders;
-  vector<std::set<DialogDate>::const_iterator> folder_iterators;
+  vector<BlockSortedSet<DialogDate>::const_iterator> folder_iterators;
   for (auto folder_id : get_dialog_list_folder_ids(list)) {
     folders.push_back(get_dialog_folder(folder_id));
     folder_iterators.push_back(folders.back()->ordered_dialogs_.upper_bound(offset));
@@ -18139,7 +18306,7 @@ int32 MessagesManager::get_pinned_dialogs_limit(DialogListId dialog_list_id) con
   }
   int32 limit = clamp(narrow_cast<int32>(td_->option_manager_->get_option_integer(key)), 0, 1000);
   if (limit <= 0) {
-    if (td_->option_manager_->get_option_boolean("is_premium")) {
+    if (td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
       default_limit *= 2;
     }
     return default_limit;
@@ -19429,6 +19596,8 @@ void MessagesManager::open_dialog(Dialog *d) {
   }
   d->was_opened = true;
 
+  td_->poll_manager_->on_dialog_opened(dialog_id);
+
   auto min_message_id = MessageId(ServerMessageId(1));
   if (d->last_message_id == MessageId() && d->last_read_outbox_message_id < min_message_id) {
     auto it = d->ordered_messages.get_const_iterator(MessageId::max());
@@ -19711,7 +19880,7 @@ td_api::object_ptr<td_api::MessageSender> MessagesManager::get_default_message_s
 td_api::object_ptr<td_api::chat> MessagesManager::get_chat_object(const Dialog *d, const char *source) const {
   CHECK(d != nullptr);
 
-  bool is_premium = td_->option_manager_->get_option_boolean("is_premium");
+  bool is_premium = td_->option_manager_->get_option_boolean(CachedOption::IsPremium);
   auto chat_source = is_dialog_sponsored(d) ? sponsored_dialog_source_.get_chat_source_object() : nullptr;
   auto can_delete = can_delete_dialog(d);
   // TODO hide/show draft message when need_hide_dialog_draft_message changes
@@ -20160,6 +20329,13 @@ void MessagesManager::do_read_history_on_server(DialogId dialog_id) {
 
   auto it = updated_read_history_message_ids_.find(dialog_id);
   if (it != updated_read_history_message_ids_.end()) {
+    auto delay = get_read_history_query_delay();
+    if (delay > 0.0) {
+      // mass reading of chats must not exceed flood limits; repeated reads of the chat are merged while waiting
+      pending_read_history_timeout_.set_timeout_in(dialog_id.get(), delay);
+      return;
+    }
+
     auto top_thread_message_ids = std::move(it->second);
     updated_read_history_message_ids_.erase(it);
     for (auto top_thread_message_id : top_thread_message_ids) {
@@ -20172,6 +20348,19 @@ void MessagesManager::do_read_history_on_server(DialogId dialog_id) {
   }
 }
 
+double MessagesManager::get_read_history_query_delay() {
+  auto now = Time::now();
+  if (now >= read_history_query_window_end_time_) {
+    read_history_query_window_end_time_ = now + 1.0;
+    read_history_query_count_ = 0;
+  }
+  if (read_history_query_count_ < MAX_READ_HISTORY_QUERIES_PER_SECOND) {
+    read_history_query_count_++;
+    return 0.0;
+  }
+  return read_history_query_window_end_time_ - now + Random::fast(0, 1000) * 1e-3;
+}
+
 void MessagesManager::read_history_on_server_impl(Dialog *d, MessageId max_message_id) {
   CHECK(d != nullptr);
   CHECK(max_message_id == MessageId() || max_message_id.is_valid());
@@ -22665,7 +22854,7 @@ ChatReactions MessagesManager::get_message_available_reactions(const Dialog *d,
     if (can_add_message_tag(d->dialog_id, m->reactions.get())) {
       auto default_tag_reactions = td_->reaction_manager_->get_default_tag_reactions();
       active_reactions.reaction_types_ = default_tag_reactions;
-      if (td_->option_manager_->get_option_boolean("is_premium")) {
+      if (td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
         for (auto &reaction_type : active_reaction_types_) {
           if (!td::contains(default_tag_reactions, reaction_type)) {
             active_reactions.reaction_types_.push_back(reaction_type);
@@ -22689,7 +22878,7 @@ ChatReactions MessagesManager::get_message_available_reactions(const Dialog *d,
       }
     }
   }
-  if (disallow_custom_for_non_premium && !td_->option_manager_->get_option_boolean("is_premium")) {
+  if (disallow_custom_for_non_premium && !td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
     active_reactions.allow_all_custom_ = false;
   }
   return active_reactions;
@@ -22977,16 +23166,15 @@ tl_object_ptr<td_api::MessageSendingState> MessagesManager::get_message_sending_
   }
   if (m->is_failed_to_send) {
     auto can_retry = can_resend_message(m);
-    auto error_code = m->send_error_code > 0 ? m->send_error_code : 400;
-    auto need_another_sender =
-        can_retry && error_code == 400 && m->send_error_message == CSlice("SEND_AS_PEER_INVALID");
+    const auto &send_error = get_message_send_error(m);
+    auto error_code = send_error.code > 0 ? send_error.code : 400;
+    auto need_another_sender = can_retry && error_code == 400 && send_error.message == CSlice("SEND_AS_PEER_INVALID");
     auto need_another_reply_quote =
-        can_retry && error_code == 400 && m->send_error_message == CSlice("QUOTE_TEXT_INVALID");
-    auto need_drop_reply =
-        can_retry && error_code == 400 && m->send_error_message == CSlice("REPLY_MESSAGE_ID_INVALID");
+        can_retry && error_code == 400 && send_error.message == CSlice("QUOTE_TEXT_INVALID");
+    auto need_drop_reply = can_retry && error_code == 400 && send_error.message == CSlice("REPLY_MESSAGE_ID_INVALID");
     return td_api::make_object<td_api::messageSendingStateFailed>(
-        td_api::make_object<td_api::error>(error_code, m->send_error_message), can_retry, need_another_sender,
-        need_another_reply_quote, need_drop_reply, max(m->try_resend_at - Time::now(), 0.0));
+        td_api::make_object<td_api::error>(error_code, send_error.message), can_retry, need_another_sender,
+        need_another_reply_quote, need_drop_reply, max(send_error.try_resend_at - Time::now(), 0.0));
   }
   return nullptr;
 }
@@ -23671,7 +23859,7 @@ void MessagesManager::cancel_send_message_query(DialogId dialog_id, Message *m)
 
   cancel_upload_message_content_files(m->content.get());
 
-  CHECK(m->edited_content == nullptr);
+  CHECK(m->edited_media == nullptr);
 
   if (!m->send_query_ref.empty()) {
     LOG(INFO) << "Cancel send query for " << m->message_id;
@@ -23838,7 +24026,7 @@ void MessagesManager::get_dialog_send_message_as_dialog_ids(
       };
       std::multimap<int64, Sender> sorted_senders;
 
-      bool is_premium = td_->option_manager_->get_option_boolean("is_premium");
+      bool is_premium = td_->option_manager_->get_option_boolean(CachedOption::IsPremium);
       auto linked_channel_id = td_->chat_manager_->get_channel_linked_channel_id(
           dialog_id.get_channel_id(), "get_dialog_send_message_as_dialog_ids");
       for (auto channel_id : created_public_broadcasts) {
@@ -24077,7 +24265,7 @@ Result<InputMessageContent> MessagesManager::process_input_message_content(
                                copied_message->send_emoji);
   }
 
-  bool is_premium = td_->option_manager_->get_option_boolean("is_premium");
+  bool is_premium = td_->option_manager_->get_option_boolean(CachedOption::IsPremium);
   TRY_RESULT(content, get_input_message_content(dialog_id, std::move(input_message_content), td_, is_premium));
   TRY_STATUS(can_send_message_content(dialog_id, content.content.get(), false, check_permissions, td_));
   return std::move(content);
@@ -24316,7 +24504,7 @@ void MessagesManager::do_send_message(DialogId dialog_id, const Message *m, int3
     request.results.push_back(Status::OK());
   }
 
-  auto content = is_edit ? m->edited_content.get() : m->content.get();
+  auto content = is_edit ? m->edited_media->content.get() : m->content.get();
   CHECK(content != nullptr);
   auto content_type = content->get_type();
   if (content_type == MessageContentType::Text) {
@@ -24435,8 +24623,9 @@ void MessagesManager::on_message_media_uploaded(DialogId dialog_id, const Messag
     CHECK(file_ids.size() == 1u);
     auto file_id = file_ids[0];
     auto thumbnail_file_id = thumbnail_file_ids.empty() ? FileId() : thumbnail_file_ids[0];
-    const FormattedText *caption = get_message_content_caption(m->edited_content.get());
-    auto input_reply_markup = get_input_reply_markup(td_->user_manager_.get(), m->edited_reply_markup);
+    CHECK(m->edited_media != nullptr);
+    const FormattedText *caption = get_message_content_caption(m->edited_media->content.get());
+    auto input_reply_markup = get_input_reply_markup(td_->user_manager_.get(), m->edited_media->reply_markup);
     bool was_uploaded = FileManager::extract_was_uploaded(input_media);
     bool was_thumbnail_uploaded = FileManager::extract_was_thumbnail_uploaded(input_media);
 
@@ -24444,7 +24633,7 @@ void MessagesManager::on_message_media_uploaded(DialogId dialog_id, const Messag
     auto schedule_date = get_message_schedule_date(m);
     auto promise = PromiseCreator::lambda(
         [actor_id = actor_id(this), dialog_id, message_id, file_id, thumbnail_file_id, schedule_date,
-         generation = m->edit_generation, was_uploaded, was_thumbnail_uploaded,
+         generation = m->edited_media->generation, was_uploaded, was_thumbnail_uploaded,
          file_reference = FileManager::extract_file_reference(input_media)](Result<int32> result) mutable {
           send_closure(actor_id, &MessagesManager::on_message_media_edited, dialog_id, message_id, file_id,
                        thumbnail_file_id, was_uploaded, was_thumbnail_uploaded, std::move(file_reference),
@@ -24453,7 +24642,7 @@ void MessagesManager::on_message_media_uploaded(DialogId dialog_id, const Messag
     td_->create_handler<EditMessageQuery>(std::move(promise))
         ->send(1 << 11, dialog_id, message_id, caption == nullptr ? "" : caption->text,
                get_input_message_entities(td_->user_manager_.get(), caption, "edit_message_media"),
-               std::move(input_media), m->edited_invert_media, std::move(input_reply_markup), schedule_date);
+               std::move(input_media), m->edited_media->invert_media, std::move(input_reply_markup), schedule_date);
     return;
   }
 
@@ -25518,10 +25707,16 @@ Status MessagesManager::can_pin_message(DialogId dialog_id, const Message *m) co
   return Status::OK();
 }
 
+const MessagesManager::MessageSendError &MessagesManager::get_message_send_error(const Message *m) {
+  static const MessageSendError empty_send_error;
+  return m->send_error == nullptr ? empty_send_error : *m->send_error;
+}
+
 bool MessagesManager::can_resend_message(const Message *m) const {
-  if (m->send_error_code != 429 && m->send_error_message != "Message is too old to be re-sent automatically" &&
-      m->send_error_message != "SCHEDULE_TOO_MUCH" && m->send_error_message != "SEND_AS_PEER_INVALID" &&
-      m->send_error_message != "QUOTE_TEXT_INVALID" && m->send_error_message != "REPLY_MESSAGE_ID_INVALID") {
+  const auto &send_error = get_message_send_error(m);
+  if (send_error.code != 429 && send_error.message != "Message is too old to be re-sent automatically" &&
+      send_error.message != "SCHEDULE_TOO_MUCH" && send_error.message != "SEND_AS_PEER_INVALID" &&
+      send_error.message != "QUOTE_TEXT_INVALID" && send_error.message != "REPLY_MESSAGE_ID_INVALID") {
     return false;
   }
   if (m->is_bot_start_message) {
@@ -25710,17 +25905,13 @@ void MessagesManager::edit_message_live_location(MessageFullId message_full_id,
 }
 
 void MessagesManager::cancel_edit_message_media(DialogId dialog_id, Message *m, Slice error_message) {
-  if (m->edited_content == nullptr) {
+  if (m->edited_media == nullptr) {
     return;
   }
 
-  cancel_upload_message_content_files(m->edited_content.get());
-
-  m->edited_content = nullptr;
-  m->edited_invert_media = false;
-  m->edited_reply_markup = nullptr;
-  m->edit_generation = 0;
-  m->edit_promise.set_error(Status::Error(400, error_message));
+  auto edited_media = std::move(m->edited_media);
+  cancel_upload_message_content_files(edited_media->content.get());
+  edited_media->promise.set_error(Status::Error(400, error_message));
 }
 
 void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId message_id, FileId file_id,
@@ -25739,7 +25930,7 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
   Dialog *d = get_dialog(dialog_id);
   CHECK(d != nullptr);
   auto m = get_message(d, message_id);
-  if (m == nullptr || m->edit_generation != generation) {
+  if (m == nullptr || m->edited_media == nullptr || m->edited_media->generation != generation) {
     // message is already deleted or was edited again
     if (was_uploaded) {
       cancel_upload_file(file_id, "on_message_media_edited");
@@ -25747,7 +25938,7 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
     return;
   }
 
-  CHECK(m->edited_content != nullptr);
+  CHECK(m->edited_media->content != nullptr);
   if (result.is_ok()) {
     // message content has already been replaced from updateEdit{Channel,}Message
     // need only merge files from edited_content with their uploaded counterparts
@@ -25756,13 +25947,14 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
     auto pts = result.ok();
     LOG(INFO) << "Successfully edited " << message_id << " in " << dialog_id << " with PTS = " << pts
               << " and last edit PTS = " << m->last_edit_pts;
-    std::swap(m->content, m->edited_content);
-    bool need_send_update_message_content = m->edited_content->get_type() == MessageContentType::Photo &&
+    auto &edited_content = m->edited_media->content;
+    std::swap(m->content, edited_content);
+    bool need_send_update_message_content = edited_content->get_type() == MessageContentType::Photo &&
                                             m->content->get_type() == MessageContentType::Photo;
     bool need_merge_files = pts != 0 && pts == m->last_edit_pts;
     bool is_content_changed = false;
     bool need_update =
-        update_message_content(dialog_id, m, std::move(m->edited_content), need_merge_files, true, is_content_changed);
+        update_message_content(dialog_id, m, std::move(edited_content), need_merge_files, true, is_content_changed);
     if (need_send_update_message_content) {
       if (need_update) {
         send_update_message_content(d, m, true, "on_message_media_edited");
@@ -25798,7 +25990,7 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
       }
     }
 
-    cancel_upload_message_content_files(m->edited_content.get());
+    cancel_upload_message_content_files(m->edited_media->content.get());
 
     if (dialog_id.get_type() != DialogType::SecretChat) {
       get_message_from_server({dialog_id, m->message_id}, Auto(), "on_message_media_edited");
@@ -25811,14 +26003,11 @@ void MessagesManager::on_message_media_edited(DialogId dialog_id, MessageId mess
   if (m->edited_schedule_date == schedule_date) {
     m->edited_schedule_date = 0;
   }
-  m->edited_content = nullptr;
-  m->edited_invert_media = false;
-  m->edited_reply_markup = nullptr;
-  m->edit_generation = 0;
+  auto edited_media = std::move(m->edited_media);
   if (result.is_ok()) {
-    m->edit_promise.set_value(Unit());
+    edited_media->promise.set_value(Unit());
   } else {
-    m->edit_promise.set_error(result.move_as_error());
+    edited_media->promise.set_error(result.move_as_error());
   }
 }
 
@@ -25885,13 +26074,14 @@ void MessagesManager::edit_message_media(MessageFullId message_full_id,
 
   cancel_edit_message_media(dialog_id, m, "Canceled by new editMessageMedia request");
 
-  m->edited_content =
+  m->edited_media = make_unique<EditedMessageMedia>();
+  m->edited_media->content =
       dup_message_content(td_, dialog_id, content.content.get(), MessageContentDupType::Send, MessageCopyOptions());
-  CHECK(m->edited_content != nullptr);
-  m->edited_invert_media = content.invert_media;
-  m->edited_reply_markup = std::move(new_reply_markup);
-  m->edit_generation = ++current_message_edit_generation_;
-  m->edit_promise = std::move(promise);
+  CHECK(m->edited_media->content != nullptr);
+  m->edited_media->invert_media = content.invert_media;
+  m->edited_media->reply_markup = std::move(new_reply_markup);
+  m->edited_media->generation = ++current_message_edit_generation_;
+  m->edited_media->promise = std::move(promise);
 
   do_send_message(dialog_id, m);
 }
@@ -27190,7 +27380,7 @@ Result<vector<MessageId>> MessagesManager::resend_messages(DialogId dialog_id, v
     if (!can_resend_message(m)) {
       return Status::Error(400, "Message can't be re-sent");
     }
-    if (m->try_resend_at > Time::now()) {
+    if (get_message_send_error(m).try_resend_at > Time::now()) {
       return Status::Error(400, "Message can't be re-sent yet");
     }
     if (last_message_id != MessageId()) {
@@ -27252,12 +27442,10 @@ Result<vector<MessageId>> MessagesManager::resend_messages(DialogId dialog_id, v
     CHECK(message != nullptr);
     send_update_delete_messages(dialog_id, {message->message_id.get()}, true);
 
-    auto need_another_sender =
-        message->send_error_code == 400 && message->send_error_message == CSlice("SEND_AS_PEER_INVALID");
-    auto need_another_reply_quote =
-        message->send_error_code == 400 && message->send_error_message == CSlice("QUOTE_TEXT_INVALID");
-    auto need_drop_reply =
-        message->send_error_code == 400 && message->send_error_message == CSlice("REPLY_MESSAGE_ID_INVALID");
+    const auto &send_error = get_message_send_error(message.get());
+    auto need_another_sender = send_error.code == 400 && send_error.message == CSlice("SEND_AS_PEER_INVALID");
+    auto need_another_reply_quote = send_error.code == 400 && send_error.message == CSlice("QUOTE_TEXT_INVALID");
+    auto need_drop_reply = send_error.code == 400 && send_error.message == CSlice("REPLY_MESSAGE_ID_INVALID");
     if (need_another_reply_quote && message_ids.size() == 1 && quote != nullptr) {
       CHECK(message->input_reply_to.is_valid());
       CHECK(message->input_reply_to.has_quote());  // checked in on_send_message_fail
@@ -30132,12 +30320,12 @@ void MessagesManager::fail_send_message(MessageFullId message_full_id, int32 err
     message->view_count = 0;
   }
   message->is_failed_to_send = true;
-  message->send_error_code = error_code;
-  message->send_error_message = error_message;
-  message->try_resend_at = 0.0;
+  message->send_error = make_unique<MessageSendError>();
+  message->send_error->code = error_code;
+  message->send_error->message = error_message;
   auto retry_after = Global::get_retry_after(error_code, error_message);
   if (retry_after > 0) {
-    message->try_resend_at = Time::now() + retry_after;
+    message->send_error->try_resend_at = Time::now() + retry_after;
   }
   update_failed_to_send_message_content(td_, message->content);
 
@@ -30183,8 +30371,8 @@ void MessagesManager::fail_edit_message_media(MessageFullId message_full_id, Sta
     // message has already been deleted by the user or sent to inaccessible channel
     return;
   }
-  CHECK(m->edited_content != nullptr);
-  m->edit_promise.set_error(std::move(error));
+  CHECK(m->edited_media != nullptr);
+  m->edited_media->promise.set_error(std::move(error));
   cancel_edit_message_media(dialog_id, m, "Failed to edit message. MUST BE IGNORED");
 }
 
@@ -30550,7 +30738,7 @@ void MessagesManager::set_dialog_is_translatable(Dialog *d, bool is_translatable
 
   LOG(INFO) << "Set " << d->dialog_id << " is translatable to " << is_translatable;
   LOG_CHECK(d->is_update_new_chat_sent) << "Wrong " << d->dialog_id << " in set_dialog_is_translatable";
-  bool is_premium = td_->option_manager_->get_option_boolean("is_premium");
+  bool is_premium = td_->option_manager_->get_option_boolean(CachedOption::IsPremium);
   if (is_premium) {
     send_closure(G()->td(), &Td::send_update,
                  td_api::make_object<td_api::updateChatIsTranslatable>(
@@ -32470,18 +32658,28 @@ MessagesManager::Message *MessagesManager::on_get_message_from_database(Dialog *
     return nullptr;
   }
 
-  auto message = parse_message(d, expected_message_id, value, is_scheduled);
-  if (message == nullptr) {
-    return nullptr;
+  CHECK(d != nullptr);
+  // data in the database is always outdated, so there is no need to parse it if the message is already in memory
+  Message *old_message = nullptr;
+  if (!is_scheduled && expected_message_id.is_valid()) {
+    old_message = get_message(d, expected_message_id);
+  }
+  unique_ptr<Message> message;
+  if (old_message == nullptr) {
+    message = parse_message(d, expected_message_id, value, is_scheduled);
+    if (message == nullptr) {
+      return nullptr;
+    }
   }
 
-  CHECK(d != nullptr);
   auto dialog_id = d->dialog_id;
   if (!td_->dialog_manager_->have_input_peer(dialog_id, true, AccessRights::Read)) {
     return nullptr;
   }
 
-  auto old_message = get_message(d, message->message_id);
+  if (old_message == nullptr) {
+    old_message = get_message(d, message->message_id);
+  }
   if (old_message != nullptr) {
     // data in the database is always outdated, so return a message from the memory
     if (dialog_id.get_type() == DialogType::SecretChat) {
@@ -32531,6 +32729,19 @@ vector<MessageId> MessagesManager::on_get_messages_from_database(Dialog *d, vect
   auto next_message_id = MessageId::max();
   Dependencies dependencies;
   for (auto &message_slice : messages) {
+    if (message_slice.message_id.is_valid() && message_slice.message_id < next_message_id &&
+        message_slice.message_id >= first_message_id && get_message(d, message_slice.message_id) != nullptr) {
+      // the message in memory is newer than the message in the database, so skip parsing of the latter
+      next_message_id = message_slice.message_id;
+      result.push_back(message_slice.message_id);
+      continue;
+    }
+    if (message_slice.message_id.is_valid() && message_slice.message_id < first_message_id &&
+        message_slice.message_id < next_message_id) {
+      // the message and all subsequent messages will be ignored, so there is no need to parse them
+      break;
+    }
+
     auto message = parse_message(d, message_slice.message_id, message_slice.data, false);
     if (message == nullptr) {
       have_error = true;
@@ -33324,6 +33535,8 @@ MessagesManager::Message *MessagesManager::add_message_to_dialog(Dialog *d, uniq
   d->messages.set(message_id, std::move(message));
 
   d->message_lru_list.put_back(result_message);
+  loaded_message_count_++;
+  on_loaded_message_count_changed();
 
   switch (dialog_type) {
     case DialogType::User:
@@ -35704,12 +35917,18 @@ void MessagesManager::update_dialog_lists(
     }
   }
 
+  // the chat properties used by chat folders are the same for all the lists, so they are computed only once
+  DialogFilterDialogInfo dialog_info;
+  if (d->order != DEFAULT_ORDER) {
+    dialog_info = get_dialog_info_for_dialog_filter(d);
+  }
+
   for (auto &dialog_list : dialog_lists_) {
     auto dialog_list_id = dialog_list.first;
     auto &list = dialog_list.second;
 
     const DialogPositionInList &old_position = old_positions[dialog_list_id];
-    const DialogPositionInList new_position = get_dialog_position_in_list(&list, d, true);
+    const DialogPositionInList new_position = get_dialog_position_in_list(&list, d, true, &dialog_info);
 
     // sponsored chat is never "in list"
     bool was_in_list = old_position.order != DEFAULT_ORDER && old_position.private_order != 0;
@@ -36171,7 +36390,8 @@ bool MessagesManager::is_dialog_in_dialog_list(DialogId dialog_id) const {
   return d != nullptr && d->order != DEFAULT_ORDER;
 }
 
-bool MessagesManager::need_dialog_in_list(const Dialog *d, const DialogList &list) const {
+bool MessagesManager::need_dialog_in_list(const Dialog *d, const DialogList &list,
+                                          const DialogFilterDialogInfo *dialog_info) const {
   CHECK(!td_->auth_manager_->is_bot());
   if (d->order == DEFAULT_ORDER) {
     return false;
@@ -36180,8 +36400,11 @@ bool MessagesManager::need_dialog_in_list(const Dialog *d, const DialogList &lis
     return d->folder_id == list.dialog_list_id.get_folder_id();
   }
   if (list.dialog_list_id.is_filter()) {
-    return td_->dialog_filter_manager_->need_dialog_in_filter(list.dialog_list_id.get_filter_id(),
-                                                              get_dialog_info_for_dialog_filter(d));
+    auto dialog_filter_id = list.dialog_list_id.get_filter_id();
+    if (dialog_info != nullptr) {
+      return td_->dialog_filter_manager_->need_dialog_in_filter(dialog_filter_id, *dialog_info);
+    }
+    return td_->dialog_filter_manager_->need_dialog_in_filter(dialog_filter_id, get_dialog_info_for_dialog_filter(d));
   }
   UNREACHABLE();
   return false;
@@ -36198,15 +36421,16 @@ bool MessagesManager::need_send_update_chat_position(const DialogPositionInList
   return old_position.is_pinned != new_position.is_pinned || old_position.is_sponsored != new_position.is_sponsored;
 }
 
-MessagesManager::DialogPositionInList MessagesManager::get_dialog_position_in_list(const DialogList *list,
-                                                                                   const Dialog *d, bool actual) const {
+MessagesManager::DialogPositionInList MessagesManager::get_dialog_position_in_list(
+    const DialogList *list, const Dialog *d, bool actual, const DialogFilterDialogInfo *dialog_info) const {
   CHECK(!td_->auth_manager_->is_bot());
   CHECK(list != nullptr);
   CHECK(d != nullptr);
 
   DialogPositionInList position;
   position.order = d->order;
-  if (is_dialog_sponsored(d) || (actual ? need_dialog_in_list(d, *list) : is_dialog_in_list(d, list->dialog_list_id))) {
+  if (is_dialog_sponsored(d) ||
+      (actual ? need_dialog_in_list(d, *list, dialog_info) : is_dialog_in_list(d, list->dialog_list_id))) {
     position.private_order = get_dialog_private_order(list, d);
   }
   if (position.private_order != 0) {
@@ -36545,29 +36769,49 @@ void MessagesManager::do_get_channel_difference(DialogId dialog_id, int32 pts, b
     limit = MIN_CHANNEL_DIFFERENCE;
   }
 
-  pending_get_channel_differences_.push(
+  pending_get_channel_differences_.push_back(
       td::make_unique<PendingGetChannelDifference>(dialog_id, pts, limit, force, std::move(input_channel), source));
   process_pending_get_channel_differences();
 }
 
+std::tuple<bool, int32, int64> MessagesManager::get_channel_difference_priority(DialogId dialog_id) const {
+  const Dialog *d = get_dialog(dialog_id);
+  if (d == nullptr) {
+    return std::make_tuple(false, 0, static_cast<int64>(0));
+  }
+  // differences for opened chats are needed first, then for chats with more unread messages and higher in chat list
+  return std::make_tuple(d->open_count > 0, d->server_unread_count + d->local_unread_count + d->unread_mention_count,
+                         d->order);
+}
+
 void MessagesManager::process_pending_get_channel_differences() {
-  static constexpr int32 MAX_CONCURRENT_GET_CHANNEL_DIFFERENCES = 10;
+  auto max_concurrent_get_channel_differences =
+      narrow_cast<int32>(td_->option_manager_->get_option_integer("channel_difference_concurrency_limit", 10));
 
-  if (pending_get_channel_differences_.empty() ||
-      get_channel_difference_count_ >= MAX_CONCURRENT_GET_CHANNEL_DIFFERENCES) {
-    return;
-  }
+  while (!pending_get_channel_differences_.empty() &&
+         get_channel_difference_count_ < max_concurrent_get_channel_differences) {
+    // the priority is calculated each time, because chats can be opened or read while their difference is pending
+    size_t best_pos = 0;
+    auto best_priority = get_channel_difference_priority(pending_get_channel_differences_[0]->dialog_id_);
+    for (size_t i = 1; i < pending_get_channel_differences_.size(); i++) {
+      auto priority = get_channel_difference_priority(pending_get_channel_differences_[i]->dialog_id_);
+      if (best_priority < priority) {
+        best_pos = i;
+        best_priority = priority;
+      }
+    }
 
-  get_channel_difference_count_++;
+    auto query = std::move(pending_get_channel_differences_[best_pos]);
+    pending_get_channel_differences_.erase(pending_get_channel_differences_.begin() + best_pos);
 
-  auto query = std::move(pending_get_channel_differences_.front());
-  pending_get_channel_differences_.pop();
+    get_channel_difference_count_++;
 
-  LOG(INFO) << "-----BEGIN GET CHANNEL DIFFERENCE----- for " << query->dialog_id_ << " with PTS " << query->pts_
-            << " and limit " << query->limit_ << " from " << query->source_;
+    LOG(INFO) << "-----BEGIN GET CHANNEL DIFFERENCE----- for " << query->dialog_id_ << " with PTS " << query->pts_
+              << " and limit " << query->limit_ << " from " << query->source_;
 
-  td_->create_handler<GetChannelDifferenceQuery>()->send(query->dialog_id_, std::move(query->input_channel_),
-                                                         query->pts_, query->limit_, query->force_);
+    td_->create_handler<GetChannelDifferenceQuery>()->send(query->dialog_id_, std::move(query->input_channel_),
+                                                           query->pts_, query->limit_, query->force_);
+  }
 }
 
 void MessagesManager::process_get_channel_difference_updates(
@@ -38871,6 +39115,11 @@ td_api::object_ptr<td_api::updateUnreadChatCount> MessagesManager::get_update_un
       unread_marked_count, unread_unmuted_marked_count);
 }
 
+void MessagesManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  statistics.add_objects<Dialog>("messages_manager.dialogs", dialogs_.calc_size());
+  statistics.add_objects<Message>("messages_manager.messages", static_cast<size_t>(loaded_message_count_));
+}
+
 void MessagesManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   if (!td_->auth_manager_->is_bot()) {
     if (G()->use_message_database()) {
@@ -38906,13 +39155,39 @@ void MessagesManager::get_current_state(vector<td_api::object_ptr<td_api::Update
 
 void MessagesManager::add_message_file_to_downloads(MessageFullId message_full_id, FileId file_id, int32 priority,
                                                     Promise<td_api::object_ptr<td_api::file>> promise) {
-  auto m = get_message_force(message_full_id, "add_message_file_to_downloads");
+  DownloadManager::FileToAdd file_to_add;
+  TRY_STATUS_PROMISE(promise, get_message_file_to_download(message_full_id, file_id, file_to_add.file_id,
+                                                           file_to_add.file_source_id, file_to_add.search_text));
+  send_closure(td_->download_manager_actor_, &DownloadManager::add_file, file_to_add.file_id,
+               file_to_add.file_source_id, std::move(file_to_add.search_text), static_cast<int8>(priority),
+               std::move(promise));
+}
+
+void MessagesManager::add_message_files_to_downloads(vector<std::pair<MessageFullId, FileId>> message_files,
+                                                     int32 priority, Promise<Unit> &&promise) {
+  vector<DownloadManager::FileToAdd> files_to_add;
+  files_to_add.reserve(message_files.size());
+  for (auto &message_file : message_files) {
+    DownloadManager::FileToAdd file_to_add;
+    TRY_STATUS_PROMISE(promise,
+                       get_message_file_to_download(message_file.first, message_file.second, file_to_add.file_id,
+                                                    file_to_add.file_source_id, file_to_add.search_text));
+    files_to_add.push_back(std::move(file_to_add));
+  }
+  send_closure(td_->download_manager_actor_, &DownloadManager::add_files, std::move(files_to_add),
+               static_cast<int8>(priority), std::move(promise));
+}
+
+Status MessagesManager::get_message_file_to_download(MessageFullId message_full_id, FileId file_id,
+                                                    FileId &main_file_id, FileSourceId &file_source_id,
+                                                    string &search_text) {
+  auto m = get_message_force(message_full_id, "get_message_file_to_download");
   if (m == nullptr) {
-    return promise.set_error(Status::Error(400, "Message not found"));
+    return Status::Error(400, "Message not found");
   }
   auto file_view = td_->file_manager_->get_file_view(file_id);
   if (file_view.empty()) {
-    return promise.set_error(Status::Error(400, "File not found"));
+    return Status::Error(400, "File not found");
   }
   file_id = file_view.get_main_file_id();
   bool is_found = false;
@@ -38924,16 +39199,16 @@ void MessagesManager::add_message_file_to_downloads(MessageFullId message_full_i
     }
   }
   if (!is_found) {
-    return promise.set_error(Status::Error(400, "Message has no specified file"));
+    return Status::Error(400, "Message has no specified file");
   }
   if (m->message_id.is_yet_unsent()) {
-    return promise.set_error(Status::Error(400, "Yet unsent messages can't be added to Downloads"));
+    return Status::Error(400, "Yet unsent messages can't be added to Downloads");
   }
-  auto search_text = get_message_search_text(m);
-  auto file_source_id = get_message_file_source_id(message_full_id, true);
+  main_file_id = file_id;
+  file_source_id = get_message_file_source_id(message_full_id, true);
   CHECK(file_source_id.is_valid());
-  send_closure(td_->download_manager_actor_, &DownloadManager::add_file, file_id, file_source_id,
-               std::move(search_text), static_cast<int8>(priority), std::move(promise));
+  search_text = get_message_search_text(m);
+  return Status::OK();
 }
 
 void MessagesManager::get_message_file_search_text(MessageFullId message_full_id, string unique_file_id,
@@ -80,6 +80,7 @@
 #include "td/actor/SignalSlot.h"
 #include "td/actor/Timeout.h"
 
+#include "td/utils/BlockSortedSet.h"
 #include "td/utils/buffer.h"
 #include "td/utils/ChangesProcessor.h"
 #include "td/utils/common.h"
@@ -100,8 +101,8 @@
 #include <functional>
 #include <map>
 #include <memory>
-#include <queue>
 #include <set>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -118,6 +119,7 @@ class FactCheck;
 struct InputMessageContent;
 class MessageContent;
 class MessageForwardInfo;
+class MemoryStatistics;
 struct MessageReactions;
 struct MessageSearchOffset;
 class MissingInvitees;
@@ -927,6 +929,9 @@ class MessagesManager final : public Actor {
 
   FileSourceId get_message_file_source_id(MessageFullId message_full_id, bool force = false);
 
+  Status get_message_file_to_download(MessageFullId message_full_id, FileId file_id, FileId &main_file_id,
+                                      FileSourceId &file_source_id, string &search_text);
+
   struct MessagePushNotificationInfo {
     NotificationGroupId group_id;
     NotificationGroupType group_type = NotificationGroupType::Calls;
@@ -982,11 +987,16 @@ class MessagesManager final : public Actor {
 
   bool can_set_game_score(MessageFullId message_full_id) const;
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
   void add_message_file_to_downloads(MessageFullId message_full_id, FileId file_id, int32 priority,
                                      Promise<td_api::object_ptr<td_api::file>> promise);
 
+  void add_message_files_to_downloads(vector<std::pair<MessageFullId, FileId>> message_files, int32 priority,
+                                      Promise<Unit> &&promise);
+
   void get_message_file_search_text(MessageFullId message_full_id, string unique_file_id, Promise<string> promise);
 
  private:
@@ -1046,6 +1056,23 @@ class MessagesManager final : public Actor {
   };
 
   // Do not forget to update MessagesManager::update_message and all make_unique<Message> when this class is changed
+  // state of a being edited message media, which is needed only until the edit request is finished
+  struct EditedMessageMedia {
+    unique_ptr<MessageContent> content;
+    bool invert_media = false;
+    unique_ptr<ReplyMarkup> reply_markup;
+    uint64 generation = 0;
+    Promise<Unit> promise;
+  };
+
+  // state of a message, which failed to be sent
+  struct MessageSendError {
+    int32 code = 0;
+    string message;
+    double try_resend_at = 0;
+  };
+
+  // rarely used fields are stored in separately allocated structures to reduce memory usage by loaded messages
   struct Message final : public ListNode {
     MessageId message_id;
     UserId sender_user_id;
@@ -1135,9 +1162,7 @@ class MessagesManager final : public Actor {
 
     int32 legacy_layer = 0;
 
-    int32 send_error_code = 0;
-    string send_error_message;
-    double try_resend_at = 0;
+    unique_ptr<MessageSendError> send_error;  // only for messages failed to send
 
     int32 ttl_period = 0;         // counted from message send date
     MessageSelfDestructType ttl;  // counted from message content view date
@@ -1151,11 +1176,7 @@ class MessagesManager final : public Actor {
     unique_ptr<ReplyMarkup> reply_markup;
 
     int32 edited_schedule_date = 0;
-    bool edited_invert_media = false;
-    unique_ptr<MessageContent> edited_content;
-    unique_ptr<ReplyMarkup> edited_reply_markup;
-    uint64 edit_generation = 0;
-    Promise<Unit> edit_promise;
+    unique_ptr<EditedMessageMedia> edited_media;
 
     int32 last_edit_pts = 0;
 
@@ -1415,7 +1436,7 @@ class MessagesManager final : public Actor {
     // date of the last loaded dialog in the folder
     DialogDate folder_last_dialog_date_{MAX_ORDINARY_DIALOG_ORDER, DialogId()};  // in memory
 
-    std::set<DialogDate> ordered_dialogs_;  // all known dialogs, including with default order
+    BlockSortedSet<DialogDate> ordered_dialogs_;  // all known dialogs, including with default order
 
     // date of last known user/group/channel dialog in the right order
     DialogDate last_server_dialog_date_{MAX_ORDINARY_DIALOG_ORDER, DialogId()};
@@ -1630,8 +1651,10 @@ class MessagesManager final : public Actor {
   static constexpr int32 DIALOG_FLAG_HAS_FOLDER_ID = 1 << 4;
 
   static constexpr int32 MAX_MESSAGE_VIEW_DELAY = 1;  // seconds
+  static constexpr double MESSAGE_INTERACTION_INFO_UPDATE_DELAY = 0.2;  // seconds
   static constexpr int32 MIN_SAVE_DRAFT_DELAY = 1;    // seconds
   static constexpr int32 MIN_READ_HISTORY_DELAY = 3;  // seconds
+  static constexpr int32 MAX_READ_HISTORY_QUERIES_PER_SECOND = 20;
   static constexpr int32 MAX_SAVE_DIALOG_DELAY = 0;   // seconds
 
   static constexpr int32 DEFAULT_LOADED_EXPIRED_MESSAGES = 50;
@@ -1744,6 +1767,8 @@ class MessagesManager final : public Actor {
 
   Status can_send_message(DialogId dialog_id) const TD_WARN_UNUSED_RESULT;
 
+  static const MessageSendError &get_message_send_error(const Message *m);
+
   bool can_resend_message(const Message *m) const;
 
   bool can_edit_message(DialogId dialog_id, const Message *m, bool is_editing, bool only_reply_markup = false) const;
@@ -1985,6 +2010,10 @@ class MessagesManager final : public Actor {
 
   void unload_dialog(DialogId dialog_id, int32 delay);
 
+  void on_loaded_message_count_changed();
+
+  void unload_least_recently_used_messages();
+
   void clear_dialog_message_list(Dialog *d, bool remove_from_dialog_list, int32 last_message_date);
 
   void delete_all_dialog_messages(Dialog *d, bool remove_from_dialog_list, bool is_permanently_deleted);
@@ -2114,6 +2143,8 @@ class MessagesManager final : public Actor {
 
   void do_read_history_on_server(DialogId dialog_id);
 
+  double get_read_history_query_delay();
+
   void read_history_on_server_impl(Dialog *d, MessageId max_message_id);
 
   void read_message_thread_history_on_server_impl(Dialog *d, MessageId top_thread_message_id, MessageId max_message_id);
@@ -2132,6 +2163,8 @@ class MessagesManager final : public Actor {
 
   void on_send_update_chat_read_inbox_timeout(DialogId dialog_id);
 
+  void on_send_update_message_interaction_info_timeout(DialogId dialog_id);
+
   void on_send_paid_reactions_timeout(int64 task_id);
 
   bool delete_newer_server_messages_at_the_end(Dialog *d, MessageId max_message_id);
@@ -2157,6 +2190,10 @@ class MessagesManager final : public Actor {
 
   void on_get_history_finished(const PendingGetHistoryQuery &query, Result<Unit> &&result);
 
+  void get_history_replied_messages(Dialog *d, const vector<MessageId> &message_ids);
+
+  void warm_up_history_media_dcs(const Dialog *d, const vector<MessageId> &message_ids);
+
   void load_messages(DialogId dialog_id, MessageId from_message_id, int32 offset, int32 limit, int left_tries,
                      bool only_local, Promise<Unit> &&promise);
 
@@ -2733,12 +2770,14 @@ class MessagesManager final : public Actor {
 
   DialogFilterDialogInfo get_dialog_info_for_dialog_filter(const Dialog *d) const;
 
-  bool need_dialog_in_list(const Dialog *d, const DialogList &list) const;
+  bool need_dialog_in_list(const Dialog *d, const DialogList &list,
+                           const DialogFilterDialogInfo *dialog_info = nullptr) const;
 
   static bool need_send_update_chat_position(const DialogPositionInList &old_position,
                                              const DialogPositionInList &new_position);
 
-  DialogPositionInList get_dialog_position_in_list(const DialogList *list, const Dialog *d, bool actual = false) const;
+  DialogPositionInList get_dialog_position_in_list(const DialogList *list, const Dialog *d, bool actual = false,
+                                                   const DialogFilterDialogInfo *dialog_info = nullptr) const;
 
   std::unordered_map<DialogListId, DialogPositionInList, DialogListIdHash> get_dialog_positions(const Dialog *d) const;
 
@@ -3031,6 +3070,8 @@ class MessagesManager final : public Actor {
 
   void process_pending_get_channel_differences();
 
+  std::tuple<bool, int32, int64> get_channel_difference_priority(DialogId dialog_id) const;
+
   void process_get_channel_difference_updates(DialogId dialog_id, int32 new_pts,
                                               vector<tl_object_ptr<telegram_api::Message>> &&new_messages,
                                               vector<tl_object_ptr<telegram_api::Update>> &&other_updates);
@@ -3066,6 +3107,9 @@ class MessagesManager final : public Actor {
 
   static void on_send_update_chat_read_inbox_timeout_callback(void *messages_manager_ptr, int64 dialog_id_int);
 
+  static void on_send_update_message_interaction_info_timeout_callback(void *messages_manager_ptr,
+                                                                       int64 dialog_id_int);
+
   static void on_send_paid_reactions_timeout_callback(void *messages_manager_ptr, int64 task_id);
 
   static void on_live_location_expire_timeout_callback(void *messages_manager_ptr);
@@ -3313,6 +3357,9 @@ class MessagesManager final : public Actor {
   bool running_get_difference_ = false;  // true after before_get_difference and false after after_get_difference
 
   WaitFreeHashMap<DialogId, unique_ptr<Dialog>, DialogIdHash> dialogs_;
+
+  int64 loaded_message_count_ = 0;
+  bool is_loaded_message_count_check_scheduled_ = false;
   int64 added_message_count_ = 0;
 
   FlatHashSet<DialogId, DialogIdHash> loaded_dialogs_;  // dialogs loaded from database, but not added to dialogs_
@@ -3320,6 +3367,10 @@ class MessagesManager final : public Actor {
 
   FlatHashSet<DialogId, DialogIdHash> postponed_chat_read_inbox_updates_;
 
+  // updateMessageInteractionInfo for changes received from the server are coalesced per message
+  FlatHashMap<DialogId, FlatHashSet<MessageId, MessageIdHash>, DialogIdHash>
+      postponed_message_interaction_info_updates_;
+
   FlatHashMap<string, vector<Promise<Unit>>> search_public_dialogs_queries_;
   FlatHashMap<string, vector<DialogId>> found_public_dialogs_;     // TODO time bound cache
   FlatHashMap<string, vector<DialogId>> found_on_server_dialogs_;  // TODO time bound cache
@@ -3379,7 +3430,7 @@ class MessagesManager final : public Actor {
         , source_(source) {
     }
   };
-  std::queue<unique_ptr<PendingGetChannelDifference>> pending_get_channel_differences_;
+  vector<unique_ptr<PendingGetChannelDifference>> pending_get_channel_differences_;
   int32 get_channel_difference_count_ = 0;
 
   FlatHashMap<DialogId, string, DialogIdHash> active_get_channel_differences_;
@@ -3403,6 +3454,7 @@ class MessagesManager final : public Actor {
   MultiTimeout preload_folder_dialog_list_timeout_{"PreloadFolderDialogListTimeout"};
   MultiTimeout update_viewed_messages_timeout_{"UpdateViewedMessagesTimeout"};
   MultiTimeout send_update_chat_read_inbox_timeout_{"SendUpdateChatReadInboxTimeout"};
+  MultiTimeout send_update_message_interaction_info_timeout_{"SendUpdateMessageInteractionInfoTimeout"};
   MultiTimeout send_paid_reactions_timeout_{"SendPaidReactionsTimeout"};
 
   Timeout live_location_expire_timeout_;
@@ -3533,6 +3585,8 @@ class MessagesManager final : public Actor {
       read_history_log_event_ids_;
 
   FlatHashMap<DialogId, std::unordered_set<MessageId, MessageIdHash>, DialogIdHash> updated_read_history_message_ids_;
+  double read_history_query_window_end_time_ = 0.0;
+  int32 read_history_query_count_ = 0;  // number of chats in which history was read during the current window
 
   struct PendingReaction {
     int32 query_count = 0;
@@ -62,6 +62,7 @@
 #include "td/utils/utf8.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 #include <limits>
 
@@ -233,6 +234,7 @@ void NotificationManager::init() {
   on_online_cloud_timeout_changed();
   on_notification_cloud_delay_changed();
   on_notification_default_delay_changed();
+  on_notification_flush_interval_changed();
 
   last_loaded_notification_group_key_.last_notification_date = std::numeric_limits<int32>::max();
   if (max_notification_group_count_ != 0) {
@@ -937,6 +939,11 @@ void NotificationManager::add_notification(NotificationGroupId group_id, Notific
   auto delay_ms = get_notification_delay_ms(dialog_id, notification, min_delay_ms);
   VLOG(notifications) << "Delay " << notification_id << " for " << delay_ms << " milliseconds";
   auto flush_time = delay_ms * 0.001 + Time::now();
+  if (notification_flush_interval_ms_ > 0) {
+    // align flush times of all notification groups to flush them together
+    auto flush_interval = notification_flush_interval_ms_ * 0.001;
+    flush_time = std::ceil(flush_time / flush_interval) * flush_interval;
+  }
 
   if (group.pending_notifications_flush_time == 0 || flush_time < group.pending_notifications_flush_time) {
     group.pending_notifications_flush_time = flush_time;
@@ -2646,6 +2653,16 @@ void NotificationManager::on_notification_default_delay_changed() {
   VLOG(notifications) << "Set notification_default_delay_ms to " << notification_default_delay_ms_;
 }
 
+void NotificationManager::on_notification_flush_interval_changed() {
+  if (is_disabled()) {
+    return;
+  }
+
+  notification_flush_interval_ms_ =
+      narrow_cast<int32>(td_->option_manager_->get_option_integer("notification_flush_interval_ms"));
+  VLOG(notifications) << "Set notification_flush_interval_ms to " << notification_flush_interval_ms_;
+}
+
 void NotificationManager::on_disable_contact_registered_notifications_changed() {
   if (is_disabled()) {
     return;
@@ -2795,7 +2812,7 @@ void NotificationManager::process_push_notification(string payload, Promise<Unit
     send_closure(G()->state_manager(), &StateManager::on_online, false);
   }
 
-  if (receiver_id == 0 || receiver_id == td_->option_manager_->get_option_integer("my_id")) {
+  if (receiver_id == 0 || receiver_id == td_->option_manager_->get_option_integer(CachedOption::MyId)) {
     auto status = process_push_notification_payload(payload, was_encrypted, promise);
     if (status.is_error()) {
       if (status.code() == 406 || status.code() == 200) {
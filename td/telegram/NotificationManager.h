@@ -111,6 +111,8 @@ class NotificationManager final : public Actor {
 
   void on_notification_default_delay_changed();
 
+  void on_notification_flush_interval_changed();
+
   void on_disable_contact_registered_notifications_changed();
 
   void process_push_notification(string payload, Promise<Unit> &&user_promise);
@@ -368,6 +370,7 @@ class NotificationManager final : public Actor {
   int32 online_cloud_timeout_ms_ = DEFAULT_ONLINE_CLOUD_TIMEOUT_MS;
   int32 notification_cloud_delay_ms_ = DEFAULT_ONLINE_CLOUD_DELAY_MS;
   int32 notification_default_delay_ms_ = DEFAULT_DEFAULT_DELAY_MS;
+  int32 notification_flush_interval_ms_ = 0;
 
   int32 delayed_notification_update_count_ = 0;
   int32 unreceived_notification_update_count_ = 0;
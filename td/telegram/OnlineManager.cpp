@@ -141,7 +141,7 @@ void OnlineManager::set_is_bot_online(bool is_bot_online) {
   ping_server_timeout_.set_callback_data(static_cast<void *>(this));
   ping_server_timeout_.set_timeout_in(PING_SERVER_TIMEOUT + Random::fast(0, PING_SERVER_TIMEOUT / 5));
 
-  if (td_->option_manager_->get_option_integer("session_count") > 1) {
+  if (td_->option_manager_->get_option_integer(CachedOption::SessionCount) > 1) {
     is_bot_online = false;
   }
 
@@ -24,6 +24,7 @@
 #include "td/telegram/OnlineManager.h"
 #include "td/telegram/PeopleNearbyManager.h"
 #include "td/telegram/ReactionType.h"
+#include "td/telegram/SequenceDispatcher.h"
 #include "td/telegram/StateManager.h"
 #include "td/telegram/StickersManager.h"
 #include "td/telegram/StorageManager.h"
@@ -161,6 +162,10 @@ OptionManager::OptionManager(Td *td)
   set_default_integer_option("usd_to_thousand_star_rate", 1410);
   set_default_integer_option("thousand_star_to_usd_rate", 1300);
 
+  for (auto name : {"is_premium", "my_id", "prefer_ipv6", "session_count", "use_quick_ack"}) {
+    update_cached_option(Slice(name));
+  }
+
   if (options.isset("my_phone_number") || !options.isset("my_id")) {
     update_premium_options();
   }
@@ -260,6 +265,9 @@ void OptionManager::set_option_string(Slice name, Slice value) {
 }
 
 bool OptionManager::have_option(Slice name) const {
+  if (is_options_owner_thread()) {
+    return options_->inner().isset(name.str());
+  }
   return options_->isset(name.str());
 }
 
@@ -316,6 +324,7 @@ void OptionManager::set_option(Slice name, Slice value) {
     }
     option_pmc_->set(name.str(), value.str());
   }
+  update_cached_option(name);
 
   if (!G()->close_flag() && is_td_inited_) {
     on_option_updated(name);
@@ -333,9 +342,51 @@ void OptionManager::set_option(Slice name, Slice value) {
 }
 
 string OptionManager::get_option(Slice name) const {
+  if (is_options_owner_thread()) {
+    // the options can be changed only by the current thread, so they can be read without locking
+    return options_->inner().get(name.str());
+  }
   return options_->get(name.str());
 }
 
+bool OptionManager::is_options_owner_thread() const {
+  auto *scheduler = Scheduler::instance();
+  return scheduler != nullptr && scheduler->sched_id() == current_scheduler_id_;
+}
+
+void OptionManager::update_cached_option(Slice name) {
+  auto option = [&] {
+    if (name == "is_premium") {
+      return CachedOption::IsPremium;
+    }
+    if (name == "my_id") {
+      return CachedOption::MyId;
+    }
+    if (name == "prefer_ipv6") {
+      return CachedOption::PreferIpv6;
+    }
+    if (name == "session_count") {
+      return CachedOption::SessionCount;
+    }
+    if (name == "use_quick_ack") {
+      return CachedOption::UseQuickAck;
+    }
+    return CachedOption::Size;
+  }();
+  if (option == CachedOption::Size) {
+    return;
+  }
+
+  auto value = get_option(name);
+  int64 cached_value = 0;
+  if (value == "Btrue") {
+    cached_value = 1;
+  } else if (!value.empty() && value[0] == 'I') {
+    cached_value = to_integer<int64>(Slice(value).substr(1));
+  }
+  cached_option_values_[static_cast<size_t>(option)].store(cached_value, std::memory_order_relaxed);
+}
+
 td_api::object_ptr<td_api::OptionValue> OptionManager::get_unix_time_option_value_object() {
   return td_api::make_object<td_api::optionValueInteger>(G()->unix_time());
 }
@@ -605,6 +656,9 @@ void OptionManager::on_option_updated(Slice name) {
       if (name == "notification_default_delay_ms") {
         send_closure(td_->notification_manager_actor_, &NotificationManager::on_notification_default_delay_changed);
       }
+      if (name == "notification_flush_interval_ms") {
+        send_closure(td_->notification_manager_actor_, &NotificationManager::on_notification_flush_interval_changed);
+      }
       if (name == "notification_group_count_max") {
         send_closure(td_->notification_manager_actor_, &NotificationManager::on_notification_group_count_max_changed,
                      true);
@@ -630,6 +684,9 @@ void OptionManager::on_option_updated(Slice name) {
       if (name == "saved_animations_limit") {
         td_->animations_manager_->on_update_saved_animations_limit();
       }
+      if (name == "sequence_dispatcher_window") {
+        G()->net_query_dispatcher().update_sequence_dispatcher_window();
+      }
       if (name == "session_count") {
         G()->net_query_dispatcher().update_session_count();
       }
@@ -814,6 +871,12 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       */
       break;
     case 'c':
+      if (set_integer_option("channel_difference_concurrency_limit", 1, 100)) {
+        return;
+      }
+      if (set_integer_option("chat_update_coalescing_delay", 0, 1000)) {
+        return;
+      }
       if (!is_bot && set_string_option("connection_parameters", [](Slice value) {
             string value_copy = value.str();
             auto r_json_value = get_json_value(value_copy);
@@ -907,11 +970,20 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       }
       break;
     case 'm':
+      if (set_integer_option("max_loaded_message_count", 0, 1000000000)) {
+        return;
+      }
       if (set_integer_option("message_unload_delay", 60, 86400)) {
         return;
       }
       break;
     case 'n':
+      if (set_integer_option("network_query_compression_level", 0, 9)) {
+        return;
+      }
+      if (!is_bot && set_integer_option("notification_flush_interval_ms", 0, 60000)) {
+        return;
+      }
       if (!is_bot &&
           set_integer_option("notification_group_count_max", NotificationManager::MIN_NOTIFICATION_GROUP_COUNT_MAX,
                              NotificationManager::MAX_NOTIFICATION_GROUP_COUNT_MAX)) {
@@ -943,6 +1015,12 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
         send_closure(td_->state_manager_, &StateManager::on_network_updated);
         return;
       }
+      if (!is_bot && set_boolean_option("prefetch_inline_query_results")) {
+        return;
+      }
+      if (!is_bot && set_boolean_option("preload_story_thumbnails")) {
+        return;
+      }
       if (set_boolean_option("process_pinned_messages_as_mentions")) {
         return;
       }
@@ -954,6 +1032,15 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       }
       break;
     case 's':
+      if (set_integer_option("sequence_dispatcher_window", 1, MultiSequenceDispatcher::MAX_WINDOW)) {
+        return;
+      }
+      if (set_string_option("shared_file_store_directory", [](Slice value) { return true; })) {
+        return;
+      }
+      if (set_integer_option("storage_max_deleted_files_per_second")) {
+        return;
+      }
       if (set_integer_option("storage_max_files_size")) {
         return;
       }
@@ -982,9 +1069,18 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       if (set_boolean_option("use_quick_ack")) {
         return;
       }
+      if (!is_bot && set_boolean_option("use_shared_inline_query_cache")) {
+        return;
+      }
+      if (set_boolean_option("use_shared_sticker_set_cache")) {
+        return;
+      }
       if (set_boolean_option("use_storage_optimizer")) {
         return;
       }
+      if (!is_bot && set_integer_option("user_status_update_delay", 0, 60)) {
+        return;
+      }
       if (set_integer_option("utc_time_offset", -12 * 60 * 60, 14 * 60 * 60)) {
         return;
       }
@@ -6,12 +6,14 @@
 //
 #pragma once
 
+#include "td/telegram/CachedOption.h"
 #include "td/telegram/td_api.h"
 
 #include "td/utils/common.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <utility>
@@ -51,6 +53,14 @@ class OptionManager {
 
   string get_option_string(Slice name, string default_value = "") const;
 
+  bool get_option_boolean(CachedOption option) const {
+    return get_cached_option_value(option) != 0;
+  }
+
+  int64 get_option_integer(CachedOption option) const {
+    return get_cached_option_value(option);
+  }
+
   void on_update_server_time_difference();
 
   void get_option(const string &name, Promise<td_api::object_ptr<td_api::OptionValue>> &&promise);
@@ -72,6 +82,14 @@ class OptionManager {
 
   string get_option(Slice name) const;
 
+  bool is_options_owner_thread() const;
+
+  int64 get_cached_option_value(CachedOption option) const {
+    return cached_option_values_[static_cast<size_t>(option)].load(std::memory_order_relaxed);
+  }
+
+  void update_cached_option(Slice name);
+
   static bool is_internal_option(Slice name);
 
   td_api::object_ptr<td_api::Update> get_internal_option_update(Slice name) const;
@@ -89,7 +107,8 @@ class OptionManager {
   vector<std::pair<string, Promise<td_api::object_ptr<td_api::OptionValue>>>> pending_get_options_;
 
   int32 current_scheduler_id_ = -1;
-  unique_ptr<TsSeqKeyValue> options_;
+  unique_ptr<TsSeqKeyValue> options_;  // modified only from the scheduler current_scheduler_id_
+  std::array<std::atomic<int64>, static_cast<size_t>(CachedOption::Size)> cached_option_values_{};
   std::shared_ptr<KeyValueSyncInterface> option_pmc_;
 
   std::atomic<double> last_sent_server_time_difference_{1e100};
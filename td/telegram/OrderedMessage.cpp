@@ -8,6 +8,8 @@
 
 #include "td/utils/logging.h"
 
+#include <algorithm>
+
 namespace td {
 
 void OrderedMessages::insert(MessageId message_id, bool auto_attach, MessageId old_last_message_id,
@@ -64,6 +66,12 @@ void OrderedMessages::insert(MessageId message_id, bool auto_attach, MessageId o
   CHECK(*left == nullptr);
   CHECK(*right == nullptr);
   *v = std::move(message);
+
+  if (message_ids_.empty() || message_ids_.back() < message_id) {
+    message_ids_.push_back(message_id);
+  } else {
+    message_ids_.insert(std::lower_bound(message_ids_.begin(), message_ids_.end(), message_id), message_id);
+  }
 }
 
 void OrderedMessages::erase(MessageId message_id, bool only_from_memory) {
@@ -112,6 +120,10 @@ void OrderedMessages::erase(MessageId message_id, bool only_from_memory) {
     }
   }
   CHECK(*v == nullptr);
+
+  auto it = std::lower_bound(message_ids_.begin(), message_ids_.end(), message_id);
+  CHECK(it != message_ids_.end() && *it == message_id);
+  message_ids_.erase(it);
 }
 
 void OrderedMessages::attach_message_to_previous(MessageId message_id, const char *source) {
@@ -203,46 +215,14 @@ void OrderedMessages::auto_attach_message(OrderedMessage *message, MessageId las
   LOG(INFO) << "Can't auto-attach " << message_id << " from " << source;
 }
 
-void OrderedMessages::do_find_older_messages(const OrderedMessage *ordered_message, MessageId max_message_id,
-                                             vector<MessageId> &message_ids) {
-  if (ordered_message == nullptr) {
-    return;
-  }
-
-  do_find_older_messages(ordered_message->left_.get(), max_message_id, message_ids);
-
-  if (ordered_message->message_id_ <= max_message_id) {
-    message_ids.push_back(ordered_message->message_id_);
-
-    do_find_older_messages(ordered_message->right_.get(), max_message_id, message_ids);
-  }
-}
-
 vector<MessageId> OrderedMessages::find_older_messages(MessageId max_message_id) const {
-  vector<MessageId> message_ids;
-  do_find_older_messages(messages_.get(), max_message_id, message_ids);
-  return message_ids;
-}
-
-void OrderedMessages::do_find_newer_messages(const OrderedMessage *ordered_message, MessageId min_message_id,
-                                             vector<MessageId> &message_ids) {
-  if (ordered_message == nullptr) {
-    return;
-  }
-
-  if (ordered_message->message_id_ > min_message_id) {
-    do_find_newer_messages(ordered_message->left_.get(), min_message_id, message_ids);
-
-    message_ids.push_back(ordered_message->message_id_);
-  }
-
-  do_find_newer_messages(ordered_message->right_.get(), min_message_id, message_ids);
+  return vector<MessageId>(message_ids_.begin(),
+                           std::upper_bound(message_ids_.begin(), message_ids_.end(), max_message_id));
 }
 
 vector<MessageId> OrderedMessages::find_newer_messages(MessageId min_message_id) const {
-  vector<MessageId> message_ids;
-  do_find_newer_messages(messages_.get(), min_message_id, message_ids);
-  return message_ids;
+  return vector<MessageId>(std::upper_bound(message_ids_.begin(), message_ids_.end(), min_message_id),
+                           message_ids_.end());
 }
 
 MessageId OrderedMessages::do_find_message_by_date(const OrderedMessage *ordered_message, int32 date,
@@ -342,13 +322,7 @@ vector<MessageId> OrderedMessages::get_history(MessageId last_message_id, Messag
     if (*it == nullptr) {
       // there is no gap if from_message_id is less than the first message
       if (force && offset < 0 && messages_ != nullptr) {
-        MessageId min_message_id;
-        traverse_messages(
-            [&](MessageId message_id) {
-              min_message_id = message_id;
-              return true;
-            },
-            [](MessageId) { return false; });
+        auto min_message_id = message_ids_[0];
         CHECK(min_message_id > from_message_id);
         from_message_id = min_message_id;
         it = get_const_iterator(from_message_id);
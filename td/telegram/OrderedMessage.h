@@ -205,12 +205,6 @@ class OrderedMessages {
     return Iterator(messages_.get(), message_id);
   }
 
-  static void do_find_older_messages(const OrderedMessage *ordered_message, MessageId max_message_id,
-                                     vector<MessageId> &message_ids);
-
-  static void do_find_newer_messages(const OrderedMessage *ordered_message, MessageId min_message_id,
-                                     vector<MessageId> &message_ids);
-
   static MessageId do_find_message_by_date(const OrderedMessage *ordered_message, int32 date,
                                            const std::function<int32(MessageId)> &get_message_date);
 
@@ -223,6 +217,9 @@ class OrderedMessages {
                                    const std::function<bool(MessageId)> &need_scan_newer);
 
   unique_ptr<OrderedMessage> messages_;
+
+  // sorted identifiers of all messages in the tree for fast range queries
+  vector<MessageId> message_ids_;
 };
 
 }  // namespace td
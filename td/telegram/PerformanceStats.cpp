@@ -0,0 +1,343 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/PerformanceStats.h"
+
+#include "td/telegram/files/FileBandwidthBudget.h"
+#include "td/telegram/net/NetQueryCompressor.h"
+#include "td/telegram/net/NetQueryLatencyStats.h"
+#include "td/telegram/td_api.h"
+#include "td/telegram/UpdateDeliveryStats.h"
+#include "td/telegram/WebPagesManager.h"
+
+#include "td/mtproto/SessionConnectionStats.h"
+
+#include "td/net/SslCtx.h"
+
+#include "td/db/SqliteStatementStats.h"
+
+#include "td/actor/ActorStats.h"
+
+#include "td/utils/filesystem.h"
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/port/Stat.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/StringBuilder.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+namespace td {
+
+namespace {
+
+class PrometheusWriter {
+ public:
+  void add_metric(Slice name, Slice type, Slice help) {
+    result_ += PSTRING() << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+  }
+
+  void add_value(Slice name, Slice labels, uint64 value) {
+    result_ += PSTRING() << name << labels << ' ' << value << '\n';
+  }
+
+  void add_value(Slice name, Slice labels, int64 value) {
+    result_ += PSTRING() << name << labels << ' ' << value << '\n';
+  }
+
+  void add_value(Slice name, Slice labels, double value) {
+    result_ += PSTRING() << name << labels << ' ' << StringBuilder::FixedDouble(value, 6) << '\n';
+  }
+
+  void add_delays(Slice name, Slice help, Slice labels, const td_api::delayStatistics *delays) {
+    if (delays == nullptr || delays->count_ == 0) {
+      return;
+    }
+    add_metric(name, "summary", help);
+    add_delay_values(name, labels, delays);
+  }
+
+  void add_delay_values(Slice name, Slice labels, const td_api::delayStatistics *delays) {
+    if (delays == nullptr || delays->count_ == 0) {
+      return;
+    }
+    auto add_quantile = [&](Slice quantile, double value) {
+      add_value(name, join_labels(labels, PSLICE() << "quantile=\"" << quantile << '"'), value);
+    };
+    add_quantile("0.5", delays->median_delay_);
+    add_quantile("0.9", delays->percentile_90_delay_);
+    add_quantile("0.99", delays->percentile_99_delay_);
+    add_quantile("1", delays->max_delay_);
+    add_value(PSLICE() << name << "_sum", labels, delays->average_delay_ * static_cast<double>(delays->count_));
+    add_value(PSLICE() << name << "_count", labels, delays->count_);
+  }
+
+  static string get_label(Slice name, Slice value) {
+    string result = PSTRING() << '{' << name << "=\"";
+    for (auto c : value) {
+      switch (c) {
+        case '\\':
+          result += "\\\\";
+          break;
+        case '"':
+          result += "\\\"";
+          break;
+        case '\n':
+          result += "\\n";
+          break;
+        default:
+          result += c;
+      }
+    }
+    result += "\"}";
+    return result;
+  }
+
+  string move_as_string() {
+    return std::move(result_);
+  }
+
+ private:
+  string result_;
+
+  static string join_labels(Slice labels, Slice label) {
+    if (labels.empty()) {
+      return PSTRING() << '{' << label << '}';
+    }
+    return PSTRING() << labels.substr(0, labels.size() - 1) << ',' << label << '}';
+  }
+};
+
+class PerformanceStatsDumper {
+ public:
+  PerformanceStatsDumper() = default;
+  PerformanceStatsDumper(const PerformanceStatsDumper &) = delete;
+  PerformanceStatsDumper &operator=(const PerformanceStatsDumper &) = delete;
+  PerformanceStatsDumper(PerformanceStatsDumper &&) = delete;
+  PerformanceStatsDumper &operator=(PerformanceStatsDumper &&) = delete;
+  ~PerformanceStatsDumper() {
+    stop();
+  }
+
+  void set_parameters(string file_path, int32 dump_period) {
+    stop();
+    if (dump_period == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopped_ = false;
+    thread_ = thread([this, file_path = std::move(file_path), dump_period] { run(file_path, dump_period); });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_variable_;
+  bool is_stopped_ = true;
+  thread thread_;
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_stopped_ = true;
+    }
+    condition_variable_.notify_all();
+    thread_.join();
+  }
+
+  void run(const string &file_path, int32 dump_period) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!condition_variable_.wait_for(lock, std::chrono::seconds(dump_period), [&] { return is_stopped_; })) {
+      lock.unlock();
+      auto status = atomic_write_file(file_path, PerformanceStats::get_prometheus_text());
+      if (status.is_error()) {
+        LOG(WARNING) << "Failed to write performance statistics to " << file_path << ": " << status;
+      }
+      lock.lock();
+    }
+  }
+};
+
+void add_memory_metrics(PrometheusWriter &writer) {
+  auto r_mem_stat = mem_stat();
+  if (r_mem_stat.is_error()) {
+    return;
+  }
+  auto stat = r_mem_stat.move_as_ok();
+  writer.add_metric("tdlib_resident_memory_bytes", "gauge", "Resident memory size of the process");
+  writer.add_value("tdlib_resident_memory_bytes", Slice(), stat.resident_size_);
+  writer.add_metric("tdlib_resident_memory_peak_bytes", "gauge", "Peak resident memory size of the process");
+  writer.add_value("tdlib_resident_memory_peak_bytes", Slice(), stat.resident_size_peak_);
+}
+
+void add_actor_metrics(PrometheusWriter &writer) {
+  auto statistics = ActorStats::get_statistics(false);
+  if (statistics.empty()) {
+    return;
+  }
+  writer.add_metric("tdlib_actor_events_total", "counter", "Number of events processed by actors");
+  for (auto &actor : statistics) {
+    writer.add_value("tdlib_actor_events_total", PrometheusWriter::get_label("actor", actor.name), actor.event_count);
+  }
+  writer.add_metric("tdlib_actor_run_time_seconds_total", "counter", "Time spent by actors processing events");
+  for (auto &actor : statistics) {
+    writer.add_value("tdlib_actor_run_time_seconds_total", PrometheusWriter::get_label("actor", actor.name),
+                     actor.run_time);
+  }
+  writer.add_metric("tdlib_actor_max_mailbox_size", "gauge", "Maximum number of events waiting for an actor");
+  for (auto &actor : statistics) {
+    writer.add_value("tdlib_actor_max_mailbox_size", PrometheusWriter::get_label("actor", actor.name),
+                     actor.max_mailbox_size);
+  }
+}
+
+void add_database_metrics(PrometheusWriter &writer) {
+  auto statistics = SqliteStatementStats::get_statistics(false);
+  if (statistics.empty()) {
+    return;
+  }
+  writer.add_metric("tdlib_database_statement_executions_total", "counter", "Number of executions of SQL statements");
+  for (auto &statement : statistics) {
+    writer.add_value("tdlib_database_statement_executions_total",
+                     PrometheusWriter::get_label("query", statement.query), statement.execution_count);
+  }
+  writer.add_metric("tdlib_database_statement_rows_total", "counter", "Number of rows returned by SQL statements");
+  for (auto &statement : statistics) {
+    writer.add_value("tdlib_database_statement_rows_total", PrometheusWriter::get_label("query", statement.query),
+                     statement.row_count);
+  }
+  writer.add_metric("tdlib_database_statement_step_time_seconds_total", "counter",
+                    "Time spent executing SQL statements");
+  for (auto &statement : statistics) {
+    writer.add_value("tdlib_database_statement_step_time_seconds_total",
+                     PrometheusWriter::get_label("query", statement.query), statement.step_time);
+  }
+}
+
+void add_network_metrics(PrometheusWriter &writer) {
+  auto packets = mtproto::SessionConnectionStats::get_statistics(false);
+  writer.add_metric("tdlib_network_packets_total", "counter", "Number of MTProto packets sent");
+  writer.add_value("tdlib_network_packets_total", Slice(), packets.packet_count);
+  writer.add_metric("tdlib_network_packet_queries_total", "counter", "Number of queries sent in MTProto packets");
+  writer.add_value("tdlib_network_packet_queries_total", Slice(), packets.query_count);
+  writer.add_metric("tdlib_network_packet_bytes_total", "counter", "Total size of sent MTProto packets");
+  writer.add_value("tdlib_network_packet_bytes_total", Slice(), packets.byte_count);
+
+  auto compression = NetQueryCompressor::get_statistics(false);
+  writer.add_metric("tdlib_network_query_compressed_total", "counter", "Number of requests sent compressed");
+  writer.add_value("tdlib_network_query_compressed_total", Slice(), compression.compressed_query_count);
+  writer.add_metric("tdlib_network_query_compression_time_seconds_total", "counter",
+                    "Time spent on compression of requests");
+  writer.add_value("tdlib_network_query_compression_time_seconds_total", Slice(), compression.compression_time);
+
+  auto latency = NetQueryLatencyStats::get_network_query_latency_statistics_object(false);
+  bool is_first = true;
+  for (auto &method : latency->methods_) {
+    if (method->total_delays_ == nullptr || method->total_delays_->count_ == 0) {
+      continue;
+    }
+    if (is_first) {
+      is_first = false;
+      writer.add_metric("tdlib_network_query_latency_seconds", "summary",
+                        "Time between creation of requests and end of processing of their results");
+    }
+    writer.add_delay_values("tdlib_network_query_latency_seconds",
+                            PrometheusWriter::get_label("method", PSLICE() << format::as_hex(method->method_id_)),
+                            method->total_delays_.get());
+  }
+
+  auto tls = SslCtx::get_session_cache_stats();
+  writer.add_metric("tdlib_tls_session_cache_sessions", "gauge", "Number of cached TLS sessions");
+  writer.add_value("tdlib_tls_session_cache_sessions", Slice(), static_cast<uint64>(tls.session_count));
+  writer.add_metric("tdlib_tls_session_cache_hits_total", "counter", "Number of resumed TLS sessions");
+  writer.add_value("tdlib_tls_session_cache_hits_total", Slice(), tls.hit_count);
+  writer.add_metric("tdlib_tls_session_cache_misses_total", "counter", "Number of TLS connections without a session");
+  writer.add_value("tdlib_tls_session_cache_misses_total", Slice(), tls.miss_count);
+}
+
+void add_update_metrics(PrometheusWriter &writer) {
+  auto statistics = UpdateDeliveryStats::get_update_delivery_statistics_object(false);
+  writer.add_delays("tdlib_update_dispatch_delay_seconds",
+                    "Delay between receiving of updates from the network and start of their processing", Slice(),
+                    statistics->dispatch_delays_.get());
+  writer.add_delays("tdlib_update_processing_delay_seconds",
+                    "Delay between start of processing of updates about messages and their application", Slice(),
+                    statistics->processing_delays_.get());
+  writer.add_delays("tdlib_update_queue_delay_seconds",
+                    "Delay between sending of updates by TDLib and returning them to the application", Slice(),
+                    statistics->queue_delays_.get());
+}
+
+void add_file_metrics(PrometheusWriter &writer) {
+  auto allocations = FileBandwidthBudget::get_file_transfer_bandwidth_allocations_object();
+  writer.add_metric("tdlib_file_transfer_limit_bytes_per_second", "gauge", "File transfer bandwidth limit");
+  writer.add_value("tdlib_file_transfer_limit_bytes_per_second", Slice(), allocations->limit_);
+  if (allocations->allocations_.empty()) {
+    return;
+  }
+  writer.add_metric("tdlib_file_transfer_bytes_total", "counter",
+                    "Size of file parts transferred by a file queue while the bandwidth limit was set");
+  for (auto &allocation : allocations->allocations_) {
+    writer.add_value("tdlib_file_transfer_bytes_total", PrometheusWriter::get_label("queue", allocation->name_),
+                     allocation->transferred_size_);
+  }
+  writer.add_metric("tdlib_file_transfer_allocated_bytes_per_second", "gauge",
+                    "File transfer bandwidth allocated to a file queue");
+  for (auto &allocation : allocations->allocations_) {
+    writer.add_value("tdlib_file_transfer_allocated_bytes_per_second",
+                     PrometheusWriter::get_label("queue", allocation->name_), allocation->bytes_per_second_);
+  }
+}
+
+void add_instant_view_cache_metrics(PrometheusWriter &writer) {
+  auto stats = WebPagesManager::get_instant_view_cache_stats();
+  writer.add_metric("tdlib_instant_view_cache_hits_total", "counter", "Number of requests of loaded instant views");
+  writer.add_value("tdlib_instant_view_cache_hits_total", Slice(), stats.hit_count);
+  writer.add_metric("tdlib_instant_view_cache_misses_total", "counter",
+                    "Number of requests of instant views, which weren't loaded in memory");
+  writer.add_value("tdlib_instant_view_cache_misses_total", Slice(), stats.miss_count);
+  writer.add_metric("tdlib_instant_view_cache_evictions_total", "counter",
+                    "Number of instant views evicted from memory");
+  writer.add_value("tdlib_instant_view_cache_evictions_total", Slice(), stats.eviction_count);
+}
+
+PerformanceStatsDumper &get_dumper() {
+  static PerformanceStatsDumper dumper;
+  return dumper;
+}
+
+}  // namespace
+
+string PerformanceStats::get_prometheus_text() {
+  PrometheusWriter writer;
+  add_memory_metrics(writer);
+  add_actor_metrics(writer);
+  add_database_metrics(writer);
+  add_network_metrics(writer);
+  add_update_metrics(writer);
+  add_file_metrics(writer);
+  add_instant_view_cache_metrics(writer);
+  return writer.move_as_string();
+}
+
+Status PerformanceStats::set_dump_parameters(string file_path, int32 dump_period) {
+  if (dump_period < 0 || dump_period > 86400) {
+    return Status::Error(400, "Invalid dump period specified");
+  }
+  if (dump_period != 0 && file_path.empty()) {
+    return Status::Error(400, "File path must be non-empty");
+  }
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  get_dumper().set_parameters(std::move(file_path), dump_period);
+  return Status::OK();
+}
+
+}  // namespace td
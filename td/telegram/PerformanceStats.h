@@ -0,0 +1,25 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Status.h"
+
+namespace td {
+
+// process-wide performance metrics of all TDLib instances, gathered from the other statistics collectors
+class PerformanceStats {
+ public:
+  // returns the metrics in the Prometheus text exposition format
+  static string get_prometheus_text();
+
+  // the metrics are atomically written to the file every dump_period seconds from a separate thread;
+  // 0 disables writing
+  static Status set_dump_parameters(string file_path, int32 dump_period);
+};
+
+}  // namespace td
@@ -245,6 +245,9 @@ PollManager::PollManager(Td *td, ActorShared<> parent) : td_(td), parent_(std::m
 
   unload_poll_timeout_.set_callback(on_unload_poll_timeout_callback);
   unload_poll_timeout_.set_callback_data(static_cast<void *>(this));
+
+  poll_update_notification_timeout_.set_callback(on_poll_update_notification_timeout_callback);
+  poll_update_notification_timeout_.set_callback_data(static_cast<void *>(this));
 }
 
 void PollManager::start_up() {
@@ -306,6 +309,16 @@ void PollManager::on_unload_poll_timeout_callback(void *poll_manager_ptr, int64
   send_closure_later(poll_manager->actor_id(poll_manager), &PollManager::on_unload_poll_timeout, PollId(poll_id_int));
 }
 
+void PollManager::on_poll_update_notification_timeout_callback(void *poll_manager_ptr, int64 poll_id_int) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  auto poll_manager = static_cast<PollManager *>(poll_manager_ptr);
+  send_closure_later(poll_manager->actor_id(poll_manager), &PollManager::on_poll_update_notification_timeout,
+                     PollId(poll_id_int));
+}
+
 bool PollManager::is_local_poll_id(PollId poll_id) {
   return poll_id.get() < 0 && poll_id.get() > std::numeric_limits<int32>::min();
 }
@@ -352,6 +365,49 @@ void PollManager::notify_on_poll_update(PollId poll_id) {
   }
 }
 
+void PollManager::schedule_poll_update_notification(PollId poll_id) {
+  if (poll_update_notification_timeout_.has_timeout(poll_id.get())) {
+    LOG(INFO) << "Delay notification about vote count changes in " << poll_id;
+    pending_poll_update_notifications_.insert(poll_id);
+    return;
+  }
+  send_poll_update_notification(poll_id);
+}
+
+void PollManager::send_poll_update_notification(PollId poll_id) {
+  notify_on_poll_update(poll_id);
+  if (td_->auth_manager_->is_bot()) {
+    auto poll = get_poll(poll_id);
+    CHECK(poll != nullptr);
+    send_closure(G()->td(), &Td::send_update, td_api::make_object<td_api::updatePoll>(get_poll_object(poll_id, poll)));
+  }
+  if (!G()->close_flag()) {
+    poll_update_notification_timeout_.set_timeout_in(poll_id.get(), POLL_UPDATE_NOTIFICATION_PERIOD);
+  }
+}
+
+void PollManager::on_poll_update_notification_timeout(PollId poll_id) {
+  if (G()->close_flag()) {
+    return;
+  }
+  if (pending_poll_update_notifications_.erase(poll_id) == 0 || !have_poll(poll_id)) {
+    return;
+  }
+
+  send_poll_update_notification(poll_id);
+  schedule_poll_unload(poll_id);
+}
+
+bool PollManager::is_poll_viewed(PollId poll_id) {
+  bool is_viewed = false;
+  server_poll_messages_[poll_id].foreach([&](const MessageFullId &message_full_id) {
+    if (!is_viewed && td_->messages_manager_->is_dialog_opened(message_full_id.get_dialog_id())) {
+      is_viewed = true;
+    }
+  });
+  return is_viewed;
+}
+
 string PollManager::get_poll_database_key(PollId poll_id) {
   return PSTRING() << "poll" << poll_id.get();
 }
@@ -730,6 +786,7 @@ void PollManager::unregister_poll(PollId poll_id, MessageFullId message_full_id,
   }
   if (message_ids.empty()) {
     server_poll_messages_.erase(poll_id);
+    unviewed_polls_.erase(poll_id);
     if (!G()->close_flag()) {
       update_poll_timeout_.cancel_timeout(poll_id.get(), "unregister_poll");
     }
@@ -761,13 +818,40 @@ void PollManager::unregister_reply_poll(PollId poll_id) {
   }
 }
 
+void PollManager::on_dialog_opened(DialogId dialog_id) {
+  if (unviewed_polls_.empty()) {
+    return;
+  }
+
+  vector<PollId> poll_ids;
+  for (auto poll_id : unviewed_polls_) {
+    bool is_viewed = false;
+    server_poll_messages_[poll_id].foreach([&](const MessageFullId &message_full_id) {
+      if (message_full_id.get_dialog_id() == dialog_id) {
+        is_viewed = true;
+      }
+    });
+    if (is_viewed) {
+      poll_ids.push_back(poll_id);
+    }
+  }
+  for (auto poll_id : poll_ids) {
+    LOG(INFO) << "Schedule updating of viewed " << poll_id;
+    unviewed_polls_.erase(poll_id);
+    if (!G()->close_flag()) {
+      update_poll_timeout_.set_timeout_in(poll_id.get(), 0.0);
+    }
+  }
+}
+
 bool PollManager::can_unload_poll(PollId poll_id) {
   if (G()->close_flag()) {
     return false;
   }
   if (is_local_poll_id(poll_id) || server_poll_messages_.count(poll_id) != 0 ||
       other_poll_messages_.count(poll_id) != 0 || reply_poll_counts_.count(poll_id) != 0 ||
-      pending_answers_.count(poll_id) != 0 || being_closed_polls_.count(poll_id) != 0) {
+      pending_answers_.count(poll_id) != 0 || being_closed_polls_.count(poll_id) != 0 ||
+      pending_poll_update_notifications_.count(poll_id) != 0) {
     return false;
   }
 
@@ -1380,6 +1464,11 @@ void PollManager::on_update_poll_timeout(PollId poll_id) {
   if (server_poll_messages_.count(poll_id) == 0) {
     return;
   }
+  if (!is_poll_viewed(poll_id)) {
+    LOG(INFO) << "Skip fetching results of " << poll_id << ", because it isn't viewed";
+    unviewed_polls_.insert(poll_id);
+    return;
+  }
 
   auto message_full_id = server_poll_messages_[poll_id].get_random();
   LOG(INFO) << "Fetching results of " << poll_id << " from " << message_full_id;
@@ -1443,6 +1532,8 @@ void PollManager::on_unload_poll_timeout(PollId poll_id) {
 
   update_poll_timeout_.cancel_timeout(poll_id.get(), "on_unload_poll_timeout");
   close_poll_timeout_.cancel_timeout(poll_id.get());
+  poll_update_notification_timeout_.cancel_timeout(poll_id.get());
+  unviewed_polls_.erase(poll_id);
 
   auto is_deleted = polls_.erase(poll_id) > 0;
   CHECK(is_deleted);
@@ -1626,6 +1717,7 @@ PollId PollManager::on_get_poll(PollId poll_id, tl_object_ptr<telegram_api::poll
 
   auto poll = get_poll_force(poll_id);
   bool is_changed = false;
+  bool is_voter_count_changed = false;  // changes caused only by votes of other users
   bool need_save_to_database = false;
   if (poll == nullptr) {
     if (poll_server == nullptr) {
@@ -1764,7 +1856,7 @@ PollId PollManager::on_get_poll(PollId poll_id, tl_object_ptr<telegram_api::poll
       LOG(ERROR) << "Receive " << poll->total_voter_count_ << " voters in " << poll_id << " from " << source;
       poll->total_voter_count_ = 0;
     }
-    is_changed = true;
+    is_voter_count_changed = true;
   }
   int32 correct_option_id = -1;
   for (auto &poll_result : poll_results->results_) {
@@ -1818,7 +1910,7 @@ PollId PollManager::on_get_poll(PollId poll_id, tl_object_ptr<telegram_api::poll
       if (poll_result->voters_ != option.voter_count_) {
         invalidate_poll_option_voters(poll, poll_id, option_index);
         option.voter_count_ = poll_result->voters_;
-        is_changed = true;
+        is_voter_count_changed = true;
       }
     }
   }
@@ -1882,7 +1974,7 @@ PollId PollManager::on_get_poll(PollId poll_id, tl_object_ptr<telegram_api::poll
   if (recent_voter_dialog_ids != poll->recent_voter_dialog_ids_) {
     poll->recent_voter_dialog_ids_ = std::move(recent_voter_dialog_ids);
     invalidate_poll_voters(poll, poll_id);
-    is_changed = true;
+    is_voter_count_changed = true;
   }
 
   if (!is_bot && !poll->is_closed_ && !G()->close_flag()) {
@@ -1890,16 +1982,20 @@ PollId PollManager::on_get_poll(PollId poll_id, tl_object_ptr<telegram_api::poll
     LOG(INFO) << "Schedule updating of " << poll_id << " in " << timeout;
     update_poll_timeout_.set_timeout_in(poll_id.get(), timeout);
   }
-  if (is_changed || need_save_to_database) {
+  if (is_changed || is_voter_count_changed || need_save_to_database) {
     save_poll(poll, poll_id);
   }
   if (is_changed) {
+    pending_poll_update_notifications_.erase(poll_id);
     notify_on_poll_update(poll_id);
   }
   if (need_update_poll && (is_changed || (poll->is_closed_ && being_closed_polls_.erase(poll_id) != 0))) {
     send_closure(G()->td(), &Td::send_update, td_api::make_object<td_api::updatePoll>(get_poll_object(poll_id, poll)));
 
     schedule_poll_unload(poll_id);
+  } else if (!is_changed && is_voter_count_changed && (need_update_poll || !is_bot)) {
+    // vote counts of popular polls can change many times per second, so only the latest state is sent
+    schedule_poll_update_notification(poll_id);
   }
   return poll_id;
 }
@@ -61,6 +61,8 @@ class PollManager final : public Actor {
 
   void unregister_reply_poll(PollId poll_id);
 
+  void on_dialog_opened(DialogId dialog_id);
+
   bool get_poll_is_closed(PollId poll_id) const;
 
   bool get_poll_is_anonymous(PollId poll_id) const;
@@ -147,6 +149,9 @@ class PollManager final : public Actor {
   static constexpr int32 MAX_GET_POLL_VOTERS = 50;  // server side limit
   static constexpr int32 UNLOAD_POLL_DELAY = 600;   // some reasonable value
 
+  // vote count changes of a poll are sent to the client at most once in the period
+  static constexpr double POLL_UPDATE_NOTIFICATION_PERIOD = 1.0;
+
   class SetPollAnswerLogEvent;
   class StopPollLogEvent;
 
@@ -159,6 +164,8 @@ class PollManager final : public Actor {
 
   static void on_unload_poll_timeout_callback(void *poll_manager_ptr, int64 poll_id_int);
 
+  static void on_poll_update_notification_timeout_callback(void *poll_manager_ptr, int64 poll_id_int);
+
   static void remove_unallowed_entities(FormattedText &text);
 
   static td_api::object_ptr<td_api::pollOption> get_poll_option_object(const PollOption &poll_option);
@@ -183,6 +190,14 @@ class PollManager final : public Actor {
 
   void notify_on_poll_update(PollId poll_id);
 
+  void schedule_poll_update_notification(PollId poll_id);
+
+  void send_poll_update_notification(PollId poll_id);
+
+  void on_poll_update_notification_timeout(PollId poll_id);
+
+  bool is_poll_viewed(PollId poll_id);
+
   static string get_poll_database_key(PollId poll_id);
 
   static void save_poll(const Poll *poll, PollId poll_id);
@@ -235,6 +250,11 @@ class PollManager final : public Actor {
   MultiTimeout update_poll_timeout_{"UpdatePollTimeout"};
   MultiTimeout close_poll_timeout_{"ClosePollTimeout"};
   MultiTimeout unload_poll_timeout_{"UnloadPollTimeout"};
+  MultiTimeout poll_update_notification_timeout_{"PollUpdateNotificationTimeout"};
+
+  FlatHashSet<PollId, PollIdHash> pending_poll_update_notifications_;
+
+  FlatHashSet<PollId, PollIdHash> unviewed_polls_;  // polls, which results weren't fetched, because they aren't viewed
 
   WaitFreeHashMap<PollId, unique_ptr<Poll>, PollIdHash> polls_;
 
@@ -10,8 +10,11 @@
 
 namespace td {
 
-QueryMerger::QueryMerger(Slice name, size_t max_concurrent_query_count, size_t max_merged_query_count)
-    : max_concurrent_query_count_(max_concurrent_query_count), max_merged_query_count_(max_merged_query_count) {
+QueryMerger::QueryMerger(Slice name, size_t max_concurrent_query_count, size_t max_merged_query_count,
+                         double max_delay)
+    : max_concurrent_query_count_(max_concurrent_query_count)
+    , max_merged_query_count_(max_merged_query_count)
+    , max_delay_(max_delay) {
   register_actor(name, this).release();
 }
 
@@ -25,6 +28,13 @@ void QueryMerger::add_query(int64 query_id, Promise<Unit> &&promise, const char
     return;
   }
   pending_queries_.push(query_id);
+  if (max_delay_ > 0 && pending_queries_.size() < max_merged_query_count_) {
+    if (!is_delayed_) {
+      is_delayed_ = true;
+      set_timeout_in(max_delay_);
+    }
+    return;
+  }
   loop();
 }
 
@@ -55,10 +65,19 @@ void QueryMerger::on_get_query_result(vector<int64> query_ids, Result<Unit> &&re
   loop();
 }
 
+void QueryMerger::timeout_expired() {
+  is_delayed_ = false;
+  loop();
+}
+
 void QueryMerger::loop() {
   if (query_count_ == max_concurrent_query_count_) {
     return;
   }
+  if (is_delayed_) {
+    is_delayed_ = false;
+    cancel_timeout();
+  }
 
   vector<int64> query_ids;
   while (!pending_queries_.empty()) {
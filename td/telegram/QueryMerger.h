@@ -20,9 +20,11 @@
 namespace td {
 
 // merges queries into a single request
+// if max_delay is positive, then queries wait up to max_delay seconds to be merged with subsequent queries,
+// otherwise queries are merged only while the maximum number of concurrent requests is being sent
 class QueryMerger final : public Actor {
  public:
-  QueryMerger(Slice name, size_t max_concurrent_query_count, size_t max_merged_query_count);
+  QueryMerger(Slice name, size_t max_concurrent_query_count, size_t max_merged_query_count, double max_delay = 0.0);
 
   using MergeFunction = std::function<void(vector<int64> query_ids, Promise<Unit> &&promise)>;
   void set_merge_function(MergeFunction merge_function) {
@@ -39,6 +41,8 @@ class QueryMerger final : public Actor {
   size_t query_count_ = 0;
   size_t max_concurrent_query_count_;
   size_t max_merged_query_count_;
+  double max_delay_;
+  bool is_delayed_ = false;
 
   MergeFunction merge_function_;
   std::queue<int64> pending_queries_;
@@ -48,6 +52,8 @@ class QueryMerger final : public Actor {
 
   void on_get_query_result(vector<int64> query_ids, Result<Unit> &&result);
 
+  void timeout_expired() final;
+
   void loop() final;
 };
 
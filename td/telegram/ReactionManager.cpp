@@ -523,7 +523,7 @@ td_api::object_ptr<td_api::availableReactions> ReactionManager::get_sorted_avail
     row_size = 8;
   }
 
-  bool is_premium = td_->option_manager_->get_option_boolean("is_premium");
+  bool is_premium = td_->option_manager_->get_option_boolean(CachedOption::IsPremium);
   bool show_premium = is_premium || is_tag;
   vector<ReactionType> recent_reactions;
   vector<ReactionType> top_reactions;
@@ -84,6 +84,7 @@
 #include "td/telegram/LanguagePackManager.h"
 #include "td/telegram/LinkManager.h"
 #include "td/telegram/Location.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageCopyOptions.h"
 #include "td/telegram/MessageEffectId.h"
 #include "td/telegram/MessageEntity.h"
@@ -1924,9 +1925,24 @@ Requests::Requests(Td *td)
     : td_(td), td_actor_(td->actor_id(td)), download_file_callback_(std::make_shared<DownloadFileCallback>()) {
 }
 
+FlatHashMap<int32, Requests::RequestHandler> Requests::create_request_handlers() {
+  FlatHashMap<int32, RequestHandler> handlers;
+  td_api::for_each_function_type([&handlers](auto *request) {
+    using RequestT = std::decay_t<decltype(*request)>;
+    RequestHandler handler = [](Requests *requests, uint64 id, td_api::Function &function) {
+      requests->on_request(id, static_cast<RequestT &>(function));
+    };
+    handlers.emplace(RequestT::ID, handler);
+  });
+  return handlers;
+}
+
 void Requests::run_request(uint64 id, td_api::object_ptr<td_api::Function> &&function) {
   CHECK(td_ != nullptr);
-  downcast_call(*function, [this, id](auto &request) { this->on_request(id, request); });
+  static const auto handlers = create_request_handlers();
+  auto it = handlers.find(function->get_id());
+  CHECK(it != handlers.end());
+  it->second(this, id, *function);
 }
 
 void Requests::send_error_raw(uint64 id, int32 code, CSlice error) {
@@ -2794,6 +2810,10 @@ void Requests::on_request(uint64 id, td_api::resetNetworkStatistics &request) {
   promise.set_value(Unit());
 }
 
+void Requests::on_request(uint64 id, const td_api::getNetworkRateLimits &request) {
+  td_->send_result(id, G()->net_query_dispatcher().get_network_rate_limits_object());
+}
+
 void Requests::on_request(uint64 id, td_api::addNetworkStatistics &request) {
   if (request.entry_ == nullptr) {
     return send_error_raw(id, 400, "Network statistics entry must be non-empty");
@@ -5524,6 +5544,16 @@ void Requests::on_request(uint64 id, const td_api::readFilePart &request) {
                request.count_, 2, std::move(promise));
 }
 
+void Requests::on_request(uint64 id, const td_api::streamFilePart &request) {
+  auto priority = request.priority_;
+  if (!(1 <= priority && priority <= 32)) {
+    return send_error_raw(id, 400, "Download priority must be between 1 and 32");
+  }
+  CREATE_REQUEST_PROMISE();
+  send_closure(td_->file_manager_actor_, &FileManager::read_file_part_streaming, FileId(request.file_id_, 0),
+               download_file_callback_, priority, request.offset_, request.count_, std::move(promise));
+}
+
 void Requests::on_request(uint64 id, const td_api::deleteFile &request) {
   CREATE_OK_REQUEST_PROMISE();
   send_closure(td_->file_manager_actor_, &FileManager::delete_file, FileId(request.file_id_, 0), std::move(promise),
@@ -5540,6 +5570,23 @@ void Requests::on_request(uint64 id, const td_api::addFileToDownloads &request)
       request.priority_, std::move(promise));
 }
 
+void Requests::on_request(uint64 id, const td_api::addFilesToDownloads &request) {
+  if (!(1 <= request.priority_ && request.priority_ <= 32)) {
+    return send_error_raw(id, 400, "Download priority must be between 1 and 32");
+  }
+  vector<std::pair<MessageFullId, FileId>> message_files;
+  for (auto &file : request.files_) {
+    if (file == nullptr) {
+      return send_error_raw(id, 400, "File must be non-empty");
+    }
+    message_files.emplace_back(MessageFullId(DialogId(file->chat_id_), MessageId(file->message_id_)),
+                               FileId(file->file_id_, 0));
+  }
+  CREATE_OK_REQUEST_PROMISE();
+  td_->messages_manager_->add_message_files_to_downloads(std::move(message_files), request.priority_,
+                                                         std::move(promise));
+}
+
 void Requests::on_request(uint64 id, const td_api::toggleDownloadIsPaused &request) {
   CREATE_OK_REQUEST_PROMISE();
   send_closure(td_->download_manager_actor_, &DownloadManager::toggle_is_paused, FileId(request.file_id_, 0),
@@ -5558,6 +5605,13 @@ void Requests::on_request(uint64 id, const td_api::removeFileFromDownloads &requ
                request.delete_from_cache_, std::move(promise));
 }
 
+void Requests::on_request(uint64 id, const td_api::removeFilesFromDownloads &request) {
+  CREATE_OK_REQUEST_PROMISE();
+  send_closure(td_->download_manager_actor_, &DownloadManager::remove_files,
+               transform(request.file_ids_, [](int32 file_id) { return FileId(file_id, 0); }),
+               request.delete_from_cache_, std::move(promise));
+}
+
 void Requests::on_request(uint64 id, const td_api::removeAllFilesFromDownloads &request) {
   CREATE_OK_REQUEST_PROMISE();
   send_closure(td_->download_manager_actor_, &DownloadManager::remove_all_files, request.only_active_,
@@ -7569,6 +7623,11 @@ void Requests::on_request(uint64 id, const td_api::getPhoneNumberInfo &request)
   td_->country_info_manager_->get_phone_number_info(request.phone_number_prefix_, std::move(promise));
 }
 
+void Requests::on_request(uint64 id, td_api::getPhoneNumbersInfo &request) {
+  CREATE_REQUEST_PROMISE();
+  td_->country_info_manager_->get_phone_numbers_info(std::move(request.phone_number_prefixes_), std::move(promise));
+}
+
 void Requests::on_request(uint64 id, td_api::getCollectibleItemInfo &request) {
   CREATE_REQUEST_PROMISE();
   get_collectible_info(td_, std::move(request.type_), std::move(promise));
@@ -7776,6 +7835,90 @@ void Requests::on_request(uint64 id, const td_api::addLogMessage &request) {
   UNREACHABLE();
 }
 
+void Requests::on_request(uint64 id, const td_api::setActorStatisticsParameters &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getActorStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::setActorProfilerSamplingInterval &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getActorProfilerSamples &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::toggleDatabaseStatementStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getDatabaseStatementStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getActorMemoryUsage &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getMemoryStatistics &request) {
+  MemoryStatistics statistics;
+  td_->messages_manager_->get_memory_statistics(statistics);
+  td_->user_manager_->get_memory_statistics(statistics);
+  td_->chat_manager_->get_memory_statistics(statistics);
+  td_->file_manager_->get_memory_statistics(statistics);
+  td_->stickers_manager_->get_memory_statistics(statistics);
+  td_->web_pages_manager_->get_memory_statistics(statistics);
+  statistics.add_process_components();
+  send_closure(td_actor_, &Td::send_result, id, statistics.get_memory_statistics_object());
+}
+
+void Requests::on_request(uint64 id, const td_api::toggleUpdateDeliveryStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getUpdateDeliveryStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getNetworkPacketStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getNetworkQueryCompressionStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::toggleNetworkQueryLatencyStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getNetworkQueryLatencyStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::setNetworkQueryLogSampleRate &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::setFileTransferBandwidthLimit &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getFileTransferBandwidthAllocations &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getPerformanceStatistics &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::setPerformanceStatisticsDumpParameters &request) {
+  UNREACHABLE();
+}
+
 // test
 void Requests::on_request(uint64 id, const td_api::testNetwork &request) {
   CREATE_OK_REQUEST_PROMISE();
@@ -38,6 +38,11 @@ class Requests {
 
   void answer_ok_query(uint64 id, Status status);
 
+  // a separate small handler is instantiated for each request type instead of inlining all of them into run_request
+  using RequestHandler = void (*)(Requests *requests, uint64 id, td_api::Function &function);
+
+  static FlatHashMap<int32, RequestHandler> create_request_handlers();
+
   struct DownloadInfo {
     int64 offset = -1;
     int64 limit = -1;
@@ -321,6 +326,8 @@ class Requests {
 
   void on_request(uint64 id, td_api::resetNetworkStatistics &request);
 
+  void on_request(uint64 id, const td_api::getNetworkRateLimits &request);
+
   void on_request(uint64 id, td_api::addNetworkStatistics &request);
 
   void on_request(uint64 id, const td_api::setNetworkType &request);
@@ -999,16 +1006,22 @@ class Requests {
 
   void on_request(uint64 id, const td_api::readFilePart &request);
 
+  void on_request(uint64 id, const td_api::streamFilePart &request);
+
   void on_request(uint64 id, const td_api::deleteFile &request);
 
   void on_request(uint64 id, const td_api::addFileToDownloads &request);
 
+  void on_request(uint64 id, const td_api::addFilesToDownloads &request);
+
   void on_request(uint64 id, const td_api::toggleDownloadIsPaused &request);
 
   void on_request(uint64 id, const td_api::toggleAllDownloadsArePaused &request);
 
   void on_request(uint64 id, const td_api::removeFileFromDownloads &request);
 
+  void on_request(uint64 id, const td_api::removeFilesFromDownloads &request);
+
   void on_request(uint64 id, const td_api::removeAllFilesFromDownloads &request);
 
   void on_request(uint64 id, td_api::searchFileDownloads &request);
@@ -1571,6 +1584,8 @@ class Requests {
 
   void on_request(uint64 id, const td_api::getPhoneNumberInfo &request);
 
+  void on_request(uint64 id, td_api::getPhoneNumbersInfo &request);
+
   void on_request(uint64 id, td_api::getCollectibleItemInfo &request);
 
   void on_request(uint64 id, const td_api::getApplicationDownloadLink &request);
@@ -1655,6 +1670,44 @@ class Requests {
 
   void on_request(uint64 id, const td_api::addLogMessage &request);
 
+  void on_request(uint64 id, const td_api::setActorStatisticsParameters &request);
+
+  void on_request(uint64 id, const td_api::getActorStatistics &request);
+
+  void on_request(uint64 id, const td_api::setActorProfilerSamplingInterval &request);
+
+  void on_request(uint64 id, const td_api::getActorProfilerSamples &request);
+
+  void on_request(uint64 id, const td_api::toggleDatabaseStatementStatistics &request);
+
+  void on_request(uint64 id, const td_api::getDatabaseStatementStatistics &request);
+
+  void on_request(uint64 id, const td_api::getActorMemoryUsage &request);
+
+  void on_request(uint64 id, const td_api::getMemoryStatistics &request);
+
+  void on_request(uint64 id, const td_api::toggleUpdateDeliveryStatistics &request);
+
+  void on_request(uint64 id, const td_api::getUpdateDeliveryStatistics &request);
+
+  void on_request(uint64 id, const td_api::getNetworkPacketStatistics &request);
+
+  void on_request(uint64 id, const td_api::getNetworkQueryCompressionStatistics &request);
+
+  void on_request(uint64 id, const td_api::toggleNetworkQueryLatencyStatistics &request);
+
+  void on_request(uint64 id, const td_api::getNetworkQueryLatencyStatistics &request);
+
+  void on_request(uint64 id, const td_api::setNetworkQueryLogSampleRate &request);
+
+  void on_request(uint64 id, const td_api::setFileTransferBandwidthLimit &request);
+
+  void on_request(uint64 id, const td_api::getFileTransferBandwidthAllocations &request);
+
+  void on_request(uint64 id, const td_api::getPerformanceStatistics &request);
+
+  void on_request(uint64 id, const td_api::setPerformanceStatisticsDumpParameters &request);
+
   void on_request(uint64 id, const td_api::testNetwork &request);
 
   void on_request(uint64 id, td_api::testProxy &request);
@@ -143,6 +143,7 @@ void SecretChatActor::replay_close_chat(unique_ptr<log_event::CloseSecretChat> e
 
 void SecretChatActor::replay_create_chat(unique_ptr<log_event::CreateSecretChat> event) {
   if (close_flag_) {
+    binlog_erase(context_->binlog(), event->log_event_id());
     return;
   }
   do_create_chat_impl(std::move(event));
@@ -166,11 +167,14 @@ void SecretChatActor::add_inbound_message(unique_ptr<log_event::InboundSecretMes
 }
 
 void SecretChatActor::replay_inbound_message(unique_ptr<log_event::InboundSecretMessage> message) {
+  // the message can't be processed anymore, so there is no need to replay it again after restart
   if (close_flag_) {
+    binlog_erase(context_->binlog(), message->log_event_id());
     return;
   }
   if (auth_state_.state != State::Ready) {
     LOG(ERROR) << "Ignore unexpected replay inbound message: " << tag("message", *message);
+    binlog_erase(context_->binlog(), message->log_event_id());
     return;
   }
 
@@ -190,10 +194,12 @@ void SecretChatActor::replay_inbound_message(unique_ptr<log_event::InboundSecret
 
 void SecretChatActor::replay_outbound_message(unique_ptr<log_event::OutboundSecretMessage> message) {
   if (close_flag_) {
+    binlog_erase(context_->binlog(), message->log_event_id());
     return;
   }
   if (auth_state_.state != State::Ready) {
     LOG(ERROR) << "Ignore unexpected replay outbound message: " << tag("message", *message);
+    binlog_erase(context_->binlog(), message->log_event_id());
     return;
   }
   CHECK(!binlog_replay_finish_flag_);
@@ -28,6 +28,7 @@
 #include "td/db/binlog/BinlogHelper.h"
 #include "td/db/binlog/BinlogInterface.h"
 
+#include "td/utils/algorithm.h"
 #include "td/utils/common.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
@@ -423,6 +424,24 @@ unique_ptr<SecretChatActor::Context> SecretChatsManager::make_secret_chat_contex
                               td::make_unique<SecretChatDb>(G()->td_db()->get_binlog_pmc_shared(), id));
 }
 
+int32 SecretChatsManager::get_chat_actor_scheduler_id(int32 id) {
+  if (chat_actor_scheduler_ids_.empty()) {
+    // the database scheduler is left for database queries, which can block for a long time
+    auto database_scheduler_id = G()->get_database_scheduler_id();
+    for (auto scheduler_id :
+         {Scheduler::instance()->sched_id(), G()->get_gc_scheduler_id(), G()->get_slow_net_scheduler_id()}) {
+      if (scheduler_id != database_scheduler_id && !td::contains(chat_actor_scheduler_ids_, scheduler_id)) {
+        chat_actor_scheduler_ids_.push_back(scheduler_id);
+      }
+    }
+    if (chat_actor_scheduler_ids_.empty()) {
+      chat_actor_scheduler_ids_.push_back(Scheduler::instance()->sched_id());
+    }
+  }
+  // all events of a secret chat are handled by the same actor, so their order is preserved
+  return chat_actor_scheduler_ids_[static_cast<uint32>(id) % chat_actor_scheduler_ids_.size()];
+}
+
 ActorId<SecretChatActor> SecretChatsManager::create_chat_actor_impl(int32 id, bool can_be_empty) {
   if (id == 0) {
     return Auto();
@@ -431,7 +450,8 @@ ActorId<SecretChatActor> SecretChatsManager::create_chat_actor_impl(int32 id, bo
   if (it_flag.second) {
     LOG(INFO) << "Create SecretChatActor: " << tag("id", id);
     it_flag.first->second =
-        create_actor<SecretChatActor>(PSLICE() << "SecretChat " << id, id, make_secret_chat_context(id), can_be_empty);
+        create_actor_on_scheduler<SecretChatActor>(PSLICE() << "SecretChat " << id, get_chat_actor_scheduler_id(id),
+                                                   id, make_secret_chat_context(id), can_be_empty);
     if (binlog_replay_finish_flag_) {
       send_closure(it_flag.first->second, &SecretChatActor::binlog_replay_finish);
     }
@@ -55,6 +55,7 @@ class SecretChatsManager final : public Actor {
   bool close_flag_ = false;
   ActorShared<> parent_;
   std::map<int32, ActorOwn<SecretChatActor>> id_to_actor_;
+  vector<int32> chat_actor_scheduler_ids_;
 
   bool is_online_{false};
 
@@ -74,6 +75,7 @@ class SecretChatsManager final : public Actor {
   void replay_create_chat(unique_ptr<log_event::CreateSecretChat> message);
 
   unique_ptr<SecretChatActor::Context> make_secret_chat_context(int32 id);
+  int32 get_chat_actor_scheduler_id(int32 id);
   ActorId<SecretChatActor> get_chat_actor(int32 id);
   ActorId<SecretChatActor> create_chat_actor(int32 id);
   ActorId<SecretChatActor> create_chat_actor_impl(int32 id, bool can_be_empty);
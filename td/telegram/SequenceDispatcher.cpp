@@ -151,7 +151,7 @@ void SequenceDispatcher::on_result(NetQueryPtr query) {
   if (query->is_error() && (query->error().code() == NetQuery::ResendInvokeAfter ||
                             (query->error().code() == 400 && (query->error().message() == "MSG_WAIT_FAILED" ||
                                                               query->error().message() == "MSG_WAIT_TIMEOUT")))) {
-    VLOG(net_query) << "Resend " << query;
+    VLOG_NET_QUERY(query) << "Resend " << query;
     query->resend();
     query->debug("Waiting at SequenceDispatcher");
     data.query_ = std::move(query);
@@ -184,7 +184,7 @@ void SequenceDispatcher::loop() {
     }
     data_[next_i_].query_->last_timeout_ = 0;
 
-    VLOG(net_query) << "Send " << data_[next_i_].query_;
+    VLOG_NET_QUERY(data_[next_i_].query_) << "Send " << data_[next_i_].query_;
 
     data_[next_i_].query_->debug("send to Td::send_with_callback");
     G()->net_query_dispatcher().dispatch_with_callback(std::move(data_[next_i_].query_),
@@ -303,6 +303,14 @@ class MultiSequenceDispatcherImpl final : public MultiSequenceDispatcher {
     loop();
   }
 
+  void update_window() final {
+    auto window = narrow_cast<int32>(clamp(G()->get_option_integer("sequence_dispatcher_window", DEFAULT_WINDOW),
+                                           static_cast<int64>(1), static_cast<int64>(MAX_WINDOW)));
+    LOG(INFO) << "Set sequence dispatcher window to " << window;
+    scheduler_.set_max_active_tasks(static_cast<uint32>(window));
+    loop();
+  }
+
  private:
   struct Node {
     NetQueryRef net_query_ref;
@@ -369,7 +377,7 @@ class MultiSequenceDispatcherImpl final : public MultiSequenceDispatcher {
     if (query->is_error() && (query->error().code() == NetQuery::ResendInvokeAfter ||
                               (query->error().code() == 400 && (query->error().message() == "MSG_WAIT_FAILED" ||
                                                                 query->error().message() == "MSG_WAIT_TIMEOUT")))) {
-      VLOG(net_query) << "Resend " << query;
+      VLOG_NET_QUERY(query) << "Resend " << query;
       query->resend();
       do_resend(task_id, node, std::move(query));
       loop();
@@ -415,6 +423,10 @@ class MultiSequenceDispatcherImpl final : public MultiSequenceDispatcher {
     }
   }
 
+  void start_up() final {
+    update_window();
+  }
+
   void loop() final {
     flush_pending_queries();
   }
@@ -93,7 +93,15 @@ class MultiSequenceDispatcherOld final : public SequenceDispatcher::Parent {
 
 class MultiSequenceDispatcher : public NetQueryCallback {
  public:
+  // default maximum number of simultaneously sent queries in a chain
+  static constexpr int32 DEFAULT_WINDOW = 10;
+  static constexpr int32 MAX_WINDOW = 100;
+
   virtual void send(NetQueryPtr query) = 0;
+
+  // rereads the option "sequence_dispatcher_window"
+  virtual void update_window() = 0;
+
   static ActorOwn<MultiSequenceDispatcher> create(Slice name);
 };
 
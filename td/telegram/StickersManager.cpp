@@ -23,6 +23,7 @@
 #include "td/telegram/LanguagePackManager.h"
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/logevent/LogEventHelper.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessagesManager.h"
 #include "td/telegram/misc.h"
 #include "td/telegram/net/DcId.h"
@@ -67,6 +68,7 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <mutex>
 #include <type_traits>
 
 namespace td {
@@ -713,10 +715,65 @@ class ReorderStickerSetsQuery final : public Td::ResultHandler {
   }
 };
 
+namespace {
+
+// messages.stickerSet responses, shared between all clients in the process to avoid repeated loading of the same
+// popular sticker sets; only raw responses can be shared, because parsed sticker sets reference client file identifiers
+struct SharedStickerSets {
+  struct Entry {
+    int64 access_hash = 0;
+    double receive_time = 0.0;
+    string packet;
+  };
+  std::mutex mutex;
+  FlatHashMap<int64, Entry> entries;
+};
+
+constexpr double SHARED_STICKER_SET_CACHE_TIME = 3600.0;
+
+constexpr size_t MAX_SHARED_STICKER_SETS = 1000;
+
+SharedStickerSets &get_shared_sticker_sets() {
+  static SharedStickerSets sticker_sets;
+  return sticker_sets;
+}
+
+BufferSlice get_shared_sticker_set_packet(int64 sticker_set_id, int64 access_hash) {
+  auto &sticker_sets = get_shared_sticker_sets();
+  std::lock_guard<std::mutex> lock(sticker_sets.mutex);
+  auto it = sticker_sets.entries.find(sticker_set_id);
+  if (it == sticker_sets.entries.end() || it->second.access_hash != access_hash ||
+      it->second.receive_time < Time::now() - SHARED_STICKER_SET_CACHE_TIME) {
+    return BufferSlice();
+  }
+  return BufferSlice(it->second.packet);
+}
+
+void add_shared_sticker_set_packet(int64 sticker_set_id, int64 access_hash, Slice packet) {
+  auto &sticker_sets = get_shared_sticker_sets();
+  std::lock_guard<std::mutex> lock(sticker_sets.mutex);
+  if (sticker_sets.entries.size() >= MAX_SHARED_STICKER_SETS && sticker_sets.entries.count(sticker_set_id) == 0) {
+    auto oldest_it = sticker_sets.entries.begin();
+    for (auto it = sticker_sets.entries.begin(); it != sticker_sets.entries.end(); ++it) {
+      if (it->second.receive_time < oldest_it->second.receive_time) {
+        oldest_it = it;
+      }
+    }
+    sticker_sets.entries.erase(oldest_it);
+  }
+  auto &entry = sticker_sets.entries[sticker_set_id];
+  entry.access_hash = access_hash;
+  entry.receive_time = Time::now();
+  entry.packet = packet.str();
+}
+
+}  // namespace
+
 class GetStickerSetQuery final : public Td::ResultHandler {
   Promise<Unit> promise_;
   StickerSetId sticker_set_id_;
   string sticker_set_name_;
+  bool is_shared_ = false;
 
  public:
   explicit GetStickerSetQuery(Promise<Unit> &&promise) : promise_(std::move(promise)) {
@@ -732,6 +789,12 @@ class GetStickerSetQuery final : public Td::ResultHandler {
         G()->net_query_creator().create(telegram_api::messages_getStickerSet(std::move(input_sticker_set), hash)));
   }
 
+  void send_shared(StickerSetId sticker_set_id, BufferSlice packet) {
+    sticker_set_id_ = sticker_set_id;
+    is_shared_ = true;
+    on_result(std::move(packet));
+  }
+
   void on_result(BufferSlice packet) final {
     auto result_ptr = fetch_result<telegram_api::messages_getStickerSet>(packet);
     if (result_ptr.is_error()) {
@@ -749,6 +812,8 @@ class GetStickerSetQuery final : public Td::ResultHandler {
           set->set_->id_ = StickersManager::GREAT_MINDS_SET_ID;
           set->set_->short_name_ = std::move(great_minds_name);
         }
+      } else if (!is_shared_ && G()->get_option_boolean("use_shared_sticker_set_cache")) {
+        add_shared_sticker_set_packet(set->set_->id_, set->set_->access_hash_, packet.as_slice());
       }
     }
 
@@ -1695,13 +1760,26 @@ StickersManager::StickersManager(Td *td, ActorShared<> parent) : td_(td), parent
 
   next_click_animated_emoji_message_time_ = Time::now();
   next_update_animated_emoji_clicked_time_ = Time::now();
+
+  reload_custom_emoji_queries_.set_merge_function([this](vector<int64> query_ids, Promise<Unit> &&promise) {
+    TRY_STATUS_PROMISE(promise, G()->close_status());
+    auto custom_emoji_ids = transform(query_ids, [](int64 query_id) { return CustomEmojiId(query_id); });
+    auto query_promise = PromiseCreator::lambda(
+        [actor_id = actor_id(this), promise = std::move(promise)](
+            Result<vector<telegram_api::object_ptr<telegram_api::Document>>> r_documents) mutable {
+          send_closure(actor_id, &StickersManager::on_get_custom_emoji_documents, std::move(r_documents),
+                       vector<CustomEmojiId>(), Promise<td_api::object_ptr<td_api::stickers>>());
+          promise.set_value(Unit());
+        });
+    td_->create_handler<GetCustomEmojiDocumentsQuery>(std::move(query_promise))->send(std::move(custom_emoji_ids));
+  });
 }
 
 StickersManager::~StickersManager() {
   Scheduler::instance()->destroy_on_scheduler(
       G()->get_gc_scheduler_id(), stickers_, sticker_sets_, short_name_to_sticker_set_id_, attached_sticker_sets_,
       found_stickers_[0], found_stickers_[1], found_stickers_[2], found_sticker_sets_[0], found_sticker_sets_[1],
-      found_sticker_sets_[2], emoji_language_codes_, emoji_language_code_versions_,
+      found_sticker_sets_[2], emoji_language_codes_, emoji_language_code_versions_, emoji_keyword_indexes_,
       emoji_language_code_last_difference_times_, reloaded_emoji_keywords_, premium_gift_messages_, dice_messages_,
       dice_quick_reply_messages_, emoji_messages_, custom_emoji_messages_, custom_emoji_to_sticker_id_);
 }
@@ -2624,7 +2702,7 @@ tl_object_ptr<td_api::stickerSetInfo> StickersManager::get_sticker_set_info_obje
     vector<FileId> regular_sticker_ids;
     vector<FileId> premium_sticker_ids;
     std::tie(regular_sticker_ids, premium_sticker_ids) = split_stickers_by_premium(sticker_set);
-    auto is_premium = td_->option_manager_->get_option_boolean("is_premium");
+    auto is_premium = td_->option_manager_->get_option_boolean(CachedOption::IsPremium);
     size_t max_premium_stickers = is_premium ? covers_limit : 1;
     if (premium_sticker_ids.size() > max_premium_stickers) {
       premium_sticker_ids.resize(max_premium_stickers);
@@ -4537,7 +4615,7 @@ vector<FileId> StickersManager::get_stickers(StickerType sticker_type, string qu
       vector<FileId> regular_sticker_ids;
       vector<FileId> premium_sticker_ids;
       std::tie(regular_sticker_ids, premium_sticker_ids) = split_stickers_by_premium(result);
-      if (td_->option_manager_->get_option_boolean("is_premium") || allow_premium) {
+      if (td_->option_manager_->get_option_boolean(CachedOption::IsPremium) || allow_premium) {
         auto normal_count = td_->option_manager_->get_option_integer("stickers_normal_by_emoji_per_premium_num", 2);
         if (normal_count < 0) {
           normal_count = 2;
@@ -5543,10 +5621,31 @@ void StickersManager::do_reload_sticker_set(StickerSetId sticker_set_id,
     promise = PromiseCreator::lambda([actor_id = actor_id(this), sticker_set_id](Result<Unit> result) mutable {
       send_closure(actor_id, &StickersManager::on_reload_sticker_set, sticker_set_id, std::move(result));
     });
+
+    // only the first load of a sticker set can be done from the shared cache, because reloads are needed to get
+    // new file references and sticker set changes
+    const StickerSet *sticker_set = get_sticker_set(sticker_set_id);
+    if ((sticker_set == nullptr || !sticker_set->was_loaded_) &&
+        G()->get_option_boolean("use_shared_sticker_set_cache")) {
+      auto input_sticker_set_id = static_cast<const telegram_api::inputStickerSetID *>(input_sticker_set.get());
+      auto packet = get_shared_sticker_set_packet(input_sticker_set_id->id_, input_sticker_set_id->access_hash_);
+      if (!packet.empty()) {
+        LOG(INFO) << "Load " << sticker_set_id << " from the shared cache";
+        send_closure_later(actor_id(this), &StickersManager::on_get_shared_sticker_set, sticker_set_id,
+                           std::move(packet), std::move(promise));
+        return;
+      }
+    }
   }
   td_->create_handler<GetStickerSetQuery>(std::move(promise))->send(sticker_set_id, std::move(input_sticker_set), hash);
 }
 
+void StickersManager::on_get_shared_sticker_set(StickerSetId sticker_set_id, BufferSlice packet,
+                                                Promise<Unit> &&promise) {
+  TRY_STATUS_PROMISE(promise, G()->close_status());
+  td_->create_handler<GetStickerSetQuery>(std::move(promise))->send_shared(sticker_set_id, std::move(packet));
+}
+
 void StickersManager::on_reload_sticker_set(StickerSetId sticker_set_id, Result<Unit> &&result) {
   G()->ignore_result_if_closing(result);
   LOG(INFO) << "Reloaded " << sticker_set_id;
@@ -6329,13 +6428,7 @@ td_api::object_ptr<td_api::sticker> StickersManager::get_custom_emoji_sticker_ob
   if (s->emoji_receive_date_ < G()->unix_time() - 86400 && !s->is_being_reloaded_) {
     s->is_being_reloaded_ = true;
     LOG(INFO) << "Reload " << custom_emoji_id;
-    auto promise = PromiseCreator::lambda(
-        [actor_id =
-             actor_id(this)](Result<vector<telegram_api::object_ptr<telegram_api::Document>>> r_documents) mutable {
-          send_closure(actor_id, &StickersManager::on_get_custom_emoji_documents, std::move(r_documents),
-                       vector<CustomEmojiId>(), Promise<td_api::object_ptr<td_api::stickers>>());
-        });
-    td_->create_handler<GetCustomEmojiDocumentsQuery>(std::move(promise))->send({custom_emoji_id});
+    reload_custom_emoji_queries_.add_query(custom_emoji_id.get(), Auto(), "get_custom_emoji_sticker_object");
   }
   return get_sticker_object(file_id);
 }
@@ -6363,13 +6456,9 @@ td_api::object_ptr<td_api::stickers> StickersManager::get_custom_emoji_stickers_
   }
   if (!reload_custom_emoji_ids.empty()) {
     LOG(INFO) << "Reload " << reload_custom_emoji_ids;
-    auto promise = PromiseCreator::lambda(
-        [actor_id =
-             actor_id(this)](Result<vector<telegram_api::object_ptr<telegram_api::Document>>> r_documents) mutable {
-          send_closure(actor_id, &StickersManager::on_get_custom_emoji_documents, std::move(r_documents),
-                       vector<CustomEmojiId>(), Promise<td_api::object_ptr<td_api::stickers>>());
-        });
-    td_->create_handler<GetCustomEmojiDocumentsQuery>(std::move(promise))->send(std::move(reload_custom_emoji_ids));
+    for (auto custom_emoji_id : reload_custom_emoji_ids) {
+      reload_custom_emoji_queries_.add_query(custom_emoji_id.get(), Auto(), "get_custom_emoji_stickers_object");
+    }
   }
   return td_api::make_object<td_api::stickers>(std::move(stickers));
 }
@@ -9669,17 +9758,40 @@ string StickersManager::get_language_emojis_database_key(const string &language_
   return PSTRING() << "emoji$" << language_code << '$' << text;
 }
 
+const vector<std::pair<string, string>> &StickersManager::get_emoji_keyword_index(const string &language_code) {
+  auto it = emoji_keyword_indexes_.find(language_code);
+  if (it != emoji_keyword_indexes_.end()) {
+    return it->second;
+  }
+
+  vector<std::pair<string, string>> keywords;
+  auto key = get_language_emojis_database_key(language_code, string());
+  G()->td_db()->get_sqlite_sync_pmc()->get_by_prefix(key, [&keywords](Slice key, Slice value) {
+    keywords.emplace_back(key.str(), value.str());
+    return true;
+  });
+  std::sort(keywords.begin(), keywords.end());
+  LOG(INFO) << "Load " << keywords.size() << " emoji keywords for language " << language_code;
+
+  auto &result = emoji_keyword_indexes_[language_code];
+  result = std::move(keywords);
+  return result;
+}
+
 vector<std::pair<string, string>> StickersManager::search_language_emojis(const string &language_code,
                                                                           const string &text) {
   LOG(INFO) << "Search emoji for \"" << text << "\" in language " << language_code;
-  auto key = get_language_emojis_database_key(language_code, text);
+  const auto &keywords = get_emoji_keyword_index(language_code);
   vector<std::pair<string, string>> result;
-  G()->td_db()->get_sqlite_sync_pmc()->get_by_prefix(key, [&text, &result](Slice key, Slice value) {
-    for (const auto &emoji : full_split(value, '$')) {
-      result.emplace_back(emoji.str(), PSTRING() << text << key);
+  auto it = std::lower_bound(keywords.begin(), keywords.end(), text,
+                             [](const std::pair<string, string> &keyword, const string &text) {
+                               return keyword.first < text;
+                             });
+  for (; it != keywords.end() && begins_with(it->first, text); ++it) {
+    for (auto &emoji : full_split(it->second, '$')) {
+      result.emplace_back(std::move(emoji), it->first);
     }
-    return true;
-  });
+  }
   return result;
 }
 
@@ -9882,6 +9994,8 @@ void StickersManager::on_get_emoji_keywords(
     LOG(ERROR) << "Receive keywords of version " << version;
     version = 1;
   }
+  // the keywords are saved to the database asynchronously, so the index must be built from them directly
+  FlatHashMap<string, string> keyword_emojis;
   for (auto &keyword_ptr : keywords->keywords_) {
     switch (keyword_ptr->get_id()) {
       case telegram_api::emojiKeyword::ID: {
@@ -9896,8 +10010,10 @@ void StickersManager::on_get_emoji_keywords(
         }
         if (is_good && !G()->close_flag()) {
           CHECK(G()->use_sqlite_pmc());
-          G()->td_db()->get_sqlite_pmc()->set(get_language_emojis_database_key(language_code, text),
-                                              implode(keyword->emoticons_, '$'), mpas.get_promise());
+          auto emojis = implode(keyword->emoticons_, '$');
+          G()->td_db()->get_sqlite_pmc()->set(get_language_emojis_database_key(language_code, text), emojis,
+                                              mpas.get_promise());
+          keyword_emojis[text] = std::move(emojis);
         }
         break;
       }
@@ -9918,6 +10034,13 @@ void StickersManager::on_get_emoji_keywords(
   emoji_language_code_versions_[language_code] = version;
   emoji_language_code_last_difference_times_[language_code] = static_cast<int32>(Time::now_cached());
 
+  auto &index = emoji_keyword_indexes_[language_code];
+  index.clear();
+  for (auto &it : keyword_emojis) {
+    index.emplace_back(it.first, std::move(it.second));
+  }
+  std::sort(index.begin(), index.end());
+
   lock.set_value(Unit());
 }
 
@@ -10033,6 +10156,7 @@ void StickersManager::finish_get_emoji_keywords_difference(string language_code,
 
   LOG(INFO) << "Finished to get emoji keywords difference for language " << language_code;
   emoji_language_code_versions_[language_code] = version;
+  emoji_keyword_indexes_.erase(language_code);  // will be reloaded from the updated database
   emoji_language_code_last_difference_times_[language_code] = static_cast<int32>(Time::now_cached());
 }
 
@@ -10310,6 +10434,11 @@ void StickersManager::on_get_emoji_groups(
   }
 }
 
+void StickersManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  statistics.add_objects<Sticker>("stickers_manager.stickers", stickers_.calc_size());
+  statistics.add_objects<StickerSet>("stickers_manager.sticker_sets", sticker_sets_.calc_size());
+}
+
 void StickersManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   if (td_->auth_manager_->is_bot()) {
     return;
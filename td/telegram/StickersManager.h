@@ -16,6 +16,7 @@
 #include "td/telegram/MessageFullId.h"
 #include "td/telegram/PhotoFormat.h"
 #include "td/telegram/PhotoSize.h"
+#include "td/telegram/QueryMerger.h"
 #include "td/telegram/QuickReplyMessageFullId.h"
 #include "td/telegram/SecretInputMedia.h"
 #include "td/telegram/SpecialStickerSetType.h"
@@ -52,6 +53,7 @@
 
 namespace td {
 
+class MemoryStatistics;
 class Td;
 
 class StickersManager final : public Actor {
@@ -435,6 +437,8 @@ class StickersManager final : public Actor {
 
   void send_get_attached_stickers_query(FileId file_id, Promise<Unit> &&promise);
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
   template <class StorerT>
@@ -698,6 +702,8 @@ class StickersManager final : public Actor {
 
   void on_reload_sticker_set(StickerSetId sticker_set_id, Result<Unit> &&result);
 
+  void on_get_shared_sticker_set(StickerSetId sticker_set_id, BufferSlice packet, Promise<Unit> &&promise);
+
   void do_get_premium_stickers(int32 limit, Promise<td_api::object_ptr<td_api::stickers>> &&promise);
 
   static void read_featured_sticker_sets(void *td_void);
@@ -962,7 +968,9 @@ class StickersManager final : public Actor {
 
   void on_get_language_codes(const string &key, Result<vector<string>> &&result);
 
-  static vector<std::pair<string, string>> search_language_emojis(const string &language_code, const string &text);
+  const vector<std::pair<string, string>> &get_emoji_keyword_index(const string &language_code);
+
+  vector<std::pair<string, string>> search_language_emojis(const string &language_code, const string &text);
 
   static vector<string> get_keyword_language_emojis(const string &language_code, const string &text);
 
@@ -1121,6 +1129,7 @@ class StickersManager final : public Actor {
 
   FlatHashMap<string, vector<string>> emoji_language_codes_;
   FlatHashMap<string, int32> emoji_language_code_versions_;
+  FlatHashMap<string, vector<std::pair<string, string>>> emoji_keyword_indexes_;  // sorted keyword -> emojis
   FlatHashMap<string, double> emoji_language_code_last_difference_times_;
   FlatHashSet<string> reloaded_emoji_keywords_;
   FlatHashMap<string, vector<Promise<Unit>>> load_emoji_keywords_queries_;
@@ -1173,6 +1182,9 @@ class StickersManager final : public Actor {
 
   WaitFreeHashMap<CustomEmojiId, FileId, CustomEmojiIdHash> custom_emoji_to_sticker_id_;
 
+  // custom emoji are reloaded one by one when they are shown, so merge the reloads
+  QueryMerger reload_custom_emoji_queries_{"ReloadCustomEmojiMerger", 3, MAX_GET_CUSTOM_EMOJI_STICKERS, 0.05};
+
   double animated_emoji_zoom_ = 0.625;
 
   bool disable_animated_emojis_ = false;
@@ -6,6 +6,7 @@
 //
 #include "td/telegram/StorageManager.h"
 
+#include "td/telegram/DatabaseVacuumWorker.h"
 #include "td/telegram/DialogId.h"
 #include "td/telegram/files/FileGcWorker.h"
 #include "td/telegram/files/FileStatsWorker.h"
@@ -40,11 +41,14 @@ void StorageManager::start_up() {
   schedule_next_gc();
 
   load_fast_stat();
+  load_stat_index();
+
+  create_vacuum_worker();
 }
 
-void StorageManager::on_new_file(int64 size, int64 real_size, int32 cnt) {
-  LOG(INFO) << "Add " << cnt << " file of size " << size << " with real size " << real_size
-            << " to fast storage statistics";
+void StorageManager::on_new_file(FileType file_type, int64 size, int64 real_size, int32 cnt) {
+  LOG(INFO) << "Add " << cnt << " file of type " << file_type << " and size " << size << " with real size "
+            << real_size << " to fast storage statistics";
   fast_stat_.cnt += cnt;
 #if TD_WINDOWS
   auto add_size = size;
@@ -58,12 +62,26 @@ void StorageManager::on_new_file(int64 size, int64 real_size, int32 cnt) {
     fast_stat_ = FileTypeStat();
   }
   save_fast_stat();
+
+  if (stat_index_.scan_date != 0) {
+    stat_index_.add_file(file_type, add_size, cnt);
+    save_stat_index();
+  }
 }
 
 void StorageManager::get_storage_stats(bool need_all_files, int32 dialog_limit, Promise<FileStats> promise) {
   if (is_closed_) {
     return promise.set_error(Global::request_aborted_error());
   }
+  if (!need_all_files && dialog_limit == 0 && stat_index_.scan_date != 0) {
+    // statistics by file type can be returned from the index without scanning of files directories
+    if (stat_index_.scan_date < G()->unix_time() - STAT_INDEX_RECONCILE_DELAY) {
+      reconcile_stat_index();
+    }
+    vector<Promise<FileStats>> promises;
+    promises.push_back(std::move(promise));
+    return send_stats(FileStats(stat_index_), dialog_limit, std::move(promises));
+  }
   if (!pending_storage_stats_.empty()) {
     if (stats_dialog_limit_ == dialog_limit && need_all_files == stats_need_all_files_) {
       pending_storage_stats_.emplace_back(std::move(promise));
@@ -138,6 +156,7 @@ void StorageManager::on_file_stats(Result<FileStats> r_file_stats, uint32 genera
   }
 
   update_fast_stats(r_file_stats.ok());
+  update_stat_index(r_file_stats.ok());
   send_stats(r_file_stats.move_as_ok(), stats_dialog_limit_, std::move(pending_storage_stats_));
 }
 
@@ -156,14 +175,16 @@ void StorageManager::on_all_files(FileGcParameters gc_parameters, Result<FileSta
     r_file_stats = Global::request_aborted_error();
   }
   if (r_file_stats.is_error()) {
-    return on_gc_finished(dialog_limit, r_file_stats.move_as_error());
+    return on_gc_finished(dialog_limit, r_file_stats.move_as_error(), gc_generation_);
   }
 
   create_gc_worker();
 
   send_closure(gc_worker_, &FileGcWorker::run_gc, std::move(gc_parameters), r_file_stats.ok_ref().get_all_files(),
-               PromiseCreator::lambda([actor_id = actor_id(this), dialog_limit](Result<FileGcResult> r_file_gc_result) {
-                 send_closure(actor_id, &StorageManager::on_gc_finished, dialog_limit, std::move(r_file_gc_result));
+               PromiseCreator::lambda([actor_id = actor_id(this), dialog_limit,
+                                       gc_generation = gc_generation_](Result<FileGcResult> r_file_gc_result) {
+                 send_closure(actor_id, &StorageManager::on_gc_finished, dialog_limit, std::move(r_file_gc_result),
+                              gc_generation);
                }));
 }
 
@@ -209,7 +230,25 @@ void StorageManager::create_gc_worker() {
   }
 }
 
-void StorageManager::on_gc_finished(int32 dialog_limit, Result<FileGcResult> r_file_gc_result) {
+void StorageManager::create_vacuum_worker() {
+  CHECK(!is_closed_);
+  auto connection = G()->td_db()->get_sqlite_connection_safe();
+  if (connection != nullptr && vacuum_worker_.empty()) {
+    vacuum_worker_ = create_actor_on_scheduler<DatabaseVacuumWorker>("DatabaseVacuumWorker", scheduler_id_,
+                                                                     create_reference(), std::move(connection));
+  }
+}
+
+void StorageManager::on_gc_progress(int32 deleted_file_count, int32 total_file_count, int64 deleted_size) {
+  LOG(INFO) << "Deleted " << deleted_file_count << " out of " << total_file_count << " files of total size "
+            << deleted_size << " during files GC";
+}
+
+void StorageManager::on_gc_finished(int32 dialog_limit, Result<FileGcResult> r_file_gc_result, uint32 generation) {
+  if (generation != gc_generation_) {
+    // the files GC was restarted or cancelled, and its promises have already been failed
+    return;
+  }
   if (r_file_gc_result.is_error()) {
     if (r_file_gc_result.error().code() != 500) {
       LOG(ERROR) << "GC failed: " << r_file_gc_result.error();
@@ -223,6 +262,7 @@ void StorageManager::on_gc_finished(int32 dialog_limit, Result<FileGcResult> r_f
   }
 
   update_fast_stats(r_file_gc_result.ok().kept_file_stats_);
+  update_stat_index(r_file_gc_result.ok().kept_file_stats_);
 
   auto kept_file_promises = std::move(pending_run_gc_[0]);
   auto removed_file_promises = std::move(pending_run_gc_[1]);
@@ -249,6 +289,48 @@ void StorageManager::update_fast_stats(const FileStats &stats) {
   save_fast_stat();
 }
 
+void StorageManager::update_stat_index(const FileStats &stats) {
+  stat_index_.stat_by_type = stats.get_total_stat_by_type();
+  stat_index_.scan_date = G()->unix_time();
+  save_stat_index();
+}
+
+void StorageManager::reconcile_stat_index() {
+  if (is_stat_index_reconciling_ || !pending_storage_stats_.empty()) {
+    return;
+  }
+  LOG(INFO) << "Reconcile storage statistics index built at " << stat_index_.scan_date;
+  is_stat_index_reconciling_ = true;
+  create_stats_worker();
+  send_closure(stats_worker_, &FileStatsWorker::get_stats, false, false,
+               PromiseCreator::lambda(
+                   [actor_id = actor_id(this), stats_generation = stats_generation_](Result<FileStats> file_stats) {
+                     send_closure(actor_id, &StorageManager::on_stat_index_reconciled, std::move(file_stats),
+                                  stats_generation);
+                   }));
+}
+
+void StorageManager::on_stat_index_reconciled(Result<FileStats> r_file_stats, uint32 generation) {
+  is_stat_index_reconciling_ = false;
+  if (generation != stats_generation_ || r_file_stats.is_error()) {
+    return;
+  }
+  update_fast_stats(r_file_stats.ok());
+  update_stat_index(r_file_stats.ok());
+}
+
+void StorageManager::save_stat_index() {
+  G()->td_db()->get_binlog_pmc()->set("file_stat_index", log_event_store(stat_index_).as_slice().str());
+}
+
+void StorageManager::load_stat_index() {
+  auto status = log_event_parse(stat_index_, G()->td_db()->get_binlog_pmc()->get("file_stat_index"));
+  if (status.is_error()) {
+    stat_index_ = FileStatsIndex();
+  }
+  LOG(INFO) << "Loaded storage statistics index built at " << stat_index_.scan_date;
+}
+
 void StorageManager::send_stats(FileStats &&stats, int32 dialog_limit, std::vector<Promise<FileStats>> &&promises) {
   if (promises.empty()) {
     return;
@@ -298,6 +380,7 @@ void StorageManager::close_gc_worker() {
   pending_run_gc_[0].clear();
   pending_run_gc_[1].clear();
   fail_promises(promises, Global::request_aborted_error());
+  gc_generation_++;
   gc_worker_.reset();
   gc_cancellation_token_source_.cancel();
 }
@@ -306,6 +389,7 @@ void StorageManager::hangup() {
   is_closed_ = true;
   close_stats_worker();
   close_gc_worker();
+  vacuum_worker_.reset();
   hangup_shared();
 }
 
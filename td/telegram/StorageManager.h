@@ -6,9 +6,11 @@
 //
 #pragma once
 
+#include "td/telegram/DatabaseVacuumWorker.h"
 #include "td/telegram/files/FileGcWorker.h"
 #include "td/telegram/files/FileStats.h"
 #include "td/telegram/files/FileStatsWorker.h"
+#include "td/telegram/files/FileType.h"
 #include "td/telegram/td_api.h"
 
 #include "td/actor/actor.h"
@@ -38,13 +40,18 @@ class StorageManager final : public Actor {
   void run_gc(FileGcParameters parameters, bool return_deleted_file_statistics, Promise<FileStats> promise);
   void update_use_storage_optimizer();
 
-  void on_new_file(int64 size, int64 real_size, int32 cnt);
+  void on_new_file(FileType file_type, int64 size, int64 real_size, int32 cnt);
+
+  void on_gc_progress(int32 deleted_file_count, int32 total_file_count, int64 deleted_size);
 
  private:
   static constexpr int GC_EACH = 60 * 60 * 24;  // 1 day
   static constexpr int GC_DELAY = 60;
   static constexpr int GC_RAND_DELAY = 60 * 15;
 
+  // the index is reconciled with the file system in background if it is older
+  static constexpr int32 STAT_INDEX_RECONCILE_DELAY = 60 * 60;  // 1 hour
+
   ActorShared<> parent_;
 
   int32 scheduler_id_;
@@ -58,6 +65,9 @@ class StorageManager final : public Actor {
 
   FileTypeStat fast_stat_;
 
+  FileStatsIndex stat_index_;
+  bool is_stat_index_reconciling_ = false;
+
   CancellationTokenSource stats_cancellation_token_source_;
   CancellationTokenSource gc_cancellation_token_source_;
 
@@ -68,6 +78,12 @@ class StorageManager final : public Actor {
 
   void save_fast_stat();
   void load_fast_stat();
+
+  void update_stat_index(const FileStats &stats);
+  void reconcile_stat_index();
+  void on_stat_index_reconciled(Result<FileStats> r_file_stats, uint32 generation);
+  void save_stat_index();
+  void load_stat_index();
   static int64 get_database_size();
   static int64 get_language_pack_database_size();
   static int64 get_log_size();
@@ -84,13 +100,14 @@ class StorageManager final : public Actor {
   // Gc
   ActorOwn<FileGcWorker> gc_worker_;
   std::vector<Promise<FileStats>> pending_run_gc_[2];
+  uint32 gc_generation_{0};
 
   uint32 last_gc_timestamp_ = 0;
   double next_gc_at_ = 0;
 
   void on_all_files(FileGcParameters gc_parameters, Result<FileStats> r_file_stats);
   void create_gc_worker();
-  void on_gc_finished(int32 dialog_limit, Result<FileGcResult> r_file_gc_result);
+  void on_gc_finished(int32 dialog_limit, Result<FileGcResult> r_file_gc_result, uint32 generation);
 
   void close_stats_worker();
   void close_gc_worker();
@@ -100,6 +117,11 @@ class StorageManager final : public Actor {
   void schedule_next_gc();
 
   void timeout_expired() final;
+
+  // Vacuum
+  ActorOwn<DatabaseVacuumWorker> vacuum_worker_;
+
+  void create_vacuum_worker();
 };
 
 }  // namespace td
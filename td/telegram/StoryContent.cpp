@@ -506,6 +506,20 @@ FileId get_story_content_any_file_id(const StoryContent *content) {
   }
 }
 
+FileId get_story_content_thumbnail_file_id(const Td *td, const StoryContent *content) {
+  switch (content->get_type()) {
+    case StoryContentType::Photo:
+      return get_photo_thumbnail_file_id(static_cast<const StoryContentPhoto *>(content)->photo_);
+    case StoryContentType::Video: {
+      const auto *s = static_cast<const StoryContentVideo *>(content);
+      return td->videos_manager_->get_video_thumbnail_file_id(s->file_id_);
+    }
+    case StoryContentType::Unsupported:
+    default:
+      return {};
+  }
+}
+
 vector<FileId> get_story_content_file_ids(const Td *td, const StoryContent *content) {
   switch (content->get_type()) {
     case StoryContentType::Photo:
@@ -68,6 +68,8 @@ td_api::object_ptr<td_api::StoryContent> get_story_content_object(Td *td, const
 
 FileId get_story_content_any_file_id(const StoryContent *content);
 
+FileId get_story_content_thumbnail_file_id(const Td *td, const StoryContent *content);
+
 vector<FileId> get_story_content_file_ids(const Td *td, const StoryContent *content);
 
 int32 get_story_content_duration(const Td *td, const StoryContent *content);
@@ -9,6 +9,7 @@
 #include "td/telegram/StoryId.h"
 #include "td/telegram/Version.h"
 
+#include "td/db/BlobCompression.h"
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteStatement.h"
@@ -80,7 +81,7 @@ Status drop_story_db(SqliteDb &db, int32 version) {
 
 class StoryDbImpl final : public StoryDbSyncInterface {
  public:
-  explicit StoryDbImpl(SqliteDb db) : db_(std::move(db)) {
+  StoryDbImpl(SqliteDb db, bool compress_data) : db_(std::move(db)), compress_data_(compress_data) {
     init().ensure();
   }
 
@@ -146,6 +147,12 @@ class StoryDbImpl final : public StoryDbSyncInterface {
     } else {
       add_story_stmt_.bind_null(4).ensure();
     }
+    if (compress_data_) {
+      auto compressed_data = compress_blob(data.as_slice());
+      if (!compressed_data.empty()) {
+        data = std::move(compressed_data);
+      }
+    }
     add_story_stmt_.bind_blob(5, data.as_slice()).ensure();
 
     add_story_stmt_.step().ensure();
@@ -178,7 +185,7 @@ class StoryDbImpl final : public StoryDbSyncInterface {
     if (!get_story_stmt_.has_row()) {
       return Status::Error("Not found");
     }
-    return BufferSlice(get_story_stmt_.view_blob(0));
+    return decompress_blob(get_story_stmt_.view_blob(0));
   }
 
   vector<StoryDbStory> get_expiring_stories(int32 expires_till, int32 limit) final {
@@ -195,7 +202,7 @@ class StoryDbImpl final : public StoryDbSyncInterface {
     while (stmt.has_row()) {
       DialogId dialog_id(stmt.view_int64(0));
       StoryId story_id(stmt.view_int32(1));
-      BufferSlice data(stmt.view_blob(2));
+      auto data = decompress_blob(stmt.view_blob(2));
       stories.emplace_back(StoryFullId{dialog_id, story_id}, std::move(data));
       stmt.step().ensure();
     }
@@ -217,7 +224,7 @@ class StoryDbImpl final : public StoryDbSyncInterface {
     vector<StoryDbStory> stories;
     while (stmt.has_row()) {
       StoryId story_id(stmt.view_int32(0));
-      BufferSlice data(stmt.view_blob(1));
+      auto data = decompress_blob(stmt.view_blob(1));
       stories.emplace_back(StoryFullId{dialog_id, story_id}, std::move(data));
       stmt.step().ensure();
     }
@@ -318,6 +325,7 @@ class StoryDbImpl final : public StoryDbSyncInterface {
 
  private:
   SqliteDb db_;
+  bool compress_data_ = false;
 
   SqliteStatement add_story_stmt_;
   SqliteStatement delete_story_stmt_;
@@ -335,12 +343,12 @@ class StoryDbImpl final : public StoryDbSyncInterface {
 };
 
 std::shared_ptr<StoryDbSyncSafeInterface> create_story_db_sync(
-    std::shared_ptr<SqliteConnectionSafe> sqlite_connection) {
+    std::shared_ptr<SqliteConnectionSafe> sqlite_connection, bool compress_data) {
   class StoryDbSyncSafe final : public StoryDbSyncSafeInterface {
    public:
-    explicit StoryDbSyncSafe(std::shared_ptr<SqliteConnectionSafe> sqlite_connection)
-        : lsls_db_([safe_connection = std::move(sqlite_connection)] {
-          return make_unique<StoryDbImpl>(safe_connection->get().clone());
+    StoryDbSyncSafe(std::shared_ptr<SqliteConnectionSafe> sqlite_connection, bool compress_data)
+        : lsls_db_([safe_connection = std::move(sqlite_connection), compress_data] {
+          return make_unique<StoryDbImpl>(safe_connection->get().clone(), compress_data);
         }) {
     }
     StoryDbSyncInterface &get() final {
@@ -350,7 +358,7 @@ std::shared_ptr<StoryDbSyncSafeInterface> create_story_db_sync(
    private:
     LazySchedulerLocalStorage<unique_ptr<StoryDbSyncInterface>> lsls_db_;
   };
-  return std::make_shared<StoryDbSyncSafe>(std::move(sqlite_connection));
+  return std::make_shared<StoryDbSyncSafe>(std::move(sqlite_connection), compress_data);
 }
 
 class StoryDbAsync final : public StoryDbAsyncInterface {
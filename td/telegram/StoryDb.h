@@ -125,7 +125,9 @@ class StoryDbAsyncInterface {
 Status init_story_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
 Status drop_story_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
 
-std::shared_ptr<StoryDbSyncSafeInterface> create_story_db_sync(std::shared_ptr<SqliteConnectionSafe> sqlite_connection);
+// if compress_data is true, then large story blobs are stored compressed; compressed blobs are always readable
+std::shared_ptr<StoryDbSyncSafeInterface> create_story_db_sync(std::shared_ptr<SqliteConnectionSafe> sqlite_connection,
+                                                               bool compress_data = false);
 
 std::shared_ptr<StoryDbAsyncInterface> create_story_db_async(std::shared_ptr<StoryDbSyncSafeInterface> sync_db,
                                                              int32 scheduler_id = -1);
@@ -2867,7 +2867,7 @@ bool StoryManager::can_use_story_reaction(const Story *story, const ReactionType
     return true;
   }
   if (reaction_type.is_custom_reaction()) {
-    if (td_->option_manager_->get_option_boolean("is_premium")) {
+    if (td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
       return true;
     }
     if (has_suggested_reaction(story, reaction_type)) {
@@ -4122,6 +4122,31 @@ std::pair<int32, vector<StoryId>> StoryManager::on_get_stories(
   return {total_count, std::move(story_ids)};
 }
 
+void StoryManager::preload_story_thumbnail(StoryFullId story_full_id) {
+  if (!td_->option_manager_->get_option_boolean("preload_story_thumbnails")) {
+    return;
+  }
+  const Story *story = get_story(story_full_id);
+  if (story == nullptr || story->content_ == nullptr) {
+    return;
+  }
+  auto file_id = get_story_content_thumbnail_file_id(td_, story->content_.get());
+  if (!file_id.is_valid()) {
+    return;
+  }
+  if (preloaded_story_thumbnail_file_ids_.size() >= MAX_PRELOADED_STORY_THUMBNAILS) {
+    preloaded_story_thumbnail_file_ids_.clear();
+  }
+  if (!preloaded_story_thumbnail_file_ids_.insert(file_id).second) {
+    return;
+  }
+
+  LOG(INFO) << "Preload thumbnail " << file_id << " of " << story_full_id;
+  // use the lowest priority to not slow down downloads requested by the user
+  send_closure(G()->file_manager(), &FileManager::download, file_id, nullptr, 1, -1, -1,
+               Promise<td_api::object_ptr<td_api::file>>());
+}
+
 DialogId StoryManager::on_get_dialog_stories(DialogId owner_dialog_id,
                                              telegram_api::object_ptr<telegram_api::peerStories> &&peer_stories,
                                              Promise<Unit> &&promise) {
@@ -4164,10 +4189,13 @@ DialogId StoryManager::on_get_dialog_stories(DialogId owner_dialog_id,
         story_ids.push_back(
             on_get_skipped_story(owner_dialog_id, telegram_api::move_object_as<telegram_api::storyItemSkipped>(story)));
         break;
-      case telegram_api::storyItem::ID:
-        story_ids.push_back(
-            on_get_new_story(owner_dialog_id, telegram_api::move_object_as<telegram_api::storyItem>(story)));
+      case telegram_api::storyItem::ID: {
+        auto story_id =
+            on_get_new_story(owner_dialog_id, telegram_api::move_object_as<telegram_api::storyItem>(story));
+        preload_story_thumbnail({owner_dialog_id, story_id});
+        story_ids.push_back(story_id);
         break;
+      }
       default:
         UNREACHABLE();
     }
@@ -5124,7 +5152,7 @@ void StoryManager::send_story(DialogId dialog_id, td_api::object_ptr<td_api::Inp
     forward_info->hide_sender_if_needed(td_);
   }
   if (active_period != 86400 && !(G()->is_test_dc() && (active_period == 60 || active_period == 300))) {
-    bool is_premium = td_->option_manager_->get_option_boolean("is_premium");
+    bool is_premium = td_->option_manager_->get_option_boolean(CachedOption::IsPremium);
     if (!is_premium || !td::contains(vector<int32>{6 * 3600, 12 * 3600, 2 * 86400}, active_period)) {
       return promise.set_error(Status::Error(400, "Invalid story active period specified"));
     }
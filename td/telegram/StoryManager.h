@@ -391,6 +391,8 @@ class StoryManager final : public Actor {
 
   static constexpr int32 DEFAULT_LOADED_EXPIRED_STORIES = 50;
 
+  static constexpr size_t MAX_PRELOADED_STORY_THUMBNAILS = 10000;
+
   void start_up() final;
 
   void timeout_expired() final;
@@ -488,6 +490,8 @@ class StoryManager final : public Actor {
 
   StoryId on_get_new_story(DialogId owner_dialog_id, telegram_api::object_ptr<telegram_api::storyItem> &&story_item);
 
+  void preload_story_thumbnail(StoryFullId story_full_id);
+
   StoryId on_get_skipped_story(DialogId owner_dialog_id,
                                telegram_api::object_ptr<telegram_api::storyItemSkipped> &&story_item);
 
@@ -699,6 +703,8 @@ class StoryManager final : public Actor {
 
   FlatHashMap<FileId, unique_ptr<PendingStory>, FileIdHash> being_uploaded_files_;
 
+  FlatHashSet<FileId, FileIdHash> preloaded_story_thumbnail_file_ids_;
+
   FlatHashMap<DialogId, std::set<uint32>, DialogIdHash> yet_unsent_stories_;
 
   FlatHashMap<DialogId, vector<StoryId>, DialogIdHash> yet_unsent_story_ids_;
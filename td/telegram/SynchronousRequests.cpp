@@ -8,19 +8,33 @@
 
 #include "td/telegram/CountryInfoManager.h"
 #include "td/telegram/DialogFilter.h"
+#include "td/telegram/files/FileBandwidthBudget.h"
 #include "td/telegram/JsonValue.h"
 #include "td/telegram/LanguagePackManager.h"
 #include "td/telegram/Logging.h"
 #include "td/telegram/MessageEntity.h"
 #include "td/telegram/MessageQuote.h"
 #include "td/telegram/misc.h"
+#include "td/telegram/net/NetQueryCompressor.h"
+#include "td/telegram/net/NetQueryLatencyStats.h"
 #include "td/telegram/NotificationManager.h"
 #include "td/telegram/OptionManager.h"
+#include "td/telegram/PerformanceStats.h"
 #include "td/telegram/QuickReplyManager.h"
 #include "td/telegram/Td.h"
 #include "td/telegram/td_api.hpp"
 #include "td/telegram/ThemeManager.h"
+#include "td/telegram/UpdateDeliveryStats.h"
 
+#include "td/mtproto/SessionConnectionStats.h"
+
+#include "td/db/SqliteStatementStats.h"
+
+#include "td/actor/ActorProfiler.h"
+#include "td/actor/ActorStats.h"
+
+#include "td/utils/algorithm.h"
+#include "td/utils/AllocationTag.h"
 #include "td/utils/filesystem.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
@@ -30,6 +44,7 @@
 #include "td/utils/Status.h"
 #include "td/utils/utf8.h"
 
+#include <algorithm>
 #include <limits>
 
 namespace td {
@@ -104,6 +119,24 @@ bool SynchronousRequests::is_synchronous_request(const td_api::Function *functio
     case td_api::setLogTagVerbosityLevel::ID:
     case td_api::getLogTagVerbosityLevel::ID:
     case td_api::addLogMessage::ID:
+    case td_api::setActorStatisticsParameters::ID:
+    case td_api::getActorStatistics::ID:
+    case td_api::setActorProfilerSamplingInterval::ID:
+    case td_api::getActorProfilerSamples::ID:
+    case td_api::toggleDatabaseStatementStatistics::ID:
+    case td_api::getDatabaseStatementStatistics::ID:
+    case td_api::getActorMemoryUsage::ID:
+    case td_api::toggleUpdateDeliveryStatistics::ID:
+    case td_api::getUpdateDeliveryStatistics::ID:
+    case td_api::getNetworkPacketStatistics::ID:
+    case td_api::getNetworkQueryCompressionStatistics::ID:
+    case td_api::toggleNetworkQueryLatencyStatistics::ID:
+    case td_api::getNetworkQueryLatencyStatistics::ID:
+    case td_api::setNetworkQueryLogSampleRate::ID:
+    case td_api::setFileTransferBandwidthLimit::ID:
+    case td_api::getFileTransferBandwidthAllocations::ID:
+    case td_api::getPerformanceStatistics::ID:
+    case td_api::setPerformanceStatisticsDumpParameters::ID:
     case td_api::testReturnError::ID:
       return true;
     case td_api::getOption::ID:
@@ -389,6 +422,161 @@ td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api:
   return td_api::make_object<td_api::ok>();
 }
 
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::setActorStatisticsParameters &request) {
+  if (request.log_period_ < 0 || request.log_period_ > 86400) {
+    return make_error(400, "Invalid log period specified");
+  }
+  ActorStats::set_enabled(request.is_enabled_);
+  ActorStats::set_log_period(request.log_period_);
+  return td_api::make_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api::getActorStatistics &request) {
+  auto actors = transform(ActorStats::get_statistics(request.reset_), [](const ActorStats::Statistics &statistics) {
+    auto max_mailbox_size = min(statistics.max_mailbox_size, static_cast<uint64>(std::numeric_limits<int32>::max()));
+    return td_api::make_object<td_api::actorStatistics>(statistics.name, static_cast<int64>(statistics.event_count),
+                                                        statistics.run_time, statistics.max_event_run_time,
+                                                        static_cast<int32>(max_mailbox_size));
+  });
+  return td_api::make_object<td_api::actorsStatistics>(std::move(actors));
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::setActorProfilerSamplingInterval &request) {
+  if (request.sampling_interval_ < 0 || request.sampling_interval_ > 1000) {
+    return make_error(400, "Invalid sampling interval specified");
+  }
+  ActorProfiler::set_sampling_interval(request.sampling_interval_);
+  return td_api::make_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api::getActorProfilerSamples &request) {
+  return td_api::make_object<td_api::text>(ActorProfiler::get_folded_stacks(request.reset_));
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::toggleDatabaseStatementStatistics &request) {
+  SqliteStatementStats::set_enabled(request.is_enabled_);
+  return td_api::make_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::getDatabaseStatementStatistics &request) {
+  auto statements = transform(
+      SqliteStatementStats::get_statistics(request.reset_), [](const SqliteStatementStats::Statistics &statistics) {
+        return td_api::make_object<td_api::databaseStatementStatistics>(
+            statistics.query, static_cast<int64>(statistics.execution_count), static_cast<int64>(statistics.row_count),
+            static_cast<int64>(statistics.full_scan_step_count), statistics.step_time, statistics.max_step_time);
+      });
+  return td_api::make_object<td_api::databaseStatementsStatistics>(std::move(statements));
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api::getActorMemoryUsage &request) {
+  if (!AllocationTag::is_enabled()) {
+    return make_error(400, "Memory profiling is disabled");
+  }
+  auto memory_usage = AllocationTag::get_memory_usage();
+  std::sort(memory_usage.begin(), memory_usage.end(),
+            [](const AllocationTag::MemoryUsage &lhs, const AllocationTag::MemoryUsage &rhs) {
+              return lhs.size > rhs.size;
+            });
+  int64 other_size = 0;
+  vector<td_api::object_ptr<td_api::actorMemoryUsage>> actors;
+  for (auto &usage : memory_usage) {
+    if (usage.name.empty()) {
+      other_size += usage.size;
+    } else {
+      actors.push_back(td_api::make_object<td_api::actorMemoryUsage>(usage.name, usage.size));
+    }
+  }
+  return td_api::make_object<td_api::actorsMemoryUsage>(std::move(actors), other_size);
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::toggleUpdateDeliveryStatistics &request) {
+  UpdateDeliveryStats::set_enabled(request.is_enabled_);
+  return td_api::make_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::getUpdateDeliveryStatistics &request) {
+  return UpdateDeliveryStats::get_update_delivery_statistics_object(request.reset_);
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api::getNetworkPacketStatistics &request) {
+  auto statistics = mtproto::SessionConnectionStats::get_statistics(request.reset_);
+  auto divide = [](double value, uint64 count) { return count == 0 ? 0.0 : value / static_cast<double>(count); };
+  auto packet_count = static_cast<double>(statistics.packet_count);
+  return td_api::make_object<td_api::networkPacketStatistics>(
+      statistics.duration, static_cast<int64>(statistics.packet_count),
+      statistics.duration <= 0 ? 0.0 : packet_count / statistics.duration,
+      divide(static_cast<double>(statistics.query_count), statistics.packet_count),
+      divide(static_cast<double>(statistics.byte_count), statistics.packet_count),
+      static_cast<int64>(statistics.ack_count), divide(statistics.total_ack_delay, statistics.ack_packet_count),
+      statistics.max_ack_delay);
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::getNetworkQueryCompressionStatistics &request) {
+  auto statistics = NetQueryCompressor::get_statistics(request.reset_);
+  return td_api::make_object<td_api::networkQueryCompressionStatistics>(
+      statistics.duration, static_cast<int64>(statistics.query_count),
+      static_cast<int64>(statistics.compressed_query_count), static_cast<int64>(statistics.offloaded_query_count),
+      static_cast<int64>(statistics.original_size), static_cast<int64>(statistics.compressed_size),
+      statistics.original_size == 0
+          ? 0.0
+          : static_cast<double>(statistics.compressed_size) / static_cast<double>(statistics.original_size),
+      statistics.compression_time);
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::toggleNetworkQueryLatencyStatistics &request) {
+  NetQueryLatencyStats::set_enabled(request.is_enabled_);
+  return td_api::make_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::getNetworkQueryLatencyStatistics &request) {
+  return NetQueryLatencyStats::get_network_query_latency_statistics_object(request.reset_);
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::setNetworkQueryLogSampleRate &request) {
+  if (request.sample_rate_ < 1 || request.sample_rate_ > NetQuery::MAX_LOG_SAMPLE_RATE) {
+    return make_error(400, "Invalid sample rate specified");
+  }
+  NetQuery::set_log_sample_rate(request.sample_rate_);
+  return td_api::make_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::setFileTransferBandwidthLimit &request) {
+  if (request.bytes_per_second_ < 0) {
+    return make_error(400, "Invalid bandwidth limit specified");
+  }
+  FileBandwidthBudget::set_limit(request.bytes_per_second_);
+  return td_api::make_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::getFileTransferBandwidthAllocations &request) {
+  return FileBandwidthBudget::get_file_transfer_bandwidth_allocations_object();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api::getPerformanceStatistics &request) {
+  return td_api::make_object<td_api::text>(PerformanceStats::get_prometheus_text());
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    td_api::setPerformanceStatisticsDumpParameters &request) {
+  auto status = PerformanceStats::set_dump_parameters(std::move(request.file_path_), request.dump_period_);
+  if (status.is_error()) {
+    return make_error(status.code(), status.message());
+  }
+  return td_api::make_object<td_api::ok>();
+}
+
 td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(td_api::testReturnError &request) {
   if (request.error_ == nullptr) {
     return td_api::make_object<td_api::error>(404, "Not Found");
@@ -83,6 +83,42 @@ class SynchronousRequests {
 
   static td_api::object_ptr<td_api::Object> do_request(const td_api::addLogMessage &request);
 
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::setActorStatisticsParameters &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getActorStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::setActorProfilerSamplingInterval &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getActorProfilerSamples &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::toggleDatabaseStatementStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getDatabaseStatementStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getActorMemoryUsage &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::toggleUpdateDeliveryStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getUpdateDeliveryStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getNetworkPacketStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getNetworkQueryCompressionStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::toggleNetworkQueryLatencyStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getNetworkQueryLatencyStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::setNetworkQueryLogSampleRate &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::setFileTransferBandwidthLimit &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getFileTransferBandwidthAllocations &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getPerformanceStatistics &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(td_api::setPerformanceStatisticsDumpParameters &request);
+
   static td_api::object_ptr<td_api::Object> do_request(td_api::testReturnError &request);
 };
 
@@ -31,6 +31,7 @@
 #include "td/telegram/DialogActionManager.h"
 #include "td/telegram/DialogFilterManager.h"
 #include "td/telegram/DialogInviteLinkManager.h"
+#include "td/telegram/DialogListId.h"
 #include "td/telegram/DialogManager.h"
 #include "td/telegram/DialogParticipantManager.h"
 #include "td/telegram/DocumentsManager.h"
@@ -91,6 +92,7 @@
 #include "td/telegram/TopDialogManager.h"
 #include "td/telegram/TranscriptionManager.h"
 #include "td/telegram/TranslationManager.h"
+#include "td/telegram/UpdateDeliveryStats.h"
 #include "td/telegram/UpdatesManager.h"
 #include "td/telegram/UserManager.h"
 #include "td/telegram/Version.h"
@@ -211,10 +213,12 @@ bool Td::is_preauthentication_request(int32 id) {
     case td_api::getNetworkStatistics::ID:
     case td_api::addNetworkStatistics::ID:
     case td_api::resetNetworkStatistics::ID:
+    case td_api::getNetworkRateLimits::ID:
     case td_api::setApplicationVerificationToken::ID:
     case td_api::getCountries::ID:
     case td_api::getCountryCode::ID:
     case td_api::getPhoneNumberInfo::ID:
+    case td_api::getPhoneNumbersInfo::ID:
     case td_api::getDeepLinkInfo::ID:
     case td_api::getApplicationConfig::ID:
     case td_api::saveApplicationLogEvent::ID:
@@ -375,11 +379,14 @@ std::shared_ptr<Td::ResultHandler> Td::extract_handler(uint64 id) {
   return result;
 }
 
-void Td::on_update(telegram_api::object_ptr<telegram_api::Updates> updates, uint64 auth_key_id) {
+void Td::on_update(telegram_api::object_ptr<telegram_api::Updates> updates, uint64 auth_key_id,
+                   double receive_time) {
   if (close_flag_ > 1) {
     return;
   }
 
+  UpdateDeliveryStats::on_updates_dispatched(receive_time);
+
   if (updates == nullptr) {
     if (auth_manager_->is_bot()) {
       G()->net_query_dispatcher().update_mtproto_header();
@@ -398,7 +405,7 @@ void Td::on_update(telegram_api::object_ptr<telegram_api::Updates> updates, uint
 
 void Td::on_result(NetQueryPtr query) {
   query->debug("Td: received from DcManager");
-  VLOG(net_query) << "Receive result of " << query;
+  VLOG_NET_QUERY(query) << "Receive result of " << query;
   if (close_flag_ > 1) {
     return;
   }
@@ -817,7 +824,10 @@ void Td::init(Parameters parameters, Result<TdDb::OpenedDatabase> r_opened_datab
 
   G()->init(actor_id(this), std::move(events.database)).ensure();
 
+  // start_up and event processing times of the created managers can be obtained through actor statistics
+  Timer timer;
   init_options_and_network();
+  VLOG(td_init) << "Options and network were inited" << timer;
 
   // we need to process td_api::getOption along with td_api::setOption for consistency
   // we need to process td_api::setOption before managers and MTProto header are created,
@@ -884,14 +894,19 @@ void Td::init(Parameters parameters, Result<TdDb::OpenedDatabase> r_opened_datab
   auth_manager_ = td::make_unique<AuthManager>(parameters.api_id_, parameters.api_hash_, create_reference());
   auth_manager_actor_ = register_actor("AuthManager", auth_manager_.get());
   G()->set_auth_manager(auth_manager_actor_.get());
+  VLOG(td_init) << "AuthManager was created" << timer;
 
   init_file_manager();
+  VLOG(td_init) << "FileManager was created" << timer;
 
   init_non_actor_managers();
+  VLOG(td_init) << "Non-actor managers were created" << timer;
 
   init_managers();
+  VLOG(td_init) << "Managers were created" << timer;
 
   init_pure_actor_managers();
+  VLOG(td_init) << "Pure actor managers were created" << timer;
 
   secret_chats_manager_ =
       create_actor<SecretChatsManager>("SecretChatsManager", create_reference(), parameters.use_secret_chats_);
@@ -903,6 +918,7 @@ void Td::init(Parameters parameters, Result<TdDb::OpenedDatabase> r_opened_datab
   option_manager_->on_td_inited();
 
   process_binlog_events(std::move(events));
+  VLOG(td_init) << "Binlog events were processed" << timer;
 
   VLOG(td_init) << "Ping datacenter";
   if (!auth_manager_->is_authorized()) {
@@ -964,6 +980,10 @@ void Td::process_binlog_events(TdDb::OpenedDatabase &&events) {
   // order to handle them properly.
   //
   // -- Use send_closure_later, so actors don't even start process binlog events, before all binlog events are sent
+  //
+  // 4. Binlog events can't be replayed in parallel on different schedulers. All managers live on the Td scheduler and
+  // access each other directly while handling their events, so only the binlog reading itself is done on the database
+  // scheduler.
 
   for (auto &event : events.to_secret_chats_manager) {
     send_closure_later(secret_chats_manager_, &SecretChatsManager::replay_binlog_event, std::move(event));
@@ -1039,8 +1059,8 @@ void Td::init_file_manager() {
       return !td_->auth_manager_->is_bot();
     }
 
-    void on_new_file(int64 size, int64 real_size, int32 cnt) final {
-      send_closure(G()->storage_manager(), &StorageManager::on_new_file, size, real_size, cnt);
+    void on_new_file(FileType file_type, int64 size, int64 real_size, int32 cnt) final {
+      send_closure(G()->storage_manager(), &StorageManager::on_new_file, file_type, size, real_size, cnt);
     }
 
     void on_file_updated(FileId file_id) final {
@@ -1279,6 +1299,89 @@ void Td::send_update(tl_object_ptr<td_api::Update> &&object) {
     return;
   }
 
+  if (object_id == td_api::updateAuthorizationState::ID) {
+    flush_delayed_updates();
+  } else if (delay_update(object)) {
+    return;
+  }
+
+  do_send_update(std::move(object));
+}
+
+bool Td::delay_update(td_api::object_ptr<td_api::Update> &object) {
+  if (option_manager_ == nullptr) {
+    return false;
+  }
+  auto delay = option_manager_->get_option_integer("chat_update_coalescing_delay");
+  if (delay <= 0) {
+    return false;
+  }
+
+  // only updates, which contain the full new state of an object, can be replaced with newer updates
+  auto object_id = object->get_id();
+  int64 chat_id = 0;
+  int64 dialog_list_id = 0;
+  switch (object_id) {
+    case td_api::updateChatLastMessage::ID:
+      chat_id = static_cast<const td_api::updateChatLastMessage *>(object.get())->chat_id_;
+      break;
+    case td_api::updateChatPosition::ID: {
+      auto update = static_cast<const td_api::updateChatPosition *>(object.get());
+      chat_id = update->chat_id_;
+      dialog_list_id = DialogListId(update->position_->list_).get();
+      break;
+    }
+    case td_api::updateChatReadInbox::ID:
+      chat_id = static_cast<const td_api::updateChatReadInbox *>(object.get())->chat_id_;
+      break;
+    case td_api::updateUnreadMessageCount::ID: {
+      auto update = static_cast<const td_api::updateUnreadMessageCount *>(object.get());
+      dialog_list_id = DialogListId(update->chat_list_).get();
+      break;
+    }
+    case td_api::updateUnreadChatCount::ID: {
+      auto update = static_cast<const td_api::updateUnreadChatCount *>(object.get());
+      dialog_list_id = DialogListId(update->chat_list_).get();
+      break;
+    }
+    default:
+      return false;
+  }
+
+  if (delayed_updates_.empty()) {
+    set_timeout_in(static_cast<double>(delay) * 1e-3);
+  }
+  // the new update is added to the end to be sent after all delayed updates, which can contain the same fields
+  auto &pos = delayed_update_positions_[std::make_tuple(object_id, chat_id, dialog_list_id)];
+  if (pos != 0) {
+    delayed_updates_[pos - 1] = nullptr;
+  }
+  delayed_updates_.push_back(std::move(object));
+  pos = delayed_updates_.size();
+  return true;
+}
+
+void Td::flush_delayed_updates() {
+  if (delayed_updates_.empty()) {
+    return;
+  }
+  cancel_timeout();
+  auto updates = std::move(delayed_updates_);
+  delayed_updates_.clear();
+  delayed_update_positions_.clear();
+  for (auto &update : updates) {
+    if (update != nullptr) {
+      do_send_update(std::move(update));
+    }
+  }
+}
+
+void Td::timeout_expired() {
+  flush_delayed_updates();
+}
+
+void Td::do_send_update(td_api::object_ptr<td_api::Update> &&object) {
+  auto object_id = object->get_id();
   switch (object_id) {
     case td_api::updateAccentColors::ID:
     case td_api::updateChatThemes::ID:
@@ -1350,6 +1453,37 @@ void Td::send_error(uint64 id, Status error) {
   error.ignore();
 }
 
+Result<SqliteDb::Parameters> Td::get_sqlite_parameters(const td_api::databaseParameters &parameters) {
+  if (parameters.memory_mapped_io_size_ < 0 || parameters.memory_mapped_io_size_ > (static_cast<int64>(1) << 40)) {
+    return Status::Error(400, "Invalid memory-mapped I/O size specified");
+  }
+  if (parameters.cache_size_ < 0 || parameters.cache_size_ > 4194304) {
+    return Status::Error(400, "Invalid cache size specified");
+  }
+  auto page_size = parameters.page_size_;
+  if (page_size != 0 && (page_size < 512 || page_size > 65536 || (page_size & (page_size - 1)) != 0)) {
+    return Status::Error(400, "Invalid page size specified");
+  }
+
+  SqliteDb::Parameters result;
+  if (parameters.optimize_for_reads_) {
+    result.mmap_size = static_cast<int64>(256) << 20;
+    result.cache_size = 64 << 10;
+    result.use_memory_temp_store = true;
+  }
+  if (parameters.memory_mapped_io_size_ != 0) {
+    result.mmap_size = parameters.memory_mapped_io_size_;
+  }
+  if (parameters.cache_size_ != 0) {
+    result.cache_size = parameters.cache_size_;
+  }
+  result.page_size = page_size;
+  if (parameters.use_memory_temp_store_) {
+    result.use_memory_temp_store = true;
+  }
+  return result;
+}
+
 Result<std::pair<Td::Parameters, TdDb::Parameters>> Td::get_parameters(
     td_api::object_ptr<td_api::setTdlibParameters> parameters) {
   VLOG(td_init) << "Begin to set TDLib parameters";
@@ -1379,6 +1513,10 @@ Result<std::pair<Td::Parameters, TdDb::Parameters>> Td::get_parameters(
   result.second.use_file_database_ = parameters->use_file_database_;
   result.second.use_chat_info_database_ = parameters->use_chat_info_database_;
   result.second.use_message_database_ = parameters->use_message_database_;
+  if (parameters->database_parameters_ != nullptr) {
+    TRY_RESULT_ASSIGN(result.second.sqlite_parameters_, get_sqlite_parameters(*parameters->database_parameters_));
+    result.second.compress_data_ = parameters->database_parameters_->compress_data_;
+  }
 
   VLOG(td_init) << "Create MtprotoHeader::Options";
   options_.api_id = parameters->api_id_;
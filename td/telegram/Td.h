@@ -26,7 +26,9 @@
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 
+#include <map>
 #include <memory>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 
@@ -139,7 +141,7 @@ class Td final : public Actor {
 
   void destroy();
 
-  void on_update(telegram_api::object_ptr<telegram_api::Updates> updates, uint64 auth_key_id);
+  void on_update(telegram_api::object_ptr<telegram_api::Updates> updates, uint64 auth_key_id, double receive_time);
 
   void on_result(NetQueryPtr query);
 
@@ -365,6 +367,10 @@ class Td final : public Actor {
   bool destroy_flag_ = false;
   int close_flag_ = 0;
 
+  // chat-level updates, which are held for a short time to be replaced with newer updates about the same object
+  vector<td_api::object_ptr<td_api::Update>> delayed_updates_;
+  std::map<std::tuple<int32, int64, int64>, size_t> delayed_update_positions_;
+
   enum class State : int32 { WaitParameters, Run, Close } state_ = State::WaitParameters;
   uint64 set_parameters_request_id_ = 0;
 
@@ -431,8 +437,17 @@ class Td final : public Actor {
 
   void clear();
 
+  bool delay_update(td_api::object_ptr<td_api::Update> &object);
+
+  void flush_delayed_updates();
+
+  void do_send_update(td_api::object_ptr<td_api::Update> &&object);
+
   void close_impl(bool destroy_flag);
 
+  static Result<SqliteDb::Parameters> get_sqlite_parameters(const td_api::databaseParameters &parameters)
+      TD_WARN_UNUSED_RESULT;
+
   Result<std::pair<Parameters, TdDb::Parameters>> get_parameters(
       td_api::object_ptr<td_api::setTdlibParameters> parameters) TD_WARN_UNUSED_RESULT;
 
@@ -445,6 +460,7 @@ class Td final : public Actor {
   void tear_down() final;
   void hangup_shared() final;
   void hangup() final;
+  void timeout_expired() final;
 };
 
 }  // namespace td
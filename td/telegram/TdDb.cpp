@@ -29,6 +29,7 @@
 #include "td/actor/actor.h"
 #include "td/actor/MultiPromise.h"
 
+#include "td/utils/algorithm.h"
 #include "td/utils/common.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
@@ -289,7 +290,13 @@ void TdDb::do_close(bool destroy_flag, Promise<Unit> on_finished) {
   }
   MultiPromiseActorSafe mpas{"TdDbCloseMultiPromiseActor"};
   mpas.add_promise(PromiseCreator::lambda(
-      [promise = std::move(on_finished), sql_connection = std::move(sql_connection_), destroy_flag](Unit) mutable {
+      [promise = std::move(on_finished), sql_connection = std::move(sql_connection_),
+       sql_read_only_connection = std::move(sql_read_only_connection_), destroy_flag](Unit) mutable {
+        if (sql_read_only_connection) {
+          LOG_CHECK(sql_read_only_connection.unique()) << sql_read_only_connection.use_count();
+          sql_read_only_connection->close();
+          sql_read_only_connection.reset();
+        }
         if (sql_connection) {
           LOG_CHECK(sql_connection.unique()) << sql_connection.use_count();
           if (destroy_flag) {
@@ -373,9 +380,13 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
   }
 
   TRY_RESULT(db_instance, SqliteDb::change_key(sql_database_path, true, key, old_key));
-  sql_connection_ = std::make_shared<SqliteConnectionSafe>(sql_database_path, key, db_instance.get_cipher_version());
+  TRY_STATUS(db_instance.apply_parameters(parameters.sqlite_parameters_));
+  sql_connection_ = std::make_shared<SqliteConnectionSafe>(sql_database_path, key, db_instance.get_cipher_version(),
+                                                           false, parameters.sqlite_parameters_);
   sql_connection_->set(std::move(db_instance));
   auto &db = sql_connection_->get();
+  // takes effect only for new databases; free pages are reclaimed by DatabaseVacuumWorker
+  TRY_STATUS(db.exec("PRAGMA auto_vacuum=INCREMENTAL"));
   TRY_STATUS(db.exec("PRAGMA journal_mode=WAL"));
   TRY_STATUS(db.exec("PRAGMA secure_delete=1"));
 
@@ -457,7 +468,7 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
 
   TRY_STATUS(db.exec("COMMIT TRANSACTION"));
 
-  file_db_ = create_file_db(sql_connection_);
+  file_db_ = create_file_db(sql_connection_, -1, parameters.compress_data_);
 
   common_kv_safe_ = std::make_shared<SqliteKeyValueSafe>("common", sql_connection_);
   common_kv_async_ = create_sqlite_key_value_async(common_kv_safe_);
@@ -480,12 +491,29 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
   }
 
   if (use_message_database) {
-    message_db_sync_safe_ = create_message_db_sync(sql_connection_);
-    message_db_async_ = create_message_db_async(message_db_sync_safe_);
+    message_db_sync_safe_ = create_message_db_sync(sql_connection_, parameters.compress_data_);
+
+    // heavy read queries are run in parallel on other schedulers through read-only connections
+    vector<int32> reader_scheduler_ids;
+    auto database_scheduler_id = G()->get_database_scheduler_id();
+    for (auto scheduler_id : {G()->get_gc_scheduler_id(), G()->get_slow_net_scheduler_id()}) {
+      if (scheduler_id != database_scheduler_id && !td::contains(reader_scheduler_ids, scheduler_id)) {
+        reader_scheduler_ids.push_back(scheduler_id);
+      }
+    }
+    std::shared_ptr<MessageDbSyncSafeInterface> read_only_message_db_sync_safe;
+    if (!reader_scheduler_ids.empty()) {
+      sql_read_only_connection_ =
+          std::make_shared<SqliteConnectionSafe>(sql_database_path, key, db.get_cipher_version(), true,
+                                                 parameters.sqlite_parameters_);
+      read_only_message_db_sync_safe = create_message_db_sync(sql_read_only_connection_);
+    }
+    message_db_async_ = create_message_db_async(message_db_sync_safe_, -1, std::move(read_only_message_db_sync_safe),
+                                                std::move(reader_scheduler_ids));
   }
 
   if (use_story_database) {
-    story_db_sync_safe_ = create_story_db_sync(sql_connection_);
+    story_db_sync_safe_ = create_story_db_sync(sql_connection_, parameters.compress_data_);
     story_db_async_ = create_story_db_async(story_db_sync_safe_);
   }
 
@@ -709,8 +737,19 @@ Result<string> TdDb::get_stats() {
                               << mask << "'",
                      PSLICE() << table << ":" << mask);
   };
+  TRY_RESULT(page_count, sql.get_pragma("page_count"));
+  TRY_RESULT(free_page_count, sql.get_pragma("freelist_count"));
+  TRY_RESULT(auto_vacuum, sql.get_pragma("auto_vacuum"));
+  sb << "pages:\n";
+  sb << page_count << " total\t" << free_page_count << " free\t" << tag("auto_vacuum", auto_vacuum) << "\n";
   TRY_STATUS(run_query("SELECT 0, SUM(length(data)), COUNT(*) FROM stories WHERE 1", "stories"));
   TRY_STATUS(run_query("SELECT 0, SUM(length(data)), COUNT(*) FROM messages WHERE 1", "messages"));
+  if (message_db_sync_safe_ != nullptr) {
+    TRY_RESULT(fts_statistics, message_db_sync_safe_->get().get_fts_statistics());
+    sb << "messages_fts:\n";
+    sb << fts_statistics.level_count << " levels\t" << fts_statistics.segment_count << " segments\t"
+       << fts_statistics.page_count << " pages\t" << format::as_size(fts_statistics.size) << "\n";
+  }
   TRY_STATUS(run_query("SELECT 0, SUM(length(data)), COUNT(*) FROM dialogs WHERE 1", "dialogs"));
   TRY_STATUS(run_kv_query("%", "common"));
   TRY_STATUS(run_kv_query("%", "files"));
@@ -10,6 +10,7 @@
 #include "td/db/binlog/BinlogInterface.h"
 #include "td/db/DbKey.h"
 #include "td/db/KeyValueSyncInterface.h"
+#include "td/db/SqliteDb.h"
 
 #include "td/utils/common.h"
 #include "td/utils/Promise.h"
@@ -60,6 +61,8 @@ class TdDb {
     bool use_file_database_ = false;
     bool use_chat_info_database_ = false;
     bool use_message_database_ = false;
+    SqliteDb::Parameters sqlite_parameters_;
+    bool compress_data_ = false;
   };
 
   struct OpenedDatabase {
@@ -162,6 +165,7 @@ class TdDb {
   bool was_dialog_db_created_ = false;
 
   std::shared_ptr<SqliteConnectionSafe> sql_connection_;
+  std::shared_ptr<SqliteConnectionSafe> sql_read_only_connection_;
 
   std::shared_ptr<FileDbInterface> file_db_;
 
@@ -35,7 +35,6 @@
 
 #include <algorithm>
 #include <cmath>
-#include <iterator>
 
 namespace td {
 
@@ -207,24 +206,25 @@ void TopDialogManager::on_dialog_used(TopDialogCategory category, DialogId dialo
   auto &top_dialogs = by_category_[pos];
 
   top_dialogs.is_dirty = true;
-  auto it = std::find_if(top_dialogs.dialogs.begin(), top_dialogs.dialogs.end(),
-                         [&](auto &top_dialog) { return top_dialog.dialog_id == dialog_id; });
-  if (it == top_dialogs.dialogs.end()) {
+  auto &dialog_pos = top_dialogs.dialog_positions[dialog_id];
+  if (dialog_pos == 0) {
     TopDialog top_dialog;
     top_dialog.dialog_id = dialog_id;
     top_dialogs.dialogs.push_back(top_dialog);
-    it = top_dialogs.dialogs.end() - 1;
+    dialog_pos = top_dialogs.dialogs.size();
   }
 
+  // dialog_pos is the 1-based position of the dialog
+  auto i = dialog_pos - 1;
   auto delta = rating_add(date, top_dialogs.rating_timestamp);
-  it->rating += delta;
-  while (it != top_dialogs.dialogs.begin()) {
-    auto next = std::prev(it);
-    if (*next < *it) {
-      break;
-    }
-    std::swap(*next, *it);
-    it = next;
+  top_dialogs.dialogs[i].rating += delta;
+  auto from_pos = i;
+  while (i > 0 && !(top_dialogs.dialogs[i - 1] < top_dialogs.dialogs[i])) {
+    std::swap(top_dialogs.dialogs[i - 1], top_dialogs.dialogs[i]);
+    i--;
+  }
+  if (i != from_pos) {
+    top_dialogs.update_dialog_positions(i);
   }
 
   LOG(INFO) << "Update " << get_top_dialog_category_name(category) << " rating of " << dialog_id << " by " << delta;
@@ -256,14 +256,16 @@ void TopDialogManager::remove_dialog(TopDialogCategory category, DialogId dialog
 
   td_->create_handler<ResetTopPeerRatingQuery>()->send(category, dialog_id);
 
-  auto it = std::find_if(top_dialogs.dialogs.begin(), top_dialogs.dialogs.end(),
-                         [&](auto &top_dialog) { return top_dialog.dialog_id == dialog_id; });
-  if (it == top_dialogs.dialogs.end()) {
+  auto it = top_dialogs.dialog_positions.find(dialog_id);
+  if (it == top_dialogs.dialog_positions.end()) {
     return promise.set_value(Unit());
   }
+  auto dialog_pos = it->second - 1;
+  top_dialogs.dialog_positions.erase(it);
 
   top_dialogs.is_dirty = true;
-  top_dialogs.dialogs.erase(it);
+  top_dialogs.dialogs.erase(top_dialogs.dialogs.begin() + dialog_pos);
+  top_dialogs.update_dialog_positions(dialog_pos);
   if (!first_unsync_change_) {
     first_unsync_change_ = Timestamp::now_cached();
   }
@@ -347,6 +349,12 @@ void parse(TopDialogManager::TopDialogs &top_dialogs, ParserT &parser) {
   parse(top_dialogs.dialogs, parser);
 }
 
+void TopDialogManager::TopDialogs::update_dialog_positions(size_t from_pos) {
+  for (size_t i = from_pos; i < dialogs.size(); i++) {
+    dialog_positions[dialogs[i].dialog_id] = i + 1;
+  }
+}
+
 double TopDialogManager::rating_add(double now, double rating_timestamp) const {
   return std::exp((now - rating_timestamp) / rating_e_decay_);
 }
@@ -356,6 +364,8 @@ double TopDialogManager::current_rating_add(double server_time, double rating_ti
 }
 
 void TopDialogManager::normalize_rating() {
+  // the relative order of dialogs doesn't change and the saved ratings are still valid together with
+  // the saved rating_timestamp, so there is no need to save the categories
   auto server_time = G()->server_time();
   for (auto &top_dialogs : by_category_) {
     auto div_by = current_rating_add(server_time, top_dialogs.rating_timestamp);
@@ -363,9 +373,7 @@ void TopDialogManager::normalize_rating() {
     for (auto &dialog : top_dialogs.dialogs) {
       dialog.rating /= div_by;
     }
-    top_dialogs.is_dirty = true;
   }
-  db_sync_state_ = SyncState::None;
 }
 
 void TopDialogManager::do_get_top_dialogs(GetTopDialogsQuery &&query) {
@@ -510,6 +518,8 @@ void TopDialogManager::on_get_top_peers(Result<telegram_api::object_ptr<telegram
           top_dialog.rating = top_peer->rating_;
           top_dialogs.dialogs.push_back(std::move(top_dialog));
         }
+        top_dialogs.dialog_positions.clear();
+        top_dialogs.update_dialog_positions(0);
       }
       db_sync_state_ = SyncState::None;
       break;
@@ -599,6 +609,7 @@ void TopDialogManager::try_start() {
         continue;
       }
       log_event_parse(top_dialogs, value).ensure();
+      top_dialogs.update_dialog_positions(0);
     }
     normalize_rating();
   } else {
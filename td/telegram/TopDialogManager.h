@@ -14,6 +14,7 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Status.h"
 #include "td/utils/Time.h"
@@ -81,10 +82,16 @@ class TopDialogManager final : public Actor {
     }
   };
 
+  // ratings are stored relative to rating_timestamp, so a new use of a dialog only increases its rating and
+  // there is no need to decay ratings of all dialogs; rating_timestamp is moved forward once in a while only
+  // to avoid overflows
   struct TopDialogs {
     bool is_dirty = false;
     double rating_timestamp = 0;
-    vector<TopDialog> dialogs;
+    vector<TopDialog> dialogs;  // sorted by rating
+    FlatHashMap<DialogId, size_t, DialogIdHash> dialog_positions;  // dialog_id -> index in dialogs
+
+    void update_dialog_positions(size_t from_pos);
   };
   template <class StorerT>
   friend void store(const TopDialog &top_dialog, StorerT &storer);
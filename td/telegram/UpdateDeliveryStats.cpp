@@ -0,0 +1,82 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/UpdateDeliveryStats.h"
+
+#include "td/utils/LatencyHistogram.h"
+#include "td/utils/Time.h"
+
+#include <mutex>
+
+namespace td {
+
+std::atomic<bool> UpdateDeliveryStats::is_enabled_{false};
+
+namespace {
+
+enum class DelayType : int32 { Dispatch, Processing, Queue, Size };
+
+struct Histograms {
+  std::mutex mutex;
+  LatencyHistogram histograms[static_cast<int32>(DelayType::Size)];
+};
+
+Histograms &get_histograms() {
+  static Histograms histograms;
+  return histograms;
+}
+
+void add_delay(DelayType type, double start_time) {
+  if (!UpdateDeliveryStats::is_enabled() || start_time <= 0) {
+    return;
+  }
+  auto delay = Time::now() - start_time;
+  auto &histograms = get_histograms();
+  std::lock_guard<std::mutex> lock(histograms.mutex);
+  histograms.histograms[static_cast<int32>(type)].add(delay);
+}
+
+td_api::object_ptr<td_api::delayStatistics> get_delay_statistics_object(const LatencyHistogram &histogram) {
+  return td_api::make_object<td_api::delayStatistics>(
+      static_cast<int64>(histogram.get_count()), histogram.get_average(), histogram.get_percentile(50),
+      histogram.get_percentile(90), histogram.get_percentile(99), histogram.get_max());
+}
+
+}  // namespace
+
+void UpdateDeliveryStats::set_enabled(bool is_enabled) {
+  is_enabled_.store(is_enabled, std::memory_order_relaxed);
+}
+
+void UpdateDeliveryStats::on_updates_dispatched(double receive_time) {
+  add_delay(DelayType::Dispatch, receive_time);
+}
+
+void UpdateDeliveryStats::on_update_processed(double receive_time) {
+  add_delay(DelayType::Processing, receive_time);
+}
+
+void UpdateDeliveryStats::on_update_received(double send_time) {
+  add_delay(DelayType::Queue, send_time);
+}
+
+td_api::object_ptr<td_api::updateDeliveryStatistics> UpdateDeliveryStats::get_update_delivery_statistics_object(
+    bool reset) {
+  auto &histograms = get_histograms();
+  std::lock_guard<std::mutex> lock(histograms.mutex);
+  auto get_object = [&histograms, reset](DelayType type) {
+    auto &histogram = histograms.histograms[static_cast<int32>(type)];
+    auto result = get_delay_statistics_object(histogram);
+    if (reset) {
+      histogram.clear();
+    }
+    return result;
+  };
+  return td_api::make_object<td_api::updateDeliveryStatistics>(
+      get_object(DelayType::Dispatch), get_object(DelayType::Processing), get_object(DelayType::Queue));
+}
+
+}  // namespace td
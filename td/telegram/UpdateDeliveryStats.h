@@ -0,0 +1,41 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/telegram/td_api.h"
+
+#include "td/utils/common.h"
+
+#include <atomic>
+
+namespace td {
+
+// process-wide histograms of delays between receiving of updates from the server and returning them to the application
+class UpdateDeliveryStats {
+ public:
+  static void set_enabled(bool is_enabled);
+
+  static bool is_enabled() {
+    return is_enabled_.load(std::memory_order_relaxed);
+  }
+
+  // updates were received from the network at receive_time and are going to be processed by UpdatesManager
+  static void on_updates_dispatched(double receive_time);
+
+  // a message update, received by UpdatesManager at receive_time, was applied after all preceding updates
+  static void on_update_processed(double receive_time);
+
+  // an update, sent to the client at send_time, was returned by ClientManager::receive
+  static void on_update_received(double send_time);
+
+  static td_api::object_ptr<td_api::updateDeliveryStatistics> get_update_delivery_statistics_object(bool reset);
+
+ private:
+  static std::atomic<bool> is_enabled_;
+};
+
+}  // namespace td
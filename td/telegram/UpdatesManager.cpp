@@ -83,6 +83,7 @@
 #include "td/telegram/ThemeManager.h"
 #include "td/telegram/TimeZoneManager.h"
 #include "td/telegram/TranscriptionManager.h"
+#include "td/telegram/UpdateDeliveryStats.h"
 #include "td/telegram/UserManager.h"
 #include "td/telegram/Usernames.h"
 #include "td/telegram/WebPagesManager.h"
@@ -102,6 +103,7 @@
 #include "td/utils/StringBuilder.h"
 #include "td/utils/Time.h"
 
+#include <algorithm>
 #include <limits>
 
 namespace td {
@@ -252,6 +254,32 @@ class GetPtsUpdateQuery final : public Td::ResultHandler {
   }
 };
 
+void UpdatesManager::PendingPtsUpdates::emplace(tl_object_ptr<telegram_api::Update> &&update, int32 pts,
+                                                int32 pts_count, double receive_time, Promise<Unit> &&promise) {
+  if (begin_pos_ == updates_.size()) {
+    clear();
+  } else if (begin_pos_ >= 16 && begin_pos_ * 2 >= updates_.size()) {
+    updates_.erase(updates_.begin(), updates_.begin() + begin_pos_);
+    begin_pos_ = 0;
+  }
+
+  PendingPtsUpdate pending_update(std::move(update), pts, pts_count, receive_time, std::move(promise));
+  if (empty() || !(pending_update < updates_.back())) {
+    updates_.push_back(std::move(pending_update));
+    return;
+  }
+  // the new update must be placed after all updates, which are equal to it, like in std::multiset
+  auto it = std::upper_bound(begin(), end(), pending_update);
+  updates_.insert(it, std::move(pending_update));
+}
+
+void UpdatesManager::PendingPtsUpdates::pop_front() {
+  CHECK(!empty());
+  auto &update = updates_[begin_pos_++];
+  update.update = nullptr;
+  update.promise = {};
+}
+
 UpdatesManager::UpdatesManager(Td *td, ActorShared<> parent) : td_(td), parent_(std::move(parent)) {
   last_pts_save_time_ = last_qts_save_time_ = Time::now() - 2 * MAX_PTS_SAVE_DELAY;
 
@@ -368,7 +396,7 @@ void UpdatesManager::fill_pts_gap(void *td) {
       min_pts_count = min_update.pts_count;
       first_update = min_update.update.get();
     }
-    max_pts = max(max_pts, updates_manager->pending_pts_updates_.rbegin()->pts);
+    max_pts = max(max_pts, updates_manager->pending_pts_updates_.back().pts);
   }
   if (!updates_manager->postponed_pts_updates_.empty()) {
     auto &min_update = *updates_manager->postponed_pts_updates_.begin();
@@ -377,7 +405,7 @@ void UpdatesManager::fill_pts_gap(void *td) {
       min_pts_count = min_update.pts_count;
       first_update = min_update.update.get();
     }
-    max_pts = max(max_pts, updates_manager->postponed_pts_updates_.rbegin()->pts);
+    max_pts = max(max_pts, updates_manager->postponed_pts_updates_.back().pts);
   }
   updates_manager->pts_gap_++;
   fill_gap(td, PSTRING() << "PTS from " << updates_manager->get_pts() << " to " << min_pts << "(-" << min_pts_count
@@ -495,6 +523,22 @@ void UpdatesManager::run_get_difference(bool is_recursive, const char *source) {
     min_postponed_update_qts_ = 0;
   }
 
+  last_confirmed_pts_ = pts;
+  last_confirmed_qts_ = qts;
+
+  if (is_prefetching_difference_) {
+    if (is_prefetched_difference_usable_ && prefetched_difference_pts_ == pts && prefetched_difference_date_ == date &&
+        prefetched_difference_qts_ == qts) {
+      VLOG(get_difference) << "Use prefetched difference";
+      is_waiting_for_prefetched_difference_ = true;
+      if (is_prefetched_difference_received_) {
+        apply_prefetched_difference();
+      }
+      return;
+    }
+    drop_prefetched_difference();
+  }
+
   auto promise = PromiseCreator::lambda([](Result<tl_object_ptr<telegram_api::updates_Difference>> result) {
     if (result.is_ok()) {
       send_closure(G()->updates_manager(), &UpdatesManager::on_get_difference, result.move_as_ok());
@@ -503,8 +547,57 @@ void UpdatesManager::run_get_difference(bool is_recursive, const char *source) {
     }
   });
   td_->create_handler<GetDifferenceQuery>(std::move(promise))->send(pts, date, qts);
-  last_confirmed_pts_ = pts;
-  last_confirmed_qts_ = qts;
+}
+
+void UpdatesManager::prefetch_difference(int32 pts, int32 date, int32 qts) {
+  CHECK(!is_prefetching_difference_);
+  VLOG(get_difference) << "Prefetch difference with PTS = " << pts << ", QTS = " << qts << ", date = " << date;
+  is_prefetching_difference_ = true;
+  prefetched_difference_pts_ = pts;
+  prefetched_difference_date_ = date;
+  prefetched_difference_qts_ = qts;
+  auto promise = PromiseCreator::lambda([generation = prefetched_difference_generation_](
+                                            Result<tl_object_ptr<telegram_api::updates_Difference>> result) {
+    send_closure(G()->updates_manager(), &UpdatesManager::on_get_prefetched_difference, generation, std::move(result));
+  });
+  td_->create_handler<GetDifferenceQuery>(std::move(promise))->send(pts, date, qts);
+}
+
+void UpdatesManager::on_get_prefetched_difference(uint64 generation,
+                                                  Result<tl_object_ptr<telegram_api::updates_Difference>> result) {
+  if (generation != prefetched_difference_generation_ || !is_prefetching_difference_) {
+    return;
+  }
+  CHECK(!is_prefetched_difference_received_);
+  is_prefetched_difference_received_ = true;
+  prefetched_difference_ = std::move(result);
+  if (is_waiting_for_prefetched_difference_) {
+    apply_prefetched_difference();
+  }
+}
+
+void UpdatesManager::apply_prefetched_difference() {
+  CHECK(is_prefetched_difference_received_);
+  CHECK(is_waiting_for_prefetched_difference_);
+  auto result = std::move(prefetched_difference_);
+  drop_prefetched_difference();
+  if (result.is_ok()) {
+    send_closure_later(actor_id(this), &UpdatesManager::on_get_difference, result.move_as_ok());
+  } else {
+    send_closure_later(actor_id(this), &UpdatesManager::on_failed_get_difference, result.move_as_error());
+  }
+}
+
+void UpdatesManager::drop_prefetched_difference() {
+  if (!is_prefetching_difference_) {
+    return;
+  }
+  prefetched_difference_generation_++;
+  is_prefetching_difference_ = false;
+  is_prefetched_difference_usable_ = false;
+  is_prefetched_difference_received_ = false;
+  is_waiting_for_prefetched_difference_ = false;
+  prefetched_difference_ = Result<tl_object_ptr<telegram_api::updates_Difference>>();
 }
 
 void UpdatesManager::before_get_difference(bool is_initial) {
@@ -646,7 +739,8 @@ Promise<> UpdatesManager::set_pts(int32 pts, const char *source) {
     if (last_confirmed_pts_ < get_pts() - FORCED_GET_DIFFERENCE_PTS_DIFF && last_confirmed_pts_ != 0) {
       confirm_pts_qts(get_qts());
     }
-  } else if (pts < get_pts() && (pts > 1 || td_->option_manager_->get_option_integer("session_count") <= 1)) {
+  } else if (pts < get_pts() &&
+             (pts > 1 || td_->option_manager_->get_option_integer(CachedOption::SessionCount) <= 1)) {
     LOG(ERROR) << "Receive wrong PTS = " << pts << " from " << source << ". Current PTS = " << get_pts();
   }
   return result;
@@ -1751,7 +1845,7 @@ void UpdatesManager::on_update_from_auth_key_id(uint64 auth_key_id) {
   if (info.update_count++ == 0) {
     info.first_update_time = now;
     while (session_infos_.size() >
-           static_cast<size_t>(max(narrow_cast<int32>(G()->get_option_integer("session_count")), 1))) {
+           static_cast<size_t>(max(narrow_cast<int32>(G()->get_option_integer(CachedOption::SessionCount)), 1))) {
       auto unused_auth_key_id = get_most_unused_auth_key_id();
       LOG(INFO) << "Delete statistics for auth key " << unused_auth_key_id;
       session_infos_.erase(unused_auth_key_id);
@@ -1940,11 +2034,10 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
     case telegram_api::updates_differenceSlice::ID: {
       auto difference = move_tl_object_as<telegram_api::updates_differenceSlice>(difference_ptr);
       bool is_pts_changed = have_update_pts_changed(difference->other_updates_);
-      if (difference->intermediate_state_->pts_ >= get_pts() && get_pts() != std::numeric_limits<int32>::max() &&
-          difference->intermediate_state_->date_ >= date_ && difference->intermediate_state_->qts_ == get_qts() &&
-          !is_pts_changed) {
-        // TODO send new getDifference request and apply difference slice only after that
-      }
+      bool can_prefetch = difference->intermediate_state_->pts_ >= get_pts() &&
+                          get_pts() != std::numeric_limits<int32>::max() &&
+                          difference->intermediate_state_->date_ >= date_ &&
+                          difference->intermediate_state_->qts_ == get_qts() && !is_pts_changed;
 
       VLOG(get_difference) << "In get difference receive " << difference->users_.size() << " users and "
                            << difference->chats_.size() << " chats";
@@ -1962,6 +2055,12 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
         }
       }
 
+      if (can_prefetch) {
+        // request the next slice, while the current slice is processed
+        const auto *state = difference->intermediate_state_.get();
+        prefetch_difference(max(state->pts_, 0), state->date_, state->qts_);
+      }
+
       process_get_difference_updates(std::move(difference->new_messages_),
                                      std::move(difference->new_encrypted_messages_),
                                      std::move(difference->other_updates_));
@@ -1977,6 +2076,9 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
       auto old_date = get_date();
       auto old_qts = get_qts();
       on_get_updates_state(std::move(difference->intermediate_state_), "get difference slice");
+      if (is_prefetching_difference_) {
+        is_prefetched_difference_usable_ = true;
+      }
 
       process_postponed_pts_updates();
       process_pending_qts_updates();
@@ -1997,7 +2099,7 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
       break;
     }
     case telegram_api::updates_differenceTooLong::ID: {
-      if (td_->option_manager_->get_option_integer("session_count") <= 1) {
+      if (td_->option_manager_->get_option_integer(CachedOption::SessionCount) <= 1) {
         LOG(ERROR) << "Receive differenceTooLong";
       }
       // TODO
@@ -2013,6 +2115,7 @@ void UpdatesManager::on_get_difference(tl_object_ptr<telegram_api::updates_Diffe
   get_difference_retry_count_ = 0;
 
   if (!running_get_difference_) {
+    drop_prefetched_difference();
     after_get_difference();
   }
 }
@@ -2824,7 +2927,7 @@ void UpdatesManager::add_pending_pts_update(tl_object_ptr<telegram_api::Update>
     bool need_restore_pts = new_pts < old_pts - 19999;
     auto now = Time::now();
     if (old_pts == 2100000000 && new_pts < 1100000000 && pts_count <= 10000 &&
-        td_->option_manager_->get_option_integer("session_count") > 1) {
+        td_->option_manager_->get_option_integer(CachedOption::SessionCount) > 1) {
       set_pts(1, "restore PTS").set_value(Unit());
       old_pts = get_pts();
       set_pts_gap_timeout(0.001);
@@ -2895,6 +2998,7 @@ void UpdatesManager::add_pending_pts_update(tl_object_ptr<telegram_api::Update>
       !pts_gap_timeout_.has_timeout()) {
     if (pts_count > 0) {
       td_->messages_manager_->process_pts_update(std::move(update));
+      UpdateDeliveryStats::on_update_processed(receive_time);
 
       set_pts(accumulated_pts_, "process pending updates fast path")
           .set_value(Unit());  // TODO can't set until data are really stored on persistent storage
@@ -2928,7 +3032,8 @@ void UpdatesManager::add_pending_pts_update(tl_object_ptr<telegram_api::Update>
 
 void UpdatesManager::postpone_pts_update(tl_object_ptr<telegram_api::Update> &&update, int32 pts, int32 pts_count,
                                          double receive_time, Promise<Unit> &&promise) {
-  if (!can_postpone_updates() || (pts_count > 1 && td_->option_manager_->get_option_integer("session_count") <= 1)) {
+  if (!can_postpone_updates() ||
+      (pts_count > 1 && td_->option_manager_->get_option_integer(CachedOption::SessionCount) <= 1)) {
     return promise.set_value(Unit());
   }
   postponed_pts_updates_.emplace(std::move(update), pts, pts_count, receive_time, std::move(promise));
@@ -2937,22 +3042,18 @@ void UpdatesManager::postpone_pts_update(tl_object_ptr<telegram_api::Update> &&u
 void UpdatesManager::process_seq_updates(int32 seq_end, int32 date,
                                          vector<tl_object_ptr<telegram_api::Update>> &&updates,
                                          Promise<Unit> &&promise) {
-  string serialized_updates;
+  string date_source;
   if (date && seq_end) {
-    serialized_updates = PSTRING() << "process_seq_updates [seq_ = " << seq_ << ", seq_end = " << seq_end << "]: ";
-    // TODO remove after bugs will be fixed
-    for (auto &update : updates) {
-      if (update != nullptr) {
-        serialized_updates += oneline(to_string(update));
-      }
-    }
+    // the updates themselves are logged when they are received
+    date_source = PSTRING() << "process_seq_updates [seq_ = " << seq_ << ", seq_end = " << seq_end << "] with "
+                            << updates.size() << " updates";
   }
   process_updates(std::move(updates), false, std::move(promise));
   if (seq_end) {
     seq_ = seq_end;
   }
   if (date && seq_end) {
-    set_date(date, true, std::move(serialized_updates));
+    set_date(date, true, std::move(date_source));
   }
 }
 
@@ -3113,6 +3214,7 @@ void UpdatesManager::process_all_pending_pts_updates() {
   auto begin_time = Time::now();
   for (auto &update : pending_pts_updates_) {
     td_->messages_manager_->process_pts_update(std::move(update.update));
+    UpdateDeliveryStats::on_update_processed(update.receive_time);
     update.promise.set_value(Unit());
   }
 
@@ -3158,7 +3260,8 @@ void UpdatesManager::process_postponed_pts_updates() {
       td_->messages_manager_->skip_old_pending_pts_update(std::move(update_it->update), new_pts, old_pts, pts_count,
                                                           "process_postponed_pts_updates");
       update_it->promise.set_value(Unit());
-      update_it = postponed_pts_updates_.erase(update_it);
+      postponed_pts_updates_.pop_front();
+      update_it = postponed_pts_updates_.begin();
       continue;
     }
 
@@ -3198,9 +3301,11 @@ void UpdatesManager::process_postponed_pts_updates() {
       if (update_it->pts_count > 0) {
         applied_update_count++;
         td_->messages_manager_->process_pts_update(std::move(update_it->update));
+        UpdateDeliveryStats::on_update_processed(update_it->receive_time);
       }
       update_it->promise.set_value(Unit());
-      update_it = postponed_pts_updates_.erase(update_it);
+      postponed_pts_updates_.pop_front();
+      update_it = postponed_pts_updates_.begin();
     }
     old_pts = new_pts;
   }
@@ -3243,6 +3348,7 @@ void UpdatesManager::process_pending_pts_updates() {
     applied_update_count++;
     if (update.pts_count > 0) {
       td_->messages_manager_->process_pts_update(std::move(update.update));
+      UpdateDeliveryStats::on_update_processed(update.receive_time);
       set_pts(update.pts, "process_pending_pts_updates")
           .set_value(Unit());  // TODO can't set until data are really stored on persistent storage
 
@@ -3255,7 +3361,7 @@ void UpdatesManager::process_pending_pts_updates() {
       LOG(INFO) << "Skip because of pts_count == 0 " << to_string(update.update);
     }
     update.promise.set_value(Unit());
-    pending_pts_updates_.erase(update_it);
+    pending_pts_updates_.pop_front();
   }
   if (applied_update_count > 0) {
     min_pts_gap_timeout_.cancel_timeout();
@@ -4167,7 +4273,7 @@ void UpdatesManager::on_update(tl_object_ptr<telegram_api::updateConfig> update,
 }
 
 void UpdatesManager::on_update(tl_object_ptr<telegram_api::updatePtsChanged> update, Promise<Unit> &&promise) {
-  if (td_->option_manager_->get_option_integer("session_count") > 1) {
+  if (td_->option_manager_->get_option_integer(CachedOption::SessionCount) > 1) {
     auto old_pts = get_pts();
     auto new_pts = 1;
     if (old_pts != new_pts) {
@@ -192,6 +192,48 @@ class UpdatesManager final : public Actor {
     }
   };
 
+  // sorted PTS updates in contiguous storage; updates are almost always added in PTS order and removed from the front
+  class PendingPtsUpdates {
+   public:
+    using iterator = vector<PendingPtsUpdate>::iterator;
+
+    bool empty() const {
+      return begin_pos_ == updates_.size();
+    }
+
+    size_t size() const {
+      return updates_.size() - begin_pos_;
+    }
+
+    iterator begin() {
+      return updates_.begin() + begin_pos_;
+    }
+
+    iterator end() {
+      return updates_.end();
+    }
+
+    const PendingPtsUpdate &back() const {
+      CHECK(!empty());
+      return updates_.back();
+    }
+
+    void emplace(tl_object_ptr<telegram_api::Update> &&update, int32 pts, int32 pts_count, double receive_time,
+                 Promise<Unit> &&promise);
+
+    // doesn't invalidate iterators to the remaining updates
+    void pop_front();
+
+    void clear() {
+      updates_.clear();
+      begin_pos_ = 0;
+    }
+
+   private:
+    vector<PendingPtsUpdate> updates_;
+    size_t begin_pos_ = 0;
+  };
+
   class PendingSeqUpdates {
    public:
     int32 seq_begin;
@@ -259,8 +301,8 @@ class UpdatesManager final : public Actor {
   double last_pts_jump_warning_time_ = 0;
   double last_pts_gap_time_ = 0;
 
-  std::multiset<PendingPtsUpdate> pending_pts_updates_;
-  std::multiset<PendingPtsUpdate> postponed_pts_updates_;
+  PendingPtsUpdates pending_pts_updates_;
+  PendingPtsUpdates postponed_pts_updates_;
 
   std::multiset<PendingSeqUpdates> postponed_updates_;    // updates received during getDifference
   std::multiset<PendingSeqUpdates> pending_seq_updates_;  // updates with too big seq
@@ -291,6 +333,17 @@ class UpdatesManager final : public Actor {
   double get_difference_start_time_ = 0;  // time from which we started to get difference without success
   int32 get_difference_retry_count_ = 0;
 
+  // the next getDifference request, sent while the previous difference slice is processed
+  bool is_prefetching_difference_ = false;
+  bool is_prefetched_difference_usable_ = false;  // the state from which the difference was requested was reached
+  bool is_prefetched_difference_received_ = false;
+  bool is_waiting_for_prefetched_difference_ = false;
+  int32 prefetched_difference_pts_ = 0;
+  int32 prefetched_difference_date_ = 0;
+  int32 prefetched_difference_qts_ = 0;
+  uint64 prefetched_difference_generation_ = 0;
+  Result<tl_object_ptr<telegram_api::updates_Difference>> prefetched_difference_;
+
   struct SessionInfo {
     uint64 update_count = 0;
     double first_update_time = 0.0;
@@ -414,6 +467,14 @@ class UpdatesManager final : public Actor {
 
   void run_get_difference(bool is_recursive, const char *source);
 
+  void prefetch_difference(int32 pts, int32 date, int32 qts);
+
+  void on_get_prefetched_difference(uint64 generation, Result<tl_object_ptr<telegram_api::updates_Difference>> result);
+
+  void apply_prefetched_difference();
+
+  void drop_prefetched_difference();
+
   void confirm_pts_qts(int32 qts);
 
   void on_failed_get_updates_state(Status &&error);
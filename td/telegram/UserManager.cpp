@@ -37,6 +37,7 @@
 #include "td/telegram/LinkManager.h"
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/logevent/LogEventHelper.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageId.h"
 #include "td/telegram/MessagesManager.h"
 #include "td/telegram/MessageTtl.h"
@@ -85,6 +86,7 @@
 #include "td/utils/utf8.h"
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <type_traits>
 #include <unordered_map>
@@ -2049,6 +2051,9 @@ UserManager::UserManager(Td *td, ActorShared<> parent) : td_(td), parent_(std::m
   user_online_timeout_.set_callback(on_user_online_timeout_callback);
   user_online_timeout_.set_callback_data(static_cast<void *>(this));
 
+  user_status_update_timeout_.set_callback(on_user_status_update_timeout_callback);
+  user_status_update_timeout_.set_callback_data(static_cast<void *>(this));
+
   user_emoji_status_timeout_.set_callback(on_user_emoji_status_timeout_callback);
   user_emoji_status_timeout_.set_callback_data(static_cast<void *>(this));
 
@@ -2084,30 +2089,118 @@ void UserManager::tear_down() {
   LOG(DEBUG) << "Have " << users_full_.calc_size() << " full users to free";
 }
 
-void UserManager::on_user_online_timeout_callback(void *user_manager_ptr, int64 user_id_long) {
+void UserManager::on_user_online_timeout_callback(void *user_manager_ptr, int64 expire_time) {
   if (G()->close_flag()) {
     return;
   }
 
   auto user_manager = static_cast<UserManager *>(user_manager_ptr);
-  send_closure_later(user_manager->actor_id(user_manager), &UserManager::on_user_online_timeout, UserId(user_id_long));
+  send_closure_later(user_manager->actor_id(user_manager), &UserManager::on_user_online_timeout, expire_time);
 }
 
-void UserManager::on_user_online_timeout(UserId user_id) {
+void UserManager::on_user_online_timeout(int64 expire_time) {
   if (G()->close_flag()) {
     return;
   }
 
-  auto u = get_user(user_id);
-  CHECK(u != nullptr);
-  CHECK(u->is_update_user_sent);
+  auto it = user_online_timeout_user_ids_.find(expire_time);
+  if (it == user_online_timeout_user_ids_.end()) {
+    return;
+  }
+  auto user_ids = std::move(it->second);
+  user_online_timeout_user_ids_.erase(it);
+
+  LOG(INFO) << "Update online status of " << user_ids.size() << " users to offline";
+  auto unix_time = G()->unix_time();
+  for (auto user_id : user_ids) {
+    user_online_expire_times_.erase(user_id);
+
+    auto u = get_user(user_id);
+    CHECK(u != nullptr);
+    CHECK(u->is_update_user_sent);
+
+    send_update_user_status(user_id, u, unix_time);
+
+    td_->dialog_participant_manager_->update_user_online_member_count(user_id);
+  }
+}
+
+void UserManager::set_user_online_timeout(UserId user_id, double left_time) {
+  auto expire_time = static_cast<int64>(std::ceil(G()->server_time() + left_time));
+  auto &old_expire_time = user_online_expire_times_[user_id];
+  if (old_expire_time == expire_time) {
+    return;
+  }
+  if (old_expire_time != 0) {
+    auto it = user_online_timeout_user_ids_.find(old_expire_time);
+    CHECK(it != user_online_timeout_user_ids_.end());
+    it->second.erase(user_id);
+    if (it->second.empty()) {
+      user_online_timeout_.cancel_timeout(old_expire_time);
+      user_online_timeout_user_ids_.erase(it);
+    }
+  }
+  old_expire_time = expire_time;
+
+  auto &user_ids = user_online_timeout_user_ids_[expire_time];
+  if (user_ids.empty()) {
+    user_online_timeout_.set_timeout_in(expire_time, static_cast<double>(expire_time) - G()->server_time());
+  }
+  user_ids.insert(user_id);
+}
+
+void UserManager::cancel_user_online_timeout(UserId user_id) {
+  auto expire_time_it = user_online_expire_times_.find(user_id);
+  if (expire_time_it == user_online_expire_times_.end()) {
+    return;
+  }
+  auto it = user_online_timeout_user_ids_.find(expire_time_it->second);
+  CHECK(it != user_online_timeout_user_ids_.end());
+  it->second.erase(user_id);
+  if (it->second.empty()) {
+    user_online_timeout_.cancel_timeout(expire_time_it->second);
+    user_online_timeout_user_ids_.erase(it);
+  }
+  user_online_expire_times_.erase(expire_time_it);
+}
 
-  LOG(INFO) << "Update " << user_id << " online status to offline";
-  send_closure(G()->td(), &Td::send_update,
-               td_api::make_object<td_api::updateUserStatus>(user_id.get(),
-                                                             get_user_status_object(user_id, u, G()->unix_time())));
+void UserManager::send_update_user_status(UserId user_id, const User *u, int32 unix_time) {
+  auto delay = td_->option_manager_->get_option_integer("user_status_update_delay");
+  if (delay > 0) {
+    pending_user_status_updates_.insert(user_id);
+    user_status_update_timeout_.add_timeout_in(0, static_cast<double>(delay));
+    return;
+  }
+
+  send_closure(
+      G()->td(), &Td::send_update,
+      td_api::make_object<td_api::updateUserStatus>(user_id.get(), get_user_status_object(user_id, u, unix_time)));
+}
+
+void UserManager::on_user_status_update_timeout_callback(void *user_manager_ptr, int64 unused) {
+  if (G()->close_flag()) {
+    return;
+  }
 
-  td_->dialog_participant_manager_->update_user_online_member_count(user_id);
+  auto user_manager = static_cast<UserManager *>(user_manager_ptr);
+  send_closure_later(user_manager->actor_id(user_manager), &UserManager::flush_pending_user_status_updates);
+}
+
+void UserManager::flush_pending_user_status_updates() {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  LOG(INFO) << "Send status of " << pending_user_status_updates_.size() << " users";
+  auto unix_time = G()->unix_time();
+  for (auto user_id : pending_user_status_updates_) {
+    auto u = get_user(user_id);
+    CHECK(u != nullptr);
+    send_closure(
+        G()->td(), &Td::send_update,
+        td_api::make_object<td_api::updateUserStatus>(user_id.get(), get_user_status_object(user_id, u, unix_time)));
+  }
+  pending_user_status_updates_.clear();
 }
 
 void UserManager::on_user_emoji_status_timeout_callback(void *user_manager_ptr, int64 user_id_long) {
@@ -3219,7 +3312,7 @@ void UserManager::on_update_user_is_blocked(UserId user_id, bool is_blocked, boo
     return;
   }
 
-  UserFull *user_full = get_user_full_force(user_id, "on_update_user_is_blocked");
+  UserFull *user_full = get_user_full_for_update(user_id, "on_update_user_is_blocked");
   if (user_full == nullptr) {
     return;
   }
@@ -3249,7 +3342,7 @@ void UserManager::on_update_user_has_pinned_stories(UserId user_id, bool has_pin
     return;
   }
 
-  UserFull *user_full = get_user_full_force(user_id, "on_update_user_has_pinned_stories");
+  UserFull *user_full = get_user_full_for_update(user_id, "on_update_user_has_pinned_stories");
   if (user_full == nullptr || user_full->has_pinned_stories == has_pinned_stories) {
     return;
   }
@@ -3412,7 +3505,7 @@ void UserManager::on_update_user_need_phone_number_privacy_exception(UserId user
     return;
   }
 
-  UserFull *user_full = get_user_full_force(user_id, "on_update_user_need_phone_number_privacy_exception");
+  UserFull *user_full = get_user_full_for_update(user_id, "on_update_user_need_phone_number_privacy_exception");
   if (user_full == nullptr) {
     return;
   }
@@ -3442,7 +3535,7 @@ void UserManager::on_update_user_wallpaper_overridden(UserId user_id, bool wallp
     return;
   }
 
-  UserFull *user_full = get_user_full_force(user_id, "on_update_user_wallpaper_overridden");
+  UserFull *user_full = get_user_full_for_update(user_id, "on_update_user_wallpaper_overridden");
   if (user_full == nullptr) {
     return;
   }
@@ -3472,7 +3565,7 @@ void UserManager::on_update_bot_menu_button(UserId bot_user_id,
     return;
   }
 
-  auto user_full = get_user_full_force(bot_user_id, "on_update_bot_menu_button");
+  auto user_full = get_user_full_for_update(bot_user_id, "on_update_bot_menu_button");
   if (user_full != nullptr) {
     on_update_user_full_menu_button(user_full, bot_user_id, std::move(bot_menu_button));
     update_user_full(user_full, bot_user_id, "on_update_bot_menu_button");
@@ -3507,7 +3600,7 @@ void UserManager::on_update_bot_has_preview_medias(UserId bot_user_id, bool has_
     return;
   }
 
-  auto user_full = get_user_full_force(bot_user_id, "on_update_bot_has_preview_medias");
+  auto user_full = get_user_full_for_update(bot_user_id, "on_update_bot_has_preview_medias");
   if (user_full != nullptr) {
     on_update_user_full_has_preview_medias(user_full, bot_user_id, has_preview_medias);
     update_user_full(user_full, bot_user_id, "on_update_bot_has_preview_medias");
@@ -3684,12 +3777,47 @@ void UserManager::save_user_to_database_impl(User *u, UserId user_id, string val
   u->is_saved = true;
   u->is_status_saved = true;
   LOG(INFO) << "Trying to save to database " << user_id;
-  G()->td_db()->get_sqlite_pmc()->set(
-      get_user_database_key(user_id), std::move(value), PromiseCreator::lambda([user_id](Result<> result) {
-        send_closure(G()->user_manager(), &UserManager::on_save_user_to_database, user_id, result.is_ok());
+  if (pending_saved_users_.empty()) {
+    set_timeout_in(MAX_SAVE_TO_DATABASE_DELAY);
+  }
+  pending_saved_users_.emplace_back(user_id, std::move(value));
+  if (pending_saved_users_.size() >= MAX_SAVE_TO_DATABASE_BATCH_SIZE) {
+    flush_pending_saved_users();
+  }
+}
+
+void UserManager::timeout_expired() {
+  flush_pending_saved_users();
+}
+
+void UserManager::flush_pending_saved_users() {
+  if (pending_saved_users_.empty()) {
+    return;
+  }
+  cancel_timeout();
+
+  FlatHashMap<string, string> key_values;
+  vector<UserId> user_ids;
+  for (auto &user : pending_saved_users_) {
+    key_values.emplace(get_user_database_key(user.first), std::move(user.second));
+    user_ids.push_back(user.first);
+  }
+  pending_saved_users_.clear();
+
+  LOG(INFO) << "Save " << user_ids.size() << " users to database";
+  G()->td_db()->get_sqlite_pmc()->set_all(
+      std::move(key_values), PromiseCreator::lambda([user_ids = std::move(user_ids)](Result<Unit> result) mutable {
+        send_closure(G()->user_manager(), &UserManager::on_save_users_to_database, std::move(user_ids),
+                     result.is_ok());
       }));
 }
 
+void UserManager::on_save_users_to_database(vector<UserId> user_ids, bool success) {
+  for (auto user_id : user_ids) {
+    on_save_user_to_database(user_id, success);
+  }
+}
+
 void UserManager::on_save_user_to_database(UserId user_id, bool success) {
   if (G()->close_flag()) {
     return;
@@ -5269,7 +5397,7 @@ void UserManager::on_set_personal_channel(ChannelId channel_id, Promise<Unit> &&
 }
 
 void UserManager::set_emoji_status(const EmojiStatus &emoji_status, Promise<Unit> &&promise) {
-  if (!td_->option_manager_->get_option_boolean("is_premium")) {
+  if (!td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
     return promise.set_error(Status::Error(400, "The method is available only to Telegram Premium users"));
   }
   add_recent_emoji_status(td_, emoji_status);
@@ -5689,7 +5817,7 @@ void UserManager::can_send_message_to_user(UserId user_id, bool force,
   }
   CHECK(user_id.is_valid());
   if ((u != nullptr && (!u->contact_require_premium || u->is_mutual_contact)) ||
-      td_->option_manager_->get_option_boolean("is_premium")) {
+      td_->option_manager_->get_option_boolean(CachedOption::IsPremium)) {
     return promise.set_value(td_api::make_object<td_api::canSendMessageToUserResultOk>());
   }
 
@@ -6038,12 +6166,6 @@ void UserManager::do_import_contacts(vector<Contact> contacts, int64 random_id,
     return promise.set_value(Unit());
   }
 
-  vector<telegram_api::object_ptr<telegram_api::inputPhoneContact>> input_phone_contacts;
-  input_phone_contacts.reserve(size);
-  for (size_t i = 0; i < size; i++) {
-    input_phone_contacts.push_back(contacts[i].get_input_phone_contact(static_cast<int64>(i)));
-  }
-
   auto task = make_unique<ImportContactsTask>();
   task->promise_ = std::move(promise);
   task->input_contacts_ = std::move(contacts);
@@ -6053,7 +6175,27 @@ void UserManager::do_import_contacts(vector<Contact> contacts, int64 random_id,
   bool is_added = import_contact_tasks_.emplace(random_id, std::move(task)).second;
   CHECK(is_added);
 
-  td_->create_handler<ImportContactsQuery>()->send(std::move(input_phone_contacts), random_id);
+  send_import_contacts_queries(random_id);
+}
+
+void UserManager::send_import_contacts_queries(int64 random_id) {
+  auto it = import_contact_tasks_.find(random_id);
+  CHECK(it != import_contact_tasks_.end());
+  auto task = it->second.get();
+  auto total_size = task->input_contacts_.size();
+  while (task->active_query_count_ < MAX_ACTIVE_IMPORT_CONTACTS_QUERIES && task->next_contact_pos_ < total_size) {
+    auto end_pos = min(total_size, task->next_contact_pos_ + MAX_IMPORT_CONTACTS_CHUNK_SIZE);
+    vector<telegram_api::object_ptr<telegram_api::inputPhoneContact>> input_phone_contacts;
+    input_phone_contacts.reserve(end_pos - task->next_contact_pos_);
+    for (size_t i = task->next_contact_pos_; i < end_pos; i++) {
+      input_phone_contacts.push_back(task->input_contacts_[i].get_input_phone_contact(static_cast<int64>(i)));
+    }
+    LOG(INFO) << "Import contacts from " << task->next_contact_pos_ << " to " << end_pos << " out of " << total_size
+              << " with random_id " << random_id;
+    task->next_contact_pos_ = end_pos;
+    task->active_query_count_++;
+    td_->create_handler<ImportContactsQuery>()->send(std::move(input_phone_contacts), random_id);
+  }
 }
 
 void UserManager::on_imported_contacts(
@@ -6063,51 +6205,71 @@ void UserManager::on_imported_contacts(
   CHECK(it->second != nullptr);
 
   auto task = it->second.get();
+  CHECK(task->active_query_count_ > 0);
+  task->active_query_count_--;
   if (result.is_error()) {
-    auto promise = std::move(task->promise_);
-    import_contact_tasks_.erase(it);
-    return promise.set_error(result.move_as_error());
-  }
+    if (task->error_.is_ok()) {
+      task->error_ = result.move_as_error();
+    }
+  } else {
+    auto imported_contacts = result.move_as_ok();
+    on_get_users(std::move(imported_contacts->users_), "on_imported_contacts");
 
-  auto imported_contacts = result.move_as_ok();
-  on_get_users(std::move(imported_contacts->users_), "on_imported_contacts");
+    for (auto &imported_contact : imported_contacts->imported_) {
+      int64 client_id = imported_contact->client_id_;
+      if (client_id < 0 || client_id >= static_cast<int64>(task->imported_user_ids_.size())) {
+        LOG(ERROR) << "Wrong client_id " << client_id << " returned";
+        continue;
+      }
 
-  for (auto &imported_contact : imported_contacts->imported_) {
-    int64 client_id = imported_contact->client_id_;
-    if (client_id < 0 || client_id >= static_cast<int64>(task->imported_user_ids_.size())) {
-      LOG(ERROR) << "Wrong client_id " << client_id << " returned";
-      continue;
+      task->imported_user_ids_[static_cast<size_t>(client_id)] = UserId(imported_contact->user_id_);
     }
+    for (auto &popular_contact : imported_contacts->popular_invites_) {
+      int64 client_id = popular_contact->client_id_;
+      if (client_id < 0 || client_id >= static_cast<int64>(task->unimported_contact_invites_.size())) {
+        LOG(ERROR) << "Wrong client_id " << client_id << " returned";
+        continue;
+      }
+      if (popular_contact->importers_ < 0) {
+        LOG(ERROR) << "Wrong number of importers " << popular_contact->importers_ << " returned";
+        continue;
+      }
 
-    task->imported_user_ids_[static_cast<size_t>(client_id)] = UserId(imported_contact->user_id_);
-  }
-  for (auto &popular_contact : imported_contacts->popular_invites_) {
-    int64 client_id = popular_contact->client_id_;
-    if (client_id < 0 || client_id >= static_cast<int64>(task->unimported_contact_invites_.size())) {
-      LOG(ERROR) << "Wrong client_id " << client_id << " returned";
-      continue;
-    }
-    if (popular_contact->importers_ < 0) {
-      LOG(ERROR) << "Wrong number of importers " << popular_contact->importers_ << " returned";
-      continue;
+      task->unimported_contact_invites_[static_cast<size_t>(client_id)] = popular_contact->importers_;
     }
 
-    task->unimported_contact_invites_[static_cast<size_t>(client_id)] = popular_contact->importers_;
+    if (!imported_contacts->retry_contacts_.empty() && task->error_.is_ok()) {
+      auto total_size = static_cast<int64>(task->input_contacts_.size());
+      vector<telegram_api::object_ptr<telegram_api::inputPhoneContact>> input_phone_contacts;
+      input_phone_contacts.reserve(imported_contacts->retry_contacts_.size());
+      for (auto &client_id : imported_contacts->retry_contacts_) {
+        if (client_id < 0 || client_id >= total_size) {
+          LOG(ERROR) << "Wrong client_id " << client_id << " returned";
+          continue;
+        }
+        auto i = static_cast<size_t>(client_id);
+        input_phone_contacts.push_back(task->input_contacts_[i].get_input_phone_contact(client_id));
+      }
+      if (!input_phone_contacts.empty()) {
+        task->active_query_count_++;
+        td_->create_handler<ImportContactsQuery>()->send(std::move(input_phone_contacts), random_id);
+      }
+    }
   }
 
-  if (!imported_contacts->retry_contacts_.empty()) {
-    auto total_size = static_cast<int64>(task->input_contacts_.size());
-    vector<telegram_api::object_ptr<telegram_api::inputPhoneContact>> input_phone_contacts;
-    input_phone_contacts.reserve(imported_contacts->retry_contacts_.size());
-    for (auto &client_id : imported_contacts->retry_contacts_) {
-      if (client_id < 0 || client_id >= total_size) {
-        LOG(ERROR) << "Wrong client_id " << client_id << " returned";
-        continue;
-      }
-      auto i = static_cast<size_t>(client_id);
-      input_phone_contacts.push_back(task->input_contacts_[i].get_input_phone_contact(client_id));
+  if (task->error_.is_error()) {
+    if (task->active_query_count_ > 0) {
+      // wait for the other queries to finish before the task is destroyed
+      return;
     }
-    td_->create_handler<ImportContactsQuery>()->send(std::move(input_phone_contacts), random_id);
+    auto promise = std::move(task->promise_);
+    auto error = std::move(task->error_);
+    import_contact_tasks_.erase(it);
+    return promise.set_error(std::move(error));
+  }
+
+  send_import_contacts_queries(random_id);
+  if (task->active_query_count_ > 0) {
     return;
   }
 
@@ -6776,6 +6938,20 @@ UserManager::UserFull *UserManager::get_user_full_force(UserId user_id, const ch
   return get_user_full(user_id);
 }
 
+UserManager::UserFull *UserManager::get_user_full_for_update(UserId user_id, const char *source) {
+  UserFull *user_full = get_user_full(user_id);
+  if (user_full != nullptr || !G()->use_chat_info_database() || !have_user_force(user_id, source)) {
+    return user_full;
+  }
+  if (unavailable_user_fulls_.insert(user_id).second) {
+    // loading of the full info from the database would cause its reload from the server anyway,
+    // so it is cheaper to drop the outdated full info and keep it unloaded until it is requested
+    LOG(INFO) << "Drop full " << user_id << " from database from " << source;
+    G()->td_db()->get_sqlite_pmc()->erase(get_user_full_database_key(user_id), Auto());
+  }
+  return nullptr;
+}
+
 void UserManager::load_user_full(UserId user_id, bool force, Promise<Unit> &&promise, const char *source) {
   auto u = get_user(user_id);
   if (u == nullptr) {
@@ -7520,7 +7696,7 @@ void UserManager::update_user(User *u, UserId user_id, bool from_binlog, bool fr
   };
 
   if (user_id == get_my_id()) {
-    if (td_->option_manager_->get_option_boolean("is_premium") != u->is_premium) {
+    if (td_->option_manager_->get_option_boolean(CachedOption::IsPremium) != u->is_premium) {
       td_->option_manager_->set_option_boolean("is_premium", u->is_premium);
       send_closure(td_->config_manager_, &ConfigManager::request_config, true);
       if (!td_->auth_manager_->is_bot()) {
@@ -7604,10 +7780,10 @@ void UserManager::update_user(User *u, UserId user_id, bool from_binlog, bool fr
     if (left_time >= 0 && left_time < 30 * 86400) {
       left_time += 2.0;  // to guarantee expiration
       LOG(DEBUG) << "Set online timeout for " << user_id << " in " << left_time << " seconds";
-      user_online_timeout_.set_timeout_in(user_id.get(), left_time);
+      set_user_online_timeout(user_id, left_time);
     } else {
       LOG(DEBUG) << "Cancel online timeout for " << user_id;
-      user_online_timeout_.cancel_timeout(user_id.get());
+      cancel_user_online_timeout(user_id);
     }
   }
   if (u->is_stories_hidden_changed) {
@@ -7672,15 +7848,14 @@ void UserManager::update_user(User *u, UserId user_id, bool from_binlog, bool fr
     u->is_changed = false;
     u->is_status_changed = false;
     u->is_update_user_sent = true;
+    pending_user_status_updates_.erase(user_id);  // the status was sent in updateUser
   }
   if (u->is_status_changed) {
     if (!from_database) {
       u->is_status_saved = false;
     }
     CHECK(u->is_update_user_sent);
-    send_closure(
-        G()->td(), &Td::send_update,
-        td_api::make_object<td_api::updateUserStatus>(user_id.get(), get_user_status_object(user_id, u, unix_time)));
+    send_update_user_status(user_id, u, unix_time);
     u->is_status_changed = false;
   }
   if (u->is_online_status_changed) {
@@ -7995,12 +8170,13 @@ td_api::object_ptr<td_api::userFullInfo> UserManager::get_user_full_info_object(
     bio.text = user_full->about;
     bio.entities = find_entities(bio.text, true, true);
     if (!is_premium) {
+      Utf8Utf16SubstrFinder substr_finder(bio.text);
       td::remove_if(bio.entities, [&](const MessageEntity &entity) {
         if (entity.type == MessageEntity::Type::EmailAddress) {
           return true;
         }
         if (entity.type == MessageEntity::Type::Url &&
-            !LinkManager::is_internal_link(utf8_utf16_substr(bio.text, entity.offset, entity.length))) {
+            !LinkManager::is_internal_link(substr_finder.substr(entity.offset, entity.length))) {
           return true;
         }
         return false;
@@ -8099,6 +8275,13 @@ td_api::object_ptr<td_api::secretChat> UserManager::get_secret_chat_object_const
                                                  secret_chat->is_outbound, secret_chat->key_hash, secret_chat->layer);
 }
 
+void UserManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  statistics.add_objects<User>("user_manager.users", users_.calc_size());
+  statistics.add_objects<UserFull>("user_manager.users_full", users_full_.calc_size());
+  statistics.add_objects<UserPhotos>("user_manager.user_photos", user_photos_.calc_size());
+  statistics.add_objects<SecretChat>("user_manager.secret_chats", secret_chats_.calc_size());
+}
+
 void UserManager::get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const {
   for (auto user_id : unknown_users_) {
     if (!have_min_user(user_id)) {
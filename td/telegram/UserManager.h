@@ -62,6 +62,7 @@ class BusinessGreetingMessage;
 class BusinessInfo;
 class BusinessIntro;
 class BusinessWorkHours;
+class MemoryStatistics;
 class Td;
 
 class UserManager final : public Actor {
@@ -468,6 +469,8 @@ class UserManager final : public Actor {
 
   td_api::object_ptr<td_api::secretChat> get_secret_chat_object(SecretChatId secret_chat_id);
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   void get_current_state(vector<td_api::object_ptr<td_api::Update>> &updates) const;
 
  private:
@@ -686,6 +689,14 @@ class UserManager final : public Actor {
 
   static constexpr int32 MAX_ACTIVE_STORY_ID_RELOAD_TIME = 3600;  // some reasonable limit
 
+  // objects are saved to the database in batches to write them in one transaction
+  static constexpr double MAX_SAVE_TO_DATABASE_DELAY = 0.05;
+  static constexpr size_t MAX_SAVE_TO_DATABASE_BATCH_SIZE = 1000;
+
+  // contacts are imported in chunks with several chunks being imported simultaneously
+  static constexpr size_t MAX_IMPORT_CONTACTS_CHUNK_SIZE = 500;
+  static constexpr size_t MAX_ACTIVE_IMPORT_CONTACTS_QUERIES = 3;
+
   // the True fields aren't set for manually created telegram_api::user objects, therefore the flags must be used
   static constexpr int32 USER_FLAG_HAS_ACCESS_HASH = 1 << 0;
   static constexpr int32 USER_FLAG_HAS_FIRST_NAME = 1 << 1;
@@ -728,9 +739,21 @@ class UserManager final : public Actor {
 
   void tear_down() final;
 
-  static void on_user_online_timeout_callback(void *user_manager_ptr, int64 user_id_long);
+  void timeout_expired() final;
+
+  static void on_user_online_timeout_callback(void *user_manager_ptr, int64 expire_time);
+
+  void on_user_online_timeout(int64 expire_time);
+
+  void set_user_online_timeout(UserId user_id, double left_time);
+
+  void cancel_user_online_timeout(UserId user_id);
+
+  void send_update_user_status(UserId user_id, const User *u, int32 unix_time);
 
-  void on_user_online_timeout(UserId user_id);
+  static void on_user_status_update_timeout_callback(void *user_manager_ptr, int64 unused);
+
+  void flush_pending_user_status_updates();
 
   static void on_user_emoji_status_timeout_callback(void *user_manager_ptr, int64 user_id_long);
 
@@ -756,6 +779,10 @@ class UserManager final : public Actor {
 
   void on_save_user_to_database(UserId user_id, bool success);
 
+  void flush_pending_saved_users();
+
+  void on_save_users_to_database(vector<UserId> user_ids, bool success);
+
   void load_user_from_database(User *u, UserId user_id, Promise<Unit> promise);
 
   void load_user_from_database_impl(UserId user_id, Promise<Unit> promise);
@@ -907,6 +934,8 @@ class UserManager final : public Actor {
 
   void do_import_contacts(vector<Contact> contacts, int64 random_id, Promise<Unit> &&promise);
 
+  void send_import_contacts_queries(int64 random_id);
+
   void on_import_contacts_finished(int64 random_id, vector<UserId> imported_contact_user_ids,
                                    vector<int32> unimported_contact_invites);
 
@@ -929,6 +958,9 @@ class UserManager final : public Actor {
 
   UserFull *get_user_full_force(UserId user_id, const char *source);
 
+  // returns full info of the user, only if it is already in memory
+  UserFull *get_user_full_for_update(UserId user_id, const char *source);
+
   void send_get_user_full_query(UserId user_id, telegram_api::object_ptr<telegram_api::InputUser> &&input_user,
                                 Promise<Unit> &&promise, const char *source);
 
@@ -1078,6 +1110,9 @@ class UserManager final : public Actor {
     vector<Contact> input_contacts_;
     vector<UserId> imported_user_ids_;
     vector<int32> unimported_contact_invites_;
+    size_t next_contact_pos_ = 0;  // position of the first contact, which wasn't sent yet
+    size_t active_query_count_ = 0;
+    Status error_;
   };
   FlatHashMap<int64, unique_ptr<ImportContactsTask>> import_contact_tasks_;
 
@@ -1123,8 +1158,19 @@ class UserManager final : public Actor {
   vector<UserId> imported_contact_user_ids_;  // result of change_imported_contacts
   vector<int32> unimported_contact_invites_;  // result of change_imported_contacts
 
-  MultiTimeout user_online_timeout_{"UserOnlineTimeout"};
+  // users, which online status expires, grouped by server time of the expiration in seconds,
+  // so that a single timeout is used for all users, which become offline at the same time
+  FlatHashMap<int64, FlatHashSet<UserId, UserIdHash>> user_online_timeout_user_ids_;
+  FlatHashMap<UserId, int64, UserIdHash> user_online_expire_times_;
+  MultiTimeout user_online_timeout_{"UserOnlineTimeout"};  // expire_time -> users from user_online_timeout_user_ids_
+
+  // users, which status has changed, but updateUserStatus wasn't sent yet because of "user_status_update_delay"
+  FlatHashSet<UserId, UserIdHash> pending_user_status_updates_;
+  MultiTimeout user_status_update_timeout_{"UserStatusUpdateTimeout"};
   MultiTimeout user_emoji_status_timeout_{"UserEmojiStatusTimeout"};
+
+  // users, which will be saved to the database together in one transaction
+  vector<std::pair<UserId, string>> pending_saved_users_;
 };
 
 }  // namespace td
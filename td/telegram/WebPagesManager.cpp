@@ -23,6 +23,7 @@
 #include "td/telegram/Global.h"
 #include "td/telegram/LinkManager.h"
 #include "td/telegram/logevent/LogEvent.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/MessageEntity.h"
 #include "td/telegram/MessagesManager.h"
 #include "td/telegram/Photo.h"
@@ -63,10 +64,15 @@
 #include "td/utils/tl_helpers.h"
 #include "td/utils/utf8.h"
 
+#include <atomic>
 #include <limits>
 
 namespace td {
 
+static std::atomic<uint64> instant_view_cache_hit_count{0};
+static std::atomic<uint64> instant_view_cache_miss_count{0};
+static std::atomic<uint64> instant_view_cache_eviction_count{0};
+
 class GetWebPagePreviewQuery final : public Td::ResultHandler {
   Promise<td_api::object_ptr<td_api::linkPreview>> promise_;
   unique_ptr<WebPagesManager::GetWebPagePreviewOptions> options_;
@@ -168,6 +174,7 @@ class WebPagesManager::WebPageInstantView {
   bool is_full_ = false;
   bool is_loaded_ = false;
   bool was_loaded_from_database_ = false;
+  size_t stored_size_ = 0;  // size of the instant view in the database; isn't stored
 
   template <class StorerT>
   void store(StorerT &storer) const {
@@ -537,6 +544,7 @@ WebPageId WebPagesManager::on_get_web_page(tl_object_ptr<telegram_api::WebPage>
                                                   get_web_page_file_ids(web_page_to_delete), vector<FileId>());
         }
         web_pages_.erase(web_page_id);
+        remove_cached_instant_view(web_page_id);
       }
 
       on_web_page_changed(web_page_id, false);
@@ -731,6 +739,7 @@ void WebPagesManager::update_web_page(unique_ptr<WebPage> web_page, WebPageId we
   }
 
   update_web_page_instant_view(web_page_id, page->instant_view_, std::move(old_instant_view));
+  update_cached_instant_view(web_page_id);
 
   auto new_file_ids = get_web_page_file_ids(page.get());
   if (old_file_ids != new_file_ids) {
@@ -795,8 +804,10 @@ void WebPagesManager::update_web_page_instant_view(WebPageId web_page_id, WebPag
       }
       */
       new_instant_view.was_loaded_from_database_ = true;
-      G()->td_db()->get_sqlite_pmc()->set(get_web_page_instant_view_database_key(web_page_id),
-                                          log_event_store(new_instant_view).as_slice().str(), Auto());
+      auto value = log_event_store(new_instant_view).as_slice().str();
+      new_instant_view.stored_size_ = value.size();
+      G()->td_db()->get_sqlite_pmc()->set(get_web_page_instant_view_database_key(web_page_id), std::move(value),
+                                          Auto());
     }
   }
 }
@@ -833,10 +844,13 @@ void WebPagesManager::on_get_web_page_instant_view_view_count(WebPageId web_page
     return;
   }
   instant_view->view_count_ = view_count;
-  if (G()->use_message_database()) {
+  if (G()->use_message_database() && instant_view->is_loaded_) {
     LOG(INFO) << "Save instant view of " << web_page_id << " to database after updating view count to " << view_count;
-    G()->td_db()->get_sqlite_pmc()->set(get_web_page_instant_view_database_key(web_page_id),
-                                        log_event_store(*instant_view).as_slice().str(), Auto());
+    auto value = log_event_store(*instant_view).as_slice().str();
+    instant_view->stored_size_ = value.size();
+    G()->td_db()->get_sqlite_pmc()->set(get_web_page_instant_view_database_key(web_page_id), std::move(value),
+                                        Auto());
+    update_cached_instant_view(web_page_id);
   }
 }
 
@@ -1056,8 +1070,13 @@ void WebPagesManager::get_web_page_instant_view_impl(WebPageId web_page_id, bool
   }
 
   if (!web_page_instant_view->is_loaded_ || (force_full && !web_page_instant_view->is_full_)) {
+    if (!web_page_instant_view->is_loaded_) {
+      instant_view_cache_miss_count.fetch_add(1, std::memory_order_relaxed);
+    }
     return load_web_page_instant_view(web_page_id, force_full, std::move(promise));
   }
+  instant_view_cache_hit_count.fetch_add(1, std::memory_order_relaxed);
+  on_use_cached_instant_view(web_page_id);
 
   if (force_full) {
     reload_web_page_instant_view(web_page_id);
@@ -1147,6 +1166,8 @@ void WebPagesManager::on_load_web_page_instant_view_from_database(WebPageId web_
 
       LOG(ERROR) << "Erase instant view in " << web_page_id << " from database because of " << status.message();
       G()->td_db()->get_sqlite_pmc()->erase(get_web_page_instant_view_database_key(web_page_id), Auto());
+    } else {
+      instant_view.stored_size_ = value.size();
     }
   }
   instant_view.was_loaded_from_database_ = true;
@@ -1154,6 +1175,7 @@ void WebPagesManager::on_load_web_page_instant_view_from_database(WebPageId web_
   auto old_file_ids = get_web_page_file_ids(web_page);
 
   update_web_page_instant_view(web_page_id, web_page_instant_view, std::move(instant_view));
+  update_cached_instant_view(web_page_id);
 
   auto new_file_ids = get_web_page_file_ids(web_page);
   if (old_file_ids != new_file_ids) {
@@ -1163,6 +1185,91 @@ void WebPagesManager::on_load_web_page_instant_view_from_database(WebPageId web_
   update_web_page_instant_view_load_requests(web_page_id, false, web_page_id);
 }
 
+void WebPagesManager::update_cached_instant_view(WebPageId web_page_id) {
+  const WebPage *web_page = get_web_page(web_page_id);
+  if (web_page == nullptr || !G()->use_message_database()) {
+    return remove_cached_instant_view(web_page_id);
+  }
+  const auto &instant_view = web_page->instant_view_;
+  // instant views of albums are needed synchronously to return link previews
+  if (instant_view.is_empty_ || !instant_view.is_loaded_ || !instant_view.was_loaded_from_database_ ||
+      instant_view.stored_size_ == 0 || can_web_page_be_album(web_page)) {
+    return remove_cached_instant_view(web_page_id);
+  }
+
+  auto &cached_instant_view = cached_instant_views_[web_page_id];
+  if (cached_instant_view.last_use_ != 0) {
+    cached_instant_view_uses_.erase(cached_instant_view.last_use_);
+    cached_instant_views_size_ -= cached_instant_view.size_;
+  }
+  cached_instant_view.size_ = instant_view.stored_size_;
+  cached_instant_view.last_use_ = ++last_instant_view_use_;
+  cached_instant_view_uses_.emplace(cached_instant_view.last_use_, web_page_id);
+  cached_instant_views_size_ += cached_instant_view.size_;
+
+  // the just cached instant view is never evicted
+  while (cached_instant_views_size_ > MAX_CACHED_INSTANT_VIEWS_SIZE && cached_instant_view_uses_.size() > 1) {
+    evict_instant_view(cached_instant_view_uses_.begin()->second);
+  }
+}
+
+void WebPagesManager::on_use_cached_instant_view(WebPageId web_page_id) {
+  auto it = cached_instant_views_.find(web_page_id);
+  if (it == cached_instant_views_.end()) {
+    return;
+  }
+  cached_instant_view_uses_.erase(it->second.last_use_);
+  it->second.last_use_ = ++last_instant_view_use_;
+  cached_instant_view_uses_.emplace(it->second.last_use_, web_page_id);
+}
+
+void WebPagesManager::remove_cached_instant_view(WebPageId web_page_id) {
+  auto it = cached_instant_views_.find(web_page_id);
+  if (it == cached_instant_views_.end()) {
+    return;
+  }
+  cached_instant_view_uses_.erase(it->second.last_use_);
+  cached_instant_views_size_ -= it->second.size_;
+  cached_instant_views_.erase(it);
+}
+
+void WebPagesManager::evict_instant_view(WebPageId web_page_id) {
+  remove_cached_instant_view(web_page_id);
+
+  WebPage *web_page = web_pages_.get_pointer(web_page_id);
+  if (web_page == nullptr || load_web_page_instant_view_queries_.count(web_page_id) != 0) {
+    return;
+  }
+  auto &instant_view = web_page->instant_view_;
+  if (instant_view.is_empty_ || !instant_view.is_loaded_ || !instant_view.was_loaded_from_database_) {
+    return;
+  }
+
+  LOG(INFO) << "Evict " << instant_view << " of " << web_page_id << " from memory";
+  instant_view_cache_eviction_count.fetch_add(1, std::memory_order_relaxed);
+  auto old_file_ids = get_web_page_file_ids(web_page);
+
+  // return the instant view to the state after loading of the web page from the database
+  reset_to_empty(instant_view.page_blocks_);
+  instant_view.is_full_ = false;
+  instant_view.is_loaded_ = false;
+  instant_view.was_loaded_from_database_ = false;
+  instant_view.stored_size_ = 0;
+
+  auto new_file_ids = get_web_page_file_ids(web_page);
+  if (old_file_ids != new_file_ids) {
+    td_->file_manager_->change_files_source(get_web_page_file_source_id(web_page), old_file_ids, new_file_ids);
+  }
+}
+
+WebPagesManager::InstantViewCacheStats WebPagesManager::get_instant_view_cache_stats() {
+  InstantViewCacheStats stats;
+  stats.hit_count = instant_view_cache_hit_count.load(std::memory_order_relaxed);
+  stats.miss_count = instant_view_cache_miss_count.load(std::memory_order_relaxed);
+  stats.eviction_count = instant_view_cache_eviction_count.load(std::memory_order_relaxed);
+  return stats;
+}
+
 void WebPagesManager::update_web_page_instant_view_load_requests(WebPageId web_page_id, bool force_update,
                                                                  Result<WebPageId> r_web_page_id) {
   G()->ignore_result_if_closing(r_web_page_id);
@@ -2020,6 +2127,13 @@ void WebPagesManager::on_story_changed(StoryFullId story_full_id) {
   }
 }
 
+void WebPagesManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  statistics.add_objects<WebPage>("web_pages_manager.web_pages", web_pages_.calc_size());
+  // the size of serialized instant views is used as an estimate of their size in memory
+  statistics.add_component("web_pages_manager.cached_instant_views", cached_instant_views_.size(),
+                           cached_instant_views_size_);
+}
+
 const WebPagesManager::WebPage *WebPagesManager::get_web_page(WebPageId web_page_id) const {
   return web_pages_.get_pointer(web_page_id);
 }
@@ -29,12 +29,15 @@
 #include "td/utils/Status.h"
 #include "td/utils/WaitFreeHashMap.h"
 
+#include <map>
 #include <utility>
 
 namespace td {
 
 struct BinlogEvent;
 
+class MemoryStatistics;
+
 class Td;
 
 class WebPagesManager final : public Actor {
@@ -115,7 +118,21 @@ class WebPagesManager final : public Actor {
 
   void on_story_changed(StoryFullId story_full_id);
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
+  struct InstantViewCacheStats {
+    uint64 hit_count = 0;
+    uint64 miss_count = 0;
+    uint64 eviction_count = 0;
+  };
+
+  // process-wide statistics of in-memory caches of instant views of all TDLib instances
+  static InstantViewCacheStats get_instant_view_cache_stats();
+
  private:
+  // maximum total size of instant views, which are kept in memory, but can be reloaded from the database
+  static constexpr size_t MAX_CACHED_INSTANT_VIEWS_SIZE = 16 << 20;
+
   class WebPage;
 
   class WebPageInstantView;
@@ -174,6 +191,14 @@ class WebPagesManager final : public Actor {
 
   void on_load_web_page_instant_view_from_database(WebPageId web_page_id, string value);
 
+  void update_cached_instant_view(WebPageId web_page_id);
+
+  void on_use_cached_instant_view(WebPageId web_page_id);
+
+  void remove_cached_instant_view(WebPageId web_page_id);
+
+  void evict_instant_view(WebPageId web_page_id);
+
   void reload_web_page_instant_view(WebPageId web_page_id);
 
   void update_web_page_instant_view_load_requests(WebPageId web_page_id, bool force_update,
@@ -213,6 +238,16 @@ class WebPagesManager final : public Actor {
   };
   FlatHashMap<WebPageId, PendingWebPageInstantViewQueries, WebPageIdHash> load_web_page_instant_view_queries_;
 
+  // loaded instant views, which are saved in the database, and can be evicted from memory
+  struct CachedInstantView {
+    size_t size_ = 0;
+    uint64 last_use_ = 0;
+  };
+  FlatHashMap<WebPageId, CachedInstantView, WebPageIdHash> cached_instant_views_;
+  std::map<uint64, WebPageId> cached_instant_view_uses_;  // last_use -> web_page_id
+  size_t cached_instant_views_size_ = 0;
+  uint64 last_instant_view_use_ = 0;
+
   FlatHashMap<WebPageId, FlatHashSet<MessageFullId, MessageFullIdHash>, WebPageIdHash> web_page_messages_;
   FlatHashMap<WebPageId, FlatHashSet<QuickReplyMessageFullId, QuickReplyMessageFullIdHash>, WebPageIdHash>
       web_page_quick_reply_messages_;
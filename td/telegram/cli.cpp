@@ -3418,6 +3418,8 @@ class CliClient final : public Actor {
       send_request(td_api::make_object<td_api::getCountryCode>());
     } else if (op == "gpni") {
       send_request(td_api::make_object<td_api::getPhoneNumberInfo>(args));
+    } else if (op == "gpnsi") {
+      send_request(td_api::make_object<td_api::getPhoneNumbersInfo>(autosplit_str(args)));
     } else if (op == "gpnis") {
       execute(td_api::make_object<td_api::getPhoneNumberInfoSync>(rand_bool() ? "en" : "", args));
     } else if (op == "gciu") {
@@ -3649,6 +3651,8 @@ class CliClient final : public Actor {
       send_request(td_api::make_object<td_api::getNetworkStatistics>(true));
     } else if (op == "reset_network") {
       send_request(td_api::make_object<td_api::resetNetworkStatistics>());
+    } else if (op == "gnrl") {
+      send_request(td_api::make_object<td_api::getNetworkRateLimits>());
     } else if (op == "snt") {
       send_request(td_api::make_object<td_api::setNetworkType>(as_network_type(args)));
     } else if (op == "gadsp") {
@@ -3998,6 +4002,16 @@ class CliClient final : public Actor {
       int64 count;
       get_args(args, file_id, offset, count);
       send_request(td_api::make_object<td_api::readFilePart>(file_id, offset, count));
+    } else if (op == "sfp") {
+      FileId file_id;
+      int64 offset;
+      int64 count;
+      int32 priority;
+      get_args(args, file_id, offset, count, priority);
+      if (priority <= 0) {
+        priority = 1;
+      }
+      send_request(td_api::make_object<td_api::streamFilePart>(file_id, priority, offset, count));
     } else if (op == "grf") {
       send_request(td_api::make_object<td_api::getRemoteFile>(args, nullptr));
     } else if (op == "gmtf") {
@@ -4071,6 +4085,20 @@ class CliClient final : public Actor {
       int32 priority;
       get_args(args, file_id, chat_id, message_id, priority);
       send_request(td_api::make_object<td_api::addFileToDownloads>(file_id, chat_id, message_id, max(priority, 1)));
+    } else if (op == "afstd") {
+      ChatId chat_id;
+      string message_ids;
+      string file_ids;
+      int32 priority;
+      get_args(args, chat_id, message_ids, file_ids, priority);
+      auto message_id_list = as_message_ids(message_ids);
+      auto file_id_list = as_file_ids(file_ids);
+      vector<td_api::object_ptr<td_api::messageFileToDownload>> files;
+      for (size_t i = 0; i < message_id_list.size() && i < file_id_list.size(); i++) {
+        files.push_back(
+            td_api::make_object<td_api::messageFileToDownload>(file_id_list[i], chat_id, message_id_list[i]));
+      }
+      send_request(td_api::make_object<td_api::addFilesToDownloads>(std::move(files), max(priority, 1)));
     } else if (op == "tdip") {
       FileId file_id;
       bool is_paused;
@@ -4085,6 +4113,11 @@ class CliClient final : public Actor {
       bool delete_from_cache;
       get_args(args, file_id, delete_from_cache);
       send_request(td_api::make_object<td_api::removeFileFromDownloads>(file_id, delete_from_cache));
+    } else if (op == "rfsfd") {
+      string file_ids;
+      bool delete_from_cache;
+      get_args(args, file_ids, delete_from_cache);
+      send_request(td_api::make_object<td_api::removeFilesFromDownloads>(as_file_ids(file_ids), delete_from_cache));
     } else if (op == "raffd" || op == "raffda" || op == "raffdc") {
       bool delete_from_cache;
       get_args(args, delete_from_cache);
@@ -7190,6 +7223,62 @@ class CliClient final : public Actor {
       } else {
         execute(std::move(request));
       }
+    } else if (op == "sasp") {
+      bool is_enabled;
+      int32 log_period;
+      get_args(args, is_enabled, log_period);
+      execute(td_api::make_object<td_api::setActorStatisticsParameters>(is_enabled, log_period));
+    } else if (op == "gas" || op == "gasr") {
+      execute(td_api::make_object<td_api::getActorStatistics>(op == "gasr"));
+    } else if (op == "sapsi") {
+      int32 sampling_interval;
+      get_args(args, sampling_interval);
+      execute(td_api::make_object<td_api::setActorProfilerSamplingInterval>(sampling_interval));
+    } else if (op == "gaps" || op == "gapsr") {
+      execute(td_api::make_object<td_api::getActorProfilerSamples>(op == "gapsr"));
+    } else if (op == "tdss") {
+      bool is_enabled;
+      get_args(args, is_enabled);
+      execute(td_api::make_object<td_api::toggleDatabaseStatementStatistics>(is_enabled));
+    } else if (op == "gdss" || op == "gdssr") {
+      execute(td_api::make_object<td_api::getDatabaseStatementStatistics>(op == "gdssr"));
+    } else if (op == "gamu") {
+      execute(td_api::make_object<td_api::getActorMemoryUsage>());
+    } else if (op == "gmemst") {
+      send_request(td_api::make_object<td_api::getMemoryStatistics>());
+    } else if (op == "tuds") {
+      bool is_enabled;
+      get_args(args, is_enabled);
+      execute(td_api::make_object<td_api::toggleUpdateDeliveryStatistics>(is_enabled));
+    } else if (op == "guds" || op == "gudsr") {
+      execute(td_api::make_object<td_api::getUpdateDeliveryStatistics>(op == "gudsr"));
+    } else if (op == "gnps" || op == "gnpsr") {
+      execute(td_api::make_object<td_api::getNetworkPacketStatistics>(op == "gnpsr"));
+    } else if (op == "gnqcs" || op == "gnqcsr") {
+      execute(td_api::make_object<td_api::getNetworkQueryCompressionStatistics>(op == "gnqcsr"));
+    } else if (op == "tnqls") {
+      bool is_enabled;
+      get_args(args, is_enabled);
+      execute(td_api::make_object<td_api::toggleNetworkQueryLatencyStatistics>(is_enabled));
+    } else if (op == "gnqls" || op == "gnqlsr") {
+      execute(td_api::make_object<td_api::getNetworkQueryLatencyStatistics>(op == "gnqlsr"));
+    } else if (op == "snqlsr") {
+      int32 sample_rate;
+      get_args(args, sample_rate);
+      execute(td_api::make_object<td_api::setNetworkQueryLogSampleRate>(sample_rate));
+    } else if (op == "sftbl") {
+      int64 bytes_per_second;
+      get_args(args, bytes_per_second);
+      execute(td_api::make_object<td_api::setFileTransferBandwidthLimit>(bytes_per_second));
+    } else if (op == "gftba") {
+      execute(td_api::make_object<td_api::getFileTransferBandwidthAllocations>());
+    } else if (op == "gperfs") {
+      execute(td_api::make_object<td_api::getPerformanceStatistics>());
+    } else if (op == "sperfsdp") {
+      string file_path;
+      int32 dump_period;
+      get_args(args, file_path, dump_period);
+      execute(td_api::make_object<td_api::setPerformanceStatisticsDumpParameters>(file_path, dump_period));
     } else if (op == "q" || op == "Quit") {
       quit();
     } else if (op == "dnq") {
@@ -0,0 +1,137 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/files/DownloadWindowController.h"
+
+#include "td/telegram/files/FileLoaderUtils.h"
+
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+
+#include <map>
+#include <mutex>
+
+namespace td {
+
+constexpr int64 DownloadWindowController::MIN_WINDOW;
+constexpr int64 DownloadWindowController::MAX_WINDOW;
+
+namespace {
+
+struct DcDownloadHistory {
+  double speed = 0.0;
+  double min_latency = 0.0;
+};
+
+struct DownloadHistory {
+  std::mutex mutex;
+  std::map<int32, DcDownloadHistory> dcs;
+};
+
+DownloadHistory &get_download_history() {
+  static DownloadHistory history;
+  return history;
+}
+
+// downloads of smaller size don't have enough parts to measure download speed
+constexpr int64 MIN_SAVED_DOWNLOAD_SIZE = 1 << 20;
+
+}  // namespace
+
+size_t DownloadWindowController::get_preferred_part_size(DcId dc_id) {
+  auto &history = get_download_history();
+  std::lock_guard<std::mutex> lock(history.mutex);
+  auto it = history.dcs.find(dc_id.get_raw_id());
+  if (it == history.dcs.end()) {
+    return 0;
+  }
+  // the initial window must cover the bandwidth-delay product
+  auto bandwidth_delay_product = it->second.speed * it->second.min_latency;
+  return static_cast<size_t>(bandwidth_delay_product / INITIAL_WINDOW_PARTS);
+}
+
+DownloadWindowController::DownloadWindowController(DcId dc_id, size_t part_size)
+    : dc_id_(dc_id), part_size_(static_cast<int64>(part_size)) {
+  set_window(part_size_ * INITIAL_WINDOW_PARTS);
+}
+
+bool DownloadWindowController::can_start_part(int64 using_size, size_t part_size) const {
+  return using_size == 0 || using_size + static_cast<int64>(part_size) <= window_;
+}
+
+void DownloadWindowController::on_part_started(double now) {
+  if (first_part_start_time_ == 0.0) {
+    first_part_start_time_ = now;
+  }
+}
+
+void DownloadWindowController::on_part_ok(size_t size, double latency, double now) {
+  stats_.part_count++;
+  stats_.downloaded_size += static_cast<int64>(size);
+  stats_.total_time = now - first_part_start_time_;
+  total_latency_ += latency;
+  stats_.average_latency = total_latency_ / stats_.part_count;
+  if (min_latency_ == 0.0 || latency < min_latency_) {
+    min_latency_ = latency;
+    stats_.min_latency = latency;
+  }
+
+  if (latency > min_latency_ * DECREASE_LATENCY_RATIO) {
+    is_slow_start_ = false;
+    // decrease the window at most once per round trip
+    if (now - last_decrease_time_ >= latency) {
+      VLOG(file_loader) << "Decrease download window " << window_ << " because of latency " << latency
+                        << " with minimum latency " << min_latency_;
+      last_decrease_time_ = now;
+      stats_.decrease_count++;
+      set_window(static_cast<int64>(static_cast<double>(window_) * DECREASE_FACTOR));
+    }
+    return;
+  }
+
+  if (is_slow_start_) {
+    if (latency <= min_latency_ * SLOW_START_LATENCY_RATIO) {
+      set_window(window_ + part_size_);
+      return;
+    }
+    VLOG(file_loader) << "Finish slow start with download window " << window_;
+    is_slow_start_ = false;
+  }
+  set_window(window_ + max(part_size_ * part_size_ / window_, static_cast<int64>(1)));
+}
+
+void DownloadWindowController::set_window(int64 window) {
+  window_ = clamp(window, max(MIN_WINDOW, part_size_), MAX_WINDOW);
+  stats_.window = window_;
+  stats_.max_window = max(stats_.max_window, window_);
+}
+
+void DownloadWindowController::save_stats() const {
+  if (!dc_id_.is_exact() || stats_.downloaded_size < MIN_SAVED_DOWNLOAD_SIZE || stats_.get_speed() <= 0.0) {
+    return;
+  }
+  auto &history = get_download_history();
+  std::lock_guard<std::mutex> lock(history.mutex);
+  auto &dc_history = history.dcs[dc_id_.get_raw_id()];
+  if (dc_history.speed == 0.0) {
+    dc_history.speed = stats_.get_speed();
+    dc_history.min_latency = min_latency_;
+  } else {
+    dc_history.speed = 0.5 * dc_history.speed + 0.5 * stats_.get_speed();
+    dc_history.min_latency = 0.5 * dc_history.min_latency + 0.5 * min_latency_;
+  }
+}
+
+StringBuilder &operator<<(StringBuilder &string_builder, const DownloadWindowController::Stats &stats) {
+  return string_builder << "DownloadStats[" << tag("parts", stats.part_count) << tag("size", stats.downloaded_size)
+                        << tag("time", stats.total_time) << tag("speed", static_cast<int64>(stats.get_speed()))
+                        << tag("min_latency", stats.min_latency) << tag("average_latency", stats.average_latency)
+                        << tag("window", stats.window) << tag("max_window", stats.max_window)
+                        << tag("decreases", stats.decrease_count) << ']';
+}
+
+}  // namespace td
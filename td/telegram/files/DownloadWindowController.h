@@ -0,0 +1,86 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/telegram/net/DcId.h"
+
+#include "td/utils/common.h"
+#include "td/utils/StringBuilder.h"
+
+namespace td {
+
+// Limits the total size of simultaneously downloaded parts of a file, adapting the limit to observed per-part latency
+// similarly to TCP congestion control. The window grows by one part for each downloaded part until part latency
+// starts to grow, then grows by one part per round trip and shrinks if the latency grows too much.
+class DownloadWindowController {
+ public:
+  static constexpr int64 MIN_WINDOW = 256 << 10;
+  static constexpr int64 MAX_WINDOW = 64 << 20;
+  static constexpr int32 INITIAL_WINDOW_PARTS = 4;
+
+  // the window stops to grow exponentially if latency exceeds the minimum latency by this factor
+  static constexpr double SLOW_START_LATENCY_RATIO = 1.5;
+  // the window shrinks if latency exceeds the minimum latency by this factor
+  static constexpr double DECREASE_LATENCY_RATIO = 2.5;
+  static constexpr double DECREASE_FACTOR = 0.75;
+
+  struct Stats {
+    int32 part_count = 0;
+    int64 downloaded_size = 0;
+    double total_time = 0.0;
+    double min_latency = 0.0;
+    double average_latency = 0.0;
+    int64 window = 0;
+    int64 max_window = 0;
+    int32 decrease_count = 0;
+
+    double get_speed() const {
+      return total_time <= 0.0 ? 0.0 : static_cast<double>(downloaded_size) / total_time;
+    }
+  };
+
+  // returns the part size, which is expected to be optimal for new downloads from the DC based on previous downloads,
+  // or 0 if there is no data about the DC
+  static size_t get_preferred_part_size(DcId dc_id);
+
+  DownloadWindowController() = default;
+  DownloadWindowController(DcId dc_id, size_t part_size);
+
+  bool can_start_part(int64 using_size, size_t part_size) const;
+
+  void on_part_started(double now);
+
+  void on_part_ok(size_t size, double latency, double now);
+
+  int64 get_window() const {
+    return window_;
+  }
+
+  const Stats &get_stats() const {
+    return stats_;
+  }
+
+  // saves the measured speed and latency for the DC for use by subsequent downloads
+  void save_stats() const;
+
+ private:
+  DcId dc_id_;
+  int64 part_size_ = 0;
+  int64 window_ = MAX_WINDOW;
+  bool is_slow_start_ = true;
+  double min_latency_ = 0.0;
+  double last_decrease_time_ = 0.0;
+  double first_part_start_time_ = 0.0;
+  double total_latency_ = 0.0;
+  Stats stats_;
+
+  void set_window(int64 window);
+};
+
+StringBuilder &operator<<(StringBuilder &string_builder, const DownloadWindowController::Stats &stats);
+
+}  // namespace td
@@ -0,0 +1,155 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/files/FileBandwidthBudget.h"
+
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/Time.h"
+
+#include <map>
+#include <mutex>
+
+namespace td {
+
+constexpr double FileBandwidthBudget::ACTIVE_PERIOD;
+constexpr double FileBandwidthBudget::MAX_BURST_TIME;
+
+std::atomic<int64> FileBandwidthBudget::limit_{0};
+
+namespace {
+
+struct Consumer {
+  string name;
+  int32 weight = 1;
+  double last_request_time = -1e9;
+  double last_refill_time = 0.0;
+  double bytes_per_second = 0.0;
+  double tokens = 0.0;
+  int64 transferred_size = 0;
+
+  bool is_active(double now) const {
+    return last_request_time >= now - FileBandwidthBudget::ACTIVE_PERIOD;
+  }
+};
+
+struct Consumers {
+  std::mutex mutex;
+  std::map<uint64, Consumer> consumers;
+  uint64 next_consumer_id = 1;
+
+  int64 get_total_active_weight(double now) const {
+    int64 result = 0;
+    for (auto &it : consumers) {
+      if (it.second.is_active(now)) {
+        result += it.second.weight;
+      }
+    }
+    return result;
+  }
+
+  // updates the share of the consumer and the amount of bandwidth available to it
+  void refill(Consumer &consumer, double now, int64 limit, int64 unit_size) {
+    consumer.tokens += (now - consumer.last_refill_time) * consumer.bytes_per_second;
+    consumer.last_refill_time = now;
+    auto total_weight = max(get_total_active_weight(now), static_cast<int64>(1));
+    consumer.bytes_per_second = static_cast<double>(limit) * consumer.weight / static_cast<double>(total_weight);
+    // the consumer must be able to accumulate at least one unit even if its share is small
+    auto max_tokens = max(consumer.bytes_per_second * FileBandwidthBudget::MAX_BURST_TIME,
+                          static_cast<double>(unit_size));
+    consumer.tokens = min(consumer.tokens, max_tokens);
+  }
+};
+
+Consumers &get_consumers() {
+  static Consumers consumers;
+  return consumers;
+}
+
+}  // namespace
+
+void FileBandwidthBudget::set_limit(int64 bytes_per_second) {
+  LOG(INFO) << "Set file transfer bandwidth limit to " << bytes_per_second;
+  limit_.store(max(bytes_per_second, static_cast<int64>(0)), std::memory_order_relaxed);
+}
+
+uint64 FileBandwidthBudget::register_consumer(Slice name) {
+  auto &consumers = get_consumers();
+  std::lock_guard<std::mutex> lock(consumers.mutex);
+  auto consumer_id = consumers.next_consumer_id++;
+  auto &consumer = consumers.consumers[consumer_id];
+  consumer.name = name.str();
+  consumer.last_refill_time = Time::now();
+  return consumer_id;
+}
+
+void FileBandwidthBudget::unregister_consumer(uint64 consumer_id) {
+  auto &consumers = get_consumers();
+  std::lock_guard<std::mutex> lock(consumers.mutex);
+  consumers.consumers.erase(consumer_id);
+}
+
+int64 FileBandwidthBudget::acquire(uint64 consumer_id, int32 weight, int64 size, int64 unit_size) {
+  CHECK(unit_size > 0);
+  auto limit = get_limit();
+  if (limit == 0) {
+    return size;
+  }
+
+  auto &consumers = get_consumers();
+  std::lock_guard<std::mutex> lock(consumers.mutex);
+  auto it = consumers.consumers.find(consumer_id);
+  if (it == consumers.consumers.end()) {
+    return size;
+  }
+  auto &consumer = it->second;
+  auto now = Time::now();
+  if (!consumer.is_active(now)) {
+    // an inactive consumer must not use bandwidth, which wasn't allocated to it
+    consumer.tokens = 0.0;
+    consumer.bytes_per_second = 0.0;
+  }
+  consumer.weight = max(weight, 1);
+  consumer.last_request_time = now;
+  consumers.refill(consumer, now, limit, unit_size);
+
+  auto result = min(size, static_cast<int64>(consumer.tokens) / unit_size * unit_size);
+  consumer.tokens -= static_cast<double>(result);
+  consumer.transferred_size += result;
+  return result;
+}
+
+double FileBandwidthBudget::get_wait_time(uint64 consumer_id, int64 unit_size) {
+  constexpr double MIN_WAIT_TIME = 0.001;
+  auto &consumers = get_consumers();
+  std::lock_guard<std::mutex> lock(consumers.mutex);
+  auto it = consumers.consumers.find(consumer_id);
+  if (it == consumers.consumers.end() || it->second.bytes_per_second <= 0.0) {
+    return MIN_WAIT_TIME;
+  }
+  const auto &consumer = it->second;
+  return max((static_cast<double>(unit_size) - consumer.tokens) / consumer.bytes_per_second, MIN_WAIT_TIME);
+}
+
+td_api::object_ptr<td_api::fileTransferBandwidthAllocations>
+FileBandwidthBudget::get_file_transfer_bandwidth_allocations_object() {
+  auto &consumers = get_consumers();
+  std::lock_guard<std::mutex> lock(consumers.mutex);
+  auto now = Time::now();
+  auto total_active_weight = max(consumers.get_total_active_weight(now), static_cast<int64>(1));
+  auto limit = get_limit();
+  vector<td_api::object_ptr<td_api::fileTransferBandwidthAllocation>> allocations;
+  for (auto &it : consumers.consumers) {
+    const auto &consumer = it.second;
+    auto is_active = consumer.is_active(now);
+    auto bytes_per_second = is_active ? limit * consumer.weight / total_active_weight : 0;
+    allocations.push_back(td_api::make_object<td_api::fileTransferBandwidthAllocation>(
+        consumer.name, is_active ? consumer.weight : 0, bytes_per_second, consumer.transferred_size));
+  }
+  return td_api::make_object<td_api::fileTransferBandwidthAllocations>(limit, std::move(allocations));
+}
+
+}  // namespace td
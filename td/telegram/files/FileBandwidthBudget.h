@@ -0,0 +1,49 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/telegram/td_api.h"
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+#include <atomic>
+
+namespace td {
+
+// process-wide limit on the total speed of file downloads and uploads of all TDLib instances;
+// the limit is shared between resource managers, which have files to load, in proportion to their weights
+class FileBandwidthBudget {
+ public:
+  static constexpr double ACTIVE_PERIOD = 1.0;   // a consumer is active for this time after its last request
+  static constexpr double MAX_BURST_TIME = 1.0;  // unused allocated bandwidth is kept for this time
+
+  // 0 means no limit
+  static void set_limit(int64 bytes_per_second);
+
+  static int64 get_limit() {
+    return limit_.load(std::memory_order_relaxed);
+  }
+
+  static uint64 register_consumer(Slice name);
+
+  static void unregister_consumer(uint64 consumer_id);
+
+  // returns the number of bytes, which the consumer is allowed to transfer now;
+  // the result is a multiple of unit_size and doesn't exceed size
+  static int64 acquire(uint64 consumer_id, int32 weight, int64 size, int64 unit_size);
+
+  // returns time after which the consumer is expected to be able to acquire unit_size bytes
+  static double get_wait_time(uint64 consumer_id, int64 unit_size);
+
+  static td_api::object_ptr<td_api::fileTransferBandwidthAllocations> get_file_transfer_bandwidth_allocations_object();
+
+ private:
+  static std::atomic<int64> limit_;
+};
+
+}  // namespace td
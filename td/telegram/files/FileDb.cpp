@@ -13,6 +13,7 @@
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/Version.h"
 
+#include "td/db/BlobCompression.h"
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteKeyValue.h"
@@ -20,6 +21,7 @@
 
 #include "td/actor/actor.h"
 
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
@@ -29,6 +31,8 @@
 #include "td/utils/tl_helpers.h"
 #include "td/utils/tl_parsers.h"
 
+#include <utility>
+
 namespace td {
 
 Status drop_file_db(SqliteDb &db, int32 version) {
@@ -60,11 +64,12 @@ class FileDb final : public FileDbInterface {
  public:
   class FileDbActor final : public Actor {
    public:
-    FileDbActor(FileDbId max_file_db_id, std::shared_ptr<SqliteKeyValueSafe> file_kv_safe)
-        : max_file_db_id_(max_file_db_id), file_kv_safe_(std::move(file_kv_safe)) {
+    FileDbActor(FileDbId max_file_db_id, std::shared_ptr<SqliteKeyValueSafe> file_kv_safe, bool compress_data)
+        : max_file_db_id_(max_file_db_id), file_kv_safe_(std::move(file_kv_safe)), compress_data_(compress_data) {
     }
 
     void close(Promise<> promise) {
+      do_flush();
       file_kv_safe_.reset();
       LOG(INFO) << "FileDb is closed";
       promise.set_value(Unit());
@@ -72,11 +77,13 @@ class FileDb final : public FileDbInterface {
     }
 
     void load_file_data(const string &key, Promise<FileData> promise) {
+      do_flush();
       promise.set_result(load_file_data_impl(actor_id(this), file_pmc(), key, max_file_db_id_));
     }
 
     void clear_file_data(FileDbId file_db_id, const string &remote_key, const string &local_key,
                          const string &generate_key) {
+      do_flush();
       auto &pmc = file_pmc();
       pmc.begin_write_transaction().ensure();
 
@@ -103,32 +110,37 @@ class FileDb final : public FileDbInterface {
       pmc.commit_transaction().ensure();
     }
 
-    void store_file_data(FileDbId file_db_id, const string &file_data, const string &remote_key,
-                         const string &local_key, const string &generate_key) {
-      auto &pmc = file_pmc();
-      pmc.begin_write_transaction().ensure();
-
-      if (file_db_id > max_file_db_id_) {
-        pmc.set("file_id", to_string(file_db_id.get()));
-        max_file_db_id_ = file_db_id;
+    void store_file_data(FileDbId file_db_id, string file_data, string remote_key, string local_key,
+                         string generate_key) {
+      CHECK(file_db_id.is_valid());
+      auto &pos = pending_file_data_pos_[file_db_id.get()];
+      if (pos == 0) {
+        pending_file_data_.emplace_back(file_db_id, std::move(file_data));
+        pos = pending_file_data_.size();
+      } else {
+        // only the last data of the file needs to be written
+        pending_file_data_[pos - 1].second = std::move(file_data);
       }
 
-      pmc.set(PSTRING() << "file" << file_db_id.get(), file_data);
-
-      if (!remote_key.empty()) {
-        pmc.set(remote_key, to_string(file_db_id.get()));
-      }
-      if (!local_key.empty()) {
-        pmc.set(local_key, to_string(file_db_id.get()));
-      }
-      if (!generate_key.empty()) {
-        pmc.set(generate_key, to_string(file_db_id.get()));
+      // a new key means that the file got a new location, for example, its download has been completed,
+      // so it is written immediately; the other changes, like download progress, are coalesced
+      bool has_new_key = false;
+      for (auto *key : {&remote_key, &local_key, &generate_key}) {
+        if (!key->empty()) {
+          pending_keys_.emplace_back(std::move(*key), file_db_id);
+          has_new_key = true;
+        }
       }
 
-      pmc.commit_transaction().ensure();
+      if (has_new_key || pending_file_data_.size() >= MAX_PENDING_FILE_DATA_COUNT) {
+        do_flush();
+      } else if (pending_file_data_.size() == 1) {
+        set_timeout_in(MAX_PENDING_FILE_DATA_DELAY);
+      }
     }
 
     void store_file_data_ref(FileDbId file_db_id, FileDbId new_file_db_id) {
+      do_flush();
       auto &pmc = file_pmc();
       pmc.begin_write_transaction().ensure();
 
@@ -144,6 +156,7 @@ class FileDb final : public FileDbInterface {
 
     void optimize_refs(std::vector<FileDbId> file_db_ids, FileDbId main_file_db_id) {
       LOG(INFO) << "Optimize " << file_db_ids.size() << " file_db_ids in file database to " << main_file_db_id.get();
+      do_flush();
       auto &pmc = file_pmc();
       pmc.begin_write_transaction().ensure();
       for (size_t i = 0; i + 1 < file_db_ids.size(); i++) {
@@ -153,24 +166,75 @@ class FileDb final : public FileDbInterface {
     }
 
    private:
+    static constexpr size_t MAX_PENDING_FILE_DATA_COUNT = 100;
+    static constexpr double MAX_PENDING_FILE_DATA_DELAY = 0.1;
+
     FileDbId max_file_db_id_;
     std::shared_ptr<SqliteKeyValueSafe> file_kv_safe_;
+    bool compress_data_ = false;
+
+    // writes, which aren't committed yet; all other queries commit them first to keep the order of changes
+    vector<std::pair<FileDbId, string>> pending_file_data_;
+    FlatHashMap<uint64, size_t> pending_file_data_pos_;  // file_db_id -> 1-based position in pending_file_data_
+    vector<std::pair<string, FileDbId>> pending_keys_;
 
     SqliteKeyValue &file_pmc() {
       return file_kv_safe_->get();
     }
 
+    void timeout_expired() final {
+      do_flush();
+    }
+
+    void tear_down() final {
+      do_flush();
+    }
+
+    void do_flush() {
+      if (pending_file_data_.empty()) {
+        return;
+      }
+      cancel_timeout();
+
+      auto &pmc = file_pmc();
+      pmc.begin_write_transaction().ensure();
+
+      for (auto &file_data : pending_file_data_) {
+        auto file_db_id = file_data.first;
+        if (file_db_id > max_file_db_id_) {
+          pmc.set("file_id", to_string(file_db_id.get()));
+          max_file_db_id_ = file_db_id;
+        }
+
+        BufferSlice compressed_file_data;
+        if (compress_data_) {
+          compressed_file_data = compress_blob(file_data.second);
+        }
+        pmc.set(PSTRING() << "file" << file_db_id.get(),
+                compressed_file_data.empty() ? Slice(file_data.second) : compressed_file_data.as_slice());
+      }
+      for (auto &key : pending_keys_) {
+        pmc.set(key.first, to_string(key.second.get()));
+      }
+
+      pmc.commit_transaction().ensure();
+
+      pending_file_data_.clear();
+      pending_file_data_pos_.clear();
+      pending_keys_.clear();
+    }
+
     void do_store_file_data_ref(FileDbId file_db_id, FileDbId new_file_db_id) {
       file_pmc().set(PSTRING() << "file" << file_db_id.get(), PSTRING() << "@@" << new_file_db_id.get());
     }
   };
 
-  explicit FileDb(std::shared_ptr<SqliteKeyValueSafe> kv_safe, int scheduler_id = -1) {
+  FileDb(std::shared_ptr<SqliteKeyValueSafe> kv_safe, int scheduler_id, bool compress_data) {
     file_kv_safe_ = std::move(kv_safe);
     CHECK(file_kv_safe_);
     max_file_db_id_ = FileDbId(to_integer<uint64>(file_kv_safe_->get().get("file_id")));
-    file_db_actor_ =
-        create_actor_on_scheduler<FileDbActor>("FileDbActor", scheduler_id, max_file_db_id_, file_kv_safe_);
+    file_db_actor_ = create_actor_on_scheduler<FileDbActor>("FileDbActor", scheduler_id, max_file_db_id_,
+                                                            file_kv_safe_, compress_data);
   }
 
   FileDbId get_next_file_db_id() final {
@@ -224,8 +288,8 @@ class FileDb final : public FileDbInterface {
     //            << tag("remote_key", format::as_hex_dump<4>(Slice(remote_key)))
     //            << tag("local_key", format::as_hex_dump<4>(Slice(local_key)))
     //            << tag("generate_key", format::as_hex_dump<4>(Slice(generate_key)));
-    send_closure(file_db_actor_, &FileDbActor::store_file_data, file_db_id, serialize(file_data), remote_key, local_key,
-                 generate_key);
+    send_closure(file_db_actor_, &FileDbActor::store_file_data, file_db_id, serialize(file_data),
+                 std::move(remote_key), std::move(local_key), std::move(generate_key));
   }
 
   void set_file_data_ref(FileDbId file_db_id, FileDbId new_file_db_id) final {
@@ -272,7 +336,8 @@ class FileDb final : public FileDbInterface {
     // LOG(DEBUG) << "By ID " << file_db_id.get() << " found data " << format::as_hex_dump<4>(Slice(data_str));
     // LOG(INFO) << attempt_count;
 
-    log_event::WithVersion<TlParser> parser(data_str);
+    auto data_buffer = decompress_blob(data_str);
+    log_event::WithVersion<TlParser> parser(data_buffer.as_slice());
     parser.set_version(static_cast<int32>(Version::Initial));
     FileData data;
     data.parse(parser, true);
@@ -294,9 +359,10 @@ class FileDb final : public FileDbInterface {
   }
 };
 
-std::shared_ptr<FileDbInterface> create_file_db(std::shared_ptr<SqliteConnectionSafe> connection, int scheduler_id) {
+std::shared_ptr<FileDbInterface> create_file_db(std::shared_ptr<SqliteConnectionSafe> connection, int scheduler_id,
+                                                bool compress_data) {
   auto kv = std::make_shared<SqliteKeyValueSafe>("files", std::move(connection));
-  return std::make_shared<FileDb>(std::move(kv), scheduler_id);
+  return std::make_shared<FileDb>(std::move(kv), scheduler_id, compress_data);
 }
 
 }  // namespace td
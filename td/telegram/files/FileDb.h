@@ -28,8 +28,10 @@ Status drop_file_db(SqliteDb &db, int32 version) TD_WARN_UNUSED_RESULT;
 Status init_file_db(SqliteDb &db, int32 version) TD_WARN_UNUSED_RESULT;
 
 class FileDbInterface;
+// if compress_data is true, then large file information blobs are stored compressed
 std::shared_ptr<FileDbInterface> create_file_db(std::shared_ptr<SqliteConnectionSafe> connection,
-                                                int32 scheduler_id = -1) TD_WARN_UNUSED_RESULT;
+                                                int32 scheduler_id = -1,
+                                                bool compress_data = false) TD_WARN_UNUSED_RESULT;
 
 class FileDbInterface {
  public:
@@ -6,6 +6,7 @@
 //
 #include "td/telegram/files/FileDownloadManager.h"
 
+#include "td/telegram/files/FileType.h"
 #include "td/telegram/Global.h"
 #include "td/telegram/net/NetQueryDispatcher.h"
 
@@ -22,17 +23,36 @@ FileDownloadManager::FileDownloadManager(unique_ptr<Callback> callback, ActorSha
 }
 
 void FileDownloadManager::start_up() {
-  if (G()->get_option_boolean("is_premium")) {
+  if (G()->get_option_boolean(CachedOption::IsPremium)) {
     max_download_resource_limit_ *= 8;
   }
 }
 
+bool FileDownloadManager::is_small_download(const FullRemoteFileLocation &remote_location, int64 size) {
+  if (size < 20 * 1024) {
+    return true;
+  }
+
+  // thumbnails, avatars and stickers are needed while chat history is scrolled,
+  // so they must not wait behind downloads of large files
+  switch (get_main_file_type(remote_location.file_type_)) {
+    case FileType::Thumbnail:
+    case FileType::ProfilePhoto:
+    case FileType::Sticker:
+    case FileType::EncryptedThumbnail:
+      return size < 256 * 1024;
+    default:
+      return false;
+  }
+}
+
 ActorOwn<ResourceManager> &FileDownloadManager::get_download_resource_manager(bool is_small, DcId dc_id) {
   auto &actor = is_small ? download_small_resource_manager_map_[dc_id] : download_resource_manager_map_[dc_id];
   if (actor.empty()) {
+    // small files are downloaded in a few parts, so a file waiting for resources must not delay the other files
     actor = create_actor<ResourceManager>(
         PSLICE() << "DownloadResourceManager " << tag("is_small", is_small) << tag("dc_id", dc_id),
-        max_download_resource_limit_, ResourceManager::Mode::Baseline);
+        max_download_resource_limit_, is_small ? ResourceManager::Mode::Independent : ResourceManager::Mode::Baseline);
   }
   return actor;
 }
@@ -49,7 +69,7 @@ void FileDownloadManager::download(QueryId query_id, const FullRemoteFileLocatio
   CHECK(node);
   node->query_id_ = query_id;
   auto callback = make_unique<FileDownloaderCallback>(actor_shared(this, node_id));
-  bool is_small = size < 20 * 1024;
+  bool is_small = is_small_download(remote_location, size);
   node->downloader_ =
       create_actor<FileDownloader>("Downloader", remote_location, local, size, std::move(name), encryption_key,
                                    is_small, need_search_file, offset, limit, std::move(callback));
@@ -79,6 +79,8 @@ class FileDownloadManager final : public Actor {
 
   void try_stop();
 
+  static bool is_small_download(const FullRemoteFileLocation &remote_location, int64 size);
+
   ActorOwn<ResourceManager> &get_download_resource_manager(bool is_small, DcId dc_id);
 
   void on_start_download();
@@ -22,10 +22,12 @@
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
+#include "td/utils/port/IoSlice.h"
 #include "td/utils/port/path.h"
 #include "td/utils/port/Stat.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
 #include "td/utils/UInt.h"
 
 #include <tuple>
@@ -155,7 +157,7 @@ Result<NetQueryPtr> FileDownloader::start_part(Part part, int32 part_count, int6
       flags |= telegram_api::upload_getFile::CDN_SUPPORTED_MASK;
     }
 #endif
-    DcId dc_id = remote_.is_web() ? G()->get_webfile_dc_id() : remote_.get_dc_id();
+    DcId dc_id = get_dc_id();
     auto unique_id = UniqueId::next(UniqueId::Type::Default, static_cast<uint8>(QueryType::Default));
     net_query =
         remote_.is_web()
@@ -205,7 +207,7 @@ Status FileDownloader::check_net_query(NetQueryPtr &net_query) {
   return Status::OK();
 }
 
-Result<size_t> FileDownloader::process_part(Part part, NetQueryPtr net_query) {
+Result<BufferSlice> FileDownloader::process_part(Part part, NetQueryPtr net_query) {
   TRY_STATUS(check_net_query(net_query));
 
   BufferSlice bytes;
@@ -246,7 +248,7 @@ Result<size_t> FileDownloader::process_part(Part part, NetQueryPtr net_query) {
     return Status::Error("Part size is more than requested");
   }
   if (bytes.empty()) {
-    return 0;
+    return std::move(bytes);
   }
 
   // Encryption
@@ -273,16 +275,68 @@ Result<size_t> FileDownloader::process_part(Part part, NetQueryPtr net_query) {
                     bytes.as_mutable_slice());
   }
 
-  auto slice = bytes.as_slice().substr(0, part.size);
-  TRY_STATUS(acquire_fd());
-  LOG(INFO) << "Receive " << slice.size() << " bytes at offset " << part.offset << " for \"" << path_ << '"';
-  TRY_RESULT(written, fd_.pwrite(slice, part.offset));
-  LOG(INFO) << "Written " << written << " bytes";
-  // may write less than part.size, when size of downloadable file is unknown
-  if (written != slice.size()) {
-    return Status::Error("Failed to save file part to the file");
+  // may receive less than part.size, when size of downloadable file is unknown
+  bytes.truncate(part.size);
+  LOG(INFO) << "Receive " << bytes.size() << " bytes at offset " << part.offset << " for \"" << path_ << '"';
+  return std::move(bytes);
+}
+
+bool FileDownloader::is_next_part_pending() const {
+  CHECK(!pending_parts_.empty());
+  const auto &last_part = pending_parts_.back();
+  if (last_part.bytes.size() != last_part.part.size) {
+    return false;
+  }
+  auto next_offset = last_part.part.offset + static_cast<int64>(last_part.part.size);
+  for (auto &it : part_map_) {
+    if (it.second.part.offset == next_offset) {
+      return true;
+    }
   }
-  return written;
+  return false;
+}
+
+Status FileDownloader::write_pending_parts() {
+  if (pending_parts_.empty()) {
+    return Status::OK();
+  }
+  auto pending_parts = std::move(pending_parts_);
+  auto pending_size = pending_size_;
+  pending_parts_.clear();
+  pending_size_ = 0;
+
+  if (pending_size > 0) {
+    TRY_STATUS(acquire_fd());
+    auto offset = pending_parts[0].part.offset;
+    size_t written = 0;
+    if (pending_parts.size() == 1) {
+      TRY_RESULT_ASSIGN(written, fd_.pwrite(pending_parts[0].bytes.as_slice(), offset));
+    } else {
+      vector<IoSlice> slices;
+      for (auto &pending_part : pending_parts) {
+        slices.push_back(as_io_slice(pending_part.bytes.as_slice()));
+      }
+      TRY_STATUS(fd_.seek(offset));
+      TRY_RESULT_ASSIGN(written, fd_.writev(slices));
+    }
+    LOG(INFO) << "Written " << written << " bytes of " << pending_parts.size() << " parts at offset " << offset;
+    if (written != pending_size) {
+      return Status::Error("Failed to save file part to the file");
+    }
+  }
+
+  for (auto &pending_part : pending_parts) {
+    auto old_ready_prefix_count = parts_manager_.get_unchecked_ready_prefix_count();
+    TRY_STATUS(parts_manager_.on_part_ok(pending_part.part.id, pending_part.part.size, pending_part.bytes.size()));
+    auto new_ready_prefix_count = parts_manager_.get_unchecked_ready_prefix_count();
+    debug_total_parts_++;
+    if (old_ready_prefix_count == new_ready_prefix_count) {
+      debug_bad_parts_.push_back(pending_part.part.id);
+      debug_bad_part_order_++;
+    }
+  }
+  on_progress();
+  return Status::OK();
 }
 
 void FileDownloader::on_progress() {
@@ -420,6 +474,13 @@ Status FileDownloader::acquire_fd() {
   if (fd_.empty()) {
     if (path_.empty()) {
       TRY_RESULT_ASSIGN(std::tie(fd_, path_), open_temp_file(remote_.file_type_));
+      auto size = parts_manager_.get_size_or_zero();
+      if (size >= MIN_PREALLOCATED_SIZE && offset_ == 0 && limit_ == 0) {
+        auto status = fd_.preallocate(size);
+        if (status.is_error()) {
+          LOG(INFO) << "Failed to preallocate " << size << " bytes for \"" << path_ << "\": " << status;
+        }
+      }
     } else {
       TRY_RESULT_ASSIGN(fd_, FileFd::open(path_, (only_check_ ? 0 : FileFd::Write) | FileFd::Read));
     }
@@ -465,9 +526,10 @@ void FileDownloader::update_downloaded_part(int64 offset, int64 limit, int64 max
     auto end_part_id = begin_part_id + td::min(max_parts, new_end_part_id - begin_part_id);
     VLOG(file_loader) << "Protect parts " << begin_part_id << " ... " << end_part_id - 1;
     for (auto &it : part_map_) {
-      if (!it.second.second.empty() && !(begin_part_id <= it.second.first.id && it.second.first.id < end_part_id)) {
-        VLOG(file_loader) << "Cancel part " << it.second.first.id;
-        it.second.second.reset();  // cancel_query(it.second.second);
+      if (!it.second.cancel_signal.empty() &&
+          !(begin_part_id <= it.second.part.id && it.second.part.id < end_part_id)) {
+        VLOG(file_loader) << "Cancel part " << it.second.part.id;
+        it.second.cancel_signal.reset();  // cancel_query(it.second.cancel_signal);
       }
     }
   } else {
@@ -487,6 +549,18 @@ void FileDownloader::start_up() {
   if (remote_.file_type_ == FileType::SecureEncrypted) {
     size_ = 0;
   }
+  if (size_ > 0 && encryption_key_.empty()) {
+    shared_store_path_ = get_shared_file_store_path(remote_);
+  }
+  if (!shared_store_path_.empty() && local_.type() == LocalFileLocation::Type::Empty) {
+    auto r_path = create_from_shared_file_store(remote_.file_type_, shared_store_path_, size_, name_);
+    if (r_path.is_ok()) {
+      LOG(INFO) << "Link file " << r_path.ok() << " from the shared file store";
+      stop_flag_ = true;
+      return callback_->on_ok(FullLocalFileLocation(remote_.file_type_, r_path.move_as_ok(), 0), size_, true);
+    }
+    LOG(DEBUG) << "File isn't found in the shared file store: " << r_path.error();
+  }
   int32 part_size = 0;
   Bitmask bitmask{Bitmask::Ones{}, 0};
   if (local_.type() == LocalFileLocation::Type::Partial) {
@@ -527,6 +601,9 @@ void FileDownloader::start_up() {
   try_release_fd();
 
   auto ready_parts = bitmask.as_vector();
+  if (part_size == 0 && !is_small_) {
+    parts_manager_.set_preferred_part_size(DownloadWindowController::get_preferred_part_size(get_dc_id()));
+  }
   auto status = parts_manager_.init(size_, size_, true, part_size, ready_parts, false, false);
   LOG(DEBUG) << "Start downloading a file of size " << size_ << ", part size " << part_size << " and "
              << ready_parts.size() << " ready parts: " << status;
@@ -538,7 +615,7 @@ void FileDownloader::start_up() {
   }
   parts_manager_.set_streaming_offset(offset_, limit_);
   if (ordered_flag_) {
-    ordered_parts_ = OrderedEventsProcessor<std::pair<Part, NetQueryPtr>>(parts_manager_.get_ready_prefix_count());
+    ordered_parts_ = OrderedEventsProcessor<ReceivedPart>(parts_manager_.get_ready_prefix_count());
   }
   auto file_type = get_main_file_type(remote_.file_type_);
   if (!is_small_ &&
@@ -549,6 +626,7 @@ void FileDownloader::start_up() {
     next_delay_ = 0.05;
   }
   resource_state_.set_unit_size(parts_manager_.get_part_size());
+  window_controller_ = DownloadWindowController(get_dc_id(), parts_manager_.get_part_size());
   update_estimated_limit();
   on_progress();
   yield();
@@ -568,6 +646,9 @@ void FileDownloader::loop() {
 }
 
 Status FileDownloader::do_loop() {
+  if (!pending_parts_.empty() && !is_next_part_pending()) {
+    TRY_STATUS(write_pending_parts());
+  }
   TRY_STATUS(check_loop(parts_manager_.get_checked_prefix_size(), parts_manager_.get_unchecked_ready_prefix_size(),
                         parts_manager_.unchecked_ready()));
 
@@ -590,12 +671,18 @@ Status FileDownloader::do_loop() {
       path = path_;
     } else {
       TRY_RESULT_ASSIGN(path, create_from_temp(remote_.file_type_, path_, name_));
+      if (!shared_store_path_.empty()) {
+        add_to_shared_file_store(path, shared_store_path_);
+      }
     }
     callback_->on_ok(FullLocalFileLocation(remote_.file_type_, std::move(path), 0), size, !only_check_);
 
     LOG(INFO) << "Bad download order rate: "
               << (debug_total_parts_ == 0 ? 0.0 : 100.0 * debug_bad_part_order_ / debug_total_parts_) << "% "
               << debug_bad_part_order_ << "/" << debug_total_parts_ << " " << format::as_array(debug_bad_parts_);
+    LOG(INFO) << "Finish download with part size " << parts_manager_.get_part_size() << ": "
+              << window_controller_.get_stats();
+    window_controller_.save_stats();
     stop_flag_ = true;
     return Status::OK();
   }
@@ -605,6 +692,10 @@ Status FileDownloader::do_loop() {
       VLOG(file_loader) << "Receive only " << resource_state_.unused() << " resource";
       break;
     }
+    if (!window_controller_.can_start_part(resource_state_.get_using(), parts_manager_.get_part_size())) {
+      VLOG(file_loader) << "Download window " << window_controller_.get_window() << " is full";
+      break;
+    }
     TRY_RESULT(part, parts_manager_.start_part());
     if (part.size == 0) {
       break;
@@ -614,7 +705,9 @@ Status FileDownloader::do_loop() {
 
     TRY_RESULT(query, start_part(part, parts_manager_.get_part_count(), parts_manager_.get_streaming_offset()));
     uint64 unique_id = UniqueId::next();
-    part_map_[unique_id] = std::make_pair(part, query->cancel_slot_.get_signal_new());
+    auto now = Time::now();
+    part_map_[unique_id] = PartInfo{part, query->cancel_slot_.get_signal_new(), now};
+    window_controller_.on_part_started(now);
 
     auto callback = actor_shared(this, unique_id);
     if (delay_dispatcher_.empty()) {
@@ -631,19 +724,24 @@ Status FileDownloader::do_loop() {
 
 void FileDownloader::tear_down() {
   for (auto &it : part_map_) {
-    it.second.second.reset();  // cancel_query(it.second.second);
+    it.second.cancel_signal.reset();  // cancel_query(it.second.cancel_signal);
   }
-  ordered_parts_.clear([](auto &&part) { part.second->clear(); });
+  ordered_parts_.clear([](auto &&received_part) { received_part.query->clear(); });
   if (!delay_dispatcher_.empty()) {
     send_closure(std::move(delay_dispatcher_), &DelayDispatcher::close_silent);
   }
 }
 
+DcId FileDownloader::get_dc_id() const {
+  return remote_.is_web() ? G()->get_webfile_dc_id() : remote_.get_dc_id();
+}
+
 void FileDownloader::update_estimated_limit() {
   if (stop_flag_) {
     return;
   }
-  auto estimated_extra = parts_manager_.get_estimated_extra();
+  // there is no need to request more resources than the download window allows to use
+  auto estimated_extra = min(parts_manager_.get_estimated_extra(), window_controller_.get_window());
   resource_state_.update_estimated_limit(estimated_extra);
   VLOG(file_loader) << "Update estimated limit " << estimated_extra;
   if (!resource_manager_.empty()) {
@@ -673,8 +771,9 @@ void FileDownloader::on_result(NetQueryPtr query) {
     return;
   }
 
-  Part part = it->second.first;
-  it->second.second.release();
+  Part part = it->second.part;
+  auto latency = Time::now() - it->second.start_time;
+  it->second.cancel_signal.release();
   CHECK(query->is_ready());
   part_map_.erase(it);
 
@@ -700,41 +799,48 @@ void FileDownloader::on_result(NetQueryPtr query) {
   if (next) {
     if (ordered_flag_) {
       auto seq_no = part.id;
-      ordered_parts_.add(
-          seq_no, std::make_pair(part, std::move(query)),
-          [this](uint64 seq_no, std::pair<Part, NetQueryPtr> &&p) { on_part_query(p.first, std::move(p.second)); });
+      ordered_parts_.add(seq_no, ReceivedPart{part, latency, std::move(query)},
+                         [this](uint64 seq_no, ReceivedPart &&received_part) {
+                           on_part_query(received_part.part, received_part.latency, std::move(received_part.query));
+                         });
     } else {
-      on_part_query(part, std::move(query));
+      on_part_query(part, latency, std::move(query));
     }
   }
   update_estimated_limit();
   loop();
 }
 
-void FileDownloader::on_part_query(Part part, NetQueryPtr query) {
+void FileDownloader::on_part_query(Part part, double latency, NetQueryPtr query) {
   if (stop_flag_) {
     // important for secret files
     return;
   }
-  auto status = try_on_part_query(part, std::move(query));
+  auto status = try_on_part_query(part, latency, std::move(query));
   if (status.is_error()) {
     on_error(std::move(status));
   }
 }
 
-Status FileDownloader::try_on_part_query(Part part, NetQueryPtr query) {
-  TRY_RESULT(size, process_part(part, std::move(query)));
-  VLOG(file_loader) << "Ok part " << tag("id", part.id) << tag("size", part.size);
+Status FileDownloader::try_on_part_query(Part part, double latency, NetQueryPtr query) {
+  TRY_RESULT(bytes, process_part(part, std::move(query)));
+  VLOG(file_loader) << "Ok part " << tag("id", part.id) << tag("size", part.size) << tag("latency", latency);
   resource_state_.stop_use(static_cast<int64>(part.size));
-  auto old_ready_prefix_count = parts_manager_.get_unchecked_ready_prefix_count();
-  TRY_STATUS(parts_manager_.on_part_ok(part.id, part.size, size));
-  auto new_ready_prefix_count = parts_manager_.get_unchecked_ready_prefix_count();
-  debug_total_parts_++;
-  if (old_ready_prefix_count == new_ready_prefix_count) {
-    debug_bad_parts_.push_back(part.id);
-    debug_bad_part_order_++;
+  window_controller_.on_part_ok(bytes.size(), latency, Time::now());
+
+  if (!pending_parts_.empty()) {
+    const auto &last_part = pending_parts_.back();
+    if (last_part.bytes.size() != last_part.part.size ||
+        last_part.part.offset + static_cast<int64>(last_part.part.size) != part.offset) {
+      TRY_STATUS(write_pending_parts());
+    }
+  }
+  pending_size_ += bytes.size();
+  pending_parts_.push_back(PendingPart{part, std::move(bytes)});
+  // the parts are processed strictly in order for secret files, so there is nothing to wait for
+  if (ordered_flag_ || pending_size_ >= MAX_PENDING_WRITE_SIZE || !is_next_part_pending()) {
+    return write_pending_parts();
   }
-  on_progress();
   return Status::OK();
 }
 
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "td/telegram/DelayDispatcher.h"
+#include "td/telegram/files/DownloadWindowController.h"
 #include "td/telegram/files/FileEncryptionKey.h"
 #include "td/telegram/files/FileLoaderActor.h"
 #include "td/telegram/files/FileLocation.h"
@@ -19,6 +20,7 @@
 
 #include "td/actor/actor.h"
 
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/OrderedEventsProcessor.h"
 #include "td/utils/port/FileFd.h"
@@ -26,7 +28,6 @@
 
 #include <map>
 #include <set>
-#include <utility>
 
 namespace td {
 
@@ -64,6 +65,7 @@ class FileDownloader final : public FileLoaderActor {
 
   string path_;
   FileFd fd_;
+  string shared_store_path_;
 
   int32 next_part_ = 0;
   bool next_part_stop_ = false;
@@ -100,8 +102,31 @@ class FileDownloader final : public FileLoaderActor {
   ActorShared<ResourceManager> resource_manager_;
   ResourceState resource_state_;
   PartsManager parts_manager_;
-  std::map<uint64, std::pair<Part, ActorShared<>>> part_map_;
-  OrderedEventsProcessor<std::pair<Part, NetQueryPtr>> ordered_parts_;
+  struct PartInfo {
+    Part part;
+    ActorShared<> cancel_signal;
+    double start_time = 0.0;
+  };
+  std::map<uint64, PartInfo> part_map_;
+
+  // adjacent downloaded parts, which are written to the file at once
+  static constexpr size_t MAX_PENDING_WRITE_SIZE = 4 << 20;
+  struct PendingPart {
+    Part part;
+    BufferSlice bytes;
+  };
+  vector<PendingPart> pending_parts_;
+  size_t pending_size_ = 0;
+
+  // files of smaller size are not preallocated
+  static constexpr int64 MIN_PREALLOCATED_SIZE = 1 << 20;
+  DownloadWindowController window_controller_;
+  struct ReceivedPart {
+    Part part;
+    double latency = 0.0;
+    NetQueryPtr query;
+  };
+  OrderedEventsProcessor<ReceivedPart> ordered_parts_;
   ActorOwn<DelayDispatcher> delay_dispatcher_;
   double next_delay_ = 0;
 
@@ -123,7 +148,11 @@ class FileDownloader final : public FileLoaderActor {
 
   Result<NetQueryPtr> start_part(Part part, int32 part_count, int64 streaming_offset) TD_WARN_UNUSED_RESULT;
 
-  Result<size_t> process_part(Part part, NetQueryPtr net_query) TD_WARN_UNUSED_RESULT;
+  Result<BufferSlice> process_part(Part part, NetQueryPtr net_query) TD_WARN_UNUSED_RESULT;
+
+  bool is_next_part_pending() const;
+
+  Status write_pending_parts() TD_WARN_UNUSED_RESULT;
 
   void add_hash_info(const std::vector<telegram_api::object_ptr<telegram_api::fileHash>> &hashes);
 
@@ -144,13 +173,15 @@ class FileDownloader final : public FileLoaderActor {
   Status do_loop();
   void tear_down() final;
 
+  DcId get_dc_id() const;
+
   void update_estimated_limit();
   void on_progress();
 
   void on_result(NetQueryPtr query) final;
-  void on_part_query(Part part, NetQueryPtr query);
+  void on_part_query(Part part, double latency, NetQueryPtr query);
   void on_common_query(NetQueryPtr query);
-  Status try_on_part_query(Part part, NetQueryPtr query);
+  Status try_on_part_query(Part part, double latency, NetQueryPtr query);
 };
 
 }  // namespace td
@@ -30,6 +30,10 @@ FileGcParameters::FileGcParameters(int64 size, int32 ttl, int32 count, int32 imm
   immunity_delay_ = immunity_delay >= 0
                         ? immunity_delay
                         : narrow_cast<int32>(G()->get_option_integer("storage_immunity_delay", 60 * 60));
+
+  max_deleted_files_per_second_ = narrow_cast<int32>(
+      clamp(G()->get_option_integer("storage_max_deleted_files_per_second"), static_cast<int64>(0),
+            static_cast<int64>(1000000)));
 }
 
 StringBuilder &operator<<(StringBuilder &string_builder, const FileGcParameters &parameters) {
@@ -37,6 +41,7 @@ StringBuilder &operator<<(StringBuilder &string_builder, const FileGcParameters
                         << tag("max_time_from_last_access", parameters.max_time_from_last_access_)
                         << tag("max_file_count", parameters.max_file_count_)
                         << tag("immunity_delay", parameters.immunity_delay_)
+                        << tag("max_deleted_files_per_second", parameters.max_deleted_files_per_second_)
                         << tag("file_types", parameters.file_types_)
                         << tag("owner_dialog_ids", parameters.owner_dialog_ids_)
                         << tag("exclude_owner_dialog_ids", parameters.exclude_owner_dialog_ids_)
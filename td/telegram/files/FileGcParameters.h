@@ -24,6 +24,7 @@ struct FileGcParameters {
   uint32 max_time_from_last_access_;
   uint32 max_file_count_;
   uint32 immunity_delay_;
+  uint32 max_deleted_files_per_second_;  // 0 if unlimited
 
   vector<FileType> file_types_;
   vector<DialogId> owner_dialog_ids_;
@@ -6,10 +6,12 @@
 //
 #include "td/telegram/files/FileGcWorker.h"
 
+#include "td/telegram/files/FileLoaderUtils.h"
 #include "td/telegram/files/FileLocation.h"
 #include "td/telegram/files/FileManager.h"
 #include "td/telegram/files/FileType.h"
 #include "td/telegram/Global.h"
+#include "td/telegram/StorageManager.h"
 
 #include "td/utils/algorithm.h"
 #include "td/utils/format.h"
@@ -28,6 +30,13 @@ int VERBOSITY_NAME(file_gc) = VERBOSITY_NAME(INFO);
 
 void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFileInfo> files,
                           Promise<FileGcResult> promise) {
+  if (promise_) {
+    promise_.set_error(Global::request_aborted_error());
+    cancel_timeout();
+  }
+  files_to_delete_.clear();
+  result_ = nullptr;
+
   auto begin_time = Time::now();
   VLOG(file_gc) << "Start files GC with " << parameters;
   // quite stupid implementations
@@ -84,12 +93,9 @@ void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFi
   FileStats new_stats(false, parameters.dialog_limit_ != 0);
   FileStats removed_stats(false, parameters.dialog_limit_ != 0);
 
-  auto do_remove_file = [&removed_stats](const FullFileInfo &info) {
+  auto do_remove_file = [this, &removed_stats](const FullFileInfo &info) {
     removed_stats.add_copy(info);
-    auto status = unlink(info.path);
-    LOG_IF(WARNING, status.is_error()) << "Failed to unlink file \"" << info.path << "\" during files GC: " << status;
-    send_closure(G()->file_manager(), &FileManager::on_file_unlink,
-                 FullLocalFileLocation(info.file_type, info.path, info.mtime_nsec));
+    files_to_delete_.push_back(info);
   };
 
   double now = Clocks::system();
@@ -175,7 +181,7 @@ void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFi
 
   auto end_time = Time::now();
 
-  VLOG(file_gc) << "Finish files GC: " << tag("time", end_time - begin_time) << tag("total", file_cnt)
+  VLOG(file_gc) << "Choose files to delete: " << tag("time", end_time - begin_time) << tag("total", file_cnt)
                 << tag("removed", remove_by_atime_cnt + remove_by_count_cnt + remove_by_size_cnt)
                 << tag("total_size", format::as_size(total_size))
                 << tag("total_removed_size", format::as_size(total_removed_size))
@@ -185,13 +191,77 @@ void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFi
                 << tag("owner_dialog_id_immunity", owner_dialog_id_ignored_cnt)
                 << tag("exclude_owner_dialog_id_immunity", exclude_owner_dialog_id_ignored_cnt);
   if (end_time - begin_time > 1.0) {
-    LOG(WARNING) << "Finish file GC: " << tag("time", end_time - begin_time) << tag("total", file_cnt)
+    LOG(WARNING) << "Choose files to delete: " << tag("time", end_time - begin_time) << tag("total", file_cnt)
                  << tag("removed", remove_by_atime_cnt + remove_by_count_cnt + remove_by_size_cnt)
                  << tag("total_size", format::as_size(total_size))
                  << tag("total_removed_size", format::as_size(total_removed_size));
   }
 
-  promise.set_value({std::move(new_stats), std::move(removed_stats)});
+  result_ = make_unique<FileGcResult>(FileGcResult{std::move(new_stats), std::move(removed_stats)});
+  promise_ = std::move(promise);
+  deleted_file_count_ = 0;
+  deleted_size_ = 0;
+  max_deleted_files_per_second_ = parameters.max_deleted_files_per_second_;
+  deletion_start_time_ = Time::now();
+  delete_files();
+}
+
+void FileGcWorker::timeout_expired() {
+  delete_files();
+}
+
+void FileGcWorker::delete_files() {
+  if (token_) {
+    files_to_delete_.clear();
+    result_ = nullptr;
+    return promise_.set_error(Global::request_aborted_error());
+  }
+
+  auto slice_end_time = Time::now() + MAX_DELETION_TIME_SLICE;
+  while (deleted_file_count_ < files_to_delete_.size()) {
+    auto now = Time::now();
+    if (now >= slice_end_time) {
+      break;
+    }
+    if (max_deleted_files_per_second_ != 0 &&
+        static_cast<double>(deleted_file_count_) >=
+            (now - deletion_start_time_ + 1.0) * static_cast<double>(max_deleted_files_per_second_)) {
+      break;
+    }
+
+    const auto &info = files_to_delete_[deleted_file_count_++];
+    auto status = unlink(info.path);
+    LOG_IF(WARNING, status.is_error()) << "Failed to unlink file \"" << info.path << "\" during files GC: " << status;
+    send_closure(G()->file_manager(), &FileManager::on_file_unlink,
+                 FullLocalFileLocation(info.file_type, info.path, info.mtime_nsec));
+    deleted_size_ += info.size;
+  }
+
+  if (deleted_file_count_ < files_to_delete_.size()) {
+    VLOG(file_gc) << "Deleted " << deleted_file_count_ << " out of " << files_to_delete_.size()
+                  << " files of total size " << format::as_size(deleted_size_);
+    send_closure(G()->storage_manager(), &StorageManager::on_gc_progress, narrow_cast<int32>(deleted_file_count_),
+                 narrow_cast<int32>(files_to_delete_.size()), deleted_size_);
+    double delay = 0.0;
+    if (max_deleted_files_per_second_ != 0) {
+      delay = max(static_cast<double>(deleted_file_count_) / max_deleted_files_per_second_ - 1.0 -
+                      (Time::now() - deletion_start_time_),
+                  0.0);
+    }
+    // give other actors on the scheduler a chance to run
+    set_timeout_in(delay);
+    return;
+  }
+
+  // shared files, which were unlinked from files directories of all clients, can be deleted now
+  clean_shared_file_store();
+
+  VLOG(file_gc) << "Finish files GC: deleted " << deleted_file_count_ << " files of total size "
+                << format::as_size(deleted_size_) << " in " << (Time::now() - deletion_start_time_);
+  files_to_delete_.clear();
+  auto result = std::move(*result_);
+  result_ = nullptr;
+  promise_.set_value(std::move(result));
 }
 
 }  // namespace td
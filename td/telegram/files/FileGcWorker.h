@@ -31,8 +31,24 @@ class FileGcWorker final : public Actor {
   void run_gc(const FileGcParameters &parameters, std::vector<FullFileInfo> files, Promise<FileGcResult> promise);
 
  private:
+  // maximum time spent on file deletion in one actor run
+  static constexpr double MAX_DELETION_TIME_SLICE = 0.02;
+
   ActorShared<> parent_;
   CancellationToken token_;
+
+  // files selected for deletion are deleted in chunks to avoid long IO bursts
+  vector<FullFileInfo> files_to_delete_;
+  size_t deleted_file_count_ = 0;
+  int64 deleted_size_ = 0;
+  uint32 max_deleted_files_per_second_ = 0;
+  double deletion_start_time_ = 0.0;
+  unique_ptr<FileGcResult> result_;
+  Promise<FileGcResult> promise_;
+
+  void delete_files();
+
+  void timeout_expired() final;
 };
 
 }  // namespace td
@@ -19,106 +19,76 @@
 #include "td/utils/MimeType.h"
 #include "td/utils/misc.h"
 #include "td/utils/PathView.h"
-#include "td/utils/port/FileFd.h"
-#include "td/utils/port/PollFlags.h"
 #include "td/utils/Status.h"
 
 namespace td {
 
 void FileHashUploader::start_up() {
-  auto status = init();
-  if (status.is_error()) {
-    callback_->on_error(std::move(status));
-    stop_flag_ = true;
-    return;
-  }
-}
-
-Status FileHashUploader::init() {
-  TRY_RESULT(fd, FileFd::open(local_.path_, FileFd::Read));
-  TRY_RESULT(file_size, fd.get_size());
-  if (file_size != size_) {
-    return Status::Error("Size mismatch");
-  }
-  fd_ = BufferedFd<FileFd>(std::move(fd));
   sha256_state_.init();
+}
 
-  resource_state_.set_unit_size(1024);
-  resource_state_.update_estimated_limit(size_);
-  return Status::OK();
+void FileHashUploader::on_error(Status status) {
+  stop_flag_ = true;
+  callback_->on_error(std::move(status));
 }
 
-void FileHashUploader::loop() {
+void FileHashUploader::on_part_read(int64 offset, BufferSlice bytes) {
   if (stop_flag_) {
     return;
   }
 
-  auto status = loop_impl();
+  auto status = on_part_read_impl(offset, std::move(bytes));
   if (status.is_error()) {
-    callback_->on_error(std::move(status));
-    stop_flag_ = true;
-    return;
+    return on_error(std::move(status));
   }
 }
 
-Status FileHashUploader::loop_impl() {
-  if (state_ == State::CalcSha) {
-    TRY_STATUS(loop_sha());
-  }
-  if (state_ == State::NetRequest) {
-    // messages.getDocumentByHash#338e2464 sha256:bytes size:long mime_type:string = Document;
-    auto hash = BufferSlice(32);
-    sha256_state_.extract(hash.as_mutable_slice(), true);
-    auto mime_type = MimeType::from_extension(PathView(local_.path_).extension(), "image/gif");
-    auto query = telegram_api::messages_getDocumentByHash(std::move(hash), size_, std::move(mime_type));
-    LOG(INFO) << "Send getDocumentByHash request: " << to_string(query);
-    auto ptr = G()->net_query_creator().create(query);
-    G()->net_query_dispatcher().dispatch_with_callback(std::move(ptr), actor_shared(this));
-    state_ = State::WaitNetResult;
-  }
-  return Status::OK();
-}
-
-Status FileHashUploader::loop_sha() {
-  auto limit = resource_state_.unused();
-  if (limit == 0) {
+Status FileHashUploader::on_part_read_impl(int64 offset, BufferSlice bytes) {
+  if (state_ != State::CalcSha) {
     return Status::OK();
   }
-  if (limit > size_left_) {
-    limit = size_left_;
+  auto hashed_size = size_ - size_left_;
+  if (offset < hashed_size) {
+    // the part was read again
+    return Status::OK();
   }
-  resource_state_.start_use(limit);
-
-  fd_.get_poll_info().add_flags(PollFlags::Read());
-  TRY_RESULT(read_size, fd_.flush_read(static_cast<size_t>(limit)));
-  if (read_size != static_cast<size_t>(limit)) {
-    return Status::Error("Unexpected end of file");
+  if (offset > hashed_size) {
+    return Status::Error("File parts are read out of order");
   }
-  while (true) {
-    auto ready = fd_.input_buffer().prepare_read();
-    if (ready.empty()) {
-      break;
-    }
-    sha256_state_.feed(ready);
-    fd_.input_buffer().confirm_read(ready.size());
+  if (static_cast<int64>(bytes.size()) > size_left_) {
+    return Status::Error("File size mismatch");
   }
-  resource_state_.stop_use(limit);
 
-  size_left_ -= narrow_cast<int64>(read_size);
-  CHECK(size_left_ >= 0);
+  sha256_state_.feed(bytes.as_slice());
+  size_left_ -= static_cast<int64>(bytes.size());
   if (size_left_ == 0) {
     state_ = State::NetRequest;
-    return Status::OK();
+    send_get_document_by_hash_query();
   }
   return Status::OK();
 }
 
+void FileHashUploader::send_get_document_by_hash_query() {
+  CHECK(state_ == State::NetRequest);
+  // messages.getDocumentByHash#338e2464 sha256:bytes size:long mime_type:string = Document;
+  auto hash = BufferSlice(32);
+  sha256_state_.extract(hash.as_mutable_slice(), true);
+  auto mime_type = MimeType::from_extension(PathView(local_.path_).extension(), "image/gif");
+  auto query = telegram_api::messages_getDocumentByHash(std::move(hash), size_, std::move(mime_type));
+  LOG(INFO) << "Send getDocumentByHash request: " << to_string(query);
+  auto ptr = G()->net_query_creator().create(query);
+  G()->net_query_dispatcher().dispatch_with_callback(std::move(ptr), actor_shared(this));
+  state_ = State::WaitNetResult;
+}
+
 void FileHashUploader::on_result(NetQueryPtr net_query) {
+  if (stop_flag_) {
+    return;
+  }
+
   auto status = on_result_impl(std::move(net_query));
   if (status.is_error()) {
-    callback_->on_error(std::move(status));
-    stop_flag_ = true;
-    return;
+    return on_error(std::move(status));
   }
 }
 
@@ -6,21 +6,20 @@
 //
 #pragma once
 
-#include "td/telegram/files/FileLoaderActor.h"
 #include "td/telegram/files/FileLocation.h"
-#include "td/telegram/files/ResourceManager.h"
 #include "td/telegram/net/NetQuery.h"
 
 #include "td/actor/actor.h"
 
-#include "td/utils/BufferedFd.h"
+#include "td/utils/buffer.h"
+#include "td/utils/common.h"
 #include "td/utils/crypto.h"
-#include "td/utils/port/FileFd.h"
 #include "td/utils/Status.h"
 
 namespace td {
 
-class FileHashUploader final : public FileLoaderActor {
+// calculates SHA-256 hash of a file from its parts, read by FileUploader, and tries to find the file by the hash
+class FileHashUploader final : public NetQueryCallback {
  public:
   class Callback {
    public:
@@ -37,46 +36,26 @@ class FileHashUploader final : public FileLoaderActor {
       : local_(local), size_(size), size_left_(size), callback_(std::move(callback)) {
   }
 
- private:
-  ResourceState resource_state_;
-  BufferedFd<FileFd> fd_;
+  // parts must be received in order; already hashed parts are ignored
+  void on_part_read(int64 offset, BufferSlice bytes);
 
+ private:
   FullLocalFileLocation local_;
   int64 size_;
   int64 size_left_;
   unique_ptr<Callback> callback_;
 
-  ActorShared<ResourceManager> resource_manager_;
-
   enum class State : int32 { CalcSha, NetRequest, WaitNetResult } state_ = State::CalcSha;
   bool stop_flag_ = false;
   Sha256State sha256_state_;
 
-  void set_resource_manager(ActorShared<ResourceManager> resource_manager) final {
-    resource_manager_ = std::move(resource_manager);
-    send_closure(resource_manager_, &ResourceManager::update_resources, resource_state_);
-  }
-
-  void update_priority(int8 priority) final {
-    send_closure(resource_manager_, &ResourceManager::update_priority, priority);
-  }
-
-  void update_resources(const ResourceState &other) final {
-    if (stop_flag_) {
-      return;
-    }
-    resource_state_.update_slave(other);
-    loop();
-  }
-
   void start_up() final;
-  Status init();
 
-  void loop() final;
+  void on_error(Status status);
 
-  Status loop_impl();
+  Status on_part_read_impl(int64 offset, BufferSlice bytes);
 
-  Status loop_sha();
+  void send_get_document_by_hash_query();
 
   void on_result(NetQueryPtr net_query) final;
 
@@ -6,9 +6,11 @@
 //
 #include "td/telegram/files/FileLoaderUtils.h"
 
+#include "td/telegram/files/FileLocation.hpp"
 #include "td/telegram/Global.h"
 #include "td/telegram/TdDb.h"
 
+#include "td/utils/base64.h"
 #include "td/utils/common.h"
 #include "td/utils/filesystem.h"
 #include "td/utils/format.h"
@@ -20,6 +22,7 @@
 #include "td/utils/Random.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/StringBuilder.h"
+#include "td/utils/tl_helpers.h"
 #include "td/utils/utf8.h"
 
 #include <tuple>
@@ -162,6 +165,65 @@ Result<string> search_file(FileType file_type, CSlice name, int64 expected_size)
   return res;
 }
 
+string get_shared_file_store_path(const FullRemoteFileLocation &remote_location) {
+  auto dir = G()->get_option_string("shared_file_store_directory");
+  if (dir.empty() || remote_location.is_web()) {
+    return string();
+  }
+  if (dir.back() != TD_DIR_SLASH) {
+    dir += TD_DIR_SLASH;
+  }
+  // files are content-addressed by their unique identifier, which is the same for all users
+  return PSTRING() << dir << base64url_encode(zero_encode(serialize(remote_location.as_unique())));
+}
+
+Result<string> create_from_shared_file_store(FileType file_type, CSlice store_path, int64 expected_size,
+                                             CSlice name) {
+  TRY_RESULT(store_stat, stat(store_path));
+  if (!store_stat.is_reg_ || store_stat.size_ != expected_size) {
+    return Status::Error(PSLICE() << "Have shared file of size " << store_stat.size_ << " instead of " << expected_size);
+  }
+
+  TRY_RESULT(temp_file, open_temp_file(file_type));
+  temp_file.first.close();
+  auto temp_path = std::move(temp_file.second);
+  TRY_STATUS(unlink(temp_path));
+  TRY_STATUS(link(store_path, temp_path));
+  auto r_path = create_from_temp(file_type, temp_path, name);
+  if (r_path.is_error()) {
+    unlink(temp_path).ignore();
+  }
+  return r_path;
+}
+
+void add_to_shared_file_store(CSlice path, CSlice store_path) {
+  auto status = mkpath(store_path, 0750);
+  if (status.is_ok()) {
+    status = link(path, store_path);
+  }
+  if (status.is_error() && stat(store_path).is_error()) {
+    LOG(INFO) << "Failed to add file to the shared file store: " << status;
+  }
+}
+
+void clean_shared_file_store() {
+  auto dir = G()->get_option_string("shared_file_store_directory");
+  if (dir.empty()) {
+    return;
+  }
+  walk_path(dir, [&](CSlice path, WalkPath::Type type) {
+    if (type != WalkPath::Type::RegularFile) {
+      return WalkPath::Action::Continue;
+    }
+    auto r_stat = stat(path);
+    if (r_stat.is_ok() && r_stat.ok().link_count_ == 1) {
+      LOG(INFO) << "Delete unused shared file " << path;
+      unlink(path).ignore();
+    }
+    return WalkPath::Action::Continue;
+  }).ignore();
+}
+
 Result<string> get_suggested_file_name(CSlice directory, Slice file_name) {
   string cleaned_name = clean_filename(file_name.str());
   file_name = cleaned_name;
@@ -28,6 +28,17 @@ Result<string> create_from_temp(FileType file_type, CSlice temp_path, CSlice nam
 
 Result<string> search_file(FileType type, CSlice name, int64 expected_size) TD_WARN_UNUSED_RESULT;
 
+// returns path to the file in the shared file store or an empty string if the store isn't used
+string get_shared_file_store_path(const FullRemoteFileLocation &remote_location);
+
+Result<string> create_from_shared_file_store(FileType file_type, CSlice store_path, int64 expected_size,
+                                             CSlice name) TD_WARN_UNUSED_RESULT;
+
+void add_to_shared_file_store(CSlice path, CSlice store_path);
+
+// deletes files from the shared file store, which aren't linked from files directories
+void clean_shared_file_store();
+
 Result<string> get_suggested_file_name(CSlice dir, Slice file_name) TD_WARN_UNUSED_RESULT;
 
 Result<FullLocalFileLocation> save_file_bytes(FileType file_type, BufferSlice bytes, CSlice file_name);
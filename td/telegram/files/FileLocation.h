@@ -16,7 +16,9 @@
 #include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/format.h"
+#include "td/utils/HashTableUtils.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/Slice.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/Variant.h"
@@ -724,6 +726,38 @@ inline StringBuilder &operator<<(StringBuilder &sb, const FullLocalFileLocation
   return sb << "[full local location of " << location.file_type_ << "] at \"" << location.path_ << '"';
 }
 
+// hash table key of a full local location; a path inside the base directory is stored relative to it
+// to avoid keeping the common prefix of paths of all files downloaded by TDLib
+struct FullLocalFileLocationKey {
+  uint64 mtime_nsec_ = 0;
+  FileType file_type_ = FileType::None;
+  bool is_relative_ = false;
+  bool is_valid_ = false;  // false only for empty keys of hash tables
+  string path_;
+
+  FullLocalFileLocationKey() = default;
+  FullLocalFileLocationKey(const FullLocalFileLocation &location, Slice base_dir)
+      : mtime_nsec_(location.mtime_nsec_), file_type_(location.file_type_), is_valid_(true) {
+    if (!base_dir.empty() && begins_with(location.path_, base_dir)) {
+      is_relative_ = true;
+      path_ = location.path_.substr(base_dir.size());
+    } else {
+      path_ = location.path_;
+    }
+  }
+};
+
+inline bool operator==(const FullLocalFileLocationKey &lhs, const FullLocalFileLocationKey &rhs) {
+  return lhs.mtime_nsec_ == rhs.mtime_nsec_ && lhs.file_type_ == rhs.file_type_ &&
+         lhs.is_relative_ == rhs.is_relative_ && lhs.is_valid_ == rhs.is_valid_ && lhs.path_ == rhs.path_;
+}
+
+struct FullLocalFileLocationKeyHash {
+  uint32 operator()(const FullLocalFileLocationKey &key) const {
+    return combine_hashes(Hash<string>()(key.path_), Hash<uint64>()(key.mtime_nsec_));
+  }
+};
+
 struct PartialLocalFileLocationPtr {
   unique_ptr<PartialLocalFileLocation> location_;  // must never be equal to nullptr
 
@@ -16,6 +16,7 @@
 #include "td/telegram/files/FileLocation.hpp"
 #include "td/telegram/Global.h"
 #include "td/telegram/logevent/LogEvent.h"
+#include "td/telegram/MemoryStatistics.h"
 #include "td/telegram/misc.h"
 #include "td/telegram/SecureStorage.h"
 #include "td/telegram/TdDb.h"
@@ -273,6 +274,7 @@ void FileNode::set_local_location(const LocalFileLocation &local, int64 ready_si
 }
 
 void FileNode::set_new_remote_location(NewRemoteFileLocation new_remote) {
+  drop_file_ids();
   if (new_remote.full) {
     if (remote_.full && remote_.full.value() == new_remote.full.value()) {
       if (remote_.full.value().get_access_hash() != new_remote.full.value().get_access_hash() ||
@@ -357,6 +359,7 @@ bool FileNode::delete_file_reference(Slice file_reference) {
   }
 
   VLOG(file_references) << "Do delete file reference of main file " << main_file_id_;
+  drop_file_ids();
   upload_was_update_file_reference_ = false;
   download_was_update_file_reference_ = false;
   on_pmc_changed();
@@ -367,6 +370,7 @@ void FileNode::set_generate_location(unique_ptr<FullGenerateFileLocation> &&gene
   bool is_changed = generate_ == nullptr ? generate != nullptr : generate == nullptr || *generate_ != *generate;
   if (is_changed) {
     generate_ = std::move(generate);
+    drop_file_ids();
     on_pmc_changed();
   }
 }
@@ -398,6 +402,7 @@ void FileNode::set_url(string url) {
   if (url_ != url) {
     VLOG(update_file) << "File " << main_file_id_ << " has changed URL to " << url;
     url_ = std::move(url);
+    drop_file_ids();
     on_changed();
   }
 }
@@ -410,12 +415,27 @@ void FileNode::set_owner_dialog_id(DialogId owner_id) {
 }
 
 void FileNode::set_encryption_key(FileEncryptionKey key) {
-  if (encryption_key_ != key) {
-    encryption_key_ = std::move(key);
+  if (encryption_key() != key) {
+    encryption_key_ = create_encryption_key(std::move(key));
     on_pmc_changed();
   }
 }
 
+const FileEncryptionKey &FileNode::encryption_key() const {
+  if (encryption_key_ == nullptr) {
+    static const FileEncryptionKey empty_encryption_key;
+    return empty_encryption_key;
+  }
+  return *encryption_key_;
+}
+
+unique_ptr<FileEncryptionKey> FileNode::create_encryption_key(FileEncryptionKey key) {
+  if (key.empty()) {
+    return nullptr;
+  }
+  return make_unique<FileEncryptionKey>(std::move(key));
+}
+
 void FileNode::set_upload_pause(FileId upload_pause) {
   if (upload_pause_ != upload_pause) {
     LOG(INFO) << "Change file " << main_file_id_ << " upload_pause from " << upload_pause_ << " to " << upload_pause;
@@ -482,7 +502,7 @@ bool FileNode::need_pmc_flush() const {
   }
 
   // We must save encryption key
-  if (!encryption_key_.empty()) {
+  if (encryption_key_ != nullptr) {
     // && remote_.type() != RemoteFileLocation::Type::Empty
     return true;
   }
@@ -847,26 +867,37 @@ string FileNode::get_persistent_id(const FullRemoteFileLocation &location) {
   return base64url_encode(binary);
 }
 
-string FileNode::get_persistent_file_id() const {
-  if (remote_.is_full_alive) {
-    return get_persistent_id(remote_.full.value());
-  } else if (!url_.empty()) {
-    return url_;
-  } else if (generate_ != nullptr && FileManager::is_remotely_generated_file(generate_->conversion_)) {
-    return get_persistent_id(*generate_);
-  }
-  return string();
+const string &FileNode::get_persistent_file_id() const {
+  calc_file_ids();
+  return cached_file_ids_->persistent_file_id_;
 }
 
-string FileNode::get_unique_file_id() const {
+const string &FileNode::get_unique_file_id() const {
+  calc_file_ids();
+  return cached_file_ids_->unique_file_id_;
+}
+
+void FileNode::calc_file_ids() const {
+  if (cached_file_ids_ != nullptr) {
+    return;
+  }
+  cached_file_ids_ = make_unique<FileIds>();
+
   if (remote_.is_full_alive) {
+    cached_file_ids_->persistent_file_id_ = get_persistent_id(remote_.full.value());
     if (!remote_.full.value().is_web()) {
-      return get_unique_id(remote_.full.value());
+      cached_file_ids_->unique_file_id_ = get_unique_id(remote_.full.value());
     }
+  } else if (!url_.empty()) {
+    cached_file_ids_->persistent_file_id_ = url_;
   } else if (generate_ != nullptr && FileManager::is_remotely_generated_file(generate_->conversion_)) {
-    return get_unique_id(*generate_);
+    cached_file_ids_->persistent_file_id_ = get_persistent_id(*generate_);
+    cached_file_ids_->unique_file_id_ = get_unique_id(*generate_);
   }
-  return string();
+}
+
+void FileNode::drop_file_ids() {
+  cached_file_ids_ = nullptr;
 }
 
 /*** FileManager ***/
@@ -1138,7 +1169,7 @@ void FileManager::on_recheck_full_local_location(FullLocalFileLocation checked_l
     return;
   }
 
-  auto file_id_it = local_location_to_file_id_.find(checked_location);
+  auto file_id_it = local_location_to_file_id_.find(get_local_location_key(checked_location));
   if (file_id_it == local_location_to_file_id_.end()) {
     return;
   }
@@ -1178,6 +1209,10 @@ bool FileManager::try_fix_partial_local_location(FileNodePtr node) {
   return true;
 }
 
+FullLocalFileLocationKey FileManager::get_local_location_key(const FullLocalFileLocation &location) {
+  return FullLocalFileLocationKey(location, get_files_base_dir(location.file_type_));
+}
+
 FileManager::FileIdInfo *FileManager::get_file_id_info(FileId file_id) {
   CHECK(static_cast<size_t>(file_id.get()) < file_id_info_.size());
   return &file_id_info_[file_id.get()];
@@ -1238,7 +1273,7 @@ FileId FileManager::register_empty(FileType type) {
 }
 
 void FileManager::on_file_unlink(const FullLocalFileLocation &location) {
-  auto it = local_location_to_file_id_.find(location);
+  auto it = local_location_to_file_id_.find(get_local_location_key(location));
   if (it == local_location_to_file_id_.end()) {
     return;
   }
@@ -1421,9 +1456,13 @@ Result<FileId> FileManager::register_file(FileData &&data, FileLocationSource fi
       new_remote = new_remote_file_id != nullptr;
     }
   }
-  FileId *new_local_file_id = nullptr;
+  // FlatHashMap doesn't preserve references to its values, so the key is kept instead
+  FullLocalFileLocationKey new_local_location_key;
   if (file_view.has_local_location()) {
-    new_local_file_id = register_location(file_view.local_location(), local_location_to_file_id_);
+    auto local_location_key = get_local_location_key(file_view.local_location());
+    if (register_location(local_location_key, local_location_to_file_id_) != nullptr) {
+      new_local_location_key = std::move(local_location_key);
+    }
   }
   FileId *new_generate_file_id = nullptr;
   if (file_view.has_generate_location()) {
@@ -1431,7 +1470,7 @@ Result<FileId> FileManager::register_file(FileData &&data, FileLocationSource fi
   }
   td::unique(to_merge);
 
-  int new_cnt = new_remote + (new_local_file_id != nullptr) + (new_generate_file_id != nullptr);
+  int new_cnt = new_remote + new_local_location_key.is_valid_ + (new_generate_file_id != nullptr);
   if (data.pmc_id_ == 0 && file_db_ && new_cnt > 0) {
     node->need_load_from_pmc_ = true;
   }
@@ -1451,8 +1490,8 @@ Result<FileId> FileManager::register_file(FileData &&data, FileLocationSource fi
     if (new_remote_file_id != nullptr) {
       *new_remote_file_id = main_file_id;
     }
-    if (new_local_file_id != nullptr) {
-      *new_local_file_id = main_file_id;
+    if (new_local_location_key.is_valid_) {
+      local_location_to_file_id_[new_local_location_key] = main_file_id;
     }
     if (new_generate_file_id != nullptr) {
       *new_generate_file_id = main_file_id;
@@ -1708,7 +1747,7 @@ Status FileManager::merge(FileId x_file_id, FileId y_file_id, bool no_sync) {
   int remote_name_i = merge_choose_name(x_node->remote_name_, y_node->remote_name_);
   int url_i = merge_choose_name(x_node->url_, y_node->url_);
   int owner_i = merge_choose_owner(x_node->owner_dialog_id_, y_node->owner_dialog_id_);
-  int encryption_key_i = merge_choose_encryption_key(x_node->encryption_key_, y_node->encryption_key_);
+  int encryption_key_i = merge_choose_encryption_key(x_node->encryption_key(), y_node->encryption_key());
   int main_file_id_i = merge_choose_main_file_id(x_node->main_file_id_, x_node->main_file_id_priority_,
                                                  y_node->main_file_id_, y_node->main_file_id_priority_);
 
@@ -1836,8 +1875,8 @@ Status FileManager::merge(FileId x_file_id, FileId y_file_id, bool no_sync) {
   }
 
   if (encryption_key_i == other_node_i) {
-    node->set_encryption_key(other_node->encryption_key_);
-    nodes[node_i]->set_encryption_key(nodes[encryption_key_i]->encryption_key_);
+    node->set_encryption_key(other_node->encryption_key());
+    nodes[node_i]->set_encryption_key(nodes[encryption_key_i]->encryption_key());
   }
   node->need_load_from_pmc_ |= other_node->need_load_from_pmc_;
   node->can_search_locally_ &= other_node->can_search_locally_;
@@ -2058,6 +2097,9 @@ void FileManager::try_flush_node_info(FileNodePtr node, const char *source) {
         // For DownloadManager. For everybody else it is just an empty function call (I hope).
         info->download_callback_->on_progress(file_id);
       }
+      if (!streaming_reads_.empty()) {
+        check_streaming_reads(file_id);
+      }
     }
     node->on_info_flushed();
   }
@@ -2120,14 +2162,14 @@ void FileManager::flush_to_pmc(FileNodePtr node, bool new_remote, bool new_local
     data.local_ = LocalFileLocation();
     data.remote_ = RemoteFileLocation();
   }
-  if (data.remote_.type() != RemoteFileLocation::Type::Full && node->encryption_key_.is_secure()) {
+  if (data.remote_.type() != RemoteFileLocation::Type::Full && node->encryption_key().is_secure()) {
     data.remote_ = RemoteFileLocation();
   }
 
   data.size_ = node->size_;
   data.expected_size_ = node->expected_size_;
   data.remote_name_ = node->remote_name_;
-  data.encryption_key_ = node->encryption_key_;
+  data.encryption_key_ = node->encryption_key();
   data.url_ = node->url_;
   data.owner_dialog_id_ = node->owner_dialog_id_;
   data.file_source_ids_ = context_->get_some_file_sources(view.get_main_file_id());
@@ -2219,7 +2261,7 @@ bool FileManager::set_encryption_key(FileId file_id, FileEncryptionKey key) {
   if (view.has_local_location() && view.has_remote_location()) {
     return false;
   }
-  if (!node->encryption_key_.empty()) {
+  if (node->encryption_key_ != nullptr) {
     return false;
   }
   node->set_encryption_key(std::move(key));
@@ -2351,6 +2393,96 @@ void FileManager::read_file_part(FileId file_id, int64 offset, int64 count, int
                std::move(read_file_part_promise));
 }
 
+void FileManager::read_file_part_streaming(FileId file_id, std::shared_ptr<DownloadCallback> callback, int32 priority,
+                                           int64 offset, int64 count,
+                                           Promise<td_api::object_ptr<td_api::filePart>> promise) {
+  TRY_STATUS_PROMISE(promise, G()->close_status());
+
+  if (!file_id.is_valid()) {
+    return promise.set_error(Status::Error(400, "File identifier is invalid"));
+  }
+  auto node = get_sync_file_node(file_id);
+  if (!node) {
+    return promise.set_error(Status::Error(400, "File not found"));
+  }
+  if (offset < 0) {
+    return promise.set_error(Status::Error(400, "Parameter offset must be non-negative"));
+  }
+  if (count <= 0) {
+    return promise.set_error(Status::Error(400, "Parameter count must be positive"));
+  }
+  if (count >= static_cast<int64>(std::numeric_limits<size_t>::max() / 2 - 1)) {
+    return promise.set_error(Status::Error(400, "Part length is too big"));
+  }
+
+  auto &state = streaming_reads_[file_id];
+  if (offset == state.next_offset_ && state.read_ahead_ != 0) {
+    state.read_ahead_ = min(state.read_ahead_ * 2, MAX_STREAMING_READ_AHEAD);
+  } else {
+    state.read_ahead_ = MIN_STREAMING_READ_AHEAD;
+  }
+  state.next_offset_ = offset + count;
+  auto limit = count + state.read_ahead_;
+  LOG(INFO) << "Read " << count << " bytes of file " << file_id << " from offset " << offset << " with read-ahead "
+            << state.read_ahead_;
+
+  StreamingRead read;
+  read.offset_ = offset;
+  read.count_ = count;
+  read.promise_ = std::move(promise);
+  state.reads_.push_back(std::move(read));
+
+  download(file_id, std::move(callback), priority, offset, limit, Auto());
+  check_streaming_reads(file_id);
+}
+
+void FileManager::check_streaming_reads(FileId file_id) {
+  auto it = streaming_reads_.find(file_id);
+  if (it == streaming_reads_.end() || it->second.reads_.empty()) {
+    return;
+  }
+  auto node = get_file_node(file_id);
+  if (!node) {
+    return fail_streaming_reads(file_id, Status::Error(400, "File not found"));
+  }
+
+  FileView file_view(node);
+  auto reads = std::move(it->second.reads_);
+  it->second.reads_.clear();
+  for (auto &read : reads) {
+    auto available_size = file_view.downloaded_prefix(read.offset_);
+    auto needed_size = read.count_;
+    if (file_view.size() != 0) {
+      needed_size = min(needed_size, max(file_view.size() - read.offset_, static_cast<int64>(0)));
+    }
+    if (available_size < needed_size) {
+      it->second.reads_.push_back(std::move(read));
+      continue;
+    }
+    if (needed_size == 0) {
+      read.promise_.set_value(td_api::make_object<td_api::filePart>());
+      continue;
+    }
+    read_file_part(file_id, read.offset_, needed_size, 2, std::move(read.promise_));
+  }
+  if (it->second.reads_.empty() && file_view.has_local_location()) {
+    // there is nothing to read ahead anymore
+    streaming_reads_.erase(it);
+  }
+}
+
+void FileManager::fail_streaming_reads(FileId file_id, Status error) {
+  auto it = streaming_reads_.find(file_id);
+  if (it == streaming_reads_.end()) {
+    return;
+  }
+  auto reads = std::move(it->second.reads_);
+  streaming_reads_.erase(it);
+  for (auto &read : reads) {
+    read.promise_.set_error(error.clone());
+  }
+}
+
 void FileManager::delete_file(FileId file_id, Promise<Unit> promise, const char *source) {
   LOG(INFO) << "Trying to delete file " << file_id << " from " << source;
   auto node = get_sync_file_node(file_id);
@@ -2366,7 +2498,7 @@ void FileManager::delete_file(FileId file_id, Promise<Unit> promise, const char
     if (begins_with(file_view.local_location().path_, get_files_dir(file_view.get_type()))) {
       clear_from_pmc(node);
       if (context_->need_notify_on_new_files()) {
-        context_->on_new_file(-file_view.size(), -file_view.get_allocated_local_size(), -1);
+        context_->on_new_file(file_view.get_type(), -file_view.size(), -file_view.get_allocated_local_size(), -1);
       }
       path = std::move(node->local_.full().path_);
     }
@@ -2480,6 +2612,9 @@ void FileManager::download_impl(FileId file_id, std::shared_ptr<DownloadCallback
   file_info->ignore_download_limit = limit == IGNORE_DOWNLOAD_LIMIT;
   file_info->download_priority_ = narrow_cast<int8>(new_priority);
   file_info->download_callback_ = std::move(callback);
+  if (new_priority == 0) {
+    fail_streaming_reads(file_id, Status::Error(200, "Canceled"));
+  }
 
   if (file_info->download_callback_) {
     file_info->download_callback_->on_progress(file_id);
@@ -2613,7 +2748,7 @@ void FileManager::run_download(FileNodePtr node, bool force_update_priority) {
   node->is_download_started_ = false;
   LOG(INFO) << "Run download of file " << file_id << " of size " << node->size_ << " from "
             << node->remote_.full.value() << " with suggested name " << node->suggested_path() << " and encyption key "
-            << node->encryption_key_;
+            << node->encryption_key();
   auto download_offset = node->download_offset_;
   auto download_limit = node->get_download_limit();
   if (file_view.is_encrypted_any()) {
@@ -2623,7 +2758,7 @@ void FileManager::run_download(FileNodePtr node, bool force_update_priority) {
     download_offset = 0;
   }
   send_closure(file_download_manager_, &FileDownloadManager::download, query_id, node->remote_.full.value(),
-               node->local_, node->size_, node->suggested_path(), node->encryption_key_, node->can_search_locally_,
+               node->local_, node->size_, node->suggested_path(), node->encryption_key(), node->can_search_locally_,
                download_offset, download_limit, priority);
 }
 
@@ -2798,6 +2933,7 @@ void FileManager::resume_upload(FileId file_id, vector<int> bad_parts, std::shar
 
   if (force) {
     node->remote_.is_full_alive = false;
+    node->drop_file_ids();
   }
   if (prefer_small) {
     node->upload_prefer_small_ = true;
@@ -3122,28 +3258,28 @@ void FileManager::run_upload(FileNodePtr node, vector<int> bad_parts) {
     return;
   }
 
+  auto expected_size = file_view.expected_size(true);
+  if (node->upload_prefer_small_ && (10 << 20) < expected_size && expected_size < (30 << 20)) {
+    expected_size = 10 << 20;
+  }
+
   if (!node->remote_.partial && node->get_by_hash_) {
     LOG(INFO) << "Get file " << node->main_file_id_ << " by hash";
     FileUploadManager::QueryId query_id = upload_queries_.create(UploadQuery{file_id, UploadQuery::Type::UploadByHash});
     node->upload_id_ = query_id;
 
     send_closure(file_upload_manager_, &FileUploadManager::upload_by_hash, query_id, node->local_.full(), node->size_,
-                 narrow_cast<int8>(-priority));
+                 expected_size, node->encryption_key(), narrow_cast<int8>(-priority));
     return;
   }
 
   auto new_priority = narrow_cast<int8>(bad_parts.empty() ? -priority : priority);
   td::remove_if(bad_parts, [](auto part_id) { return part_id < 0; });
 
-  auto expected_size = file_view.expected_size(true);
-  if (node->upload_prefer_small_ && (10 << 20) < expected_size && expected_size < (30 << 20)) {
-    expected_size = 10 << 20;
-  }
-
   FileUploadManager::QueryId query_id = upload_queries_.create(UploadQuery{file_id, UploadQuery::Type::Upload});
   node->upload_id_ = query_id;
   send_closure(file_upload_manager_, &FileUploadManager::upload, query_id, node->local_,
-               node->remote_.partial_or_empty(), expected_size, node->encryption_key_, new_priority,
+               node->remote_.partial_or_empty(), expected_size, node->encryption_key(), new_priority,
                std::move(bad_parts));
 
   LOG(INFO) << "File " << file_id << " upload request has sent to FileUploadManager";
@@ -3834,7 +3970,8 @@ void FileManager::on_hash(FileUploadManager::QueryId query_id, string hash) {
     return;
   }
 
-  file_node->encryption_key_.set_value_hash(secure_storage::ValueHash::create(hash).move_as_ok());
+  CHECK(file_node->encryption_key_ != nullptr);
+  file_node->encryption_key_->set_value_hash(secure_storage::ValueHash::create(hash).move_as_ok());
 }
 
 void FileManager::on_partial_upload(FileUploadManager::QueryId query_id, PartialRemoteFileLocation partial_remote,
@@ -3881,7 +4018,8 @@ void FileManager::on_download_ok(FileDownloadManager::QueryId query_id, FullLoca
     status = Status::Error(PSLICE() << "Can't register local file after download: " << r_new_file_id.error().message());
   } else {
     if (is_new && context_->need_notify_on_new_files()) {
-      context_->on_new_file(size, get_file_view(r_new_file_id.ok()).get_allocated_local_size(), 1);
+      auto file_view = get_file_view(r_new_file_id.ok());
+      context_->on_new_file(file_view.get_type(), size, file_view.get_allocated_local_size(), 1);
     }
   }
   if (status.is_error()) {
@@ -4047,7 +4185,7 @@ void FileManager::on_generate_ok(FileGenerateManager::QueryId query_id, FullLoca
   FileView file_view(file_node);
   if (context_->need_notify_on_new_files()) {
     if (!file_view.has_generate_location() || !begins_with(file_view.generate_location().conversion_, "#file_id#")) {
-      context_->on_new_file(file_view.size(), file_view.get_allocated_local_size(), 1);
+      context_->on_new_file(file_view.get_type(), file_view.size(), file_view.get_allocated_local_size(), 1);
     }
   }
 
@@ -4295,6 +4433,7 @@ void FileManager::on_file_load_error(FileNodePtr node, Status status) {
         info->download_callback_.reset();
       }
     }
+    fail_streaming_reads(file_id, status.clone());
     if (info->upload_priority_ != 0) {
       info->upload_priority_ = 0;
       if (info->upload_callback_) {
@@ -4460,6 +4599,18 @@ void FileManager::hangup() {
   stop();
 }
 
+void FileManager::get_memory_statistics(MemoryStatistics &statistics) const {
+  size_t file_node_count = 0;
+  for (size_t i = 0; i < file_nodes_.size(); i++) {
+    if (file_nodes_[i] != nullptr) {
+      file_node_count++;
+    }
+  }
+  statistics.add_component("file_manager.file_nodes", file_node_count,
+                           file_node_count * sizeof(FileNode) + file_nodes_.size() * sizeof(unique_ptr<FileNode>));
+  statistics.add_component("file_manager.file_ids", file_id_info_.size(), file_id_info_.size() * sizeof(FileIdInfo));
+}
+
 void FileManager::tear_down() {
   parent_.reset();
 
@@ -4471,5 +4622,7 @@ void FileManager::tear_down() {
 constexpr int64 FileManager::KEEP_DOWNLOAD_LIMIT;
 constexpr int64 FileManager::KEEP_DOWNLOAD_OFFSET;
 constexpr int64 FileManager::IGNORE_DOWNLOAD_LIMIT;
+constexpr int64 FileManager::MIN_STREAMING_READ_AHEAD;
+constexpr int64 FileManager::MAX_STREAMING_READ_AHEAD;
 
 }  // namespace td
@@ -29,6 +29,7 @@
 #include "td/utils/common.h"
 #include "td/utils/Container.h"
 #include "td/utils/Enumerator.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/FlatHashSet.h"
 #include "td/utils/logging.h"
 #include "td/utils/optional.h"
@@ -50,6 +51,7 @@ extern int VERBOSITY_NAME(update_file);
 
 class FileData;
 class FileDbInterface;
+class MemoryStatistics;
 
 enum class FileLocationSource : int8 { None, FromUser, FromBinlog, FromDatabase, FromServer };
 
@@ -83,7 +85,7 @@ class FileNode {
       , remote_name_(std::move(remote_name))
       , url_(std::move(url))
       , owner_dialog_id_(owner_dialog_id)
-      , encryption_key_(std::move(key))
+      , encryption_key_(create_encryption_key(std::move(key)))
       , main_file_id_(main_file_id)
       , main_file_id_priority_(main_file_id_priority) {
     init_ready_size();
@@ -127,6 +129,8 @@ class FileNode {
 
   string suggested_path() const;
 
+  const FileEncryptionKey &encryption_key() const;
+
  private:
   friend class FileView;
   friend class FileManager;
@@ -153,8 +157,17 @@ class FileNode {
   int64 expected_size_ = 0;
   string remote_name_;
   string url_;
+
+  // cached values of persistent and unique file identifiers, which are computed when needed;
+  // they are stored separately, because most file nodes are never returned to the application
+  struct FileIds {
+    string persistent_file_id_;
+    string unique_file_id_;
+  };
+  mutable unique_ptr<FileIds> cached_file_ids_;
+
   DialogId owner_dialog_id_;
-  FileEncryptionKey encryption_key_;
+  unique_ptr<FileEncryptionKey> encryption_key_;  // only non-empty keys are stored
   FileDbId pmc_id_;
   vector<FileId> file_ids_;
 
@@ -195,15 +208,21 @@ class FileNode {
 
   bool ignore_download_limit_{false};
 
+  static unique_ptr<FileEncryptionKey> create_encryption_key(FileEncryptionKey key);
+
   void init_ready_size();
 
   void recalc_ready_prefix_size(int64 prefix_offset, int64 ready_prefix_size);
 
   void update_effective_download_limit(int64 old_download_limit);
 
-  string get_persistent_file_id() const;
+  const string &get_persistent_file_id() const;
+
+  const string &get_unique_file_id() const;
 
-  string get_unique_file_id() const;
+  void calc_file_ids() const;
+
+  void drop_file_ids();
 
   static string get_unique_id(const FullGenerateFileLocation &location);
   static string get_unique_id(const FullRemoteFileLocation &location);
@@ -352,7 +371,7 @@ class FileView {
     return is_encrypted_secret() || is_secure();
   }
   const FileEncryptionKey &encryption_key() const {
-    return node_->encryption_key_;
+    return node_->encryption_key();
   }
 
   bool may_reload_photo() const {
@@ -416,7 +435,7 @@ class FileManager final : public Actor {
    public:
     virtual bool need_notify_on_new_files() = 0;
 
-    virtual void on_new_file(int64 size, int64 real_size, int32 cnt) = 0;
+    virtual void on_new_file(FileType file_type, int64 size, int64 real_size, int32 cnt) = 0;
 
     virtual void on_file_updated(FileId size) = 0;
 
@@ -511,6 +530,10 @@ class FileManager final : public Actor {
   void read_file_part(FileId file_id, int64 offset, int64 count, int left_tries,
                       Promise<td_api::object_ptr<td_api::filePart>> promise);
 
+  // downloads the file from the offset with a read-ahead window and returns the part as soon as it is downloaded
+  void read_file_part_streaming(FileId file_id, std::shared_ptr<DownloadCallback> callback, int32 priority,
+                                int64 offset, int64 count, Promise<td_api::object_ptr<td_api::filePart>> promise);
+
   void delete_file(FileId file_id, Promise<Unit> promise, const char *source);
 
   void external_file_generate_write_part(int64 generation_id, int64 offset, string data, Promise<> promise);
@@ -557,6 +580,8 @@ class FileManager final : public Actor {
 
   static string extract_file_reference(const telegram_api::object_ptr<telegram_api::InputChatPhoto> &input_chat_photo);
 
+  void get_memory_statistics(MemoryStatistics &statistics) const;
+
   template <class StorerT>
   void store_file(FileId file_id, StorerT &storer, int32 ttl = 5) const;
 
@@ -684,6 +709,8 @@ class FileManager final : public Actor {
 
   FileIdInfo *get_file_id_info(FileId file_id);
 
+  static FullLocalFileLocationKey get_local_location_key(const FullLocalFileLocation &location);
+
   struct RemoteInfo {
     // mutable is set to to enable changing of access hash
     mutable FullRemoteFileLocation remote_;
@@ -701,7 +728,7 @@ class FileManager final : public Actor {
   WaitFreeHashMap<string, FileId> file_hash_to_file_id_;
 
   std::map<FullRemoteFileLocation, FileId> remote_location_to_file_id_;
-  std::map<FullLocalFileLocation, FileId> local_location_to_file_id_;
+  FlatHashMap<FullLocalFileLocationKey, FileId, FullLocalFileLocationKeyHash> local_location_to_file_id_;
   std::map<FullGenerateFileLocation, FileId> generate_location_to_file_id_;
 
   WaitFreeVector<FileIdInfo> file_id_info_;
@@ -722,6 +749,25 @@ class FileManager final : public Actor {
 
   int file_node_size_warning_exp_ = 10;
 
+  // the read-ahead window is doubled for each sequential streaming read
+  static constexpr int64 MIN_STREAMING_READ_AHEAD = 1 << 20;
+  static constexpr int64 MAX_STREAMING_READ_AHEAD = 32 << 20;
+
+  struct StreamingRead {
+    int64 offset_ = 0;
+    int64 count_ = 0;
+    Promise<td_api::object_ptr<td_api::filePart>> promise_;
+  };
+  struct StreamingReadState {
+    int64 next_offset_ = 0;
+    int64 read_ahead_ = 0;
+    vector<StreamingRead> reads_;
+  };
+  FlatHashMap<FileId, StreamingReadState, FileIdHash> streaming_reads_;
+
+  void check_streaming_reads(FileId file_id);
+  void fail_streaming_reads(FileId file_id, Status error);
+
   FileId next_file_id();
   FileNodeId next_file_node_id();
   int32 next_pmc_file_id();
@@ -77,6 +77,20 @@ FileTypeStat FileStats::get_total_nontemp_stat() const {
   return stat;
 }
 
+FileStats::StatByType FileStats::get_total_stat_by_type() const {
+  if (!split_by_owner_dialog_id_) {
+    return stat_by_type_;
+  }
+  StatByType result;
+  for (auto &dialog : stat_by_owner_dialog_id_) {
+    for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+      result[i].size += dialog.second[i].size;
+      result[i].cnt += dialog.second[i].cnt;
+    }
+  }
+  return result;
+}
+
 void FileStats::apply_dialog_limit(int32 limit) {
   if (limit == -1) {
     return;
@@ -41,6 +41,47 @@ void parse(FileTypeStat &stat, ParserT &parser) {
   parse(stat.cnt, parser);
 }
 
+// statistics of files by type, which are updated incrementally between full scans of files directories
+struct FileStatsIndex {
+  std::array<FileTypeStat, MAX_FILE_TYPE> stat_by_type;
+  int32 scan_date = 0;  // date of the last full scan; 0 if the index wasn't built yet
+
+  void add_file(FileType file_type, int64 size, int32 cnt) {
+    auto &stat = stat_by_type[static_cast<size_t>(file_type)];
+    stat.size += size;
+    stat.cnt += cnt;
+    if (stat.size < 0 || stat.cnt < 0) {
+      // the index is inconsistent with the file system and must be rebuilt
+      scan_date = 0;
+    }
+  }
+
+  template <class StorerT>
+  void store(StorerT &storer) const {
+    using ::td::store;
+    store(scan_date, storer);
+    store(static_cast<int32>(MAX_FILE_TYPE), storer);
+    for (auto &stat : stat_by_type) {
+      store(stat, storer);
+    }
+  }
+
+  template <class ParserT>
+  void parse(ParserT &parser) {
+    using ::td::parse;
+    parse(scan_date, parser);
+    int32 file_type_count;
+    parse(file_type_count, parser);
+    if (file_type_count != MAX_FILE_TYPE) {
+      // file types were changed; the index must be rebuilt
+      return parser.set_error("Invalid file type count");
+    }
+    for (auto &stat : stat_by_type) {
+      parse(stat, parser);
+    }
+  }
+};
+
 struct FullFileInfo {
   FileType file_type;
   string path;
@@ -67,11 +108,13 @@ struct FileStatsFast {
 };
 
 class FileStats {
+ public:
+  using StatByType = std::array<FileTypeStat, MAX_FILE_TYPE>;
+
+ private:
   bool need_all_files_{false};
   bool split_by_owner_dialog_id_{false};
 
-  using StatByType = std::array<FileTypeStat, MAX_FILE_TYPE>;
-
   StatByType stat_by_type_;
   std::unordered_map<DialogId, StatByType, DialogIdHash> stat_by_owner_dialog_id_;
   vector<FullFileInfo> all_files_;
@@ -92,6 +135,9 @@ class FileStats {
       : need_all_files_(need_all_files), split_by_owner_dialog_id_(split_by_owner_dialog_id) {
   }
 
+  explicit FileStats(const FileStatsIndex &index) : stat_by_type_(index.stat_by_type) {
+  }
+
   void add_copy(const FullFileInfo &info);
 
   void add(FullFileInfo &&info);
@@ -106,6 +152,8 @@ class FileStats {
 
   FileTypeStat get_total_nontemp_stat() const;
 
+  StatByType get_total_stat_by_type() const;
+
   vector<FullFileInfo> get_all_files();
 };
 
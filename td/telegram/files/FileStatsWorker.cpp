@@ -16,6 +16,7 @@
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/TdDb.h"
 
+#include "td/db/BlobCompression.h"
 #include "td/db/SqliteKeyValue.h"
 
 #include "td/utils/common.h"
@@ -59,7 +60,8 @@ void scan_db(CancellationToken &token, CallbackT &&callback) {
     if (value.substr(0, 2) == "@@") {
       return true;
     }
-    log_event::WithVersion<TlParser> parser(value);
+    auto value_buffer = decompress_blob(value);
+    log_event::WithVersion<TlParser> parser(value_buffer.as_slice());
     FileData data;
     data.parse(parser, false);
     if (parser.get_status().is_error()) {
@@ -128,7 +130,8 @@ void scan_fs(CancellationToken &token, CallbackT &&callback) {
 
       FsFileInfo info;
       info.path = path.str();
-      info.size = stat.real_size_;
+      // a file in the shared file store is accounted proportionally in all directories, in which it is linked
+      info.size = stat.real_size_ / max(stat.link_count_, static_cast<int64>(1));
       info.file_type = guess_file_type_by_path(path, file_type);
       info.atime_nsec = stat.atime_nsec_;
       info.mtime_nsec = stat.mtime_nsec_;
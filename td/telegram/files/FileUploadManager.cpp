@@ -9,6 +9,7 @@
 #include "td/telegram/Global.h"
 
 #include "td/utils/common.h"
+#include "td/utils/logging.h"
 
 namespace td {
 
@@ -37,7 +38,7 @@ void FileUploadManager::upload(QueryId query_id, const LocalFileLocation &local_
   node->query_id_ = query_id;
   auto callback = make_unique<FileUploaderCallback>(actor_shared(this, node_id));
   node->uploader_ = create_actor<FileUploader>("Uploader", local_location, remote_location, expected_size,
-                                               encryption_key, std::move(bad_parts), std::move(callback));
+                                               encryption_key, std::move(bad_parts), false, std::move(callback));
   send_closure(upload_resource_manager_, &ResourceManager::register_worker,
                ActorShared<FileLoaderActor>(node->uploader_.get(), static_cast<uint64>(-1)), priority);
   bool is_inserted = query_id_to_node_id_.emplace(query_id, node_id).second;
@@ -45,7 +46,7 @@ void FileUploadManager::upload(QueryId query_id, const LocalFileLocation &local_
 }
 
 void FileUploadManager::upload_by_hash(QueryId query_id, const FullLocalFileLocation &local_location, int64 size,
-                                       int8 priority) {
+                                       int64 expected_size, const FileEncryptionKey &encryption_key, int8 priority) {
   if (stop_flag_) {
     return;
   }
@@ -53,10 +54,16 @@ void FileUploadManager::upload_by_hash(QueryId query_id, const FullLocalFileLoca
   Node *node = nodes_container_.get(node_id);
   CHECK(node);
   node->query_id_ = query_id;
-  auto callback = make_unique<FileHashUploaderCallback>(actor_shared(this, node_id));
-  node->hash_uploader_ = create_actor<FileHashUploader>("HashUploader", local_location, size, std::move(callback));
+  // the file is read only once by the uploader, and the hash is calculated on another thread from the read parts
+  auto hash_callback = make_unique<FileHashUploaderCallback>(actor_id(this), node_id);
+  node->hash_uploader_ = create_actor_on_scheduler<FileHashUploader>(
+      "HashUploader", G()->get_gc_scheduler_id(), local_location, size, std::move(hash_callback));
+  auto callback = make_unique<FileUploaderCallback>(actor_shared(this, node_id));
+  node->uploader_ =
+      create_actor<FileUploader>("Uploader", LocalFileLocation(local_location), RemoteFileLocation(), expected_size,
+                                 encryption_key, vector<int>(), true, std::move(callback));
   send_closure(upload_resource_manager_, &ResourceManager::register_worker,
-               ActorShared<FileLoaderActor>(node->hash_uploader_.get(), static_cast<uint64>(-1)), priority);
+               ActorShared<FileLoaderActor>(node->uploader_.get(), static_cast<uint64>(-1)), priority);
   bool is_inserted = query_id_to_node_id_.emplace(query_id, node_id).second;
   CHECK(is_inserted);
 }
@@ -73,11 +80,7 @@ void FileUploadManager::update_priority(QueryId query_id, int8 priority) {
   if (node == nullptr) {
     return;
   }
-  if (!node->uploader_.empty()) {
-    send_closure(node->uploader_, &FileLoaderActor::update_priority, priority);
-  } else {
-    send_closure(node->hash_uploader_, &FileLoaderActor::update_priority, priority);
-  }
+  send_closure(node->uploader_, &FileLoaderActor::update_priority, priority);
 }
 
 void FileUploadManager::cancel(QueryId query_id) {
@@ -126,37 +129,54 @@ void FileUploadManager::on_hash(string hash) {
   }
 }
 
-void FileUploadManager::on_partial_upload(PartialRemoteFileLocation partial_remote, int64 ready_size) {
+void FileUploadManager::on_part_read(int64 offset, BufferSlice bytes) {
   auto node_id = get_link_token();
+  auto node = nodes_container_.get(node_id);
+  if (node == nullptr || node->hash_uploader_.empty()) {
+    return;
+  }
+  send_closure(node->hash_uploader_, &FileHashUploader::on_part_read, offset, std::move(bytes));
+}
+
+void FileUploadManager::on_hash_upload_ok(NodeId node_id, FullRemoteFileLocation remote) {
   auto node = nodes_container_.get(node_id);
   if (node == nullptr) {
     return;
   }
   if (!stop_flag_) {
-    callback_->on_partial_upload(node->query_id_, std::move(partial_remote), ready_size);
+    callback_->on_upload_full_ok(node->query_id_, std::move(remote));
   }
+  close_node(node_id);
 }
 
-void FileUploadManager::on_ok_upload(FileType file_type, PartialRemoteFileLocation remote, int64 size) {
+void FileUploadManager::on_hash_upload_error(NodeId node_id, Status status) {
+  auto node = nodes_container_.get(node_id);
+  if (node == nullptr) {
+    return;
+  }
+  LOG(INFO) << "Failed to find file by hash: " << status << ", continue upload";
+  node->hash_uploader_.reset();
+}
+
+void FileUploadManager::on_partial_upload(PartialRemoteFileLocation partial_remote, int64 ready_size) {
   auto node_id = get_link_token();
   auto node = nodes_container_.get(node_id);
   if (node == nullptr) {
     return;
   }
   if (!stop_flag_) {
-    callback_->on_upload_ok(node->query_id_, file_type, std::move(remote), size);
+    callback_->on_partial_upload(node->query_id_, std::move(partial_remote), ready_size);
   }
-  close_node(node_id);
 }
 
-void FileUploadManager::on_ok_upload_full(FullRemoteFileLocation remote) {
+void FileUploadManager::on_ok_upload(FileType file_type, PartialRemoteFileLocation remote, int64 size) {
   auto node_id = get_link_token();
   auto node = nodes_container_.get(node_id);
   if (node == nullptr) {
     return;
   }
   if (!stop_flag_) {
-    callback_->on_upload_full_ok(node->query_id_, std::move(remote));
+    callback_->on_upload_ok(node->query_id_, file_type, std::move(remote), size);
   }
   close_node(node_id);
 }
@@ -15,6 +15,7 @@
 
 #include "td/actor/actor.h"
 
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/Container.h"
 #include "td/utils/Status.h"
@@ -42,7 +43,9 @@ class FileUploadManager final : public Actor {
   void upload(QueryId query_id, const LocalFileLocation &local_location, const RemoteFileLocation &remote_location,
               int64 expected_size, const FileEncryptionKey &encryption_key, int8 priority, vector<int> bad_parts);
 
-  void upload_by_hash(QueryId query_id, const FullLocalFileLocation &local_location, int64 size, int8 priority);
+  // uploads the file, simultaneously trying to find it by hash, calculated from the uploaded parts
+  void upload_by_hash(QueryId query_id, const FullLocalFileLocation &local_location, int64 size, int64 expected_size,
+                      const FileEncryptionKey &encryption_key, int8 priority);
 
   void update_priority(QueryId query_id, int8 priority);
 
@@ -76,8 +79,10 @@ class FileUploadManager final : public Actor {
 
   void on_partial_upload(PartialRemoteFileLocation partial_remote, int64 ready_size);
   void on_hash(string hash);
+  void on_part_read(int64 offset, BufferSlice bytes);
+  void on_hash_upload_ok(NodeId node_id, FullRemoteFileLocation remote);
+  void on_hash_upload_error(NodeId node_id, Status status);
   void on_ok_upload(FileType file_type, PartialRemoteFileLocation remote, int64 size);
-  void on_ok_upload_full(FullRemoteFileLocation remote);
   void on_error(Status status);
   void on_error_impl(NodeId node_id, Status status);
 
@@ -92,6 +97,9 @@ class FileUploadManager final : public Actor {
     void on_hash(string hash) final {
       send_closure(actor_id_, &FileUploadManager::on_hash, std::move(hash));
     }
+    void on_part_read(int64 offset, BufferSlice bytes) final {
+      send_closure(actor_id_, &FileUploadManager::on_part_read, offset, std::move(bytes));
+    }
     void on_partial_upload(PartialRemoteFileLocation partial_remote, int64 ready_size) final {
       send_closure(actor_id_, &FileUploadManager::on_partial_upload, std::move(partial_remote), ready_size);
     }
@@ -103,19 +111,22 @@ class FileUploadManager final : public Actor {
     }
   };
 
+  // the upload must not be canceled if the hash uploader is destroyed, so ActorShared isn't used
   class FileHashUploaderCallback final : public FileHashUploader::Callback {
    public:
-    explicit FileHashUploaderCallback(ActorShared<FileUploadManager> actor_id) : actor_id_(std::move(actor_id)) {
+    FileHashUploaderCallback(ActorId<FileUploadManager> actor_id, NodeId node_id)
+        : actor_id_(std::move(actor_id)), node_id_(node_id) {
     }
 
    private:
-    ActorShared<FileUploadManager> actor_id_;
+    ActorId<FileUploadManager> actor_id_;
+    NodeId node_id_;
 
     void on_ok(FullRemoteFileLocation remote) final {
-      send_closure(std::move(actor_id_), &FileUploadManager::on_ok_upload_full, std::move(remote));
+      send_closure(actor_id_, &FileUploadManager::on_hash_upload_ok, node_id_, std::move(remote));
     }
     void on_error(Status status) final {
-      send_closure(std::move(actor_id_), &FileUploadManager::on_error, std::move(status));
+      send_closure(actor_id_, &FileUploadManager::on_hash_upload_error, node_id_, std::move(status));
     }
   };
 };
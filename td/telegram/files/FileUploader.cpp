@@ -25,17 +25,37 @@
 
 namespace td {
 
+class FileUploader::PartEncryptor final : public Actor {
+ public:
+  PartEncryptor(const UInt256 &key, const UInt256 &iv, ActorId<FileUploader> parent)
+      : key_(key), iv_(iv), parent_(parent) {
+  }
+
+  // parts following each other are chained through iv_, so they must be sent in order;
+  // other parts are encrypted with an explicitly provided iv
+  void encrypt_part(uint64 unique_id, BufferSlice bytes, bool is_chained, UInt256 iv) {
+    aes_ige_encrypt(as_slice(key_), as_mutable_slice(is_chained ? iv_ : iv), bytes.as_slice(),
+                    bytes.as_mutable_slice());
+    send_closure(parent_, &FileUploader::on_part_encrypted, unique_id, std::move(bytes));
+  }
+
+ private:
+  UInt256 key_;
+  UInt256 iv_;
+  ActorId<FileUploader> parent_;
+};
+
 FileUploader::FileUploader(const LocalFileLocation &local, const RemoteFileLocation &remote, int64 expected_size,
-                           const FileEncryptionKey &encryption_key, std::vector<int> bad_parts,
+                           const FileEncryptionKey &encryption_key, std::vector<int> bad_parts, bool need_read_parts,
                            unique_ptr<Callback> callback)
     : local_(local)
     , remote_(remote)
     , expected_size_(expected_size)
     , encryption_key_(encryption_key)
     , bad_parts_(std::move(bad_parts))
+    , need_read_parts_(need_read_parts && !encryption_key_.is_secure())
     , callback_(std::move(callback)) {
   if (encryption_key_.is_secret()) {
-    iv_ = encryption_key_.mutable_iv();
     generate_iv_ = encryption_key_.iv_slice().str();
   }
   if (remote_.type() == RemoteFileLocation::Type::Partial && encryption_key_.is_secure() &&
@@ -49,6 +69,12 @@ void FileUploader::start_up() {
     return on_error(Status::Error("File is already uploaded"));
   }
 
+  if (encryption_key_.is_secret()) {
+    part_encryptor_ = create_actor_on_scheduler<PartEncryptor>(
+        "FilePartEncryptor", G()->get_gc_scheduler_id(), encryption_key_.key(), encryption_key_.mutable_iv(),
+        actor_id(this));
+  }
+
   // file_size is needed only for partial local locations, but for uploaded partial files
   // size is yet unknown or local location is full, so we can always pass 0 here
   auto r_prefix_info = on_update_local_location(local_, 0);
@@ -247,45 +273,71 @@ Status FileUploader::generate_iv_map() {
   return Status::OK();
 }
 
-Result<NetQueryPtr> FileUploader::start_part(Part part, int32 part_count) {
+Result<BufferSlice> FileUploader::read_part(Part part) {
   auto padded_size = part.size;
   if (encryption_key_.is_secret()) {
     padded_size = (padded_size + 15) & ~15;
   }
   BufferSlice bytes(padded_size);
   TRY_RESULT(size, fd_.pread(bytes.as_mutable_slice().truncate(part.size), part.offset));
+  if (need_read_parts_ && size == part.size && part.offset == read_prefix_size_) {
+    read_prefix_size_ += static_cast<int64>(size);
+    // bytes of encrypted files are encrypted in place, so they must be copied
+    auto read_bytes = encryption_key_.empty() ? bytes.from_slice(bytes.as_slice().substr(0, size))
+                                              : BufferSlice(bytes.as_slice().substr(0, size));
+    callback_->on_part_read(part.offset, std::move(read_bytes));
+  }
+  if (size != part.size) {
+    return Status::Error("Failed to read file part");
+  }
   if (encryption_key_.is_secret()) {
     Random::secure_bytes(bytes.as_mutable_slice().substr(part.size));
-    if (next_offset_ == part.offset) {
-      aes_ige_encrypt(as_slice(encryption_key_.key()), as_mutable_slice(iv_), bytes.as_slice(),
-                      bytes.as_mutable_slice());
-      next_offset_ += static_cast<int64>(bytes.size());
-    } else {
-      if (part.id >= static_cast<int32>(iv_map_.size())) {
-        TRY_STATUS(generate_iv_map());
-      }
-      CHECK(part.id < static_cast<int32>(iv_map_.size()) && part.id >= 0);
-      auto iv = iv_map_[part.id];
-      aes_ige_encrypt(as_slice(encryption_key_.key()), as_mutable_slice(iv), bytes.as_slice(),
-                      bytes.as_mutable_slice());
+  }
+  return std::move(bytes);
+}
+
+Status FileUploader::encrypt_part(uint64 unique_id, Part part, BufferSlice bytes) {
+  CHECK(!part_encryptor_.empty());
+  bool is_chained = next_offset_ == part.offset;
+  UInt256 iv;
+  if (is_chained) {
+    next_offset_ += static_cast<int64>(bytes.size());
+  } else {
+    if (part.id >= static_cast<int32>(iv_map_.size())) {
+      TRY_STATUS(generate_iv_map());
     }
+    CHECK(part.id < static_cast<int32>(iv_map_.size()) && part.id >= 0);
+    iv = iv_map_[part.id];
   }
+  send_closure(part_encryptor_, &PartEncryptor::encrypt_part, unique_id, std::move(bytes), is_chained, iv);
+  return Status::OK();
+}
 
-  if (size != part.size) {
-    return Status::Error("Failed to read file part");
+void FileUploader::on_part_encrypted(uint64 unique_id, BufferSlice bytes) {
+  if (stop_flag_) {
+    return;
   }
+  auto it = part_map_.find(unique_id);
+  if (it == part_map_.end()) {
+    return;
+  }
+  send_part(unique_id, it->second.first, std::move(bytes));
+}
 
+void FileUploader::send_part(uint64 unique_id, Part part, BufferSlice bytes) {
   NetQueryPtr net_query;
   if (big_flag_) {
-    auto query =
-        telegram_api::upload_saveBigFilePart(file_id_, part.id, local_is_ready_ ? part_count : -1, std::move(bytes));
+    auto part_count = local_is_ready_ ? parts_manager_.get_part_count() : -1;
+    auto query = telegram_api::upload_saveBigFilePart(file_id_, part.id, part_count, std::move(bytes));
     net_query = G()->net_query_creator().create(query, {}, DcId::main(), NetQuery::Type::Upload);
   } else {
     auto query = telegram_api::upload_saveFilePart(file_id_, part.id, std::move(bytes));
     net_query = G()->net_query_creator().create(query, {}, DcId::main(), NetQuery::Type::Upload);
   }
   net_query->file_type_ = narrow_cast<int32>(file_type_);
-  return std::move(net_query);
+  part_map_[unique_id] = std::make_pair(part, net_query->cancel_slot_.get_signal_new());
+
+  G()->net_query_dispatcher().dispatch_with_callback(std::move(net_query), actor_shared(this, unique_id));
 }
 
 Result<size_t> FileUploader::process_part(Part part, NetQueryPtr net_query) {
@@ -408,11 +460,15 @@ Status FileUploader::do_loop() {
     VLOG(file_loader) << "Start part " << tag("id", part.id) << tag("size", part.size);
     resource_state_.start_use(static_cast<int64>(part.size));
 
-    TRY_RESULT(query, start_part(part, parts_manager_.get_part_count()));
+    TRY_RESULT(bytes, read_part(part));
     uint64 unique_id = UniqueId::next();
-    part_map_[unique_id] = std::make_pair(part, query->cancel_slot_.get_signal_new());
-
-    G()->net_query_dispatcher().dispatch_with_callback(std::move(query), actor_shared(this, unique_id));
+    if (encryption_key_.is_secret()) {
+      // the query is created after the part is encrypted
+      part_map_[unique_id] = std::make_pair(part, ActorShared<>());
+      TRY_STATUS(encrypt_part(unique_id, part, std::move(bytes)));
+    } else {
+      send_part(unique_id, part, std::move(bytes));
+    }
   }
   return Status::OK();
 }
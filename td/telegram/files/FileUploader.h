@@ -17,6 +17,7 @@
 
 #include "td/actor/actor.h"
 
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/port/FileFd.h"
 #include "td/utils/Status.h"
@@ -35,6 +36,8 @@ class FileUploader final : public FileLoaderActor {
     Callback(const Callback &) = delete;
     Callback &operator=(const Callback &) = delete;
     virtual void on_hash(string hash) = 0;
+    // a not encrypted prefix of the file has been read; called only if need_read_parts is true
+    virtual void on_part_read(int64 offset, BufferSlice bytes) = 0;
     virtual void on_partial_upload(PartialRemoteFileLocation partial_remote, int64 ready_size) = 0;
     virtual void on_ok(FileType file_type, PartialRemoteFileLocation partial_remote, int64 size) = 0;
     virtual void on_error(Status status) = 0;
@@ -42,7 +45,8 @@ class FileUploader final : public FileLoaderActor {
   };
 
   FileUploader(const LocalFileLocation &local, const RemoteFileLocation &remote, int64 expected_size,
-               const FileEncryptionKey &encryption_key, std::vector<int> bad_parts, unique_ptr<Callback> callback);
+               const FileEncryptionKey &encryption_key, std::vector<int> bad_parts, bool need_read_parts,
+               unique_ptr<Callback> callback);
 
   void update_local_file_location(const LocalFileLocation &local);
 
@@ -52,13 +56,18 @@ class FileUploader final : public FileLoaderActor {
   int64 expected_size_;
   FileEncryptionKey encryption_key_;
   vector<int> bad_parts_;
+  bool need_read_parts_ = false;
+  int64 read_prefix_size_ = 0;
   unique_ptr<Callback> callback_;
   int64 local_size_ = 0;
   bool local_is_ready_ = false;
   FileType file_type_ = FileType::Temp;
 
+  // encrypts parts of secret files outside of the uploader's scheduler
+  class PartEncryptor;
+  ActorOwn<PartEncryptor> part_encryptor_;
+
   vector<UInt256> iv_map_;
-  UInt256 iv_;
   string generate_iv_;
   int64 generate_offset_ = 0;
   int64 next_offset_ = 0;
@@ -84,7 +93,13 @@ class FileUploader final : public FileLoaderActor {
 
   void on_error(Status status);
 
-  Result<NetQueryPtr> start_part(Part part, int32 part_count) TD_WARN_UNUSED_RESULT;
+  Result<BufferSlice> read_part(Part part) TD_WARN_UNUSED_RESULT;
+
+  Status encrypt_part(uint64 unique_id, Part part, BufferSlice bytes) TD_WARN_UNUSED_RESULT;
+
+  void on_part_encrypted(uint64 unique_id, BufferSlice bytes);
+
+  void send_part(uint64 unique_id, Part part, BufferSlice bytes);
 
   Result<size_t> process_part(Part part, NetQueryPtr net_query) TD_WARN_UNUSED_RESULT;
 
@@ -91,7 +91,7 @@ Status PartsManager::init_no_size(size_t part_size, const std::vector<int> &read
   if (part_size != 0) {
     part_size_ = part_size;
   } else {
-    part_size_ = 32 << 10;
+    part_size_ = max(static_cast<size_t>(32 << 10), preferred_part_size_);
     while (part_size_ < MAX_PART_SIZE && calc_part_count(expected_size_, part_size_) > MAX_PART_COUNT) {
       part_size_ *= 2;
     }
@@ -106,6 +106,17 @@ Status PartsManager::init_no_size(size_t part_size, const std::vector<int> &read
   return init_common(ready_parts);
 }
 
+void PartsManager::set_preferred_part_size(size_t part_size) {
+  preferred_part_size_ = 0;
+  if (part_size == 0) {
+    return;
+  }
+  preferred_part_size_ = 1;
+  while (preferred_part_size_ < part_size && preferred_part_size_ < MAX_PART_SIZE) {
+    preferred_part_size_ *= 2;
+  }
+}
+
 Status PartsManager::init(int64 size, int64 expected_size, bool is_size_final, size_t part_size,
                           const std::vector<int> &ready_parts, bool use_part_count_limit, bool is_upload) {
   CHECK(expected_size >= size);
@@ -133,7 +144,7 @@ Status PartsManager::init(int64 size, int64 expected_size, bool is_size_final, s
       return Status::Error("FILE_UPLOAD_RESTART");
     }
   } else {
-    part_size_ = 64 << 10;
+    part_size_ = max(static_cast<size_t>(64 << 10), preferred_part_size_);
     while (part_size_ < MAX_PART_SIZE && calc_part_count(expected_size_, part_size_) > MAX_PART_COUNT) {
       part_size_ *= 2;
     }
@@ -24,6 +24,8 @@ class PartsManager {
  public:
   Status init(int64 size, int64 expected_size, bool is_size_final, size_t part_size,
               const std::vector<int> &ready_parts, bool use_part_count_limit, bool is_upload) TD_WARN_UNUSED_RESULT;
+  // must be called before init; the part size is used only if init is called without explicit part size
+  void set_preferred_part_size(size_t part_size);
   bool may_finish();
   bool ready();
   bool unchecked_ready();
@@ -78,6 +80,7 @@ class PartsManager {
   int64 streaming_ready_size_{0};
 
   size_t part_size_{0};
+  size_t preferred_part_size_{0};
   int part_count_{0};
   int pending_count_{0};
   int first_empty_part_{0};
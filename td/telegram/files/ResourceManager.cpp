@@ -6,6 +6,7 @@
 //
 #include "td/telegram/files/ResourceManager.h"
 
+#include "td/telegram/files/FileBandwidthBudget.h"
 #include "td/telegram/files/FileLoaderUtils.h"
 
 #include "td/utils/common.h"
@@ -18,6 +19,14 @@
 
 namespace td {
 
+void ResourceManager::start_up() {
+  bandwidth_consumer_id_ = FileBandwidthBudget::register_consumer(get_name());
+}
+
+void ResourceManager::tear_down() {
+  FileBandwidthBudget::unregister_consumer(bandwidth_consumer_id_);
+}
+
 void ResourceManager::register_worker(ActorShared<FileLoaderActor> callback, int8 priority) {
   auto node_id = nodes_container_.create();
   auto *node_ptr = nodes_container_.get(node_id);
@@ -82,6 +91,15 @@ void ResourceManager::hangup_shared() {
   loop();
 }
 
+void ResourceManager::timeout_expired() {
+  loop();
+}
+
+int32 ResourceManager::get_bandwidth_weight() const {
+  // workers with a higher priority are first in to_xload_
+  return to_xload_.empty() ? 1 : max(static_cast<int32>(to_xload_[0].first), 1);
+}
+
 void ResourceManager::add_to_heap(Node *node) {
   auto *heap_node = node->as_heap_node();
   auto key = node->resource_state_.estimated_extra();
@@ -114,8 +132,15 @@ bool ResourceManager::satisfy_node(NodeId file_node_id) {
   auto give = resource_state_.unused();
   give = min(need, give);
   give -= give % part_size;
+  if (give == 0) {
+    VLOG(file_loader) << tag("give", give);
+    return false;
+  }
+  give = FileBandwidthBudget::acquire(bandwidth_consumer_id_, get_bandwidth_weight(), give, part_size);
   VLOG(file_loader) << tag("give", give);
   if (give == 0) {
+    // the process-wide bandwidth limit is exceeded
+    set_timeout_in(FileBandwidthBudget::get_wait_time(bandwidth_consumer_id_, part_size));
     return false;
   }
   resource_state_.start_use(give);
@@ -157,6 +182,13 @@ void ResourceManager::loop() {
         break;
       }
     }
+  } else if (mode_ == Mode::Independent) {
+    for (auto &it : to_xload_) {
+      if (resource_state_.unused() <= 0) {
+        break;
+      }
+      satisfy_node(it.second);
+    }
   }
 }
 
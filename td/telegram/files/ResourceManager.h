@@ -21,7 +21,9 @@ namespace td {
 
 class ResourceManager final : public Actor {
  public:
-  enum class Mode : int32 { Baseline, Greedy };
+  // in Independent mode workers are satisfied in the order of their priority as in Baseline mode, but a worker,
+  // which can't be satisfied, doesn't block workers with lower priority
+  enum class Mode : int32 { Baseline, Greedy, Independent };
   ResourceManager(int64 max_resource_limit, Mode mode) : max_resource_limit_(max_resource_limit), mode_(mode) {
   }
   // use through ActorShared
@@ -57,10 +59,20 @@ class ResourceManager final : public Actor {
   ActorShared<> parent_;
   bool stop_flag_ = false;
 
+  uint64 bandwidth_consumer_id_ = 0;
+
+  void start_up() final;
+
+  void tear_down() final;
+
   void hangup_shared() final;
 
+  void timeout_expired() final;
+
   void loop() final;
 
+  int32 get_bandwidth_weight() const;
+
   void add_to_heap(Node *node);
   bool satisfy_node(NodeId file_node_id);
   void add_node(NodeId node_id, int8 priority);
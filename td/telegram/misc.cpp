@@ -7,15 +7,19 @@
 #include "td/telegram/misc.h"
 
 #include "td/utils/algorithm.h"
+#include "td/utils/as.h"
 #include "td/utils/common.h"
 #include "td/utils/crypto.h"
+#include "td/utils/HashTableUtils.h"
 #include "td/utils/Hints.h"
 #include "td/utils/misc.h"
 #include "td/utils/Slice.h"
 #include "td/utils/utf8.h"
 
+#include <algorithm>
 #include <cstring>
 #include <limits>
+#include <mutex>
 
 namespace td {
 
@@ -57,10 +61,29 @@ void clean_phone_number(string &phone_number) {
   td::remove_if(phone_number, [](char c) { return !is_digit(c); });
 }
 
+static constexpr size_t ASCII_BLOCK_SIZE = sizeof(uint64);
+
+static bool is_ascii_block(const char *ptr) {
+  return (as<uint64>(ptr) & 0x8080808080808080ULL) == 0;
+}
+
+// checks whether the block consists of characters from ' ' to '\x7f', which are never changed by clean_input_string
+static bool is_printable_ascii_block(const char *ptr) {
+  uint64 block = as<uint64>(ptr);
+  // a byte less than ' ' causes a borrow to its high bit
+  return ((block | (block - 0x2020202020202020ULL)) & 0x8080808080808080ULL) == 0;
+}
+
 void replace_offending_characters(string &str) {
   // "(\xe2\x80\x8f|\xe2\x80\x8e){N}(\xe2\x80\x8f|\xe2\x80\x8e)" -> "(\xe2\x80\x8c){N}$2"
   auto s = MutableSlice(str).ubegin();
   for (size_t pos = 0; pos < str.size(); pos++) {
+    while (pos + ASCII_BLOCK_SIZE <= str.size() && is_ascii_block(str.data() + pos)) {
+      pos += ASCII_BLOCK_SIZE;
+    }
+    if (pos == str.size()) {
+      break;
+    }
     if (s[pos] == 0xe2 && s[pos + 1] == 0x80 && (s[pos + 2] == 0x8e || s[pos + 2] == 0x8f)) {
       while (s[pos + 3] == 0xe2 && s[pos + 4] == 0x80 && (s[pos + 5] == 0x8e || s[pos + 5] == 0x8f)) {
         s[pos + 2] = static_cast<unsigned char>(0x8c);
@@ -80,6 +103,19 @@ bool clean_input_string(string &str) {
   size_t str_size = str.size();
   size_t new_size = 0;
   for (size_t pos = 0; pos < str_size; pos++) {
+    // fast path for blocks without characters to change, which can't reach the length limit
+    while (pos + ASCII_BLOCK_SIZE <= str_size && new_size + ASCII_BLOCK_SIZE < LENGTH_LIMIT - 3 &&
+           is_printable_ascii_block(str.data() + pos)) {
+      if (new_size != pos) {
+        std::memmove(&str[new_size], &str[pos], ASCII_BLOCK_SIZE);
+      }
+      pos += ASCII_BLOCK_SIZE;
+      new_size += ASCII_BLOCK_SIZE;
+    }
+    if (pos == str_size) {
+      break;
+    }
+
     auto c = static_cast<unsigned char>(str[pos]);
     switch (c) {
       // remove control characters
@@ -390,15 +426,59 @@ Status validate_bot_language_code(const string &language_code) {
   return Status::Error(400, "Invalid language code specified");
 }
 
+namespace {
+
+struct StringPrefixIndex {
+  uint32 hash = 0;
+  vector<string> strings;
+  Hints hints;
+};
+
+// indexes of the last searched lists of strings, because the same list is usually searched repeatedly during typing
+struct StringPrefixIndexCache {
+  std::mutex mutex;
+  vector<unique_ptr<StringPrefixIndex>> indexes;  // the most recently used index is the last
+};
+
+StringPrefixIndexCache &get_string_prefix_index_cache() {
+  static StringPrefixIndexCache cache;
+  return cache;
+}
+
+constexpr size_t MAX_CACHED_STRING_PREFIX_INDEXES = 8;
+
+}  // namespace
+
 vector<int32> search_strings_by_prefix(const vector<string> &strings, const string &query, int32 limit,
                                        bool return_all_for_empty_query, int32 &total_count) {
-  Hints hints;
-  for (size_t i = 0; i < strings.size(); i++) {
-    const auto &str = strings[i];
-    hints.add(i, str.empty() ? Slice(" ") : Slice(str));
-    hints.set_rating(i, i);
+  uint32 hash = 0;
+  for (const auto &str : strings) {
+    hash = combine_hashes(hash, Hash<string>()(str));
+  }
+
+  auto &cache = get_string_prefix_index_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto &indexes = cache.indexes;
+  auto it = std::find_if(indexes.begin(), indexes.end(), [hash, &strings](const unique_ptr<StringPrefixIndex> &index) {
+    return index->hash == hash && index->strings == strings;
+  });
+  if (it != indexes.end()) {
+    std::rotate(it, it + 1, indexes.end());
+  } else {
+    auto index = make_unique<StringPrefixIndex>();
+    index->hash = hash;
+    index->strings = strings;
+    for (size_t i = 0; i < strings.size(); i++) {
+      const auto &str = strings[i];
+      index->hints.add(i, str.empty() ? Slice(" ") : Slice(str));
+      index->hints.set_rating(i, i);
+    }
+    if (indexes.size() == MAX_CACHED_STRING_PREFIX_INDEXES) {
+      indexes.erase(indexes.begin());
+    }
+    indexes.push_back(std::move(index));
   }
-  auto result = hints.search(query, limit, return_all_for_empty_query);
+  auto result = indexes.back()->hints.search(query, limit, return_all_for_empty_query);
   total_count = narrow_cast<int32>(result.first);
   return transform(result.second, [](int64 key) { return narrow_cast<int32>(key); });
 }
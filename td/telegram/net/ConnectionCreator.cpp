@@ -257,6 +257,8 @@ ActorId<GetHostByNameActor> ConnectionCreator::get_dns_resolver() {
       options.resolver_types = {GetHostByNameActor::ResolverType::Google, GetHostByNameActor::ResolverType::Native};
       options.ok_timeout = 60;
       options.error_timeout = 0;
+      options.use_shared_cache = true;
+      options.refresh_before_expiration = true;
       block_get_host_by_name_actor_ = create_actor<GetHostByNameActor>("BlockDnsResolverActor", std::move(options));
     }
     return block_get_host_by_name_actor_.get();
@@ -267,6 +269,8 @@ ActorId<GetHostByNameActor> ConnectionCreator::get_dns_resolver() {
       options.scheduler_id = G()->get_gc_scheduler_id();
       options.ok_timeout = 5 * 60 - 1;
       options.error_timeout = 0;
+      options.use_shared_cache = true;
+      options.refresh_before_expiration = true;
       get_host_by_name_actor_ = create_actor<GetHostByNameActor>("DnsResolverActor", std::move(options));
     }
     return get_host_by_name_actor_.get();
@@ -277,7 +281,7 @@ void ConnectionCreator::ping_proxy(int32 proxy_id, Promise<double> promise) {
   CHECK(!close_flag_);
   if (proxy_id == 0) {
     auto main_dc_id = G()->net_query_dispatcher().get_main_dc_id();
-    bool prefer_ipv6 = G()->get_option_boolean("prefer_ipv6");
+    bool prefer_ipv6 = G()->get_option_boolean(CachedOption::PreferIpv6);
     auto infos = dc_options_set_.find_all_connections(main_dc_id, false, false, prefer_ipv6, false);
     if (infos.empty()) {
       return promise.set_error(Status::Error(400, "Can't find valid DC address"));
@@ -324,7 +328,7 @@ void ConnectionCreator::ping_proxy(int32 proxy_id, Promise<double> promise) {
     return promise.set_error(Status::Error(400, "Unknown proxy identifier"));
   }
   const Proxy &proxy = it->second;
-  bool prefer_ipv6 = G()->get_option_boolean("prefer_ipv6");
+  bool prefer_ipv6 = G()->get_option_boolean(CachedOption::PreferIpv6);
   send_closure(get_dns_resolver(), &GetHostByNameActor::run, proxy.server().str(), proxy.port(), prefer_ipv6,
                PromiseCreator::lambda([actor_id = actor_id(this), promise = std::move(promise),
                                        proxy_id](Result<IPAddress> result) mutable {
@@ -747,6 +751,7 @@ void ConnectionCreator::request_raw_connection(DcId dc_id, bool allow_media_only
   VLOG(connections) << "Request connection for " << tag("client", format::as_hex(client.hash)) << " to " << dc_id << " "
                     << tag("allow_media_only", allow_media_only);
   client.queries.push_back(std::move(promise));
+  client.last_query_time = Time::now();
 
   client_loop(client);
 }
@@ -813,7 +818,8 @@ Result<mtproto::TransportType> ConnectionCreator::get_transport_type(const Proxy
 Result<SocketFd> ConnectionCreator::find_connection(const Proxy &proxy, const IPAddress &proxy_ip_address, DcId dc_id,
                                                     bool allow_media_only, FindConnectionExtra &extra) {
   extra.debug_str = PSTRING() << "Failed to find valid IP address for " << dc_id;
-  bool prefer_ipv6 = G()->get_option_boolean("prefer_ipv6") || (proxy.use_proxy() && proxy_ip_address.is_ipv6());
+  bool prefer_ipv6 =
+      G()->get_option_boolean(CachedOption::PreferIpv6) || (proxy.use_proxy() && proxy_ip_address.is_ipv6());
   bool only_http = proxy.use_http_caching_proxy();
 #if TD_DARWIN_WATCH_OS
   only_http = true;
@@ -980,9 +986,11 @@ void ConnectionCreator::client_loop(ClientInfo &client) {
 
   // Main loop. Create new connections till needed
   bool check_mode = client.checking_connections != 0 && !proxy.use_proxy();
+  auto spare_count = get_spare_connection_count(client, proxy);
   while (true) {
     // Check if we need new connections
-    if (client.queries.empty()) {
+    auto connection_count = client.pending_connections + client.ready_connections.size();
+    if (client.queries.empty() && (check_mode || connection_count >= spare_count)) {
       if (!client.ready_connections.empty()) {
         client_set_timeout_at(client, Time::now() + ClientInfo::READY_CONNECTIONS_TIMEOUT);
       }
@@ -993,7 +1001,7 @@ void ConnectionCreator::client_loop(ClientInfo &client) {
         return;
       }
     } else {
-      if (client.pending_connections >= client.queries.size()) {
+      if (connection_count >= client.queries.size() + spare_count) {
         return;
       }
     }
@@ -1052,10 +1060,11 @@ void ConnectionCreator::client_loop(ClientInfo &client) {
 
     auto promise = PromiseCreator::lambda(
         [actor_id = actor_id(this), check_mode, transport_type = extra.transport_type, hash = client.hash,
-         debug_str = extra.debug_str,
-         network_generation = network_generation_](Result<ConnectionData> r_connection_data) mutable {
+         debug_str = extra.debug_str, network_generation = network_generation_,
+         option_stat = extra.stat](Result<ConnectionData> r_connection_data) mutable {
           send_closure(actor_id, &ConnectionCreator::client_create_raw_connection, std::move(r_connection_data),
-                       check_mode, std::move(transport_type), hash, std::move(debug_str), network_generation);
+                       check_mode, std::move(transport_type), hash, std::move(debug_str), network_generation,
+                       option_stat);
         });
 
     auto stats_callback =
@@ -1071,9 +1080,22 @@ void ConnectionCreator::client_loop(ClientInfo &client) {
   }
 }
 
+size_t ConnectionCreator::get_spare_connection_count(const ClientInfo &client, const Proxy &proxy) const {
+  // tunnels through SOCKS5 and HTTP proxies take additional round trips to the proxy to be established,
+  // so a connection is prepared in advance to replace quickly a closed connection
+  if (!proxy.use_socks5_proxy() && !proxy.use_http_tcp_proxy()) {
+    return 0;
+  }
+  if (!online_flag_ || client.last_query_time + ClientInfo::SPARE_PROXY_CONNECTIONS_TIME <= Time::now()) {
+    return 0;
+  }
+  return ClientInfo::SPARE_PROXY_CONNECTIONS;
+}
+
 void ConnectionCreator::client_create_raw_connection(Result<ConnectionData> r_connection_data, bool check_mode,
                                                      mtproto::TransportType transport_type, uint32 hash,
-                                                     string debug_str, uint32 network_generation) {
+                                                     string debug_str, uint32 network_generation,
+                                                     DcOptionsSet::Stat *option_stat) {
   unique_ptr<mtproto::AuthData> auth_data;
   uint64 auth_data_generation{0};
   uint64 session_id{0};
@@ -1089,7 +1111,8 @@ void ConnectionCreator::client_create_raw_connection(Result<ConnectionData> r_co
     }
   }
   auto promise = PromiseCreator::lambda([actor_id = actor_id(this), hash, check_mode, auth_data_generation, session_id,
-                                         debug_str](Result<unique_ptr<mtproto::RawConnection>> result) mutable {
+                                         debug_str,
+                                         option_stat](Result<unique_ptr<mtproto::RawConnection>> result) mutable {
     if (result.is_ok()) {
       VLOG(connections) << "Ready connection (" << (check_mode ? "" : "un") << "checked) " << result.ok().get() << ' '
                         << tag("rtt", format::as_time(result.ok()->extra().rtt)) << ' ' << debug_str;
@@ -1098,7 +1121,7 @@ void ConnectionCreator::client_create_raw_connection(Result<ConnectionData> r_co
                         << debug_str;
     }
     send_closure(actor_id, &ConnectionCreator::client_add_connection, hash, std::move(result), check_mode,
-                 auth_data_generation, session_id);
+                 auth_data_generation, session_id, option_stat);
   });
 
   if (r_connection_data.is_error()) {
@@ -1134,7 +1157,8 @@ void ConnectionCreator::client_set_timeout_at(ClientInfo &client, double wakeup_
 }
 
 void ConnectionCreator::client_add_connection(uint32 hash, Result<unique_ptr<mtproto::RawConnection>> r_raw_connection,
-                                              bool check_flag, uint64 auth_data_generation, uint64 session_id) {
+                                              bool check_flag, uint64 auth_data_generation, uint64 session_id,
+                                              DcOptionsSet::Stat *option_stat) {
   auto &client = clients_[hash];
   client.add_session_id(session_id);
   CHECK(client.pending_connections > 0);
@@ -1147,6 +1171,9 @@ void ConnectionCreator::client_add_connection(uint32 hash, Result<unique_ptr<mtp
     VLOG(connections) << "Add ready connection " << r_raw_connection.ok().get() << " for "
                       << tag("client", format::as_hex(hash));
     client.backoff.clear();
+    if (check_flag && option_stat != nullptr && active_proxy_id_ == 0) {
+      on_option_rtt(option_stat, r_raw_connection.ok()->extra().rtt);
+    }
     client.ready_connections.emplace_back(r_raw_connection.move_as_ok(), Time::now_cached());
   } else {
     if (r_raw_connection.error().code() == -404 && client.auth_data &&
@@ -1179,6 +1206,18 @@ void ConnectionCreator::add_dc_options(DcOptions &&new_dc_options) {
 #endif
 }
 
+void ConnectionCreator::on_option_rtt(DcOptionsSet::Stat *option_stat, double rtt) {
+  option_stat->on_rtt(rtt);
+
+  // RTTs are saved at most once per minute
+  auto now = Time::now();
+  if (now < next_rtt_save_time_) {
+    return;
+  }
+  next_rtt_save_time_ = now + 60;
+  G()->td_db()->get_binlog_pmc()->set("dc_options_rtt", dc_options_set_.get_serialized_rtts());
+}
+
 void ConnectionCreator::on_dc_update(DcId dc_id, string ip_port, Promise<> promise) {
   if (!dc_id.is_exact()) {
     return promise.set_error(Status::Error("Invalid dc_id"));
@@ -1225,6 +1264,8 @@ void ConnectionCreator::start_up() {
   };
   send_closure(G()->state_manager(), &StateManager::add_callback, make_unique<StateCallback>(actor_id(this)));
 
+  dc_options_set_.add_serialized_rtts(G()->td_db()->get_binlog_pmc()->get("dc_options_rtt"));
+
   auto serialized_dc_options = G()->td_db()->get_binlog_pmc()->get("dc_options");
   DcOptions dc_options;
   auto status = unserialize(dc_options, serialized_dc_options);
@@ -1411,7 +1452,7 @@ void ConnectionCreator::loop() {
       if (resolve_proxy_query_token_ == 0) {
         resolve_proxy_query_token_ = next_token();
         const Proxy &proxy = proxies_[active_proxy_id_];
-        bool prefer_ipv6 = G()->get_option_boolean("prefer_ipv6");
+        bool prefer_ipv6 = G()->get_option_boolean(CachedOption::PreferIpv6);
         VLOG(connections) << "Resolve IP address " << resolve_proxy_query_token_ << " of " << proxy.server();
         send_closure(
             get_dns_resolver(), &GetHostByNameActor::run, proxy.server().str(), proxy.port(), prefer_ipv6,
@@ -144,6 +144,12 @@ class ConnectionCreator final : public NetQueryCallback {
 
     static constexpr double READY_CONNECTIONS_TIMEOUT = 10;
 
+    // number of connections through SOCKS5 and HTTP proxies, which are established in advance,
+    // and for how long after the last connection request they are kept
+    static constexpr size_t SPARE_PROXY_CONNECTIONS = 1;
+    static constexpr double SPARE_PROXY_CONNECTIONS_TIME = 60;
+    double last_query_time{0.0};
+
     bool inited{false};
     uint32 hash{0};
     DcId dc_id;
@@ -162,6 +168,7 @@ class ConnectionCreator final : public NetQueryCallback {
   int ref_cnt_{0};
   bool close_flag_{false};
   uint64 current_token_ = 0;
+  double next_rtt_save_time_ = 0.0;
   std::map<uint64, std::pair<bool, ActorShared<>>> children_;
 
   struct PingMainDcRequest {
@@ -213,6 +220,7 @@ class ConnectionCreator final : public NetQueryCallback {
 
   void init_proxies();
   void add_dc_options(DcOptions &&new_dc_options);
+  void on_option_rtt(DcOptionsSet::Stat *option_stat, double rtt);
   Result<SocketFd> do_request_connection(DcId dc_id, bool allow_media_only);
   Result<std::pair<unique_ptr<mtproto::RawConnection>, bool>> do_request_raw_connection(DcId dc_id,
                                                                                         bool allow_media_only,
@@ -226,11 +234,12 @@ class ConnectionCreator final : public NetQueryCallback {
 
   void client_wakeup(uint32 hash);
   void client_loop(ClientInfo &client);
+  size_t get_spare_connection_count(const ClientInfo &client, const Proxy &proxy) const;
   void client_create_raw_connection(Result<ConnectionData> r_connection_data, bool check_mode,
                                     mtproto::TransportType transport_type, uint32 hash, string debug_str,
-                                    uint32 network_generation);
+                                    uint32 network_generation, DcOptionsSet::Stat *option_stat);
   void client_add_connection(uint32 hash, Result<unique_ptr<mtproto::RawConnection>> r_raw_connection, bool check_flag,
-                             uint64 auth_data_generation, uint64 session_id);
+                             uint64 auth_data_generation, uint64 session_id, DcOptionsSet::Stat *option_stat);
   void client_set_timeout_at(ClientInfo &client, double wakeup_at);
 
   void on_proxy_resolved(Result<IPAddress> ip_address, bool dummy);
@@ -160,6 +160,13 @@ Result<DcOptionsSet::ConnectionInfo> DcOptionsSet::find_connection(DcId dc_id, b
       return a_state < b_state;
     }
     if (a_state == Stat::State::Ok) {
+      // options with known RTT have already been checked to be reachable, so they are preferred
+      if ((a.rtt != 0.0) != (b.rtt != 0.0)) {
+        return a.rtt != 0.0;
+      }
+      if (a.rtt != 0.0 && a.rtt != b.rtt) {
+        return a.rtt < b.rtt;
+      }
       if (a_option.order == b_option.order) {
         return a_option.use_http < b_option.use_http;
       }
@@ -169,7 +176,10 @@ Result<DcOptionsSet::ConnectionInfo> DcOptionsSet::find_connection(DcId dc_id, b
     }
     return a_option.order < b_option.order;
   });
-  result.should_check = !result.stat->is_ok() || result.use_http || last_error_at > Time::now_cached() - 10;
+  // options, which were never connected to successfully, are checked, so the next best options are checked
+  // at the same time and the first reachable of them is used
+  result.should_check = !result.stat->is_ok() || !result.stat->was_ok() || result.use_http ||
+                        last_error_at > Time::now_cached() - 10;
   return result;
 }
 
@@ -194,10 +204,47 @@ void DcOptionsSet::init_option_stat(DcOptionInfo *option_info) {
       return;
     }
   }
-  option_stats_.emplace_back(ip_address, make_unique<OptionStat>());
+  auto option_stat = make_unique<OptionStat>();
+  auto it = saved_rtts_.find(get_rtt_key(ip_address));
+  if (it != saved_rtts_.end()) {
+    option_stat->tcp_stat.rtt = it->second.first;
+    option_stat->http_stat.rtt = it->second.second;
+    saved_rtts_.erase(it);
+  }
+  option_stats_.emplace_back(ip_address, std::move(option_stat));
   option_info->stat_id = option_stats_.size() - 1;
 }
 
+string DcOptionsSet::get_rtt_key(const IPAddress &ip_address) {
+  return PSTRING() << ip_address;
+}
+
+string DcOptionsSet::get_serialized_rtts() const {
+  vector<SavedRtt> rtts;
+  for (auto &option_stat : option_stats_) {
+    const auto &stat = *option_stat.second;
+    if (stat.tcp_stat.rtt != 0.0 || stat.http_stat.rtt != 0.0) {
+      rtts.push_back({get_rtt_key(option_stat.first), stat.tcp_stat.rtt, stat.http_stat.rtt});
+    }
+  }
+  return serialize(rtts);
+}
+
+void DcOptionsSet::add_serialized_rtts(Slice serialized_rtts) {
+  if (serialized_rtts.empty()) {
+    return;
+  }
+  vector<SavedRtt> rtts;
+  auto status = unserialize(rtts, serialized_rtts);
+  if (status.is_error()) {
+    LOG(ERROR) << "Failed to parse saved RTTs: " << status;
+    return;
+  }
+  for (auto &rtt : rtts) {
+    saved_rtts_[rtt.ip_address] = {rtt.tcp_rtt, rtt.http_rtt};
+  }
+}
+
 DcOptionsSet::OptionStat *DcOptionsSet::get_option_stat(const DcOptionInfo *option_info) {
   CHECK(option_info->stat_id < option_stats_.size());
   return option_stats_[option_info->stat_id].second.get();
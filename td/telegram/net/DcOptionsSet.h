@@ -10,9 +10,12 @@
 #include "td/telegram/net/DcOptions.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/port/IPAddress.h"
+#include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 #include "td/utils/Time.h"
+#include "td/utils/tl_helpers.h"
 
 #include <utility>
 
@@ -28,6 +31,7 @@ class DcOptionsSet {
     double ok_at{-1000};
     double error_at{-1001};
     double check_at{-1002};
+    double rtt{0.0};  // smoothed round-trip time of successful connection checks; 0 if unknown
     enum class State : int32 { Ok, Error, Checking };
 
     void on_ok() {
@@ -39,6 +43,15 @@ class DcOptionsSet {
     void on_check() {
       check_at = Time::now_cached();
     }
+    void on_rtt(double new_rtt) {
+      if (new_rtt <= 0) {
+        return;
+      }
+      rtt = rtt == 0.0 ? new_rtt : 0.75 * rtt + 0.25 * new_rtt;
+    }
+    bool was_ok() const {
+      return ok_at >= 0;
+    }
     bool is_ok() const {
       return state() == State::Ok;
     }
@@ -68,6 +81,12 @@ class DcOptionsSet {
                                          bool only_http);
   void reset();
 
+  // returns known RTTs of all options to be saved between restarts
+  string get_serialized_rtts() const;
+
+  // restores RTTs saved by get_serialized_rtts for options, which will be added later
+  void add_serialized_rtts(Slice serialized_rtts);
+
  private:
   enum class State : int32 { Error, Ok, Checking };
 
@@ -76,6 +95,26 @@ class DcOptionsSet {
     Stat http_stat;
   };
 
+  struct SavedRtt {
+    string ip_address;
+    double tcp_rtt = 0.0;
+    double http_rtt = 0.0;
+
+    template <class StorerT>
+    void store(StorerT &storer) const {
+      td::store(ip_address, storer);
+      td::store(tcp_rtt, storer);
+      td::store(http_rtt, storer);
+    }
+
+    template <class ParserT>
+    void parse(ParserT &parser) {
+      td::parse(ip_address, parser);
+      td::parse(tcp_rtt, parser);
+      td::parse(http_rtt, parser);
+    }
+  };
+
   struct DcOptionInfo {
     DcOption option;
     size_t stat_id = static_cast<size_t>(-1);
@@ -106,6 +145,9 @@ class DcOptionsSet {
   vector<unique_ptr<DcOptionInfo>> options_;
   vector<DcOptionId> ordered_options_;
   vector<std::pair<IPAddress, unique_ptr<OptionStat>>> option_stats_;
+  FlatHashMap<string, std::pair<double, double>> saved_rtts_;
+
+  static string get_rtt_key(const IPAddress &ip_address);
 
   DcOptionInfo *register_dc_option(DcOption &&option);
   void init_option_stat(DcOptionInfo *option_info);
@@ -8,6 +8,7 @@
 
 #include "td/telegram/ChainId.h"
 #include "td/telegram/Global.h"
+#include "td/telegram/net/NetQueryLatencyStats.h"
 #include "td/telegram/telegram_api.h"
 
 #include "td/utils/algorithm.h"
@@ -20,11 +21,17 @@
 
 namespace td {
 
+constexpr size_t NetQuery::PRIORITY_COUNT;
+constexpr size_t NetQuery::STAGE_COUNT;
+constexpr int32 NetQuery::MAX_LOG_SAMPLE_RATE;
+
 int VERBOSITY_NAME(net_query) = VERBOSITY_NAME(INFO);
 
+std::atomic<int32> NetQuery::log_sample_rate_{1};
+
 void NetQuery::debug(string state, bool may_be_lost) {
   may_be_lost_ = may_be_lost;
-  VLOG(net_query) << *this << " " << tag("state", state);
+  VLOG_NET_QUERY(*this) << *this << " " << tag("state", state);
   {
     auto guard = lock();
     auto &data = get_data_unsafe();
@@ -34,6 +41,16 @@ void NetQuery::debug(string state, bool may_be_lost) {
   }
 }
 
+void NetQuery::set_stage(Stage stage) {
+  if (stage_start_time_ == 0.0) {
+    return;
+  }
+  auto now = Time::now();
+  stage_durations_[static_cast<size_t>(stage_)] += now - stage_start_time_;
+  stage_ = stage;
+  stage_start_time_ = now;
+}
+
 NetQuery::NetQuery(uint64 id, BufferSlice &&query, DcId dc_id, Type type, AuthFlag auth_flag, GzipFlag gzip_flag,
                    int32 tl_constructor, int32 total_timeout_limit, NetQueryStats *stats, vector<ChainId> chain_ids)
     : state_(State::Query)
@@ -51,8 +68,11 @@ NetQuery::NetQuery(uint64 id, BufferSlice &&query, DcId dc_id, Type type, AuthFl
   td::unique(chain_ids_);
 
   auto &data = get_data_unsafe();
-  data.my_id_ = G()->get_option_integer("my_id");
+  data.my_id_ = G()->get_option_integer(CachedOption::MyId);
   data.start_timestamp_ = data.state_timestamp_ = Time::now();
+  if (NetQueryLatencyStats::is_enabled()) {
+    stage_start_time_ = data.start_timestamp_;
+  }
   LOG(INFO) << *this;
   if (stats) {
     nq_counter_ = stats->register_query(this);
@@ -64,13 +84,17 @@ void NetQuery::clear() {
     auto guard = lock();
     LOG(ERROR) << "Destroy not ready query " << *this << " " << tag("state", get_data_unsafe().state_);
   }
+  if (stage_start_time_ != 0.0 && is_ready()) {
+    set_stage(stage_);
+    NetQueryLatencyStats::on_query_finished(tl_constructor_, id_, is_ok(), stage_durations_);
+  }
   // TODO: CHECK if net_query is lost here
   cancel_slot_.close();
   *this = NetQuery();
 }
 
 void NetQuery::resend(DcId new_dc_id) {
-  VLOG(net_query) << "Resend " << *this;
+  VLOG_NET_QUERY(*this) << "Resend " << *this;
   {
     auto guard = lock();
     get_data_unsafe().resend_count_++;
@@ -78,6 +102,7 @@ void NetQuery::resend(DcId new_dc_id) {
   dc_id_ = new_dc_id;
   status_ = Status::OK();
   state_ = State::Query;
+  set_stage(Stage::Dispatch);
 }
 
 bool NetQuery::update_is_ready() {
@@ -92,7 +117,7 @@ bool NetQuery::update_is_ready() {
 }
 
 void NetQuery::set_ok(BufferSlice slice) {
-  VLOG(net_query) << "Receive answer " << *this;
+  VLOG_NET_QUERY(*this) << "Receive answer " << *this;
   CHECK(state_ == State::Query);
   answer_ = std::move(slice);
   state_ = State::OK;
@@ -141,7 +166,7 @@ void NetQuery::set_error(Status status, string source) {
 }
 
 void NetQuery::set_error_impl(Status status, string source) {
-  VLOG(net_query) << "Receive error " << *this << " " << status;
+  VLOG_NET_QUERY(*this) << "Receive error " << *this << " " << status;
   status_ = std::move(status);
   state_ = State::Error;
   source_ = std::move(source);
@@ -16,6 +16,7 @@
 #include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/format.h"
+#include "td/utils/HashTableUtils.h"
 #include "td/utils/logging.h"
 #include "td/utils/ObjectPool.h"
 #include "td/utils/Promise.h"
@@ -26,6 +27,7 @@
 #include "td/utils/tl_parsers.h"
 #include "td/utils/TsList.h"
 
+#include <array>
 #include <atomic>
 #include <utility>
 
@@ -54,7 +56,26 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
   enum class Type : int8 { Common, Upload, Download, DownloadSmall };
   enum class AuthFlag : int8 { Off, On };
   enum class GzipFlag : int8 { Off, On };
+  // queries with higher priority are sent first, but queries with lower priority aren't starved:
+  // while queries of all priorities are waiting, they are sent in proportion to weights of their priorities
+  enum class Priority : int8 { Background, Normal, Interactive };
+  static constexpr size_t PRIORITY_COUNT = 3;
+  // stages of a query lifecycle; time spent in each stage is measured only if NetQueryLatencyStats are enabled
+  enum class Stage : int8 { Dispatch, SequenceDispatcher, Delayer, SessionQueue, Network, ResultProcessing };
+  static constexpr size_t STAGE_COUNT = 6;
   enum Error : int32 { Resend = 202, Canceled = 203, ResendInvokeAfter = 204 };
+  static constexpr int32 MAX_LOG_SAMPLE_RATE = 1000000;
+
+  // only about one of sample_rate queries is logged with the verbosity net_query
+  static void set_log_sample_rate(int32 sample_rate) {
+    log_sample_rate_.store(sample_rate, std::memory_order_relaxed);
+  }
+
+  // the choice depends only on the query identifier, so either all or none of log messages about a query are kept
+  static bool is_log_sampled(uint64 id) {
+    auto sample_rate = log_sample_rate_.load(std::memory_order_relaxed);
+    return sample_rate <= 1 || Hash<uint64>()(id) % static_cast<uint32>(sample_rate) == 0;
+  }
 
   uint64 id() const {
     return id_;
@@ -90,6 +111,26 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
     return query_;
   }
 
+  // the query was created uncompressed and must be compressed by NetQueryCompressor before it is sent
+  bool need_compression() const {
+    return need_compression_;
+  }
+
+  void set_need_compression() {
+    CHECK(gzip_flag_ == GzipFlag::Off);
+    need_compression_ = true;
+  }
+
+  // an empty compressed_query means that the query must be sent uncompressed
+  void on_compressed(BufferSlice &&compressed_query) {
+    CHECK(need_compression_);
+    need_compression_ = false;
+    if (!compressed_query.empty()) {
+      query_ = std::move(compressed_query);
+      gzip_flag_ = GzipFlag::On;
+    }
+  }
+
   const BufferSlice &ok() const {
     CHECK(state_ == State::OK);
     return answer_;
@@ -203,6 +244,8 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
 
   void debug(string state, bool may_be_lost = false);
 
+  void set_stage(Stage stage);
+
   void set_callback(ActorShared<NetQueryCallback> callback) {
     callback_ = std::move(callback);
   }
@@ -220,13 +263,27 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
     finish_migrate(cancel_slot_);
   }
 
-  int8 priority() const {
+  Priority priority() const {
     return priority_;
   }
-  void set_priority(int8 priority) {
+  void set_priority(Priority priority) {
     priority_ = priority;
   }
 
+  static int32 get_priority_weight(Priority priority) {
+    switch (priority) {
+      case Priority::Background:
+        return 1;
+      case Priority::Normal:
+        return 4;
+      case Priority::Interactive:
+        return 16;
+      default:
+        UNREACHABLE();
+        return 1;
+    }
+  }
+
   Span<uint64> get_chain_ids() const {
     return chain_ids_;
   }
@@ -245,6 +302,8 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
   }
 
  private:
+  static std::atomic<int32> log_sample_rate_;
+
   State state_ = State::Empty;
   Type type_ = Type::Common;
   AuthFlag auth_flag_ = AuthFlag::Off;
@@ -264,7 +323,12 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
 
   bool in_sequence_dispacher_ = false;
   bool may_be_lost_ = false;
-  int8 priority_{0};
+  bool need_compression_ = false;
+  Priority priority_ = Priority::Normal;
+
+  Stage stage_ = Stage::Dispatch;
+  double stage_start_time_ = 0.0;  // 0 if the stages aren't measured
+  std::array<double, STAGE_COUNT> stage_durations_{};
 
   template <class T>
   struct movable_atomic final : public std::atomic<T> {
@@ -304,6 +368,7 @@ class NetQuery final : public TsListNode<NetQueryDebug> {
   Slot cancel_slot_;                // for Session and to be set by caller
   Promise<> quick_ack_promise_;     // for Session and to be set by caller
   bool need_resend_on_503_ = true;  // for NetQueryDispatcher and to be set by caller
+  uint64 rate_limit_key_ = 0;       // for NetQueryDispatcher
 
   NetQuery(uint64 id, BufferSlice &&query, DcId dc_id, Type type, AuthFlag auth_flag, GzipFlag gzip_flag,
            int32 tl_constructor, int32 total_timeout_limit, NetQueryStats *stats, vector<ChainId> chain_ids);
@@ -313,6 +378,18 @@ StringBuilder &operator<<(StringBuilder &stream, const NetQuery &net_query);
 
 StringBuilder &operator<<(StringBuilder &stream, const NetQueryPtr &net_query_ptr);
 
+inline bool is_net_query_log_sampled(const NetQuery &net_query) {
+  return NetQuery::is_log_sampled(net_query.id());
+}
+
+inline bool is_net_query_log_sampled(const NetQueryPtr &net_query_ptr) {
+  return net_query_ptr.empty() || is_net_query_log_sampled(*net_query_ptr);
+}
+
+// the condition is checked only if the verbosity net_query is enabled
+#define VLOG_NET_QUERY(query) \
+  LOG_IMPL(DEBUG, net_query, ::td::is_net_query_log_sampled(query), TD_DEFINE_STR(net_query))
+
 inline void cancel_query(NetQueryRef &ref) {
   if (ref.empty()) {
     return;
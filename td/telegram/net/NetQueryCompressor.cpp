@@ -0,0 +1,98 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/net/NetQueryCompressor.h"
+
+#include "td/telegram/Global.h"
+#include "td/telegram/net/NetQueryDispatcher.h"
+
+#include "td/utils/Gzip.h"
+#include "td/utils/misc.h"
+#include "td/utils/Time.h"
+
+#include <mutex>
+
+namespace td {
+
+namespace {
+
+struct StatisticsStorage {
+  std::mutex mutex;
+  NetQueryCompressor::Statistics statistics;
+  double start_time = Time::now();
+};
+
+StatisticsStorage &get_statistics_storage() {
+  static StatisticsStorage storage;
+  return storage;
+}
+
+}  // namespace
+
+void NetQueryCompressor::compress_query(NetQueryPtr query) {
+  query->debug("compress");
+  compress_query_impl(query, true);
+  G()->net_query_dispatcher().dispatch(std::move(query));
+}
+
+void NetQueryCompressor::compress_query_impl(NetQueryPtr &query, bool is_offloaded) {
+  CHECK(query->need_compression());
+  auto level = get_compression_level();
+  query->on_compressed(level == 0 ? BufferSlice() : compress(query->query().as_slice(), level, is_offloaded));
+}
+
+bool NetQueryCompressor::is_compressible(Slice query, int32 level) {
+  // test compression ratio for the middle part
+  // if it is less than MAX_COMPRESSION_RATIO, then try to compress the whole query
+  const size_t TESTED_SIZE = 1024;
+  if (query.size() < 2 * TESTED_SIZE) {
+    return true;
+  }
+  return !gzencode(query.substr((query.size() - TESTED_SIZE) / 2, TESTED_SIZE), MAX_COMPRESSION_RATIO, level).empty();
+}
+
+BufferSlice NetQueryCompressor::compress(Slice query, int32 level, bool is_offloaded) {
+  CHECK(level > 0);
+  auto start_time = Time::now();
+  auto result = gzencode(query, MAX_COMPRESSION_RATIO, level);
+  auto compression_time = Time::now() - start_time;
+
+  auto &storage = get_statistics_storage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  auto &statistics = storage.statistics;
+  statistics.query_count++;
+  if (is_offloaded) {
+    statistics.offloaded_query_count++;
+  }
+  if (!result.empty()) {
+    statistics.compressed_query_count++;
+    statistics.original_size += query.size();
+    statistics.compressed_size += result.size();
+  }
+  statistics.compression_time += compression_time;
+  return result;
+}
+
+int32 NetQueryCompressor::get_compression_level() {
+  return narrow_cast<int32>(
+      clamp(G()->get_option_integer("network_query_compression_level", DEFAULT_COMPRESSION_LEVEL),
+            static_cast<int64>(0), static_cast<int64>(9)));
+}
+
+NetQueryCompressor::Statistics NetQueryCompressor::get_statistics(bool reset) {
+  auto &storage = get_statistics_storage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  auto now = Time::now();
+  auto result = storage.statistics;
+  result.duration = now - storage.start_time;
+  if (reset) {
+    storage.statistics = Statistics();
+    storage.start_time = now;
+  }
+  return result;
+}
+
+}  // namespace td
@@ -0,0 +1,64 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/telegram/net/NetQuery.h"
+
+#include "td/actor/actor.h"
+
+#include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+namespace td {
+
+// compresses big network queries on a separate scheduler, so they don't block the actor, which has created them
+class NetQueryCompressor final : public Actor {
+ public:
+  // process-wide statistics about compression of network queries
+  struct Statistics {
+    double duration = 0.0;
+    uint64 query_count = 0;
+    uint64 compressed_query_count = 0;
+    uint64 offloaded_query_count = 0;
+    uint64 original_size = 0;
+    uint64 compressed_size = 0;
+    double compression_time = 0.0;
+  };
+
+  // queries of at least this size are compressed by NetQueryCompressor
+  static constexpr size_t MIN_OFFLOADED_QUERY_SIZE = 1 << 14;
+
+  static constexpr int32 DEFAULT_COMPRESSION_LEVEL = 6;
+
+  // queries are sent compressed only if compression reduces their size at least by 10%
+  static constexpr double MAX_COMPRESSION_RATIO = 0.9;
+
+  explicit NetQueryCompressor(ActorShared<> parent) : parent_(std::move(parent)) {
+  }
+
+  void compress_query(NetQueryPtr query);
+
+  // compresses the query on the current thread
+  static void compress_query_impl(NetQueryPtr &query, bool is_offloaded);
+
+  // quickly checks whether a big query can be compressed by compressing a part of it
+  static bool is_compressible(Slice query, int32 level);
+
+  // returns the compressed query or an empty BufferSlice if the query must be sent uncompressed
+  static BufferSlice compress(Slice query, int32 level, bool is_offloaded);
+
+  // returns the level from the option "network_query_compression_level"; 0 means that compression is disabled
+  static int32 get_compression_level();
+
+  static Statistics get_statistics(bool reset);
+
+ private:
+  ActorShared<> parent_;
+};
+
+}  // namespace td
@@ -8,6 +8,7 @@
 
 #include "td/telegram/AuthManager.h"
 #include "td/telegram/Global.h"
+#include "td/telegram/net/NetQueryCompressor.h"
 #include "td/telegram/Td.h"
 #include "td/telegram/telegram_api.h"
 
@@ -15,7 +16,6 @@
 
 #include "td/utils/buffer.h"
 #include "td/utils/format.h"
-#include "td/utils/Gzip.h"
 #include "td/utils/logging.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Storer.h"
@@ -29,8 +29,10 @@ NetQueryCreator::NetQueryCreator(std::shared_ptr<NetQueryStats> net_query_stats)
 }
 
 NetQueryPtr NetQueryCreator::create(const telegram_api::Function &function, vector<ChainId> chain_ids, DcId dc_id,
-                                    NetQuery::Type type) {
-  return create(UniqueId::next(), nullptr, function, std::move(chain_ids), dc_id, type, NetQuery::AuthFlag::On);
+                                    NetQuery::Type type, NetQuery::Priority priority) {
+  auto query = create(UniqueId::next(), nullptr, function, std::move(chain_ids), dc_id, type, NetQuery::AuthFlag::On);
+  query->set_priority(priority);
+  return query;
 }
 
 NetQueryPtr NetQueryCreator::create_with_prefix(const telegram_api::object_ptr<telegram_api::Function> &prefix,
@@ -64,9 +66,11 @@ NetQueryPtr NetQueryCreator::create(uint64 id, const telegram_api::object_ptr<te
   size_t min_gzipped_size = 128;
   int32 tl_constructor = function.get_id();
   int32 total_timeout_limit = 60;
+  int32 compression_level = NetQueryCompressor::DEFAULT_COMPRESSION_LEVEL;
 
   if (Scheduler::instance() != nullptr && current_scheduler_id_ == Scheduler::instance()->sched_id() &&
       !G()->close_flag()) {
+    compression_level = NetQueryCompressor::get_compression_level();
     auto td = G()->td();
     if (!td.empty()) {
       auto auth_manager = td.get_actor_unsafe()->auth_manager_.get();
@@ -82,27 +86,26 @@ NetQueryPtr NetQueryCreator::create(uint64 id, const telegram_api::object_ptr<te
     }
   }
 
-  auto gzip_flag = slice.size() < min_gzipped_size ? NetQuery::GzipFlag::Off : NetQuery::GzipFlag::On;
-  if (slice.size() >= 16384) {
-    // test compression ratio for the middle part
-    // if it is less than 0.9, then try to compress the whole request
-    size_t TESTED_SIZE = 1024;
-    BufferSlice compressed_part = gzencode(slice.as_slice().substr((slice.size() - TESTED_SIZE) / 2, TESTED_SIZE), 0.9);
-    if (compressed_part.empty()) {
-      gzip_flag = NetQuery::GzipFlag::Off;
-    }
-  }
-  if (gzip_flag == NetQuery::GzipFlag::On) {
-    BufferSlice compressed = gzencode(slice.as_slice(), 0.9);
-    if (compressed.empty()) {
-      gzip_flag = NetQuery::GzipFlag::Off;
+  auto gzip_flag = NetQuery::GzipFlag::Off;
+  bool need_compression = false;
+  if (slice.size() >= min_gzipped_size && compression_level != 0) {
+    if (slice.size() >= NetQueryCompressor::MIN_OFFLOADED_QUERY_SIZE) {
+      // compression of big queries is postponed until they are dispatched
+      need_compression = NetQueryCompressor::is_compressible(slice.as_slice(), compression_level);
     } else {
-      slice = std::move(compressed);
+      BufferSlice compressed = NetQueryCompressor::compress(slice.as_slice(), compression_level, false);
+      if (!compressed.empty()) {
+        gzip_flag = NetQuery::GzipFlag::On;
+        slice = std::move(compressed);
+      }
     }
   }
 
   auto query = object_pool_.create(id, std::move(slice), dc_id, type, auth_flag, gzip_flag, tl_constructor,
                                    total_timeout_limit, net_query_stats_.get(), std::move(chain_ids));
+  if (need_compression) {
+    query->set_need_compression();
+  }
   query->set_cancellation_token(query.generation());
   return query;
 }
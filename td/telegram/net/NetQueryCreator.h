@@ -32,7 +32,8 @@ class NetQueryCreator {
   }
 
   NetQueryPtr create(const telegram_api::Function &function, vector<ChainId> chain_ids = {}, DcId dc_id = DcId::main(),
-                     NetQuery::Type type = NetQuery::Type::Common);
+                     NetQuery::Type type = NetQuery::Type::Common,
+                     NetQuery::Priority priority = NetQuery::Priority::Normal);
 
   NetQueryPtr create_unauth(const telegram_api::Function &function, DcId dc_id = DcId::main()) {
     return create(UniqueId::next(), nullptr, function, {}, dc_id, NetQuery::Type::Common, NetQuery::AuthFlag::Off);
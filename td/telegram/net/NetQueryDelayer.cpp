@@ -38,6 +38,9 @@ void NetQueryDelayer::delay(NetQueryPtr query) {
                         Slice("TAKEOUT_INIT_DELAY_"), Slice("FLOOD_PREMIUM_WAIT_")}) {
       if (begins_with(error_message, prefix)) {
         timeout = clamp(to_integer<int>(error_message.substr(prefix.size())), 1, 14 * 24 * 60 * 60);
+        if (prefix == "FLOOD_WAIT_") {
+          G()->net_query_dispatcher().on_query_flood_wait(query->dc_id(), query->tl_constructor(), timeout);
+        }
         if (prefix == "FLOOD_PREMIUM_WAIT_") {
           switch (query->type()) {
             case NetQuery::Type::Common:
@@ -106,6 +109,15 @@ void NetQueryDelayer::delay(NetQueryPtr query) {
   query_slot->timeout_.set_timeout_in(timeout);
 }
 
+void NetQueryDelayer::delay_send(NetQueryPtr query, double timeout) {
+  CHECK(!query->is_ready());
+  auto id = container_.create(QuerySlot());
+  auto *query_slot = container_.get(id);
+  query_slot->query_ = std::move(query);
+  query_slot->timeout_.set_event(EventCreator::yield(actor_shared(this, id)));
+  query_slot->timeout_.set_timeout_in(timeout);
+}
+
 void NetQueryDelayer::wakeup() {
   auto link_token = get_link_token();
   if (link_token) {
@@ -120,9 +132,10 @@ void NetQueryDelayer::on_slot_event(uint64 id) {
     return;
   }
   auto query = std::move(slot->query_);
-  if (!query->invoke_after().empty()) {
+  if (!query->invoke_after().empty() && query->rate_limit_key_ == 0) {
     // Fail query after timeout expired if it is a part of an invokeAfter chain.
     // It is not necessary but helps to avoid server problems, when previous query was lost.
+    // Queries delayed by the rate limiter weren't sent yet, so they are sent as is.
     query->set_error_resend_invoke_after();
   }
   slot->timeout_.close();
@@ -21,6 +21,9 @@ class NetQueryDelayer final : public Actor {
   }
   void delay(NetQueryPtr query);
 
+  // delays sending of a query, which has no error, for the given number of seconds
+  void delay_send(NetQueryPtr query, double timeout);
+
  private:
   struct QuerySlot {
     NetQueryPtr query_;
@@ -10,6 +10,7 @@
 #include "td/telegram/net/AuthDataShared.h"
 #include "td/telegram/net/DcAuthManager.h"
 #include "td/telegram/net/NetQuery.h"
+#include "td/telegram/net/NetQueryCompressor.h"
 #include "td/telegram/net/NetQueryDelayer.h"
 #include "td/telegram/net/NetQueryVerifier.h"
 #include "td/telegram/net/PublicRsaKeySharedCdn.h"
@@ -29,6 +30,9 @@
 #include "td/utils/port/sleep.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
+
+#include <cmath>
 
 namespace td {
 
@@ -58,6 +62,12 @@ void NetQueryDispatcher::dispatch(NetQueryPtr net_query) {
   if (check_stop_flag(net_query)) {
     return;
   }
+  bool is_rate_limited = net_query->rate_limit_key_ != 0;
+  if (is_rate_limited) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    rate_limiter_.on_delayed_query_sent(net_query->rate_limit_key_);
+    net_query->rate_limit_key_ = 0;
+  }
   if (G()->get_option_boolean("test_flood_wait")) {
     net_query->set_error(Status::Error(429, "Too Many Requests: retry after 10"));
     return complete_net_query(std::move(net_query));
@@ -76,8 +86,18 @@ void NetQueryDispatcher::dispatch(NetQueryPtr net_query) {
   }
 #endif
 
+  if (net_query->need_compression()) {
+    net_query->debug("sent to NetQueryCompressor");
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (check_stop_flag(net_query)) {
+      return;
+    }
+    return send_closure_later(compressor_, &NetQueryCompressor::compress_query, std::move(net_query));
+  }
+
   if (!net_query->in_sequence_dispatcher() && !net_query->get_chain_ids().empty()) {
     net_query->debug("sent to main sequence dispatcher");
+    net_query->set_stage(NetQuery::Stage::SequenceDispatcher);
     std::lock_guard<std::mutex> guard(mutex_);
     if (check_stop_flag(net_query)) {
       return;
@@ -96,6 +116,7 @@ void NetQueryDispatcher::dispatch(NetQueryPtr net_query) {
                (code == 420 && !begins_with(net_query->error().message(), "STORY_SEND_FLOOD_") &&
                 !begins_with(net_query->error().message(), "PREMIUM_SUB_ACTIVE_UNTIL_"))) {
       net_query->debug("sent to NetQueryDelayer");
+      net_query->set_stage(NetQuery::Stage::Delayer);
       std::lock_guard<std::mutex> guard(mutex_);
       if (check_stop_flag(net_query)) {
         return;
@@ -149,6 +170,23 @@ void NetQueryDispatcher::dispatch(NetQueryPtr net_query) {
   if (check_stop_flag(net_query)) {
     return;
   }
+  if (!is_rate_limited) {
+    auto rate_limit_key = NetQueryRateLimiter::get_key(dest_dc_id, net_query->tl_constructor());
+    auto max_delay = static_cast<double>(net_query->total_timeout_limit_ - net_query->total_timeout_);
+    auto delay = rate_limiter_.get_query_delay(rate_limit_key, Time::now(), max_delay);
+    if (delay > max_delay) {
+      // the query would fail after receiving FLOOD_WAIT anyway
+      net_query->set_error(Status::Error(429, PSLICE() << "Too Many Requests: retry after "
+                                                       << static_cast<int32>(std::ceil(delay))));
+      return complete_net_query(std::move(net_query));
+    }
+    if (delay > 0) {
+      net_query->debug(PSTRING() << "sent to NetQueryDelayer for " << delay << " to avoid flood wait");
+      net_query->rate_limit_key_ = rate_limit_key;
+      net_query->set_stage(NetQuery::Stage::Delayer);
+      return send_closure_later(delayer_, &NetQueryDelayer::delay_send, std::move(net_query), delay);
+    }
+  }
   switch (net_query->type()) {
     case NetQuery::Type::Common:
       net_query->debug(PSTRING() << "sent to main session multi proxy " << dest_dc_id);
@@ -171,6 +209,22 @@ void NetQueryDispatcher::dispatch(NetQueryPtr net_query) {
   }
 }
 
+void NetQueryDispatcher::on_query_flood_wait(DcId dc_id, int32 tl_constructor, int32 timeout) {
+  if (dc_id.is_main()) {
+    dc_id = get_main_dc_id();
+  }
+  if (!dc_id.is_exact()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  rate_limiter_.on_flood_wait(NetQueryRateLimiter::get_key(dc_id, tl_constructor), timeout, Time::now());
+}
+
+td_api::object_ptr<td_api::networkRateLimits> NetQueryDispatcher::get_network_rate_limits_object() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return rate_limiter_.get_network_rate_limits_object(Time::now());
+}
+
 Status NetQueryDispatcher::wait_dc_init(DcId dc_id, bool force) {
   // TODO: optimize
   if (!dc_id.is_exact()) {
@@ -216,7 +270,7 @@ Status NetQueryDispatcher::wait_dc_init(DcId dc_id, bool force) {
     int32 slow_net_scheduler_id = G()->get_slow_net_scheduler_id();
 
     auto raw_dc_id = dc_id.get_raw_id();
-    bool is_premium = G()->get_option_boolean("is_premium");
+    bool is_premium = G()->get_option_boolean(CachedOption::IsPremium);
     int32 upload_session_count = (raw_dc_id != 2 && raw_dc_id != 4) || is_premium ? 8 : 4;
     int32 download_session_count = is_premium ? 8 : 2;
     int32 download_small_session_count = is_premium ? 8 : 2;
@@ -258,6 +312,7 @@ void NetQueryDispatcher::stop() {
   std::lock_guard<std::mutex> guard(mutex_);
   stop_flag_ = true;
   delayer_.reset();
+  compressor_.reset();
   verifier_.reset();
   for (auto &dc : dcs_) {
     dc.main_session_.reset();
@@ -285,6 +340,11 @@ void NetQueryDispatcher::update_session_count() {
     }
   }
 }
+
+void NetQueryDispatcher::update_sequence_dispatcher_window() {
+  send_closure_later(sequence_dispatcher_, &MultiSequenceDispatcher::update_window);
+}
+
 void NetQueryDispatcher::destroy_auth_keys(Promise<> promise) {
   for (int32 i = 1; i < DcId::MAX_RAW_DC_ID && i <= 5; i++) {
     auto dc_id = DcId::internal(i);
@@ -334,7 +394,7 @@ bool NetQueryDispatcher::is_dc_inited(int32 raw_dc_id) {
 }
 
 int32 NetQueryDispatcher::get_session_count() {
-  return max(narrow_cast<int32>(G()->get_option_integer("session_count")), 1);
+  return max(narrow_cast<int32>(G()->get_option_integer(CachedOption::SessionCount)), 1);
 }
 
 bool NetQueryDispatcher::get_use_pfs() {
@@ -351,6 +411,8 @@ NetQueryDispatcher::NetQueryDispatcher(const std::function<ActorShared<>()> &cre
     main_dc_id_ = to_integer<int32>(s_main_dc_id);
   }
   delayer_ = create_actor<NetQueryDelayer>("NetQueryDelayer", create_reference());
+  compressor_ = create_actor_on_scheduler<NetQueryCompressor>("NetQueryCompressor", G()->get_slow_net_scheduler_id(),
+                                                             create_reference());
 #if TD_ANDROID || TD_DARWIN_IOS || TD_DARWIN_VISION_OS || TD_DARWIN_WATCH_OS || TD_TEST_VERIFICATION
   verifier_ = create_actor<NetQueryVerifier>("NetQueryVerifier", create_reference());
 #endif
@@ -410,6 +472,24 @@ void NetQueryDispatcher::set_main_dc_id(int32 new_main_dc_id) {
   G()->td_db()->get_binlog_pmc()->set("main_dc_id", to_string(main_dc_id_.load(std::memory_order_relaxed)));
 }
 
+void NetQueryDispatcher::warm_up_dc(DcId dc_id) {
+  // initialization of a DC starts export and import of the authorization in DcAuthManager;
+  // the download session is opened as soon as the authorization is imported
+  if (!dc_id.is_exact() || !dc_id.is_internal() || is_dc_inited(dc_id.get_raw_id())) {
+    return;
+  }
+  if (wait_dc_init(dc_id, true).is_error()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (stop_flag_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  LOG(INFO) << "Warm up " << dc_id;
+  send_closure_later(dcs_[dc_id.get_raw_id() - 1].download_small_session_, &SessionMultiProxy::warm_up);
+}
+
 void NetQueryDispatcher::check_authorization_is_ok() {
   std::lock_guard<std::mutex> guard(mutex_);
   if (stop_flag_.load(std::memory_order_relaxed)) {
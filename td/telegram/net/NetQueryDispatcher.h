@@ -8,6 +8,8 @@
 
 #include "td/telegram/net/DcId.h"
 #include "td/telegram/net/NetQuery.h"
+#include "td/telegram/net/NetQueryRateLimiter.h"
+#include "td/telegram/td_api.h"
 
 #include "td/actor/actor.h"
 
@@ -26,6 +28,7 @@ namespace td {
 
 class DcAuthManager;
 class MultiSequenceDispatcher;
+class NetQueryCompressor;
 class NetQueryDelayer;
 class NetQueryVerifier;
 class PublicRsaKeyWatchdog;
@@ -46,6 +49,7 @@ class NetQueryDispatcher {
   void stop();
 
   void update_session_count();
+  void update_sequence_dispatcher_window();
   void destroy_auth_keys(Promise<> promise);
   void update_use_pfs();
   void update_mtproto_header();
@@ -55,14 +59,20 @@ class NetQueryDispatcher {
   }
 
   void set_main_dc_id(int32 new_main_dc_id);
+  void warm_up_dc(DcId dc_id);
   void check_authorization_is_ok();
 
   void set_verification_token(int64 verification_id, string &&token, Promise<Unit> &&promise);
 
+  void on_query_flood_wait(DcId dc_id, int32 tl_constructor, int32 timeout);
+
+  td_api::object_ptr<td_api::networkRateLimits> get_network_rate_limits_object();
+
  private:
   std::atomic<bool> stop_flag_{false};
   bool need_destroy_auth_key_{false};
   ActorOwn<NetQueryDelayer> delayer_;
+  ActorOwn<NetQueryCompressor> compressor_;
   ActorOwn<NetQueryVerifier> verifier_;
   ActorOwn<DcAuthManager> dc_auth_manager_;
   ActorOwn<MultiSequenceDispatcher> sequence_dispatcher_;
@@ -84,6 +94,7 @@ class NetQueryDispatcher {
 #endif
   ActorOwn<PublicRsaKeyWatchdog> public_rsa_key_watchdog_;
   std::mutex mutex_;
+  NetQueryRateLimiter rate_limiter_;  // protected by mutex_
   std::shared_ptr<Guard> td_guard_;
 
   Status wait_dc_init(DcId dc_id, bool force);
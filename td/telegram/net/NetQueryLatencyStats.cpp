@@ -0,0 +1,156 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/net/NetQueryLatencyStats.h"
+
+#include "td/utils/LatencyHistogram.h"
+#include "td/utils/port/Clocks.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
+
+#include <map>
+#include <mutex>
+
+namespace td {
+
+int VERBOSITY_NAME(net_query_trace) = VERBOSITY_NAME(DEBUG) + 2;
+
+std::atomic<bool> NetQueryLatencyStats::is_enabled_{false};
+
+namespace {
+
+struct MethodHistograms {
+  LatencyHistogram total;
+  std::array<LatencyHistogram, NetQuery::STAGE_COUNT> stages;
+};
+
+struct Histograms {
+  std::mutex mutex;
+  std::map<int32, unique_ptr<MethodHistograms>> methods;
+  double start_time = Time::now();
+};
+
+Histograms &get_histograms() {
+  static Histograms histograms;
+  return histograms;
+}
+
+Slice get_stage_name(size_t stage) {
+  switch (static_cast<NetQuery::Stage>(stage)) {
+    case NetQuery::Stage::Dispatch:
+      return Slice("dispatch");
+    case NetQuery::Stage::SequenceDispatcher:
+      return Slice("sequence_dispatcher");
+    case NetQuery::Stage::Delayer:
+      return Slice("delayer");
+    case NetQuery::Stage::SessionQueue:
+      return Slice("session_queue");
+    case NetQuery::Stage::Network:
+      return Slice("network");
+    case NetQuery::Stage::ResultProcessing:
+      return Slice("result_processing");
+    default:
+      UNREACHABLE();
+      return Slice();
+  }
+}
+
+string to_fixed_hex(uint64 value, size_t length) {
+  static const char *hex = "0123456789abcdef";
+  string result(length, '0');
+  for (size_t i = length; i > 0 && value != 0; i--) {
+    result[i - 1] = hex[value & 15];
+    value >>= 4;
+  }
+  return result;
+}
+
+void log_query_span(int32 tl_constructor, uint64 query_id, bool is_ok, double total_duration,
+                    const std::array<double, NetQuery::STAGE_COUNT> &stage_durations) {
+  auto end_time = Clocks::system();
+  auto start_time = end_time - total_duration;
+  auto span_id = to_fixed_hex(query_id, 16);
+
+  auto log_line = PSTRING() << "{\"traceId\":\"" << to_fixed_hex(0, 16) << span_id << "\",\"spanId\":\"" << span_id
+                            << "\",\"name\":\"" << to_fixed_hex(static_cast<uint32>(tl_constructor), 8)
+                            << "\",\"kind\":3,\"startTimeUnixNano\":\"" << static_cast<int64>(start_time * 1e9)
+                            << "\",\"endTimeUnixNano\":\"" << static_cast<int64>(end_time * 1e9)
+                            << "\",\"status\":{\"code\":" << (is_ok ? 1 : 2) << "},\"attributes\":[";
+  for (size_t i = 0; i < NetQuery::STAGE_COUNT; i++) {
+    if (i != 0) {
+      log_line += ',';
+    }
+    log_line += PSTRING() << "{\"key\":\"td.stage." << get_stage_name(i) << "\",\"value\":{\"doubleValue\":"
+                          << stage_durations[i] << "}}";
+  }
+  log_line += "]}";
+  VLOG(net_query_trace) << log_line;
+}
+
+td_api::object_ptr<td_api::delayStatistics> get_delay_statistics_object(const LatencyHistogram &histogram) {
+  return td_api::make_object<td_api::delayStatistics>(
+      static_cast<int64>(histogram.get_count()), histogram.get_average(), histogram.get_percentile(50),
+      histogram.get_percentile(90), histogram.get_percentile(99), histogram.get_max());
+}
+
+}  // namespace
+
+void NetQueryLatencyStats::set_enabled(bool is_enabled) {
+  is_enabled_.store(is_enabled, std::memory_order_relaxed);
+}
+
+void NetQueryLatencyStats::on_query_finished(int32 tl_constructor, uint64 query_id, bool is_ok,
+                                             const std::array<double, NetQuery::STAGE_COUNT> &stage_durations) {
+  double total_duration = 0.0;
+  for (auto duration : stage_durations) {
+    total_duration += duration;
+  }
+  if (VERBOSITY_NAME(net_query_trace) <= GET_VERBOSITY_LEVEL() && NetQuery::is_log_sampled(query_id)) {
+    log_query_span(tl_constructor, query_id, is_ok, total_duration, stage_durations);
+  }
+  if (!is_enabled()) {
+    return;
+  }
+
+  auto &histograms = get_histograms();
+  std::lock_guard<std::mutex> lock(histograms.mutex);
+  auto &method_histograms = histograms.methods[tl_constructor];
+  if (method_histograms == nullptr) {
+    method_histograms = make_unique<MethodHistograms>();
+  }
+  method_histograms->total.add(total_duration);
+  for (size_t i = 0; i < NetQuery::STAGE_COUNT; i++) {
+    method_histograms->stages[i].add(stage_durations[i]);
+  }
+}
+
+td_api::object_ptr<td_api::networkQueryLatencyStatistics>
+NetQueryLatencyStats::get_network_query_latency_statistics_object(bool reset) {
+  auto &histograms = get_histograms();
+  std::lock_guard<std::mutex> lock(histograms.mutex);
+  auto now = Time::now();
+  vector<td_api::object_ptr<td_api::networkMethodLatencyStatistics>> methods;
+  for (auto &it : histograms.methods) {
+    const auto &stages = it.second->stages;
+    auto get_stage_object = [&stages](NetQuery::Stage stage) {
+      return get_delay_statistics_object(stages[static_cast<size_t>(stage)]);
+    };
+    methods.push_back(td_api::make_object<td_api::networkMethodLatencyStatistics>(
+        it.first, get_delay_statistics_object(it.second->total), get_stage_object(NetQuery::Stage::Dispatch),
+        get_stage_object(NetQuery::Stage::SequenceDispatcher), get_stage_object(NetQuery::Stage::Delayer),
+        get_stage_object(NetQuery::Stage::SessionQueue), get_stage_object(NetQuery::Stage::Network),
+        get_stage_object(NetQuery::Stage::ResultProcessing)));
+  }
+  auto result = td_api::make_object<td_api::networkQueryLatencyStatistics>(now - histograms.start_time,
+                                                                           std::move(methods));
+  if (reset) {
+    histograms.methods.clear();
+    histograms.start_time = now;
+  }
+  return result;
+}
+
+}  // namespace td
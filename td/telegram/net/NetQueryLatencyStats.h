@@ -0,0 +1,43 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/telegram/net/NetQuery.h"
+#include "td/telegram/td_api.h"
+
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
+
+#include <array>
+#include <atomic>
+
+namespace td {
+
+extern int VERBOSITY_NAME(net_query_trace);
+
+// process-wide per-method histograms of time spent by network queries in each stage of their lifecycle
+class NetQueryLatencyStats {
+ public:
+  static void set_enabled(bool is_enabled);
+
+  static bool is_enabled() {
+    return is_enabled_.load(std::memory_order_relaxed);
+  }
+
+  // a query, created while the statistics were enabled, has finished and its result was processed;
+  // if the net_query_trace log tag is enabled, the query is also logged as a span in OpenTelemetry JSON format
+  static void on_query_finished(int32 tl_constructor, uint64 query_id, bool is_ok,
+                                const std::array<double, NetQuery::STAGE_COUNT> &stage_durations);
+
+  static td_api::object_ptr<td_api::networkQueryLatencyStatistics> get_network_query_latency_statistics_object(
+      bool reset);
+
+ private:
+  static std::atomic<bool> is_enabled_;
+};
+
+}  // namespace td
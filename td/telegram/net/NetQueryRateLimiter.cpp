@@ -0,0 +1,93 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/net/NetQueryRateLimiter.h"
+
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+
+#include <algorithm>
+
+namespace td {
+
+uint64 NetQueryRateLimiter::get_key(DcId dc_id, int32 tl_constructor) {
+  CHECK(dc_id.is_exact());
+  return (static_cast<uint64>(dc_id.get_raw_id()) << 32) | static_cast<uint32>(tl_constructor);
+}
+
+double NetQueryRateLimiter::get_query_delay(uint64 key, double now, double max_delay) {
+  auto it = limiters_.find(key);
+  if (it == limiters_.end()) {
+    return 0.0;
+  }
+  auto &limiter = it->second;
+  if (limiter.delayed_query_count_ == 0 && limiter.next_send_time_ <= now &&
+      limiter.last_flood_wait_time_ + LIMITER_TTL < now) {
+    LOG(INFO) << "Forget rate limit for query " << key;
+    limiters_.erase(it);
+    return 0.0;
+  }
+
+  auto send_time = max(limiter.next_send_time_, now);
+  auto delay = send_time - now;
+  if (delay > max_delay) {
+    return delay;
+  }
+  limiter.next_send_time_ = send_time + 1.0 / limiter.rate_;
+  limiter.rate_ = min(limiter.rate_ + RATE_INCREASE_SPEED / limiter.rate_, MAX_RATE);
+  if (delay > 0) {
+    limiter.delayed_query_count_++;
+  }
+  return delay;
+}
+
+void NetQueryRateLimiter::on_delayed_query_sent(uint64 key) {
+  auto it = limiters_.find(key);
+  if (it == limiters_.end()) {
+    return;
+  }
+  CHECK(it->second.delayed_query_count_ > 0);
+  it->second.delayed_query_count_--;
+}
+
+void NetQueryRateLimiter::on_flood_wait(uint64 key, int32 timeout, double now) {
+  CHECK(timeout > 0);
+  auto &limiter = limiters_[key];
+  if (limiter.rate_ == 0.0) {
+    limiter.rate_ = clamp(1.0 / timeout, MIN_RATE, MAX_INITIAL_RATE);
+  } else if (limiter.flood_wait_until_ <= now) {
+    // all queries sent before the flood wait will likely receive the same error, so reduce the rate only once
+    limiter.rate_ = max(limiter.rate_ * RATE_DECREASE_FACTOR, MIN_RATE);
+  }
+  limiter.flood_wait_until_ = max(limiter.flood_wait_until_, now + timeout);
+  limiter.next_send_time_ = max(limiter.next_send_time_, limiter.flood_wait_until_);
+  limiter.last_flood_wait_time_ = now;
+  LOG(INFO) << "Limit rate of query " << key << " to " << limiter.rate_ << " queries per second";
+}
+
+td_api::object_ptr<td_api::networkRateLimits> NetQueryRateLimiter::get_network_rate_limits_object(double now) const {
+  vector<td_api::object_ptr<td_api::networkRateLimit>> limits;
+  for (auto &it : limiters_) {
+    auto &limiter = it.second;
+    auto dc_id = static_cast<int32>(it.first >> 32);
+    auto method_id = static_cast<int32>(static_cast<uint32>(it.first));
+    limits.push_back(td_api::make_object<td_api::networkRateLimit>(
+        dc_id, method_id, limiter.rate_, limiter.delayed_query_count_, max(limiter.next_send_time_ - now, 0.0),
+        max(now - limiter.last_flood_wait_time_, 0.0)));
+  }
+  std::sort(limits.begin(), limits.end(), [](const auto &lhs, const auto &rhs) {
+    if (lhs->delayed_query_count_ != rhs->delayed_query_count_) {
+      return lhs->delayed_query_count_ > rhs->delayed_query_count_;
+    }
+    if (lhs->dc_id_ != rhs->dc_id_) {
+      return lhs->dc_id_ < rhs->dc_id_;
+    }
+    return lhs->method_id_ < rhs->method_id_;
+  });
+  return td_api::make_object<td_api::networkRateLimits>(std::move(limits));
+}
+
+}  // namespace td
@@ -0,0 +1,55 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/telegram/net/DcId.h"
+#include "td/telegram/td_api.h"
+
+#include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
+
+namespace td {
+
+// learns limits on query rate for each method in each DC from received FLOOD_WAIT_X errors
+// and paces subsequent queries to the same method to stay below the limit instead of repeatedly hitting it;
+// the rate is reduced multiplicatively after each flood wait and grows additively while queries are sent
+// must be used under external synchronization
+class NetQueryRateLimiter {
+ public:
+  static uint64 get_key(DcId dc_id, int32 tl_constructor);
+
+  // returns the delay in seconds before the query can be sent
+  // a send slot is reserved for the query if the delay doesn't exceed max_delay
+  double get_query_delay(uint64 key, double now, double max_delay);
+
+  // must be called when a query with non-zero delay is sent
+  void on_delayed_query_sent(uint64 key);
+
+  void on_flood_wait(uint64 key, int32 timeout, double now);
+
+  td_api::object_ptr<td_api::networkRateLimits> get_network_rate_limits_object(double now) const;
+
+ private:
+  struct Limiter {
+    double rate_ = 0.0;            // allowed number of queries per second
+    double next_send_time_ = 0.0;  // the time at which the next query can be sent
+    double flood_wait_until_ = 0.0;
+    double last_flood_wait_time_ = 0.0;
+    int32 delayed_query_count_ = 0;
+  };
+
+  static constexpr double MIN_RATE = 1.0 / 60;
+  static constexpr double MAX_INITIAL_RATE = 1.0;
+  static constexpr double MAX_RATE = 1000.0;
+  static constexpr double RATE_DECREASE_FACTOR = 0.8;
+  static constexpr double RATE_INCREASE_SPEED = 0.2;  // increase of the rate per second of sending at the rate
+  static constexpr double LIMITER_TTL = 3600.0;       // limiters without flood waits are forgotten after an hour
+
+  FlatHashMap<uint64, Limiter> limiters_;
+};
+
+}  // namespace td
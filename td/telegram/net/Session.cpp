@@ -12,6 +12,7 @@
 #include "td/telegram/net/DcId.h"
 #include "td/telegram/net/MtprotoHeader.h"
 #include "td/telegram/net/NetQuery.h"
+#include "td/telegram/net/NetQueryCompressor.h"
 #include "td/telegram/net/NetQueryDispatcher.h"
 #include "td/telegram/net/NetType.h"
 #include "td/telegram/StateManager.h"
@@ -213,22 +214,38 @@ TD_THREAD_LOCAL Semaphore *GenAuthKeyActor::semaphore_{};
 }  // namespace detail
 
 void Session::PriorityQueue::push(NetQueryPtr query) {
-  auto priority = query->priority();
-  queries_[priority].push(std::move(query));
+  auto priority = static_cast<size_t>(query->priority());
+  CHECK(priority < queries_.size());
+  auto &queue = queries_[priority];
+  if (queue.empty()) {
+    // a queue, which was idle, must not get a burst of queries for the time it was idle
+    virtual_times_[priority] = max(virtual_times_[priority], virtual_time_);
+  }
+  queue.push(std::move(query));
+  size_++;
 }
 
 NetQueryPtr Session::PriorityQueue::pop() {
   CHECK(!empty());
-  auto it = queries_.begin();
-  auto res = it->second.pop();
-  if (it->second.empty()) {
-    queries_.erase(it);
+  size_t best_priority = queries_.size();
+  for (size_t priority = queries_.size(); priority-- > 0;) {
+    if (!queries_[priority].empty() &&
+        (best_priority == queries_.size() || virtual_times_[priority] < virtual_times_[best_priority])) {
+      best_priority = priority;
+    }
   }
-  return res;
+  CHECK(best_priority < queries_.size());
+  virtual_time_ = virtual_times_[best_priority];
+
+  auto max_weight = NetQuery::get_priority_weight(NetQuery::Priority::Interactive);
+  virtual_times_[best_priority] +=
+      max_weight / NetQuery::get_priority_weight(static_cast<NetQuery::Priority>(best_priority));
+  size_--;
+  return queries_[best_priority].pop();
 }
 
 bool Session::PriorityQueue::empty() const {
-  return queries_.empty();
+  return size_ == 0;
 }
 
 Session::Session(unique_ptr<Callback> callback, std::shared_ptr<AuthDataShared> shared_auth_data, int32 raw_dc_id,
@@ -375,7 +392,7 @@ void Session::send(NetQueryPtr &&query) {
 
   // query->debug(PSTRING() << get_name() << ": received by Session");
   query->set_session_id(auth_data_.get_session_id());
-  VLOG(net_query) << "Receive query " << query;
+  VLOG_NET_QUERY(query) << "Receive query " << query;
   if (query->update_is_ready()) {
     return_query(std::move(query));
     return;
@@ -491,6 +508,7 @@ void Session::return_query(NetQueryPtr &&query) {
   last_activity_timestamp_ = Time::now();
 
   query->set_session_id(0);
+  query->set_stage(NetQuery::Stage::ResultProcessing);
   callback_->on_result(std::move(query));
 }
 
@@ -511,6 +529,7 @@ void Session::close() {
   for (auto &it : sent_queries_) {
     auto &query = it.second.net_query_;
     query->set_message_id(0);
+    query->set_stage(NetQuery::Stage::SessionQueue);
     pending_queries_.push(std::move(query));
   }
   sent_queries_.clear();
@@ -686,7 +705,7 @@ void Session::on_closed(Status status) {
         mark_as_known(it->first, &it->second);
 
         auto &query = it->second.net_query_;
-        VLOG(net_query) << "Resend query (on_disconnected, no ack) " << query;
+        VLOG_NET_QUERY(query) << "Resend query (on_disconnected, no ack) " << query;
         query->set_message_id(0);
         query->set_error(Status::Error(500, PSLICE() << "Session failed: " << status.message()),
                          current_info_->connection_->get_name().str());
@@ -791,7 +810,7 @@ void Session::on_message_ack_impl_inner(mtproto::MessageId message_id, int32 typ
   if (it == sent_queries_.end()) {
     return;
   }
-  VLOG(net_query) << "Ack " << it->second.net_query_;
+  VLOG_NET_QUERY(it->second.net_query_) << "Ack " << it->second.net_query_;
   it->second.is_acknowledged_ = true;
   {
     auto lock = it->second.net_query_->lock();
@@ -839,7 +858,7 @@ void Session::mark_as_known(mtproto::MessageId message_id, Query *query) {
   if (!query->is_unknown_) {
     return;
   }
-  VLOG(net_query) << "Mark as known " << query->net_query_;
+  VLOG_NET_QUERY(query->net_query_) << "Mark as known " << query->net_query_;
   query->is_unknown_ = false;
   unknown_queries_.erase(message_id);
   if (unknown_queries_.empty()) {
@@ -855,7 +874,7 @@ void Session::mark_as_unknown(mtproto::MessageId message_id, Query *query) {
   if (query->is_unknown_) {
     return;
   }
-  VLOG(net_query) << "Mark as unknown " << query->net_query_;
+  VLOG_NET_QUERY(query->net_query_) << "Mark as unknown " << query->net_query_;
   query->is_unknown_ = true;
   CHECK(message_id != mtproto::MessageId());
   unknown_queries_.insert(message_id);
@@ -899,7 +918,7 @@ Status Session::on_message_result_ok(mtproto::MessageId message_id, BufferSlice
 
   auth_data_.on_api_response();
   Query *query_ptr = &it->second;
-  VLOG(net_query) << "Return query result " << query_ptr->net_query_;
+  VLOG_NET_QUERY(query_ptr->net_query_) << "Return query result " << query_ptr->net_query_;
 
   if (!parser.get_error()) {
     // Steal authorization information.
@@ -995,7 +1014,7 @@ void Session::on_message_result_error(mtproto::MessageId message_id, int error_c
   }
 
   Query *query_ptr = &it->second;
-  VLOG(net_query) << "Return query error " << query_ptr->net_query_;
+  VLOG_NET_QUERY(query_ptr->net_query_) << "Return query error " << query_ptr->net_query_;
 
   cleanup_container(message_id, query_ptr);
   mark_as_known(message_id, query_ptr);
@@ -1108,7 +1127,7 @@ bool Session::has_queries() const {
 }
 
 void Session::resend_query(NetQueryPtr query) {
-  VLOG(net_query) << "Resend " << query;
+  VLOG_NET_QUERY(query) << "Resend " << query;
   query->set_message_id(0);
 
   if (UniqueId::extract_type(query->id()) == UniqueId::BindKey) {
@@ -1122,6 +1141,7 @@ void Session::resend_query(NetQueryPtr query) {
 void Session::add_query(NetQueryPtr &&net_query) {
   CHECK(UniqueId::extract_type(net_query->id()) != UniqueId::BindKey);
   net_query->debug(PSTRING() << get_name() << ": pending");
+  net_query->set_stage(NetQuery::Stage::SessionQueue);
   pending_queries_.push(std::move(net_query));
 }
 
@@ -1151,6 +1171,11 @@ void Session::connection_send_query(ConnectionInfo *info, NetQueryPtr &&net_quer
     }
   }
 
+  if (net_query->need_compression()) {
+    // the query was sent directly to the session instead of NetQueryDispatcher
+    NetQueryCompressor::compress_query_impl(net_query, false);
+  }
+
   auto now = Time::now();
   bool immediately_fail_query = false;
   if (!immediately_fail_query) {
@@ -1171,7 +1196,9 @@ void Session::connection_send_query(ConnectionInfo *info, NetQueryPtr &&net_quer
     }
   }
   net_query->set_message_id(message_id.get());
-  VLOG(net_query) << "Send query to connection " << net_query << tag("invoke_after", invoke_after_message_ids);
+  net_query->set_stage(NetQuery::Stage::Network);
+  VLOG_NET_QUERY(net_query) << "Send query to connection " << net_query
+                            << tag("invoke_after", invoke_after_message_ids);
   {
     auto lock = net_query->lock();
     net_query->get_data_unsafe().unknown_state_ = false;
@@ -1416,6 +1443,10 @@ void Session::on_handshake_ready(Result<unique_ptr<mtproto::AuthKeyHandshake>> r
     if (!handshake->is_ready_for_finish()) {
       LOG(INFO) << "Handshake is not yet ready";
       info.handshake_ = std::move(handshake);
+    } else if (handshake_id == SpareTmpAuthKeyHandshake) {
+      spare_tmp_auth_key_ = handshake->release_auth_key();
+      spare_tmp_auth_key_server_salt_ = handshake->get_server_salt();
+      LOG(INFO) << "Generated spare temporary auth key " << spare_tmp_auth_key_.id();
     } else {
       if (is_main) {
         auth_data_.set_main_auth_key(handshake->release_auth_key());
@@ -1498,6 +1529,37 @@ void Session::create_gen_auth_key_actor(HandshakeId handshake_id) {
       callback_);
 }
 
+bool Session::need_spare_tmp_auth_key(double now) const {
+  // the spare key is generated only for main sessions when there are no queries to avoid delaying them
+  return is_main_ && auth_data_.use_pfs() && !auth_data_.need_main_auth_key() && spare_tmp_auth_key_.empty() &&
+         !handshake_info_[TmpAuthKeyHandshake].flag_ && !has_queries() && last_activity_timestamp_ < now - 10;
+}
+
+bool Session::use_spare_tmp_auth_key(double now, double refresh_margin) {
+  if (spare_tmp_auth_key_.empty() || handshake_info_[TmpAuthKeyHandshake].flag_) {
+    return false;
+  }
+  if (now > spare_tmp_auth_key_.expires_at() - refresh_margin) {
+    spare_tmp_auth_key_ = mtproto::AuthKey();
+    return false;
+  }
+
+  LOG(WARNING) << "Use spare temporary auth key " << spare_tmp_auth_key_.id() << " in session_id "
+               << auth_data_.get_session_id();
+  auth_data_.set_tmp_auth_key(std::move(spare_tmp_auth_key_));
+  spare_tmp_auth_key_ = mtproto::AuthKey();
+  if (is_main_) {
+    registered_temp_auth_key_ = TempAuthKeyWatchdog::register_auth_key_id(auth_data_.get_tmp_auth_key().id());
+  }
+  on_tmp_auth_key_updated();
+  connection_close(&main_connection_);
+  connection_close(&long_poll_connection_);
+
+  auth_data_.set_server_salt(spare_tmp_auth_key_server_salt_, now);
+  on_server_salt_updated();
+  return true;
+}
+
 void Session::auth_loop(double now) {
   if (can_destroy_auth_key()) {
     return;
@@ -1505,8 +1567,13 @@ void Session::auth_loop(double now) {
   if (auth_data_.need_main_auth_key()) {
     create_gen_auth_key_actor(MainAuthKeyHandshake);
   }
-  if (auth_data_.need_tmp_auth_key(now, persist_tmp_auth_key_ ? 2 * 60 : 60 * 60)) {
-    create_gen_auth_key_actor(TmpAuthKeyHandshake);
+  auto tmp_auth_key_refresh_margin = persist_tmp_auth_key_ ? 2 * 60 : 60 * 60;
+  if (auth_data_.need_tmp_auth_key(now, tmp_auth_key_refresh_margin)) {
+    if (!use_spare_tmp_auth_key(now, tmp_auth_key_refresh_margin)) {
+      create_gen_auth_key_actor(TmpAuthKeyHandshake);
+    }
+  } else if (need_spare_tmp_auth_key(now)) {
+    create_gen_auth_key_actor(SpareTmpAuthKeyHandshake);
   }
 }
 
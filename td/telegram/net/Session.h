@@ -32,7 +32,6 @@
 
 #include <array>
 #include <deque>
-#include <functional>
 #include <map>
 #include <memory>
 #include <utility>
@@ -138,13 +137,18 @@ class Session final
 
   // Do not invalidate iterators of these two containers!
   // TODO: better data structures
+  // weighted fair queue: the non-empty queue with the smallest virtual time is served first,
+  // and each served query advances virtual time of its queue inversely proportional to the priority weight
   struct PriorityQueue {
     void push(NetQueryPtr query);
     NetQueryPtr pop();
     bool empty() const;
 
    private:
-    std::map<int8, VectorQueue<NetQueryPtr>, std::greater<>> queries_;
+    std::array<VectorQueue<NetQueryPtr>, NetQuery::PRIORITY_COUNT> queries_;
+    std::array<int64, NetQuery::PRIORITY_COUNT> virtual_times_{};
+    int64 virtual_time_ = 0;
+    size_t size_ = 0;
   };
   PriorityQueue pending_queries_;
   std::map<mtproto::MessageId, Query> sent_queries_;
@@ -192,8 +196,12 @@ class Session final
     ActorOwn<detail::GenAuthKeyActor> actor_;
     unique_ptr<mtproto::AuthKeyHandshake> handshake_;
   };
-  enum HandshakeId : int32 { MainAuthKeyHandshake = 0, TmpAuthKeyHandshake = 1 };
-  std::array<HandshakeInfo, 2> handshake_info_;
+  enum HandshakeId : int32 { MainAuthKeyHandshake = 0, TmpAuthKeyHandshake = 1, SpareTmpAuthKeyHandshake = 2 };
+  std::array<HandshakeInfo, 3> handshake_info_;
+
+  // temporary auth key generated in advance to be used immediately after the current one is dropped or expires
+  mtproto::AuthKey spare_tmp_auth_key_;
+  uint64 spare_tmp_auth_key_server_salt_ = 0;
 
   double wakeup_at_;
 
@@ -202,6 +210,8 @@ class Session final
 
   void on_handshake_ready(Result<unique_ptr<mtproto::AuthKeyHandshake>> r_handshake);
   void create_gen_auth_key_actor(HandshakeId handshake_id);
+  bool need_spare_tmp_auth_key(double now) const;
+  bool use_spare_tmp_auth_key(double now, double refresh_margin);
   void auth_loop(double now);
 
   // mtproto::Connection::Callback
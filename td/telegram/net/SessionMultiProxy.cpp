@@ -43,14 +43,16 @@ void SessionMultiProxy::send(NetQueryPtr query) {
     if (session_rand) {
       pos = session_rand % sessions_.size();
     } else {
+      // send the query to the least loaded session, so a large query doesn't delay small queries
       size_t equal_count = 1;
-      int min_query_count = sessions_[pos].query_count;
+      auto min_load = get_session_load(sessions_[pos], query->priority());
       for (size_t i = 1; i < sessions_.size(); i++) {
-        if (sessions_[i].query_count < min_query_count) {
+        auto load = get_session_load(sessions_[i], query->priority());
+        if (load < min_load) {
           pos = i;
-          min_query_count = sessions_[pos].query_count;
+          min_load = load;
           equal_count = 1;
-        } else if (sessions_[i].query_count == min_query_count) {
+        } else if (load == min_load) {
           equal_count++;
           if (Random::fast_uint32() % equal_count == 0) {
             pos = i;
@@ -60,7 +62,7 @@ void SessionMultiProxy::send(NetQueryPtr query) {
     }
   }
   // query->debug(PSTRING() << get_name() << ": send to proxy #" << pos);
-  sessions_[pos].query_count++;
+  sessions_[pos].loads[static_cast<size_t>(query->priority())] += get_query_weight(query->query().size());
   send_closure(sessions_[pos].proxy, &SessionProxy::send, std::move(query));
 }
 
@@ -125,6 +127,13 @@ void SessionMultiProxy::update_mtproto_header() {
   }
 }
 
+void SessionMultiProxy::warm_up() {
+  if (sessions_.empty()) {
+    return;
+  }
+  send_closure(sessions_[0].proxy, &SessionProxy::warm_up);
+}
+
 void SessionMultiProxy::start_up() {
   init();
 }
@@ -149,8 +158,8 @@ void SessionMultiProxy::init() {
       Callback(ActorId<SessionMultiProxy> parent, uint32 generation, int32 session_id)
           : parent_(parent), generation_(generation), session_id_(session_id) {
       }
-      void on_query_finished() final {
-        send_closure(parent_, &SessionMultiProxy::on_query_finished, generation_, session_id_);
+      void on_query_finished(NetQuery::Priority priority, size_t query_size) final {
+        send_closure(parent_, &SessionMultiProxy::on_query_finished, generation_, session_id_, priority, query_size);
       }
 
      private:
@@ -166,14 +175,32 @@ void SessionMultiProxy::init() {
   }
 }
 
-void SessionMultiProxy::on_query_finished(uint32 generation, int session_id) {
+int64 SessionMultiProxy::get_query_weight(size_t query_size) {
+  // a query costs as much as 1 KB of data, so sessions are balanced both by the number of queries in flight
+  // and by the number of bytes sent in them
+  return 1 + static_cast<int64>(query_size >> 10);
+}
+
+int64 SessionMultiProxy::get_session_load(const SessionInfo &info, NetQuery::Priority priority) {
+  // queries with lower priority delay the query only in proportion to their weight,
+  // because sessions send queries using weighted fair queueing
+  auto weight = NetQuery::get_priority_weight(priority);
+  int64 result = 0;
+  for (size_t i = 0; i < info.loads.size(); i++) {
+    result += info.loads[i] * min(weight, NetQuery::get_priority_weight(static_cast<NetQuery::Priority>(i)));
+  }
+  return result;
+}
+
+void SessionMultiProxy::on_query_finished(uint32 generation, int session_id, NetQuery::Priority priority,
+                                          size_t query_size) {
   if (generation != sessions_generation_) {
     return;
   }
   CHECK(static_cast<size_t>(session_id) < sessions_.size());
-  auto &query_count = sessions_[session_id].query_count;
-  CHECK(query_count > 0);
-  query_count--;
+  auto &load = sessions_[session_id].loads[static_cast<size_t>(priority)];
+  load -= get_query_weight(query_size);
+  CHECK(load >= 0);
 }
 
 }  // namespace td
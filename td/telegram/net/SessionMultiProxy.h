@@ -11,6 +11,7 @@
 
 #include "td/actor/actor.h"
 
+#include <array>
 #include <memory>
 
 namespace td {
@@ -33,6 +34,8 @@ class SessionMultiProxy final : public Actor {
   void update_options(int32 session_count, bool use_pfs, bool need_destroy_auth_key);
   void update_mtproto_header();
 
+  void warm_up();
+
   void destroy_auth_key();
 
  private:
@@ -47,7 +50,7 @@ class SessionMultiProxy final : public Actor {
   bool need_destroy_auth_key_ = false;
   struct SessionInfo {
     ActorOwn<SessionProxy> proxy;
-    int query_count{0};
+    std::array<int64, NetQuery::PRIORITY_COUNT> loads{};  // total weight of the queries in flight for each priority
   };
   uint32 sessions_generation_{0};
   std::vector<SessionInfo> sessions_;
@@ -57,7 +60,11 @@ class SessionMultiProxy final : public Actor {
 
   bool get_pfs_flag() const;
 
-  void on_query_finished(uint32 generation, int session_id);
+  static int64 get_query_weight(size_t query_size);
+
+  static int64 get_session_load(const SessionInfo &info, NetQuery::Priority priority);
+
+  void on_query_finished(uint32 generation, int session_id, NetQuery::Priority priority, size_t query_size);
 };
 
 }  // namespace td
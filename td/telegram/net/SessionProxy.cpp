@@ -66,6 +66,7 @@ class SessionCallback final : public Session::Callback {
   }
 
   void on_update(BufferSlice &&update, uint64 auth_key_id) final {
+    auto receive_time = Time::now();
     TlBufferParser parser(&update);
     auto updates = telegram_api::Updates::fetch(parser);
     parser.fetch_end();
@@ -73,12 +74,12 @@ class SessionCallback final : public Session::Callback {
       LOG(ERROR) << "Failed to fetch update: " << parser.get_error() << format::as_hex_dump<4>(update.as_slice());
       updates = nullptr;
     }
-    send_closure_later(G()->td(), &Td::on_update, std::move(updates), auth_key_id);
+    send_closure_later(G()->td(), &Td::on_update, std::move(updates), auth_key_id, receive_time);
   }
 
   void on_result(NetQueryPtr query) final {
     if (UniqueId::extract_type(query->id()) != UniqueId::BindKey) {
-      send_closure(parent_, &SessionProxy::on_query_finished);
+      send_closure(parent_, &SessionProxy::on_query_finished, query->priority(), query->query().size());
     }
     G()->net_query_dispatcher().dispatch(std::move(query));
   }
@@ -145,7 +146,7 @@ void SessionProxy::start_up() {
 void SessionProxy::tear_down() {
   for (auto &query : pending_queries_) {
     query->resend();
-    callback_->on_query_finished();
+    callback_->on_query_finished(query->priority(), query->query().size());
     G()->net_query_dispatcher().dispatch(std::move(query));
   }
   pending_queries_.clear();
@@ -185,6 +186,12 @@ void SessionProxy::update_mtproto_header() {
   open_session();
 }
 
+void SessionProxy::warm_up() {
+  // open the session as soon as the authorization is imported, so the first query doesn't wait for the handshake
+  need_warm_up_ = true;
+  open_session();
+}
+
 void SessionProxy::on_closed() {
 }
 
@@ -215,11 +222,12 @@ void SessionProxy::open_session(bool force) {
     if (auth_key_state_ != AuthKeyState::OK) {
       return false;
     }
-    return !pending_queries_.empty();
+    return need_warm_up_ || !pending_queries_.empty();
   }();
   if (!should_open) {
     return;
   }
+  need_warm_up_ = false;
 
   CHECK(session_.empty());
   auto dc_id = auth_data_->dc_id();
@@ -274,8 +282,8 @@ void SessionProxy::on_server_salt_updated(std::vector<mtproto::ServerSalt> serve
   server_salts_ = std::move(server_salts);
 }
 
-void SessionProxy::on_query_finished() {
-  callback_->on_query_finished();
+void SessionProxy::on_query_finished(NetQuery::Priority priority, size_t query_size) {
+  callback_->on_query_finished(priority, query_size);
 }
 
 }  // namespace td
@@ -29,7 +29,7 @@ class SessionProxy final : public Actor {
   class Callback {
    public:
     virtual ~Callback() = default;
-    virtual void on_query_finished() = 0;
+    virtual void on_query_finished(NetQuery::Priority priority, size_t query_size) = 0;
   };
 
   SessionProxy(unique_ptr<Callback> callback, std::shared_ptr<AuthDataShared> shared_auth_data, bool is_primary,
@@ -42,6 +42,8 @@ class SessionProxy final : public Actor {
 
   void update_mtproto_header();
 
+  void warm_up();
+
  private:
   unique_ptr<Callback> callback_;
   std::shared_ptr<AuthDataShared> auth_data_;
@@ -56,6 +58,7 @@ class SessionProxy final : public Actor {
   std::vector<mtproto::ServerSalt> server_salts_;
   bool is_cdn_;
   bool need_destroy_auth_key_;
+  bool need_warm_up_ = false;
   ActorOwn<Session> session_;
   std::vector<NetQueryPtr> pending_queries_;
   uint64 session_generation_ = 1;
@@ -69,7 +72,7 @@ class SessionProxy final : public Actor {
   void on_tmp_auth_key_updated(mtproto::AuthKey auth_key);
   void on_server_salt_updated(std::vector<mtproto::ServerSalt> server_salts);
 
-  void on_query_finished();
+  void on_query_finished(NetQuery::Priority priority, size_t query_size);
 
   string tmp_auth_key_key() const;
 
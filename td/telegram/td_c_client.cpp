@@ -11,6 +11,7 @@
 #include "td/telegram/td_tdc_api_inner.h"
 
 #include <cstring>
+#include <utility>
 
 static td::ClientManager *GetClientManager() {
   return td::ClientManager::get_manager_singleton();
@@ -34,12 +35,70 @@ TdResponse TdCClientReceive(double timeout) {
   return c_response;
 }
 
+int TdCClientReceiveBatch(double timeout, TdResponse *responses, int max_count) {
+  if (responses == nullptr || max_count <= 0) {
+    return 0;
+  }
+  auto received_responses = GetClientManager()->receive_many(static_cast<std::size_t>(max_count), timeout);
+  int count = 0;
+  for (auto &response : received_responses) {
+    auto &c_response = responses[count++];
+    c_response.client_id = response.client_id;
+    c_response.request_id = response.request_id;
+    c_response.object = TdConvertFromInternal(*response.object);
+  }
+  return count;
+}
+
 TdObject *TdCClientExecute(TdFunction *function) {
   auto result = td::ClientManager::execute(TdConvertToInternal(function));
   TdDestroyObjectFunction(function);
   return TdConvertFromInternal(*result);
 }
 
+// handles point directly to the received td_api objects, whose fields are read using the generated getters
+static TdHandle *TdCreateHandle(td::td_api::object_ptr<td::td_api::Object> &&object) {
+  return reinterpret_cast<TdHandle *>(object.release());
+}
+
+TdHandleResponse TdCClientReceiveHandle(double timeout) {
+  auto response = GetClientManager()->receive(timeout);
+  TdHandleResponse c_response;
+  c_response.client_id = response.client_id;
+  c_response.request_id = response.request_id;
+  c_response.object = TdCreateHandle(std::move(response.object));
+  return c_response;
+}
+
+int TdCClientReceiveHandleBatch(double timeout, TdHandleResponse *responses, int max_count) {
+  if (responses == nullptr || max_count <= 0) {
+    return 0;
+  }
+  auto received_responses = GetClientManager()->receive_many(static_cast<std::size_t>(max_count), timeout);
+  int count = 0;
+  for (auto &response : received_responses) {
+    auto &c_response = responses[count++];
+    c_response.client_id = response.client_id;
+    c_response.request_id = response.request_id;
+    c_response.object = TdCreateHandle(std::move(response.object));
+  }
+  return count;
+}
+
+TdHandle *TdCClientExecuteHandle(TdFunction *function) {
+  auto result = td::ClientManager::execute(TdConvertToInternal(function));
+  TdDestroyObjectFunction(function);
+  return TdCreateHandle(std::move(result));
+}
+
+int TdHandleGetId(const TdHandle *handle) {
+  return reinterpret_cast<const td::td_api::Object *>(handle)->get_id();
+}
+
+void TdHandleDestroy(TdHandle *handle) {
+  td::td_api::object_ptr<td::td_api::Object>(reinterpret_cast<td::td_api::Object *>(handle));
+}
+
 TdVectorInt *TdCreateObjectVectorInt(int size, int *data) {
   auto res = new TdVectorInt();
   res->len = size;
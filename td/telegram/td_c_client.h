@@ -34,8 +34,26 @@ void TdCClientSend(int client_id, struct TdRequest request);
 
 struct TdResponse TdCClientReceive(double timeout);
 
+int TdCClientReceiveBatch(double timeout, struct TdResponse *responses, int max_count);
+
 struct TdObject *TdCClientExecute(struct TdFunction *function);
 
+struct TdHandleResponse {
+  long long request_id;
+  int client_id;
+  struct TdHandle *object;
+};
+
+struct TdHandleResponse TdCClientReceiveHandle(double timeout);
+
+int TdCClientReceiveHandleBatch(double timeout, struct TdHandleResponse *responses, int max_count);
+
+struct TdHandle *TdCClientExecuteHandle(struct TdFunction *function);
+
+int TdHandleGetId(const struct TdHandle *handle);
+
+void TdHandleDestroy(struct TdHandle *handle);
+
 #ifdef __cplusplus
 }
 #endif
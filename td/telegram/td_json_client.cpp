@@ -43,6 +43,14 @@ const char *td_receive(double timeout) {
   return td::json_receive(timeout);
 }
 
+int td_receive_batch(double timeout, const char **responses, int max_count) {
+  return td::json_receive_batch(timeout, responses, max_count);
+}
+
+const char *td_receive_binary(double timeout, int *size) {
+  return td::json_receive_binary(timeout, size);
+}
+
 const char *td_execute(const char *request) {
   return td::json_execute(td::Slice(request == nullptr ? "" : request));
 }
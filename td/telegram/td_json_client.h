@@ -76,6 +76,34 @@ TDJSON_EXPORT void td_send(int client_id, const char *request);
  */
 TDJSON_EXPORT const char *td_receive(double timeout);
 
+/**
+ * Receives up to max_count incoming updates and request responses at once. Waits for new data only if there are
+ * no pending responses. Must not be called simultaneously from two different threads.
+ * The returned pointers can be used until the next call to td_receive_batch, after which they will be deallocated by TDLib.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \param[out] responses Array of at least max_count elements, which will receive JSON-serialized null-terminated
+ *                       incoming updates and request responses.
+ * \param[in] max_count The maximum number of responses to receive.
+ * \return The number of received responses, stored at the beginning of the responses array. May be 0 if the timeout expires.
+ */
+TDJSON_EXPORT int td_receive_batch(double timeout, const char **responses, int max_count);
+
+/**
+ * Receives an incoming update or request response serialized in the TL binary format instead of JSON, which is
+ * much cheaper to produce and to parse. Must not be called simultaneously from two different threads and
+ * simultaneously with td_receive or td_receive_batch.
+ * The received data consists of the int32 identifier of the client, the string with the JSON-serialized "@extra" field
+ * of the corresponding request, which is empty for updates and requests without "@extra", and the boxed TDLib API
+ * object. Objects are serialized as described in the TDLib API scheme td_api.tl using constructor identifiers from
+ * the scheme; fields of object types are always serialized together with the constructor identifier, and null objects
+ * are serialized as the constructor identifier 0.
+ * The returned pointer can be used until the next call to td_receive_binary, after which it will be deallocated by TDLib.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \param[out] size Pointer to the variable, which will receive the size of the returned data in bytes. May be NULL.
+ * \return Pointer to the TL-serialized incoming update or request response. May be NULL if the timeout expires.
+ */
+TDJSON_EXPORT const char *td_receive_binary(double timeout, int *size);
+
 /**
  * Synchronously executes a TDLib request.
  * A request can be executed synchronously, only if it is documented with "Can be called synchronously".
@@ -6,6 +6,8 @@
 //
 #pragma once
 
+#include "td/tl/TlObject.h"
+
 #include <jni.h>
 
 #include <cstdint>
@@ -258,5 +260,53 @@ struct FetchVector<std::vector<T>> {
   }
 };
 
+// objects can also be stored to a direct ByteBuffer in native byte order and read by the generated Java code
+// without any JNI calls: numbers are stored as is, Bool as 1 byte, String and Bytes as 4-byte length followed by
+// UTF-8 string or bytes, vectors as 4-byte length followed by elements, and objects as 4-byte constructor identifier,
+// or 0 if the object is null, followed by object fields
+template <class StorerT>
+void store_to_buffer(StorerT &s, bool x) {
+  s.store_binary(static_cast<std::uint8_t>(x));
+}
+
+template <class StorerT>
+void store_to_buffer(StorerT &s, std::int32_t x) {
+  s.store_binary(x);
+}
+
+template <class StorerT>
+void store_to_buffer(StorerT &s, std::int64_t x) {
+  s.store_binary(x);
+}
+
+template <class StorerT>
+void store_to_buffer(StorerT &s, double x) {
+  s.store_binary(x);
+}
+
+template <class StorerT>
+void store_to_buffer(StorerT &s, const std::string &str) {
+  s.store_binary(static_cast<std::int32_t>(str.size()));
+  s.store_slice(str);
+}
+
+template <class StorerT, class T>
+void store_to_buffer(StorerT &s, const tl_object_ptr<T> &object) {
+  if (object == nullptr) {
+    s.store_binary(static_cast<std::int32_t>(0));
+    return;
+  }
+  s.store_binary(object->get_id());
+  object->store(s);
+}
+
+template <class StorerT, class T>
+void store_to_buffer(StorerT &s, const std::vector<T> &v) {
+  s.store_binary(static_cast<std::int32_t>(v.size()));
+  for (const auto &x : v) {
+    store_to_buffer(s, x);
+  }
+}
+
 }  // namespace jni
 }  // namespace td
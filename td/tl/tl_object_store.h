@@ -9,6 +9,7 @@
 #include "td/tl/TlObject.h"
 
 #include "td/utils/misc.h"
+#include "td/utils/Slice.h"
 
 #include <cstdint>
 #include <string>
@@ -36,6 +37,21 @@ class TlStoreBoxedUnknown {
   }
 };
 
+template <class Func>
+class TlStoreBoxedNullable {
+ public:
+  template <class T, class StorerT>
+  static void store(const T &x, StorerT &storer) {
+    if (x == nullptr) {
+      storer.store_binary(static_cast<std::int32_t>(0));
+      return;
+    }
+    const TlObject &object = *x;  // get_id is private in final classes
+    storer.store_binary(object.get_id());
+    Func::store(x, storer);
+  }
+};
+
 class TlStoreBool {
  public:
   template <class StorerT>
@@ -75,6 +91,19 @@ class TlStoreVector {
   }
 };
 
+// values of fixed size are stored contiguously, so the whole vector can be stored at once
+template <>
+class TlStoreVector<TlStoreBinary> {
+ public:
+  template <class T, class StorerT>
+  static void store(const std::vector<T> &vec, StorerT &storer) {
+    storer.store_binary(narrow_cast<int32>(vec.size()));
+    if (!vec.empty()) {
+      storer.store_slice(Slice(reinterpret_cast<const char *>(vec.data()), vec.size() * sizeof(T)));
+    }
+  }
+};
+
 class TlStoreObject {
  public:
   template <class T, class StorerT>
@@ -0,0 +1,204 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/actor/ActorProfiler.h"
+
+#include "td/utils/format.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/port/thread_local.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/StringBuilder.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
+namespace td {
+
+struct ActorProfiler::ThreadState {
+  std::atomic<bool> is_running{false};
+  std::atomic<uint32> pending_sample_count{0};
+  EventScope *current_scope = nullptr;  // accessed only by the owning thread
+
+  std::mutex mutex;
+  std::map<string, uint64> stack_sample_counts;
+};
+
+std::atomic<bool> ActorProfiler::is_enabled_{false};
+
+static TD_THREAD_LOCAL ActorProfiler::ThreadState *current_thread_state;  // static zero-initialized
+
+static std::mutex thread_states_mutex;
+static vector<ActorProfiler::ThreadState *> &get_thread_states() {
+  // thread states are never deleted, because they can be sampled at any time and contain collected samples
+  static auto *thread_states = new vector<ActorProfiler::ThreadState *>();
+  return *thread_states;
+}
+
+class ActorProfilerSampler {
+ public:
+  ActorProfilerSampler() = default;
+  ActorProfilerSampler(const ActorProfilerSampler &) = delete;
+  ActorProfilerSampler &operator=(const ActorProfilerSampler &) = delete;
+  ActorProfilerSampler(ActorProfilerSampler &&) = delete;
+  ActorProfilerSampler &operator=(ActorProfilerSampler &&) = delete;
+  ~ActorProfilerSampler() {
+    stop();
+  }
+
+  void set_sampling_interval(int32 sampling_interval) {
+    stop();
+    if (sampling_interval <= 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopped_ = false;
+    ActorProfiler::is_enabled_.store(true, std::memory_order_relaxed);
+    thread_ = thread([this, sampling_interval] { run(sampling_interval); });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_variable_;
+  bool is_stopped_ = true;
+  thread thread_;
+
+  void stop() {
+    ActorProfiler::is_enabled_.store(false, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_stopped_ = true;
+    }
+    condition_variable_.notify_all();
+    thread_.join();
+  }
+
+  void run(int32 sampling_interval) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!condition_variable_.wait_for(lock, std::chrono::milliseconds(sampling_interval),
+                                         [&] { return is_stopped_; })) {
+      ActorProfiler::take_samples();
+    }
+  }
+};
+
+static ActorProfilerSampler &get_sampler() {
+  static ActorProfilerSampler sampler;
+  return sampler;
+}
+
+void ActorProfiler::EventScope::start(CSlice actor_name, const char *context_tag, uint64 function_address,
+                                      const char *method_name) {
+  thread_state_ = get_thread_state();
+  parent_ = thread_state_->current_scope;
+  if (parent_ != nullptr) {
+    parent_->flush_samples();
+  } else {
+    // drop samples, which could be taken while the previous event was finishing
+    thread_state_->pending_sample_count.store(0, std::memory_order_relaxed);
+  }
+  actor_name_ = actor_name.c_str();
+  context_tag_ = context_tag;
+  function_address_ = function_address;
+  method_name_ = method_name;
+  thread_state_->current_scope = this;
+  thread_state_->is_running.store(true, std::memory_order_relaxed);
+}
+
+void ActorProfiler::EventScope::finish() {
+  flush_samples();
+  thread_state_->current_scope = parent_;
+  if (parent_ == nullptr) {
+    thread_state_->is_running.store(false, std::memory_order_relaxed);
+  }
+}
+
+void ActorProfiler::EventScope::flush_samples() {
+  auto sample_count = thread_state_->pending_sample_count.exchange(0, std::memory_order_relaxed);
+  if (sample_count == 0) {
+    return;
+  }
+
+  string stack;
+  append_stack(stack);
+  std::lock_guard<std::mutex> lock(thread_state_->mutex);
+  thread_state_->stack_sample_counts[stack] += sample_count;
+}
+
+void ActorProfiler::EventScope::append_stack(string &stack) const {
+  auto append_frame = [&stack](Slice frame) {
+    if (!stack.empty()) {
+      stack += ';';
+    }
+    for (auto c : frame) {
+      // ';' separates frames and a stack must fit in one line
+      stack += c == ';' || c == '\n' ? '_' : c;
+    }
+  };
+
+  if (parent_ != nullptr) {
+    parent_->append_stack(stack);
+  } else if (context_tag_ != nullptr && context_tag_[0] != '\0') {
+    append_frame(PSLICE() << "client " << context_tag_);
+  } else {
+    append_frame("[no client]");
+  }
+  append_frame(CSlice(actor_name_));
+  if (function_address_ != 0) {
+    append_frame(PSLICE() << format::as_hex(function_address_));
+  } else {
+    append_frame(CSlice(method_name_ == nullptr ? "[unknown]" : method_name_));
+  }
+}
+
+void ActorProfiler::set_sampling_interval(int32 sampling_interval) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  get_sampler().set_sampling_interval(sampling_interval);
+}
+
+string ActorProfiler::get_folded_stacks(bool reset) {
+  std::map<string, uint64> stack_sample_counts;
+  {
+    std::lock_guard<std::mutex> lock(thread_states_mutex);
+    for (auto *thread_state : get_thread_states()) {
+      std::lock_guard<std::mutex> thread_lock(thread_state->mutex);
+      for (auto &it : thread_state->stack_sample_counts) {
+        stack_sample_counts[it.first] += it.second;
+      }
+      if (reset) {
+        thread_state->stack_sample_counts.clear();
+      }
+    }
+  }
+
+  string result;
+  for (auto &it : stack_sample_counts) {
+    result += PSTRING() << it.first << ' ' << it.second << '\n';
+  }
+  return result;
+}
+
+ActorProfiler::ThreadState *ActorProfiler::get_thread_state() {
+  if (current_thread_state == nullptr) {
+    current_thread_state = new ThreadState();
+    std::lock_guard<std::mutex> lock(thread_states_mutex);
+    get_thread_states().push_back(current_thread_state);
+  }
+  return current_thread_state;
+}
+
+void ActorProfiler::take_samples() {
+  std::lock_guard<std::mutex> lock(thread_states_mutex);
+  for (auto *thread_state : get_thread_states()) {
+    if (thread_state->is_running.load(std::memory_order_relaxed)) {
+      thread_state->pending_sample_count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace td
@@ -0,0 +1,86 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace td {
+
+// process-wide sampling profiler of events processed by actors
+// a separate thread periodically marks threads, which are running an event, and the samples are attributed to
+// the context tag of the actor, which is the client identifier for actors of TDLib instances, the actor name and
+// the called method; the result is returned as folded stacks, suitable for flame graph generation
+class ActorProfiler {
+ public:
+  struct ThreadState;
+
+  class EventScope {
+   public:
+    EventScope() = default;
+    EventScope(const EventScope &) = delete;
+    EventScope &operator=(const EventScope &) = delete;
+    EventScope(EventScope &&) = delete;
+    EventScope &operator=(EventScope &&) = delete;
+    ~EventScope() {
+      if (thread_state_ != nullptr) {
+        finish();
+      }
+    }
+
+    // all strings must be valid until the scope is destroyed;
+    // method_name is used if the function address is unknown
+    void start(CSlice actor_name, const char *context_tag, uint64 function_address, const char *method_name);
+
+   private:
+    ThreadState *thread_state_ = nullptr;
+    EventScope *parent_ = nullptr;
+    const char *actor_name_ = nullptr;
+    const char *context_tag_ = nullptr;
+    uint64 function_address_ = 0;
+    const char *method_name_ = nullptr;
+
+    void finish();
+
+    void flush_samples();
+
+    void append_stack(string &stack) const;
+  };
+
+  static bool is_enabled() {
+    return is_enabled_.load(std::memory_order_relaxed);
+  }
+
+  // sampling_interval is in milliseconds; 0 disables the profiler
+  static void set_sampling_interval(int32 sampling_interval);
+
+  // returns collected samples in the folded stacks format, i.e., a line "frame;frame;frame sample_count" per stack;
+  // methods are identified by their addresses in the current process
+  static string get_folded_stacks(bool reset);
+
+  template <class FunctionT>
+  static uint64 get_function_address(const FunctionT &function) {
+    static_assert(sizeof(FunctionT) >= sizeof(uintptr_t), "");
+    uintptr_t address;
+    std::memcpy(&address, &function, sizeof(address));
+    return static_cast<uint64>(address);
+  }
+
+ private:
+  static std::atomic<bool> is_enabled_;
+
+  static ThreadState *get_thread_state();
+
+  static void take_samples();
+
+  friend class ActorProfilerSampler;
+};
+
+}  // namespace td
@@ -0,0 +1,127 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/actor/ActorStats.h"
+
+#include "td/utils/FlatHashMap.h"
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/Time.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace td {
+
+std::atomic<bool> ActorStats::is_enabled_{false};
+
+static std::atomic<double> log_period{0.0};
+static std::atomic<double> next_log_time{0.0};
+
+static std::mutex entries_mutex;
+static FlatHashMap<string, unique_ptr<ActorStats::Entry>> &get_entries() {
+  // entries are never deleted, because they are referenced by actors
+  static auto *entries = new FlatHashMap<string, unique_ptr<ActorStats::Entry>>();
+  return *entries;
+}
+
+static void update_max(std::atomic<uint64> &max_value, uint64 value) {
+  auto old_value = max_value.load(std::memory_order_relaxed);
+  while (old_value < value && !max_value.compare_exchange_weak(old_value, value, std::memory_order_relaxed)) {
+  }
+}
+
+static uint64 to_nanoseconds(double time) {
+  return time <= 0 ? 0 : static_cast<uint64>(time * 1e9);
+}
+
+static double from_nanoseconds(uint64 time) {
+  return static_cast<double>(time) * 1e-9;
+}
+
+void ActorStats::Entry::on_event(double run_time) {
+  auto run_time_ns = to_nanoseconds(run_time);
+  event_count_.fetch_add(1, std::memory_order_relaxed);
+  run_time_ns_.fetch_add(run_time_ns, std::memory_order_relaxed);
+  update_max(max_event_run_time_ns_, run_time_ns);
+}
+
+void ActorStats::Entry::on_mailbox_size(size_t mailbox_size) {
+  update_max(max_mailbox_size_, static_cast<uint64>(mailbox_size));
+}
+
+void ActorStats::set_enabled(bool is_enabled) {
+  is_enabled_.store(is_enabled, std::memory_order_relaxed);
+}
+
+void ActorStats::set_log_period(double new_log_period) {
+  log_period.store(max(new_log_period, 0.0), std::memory_order_relaxed);
+  next_log_time.store(Time::now() + new_log_period, std::memory_order_relaxed);
+}
+
+ActorStats::Entry *ActorStats::get_entry(Slice actor_name) {
+  if (!is_enabled()) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(entries_mutex);
+  auto &entry = get_entries()[actor_name.str()];
+  if (entry == nullptr) {
+    entry = make_unique<Entry>(actor_name);
+  }
+  return entry.get();
+}
+
+vector<ActorStats::Statistics> ActorStats::get_statistics(bool reset) {
+  vector<Statistics> result;
+  {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    for (auto &it : get_entries()) {
+      auto &entry = *it.second;
+      auto load = [reset](std::atomic<uint64> &value) {
+        return reset ? value.exchange(0, std::memory_order_relaxed) : value.load(std::memory_order_relaxed);
+      };
+      Statistics statistics;
+      statistics.event_count = load(entry.event_count_);
+      if (statistics.event_count == 0) {
+        continue;
+      }
+      statistics.name = entry.name_;
+      statistics.run_time = from_nanoseconds(load(entry.run_time_ns_));
+      statistics.max_event_run_time = from_nanoseconds(load(entry.max_event_run_time_ns_));
+      statistics.max_mailbox_size = load(entry.max_mailbox_size_);
+      result.push_back(std::move(statistics));
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const Statistics &lhs, const Statistics &rhs) { return lhs.run_time > rhs.run_time; });
+  return result;
+}
+
+void ActorStats::log_statistics_if_needed(double now) {
+  auto period = log_period.load(std::memory_order_relaxed);
+  if (period <= 0) {
+    return;
+  }
+  auto log_time = next_log_time.load(std::memory_order_relaxed);
+  if (now < log_time || !next_log_time.compare_exchange_strong(log_time, now + period, std::memory_order_relaxed)) {
+    return;
+  }
+
+  constexpr size_t MAX_LOGGED_ACTORS = 20;
+  auto statistics = get_statistics(false);
+  if (statistics.size() > MAX_LOGGED_ACTORS) {
+    statistics.resize(MAX_LOGGED_ACTORS);
+  }
+  for (auto &actor_statistics : statistics) {
+    LOG(WARNING) << "Actor " << actor_statistics.name << ": processed " << actor_statistics.event_count
+                 << " events in " << format::as_time(actor_statistics.run_time) << ", max event run time is "
+                 << format::as_time(actor_statistics.max_event_run_time) << ", max mailbox size is "
+                 << actor_statistics.max_mailbox_size;
+  }
+}
+
+}  // namespace td
@@ -0,0 +1,92 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+#include "td/utils/Time.h"
+
+#include <atomic>
+
+namespace td {
+
+// process-wide statistics about events processed by actors, grouped by actor name
+// statistics are collected only for actors created while the collection is enabled
+class ActorStats {
+ public:
+  class Entry {
+   public:
+    explicit Entry(Slice name) : name_(name.str()) {
+    }
+
+    void on_event(double run_time);
+
+    void on_mailbox_size(size_t mailbox_size);
+
+   private:
+    friend class ActorStats;
+
+    string name_;
+    std::atomic<uint64> event_count_{0};
+    std::atomic<uint64> run_time_ns_{0};
+    std::atomic<uint64> max_event_run_time_ns_{0};
+    std::atomic<uint64> max_mailbox_size_{0};
+  };
+
+  struct Statistics {
+    string name;
+    uint64 event_count = 0;
+    double run_time = 0.0;
+    double max_event_run_time = 0.0;
+    uint64 max_mailbox_size = 0;
+  };
+
+  class EventTimer {
+   public:
+    explicit EventTimer(Entry *entry) {
+      if (entry != nullptr && is_enabled()) {
+        entry_ = entry;
+        start_time_ = Time::now();
+      }
+    }
+    EventTimer(const EventTimer &) = delete;
+    EventTimer &operator=(const EventTimer &) = delete;
+    EventTimer(EventTimer &&) = delete;
+    EventTimer &operator=(EventTimer &&) = delete;
+    ~EventTimer() {
+      if (entry_ != nullptr) {
+        entry_->on_event(Time::now() - start_time_);
+      }
+    }
+
+   private:
+    Entry *entry_ = nullptr;
+    double start_time_ = 0.0;
+  };
+
+  static void set_enabled(bool is_enabled);
+
+  static bool is_enabled() {
+    return is_enabled_.load(std::memory_order_relaxed);
+  }
+
+  // statistics are written to the log every log_period seconds; 0 disables logging
+  static void set_log_period(double log_period);
+
+  // returns nullptr if statistics collection is disabled
+  static Entry *get_entry(Slice actor_name);
+
+  // returns statistics sorted by total run time in descending order
+  static vector<Statistics> get_statistics(bool reset);
+
+  static void log_statistics_if_needed(double now);
+
+ private:
+  static std::atomic<bool> is_enabled_;
+};
+
+}  // namespace td
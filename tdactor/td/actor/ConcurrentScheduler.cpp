@@ -70,6 +70,32 @@ void ConcurrentScheduler::test_one_thread_run() {
   } while (!is_finished_.load(std::memory_order_relaxed));
 }
 
+void ConcurrentScheduler::enable_work_stealing() {
+  CHECK(state_ == State::Start);
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  // the extra scheduler isn't known to other schedulers and can't receive actors
+  auto sched_count = static_cast<int32>(schedulers_.size()) - extra_scheduler_;
+  auto idle_schedulers = std::make_shared<Scheduler::IdleSchedulers>(sched_count);
+  for (int32 i = 0; i < sched_count; i++) {
+    schedulers_[i]->set_idle_schedulers(idle_schedulers);
+  }
+#endif
+}
+
+void ConcurrentScheduler::enable_outbound_event_batching() {
+  CHECK(state_ == State::Start);
+  for (auto &scheduler : schedulers_) {
+    scheduler->enable_outbound_event_batching();
+  }
+}
+
+void ConcurrentScheduler::set_busy_poll_time(double busy_poll_time) {
+  CHECK(state_ == State::Start);
+  for (auto &scheduler : schedulers_) {
+    scheduler->set_busy_poll_time(busy_poll_time);
+  }
+}
+
 #if !TD_THREAD_UNSUPPORTED
 thread::id ConcurrentScheduler::get_scheduler_thread_id(int32 sched_id) {
   auto thread_pos = static_cast<size_t>(sched_id - 1);
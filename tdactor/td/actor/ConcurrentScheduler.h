@@ -46,6 +46,18 @@ class ConcurrentScheduler final : private Scheduler::Callback {
 
   void test_one_thread_run();
 
+  // allows schedulers to move migratable actors to idle schedulers; must be called before start
+  void enable_work_stealing();
+
+  // makes schedulers send events to other schedulers in batches once per run iteration instead of one by one;
+  // event handlers must not block waiting for other schedulers; must be called before start
+  void enable_outbound_event_batching();
+
+  // makes schedulers check for new events without blocking for the given time in seconds before waiting for them;
+  // reduces event delivery latency at the cost of CPU usage and is useful only if each scheduler has a dedicated core;
+  // must be called before start
+  void set_busy_poll_time(double busy_poll_time);
+
   bool is_finished() const {
     return is_finished_.load(std::memory_order_relaxed);
   }
@@ -11,13 +11,13 @@
 namespace td {
 
 bool MultiTimeout::has_timeout(int64 key) const {
-  return items_.count(Item(key)) > 0;
+  return items_.count(key) > 0;
 }
 
 void MultiTimeout::set_timeout_at(int64 key, double timeout) {
   LOG(DEBUG) << "Set " << get_name() << " for " << key << " in " << timeout - Time::now();
-  auto item = items_.emplace(key);
-  auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item.first));
+  auto item = items_.emplace(key, Item(key));
+  auto heap_node = static_cast<HeapNode *>(&item.first->second);
   if (heap_node->in_heap()) {
     CHECK(!item.second);
     bool need_update_timeout = heap_node->is_top();
@@ -36,8 +36,8 @@ void MultiTimeout::set_timeout_at(int64 key, double timeout) {
 
 void MultiTimeout::add_timeout_at(int64 key, double timeout) {
   LOG(DEBUG) << "Add " << get_name() << " for " << key << " in " << timeout - Time::now();
-  auto item = items_.emplace(key);
-  auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item.first));
+  auto item = items_.emplace(key, Item(key));
+  auto heap_node = static_cast<HeapNode *>(&item.first->second);
   if (heap_node->in_heap()) {
     CHECK(!item.second);
   } else {
@@ -51,9 +51,9 @@ void MultiTimeout::add_timeout_at(int64 key, double timeout) {
 
 void MultiTimeout::cancel_timeout(int64 key, const char *source) {
   LOG(DEBUG) << "Cancel " << get_name() << " for " << key;
-  auto item = items_.find(Item(key));
+  auto item = items_.find(key);
   if (item != items_.end()) {
-    auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item));
+    auto heap_node = static_cast<HeapNode *>(&item->second);
     CHECK(heap_node->in_heap());
     bool need_update_timeout = heap_node->is_top();
     timeout_queue_.erase(heap_node);
@@ -90,7 +90,7 @@ vector<int64> MultiTimeout::get_expired_keys(double now) {
   vector<int64> expired_keys;
   while (!timeout_queue_.empty() && timeout_queue_.top_key() < now) {
     int64 key = static_cast<Item *>(timeout_queue_.pop())->key;
-    items_.erase(Item(key));
+    items_.erase(key);
     expired_keys.push_back(key);
   }
   return expired_keys;
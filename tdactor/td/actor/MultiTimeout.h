@@ -9,11 +9,12 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/common.h"
+#include "td/utils/HashTableUtils.h"
 #include "td/utils/Heap.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Time.h"
 
-#include <set>
+#include <unordered_map>
 
 namespace td {
 
@@ -24,10 +25,6 @@ class MultiTimeout final : public Actor {
 
     explicit Item(int64 key) : key(key) {
     }
-
-    bool operator<(const Item &other) const {
-      return key < other.key;
-    }
   };
 
  public:
@@ -69,7 +66,8 @@ class MultiTimeout final : public Actor {
   Data data_;
 
   KHeap<double> timeout_queue_;
-  std::set<Item> items_;
+  // node-based map is used, because timeout_queue_ references the items
+  std::unordered_map<int64, Item, Hash<int64>> items_;
 
   void update_timeout(const char *source);
 
@@ -75,6 +75,10 @@ class Actor : public ObserverBase {
   void migrate(int32 sched_id);
   void do_migrate(int32 sched_id);
 
+  // allows the scheduler to move the actor with pending events and without timeout to an idle scheduler
+  // the actor must not own pollable file descriptors
+  void set_migratable(bool is_migratable);
+
   uint64 get_link_token();
   std::weak_ptr<ActorContext> get_context_weak_ptr() const;
   std::shared_ptr<ActorContext> set_context(std::shared_ptr<ActorContext> context);
@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/actor/ActorStats.h"
 #include "td/actor/impl/ActorId-decl.h"
 #include "td/actor/impl/Event.h"
 
@@ -108,14 +109,24 @@ class ActorInfo final
   bool need_context() const;
   bool need_start_up() const;
 
+  void set_migratable(bool is_migratable);
+  bool is_migratable() const;
+
+  ActorStats::Entry *get_stats_entry() const;
+
+  int32 get_allocation_tag() const;
+
  private:
   Deleter deleter_ = Deleter::None;
   bool need_context_ = true;
   bool need_start_up_ = true;
   bool is_running_ = false;
+  bool is_migratable_ = false;
 
   std::atomic<int32> sched_id_{0};
   Actor *actor_ = nullptr;
+  ActorStats::Entry *stats_entry_ = nullptr;
+  int32 allocation_tag_ = 0;
 
 #ifdef TD_DEBUG
   string name_;
@@ -10,6 +10,7 @@
 #include "td/actor/impl/ActorInfo-decl.h"
 #include "td/actor/impl/Scheduler-decl.h"
 
+#include "td/utils/AllocationTag.h"
 #include "td/utils/common.h"
 #include "td/utils/Heap.h"
 #include "td/utils/List.h"
@@ -36,6 +37,8 @@ inline void ActorInfo::init(int32 sched_id, Slice name, ObjectPool<ActorInfo>::O
   CHECK(!is_migrating());
   sched_id_.store(sched_id, std::memory_order_relaxed);
   actor_ = actor_ptr;
+  stats_entry_ = ActorStats::get_entry(name);
+  allocation_tag_ = AllocationTag::get_tag(name);
 
   if (need_context) {
     context_ = Scheduler::context()->this_ptr_.lock();
@@ -50,6 +53,7 @@ inline void ActorInfo::init(int32 sched_id, Slice name, ObjectPool<ActorInfo>::O
   need_context_ = need_context;
   need_start_up_ = need_start_up;
   is_running_ = false;
+  is_migratable_ = false;
 }
 
 inline bool ActorInfo::need_context() const {
@@ -60,6 +64,22 @@ inline bool ActorInfo::need_start_up() const {
   return need_start_up_;
 }
 
+inline void ActorInfo::set_migratable(bool is_migratable) {
+  is_migratable_ = is_migratable;
+}
+
+inline bool ActorInfo::is_migratable() const {
+  return is_migratable_;
+}
+
+inline ActorStats::Entry *ActorInfo::get_stats_entry() const {
+  return stats_entry_;
+}
+
+inline int32 ActorInfo::get_allocation_tag() const {
+  return allocation_tag_;
+}
+
 inline void ActorInfo::on_actor_moved(Actor *actor_new_ptr) {
   actor_ = actor_new_ptr;
 }
@@ -6,6 +6,8 @@
 //
 #pragma once
 
+#include "td/actor/ActorProfiler.h"
+
 #include "td/utils/Closure.h"
 #include "td/utils/common.h"
 #include "td/utils/StringBuilder.h"
@@ -52,6 +54,10 @@ class CustomEvent {
   }
   virtual void finish_migrate() {
   }
+  // returns address of the called method or 0 if unknown
+  virtual uint64 get_function_address() const {
+    return 0;
+  }
 };
 
 template <class ClosureT>
@@ -78,6 +84,10 @@ class ClosureEvent final : public CustomEvent {
     });
   }
 
+  uint64 get_function_address() const final {
+    return ActorProfiler::get_function_address(closure_.get_function());
+  }
+
  private:
   ClosureT closure_;
 };
@@ -28,6 +28,7 @@
 #include "td/utils/Time.h"
 #include "td/utils/type_traits.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -69,6 +70,27 @@ class Scheduler {
     virtual void on_finish() = 0;
     virtual void register_at_finish(std::function<void()>) = 0;
   };
+
+  // shared between schedulers, which are allowed to take over migratable actors from each other
+  class IdleSchedulers {
+   public:
+    explicit IdleSchedulers(int32 sched_count) : is_idle_(static_cast<size_t>(sched_count)) {
+    }
+
+    bool is_member(int32 sched_id) const {
+      return 0 <= sched_id && static_cast<size_t>(sched_id) < is_idle_.size();
+    }
+
+    void set_idle(int32 sched_id, bool is_idle) {
+      is_idle_[sched_id].store(is_idle, std::memory_order_release);
+    }
+
+    // returns identifier of an idle scheduler, which is no longer considered idle, or -1
+    int32 acquire(int32 current_sched_id);
+
+   private:
+    vector<std::atomic<bool>> is_idle_;
+  };
   Scheduler() = default;
   Scheduler(const Scheduler &) = delete;
   Scheduler &operator=(const Scheduler &) = delete;
@@ -78,6 +100,14 @@ class Scheduler {
 
   void init(int32 id, std::vector<std::shared_ptr<MpscPollableQueue<EventFull>>> outbound, Callback *callback);
 
+  void set_idle_schedulers(std::shared_ptr<IdleSchedulers> idle_schedulers);
+
+  // events sent to other schedulers while running events are delivered in batches once per run iteration
+  void enable_outbound_event_batching();
+
+  // the scheduler polls without blocking for the given time before waiting for new events
+  void set_busy_poll_time(double busy_poll_time);
+
   int32 sched_id() const;
   int32 sched_count() const;
 
@@ -182,6 +212,8 @@ class Scheduler {
 
   void do_event(ActorInfo *actor, Event &&event);
 
+  static const char *get_context_tag();
+
   void enter_actor(ActorInfo *actor_info);
   void exit_actor(ActorInfo *actor_info);
 
@@ -212,7 +244,10 @@ class Scheduler {
 
   void send_later_impl(const ActorId<> &actor_id, Event &&event);
 
+  void flush_outbound_events();
+
   Timestamp run_timeout();
+  void share_ready_actors(ListNode &actors_list);
   void run_mailbox();
   Timestamp run_events(Timestamp timeout);
   void run_poll(Timestamp timeout);
@@ -245,6 +280,13 @@ class Scheduler {
   int32 sched_n_ = 0;
   std::shared_ptr<MpscPollableQueue<EventFull>> inbound_queue_;
   std::vector<std::shared_ptr<MpscPollableQueue<EventFull>>> outbound_queues_;
+  std::shared_ptr<IdleSchedulers> idle_schedulers_;
+
+  bool is_outbound_event_batching_enabled_ = false;
+  bool is_outbound_event_batching_active_ = false;
+  std::vector<std::vector<EventFull>> outbound_events_;
+
+  double busy_poll_time_ = 0.0;
 
   std::shared_ptr<ActorContext> save_context_;
 
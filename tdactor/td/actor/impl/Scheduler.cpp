@@ -6,6 +6,8 @@
 //
 #include "td/actor/impl/Scheduler.h"
 
+#include "td/actor/ActorProfiler.h"
+#include "td/actor/ActorStats.h"
 #include "td/actor/impl/Actor.h"
 #include "td/actor/impl/ActorId.h"
 #include "td/actor/impl/ActorInfo.h"
@@ -13,6 +15,7 @@
 #include "td/actor/impl/EventFull.h"
 
 #include "td/utils/algorithm.h"
+#include "td/utils/AllocationTag.h"
 #include "td/utils/common.h"
 #include "td/utils/ExitGuard.h"
 #include "td/utils/format.h"
@@ -233,6 +236,37 @@ void Scheduler::init(int32 id, std::vector<std::shared_ptr<MpscPollableQueue<Eve
   register_actor(PSLICE() << "ServiceActor" << id, &service_actor_).release();
 }
 
+void Scheduler::set_idle_schedulers(std::shared_ptr<IdleSchedulers> idle_schedulers) {
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  if (idle_schedulers != nullptr && idle_schedulers->is_member(sched_id_)) {
+    idle_schedulers_ = std::move(idle_schedulers);
+  }
+#endif
+}
+
+void Scheduler::enable_outbound_event_batching() {
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  is_outbound_event_batching_enabled_ = true;
+  outbound_events_.resize(outbound_queues_.size());
+#endif
+}
+
+void Scheduler::set_busy_poll_time(double busy_poll_time) {
+  busy_poll_time_ = max(busy_poll_time, 0.0);
+}
+
+int32 Scheduler::IdleSchedulers::acquire(int32 current_sched_id) {
+  auto sched_count = static_cast<int32>(is_idle_.size());
+  for (int32 i = 1; i < sched_count; i++) {
+    auto sched_id = (current_sched_id + i) % sched_count;
+    auto &is_idle = is_idle_[sched_id];
+    if (is_idle.load(std::memory_order_relaxed) && is_idle.exchange(false, std::memory_order_acq_rel)) {
+      return sched_id;
+    }
+  }
+  return -1;
+}
+
 void Scheduler::clear() {
   if (service_actor_.empty()) {
     return;
@@ -263,10 +297,39 @@ void Scheduler::clear() {
   }
 }
 
+static const char *get_event_method_name(Event::Type type) {
+  switch (type) {
+    case Event::Type::Start:
+      return "start_up";
+    case Event::Type::Stop:
+      return "tear_down";
+    case Event::Type::Yield:
+      return "wakeup";
+    case Event::Type::Hangup:
+      return "hangup";
+    case Event::Type::Timeout:
+      return "timeout_expired";
+    case Event::Type::Raw:
+      return "raw_event";
+    case Event::Type::Custom:
+      return "lambda";
+    default:
+      return nullptr;
+  }
+}
+
 void Scheduler::do_event(ActorInfo *actor_info, Event &&event) {
   event_context_ptr_->link_token = event.link_token;
   auto actor = actor_info->get_actor_unsafe();
   VLOG(actor) << *actor_info << ' ' << event;
+  ActorStats::EventTimer event_timer(actor_info->get_stats_entry());
+  AllocationTagGuard allocation_tag_guard(actor_info->get_allocation_tag());
+  ActorProfiler::EventScope profiler_scope;
+  if (ActorProfiler::is_enabled()) {
+    profiler_scope.start(actor_info->get_name(), get_context_tag(),
+                         event.type == Event::Type::Custom ? event.data.custom_event->get_function_address() : 0,
+                         get_event_method_name(event.type));
+  }
   switch (event.type) {
     case Event::Type::Start:
       actor->start_up();
@@ -363,11 +426,25 @@ void Scheduler::send_to_other_scheduler(int32 sched_id, const ActorId<> &actor_i
       VLOG(actor) << "Send to scheduler " << sched_id << ": " << event;
     }
     start_migrate(event, sched_id);
+    if (is_outbound_event_batching_active_) {
+      outbound_events_[sched_id].push_back(EventCreator::event_unsafe(actor_id, std::move(event)));
+      return;
+    }
     outbound_queues_[sched_id]->writer_put(EventCreator::event_unsafe(actor_id, std::move(event)));
     outbound_queues_[sched_id]->writer_flush();
   }
 }
 
+void Scheduler::flush_outbound_events() {
+  for (size_t sched_id = 0; sched_id < outbound_events_.size(); sched_id++) {
+    auto &events = outbound_events_[sched_id];
+    if (!events.empty()) {
+      outbound_queues_[sched_id]->writer_put_all(events);
+      outbound_queues_[sched_id]->writer_flush();
+    }
+  }
+}
+
 void Scheduler::run_on_scheduler(int32 sched_id, Promise<Unit> action) {
   if (sched_id >= 0 && sched_id_ != sched_id) {
     class Worker final : public Actor {
@@ -413,6 +490,10 @@ void Scheduler::add_to_mailbox(ActorInfo *actor_info, Event &&event) {
   }
   VLOG(actor) << "Add to mailbox: " << *actor_info << " " << event;
   actor_info->mailbox_.push_back(std::move(event));
+  auto stats_entry = actor_info->get_stats_entry();
+  if (stats_entry != nullptr) {
+    stats_entry->on_mailbox_size(actor_info->mailbox_.size());
+  }
 }
 
 void Scheduler::do_stop_actor(Actor *actor) {
@@ -510,8 +591,22 @@ void Scheduler::set_actor_timeout_at(ActorInfo *actor_info, double timeout_at) {
 }
 
 void Scheduler::run_poll(Timestamp timeout) {
-  // we can't wait for less than 1ms
-  auto timeout_ms = static_cast<int>(clamp(timeout.in(), 0.0, 1000000.0) * 1000 + 1);
+#if TD_PORT_POSIX
+  if (busy_poll_time_ > 0.0) {
+    // spin for a while to avoid a costly wakeup of a sleeping thread if new events arrive soon
+    auto busy_poll_timeout = Timestamp::in(busy_poll_time_, Timestamp::now());
+    busy_poll_timeout.relax(timeout);
+    do {
+      poll_.run(0);
+      if (!pending_events_.empty() || !ready_actors_list_.empty()) {
+        return;
+      }
+    } while (!busy_poll_timeout.is_in_past(Timestamp::now()));
+  }
+#endif
+
+  // we can't wait for less than 1ms, but there is no need to wait at all if the timeout has already expired
+  auto timeout_ms = timeout.is_in_past() ? 0 : static_cast<int>(clamp(timeout.in(), 0.0, 1000000.0) * 1000 + 1);
 #if TD_PORT_WINDOWS
   CHECK(inbound_queue_);
   inbound_queue_->reader_get_event_fd().wait(timeout_ms);
@@ -533,9 +628,31 @@ void Scheduler::flush_mailbox(ActorInfo *actor_info) {
   mailbox.erase(mailbox.begin(), mailbox.begin() + i);
 }
 
+void Scheduler::share_ready_actors(ListNode &actors_list) {
+  // the first ready actor is always left on the current scheduler
+  ListNode *end = &actors_list;
+  ListNode *node = actors_list.prev->prev;
+  while (node != end) {
+    auto actor_info = ActorInfo::from_list_node(node);
+    node = node->prev;
+    if (!actor_info->is_migratable() || actor_info->get_heap_node()->in_heap()) {
+      continue;
+    }
+    auto dest_sched_id = idle_schedulers_->acquire(sched_id_);
+    if (dest_sched_id == -1) {
+      break;
+    }
+    VLOG(actor) << "Share actor " << *actor_info << " with idle scheduler " << dest_sched_id;
+    do_migrate_actor(actor_info, dest_sched_id);
+  }
+}
+
 void Scheduler::run_mailbox() {
   VLOG(actor) << "Run mailbox : begin";
   ListNode actors_list = std::move(ready_actors_list_);
+  if (idle_schedulers_ != nullptr) {
+    share_ready_actors(actors_list);
+  }
   while (!actors_list.empty()) {
     ListNode *node = actors_list.get();
     CHECK(node);
@@ -577,10 +694,15 @@ Timestamp Scheduler::run_events(Timestamp timeout) {
   Timestamp res;
   VLOG(actor) << "Run events " << sched_id_ << " " << tag("pending", pending_events_.size())
               << tag("actors", actor_count_);
+  is_outbound_event_batching_active_ = is_outbound_event_batching_enabled_;
   do {
     run_mailbox();
     res = run_timeout();
+    if (is_outbound_event_batching_active_) {
+      flush_outbound_events();
+    }
   } while (!ready_actors_list_.empty() && !timeout.is_in_past());
+  is_outbound_event_batching_active_ = false;
   return res;
 }
 
@@ -594,8 +716,18 @@ void Scheduler::run_no_guard(Timestamp timeout) {
   if (yield_flag_) {
     return;
   }
+  bool is_idle = idle_schedulers_ != nullptr && ready_actors_list_.empty();
+  if (is_idle) {
+    idle_schedulers_->set_idle(sched_id_, true);
+  }
   run_poll(timeout);
+  if (is_idle) {
+    idle_schedulers_->set_idle(sched_id_, false);
+  }
   run_events(timeout);
+  if (ActorStats::is_enabled()) {
+    ActorStats::log_statistics_if_needed(Time::now_cached());
+  }
 }
 
 Timestamp Scheduler::get_timeout() {
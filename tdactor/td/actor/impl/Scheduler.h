@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/actor/ActorProfiler.h"
 #include "td/actor/impl/ActorInfo-decl.h"
 #include "td/actor/impl/Scheduler-decl.h"
 
@@ -209,6 +210,10 @@ void Scheduler::send_lambda_immediately(ActorRef actor_ref, EventT &&func) {
       actor_ref.get(),
       [&](ActorInfo *actor_info) {
         event_context_ptr_->link_token = actor_ref.token();
+        ActorProfiler::EventScope profiler_scope;
+        if (ActorProfiler::is_enabled()) {
+          profiler_scope.start(actor_info->get_name(), get_context_tag(), 0, "lambda");
+        }
         func();
       },
       [&] {
@@ -231,6 +236,11 @@ void Scheduler::send_closure_immediately(ActorRef actor_ref, EventT &&closure) {
       actor_ref.get(),
       [&](ActorInfo *actor_info) {
         event_context_ptr_->link_token = actor_ref.token();
+        ActorProfiler::EventScope profiler_scope;
+        if (ActorProfiler::is_enabled()) {
+          profiler_scope.start(actor_info->get_name(), get_context_tag(),
+                               ActorProfiler::get_function_address(closure.get_function()), nullptr);
+        }
         closure.run(static_cast<typename EventT::ActorType *>(actor_info->get_actor_unsafe()));
       },
       [&] {
@@ -294,6 +304,11 @@ inline uint64 Scheduler::get_link_token(ActorInfo *actor_info) {
   return event_context_ptr_->link_token;
 }
 
+inline const char *Scheduler::get_context_tag() {
+  auto *context = Scheduler::context();
+  return context == nullptr ? nullptr : context->tag_;
+}
+
 inline void Scheduler::finish_migrate_actor(Actor *actor) {
   register_migrated_actor(actor->get_info());
 }
@@ -5,12 +5,15 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 #include "td/actor/actor.h"
+#include "td/actor/ActorProfiler.h"
+#include "td/actor/ActorStats.h"
 #include "td/actor/ConcurrentScheduler.h"
 #include "td/actor/MultiPromise.h"
 #include "td/actor/PromiseFuture.h"
 #include "td/actor/SleepActor.h"
 
 #include "td/utils/common.h"
+#include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/MpscPollableQueue.h"
 #include "td/utils/Observer.h"
@@ -19,6 +22,7 @@
 #include "td/utils/port/thread.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/tests.h"
@@ -680,3 +684,97 @@ TEST(Actors, MultiPromiseSendClosureLater) {
   }
   scheduler.finish();
 }
+
+class ActorStatsReceiver final : public td::Actor {
+ public:
+  void on_event() {
+    received_event_count_++;
+  }
+
+  void finish() {
+    CHECK(received_event_count_ == 10);
+    td::Scheduler::instance()->finish();
+    stop();
+  }
+
+ private:
+  int received_event_count_ = 0;
+};
+
+class ActorStatsSender final : public td::Actor {
+  void start_up() final {
+    auto receiver = td::create_actor<ActorStatsReceiver>("ActorStatsReceiver").release();
+    for (int i = 0; i < 10; i++) {
+      td::send_closure_later(receiver, &ActorStatsReceiver::on_event);
+    }
+    td::send_closure_later(receiver, &ActorStatsReceiver::finish);
+    stop();
+  }
+};
+
+TEST(Actors, actor_stats) {
+  td::ActorStats::set_enabled(true);
+  td::ActorStats::get_statistics(true);
+  td::ConcurrentScheduler scheduler(0, 0);
+  scheduler.create_actor_unsafe<ActorStatsSender>(0, "ActorStatsSender").release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+  td::ActorStats::set_enabled(false);
+
+  bool found = false;
+  for (auto &statistics : td::ActorStats::get_statistics(false)) {
+    if (statistics.name == "ActorStatsReceiver") {
+      found = true;
+      // start_up, 10 events, finish and tear_down
+      ASSERT_EQ(13u, statistics.event_count);
+      ASSERT_TRUE(statistics.max_mailbox_size >= 11);
+      ASSERT_TRUE(statistics.run_time >= statistics.max_event_run_time);
+    }
+  }
+  ASSERT_TRUE(found);
+}
+
+class ActorProfilerReceiver final : public td::Actor {
+ public:
+  void work() {
+    auto end_time = td::Time::now() + 0.1;
+    while (td::Time::now() < end_time) {
+    }
+  }
+
+  void finish() {
+    td::Scheduler::instance()->finish();
+    stop();
+  }
+};
+
+class ActorProfilerSender final : public td::Actor {
+  void start_up() final {
+    set_context(std::make_shared<td::ActorContext>());
+    set_tag("7");
+    auto receiver = td::create_actor<ActorProfilerReceiver>("ActorProfilerReceiver").release();
+    td::send_closure_later(receiver, &ActorProfilerReceiver::work);
+    td::send_closure_later(receiver, &ActorProfilerReceiver::finish);
+    stop();
+  }
+};
+
+TEST(Actors, actor_profiler) {
+  td::ActorProfiler::get_folded_stacks(true);
+  td::ActorProfiler::set_sampling_interval(1);
+  td::ConcurrentScheduler scheduler(0, 0);
+  scheduler.create_actor_unsafe<ActorProfilerSender>(0, "ActorProfilerSender").release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+  td::ActorProfiler::set_sampling_interval(0);
+
+  auto folded_stacks = td::ActorProfiler::get_folded_stacks(true);
+  auto work_address = td::ActorProfiler::get_function_address(&ActorProfilerReceiver::work);
+  auto work_stack = PSTRING() << "client 7;ActorProfilerReceiver;" << td::format::as_hex(work_address) << ' ';
+  ASSERT_TRUE(folded_stacks.find(work_stack) != td::string::npos);
+  ASSERT_TRUE(td::ActorProfiler::get_folded_stacks(false).empty());
+}
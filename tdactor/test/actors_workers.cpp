@@ -12,6 +12,9 @@
 #include "td/utils/tests.h"
 #include "td/utils/Time.h"
 
+#include <atomic>
+#include <memory>
+
 class PowerWorker final : public td::Actor {
  public:
   class Callback {
@@ -106,8 +109,12 @@ class Manager final : public td::Actor {
   int query_size_;
 };
 
-static void test_workers(int threads_n, int workers_n, int queries_n, int query_size) {
+static void test_workers(int threads_n, int workers_n, int queries_n, int query_size,
+                         bool use_outbound_event_batching = false) {
   td::ConcurrentScheduler sched(threads_n, 0);
+  if (use_outbound_event_batching) {
+    sched.enable_outbound_event_batching();
+  }
 
   td::vector<td::ActorId<PowerWorker>> workers;
   for (int i = 0; i < workers_n; i++) {
@@ -149,6 +156,14 @@ TEST(Actors, workers_small_query_nine_threads) {
   test_workers(9, 10, 10000, 1);
 }
 
+TEST(Actors, workers_small_query_two_threads_batched) {
+  test_workers(2, 10, 100000, 1, true);
+}
+
+TEST(Actors, workers_small_query_nine_threads_batched) {
+  test_workers(9, 10, 10000, 1, true);
+}
+
 class SenderActor;
 
 class ReceiverActor final : public td::Actor {
@@ -186,3 +201,67 @@ TEST(Actors, send_closure_while_finish) {
   }
   sched.finish();
 }
+
+class StealableWorker final : public td::Actor {
+ public:
+  StealableWorker(std::shared_ptr<td::vector<std::atomic<int>>> sched_tasks, std::shared_ptr<std::atomic<int>> left)
+      : sched_tasks_(std::move(sched_tasks)), left_(std::move(left)) {
+  }
+
+ private:
+  std::shared_ptr<td::vector<std::atomic<int>>> sched_tasks_;
+  std::shared_ptr<std::atomic<int>> left_;
+  int tasks_left_ = 100;
+
+  void start_up() final {
+    set_migratable(true);
+    yield();
+  }
+
+  void loop() final {
+    auto end_time = td::Time::now() + 0.0005;
+    while (td::Time::now() < end_time) {
+      // busy work
+    }
+    (*sched_tasks_)[td::Scheduler::instance()->sched_id()]++;
+    if (--tasks_left_ == 0) {
+      if (--*left_ == 0) {
+        td::Scheduler::instance()->finish();
+      }
+      stop();
+      return;
+    }
+    yield();
+  }
+};
+
+TEST(Actors, work_stealing) {
+  int threads_n = 3;
+  int workers_n = 20;
+  td::ConcurrentScheduler sched(threads_n, 0);
+  sched.enable_work_stealing();
+
+  auto sched_tasks = std::make_shared<td::vector<std::atomic<int>>>(threads_n + 2);
+  auto left = std::make_shared<std::atomic<int>>(workers_n);
+  for (int i = 0; i < workers_n; i++) {
+    sched.create_actor_unsafe<StealableWorker>(1, PSLICE() << "StealableWorker" << i, sched_tasks, left).release();
+  }
+
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+
+  int total_tasks = 0;
+  int used_sched_count = 0;
+  for (auto &tasks : *sched_tasks) {
+    total_tasks += tasks.load();
+    if (tasks.load() != 0) {
+      used_sched_count++;
+    }
+  }
+  ASSERT_EQ(workers_n * 100, total_tasks);
+  ASSERT_EQ(0, (*sched_tasks)[threads_n + 1].load());
+  ASSERT_TRUE(used_sched_count > 1);
+}
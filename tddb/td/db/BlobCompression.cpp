@@ -0,0 +1,82 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/db/BlobCompression.h"
+
+#include "td/utils/as.h"
+#include "td/utils/Gzip.h"
+#include "td/utils/logging.h"
+
+namespace td {
+
+namespace {
+
+enum class BlobCodec : uint32 { Deflate = 1 };
+
+constexpr uint32 COMPRESSED_BLOB_MAGIC = 0xB10BC000;
+constexpr uint32 COMPRESSED_BLOB_MAGIC_MASK = 0xFFFFFF00;
+constexpr size_t COMPRESSED_BLOB_HEADER_SIZE = 8;
+
+// small blobs can't be compressed enough to compensate the header and the codec overhead
+constexpr size_t MIN_COMPRESSED_BLOB_SIZE = 256;
+constexpr double MAX_COMPRESSION_RATIO = 0.9;
+constexpr uint32 MAX_UNCOMPRESSED_BLOB_SIZE = 1 << 28;
+
+}  // namespace
+
+bool is_compressed_blob(Slice data) {
+  return data.size() >= COMPRESSED_BLOB_HEADER_SIZE &&
+         (as<uint32>(data.data()) & COMPRESSED_BLOB_MAGIC_MASK) == COMPRESSED_BLOB_MAGIC;
+}
+
+BufferSlice compress_blob(Slice data) {
+#if TD_HAVE_ZLIB
+  if (data.size() < MIN_COMPRESSED_BLOB_SIZE || data.size() > MAX_UNCOMPRESSED_BLOB_SIZE) {
+    return BufferSlice();
+  }
+  auto compressed = gzencode(data, MAX_COMPRESSION_RATIO);
+  if (compressed.empty()) {
+    return BufferSlice();
+  }
+  BufferSlice result(COMPRESSED_BLOB_HEADER_SIZE + compressed.size());
+  as<uint32>(result.as_mutable_slice().begin()) = COMPRESSED_BLOB_MAGIC | static_cast<uint32>(BlobCodec::Deflate);
+  as<uint32>(result.as_mutable_slice().begin() + 4) = static_cast<uint32>(data.size());
+  result.as_mutable_slice().substr(COMPRESSED_BLOB_HEADER_SIZE).copy_from(compressed.as_slice());
+  return result;
+#else
+  return BufferSlice();
+#endif
+}
+
+BufferSlice decompress_blob(Slice data) {
+  if (!is_compressed_blob(data)) {
+    return BufferSlice(data);
+  }
+  auto codec = as<uint32>(data.data()) & ~COMPRESSED_BLOB_MAGIC_MASK;
+  auto size = as<uint32>(data.data() + 4);
+  if (size > MAX_UNCOMPRESSED_BLOB_SIZE) {
+    LOG(ERROR) << "Receive compressed blob of size " << size;
+    return BufferSlice();
+  }
+  BufferSlice result;
+  switch (static_cast<BlobCodec>(codec)) {
+    case BlobCodec::Deflate:
+#if TD_HAVE_ZLIB
+      result = gzdecode(data.substr(COMPRESSED_BLOB_HEADER_SIZE));
+#endif
+      break;
+    default:
+      LOG(ERROR) << "Receive blob compressed with unsupported codec " << codec;
+      return BufferSlice();
+  }
+  if (result.size() != size) {
+    LOG(ERROR) << "Failed to decompress blob of size " << size << " using codec " << codec;
+    return BufferSlice();
+  }
+  return result;
+}
+
+}  // namespace td
@@ -0,0 +1,27 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+namespace td {
+
+// compressed blobs start with a header containing the used codec and the size of the uncompressed data
+// the header can't be a prefix of a TL-serialized object beginning with a version or flags, so compressed and
+// uncompressed blobs can be stored in the same column and rows can be compressed one by one
+
+bool is_compressed_blob(Slice data);
+
+// returns an empty BufferSlice if the data isn't worth to be compressed
+BufferSlice compress_blob(Slice data);
+
+// returns a copy of the data if it isn't compressed and an empty BufferSlice if the data can't be decompressed
+BufferSlice decompress_blob(Slice data);
+
+}  // namespace td
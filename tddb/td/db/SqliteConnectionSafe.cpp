@@ -12,17 +12,22 @@
 
 namespace td {
 
-SqliteConnectionSafe::SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version)
+SqliteConnectionSafe::SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version, bool is_read_only,
+                                           SqliteDb::Parameters parameters)
     : path_(std::move(path))
     , lsls_connection_([path = path_, close_state_ptr = &close_state_, key = std::move(key),
-                        cipher_version = std::move(cipher_version)] {
+                        cipher_version = std::move(cipher_version), is_read_only, parameters] {
       auto r_db = SqliteDb::open_with_key(path, false, key, cipher_version.copy());
       if (r_db.is_error()) {
         LOG(FATAL) << "Can't open database in state " << close_state_ptr->load() << ": " << r_db.error().message();
       }
       auto db = r_db.move_as_ok();
+      db.apply_parameters(parameters).ensure();
       db.exec("PRAGMA journal_mode=WAL").ensure();
       db.exec("PRAGMA secure_delete=1").ensure();
+      if (is_read_only) {
+        db.exec("PRAGMA query_only=1").ensure();
+      }
       return db;
     }) {
 }
@@ -21,7 +21,10 @@ namespace td {
 class SqliteConnectionSafe {
  public:
   SqliteConnectionSafe() = default;
-  SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version = {});
+  // read-only connections can be used to run queries in parallel with the writer in WAL mode;
+  // the database must already exist and be initialized through a writable connection
+  SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version = {}, bool is_read_only = false,
+                       SqliteDb::Parameters parameters = SqliteDb::Parameters());
 
   SqliteDb &get();
   void set(SqliteDb &&db);
@@ -168,6 +168,25 @@ Result<string> SqliteDb::get_pragma_string(Slice name) {
   return std::move(res);
 }
 
+Status SqliteDb::apply_parameters(const Parameters &parameters) {
+  // SQLCipher can't read encrypted pages through memory mapping and manages page size itself
+  bool is_encrypted = static_cast<bool>(get_cipher_version());
+  if (parameters.page_size != 0 && !is_encrypted) {
+    TRY_STATUS(exec(PSLICE() << "PRAGMA page_size = " << parameters.page_size));
+  }
+  if (parameters.cache_size != 0) {
+    // negative value of cache_size is interpreted as the size in kilobytes
+    TRY_STATUS(exec(PSLICE() << "PRAGMA cache_size = " << -static_cast<int64>(parameters.cache_size)));
+  }
+  if (parameters.mmap_size != 0 && !is_encrypted) {
+    TRY_STATUS(exec(PSLICE() << "PRAGMA mmap_size = " << parameters.mmap_size));
+  }
+  if (parameters.use_memory_temp_store) {
+    TRY_STATUS(exec("PRAGMA temp_store = MEMORY"));
+  }
+  return Status::OK();
+}
+
 Result<int32> SqliteDb::user_version() {
   TRY_RESULT(get_version_stmt, get_statement("PRAGMA user_version"));
   TRY_STATUS(get_version_stmt.step());
@@ -309,7 +328,16 @@ Status SqliteDb::destroy(Slice path) {
   return detail::RawSqliteDb::destroy(path);
 }
 
+int64 SqliteDb::get_memory_used() {
+  return static_cast<int64>(tdsqlite3_memory_used());
+}
+
 Result<SqliteStatement> SqliteDb::get_statement(CSlice statement) {
+  auto *cached_stmt = raw_->get_cached_statement(statement);
+  if (cached_stmt != nullptr) {
+    return SqliteStatement(cached_stmt, raw_);
+  }
+
   tdsqlite3_stmt *stmt = nullptr;
   auto rc =
       tdsqlite3_prepare_v2(get_native(), statement.c_str(), static_cast<int>(statement.size()) + 1, &stmt, nullptr);
@@ -24,6 +24,14 @@ namespace td {
 
 class SqliteDb {
  public:
+  // performance-related settings of a connection; zero values keep SQLite defaults
+  struct Parameters {
+    int64 mmap_size = 0;  // ignored for encrypted databases
+    int32 cache_size = 0;  // in kilobytes
+    int32 page_size = 0;   // ignored for encrypted databases; applied only before the first write to a new database
+    bool use_memory_temp_store = false;
+  };
+
   SqliteDb() = default;
   SqliteDb(SqliteDb &&) = default;
   SqliteDb &operator=(SqliteDb &&) = default;
@@ -52,12 +60,18 @@ class SqliteDb {
   Status begin_write_transaction() TD_WARN_UNUSED_RESULT;
   Status commit_transaction() TD_WARN_UNUSED_RESULT;
 
+  // must be called after the key is set and before journal mode is changed
+  Status apply_parameters(const Parameters &parameters) TD_WARN_UNUSED_RESULT;
+
   Result<int32> user_version();
   Status set_user_version(int32 version) TD_WARN_UNUSED_RESULT;
   void trace(bool flag);
 
   static Status destroy(Slice path) TD_WARN_UNUSED_RESULT;
 
+  // returns size of memory currently used by SQLite in the process, including page caches of all databases
+  static int64 get_memory_used();
+
   // we can't change the key on the fly, so static functions are more than enough
   static Result<SqliteDb> open_with_key(CSlice path, bool allow_creation, const DbKey &db_key,
                                         optional<int32> cipher_version = {});
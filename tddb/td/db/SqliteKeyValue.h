@@ -65,7 +65,7 @@ class SqliteKeyValue {
 
   FlatHashMap<string, string> get_all() {
     FlatHashMap<string, string> res;
-    get_by_prefix("", [&](Slice key, Slice value) {
+    get_all([&](Slice key, Slice value) {
       CHECK(!key.empty());
       res.emplace(key.str(), value.str());
       return true;
@@ -73,6 +73,13 @@ class SqliteKeyValue {
     return res;
   }
 
+  // callback is called for each key-value pair directly from the statement row, until it returns false;
+  // the slices are valid only during the call and the table must not be modified by the callback
+  template <class CallbackT>
+  void get_all(CallbackT &&callback) {
+    get_by_range_impl(Slice(), Slice(), false, callback);
+  }
+
   template <class CallbackT>
   void get_by_prefix(Slice prefix, CallbackT &&callback) {
     string next;
@@ -96,7 +103,7 @@ class SqliteKeyValue {
     } else {
       if (till.empty()) {
         stmt = &get_by_prefix_rare_stmt_;
-        stmt->bind_blob(1, till).ensure();
+        stmt->bind_blob(1, from).ensure();
       } else {
         stmt = &get_by_prefix_stmt_;
         stmt->bind_blob(1, from).ensure();
@@ -18,8 +18,8 @@ namespace td {
 
 class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
  public:
-  explicit SqliteKeyValueAsync(std::shared_ptr<SqliteKeyValueSafe> kv_safe, int32 scheduler_id = -1) {
-    impl_ = create_actor_on_scheduler<Impl>("KV", scheduler_id, std::move(kv_safe));
+  SqliteKeyValueAsync(std::shared_ptr<SqliteKeyValueSafe> kv_safe, int32 scheduler_id, Parameters parameters) {
+    impl_ = create_actor_on_scheduler<Impl>("KV", scheduler_id, std::move(kv_safe), parameters);
   }
   void set(string key, string value, Promise<Unit> promise) final {
     send_closure_later(impl_, &Impl::set, std::move(key), std::move(value), std::move(promise));
@@ -36,6 +36,9 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
   void get(string key, Promise<string> promise) final {
     send_closure_later(impl_, &Impl::get, std::move(key), std::move(promise));
   }
+  void get_statistics(Promise<Statistics> promise) final {
+    send_closure_later(impl_, &Impl::get_statistics, std::move(promise));
+  }
   void close(Promise<Unit> promise) final {
     send_closure_later(impl_, &Impl::close, std::move(promise));
   }
@@ -43,13 +46,15 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
  private:
   class Impl final : public Actor {
    public:
-    explicit Impl(std::shared_ptr<SqliteKeyValueSafe> kv_safe) : kv_safe_(std::move(kv_safe)) {
+    Impl(std::shared_ptr<SqliteKeyValueSafe> kv_safe, Parameters parameters)
+        : kv_safe_(std::move(kv_safe)), parameters_(parameters) {
     }
 
     void set(string key, string value, Promise<Unit> promise) {
       auto it = buffer_.find(key);
       if (it != buffer_.end()) {
         it->second = std::move(value);
+        statistics_.coalesced_query_count++;
       } else {
         CHECK(!key.empty());
         buffer_.emplace(std::move(key), std::move(value));
@@ -64,6 +69,8 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
     void set_all(FlatHashMap<string, string> key_values, Promise<Unit> promise) {
       do_flush(true /*force*/);
       kv_->set_all(key_values);
+      statistics_.transaction_count++;
+      statistics_.query_count += key_values.size();
       promise.set_value(Unit());
     }
 
@@ -71,6 +78,7 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
       auto it = buffer_.find(key);
       if (it != buffer_.end()) {
         it->second = optional<string>();
+        statistics_.coalesced_query_count++;
       } else {
         CHECK(!key.empty());
         buffer_.emplace(std::move(key), optional<string>());
@@ -96,6 +104,10 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
       promise.set_value(kv_->get(key));
     }
 
+    void get_statistics(Promise<Statistics> promise) {
+      promise.set_value(Statistics(statistics_));
+    }
+
     void close(Promise<Unit> promise) {
       do_flush(true /*force*/);
       kv_safe_.reset();
@@ -108,8 +120,9 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
     std::shared_ptr<SqliteKeyValueSafe> kv_safe_;
     SqliteKeyValue *kv_ = nullptr;
 
-    static constexpr double MAX_PENDING_QUERIES_DELAY = 0.01;
-    static constexpr size_t MAX_PENDING_QUERIES_COUNT = 100;
+    Parameters parameters_;
+    Statistics statistics_;
+
     FlatHashMap<string, optional<string>> buffer_;
     vector<Promise<Unit>> buffer_promises_;
     size_t cnt_ = 0;
@@ -123,19 +136,30 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
       if (!force) {
         auto now = Time::now_cached();
         if (wakeup_at_ == 0) {
-          wakeup_at_ = now + MAX_PENDING_QUERIES_DELAY;
+          wakeup_at_ = now + parameters_.max_flush_delay;
         }
-        if (now < wakeup_at_ && cnt_ < MAX_PENDING_QUERIES_COUNT) {
+        if (now < wakeup_at_ && cnt_ < parameters_.max_pending_query_count) {
           set_timeout_at(wakeup_at_);
           return;
         }
       }
 
       wakeup_at_ = 0;
+      statistics_.flush_count++;
+      statistics_.query_count += cnt_;
       cnt_ = 0;
 
+      size_t transaction_size = 0;
+      statistics_.transaction_count++;
       kv_->begin_write_transaction().ensure();
       for (auto &it : buffer_) {
+        if (transaction_size == parameters_.max_transaction_size && transaction_size != 0) {
+          transaction_size = 0;
+          statistics_.transaction_count++;
+          kv_->commit_transaction().ensure();
+          kv_->begin_write_transaction().ensure();
+        }
+        transaction_size++;
         if (it.second) {
           kv_->set(it.first, it.second.value());
         } else {
@@ -158,9 +182,9 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
   ActorOwn<Impl> impl_;
 };
 
-unique_ptr<SqliteKeyValueAsyncInterface> create_sqlite_key_value_async(std::shared_ptr<SqliteKeyValueSafe> kv,
-                                                                       int32 scheduler_id) {
-  return td::make_unique<SqliteKeyValueAsync>(std::move(kv), scheduler_id);
+unique_ptr<SqliteKeyValueAsyncInterface> create_sqlite_key_value_async(
+    std::shared_ptr<SqliteKeyValueSafe> kv, int32 scheduler_id, SqliteKeyValueAsyncInterface::Parameters parameters) {
+  return td::make_unique<SqliteKeyValueAsync>(std::move(kv), scheduler_id, parameters);
 }
 
 }  // namespace td
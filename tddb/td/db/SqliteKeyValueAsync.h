@@ -18,6 +18,24 @@ namespace td {
 
 class SqliteKeyValueAsyncInterface {
  public:
+  // set and erase queries are buffered and written in batches
+  struct Parameters {
+    // maximum time a buffered query can wait before being written in seconds
+    double max_flush_delay = 0.01;
+    // number of buffered queries, after which they are written immediately
+    size_t max_pending_query_count = 100;
+    // maximum number of keys written in one transaction; 0 means no limit
+    size_t max_transaction_size = 0;
+  };
+
+  struct Statistics {
+    uint64 flush_count = 0;
+    uint64 transaction_count = 0;
+    uint64 query_count = 0;
+    // number of set and erase queries for a key, which had a not yet written query in the buffer
+    uint64 coalesced_query_count = 0;
+  };
+
   virtual ~SqliteKeyValueAsyncInterface() = default;
 
   virtual void set(string key, string value, Promise<Unit> promise) = 0;
@@ -30,9 +48,12 @@ class SqliteKeyValueAsyncInterface {
 
   virtual void get(string key, Promise<string> promise) = 0;
 
+  virtual void get_statistics(Promise<Statistics> promise) = 0;
+
   virtual void close(Promise<Unit> promise) = 0;
 };
 
-unique_ptr<SqliteKeyValueAsyncInterface> create_sqlite_key_value_async(std::shared_ptr<SqliteKeyValueSafe> kv,
-                                                                       int32 scheduler_id = 1);
+unique_ptr<SqliteKeyValueAsyncInterface> create_sqlite_key_value_async(
+    std::shared_ptr<SqliteKeyValueSafe> kv, int32 scheduler_id = 1,
+    SqliteKeyValueAsyncInterface::Parameters parameters = SqliteKeyValueAsyncInterface::Parameters());
 }  // namespace td
@@ -10,6 +10,7 @@
 #include "td/utils/logging.h"
 #include "td/utils/StackAllocator.h"
 #include "td/utils/StringBuilder.h"
+#include "td/utils/Time.h"
 
 #include "sqlite/sqlite3.h"
 
@@ -53,8 +54,20 @@ int printExplainQueryPlan(StringBuilder &sb, tdsqlite3_stmt *pStmt) {
 SqliteStatement::SqliteStatement(tdsqlite3_stmt *stmt, std::shared_ptr<detail::RawSqliteDb> db)
     : stmt_(stmt), db_(std::move(db)) {
   CHECK(stmt != nullptr);
+  if (SqliteStatementStats::is_enabled()) {
+    stats_entry_ = SqliteStatementStats::get_entry(CSlice(tdsqlite3_sql(stmt)));
+  }
+}
+
+SqliteStatement::~SqliteStatement() {
+  if (stmt_ != nullptr && db_ != nullptr) {
+    // return the statement to the connection to avoid preparing it again; values must not be bound after the owner
+    // of the bound data is destroyed
+    tdsqlite3_reset(stmt_.get());
+    tdsqlite3_clear_bindings(stmt_.get());
+    db_->put_cached_statement(stmt_.release());
+  }
 }
-SqliteStatement::~SqliteStatement() = default;
 
 Result<string> SqliteStatement::explain() {
   if (empty()) {
@@ -180,7 +193,17 @@ Status SqliteStatement::step() {
   }
   VLOG(sqlite) << "Start step " << tag("query", tdsqlite3_sql(stmt_.get())) << tag("statement", stmt_.get())
                << tag("database", db_.get());
-  auto rc = tdsqlite3_step(stmt_.get());
+  int rc;
+  if (stats_entry_ != nullptr) {
+    auto is_first_step = state_ == State::Start;
+    auto start_time = Time::now();
+    rc = tdsqlite3_step(stmt_.get());
+    auto full_scan_step_count = tdsqlite3_stmt_status(stmt_.get(), SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    stats_entry_->on_step(Time::now() - start_time, is_first_step, rc == SQLITE_ROW,
+                          static_cast<uint64>(full_scan_step_count));
+  } else {
+    rc = tdsqlite3_step(stmt_.get());
+  }
   VLOG(sqlite) << "Finish step with response " << (rc == SQLITE_ROW ? "ROW" : (rc == SQLITE_DONE ? "DONE" : "ERROR"));
   if (rc == SQLITE_ROW) {
     state_ = State::HaveRow;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "td/db/detail/RawSqliteDb.h"
+#include "td/db/SqliteStatementStats.h"
 
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
@@ -81,6 +82,7 @@ class SqliteStatement {
 
   std::unique_ptr<tdsqlite3_stmt, StmtDeleter> stmt_;
   std::shared_ptr<detail::RawSqliteDb> db_;
+  SqliteStatementStats::Entry *stats_entry_ = nullptr;
 
   Status last_error();
 };
@@ -0,0 +1,108 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/db/SqliteStatementStats.h"
+
+#include "td/utils/FlatHashMap.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace td {
+
+std::atomic<bool> SqliteStatementStats::is_enabled_{false};
+
+// some statements are built with inlined values, so the number of entries must be limited
+static constexpr size_t MAX_ENTRY_COUNT = 1000;
+
+static std::mutex entries_mutex;
+static FlatHashMap<string, unique_ptr<SqliteStatementStats::Entry>> &get_entries() {
+  // entries are never deleted, because they are referenced by statements
+  static auto *entries = new FlatHashMap<string, unique_ptr<SqliteStatementStats::Entry>>();
+  return *entries;
+}
+
+static void update_max(std::atomic<uint64> &max_value, uint64 value) {
+  auto old_value = max_value.load(std::memory_order_relaxed);
+  while (old_value < value && !max_value.compare_exchange_weak(old_value, value, std::memory_order_relaxed)) {
+  }
+}
+
+static uint64 to_nanoseconds(double time) {
+  return time <= 0 ? 0 : static_cast<uint64>(time * 1e9);
+}
+
+static double from_nanoseconds(uint64 time) {
+  return static_cast<double>(time) * 1e-9;
+}
+
+void SqliteStatementStats::Entry::on_step(double step_time, bool is_first_step, bool has_row,
+                                          uint64 full_scan_step_count) {
+  auto step_time_ns = to_nanoseconds(step_time);
+  if (is_first_step) {
+    execution_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (has_row) {
+    row_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (full_scan_step_count != 0) {
+    full_scan_step_count_.fetch_add(full_scan_step_count, std::memory_order_relaxed);
+  }
+  step_time_ns_.fetch_add(step_time_ns, std::memory_order_relaxed);
+  update_max(max_step_time_ns_, step_time_ns);
+}
+
+void SqliteStatementStats::set_enabled(bool is_enabled) {
+  is_enabled_.store(is_enabled, std::memory_order_relaxed);
+}
+
+SqliteStatementStats::Entry *SqliteStatementStats::get_entry(Slice query) {
+  if (!is_enabled()) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(entries_mutex);
+  auto &entries = get_entries();
+  auto it = entries.find(query.str());
+  if (it != entries.end()) {
+    return it->second.get();
+  }
+  if (entries.size() >= MAX_ENTRY_COUNT) {
+    return nullptr;
+  }
+  auto &entry = entries[query.str()];
+  entry = make_unique<Entry>(query);
+  return entry.get();
+}
+
+vector<SqliteStatementStats::Statistics> SqliteStatementStats::get_statistics(bool reset) {
+  vector<Statistics> result;
+  {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    for (auto &it : get_entries()) {
+      auto &entry = *it.second;
+      auto load = [reset](std::atomic<uint64> &value) {
+        return reset ? value.exchange(0, std::memory_order_relaxed) : value.load(std::memory_order_relaxed);
+      };
+      Statistics statistics;
+      statistics.execution_count = load(entry.execution_count_);
+      statistics.row_count = load(entry.row_count_);
+      statistics.full_scan_step_count = load(entry.full_scan_step_count_);
+      statistics.step_time = from_nanoseconds(load(entry.step_time_ns_));
+      statistics.max_step_time = from_nanoseconds(load(entry.max_step_time_ns_));
+      if (statistics.execution_count == 0) {
+        continue;
+      }
+      statistics.query = entry.query_;
+      result.push_back(std::move(statistics));
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const Statistics &lhs, const Statistics &rhs) { return lhs.step_time > rhs.step_time; });
+  return result;
+}
+
+}  // namespace td
@@ -0,0 +1,63 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+#include <atomic>
+
+namespace td {
+
+// process-wide statistics about SQLite statement executions, grouped by statement text
+// statistics are collected only for statements prepared while the collection is enabled
+class SqliteStatementStats {
+ public:
+  class Entry {
+   public:
+    explicit Entry(Slice query) : query_(query.str()) {
+    }
+
+    void on_step(double step_time, bool is_first_step, bool has_row, uint64 full_scan_step_count);
+
+   private:
+    friend class SqliteStatementStats;
+
+    string query_;
+    std::atomic<uint64> execution_count_{0};
+    std::atomic<uint64> row_count_{0};
+    std::atomic<uint64> full_scan_step_count_{0};
+    std::atomic<uint64> step_time_ns_{0};
+    std::atomic<uint64> max_step_time_ns_{0};
+  };
+
+  struct Statistics {
+    string query;
+    uint64 execution_count = 0;
+    uint64 row_count = 0;
+    uint64 full_scan_step_count = 0;
+    double step_time = 0.0;
+    double max_step_time = 0.0;
+  };
+
+  static void set_enabled(bool is_enabled);
+
+  static bool is_enabled() {
+    return is_enabled_.load(std::memory_order_relaxed);
+  }
+
+  // returns nullptr if statistics collection is disabled or there are too many different statements
+  static Entry *get_entry(Slice query);
+
+  // returns statistics sorted by total step time in descending order
+  static vector<Statistics> get_statistics(bool reset);
+
+ private:
+  static std::atomic<bool> is_enabled_;
+};
+
+}  // namespace td
@@ -21,6 +21,7 @@
 #include "td/utils/tl_parsers.h"
 #include "td/utils/tl_storers.h"
 
+#include <iterator>
 #include <set>
 
 namespace td {
@@ -82,6 +83,250 @@ bool EventId::is_valid_id(int32 id) {
   return 0 <= id && id < MAX_ID;
 }
 
+// events of a queue sorted by their identifiers in a circular buffer; events are removed from the middle lazily,
+// so adding of new events and removing of events from both ends take amortized O(1) time
+class TQueueEventRing {
+ public:
+  struct Entry {
+    EventId first;
+    TQueue::RawEvent second;
+    bool is_removed = false;
+  };
+
+  template <class RingT, class EntryT>
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = EntryT;
+    using difference_type = std::ptrdiff_t;
+    using pointer = EntryT *;
+    using reference = EntryT &;
+
+    Iterator() = default;
+    Iterator(RingT *ring, size_t pos) : ring_(ring), pos_(pos) {
+    }
+
+    EntryT &operator*() const {
+      return ring_->get_entry(pos_);
+    }
+    EntryT *operator->() const {
+      return &ring_->get_entry(pos_);
+    }
+
+    Iterator &operator++() {
+      pos_ = ring_->get_next_pos(pos_);
+      return *this;
+    }
+    Iterator &operator--() {
+      pos_ = ring_->get_prev_pos(pos_);
+      return *this;
+    }
+
+    bool operator==(const Iterator &other) const {
+      return pos_ == other.pos_;
+    }
+    bool operator!=(const Iterator &other) const {
+      return pos_ != other.pos_;
+    }
+
+   private:
+    friend class TQueueEventRing;
+
+    RingT *ring_ = nullptr;
+    size_t pos_ = 0;  // position from the beginning of the ring, which doesn't change after removal of first events
+  };
+
+  using iterator = Iterator<TQueueEventRing, Entry>;
+  using const_iterator = Iterator<const TQueueEventRing, const Entry>;
+
+  iterator begin() {
+    return iterator(this, first_pos_);
+  }
+  iterator end() {
+    return iterator(this, first_pos_ + size_);
+  }
+  std::reverse_iterator<iterator> rbegin() {
+    return std::reverse_iterator<iterator>(end());
+  }
+  const_iterator begin() const {
+    return const_iterator(this, first_pos_);
+  }
+  const_iterator end() const {
+    return const_iterator(this, first_pos_ + size_);
+  }
+  std::reverse_iterator<const_iterator> rbegin() const {
+    return std::reverse_iterator<const_iterator>(end());
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+  size_t size() const {
+    return live_count_;
+  }
+
+  void emplace(EventId event_id, TQueue::RawEvent &&event) {
+    CHECK(size_ == 0 || at(size_ - 1).first < event_id);
+    if (size_ == entries_.size()) {
+      reallocate(max(entries_.size() * 2, static_cast<size_t>(MIN_CAPACITY)));
+    }
+    size_++;
+    auto &entry = at(size_ - 1);
+    entry.first = event_id;
+    entry.second = std::move(event);
+    live_count_++;
+  }
+
+  iterator lower_bound(EventId event_id) {
+    size_t left = 0;
+    size_t right = size_;
+    while (left < right) {
+      auto middle = left + (right - left) / 2;
+      if (at(middle).first < event_id) {
+        left = middle + 1;
+      } else {
+        right = middle;
+      }
+    }
+    while (left < size_ && at(left).is_removed) {
+      left++;
+    }
+    return iterator(this, first_pos_ + left);
+  }
+
+  iterator find(EventId event_id) {
+    auto it = lower_bound(event_id);
+    if (it == end() || it->first != event_id) {
+      return end();
+    }
+    return it;
+  }
+
+  iterator erase(iterator it) {
+    auto index = it.pos_ - first_pos_;
+    CHECK(index < size_);
+    auto &entry = at(index);
+    CHECK(!entry.is_removed);
+    entry.second = TQueue::RawEvent();
+    entry.is_removed = true;
+    live_count_--;
+    removed_count_++;
+
+    if (index == 0) {
+      while (size_ > 0 && at(0).is_removed) {
+        at(0) = Entry();
+        head_ = (head_ + 1) & (entries_.size() - 1);
+        size_--;
+        first_pos_++;
+        removed_count_--;
+      }
+      shrink_if_needed();
+      return begin();
+    }
+    if (index + 1 == size_) {
+      while (at(size_ - 1).is_removed) {
+        at(size_ - 1) = Entry();
+        size_--;
+        removed_count_--;
+      }
+      shrink_if_needed();
+      return end();
+    }
+    if (removed_count_ <= live_count_) {
+      return iterator(this, get_next_pos(it.pos_));
+    }
+
+    // compact the ring; the next event is the first event with a bigger identifier
+    size_t new_size = 0;
+    size_t next_index = 0;
+    for (size_t i = 0; i < size_; i++) {
+      if (at(i).is_removed) {
+        continue;
+      }
+      if (i < index) {
+        next_index++;
+      }
+      if (new_size != i) {
+        at(new_size) = std::move(at(i));
+      }
+      new_size++;
+    }
+    for (size_t i = new_size; i < size_; i++) {
+      at(i) = Entry();
+    }
+    size_ = new_size;
+    removed_count_ = 0;
+    shrink_if_needed();
+    return iterator(this, first_pos_ + next_index);
+  }
+
+ private:
+  static constexpr size_t MIN_CAPACITY = 8;
+  static constexpr size_t MIN_SHRINK_CAPACITY = 64;
+
+  vector<Entry> entries_;  // circular buffer with capacity equal to a power of 2
+  size_t head_ = 0;        // index of the first entry in entries_
+  size_t size_ = 0;        // number of entries including removed ones; the first and the last entries aren't removed
+  size_t first_pos_ = 0;
+  size_t live_count_ = 0;
+  size_t removed_count_ = 0;
+
+  Entry &at(size_t index) {
+    return entries_[(head_ + index) & (entries_.size() - 1)];
+  }
+  const Entry &at(size_t index) const {
+    return entries_[(head_ + index) & (entries_.size() - 1)];
+  }
+
+  void reallocate(size_t new_capacity) {
+    CHECK(new_capacity >= size_);
+    vector<Entry> new_entries(new_capacity);
+    for (size_t i = 0; i < size_; i++) {
+      new_entries[i] = std::move(at(i));
+    }
+    entries_ = std::move(new_entries);
+    head_ = 0;
+  }
+
+  void shrink_if_needed() {
+    if (size_ == 0) {
+      entries_ = {};
+      head_ = 0;
+    } else if (entries_.size() > MIN_SHRINK_CAPACITY && size_ * 8 <= entries_.size()) {
+      reallocate(entries_.size() / 2);
+    }
+  }
+
+  Entry &get_entry(size_t pos) {
+    auto index = pos - first_pos_;
+    CHECK(index < size_);
+    return at(index);
+  }
+  const Entry &get_entry(size_t pos) const {
+    auto index = pos - first_pos_;
+    CHECK(index < size_);
+    return at(index);
+  }
+
+  size_t get_next_pos(size_t pos) const {
+    auto index = pos - first_pos_ + 1;
+    while (index < size_ && at(index).is_removed) {
+      index++;
+    }
+    return first_pos_ + index;
+  }
+
+  size_t get_prev_pos(size_t pos) const {
+    auto index = pos - first_pos_;
+    CHECK(index > 0);
+    do {
+      index--;
+    } while (at(index).is_removed);
+    return first_pos_ + index;
+  }
+};
+
+template <class EventsT>
 class TQueueImpl final : public TQueue {
   static constexpr size_t MAX_EVENT_LENGTH = 65536 * 8;
   static constexpr size_t MAX_QUEUE_EVENTS = 100000;
@@ -263,23 +508,7 @@ class TQueueImpl final : public TQueue {
     auto callback_clear_time = Time::now() - start_time;
 
     std::map<EventId, RawEvent> deleted_events;
-    if (keep_count > size / 2) {
-      for (auto it = q.events.begin(); it != end_it;) {
-        q.total_event_length -= it->second.data.size();
-        bool is_inserted = deleted_events.emplace(it->first, std::move(it->second)).second;
-        CHECK(is_inserted);
-        it = q.events.erase(it);
-      }
-    } else {
-      q.total_event_length = 0;
-      for (auto it = end_it; it != q.events.end();) {
-        q.total_event_length += it->second.data.size();
-        bool is_inserted = deleted_events.emplace(it->first, std::move(it->second)).second;
-        CHECK(is_inserted);
-        it = q.events.erase(it);
-      }
-      std::swap(deleted_events, q.events);
-    }
+    extract_events(q, q.events, end_it, keep_count > size / 2, deleted_events);
 
     auto clear_time = Time::now() - start_time;
     if (clear_time > 0.02) {
@@ -374,9 +603,11 @@ class TQueueImpl final : public TQueue {
   }
 
  private:
+  using EventIterator = typename EventsT::iterator;
+
   struct Queue {
     EventId tail_id;
-    std::map<EventId, RawEvent> events;
+    EventsT events;
     size_t total_event_length = 0;
     int32 gc_at = 0;
   };
@@ -400,7 +631,7 @@ class TQueueImpl final : public TQueue {
     return q.events.size() - (q.events.rbegin()->second.data.empty() ? 1 : 0);
   }
 
-  void pop(Queue &q, QueueId queue_id, std::map<EventId, RawEvent>::iterator &it, EventId tail_id) {
+  void pop(Queue &q, QueueId queue_id, EventIterator &it, EventId tail_id) {
     auto &event = it->second;
     if (callback_ == nullptr || event.log_event_id == 0) {
       remove_event(q, it);
@@ -419,7 +650,39 @@ class TQueueImpl final : public TQueue {
     }
   }
 
-  static void remove_event(Queue &q, std::map<EventId, RawEvent>::iterator &it) {
+  // moves events before end_it to deleted_events
+  static void extract_events(Queue &q, std::map<EventId, RawEvent> &events,
+                             std::map<EventId, RawEvent>::iterator end_it, bool is_big_suffix,
+                             std::map<EventId, RawEvent> &deleted_events) {
+    if (is_big_suffix) {
+      for (auto it = events.begin(); it != end_it;) {
+        q.total_event_length -= it->second.data.size();
+        bool is_inserted = deleted_events.emplace(it->first, std::move(it->second)).second;
+        CHECK(is_inserted);
+        it = events.erase(it);
+      }
+    } else {
+      q.total_event_length = 0;
+      for (auto it = end_it; it != events.end();) {
+        q.total_event_length += it->second.data.size();
+        bool is_inserted = deleted_events.emplace(it->first, std::move(it->second)).second;
+        CHECK(is_inserted);
+        it = events.erase(it);
+      }
+      std::swap(deleted_events, events);
+    }
+  }
+
+  static void extract_events(Queue &q, TQueueEventRing &events, TQueueEventRing::iterator end_it, bool is_big_suffix,
+                             std::map<EventId, RawEvent> &deleted_events) {
+    for (auto it = events.begin(); it != end_it;) {
+      q.total_event_length -= it->second.data.size();
+      deleted_events.emplace_hint(deleted_events.end(), it->first, std::move(it->second));
+      it = events.erase(it);
+    }
+  }
+
+  static void remove_event(Queue &q, EventIterator &it) {
     q.total_event_length -= it->second.data.size();
     it = q.events.erase(it);
   }
@@ -474,8 +737,11 @@ class TQueueImpl final : public TQueue {
   }
 };
 
-unique_ptr<TQueue> TQueue::create() {
-  return make_unique<TQueueImpl>();
+unique_ptr<TQueue> TQueue::create(bool use_ring_buffers) {
+  if (use_ring_buffers) {
+    return make_unique<TQueueImpl<TQueueEventRing>>();
+  }
+  return make_unique<TQueueImpl<std::map<EventId, RawEvent>>>();
 }
 
 struct TQueueLogEvent final : public Storer {
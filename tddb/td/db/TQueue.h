@@ -86,7 +86,9 @@ class TQueue {
     virtual void pop_batch(std::vector<uint64> log_event_ids);
   };
 
-  static unique_ptr<TQueue> create();
+  // if use_ring_buffers, then events of each queue are kept in a ring buffer instead of a balanced tree,
+  // which is faster for queues from which events are deleted mostly in order
+  static unique_ptr<TQueue> create(bool use_ring_buffers = false);
 
   TQueue() = default;
   TQueue(const TQueue &) = delete;
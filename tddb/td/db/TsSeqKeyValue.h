@@ -79,6 +79,11 @@ class TsSeqKeyValue {
     return kv_;
   }
 
+  // non-thread-safe method
+  const SeqKeyValue &inner() const {
+    return kv_;
+  }
+
   auto lock() {
     return rw_mutex_.lock_write().move_as_ok();
   }
@@ -14,6 +14,7 @@
 #include "td/utils/misc.h"
 #include "td/utils/port/Clocks.h"
 #include "td/utils/port/FileFd.h"
+#include "td/utils/port/MemoryMapping.h"
 #include "td/utils/port/path.h"
 #include "td/utils/port/PollFlags.h"
 #include "td/utils/port/sleep.h"
@@ -98,12 +99,27 @@ class BinlogReader {
   }
   void set_input(ChainBufferReader *input, bool is_encrypted, int64 expected_size) {
     input_ = input;
+    is_mapped_ = false;
     is_encrypted_ = is_encrypted;
     expected_size_ = expected_size;
   }
 
-  ChainBufferReader *input() {
-    return input_;
+  // reads events directly from memory-mapped content of an unencrypted binlog, starting from the current offset
+  void set_mapped_input(Slice data, int64 expected_size) {
+    CHECK(static_cast<int64>(data.size()) >= offset_);
+    input_ = nullptr;
+    is_mapped_ = true;
+    mapped_input_ = data.substr(static_cast<size_t>(offset_));
+    is_encrypted_ = false;
+    expected_size_ = expected_size;
+  }
+
+  bool is_mapped() const {
+    return is_mapped_;
+  }
+
+  size_t input_size() const {
+    return is_mapped_ ? mapped_input_.size() : input_->size();
   }
 
   int64 offset() const {
@@ -111,13 +127,17 @@ class BinlogReader {
   }
   Result<size_t> read_next(BinlogEvent *event) {
     if (state_ == State::ReadLength) {
-      if (input_->size() < 4) {
+      if (input_size() < 4) {
         return 4;
       }
-      auto it = input_->clone();
 
       char buf[4];
-      it.advance(4, MutableSlice(buf, 4));
+      if (is_mapped_) {
+        MutableSlice(buf, 4).copy_from(mapped_input_.substr(0, 4));
+      } else {
+        auto it = input_->clone();
+        it.advance(4, MutableSlice(buf, 4));
+      }
       size_ = static_cast<size_t>(TlParser(Slice(buf, 4)).fetch_int());
 
       if (size_ > BinlogEvent::MAX_SIZE) {
@@ -129,18 +149,25 @@ class BinlogReader {
       if (size_ % 4 != 0) {
         return Status::Error(-2, PSLICE() << "Event of size " << size_ << " at offset " << offset() << " out of "
                                           << expected_size_ << ' ' << tag("is_encrypted", is_encrypted_)
-                                          << format::as_hex_dump<4>(Slice(input_->prepare_read().truncate(28))));
+                                          << format::as_hex_dump<4>(
+                                                 (is_mapped_ ? mapped_input_ : input_->prepare_read()).truncate(28)));
       }
       state_ = State::ReadEvent;
     }
 
-    if (input_->size() < size_) {
+    if (input_size() < size_) {
       return size_;
     }
 
     event->debug_info_ = BinlogDebugInfo{__FILE__, __LINE__};
-    auto buffer_slice = input_->cut_head(size_).move_as_buffer_slice();
-    event->init(buffer_slice.as_slice().str());
+    if (is_mapped_) {
+      event->init(mapped_input_.substr(0, size_).str());
+      mapped_input_.remove_prefix(size_);
+    } else {
+      string raw_event(size_, '\0');
+      input_->advance(size_, raw_event);
+      event->init(std::move(raw_event));
+    }
     TRY_STATUS(event->validate());
     offset_ += size_;
     event->offset_ = offset_;
@@ -150,6 +177,8 @@ class BinlogReader {
 
  private:
   ChainBufferReader *input_;
+  bool is_mapped_{false};
+  Slice mapped_input_;
   enum class State { ReadLength, ReadEvent };
   State state_ = State::ReadLength;
   size_t size_{0};
@@ -226,6 +255,14 @@ Status Binlog::init(string path, const Callback &callback, DbKey db_key, DbKey o
   return Status::OK();
 }
 
+int64 Binlog::get_full_size() const {
+  auto fd_size = fd_size_;
+  if (events_buffer_) {
+    fd_size += events_buffer_->size();
+  }
+  return fd_size;
+}
+
 void Binlog::add_event(BinlogEvent &&event) {
   if (event.size_ % 4 != 0) {
     LOG(FATAL) << "Trying to add event with bad size " << event.public_to_string();
@@ -239,10 +276,7 @@ void Binlog::add_event(BinlogEvent &&event) {
   lazy_flush();
 
   if (state_ == State::Run) {
-    auto fd_size = fd_size_;
-    if (events_buffer_) {
-      fd_size += events_buffer_->size();
-    }
+    auto fd_size = get_full_size();
     auto need_reindex = [&](int64 min_size, int rate) {
       return fd_size > min_size && fd_size / rate > processor_->total_raw_events_size();
     };
@@ -299,6 +333,24 @@ Status Binlog::close(bool need_sync) {
   return Status::OK();
 }
 
+bool Binlog::need_idle_reindex() const {
+  if (state_ != State::Run) {
+    return false;
+  }
+  // reindex if more than a third of the binlog size is occupied by outdated events
+  constexpr int64 MIN_IDLE_REINDEX_SIZE = 1 << 20;
+  auto fd_size = get_full_size();
+  return fd_size > MIN_IDLE_REINDEX_SIZE && processor_->total_raw_events_size() * 3 < fd_size * 2;
+}
+
+void Binlog::reindex() {
+  if (state_ == State::Run) {
+    LOG(INFO) << tag("fd_size", format::as_size(get_full_size()))
+              << tag("total events size", format::as_size(processor_->total_raw_events_size()));
+    do_reindex();
+  }
+}
+
 void Binlog::close(Promise<> promise) {
   TRY_STATUS_PROMISE(promise, close());
   promise.set_value({});
@@ -458,6 +510,10 @@ void Binlog::lazy_flush() {
 
 void Binlog::update_read_encryption() {
   CHECK(binlog_reader_ptr_);
+  if (binlog_reader_ptr_->is_mapped()) {
+    // continue to read the file just after the last event read from the memory mapping
+    fd_.seek(binlog_reader_ptr_->offset()).ensure();
+  }
   switch (encryption_type_) {
     case EncryptionType::None: {
       auto r_file_size = fd_.get_size();
@@ -512,6 +568,20 @@ Status Binlog::load_binlog(const Callback &callback, const Callback &debug_callb
 
   update_read_encryption();
 
+  // unencrypted part of the binlog is parsed directly from a memory mapping of the file to avoid reading it to buffers
+  Result<MemoryMapping> r_mapping = Status::Error("Memory mapping wasn't created");
+  if (encryption_type_ == EncryptionType::None) {
+    auto r_file_size = fd_.get_size();
+    if (r_file_size.is_ok() && r_file_size.ok() > 0) {
+      r_mapping = MemoryMapping::create_from_file(fd_);
+      if (r_mapping.is_ok()) {
+        reader.set_mapped_input(r_mapping.ok().as_slice(), r_file_size.ok());
+      } else {
+        LOG(INFO) << "Failed to map binlog " << path_ << ": " << r_mapping.error();
+      }
+    }
+  }
+
   fd_.get_poll_info().add_flags(PollFlags::Read());
   info_.wrong_password = false;
   while (true) {
@@ -544,16 +614,23 @@ Status Binlog::load_binlog(const Callback &callback, const Callback &debug_callb
         return Status::OK();
       }
     } else {
+      if (reader.is_mapped()) {
+        // the whole mapped file has been read
+        break;
+      }
       TRY_STATUS(fd_.flush_read(max(need_size, static_cast<size_t>(4096))));
       buffer_reader_.sync_with_writer();
       if (byte_flow_flag_) {
         byte_flow_source_.wakeup();
       }
-      if (reader.input()->size() < need_size) {
+      if (reader.input_size() < need_size) {
         break;
       }
     }
   }
+  if (reader.is_mapped()) {
+    fd_.seek(reader.offset()).ensure();
+  }
 
   auto offset = processor_->offset();
   CHECK(offset >= 0);
@@ -117,6 +117,11 @@ class Binlog {
   }
   void change_key(DbKey new_db_key);
 
+  // returns true, if the binlog is big enough and its size can be noticeably decreased by reindex,
+  // which isn't yet required, but should be done when the binlog isn't used
+  bool need_idle_reindex() const;
+  void reindex();
+
   Status close(bool need_sync = true) TD_WARN_UNUSED_RESULT;
   void close(Promise<> promise);
   Status close_and_destroy() TD_WARN_UNUSED_RESULT;
@@ -166,6 +171,7 @@ class Binlog {
   enum class State { Empty, Load, Reindex, Run } state_{State::Empty};
 
   static Result<FileFd> open_binlog(const string &path, int32 flags);
+  int64 get_full_size() const;
   size_t flush_events_buffer(bool force);
   void do_add_event(BinlogEvent &&event);
   void do_event(BinlogEvent &&event);
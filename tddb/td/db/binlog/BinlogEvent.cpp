@@ -14,6 +14,25 @@
 
 namespace td {
 
+std::atomic<bool> BinlogEvent::use_crc32c_{false};
+
+void BinlogEvent::set_use_crc32c(bool use_crc32c) {
+  use_crc32c_.store(use_crc32c && is_crc32c_supported(), std::memory_order_relaxed);
+}
+
+bool BinlogEvent::is_crc32c_supported() {
+  return TD_HAVE_CRC32C != 0;
+}
+
+uint32 BinlogEvent::calc_crc(int32 flags, Slice data) {
+#if TD_HAVE_CRC32C
+  if ((flags & Flags::Crc32c) != 0) {
+    return crc32c(data);
+  }
+#endif
+  return crc32(data);
+}
+
 void BinlogEvent::init(string raw_event) {
   TlParser parser(as_slice(raw_event));
   size_ = static_cast<uint32>(parser.fetch_int());
@@ -45,7 +64,10 @@ Status BinlogEvent::validate() const {
   }
   parser.template fetch_string_raw<Slice>(size_ - TAIL_SIZE - sizeof(int));  // skip
   auto stored_crc32 = static_cast<uint32>(parser.fetch_int());
-  auto calculated_crc = crc32(Slice(as_slice(raw_event_).data(), size_ - TAIL_SIZE));
+  if ((flags_ & Flags::Crc32c) != 0 && !is_crc32c_supported()) {
+    return Status::Error(PSLICE() << "CRC-32C isn't supported " << public_to_string());
+  }
+  auto calculated_crc = calc_crc(flags_, Slice(as_slice(raw_event_).data(), size_ - TAIL_SIZE));
   if (calculated_crc != crc32_ || calculated_crc != stored_crc32) {
     return Status::Error(PSLICE() << "CRC mismatch " << tag("actual", format::as_hex(calculated_crc))
                                   << tag("expected", format::as_hex(crc32_)) << public_to_string());
@@ -55,6 +77,9 @@ Status BinlogEvent::validate() const {
 
 BufferSlice BinlogEvent::create_raw(uint64 id, int32 type, int32 flags, const Storer &storer) {
   auto raw_event = BufferSlice{storer.size() + MIN_SIZE};
+  if (use_crc32c_.load(std::memory_order_relaxed)) {
+    flags |= Flags::Crc32c;
+  }
 
   TlStorerUnsafe tl_storer(raw_event.as_mutable_slice().ubegin());
   tl_storer.store_int(narrow_cast<int32>(raw_event.size()));
@@ -67,7 +92,7 @@ BufferSlice BinlogEvent::create_raw(uint64 id, int32 type, int32 flags, const St
   tl_storer.store_storer(storer);
 
   CHECK(tl_storer.get_buf() == raw_event.as_slice().uend() - TAIL_SIZE);
-  tl_storer.store_int(crc32(raw_event.as_slice().truncate(raw_event.size() - TAIL_SIZE)));
+  tl_storer.store_int(calc_crc(flags, raw_event.as_slice().truncate(raw_event.size() - TAIL_SIZE)));
 
   return raw_event;
 }
@@ -16,6 +16,8 @@
 #include "td/utils/StorerBase.h"
 #include "td/utils/StringBuilder.h"
 
+#include <atomic>
+
 namespace td {
 
 struct EmptyStorerImpl {
@@ -67,7 +69,8 @@ struct BinlogEvent {
   BinlogDebugInfo debug_info_;
 
   enum ServiceTypes { Header = -1, Empty = -2, AesCtrEncryption = -3, NoEncryption = -4 };
-  enum Flags { Rewrite = 1, Partial = 2 };
+  // events with the flag Crc32c are checksummed with CRC-32C instead of CRC-32
+  enum Flags { Rewrite = 1, Partial = 2, Crc32c = 4 };
 
   Slice get_data() const;
 
@@ -96,6 +99,12 @@ struct BinlogEvent {
 
   static BufferSlice create_raw(uint64 id, int32 type, int32 flags, const Storer &storer);
 
+  // new events will be checksummed with hardware-accelerated CRC-32C if it is available;
+  // binlogs with such events can't be read by previous TDLib versions, so it is disabled by default
+  static void set_use_crc32c(bool use_crc32c);
+
+  static bool is_crc32c_supported();
+
   string public_to_string() const {
     return PSTRING() << "LogEvent[" << tag("id", format::as_hex(id_)) << tag("type", type_) << tag("flags", flags_)
                      << tag("data", get_data().size()) << "]" << debug_info_;
@@ -104,6 +113,11 @@ struct BinlogEvent {
   void init(string raw_event);
 
   Status validate() const TD_WARN_UNUSED_RESULT;
+
+ private:
+  static std::atomic<bool> use_crc32c_;
+
+  static uint32 calc_crc(int32 flags, Slice data);
 };
 
 inline StringBuilder &operator<<(StringBuilder &sb, const BinlogEvent &event) {
@@ -12,15 +12,24 @@
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Time.h"
 
+#include <atomic>
 #include <map>
 
 namespace td {
 namespace detail {
+static std::atomic<double> force_sync_delay{0.003};
+static std::atomic<uint64> sync_count{0};
+static std::atomic<uint64> synced_promise_count{0};
+
 class BinlogActor final : public Actor {
  public:
   BinlogActor(unique_ptr<Binlog> binlog, uint64 seq_no) : binlog_(std::move(binlog)), processor_(seq_no) {
   }
   void close(Promise<> promise) {
+    if (binlog_->need_idle_reindex()) {
+      // the binlog is replayed on the next start, so drop outdated events while it is still opened
+      binlog_->reindex();
+    }
     binlog_->close().ensure();
     LOG(INFO) << "Finished to close binlog";
     stop();
@@ -59,6 +68,9 @@ class BinlogActor final : public Actor {
     });
     flush_immediate_sync();
     try_flush();
+
+    last_event_time_ = Time::now_cached();
+    try_schedule_idle_reindex();
   }
 
   void force_sync(Promise<> &&promise, const char *source) {
@@ -92,9 +104,17 @@ class BinlogActor final : public Actor {
   bool force_sync_flag_ = false;
   bool lazy_sync_flag_ = false;
   bool flush_flag_ = false;
+  bool idle_reindex_flag_ = false;
   double wakeup_at_ = 0;
+  double last_event_time_ = 0;
 
   static constexpr double FLUSH_TIMEOUT = 0.001;  // 1ms
+  static constexpr double IDLE_REINDEX_DELAY = 10.0;  // 10s without new events
+
+  void start_up() final {
+    last_event_time_ = Time::now();
+    try_schedule_idle_reindex();
+  }
 
   void wakeup_after(double after) {
     auto now = Time::now_cached();
@@ -108,6 +128,28 @@ class BinlogActor final : public Actor {
     }
   }
 
+  void try_schedule_idle_reindex() {
+    if (!idle_reindex_flag_ && binlog_->need_idle_reindex()) {
+      idle_reindex_flag_ = true;
+      wakeup_at(last_event_time_ + IDLE_REINDEX_DELAY);
+    }
+  }
+
+  void try_idle_reindex() {
+    if (!idle_reindex_flag_) {
+      return;
+    }
+    auto reindex_at = last_event_time_ + IDLE_REINDEX_DELAY;
+    if (Time::now() < reindex_at) {
+      wakeup_at(reindex_at);
+      return;
+    }
+    idle_reindex_flag_ = false;
+    if (binlog_->need_idle_reindex()) {
+      binlog_->reindex();
+    }
+  }
+
   void do_add_raw_event(BufferSlice &&raw_event, BinlogDebugInfo info) {
     binlog_->add_raw_event(std::move(raw_event), info);
   }
@@ -139,7 +181,7 @@ class BinlogActor final : public Actor {
     }
     if (!force_sync_flag_) {
       force_sync_flag_ = true;
-      wakeup_after(0.003);
+      wakeup_after(force_sync_delay.load(std::memory_order_relaxed));
     }
   }
 
@@ -164,11 +206,14 @@ class BinlogActor final : public Actor {
     if (need_sync) {
       binlog_->sync("timeout_expired");
       // LOG(ERROR) << "BINLOG SYNC";
+      sync_count.fetch_add(1, std::memory_order_relaxed);
+      synced_promise_count.fetch_add(sync_promises_.size(), std::memory_order_relaxed);
       set_promises(sync_promises_);
     } else if (need_flush) {
       try_flush();
       // LOG(ERROR) << "BINLOG FLUSH";
     }
+    try_idle_reindex();
   }
 };
 }  // namespace detail
@@ -218,6 +263,17 @@ void ConcurrentBinlog::change_key(DbKey db_key, Promise<> promise) {
   send_closure(binlog_actor_, &detail::BinlogActor::change_key, std::move(db_key), std::move(promise));
 }
 
+void ConcurrentBinlog::set_force_sync_delay(double delay) {
+  detail::force_sync_delay.store(clamp(delay, 0.0, 1.0), std::memory_order_relaxed);
+}
+
+ConcurrentBinlog::SyncStatistics ConcurrentBinlog::get_sync_statistics() {
+  SyncStatistics result;
+  result.sync_count = detail::sync_count.load(std::memory_order_relaxed);
+  result.synced_promise_count = detail::synced_promise_count.load(std::memory_order_relaxed);
+  return result;
+}
+
 uint64 ConcurrentBinlog::erase_batch(vector<uint64> event_ids) {
   auto shift = narrow_cast<int32>(event_ids.size());
   if (shift == 0) {
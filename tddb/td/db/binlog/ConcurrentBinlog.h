@@ -58,6 +58,17 @@ class ConcurrentBinlog final : public BinlogInterface {
 
   uint64 erase_batch(vector<uint64> event_ids) final;
 
+  struct SyncStatistics {
+    uint64 sync_count = 0;            // number of performed binlog syncs
+    uint64 synced_promise_count = 0;  // number of sync promises completed by them
+  };
+
+  // sets the maximum time by which a forced sync can be postponed to share it with other forced syncs
+  static void set_force_sync_delay(double delay);
+
+  // returns process-wide sync statistics of all concurrent binlogs
+  static SyncStatistics get_sync_statistics();
+
  private:
   void init_impl(unique_ptr<Binlog> binlog, int scheduler_id);
   void close_impl(Promise<> promise) final;
@@ -5,6 +5,7 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 #include "td/db/binlog/Binlog.h"
+#include "td/db/binlog/BinlogEvent.h"
 
 #include "td/db/DbKey.h"
 
@@ -18,6 +19,7 @@
 #include "td/utils/StringBuilder.h"
 #include "td/utils/tl_parsers.h"
 
+#include <algorithm>
 #include <map>
 
 struct Trie {
@@ -93,29 +95,154 @@ struct Trie {
   }
 };
 
-enum Magic { ConfigPmcMagic = 0x1f18, BinlogPmcMagic = 0x4327 };
+enum Magic { ConfigPmcMagic = 0x1f18, BinlogPmcMagic = 0x4327, SecretChatsMagic = 1 };
+
+// type and secret chat identifier of a SecretChatEvent
+struct SecretChatEventInfo {
+  td::int32 type = 0;
+  td::int32 chat_id = 0;
+  bool is_pending = false;
+};
+
+static SecretChatEventInfo get_secret_chat_event_info(const td::BinlogEvent &event) {
+  SecretChatEventInfo result;
+  td::TlParser parser(event.get_data());
+  auto version = parser.fetch_int();
+  auto type = parser.fetch_int();
+  td::int32 chat_id = 0;
+  switch (type) {
+    case 1: {  // InboundSecretMessage
+      auto flags = parser.fetch_int();
+      result.is_pending = (flags & 2) != 0;
+      if ((flags & 4) == 0) {
+        parser.fetch_int();  // legacy qts
+      }
+      chat_id = parser.fetch_int();
+      break;
+    }
+    case 2:  // OutboundSecretMessage
+    case 4:  // CreateSecretChat
+      chat_id = parser.fetch_int();
+      break;
+    case 3:  // CloseSecretChat
+      if (version >= 3) {
+        parser.fetch_int();
+      }
+      chat_id = parser.fetch_int();
+      break;
+    default:
+      return result;
+  }
+  if (parser.get_error() == nullptr) {
+    result.type = type;
+    result.chat_id = chat_id;
+  }
+  return result;
+}
+
+static td::Slice get_secret_chat_event_type_name(td::int32 type) {
+  switch (type) {
+    case 1:
+      return td::Slice("InboundSecretMessage");
+    case 2:
+      return td::Slice("OutboundSecretMessage");
+    case 3:
+      return td::Slice("CloseSecretChat");
+    case 4:
+      return td::Slice("CreateSecretChat");
+    default:
+      return td::Slice("Unknown");
+  }
+}
+
+static td::string get_event_key(const td::BinlogEvent &event) {
+  if (event.type_ == ConfigPmcMagic || event.type_ == BinlogPmcMagic) {
+    td::TlParser parser(event.get_data());
+    auto key = parser.template fetch_string<td::Slice>();
+    if (parser.get_error() == nullptr) {
+      return key.str();
+    }
+  }
+  return td::string();
+}
+
+static td::StringBuilder::FixedDouble get_percentage(std::size_t part, std::size_t total) {
+  return td::StringBuilder::FixedDouble(total == 0 ? 0.0 : static_cast<double>(part) * 100.0 / static_cast<double>(total),
+                                        2);
+}
+
+static void print_usage() {
+  LOG(PLAIN) << "Usage: binlog_dump [--stats] [--compact] <binlog_file_name>";
+  LOG(PLAIN) << "  --stats    print only statistics about live and outdated events instead of all events";
+  LOG(PLAIN) << "  --compact  rewrite the binlog keeping only live events";
+}
 
 int main(int argc, char *argv[]) {
-  if (argc < 2) {
-    LOG(PLAIN) << "Usage: binlog_dump <binlog_file_name>";
+  bool only_stats = false;
+  bool need_compact = false;
+  td::string binlog_file_name;
+  for (int i = 1; i < argc; i++) {
+    td::Slice arg(argv[i]);
+    if (arg == "--stats") {
+      only_stats = true;
+    } else if (arg == "--compact") {
+      need_compact = true;
+    } else if (binlog_file_name.empty() && !td::begins_with(arg, "--")) {
+      binlog_file_name = arg.str();
+    } else {
+      print_usage();
+      return 1;
+    }
+  }
+  if (binlog_file_name.empty()) {
+    print_usage();
     return 1;
   }
-  td::string binlog_file_name = argv[1];
   auto r_stat = td::stat(binlog_file_name);
   if (r_stat.is_error() || r_stat.ok().size_ == 0 || !r_stat.ok().is_reg_) {
     LOG(PLAIN) << "Wrong binlog file name specified";
-    LOG(PLAIN) << "Usage: binlog_dump <binlog_file_name>";
+    print_usage();
     return 1;
   }
 
   struct Info {
     std::size_t full_size = 0;
     std::size_t compressed_size = 0;
+    std::size_t event_count = 0;
+    std::size_t live_event_count = 0;
+    std::size_t rewrite_count = 0;
+    std::size_t erase_count = 0;
     Trie trie;
     Trie compressed_trie;
   };
   std::map<td::uint64, Info> info;
 
+  // type of the last event with the given identifier; used to attribute erase events
+  std::map<td::uint64, td::int32> event_types;
+
+  struct LiveEvent {
+    std::size_t size;
+    td::uint64 event_id;
+    td::int32 type;
+    td::string key;
+
+    bool operator<(const LiveEvent &other) const {
+      return size > other.size;
+    }
+  };
+  constexpr std::size_t MAX_LARGEST_EVENTS = 20;
+  td::vector<LiveEvent> largest_events;
+
+  // live secret chat events, which are replayed on every start
+  struct SecretChatEventStat {
+    std::size_t size = 0;
+    std::size_t count = 0;
+    std::size_t pending_count = 0;
+  };
+  std::map<td::int32, SecretChatEventStat> secret_chat_event_types;
+  std::map<td::int32, SecretChatEventStat> secret_chats;
+  constexpr std::size_t MAX_LARGEST_SECRET_CHATS = 10;
+
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
   td::Binlog binlog;
   binlog
@@ -123,36 +250,143 @@ int main(int argc, char *argv[]) {
           binlog_file_name,
           [&](auto &event) {
             info[0].compressed_size += event.raw_event_.size();
-            info[event.type_].compressed_size += event.raw_event_.size();
-            if (event.type_ == ConfigPmcMagic || event.type_ == BinlogPmcMagic) {
-              auto key = td::TlParser(event.get_data()).template fetch_string<td::Slice>();
-              info[event.type_].compressed_trie.add(key);
+            info[0].live_event_count++;
+            auto &type_info = info[event.type_];
+            type_info.compressed_size += event.raw_event_.size();
+            type_info.live_event_count++;
+            auto key = get_event_key(event);
+            if (!key.empty()) {
+              type_info.compressed_trie.add(key);
+            }
+            if (event.type_ == SecretChatsMagic) {
+              auto secret_chat_event_info = get_secret_chat_event_info(event);
+              for (auto *stat : {&secret_chat_event_types[secret_chat_event_info.type],
+                                 &secret_chats[secret_chat_event_info.chat_id]}) {
+                stat->size += event.raw_event_.size();
+                stat->count++;
+                if (secret_chat_event_info.is_pending) {
+                  stat->pending_count++;
+                }
+              }
+            }
+            if (event.type_ >= 0) {
+              largest_events.push_back(LiveEvent{event.raw_event_.size(), event.id_, event.type_, std::move(key)});
+              if (largest_events.size() >= 2 * MAX_LARGEST_EVENTS) {
+                std::nth_element(largest_events.begin(), largest_events.begin() + (MAX_LARGEST_EVENTS - 1),
+                                 largest_events.end());
+                largest_events.resize(MAX_LARGEST_EVENTS);
+              }
             }
           },
           td::DbKey::raw_key("cucumber"), td::DbKey::empty(), -1,
           [&](auto &event) mutable {
             info[0].full_size += event.raw_event_.size();
-            info[event.type_].full_size += event.raw_event_.size();
-            if (event.type_ == ConfigPmcMagic || event.type_ == BinlogPmcMagic) {
-              auto key = td::TlParser(event.get_data()).template fetch_string<td::Slice>();
-              info[event.type_].trie.add(key);
+            info[0].event_count++;
+            td::int32 type = event.type_;
+            bool is_erase = type == td::BinlogEvent::ServiceTypes::Empty &&
+                            (event.flags_ & td::BinlogEvent::Flags::Rewrite) != 0;
+            if (is_erase || (event.flags_ & td::BinlogEvent::Flags::Rewrite) != 0) {
+              auto it = event_types.find(event.id_);
+              if (it != event_types.end()) {
+                if (is_erase) {
+                  type = it->second;
+                  event_types.erase(it);
+                } else {
+                  it->second = type;
+                }
+              }
+            } else if (type >= 0) {
+              event_types[event.id_] = type;
+            }
+
+            auto &type_info = info[type];
+            type_info.full_size += event.raw_event_.size();
+            type_info.event_count++;
+            if (is_erase) {
+              type_info.erase_count++;
+              info[0].erase_count++;
+            } else if ((event.flags_ & td::BinlogEvent::Flags::Rewrite) != 0) {
+              type_info.rewrite_count++;
+              info[0].rewrite_count++;
+            }
+            auto key = get_event_key(event);
+            if (!key.empty()) {
+              type_info.trie.add(key);
+            }
+            if (!only_stats) {
+              LOG(PLAIN) << "LogEvent[" << td::tag("event_id", td::format::as_hex(event.id_))
+                         << td::tag("type", event.type_) << td::tag("flags", event.flags_)
+                         << td::tag("size", event.get_data().size())
+                         << td::tag("data", td::format::escaped(event.get_data())) << "]\n";
             }
-            LOG(PLAIN) << "LogEvent[" << td::tag("event_id", td::format::as_hex(event.id_))
-                       << td::tag("type", event.type_) << td::tag("flags", event.flags_)
-                       << td::tag("size", event.get_data().size())
-                       << td::tag("data", td::format::escaped(event.get_data())) << "]\n";
           })
       .ensure();
 
   for (auto &it : info) {
+    auto &type_info = it.second;
+    auto dead_size = type_info.full_size - td::min(type_info.full_size, type_info.compressed_size);
     LOG(PLAIN) << td::tag("handler", td::format::as_hex(it.first))
-               << td::tag("full_size", td::format::as_size(it.second.full_size))
-               << td::tag("compressed_size", td::format::as_size(it.second.compressed_size));
-    it.second.trie.dump();
-    if (it.second.full_size != it.second.compressed_size) {
-      it.second.compressed_trie.dump();
+               << td::tag("full_size", td::format::as_size(type_info.full_size))
+               << td::tag("compressed_size", td::format::as_size(type_info.compressed_size))
+               << td::tag("dead_size", td::format::as_size(dead_size)) << td::tag("events", type_info.event_count)
+               << td::tag("live_events", type_info.live_event_count)
+               << td::tag("rewrites", type_info.rewrite_count) << td::tag("erases", type_info.erase_count);
+    if (type_info.event_count != 0) {
+      LOG(PLAIN) << "rewrite ratio: " << get_percentage(type_info.rewrite_count, type_info.event_count)
+                 << "%, erase ratio: " << get_percentage(type_info.erase_count, type_info.event_count)
+                 << "%, dead bytes: " << get_percentage(dead_size, type_info.full_size) << "%";
+    }
+    type_info.trie.dump();
+    if (type_info.full_size != type_info.compressed_size) {
+      type_info.compressed_trie.dump();
     }
   }
 
+  std::sort(largest_events.begin(), largest_events.end());
+  if (largest_events.size() > MAX_LARGEST_EVENTS) {
+    largest_events.resize(MAX_LARGEST_EVENTS);
+  }
+  if (!largest_events.empty()) {
+    LOG(PLAIN) << "Largest live events:";
+  }
+  for (auto &event : largest_events) {
+    LOG(PLAIN) << td::tag("event_id", td::format::as_hex(event.event_id))
+               << td::tag("handler", td::format::as_hex(event.type))
+               << td::tag("size", td::format::as_size(event.size))
+               << td::tag("key", td::format::escaped(event.key));
+  }
+
+  if (!secret_chat_event_types.empty()) {
+    LOG(PLAIN) << "Live secret chat events:";
+  }
+  for (auto &it : secret_chat_event_types) {
+    LOG(PLAIN) << td::tag("type", get_secret_chat_event_type_name(it.first))
+               << td::tag("size", td::format::as_size(it.second.size)) << td::tag("events", it.second.count)
+               << td::tag("pending", it.second.pending_count);
+  }
+  if (!secret_chats.empty()) {
+    td::vector<std::pair<td::int32, SecretChatEventStat>> largest_secret_chats(secret_chats.begin(),
+                                                                               secret_chats.end());
+    std::sort(largest_secret_chats.begin(), largest_secret_chats.end(),
+              [](const auto &lhs, const auto &rhs) { return lhs.second.size > rhs.second.size; });
+    if (largest_secret_chats.size() > MAX_LARGEST_SECRET_CHATS) {
+      largest_secret_chats.resize(MAX_LARGEST_SECRET_CHATS);
+    }
+    LOG(PLAIN) << "Secret chats with the largest live events " << td::tag("total_chats", secret_chats.size()) << ":";
+    for (auto &it : largest_secret_chats) {
+      LOG(PLAIN) << td::tag("chat_id", it.first) << td::tag("size", td::format::as_size(it.second.size))
+                 << td::tag("events", it.second.count) << td::tag("pending", it.second.pending_count);
+    }
+  }
+
+  if (need_compact) {
+    auto old_size = r_stat.ok().size_;
+    binlog.reindex();
+    binlog.close().ensure();
+    auto new_size = td::stat(binlog_file_name).move_as_ok().size_;
+    LOG(PLAIN) << "Compacted binlog " << td::tag("old_size", td::format::as_size(old_size))
+               << td::tag("new_size", td::format::as_size(new_size));
+  }
+
   return 0;
 }
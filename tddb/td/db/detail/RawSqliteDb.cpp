@@ -8,6 +8,7 @@
 
 #include "sqlite/sqlite3.h"
 
+#include "td/utils/algorithm.h"
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
@@ -51,7 +52,31 @@ bool RawSqliteDb::was_any_database_destroyed() {
   return was_database_destroyed.load(std::memory_order_relaxed);
 }
 
+tdsqlite3_stmt *RawSqliteDb::get_cached_statement(Slice statement) {
+  for (size_t i = cached_statements_.size(); i-- > 0;) {
+    auto *stmt = cached_statements_[i];
+    if (CSlice(tdsqlite3_sql(stmt)) == statement) {
+      cached_statements_.erase(cached_statements_.begin() + i);
+      return stmt;
+    }
+  }
+  return nullptr;
+}
+
+void RawSqliteDb::put_cached_statement(tdsqlite3_stmt *stmt) {
+  CHECK(stmt != nullptr);
+  if (cached_statements_.size() == MAX_CACHED_STATEMENT_COUNT) {
+    tdsqlite3_finalize(cached_statements_[0]);
+    cached_statements_.erase(cached_statements_.begin());
+  }
+  cached_statements_.push_back(stmt);
+}
+
 RawSqliteDb::~RawSqliteDb() {
+  for (auto *stmt : cached_statements_) {
+    tdsqlite3_finalize(stmt);
+  }
+  cached_statements_.clear();
   auto rc = tdsqlite3_close(db_);
   LOG_IF(FATAL, rc != SQLITE_OK) << last_error(db_, path());
 }
@@ -6,12 +6,14 @@
 //
 #pragma once
 
+#include "td/utils/common.h"
 #include "td/utils/optional.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 
 struct tdsqlite3;
+struct tdsqlite3_stmt;
 
 namespace td {
 namespace detail {
@@ -67,11 +69,20 @@ class RawSqliteDb {
     return cipher_version_.copy();
   }
 
+  // returns an unused prepared statement with the given text or nullptr
+  tdsqlite3_stmt *get_cached_statement(Slice statement);
+
+  // takes ownership of a reset statement, which has no more users
+  void put_cached_statement(tdsqlite3_stmt *stmt);
+
  private:
+  static constexpr size_t MAX_CACHED_STATEMENT_COUNT = 32;
+
   tdsqlite3 *db_;
   std::string path_;
   size_t begin_cnt_{0};
   optional<int32> cipher_version_;
+  vector<tdsqlite3_stmt *> cached_statements_;  // the least recently used statements go first
 };
 
 }  // namespace detail
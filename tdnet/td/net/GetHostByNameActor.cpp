@@ -18,26 +18,28 @@
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Time.h"
 
+#include <mutex>
+
 namespace td {
 namespace detail {
 
 class GoogleDnsResolver final : public Actor {
  public:
-  GoogleDnsResolver(std::string host, bool prefer_ipv6, Promise<IPAddress> promise)
+  GoogleDnsResolver(std::string host, bool prefer_ipv6, Promise<ResolvedIpAddress> promise)
       : host_(std::move(host)), prefer_ipv6_(prefer_ipv6), promise_(std::move(promise)) {
   }
 
  private:
   std::string host_;
   bool prefer_ipv6_;
-  Promise<IPAddress> promise_;
+  Promise<ResolvedIpAddress> promise_;
   ActorOwn<Wget> wget_;
   double begin_time_ = 0;
 
   void start_up() final {
     auto r_address = IPAddress::get_ip_address(host_);
     if (r_address.is_ok()) {
-      promise_.set_value(r_address.move_as_ok());
+      promise_.set_value(ResolvedIpAddress{r_address.move_as_ok(), 0});
       return stop();
     }
 
@@ -54,10 +56,10 @@ class GoogleDnsResolver final : public Actor {
         SslCtx::VerifyPeer::Off);
   }
 
-  static Result<IPAddress> get_ip_address(Result<unique_ptr<HttpQuery>> r_http_query) {
+  static Result<ResolvedIpAddress> get_ip_address(Result<unique_ptr<HttpQuery>> r_http_query) {
     TRY_RESULT(http_query, std::move(r_http_query));
 
-    auto get_ip_address = [](JsonValue &answer) -> Result<IPAddress> {
+    auto get_ip_address = [](JsonValue &answer) -> Result<ResolvedIpAddress> {
       auto &array = answer.get_array();
       if (array.empty()) {
         return Status::Error("Failed to parse DNS result: Answer is an empty array");
@@ -67,9 +69,11 @@ class GoogleDnsResolver final : public Actor {
       }
       auto &answer_0 = array[0].get_object();
       TRY_RESULT(ip_str, answer_0.get_required_string_field("data"));
-      IPAddress ip;
-      TRY_STATUS(ip.init_host_port(ip_str, 0));
-      return ip;
+      TRY_RESULT(ttl, answer_0.get_optional_int_field("TTL"));
+      ResolvedIpAddress result;
+      TRY_STATUS(result.ip_address.init_host_port(ip_str, 0));
+      result.ttl = max(ttl, 0);
+      return result;
     };
     if (!http_query->get_arg("Answer").empty()) {
       TRY_RESULT(answer, json_decode(http_query->get_arg("Answer")));
@@ -93,7 +97,7 @@ class GoogleDnsResolver final : public Actor {
     auto result = get_ip_address(std::move(r_http_query));
     VLOG(dns_resolver) << "Init IPv" << (prefer_ipv6_ ? "6" : "4") << " host = " << host_ << " in "
                        << end_time - begin_time_ << " seconds to "
-                       << (result.is_ok() ? (PSLICE() << result.ok()) : CSlice("[invalid]"));
+                       << (result.is_ok() ? (PSLICE() << result.ok().ip_address) : CSlice("[invalid]"));
     promise_.set_result(std::move(result));
     stop();
   }
@@ -101,14 +105,14 @@ class GoogleDnsResolver final : public Actor {
 
 class NativeDnsResolver final : public Actor {
  public:
-  NativeDnsResolver(std::string host, bool prefer_ipv6, Promise<IPAddress> promise)
+  NativeDnsResolver(std::string host, bool prefer_ipv6, Promise<ResolvedIpAddress> promise)
       : host_(std::move(host)), prefer_ipv6_(prefer_ipv6), promise_(std::move(promise)) {
   }
 
  private:
   std::string host_;
   bool prefer_ipv6_;
-  Promise<IPAddress> promise_;
+  Promise<ResolvedIpAddress> promise_;
 
   void start_up() final {
     IPAddress ip;
@@ -119,16 +123,33 @@ class NativeDnsResolver final : public Actor {
     if (status.is_error()) {
       promise_.set_error(std::move(status));
     } else {
-      promise_.set_value(std::move(ip));
+      // getaddrinfo doesn't return TTL of the address
+      promise_.set_value(ResolvedIpAddress{std::move(ip), 0});
     }
     stop();
   }
 };
 
+struct SharedDnsCache {
+  struct Value {
+    IPAddress ip_address;
+    double expires_at = 0.0;
+  };
+  std::mutex mutex;
+  FlatHashMap<string, Value> values[2];
+};
+
+static SharedDnsCache &get_shared_dns_cache() {
+  static SharedDnsCache cache;
+  return cache;
+}
+
 }  // namespace detail
 
 int VERBOSITY_NAME(dns_resolver) = VERBOSITY_NAME(DEBUG);
 
+constexpr double GetHostByNameActor::REFRESH_TIME_PART;
+
 GetHostByNameActor::GetHostByNameActor(Options options) : options_(std::move(options)) {
   CHECK(!options_.resolver_types.empty());
 }
@@ -145,8 +166,31 @@ void GetHostByNameActor::run(string host, int port, bool prefer_ipv6, Promise<IP
 
   auto begin_time = Time::now();
   auto &value = cache_[prefer_ipv6].emplace(ascii_host, Value{{}, begin_time - 1.0}).first->second;
+  if (value.expires_at <= begin_time && options_.use_shared_cache) {
+    auto &shared_cache = detail::get_shared_dns_cache();
+    std::lock_guard<std::mutex> lock(shared_cache.mutex);
+    auto it = shared_cache.values[prefer_ipv6].find(ascii_host);
+    if (it != shared_cache.values[prefer_ipv6].end() && it->second.expires_at > begin_time) {
+      VLOG(dns_resolver) << "Use shared cache for host = " << host;
+      auto expires_at = min(it->second.expires_at, begin_time + options_.ok_timeout);
+      value = Value{it->second.ip_address, expires_at};
+      if (options_.refresh_before_expiration) {
+        value.refresh_at = begin_time + (expires_at - begin_time) * REFRESH_TIME_PART;
+      }
+    }
+  }
   if (value.expires_at > begin_time) {
-    return promise.set_result(value.get_ip_port(port));
+    bool was_used = value.is_used;
+    value.is_used = true;
+    promise.set_result(value.get_ip_port(port));
+    if (value.refresh_at != 0.0) {
+      if (value.refresh_at <= begin_time) {
+        start_refresh(ascii_host, prefer_ipv6);
+      } else if (!was_used) {
+        update_refresh_timeout();
+      }
+    }
+    return;
   }
 
   auto &query_ptr = active_queries_[prefer_ipv6][ascii_host];
@@ -163,10 +207,60 @@ void GetHostByNameActor::run(string host, int port, bool prefer_ipv6, Promise<IP
   }
 }
 
+void GetHostByNameActor::start_refresh(const string &host, bool prefer_ipv6) {
+  auto &query_ptr = active_queries_[prefer_ipv6][host];
+  if (query_ptr != nullptr) {
+    return;
+  }
+  VLOG(dns_resolver) << "Refresh host = " << host;
+  auto value_it = cache_[prefer_ipv6].find(host);
+  CHECK(value_it != cache_[prefer_ipv6].end());
+  value_it->second.refresh_at = 0.0;
+  query_ptr = make_unique<Query>();
+  query_ptr->real_host = host;
+  query_ptr->begin_time = Time::now();
+  run_query(host, prefer_ipv6, *query_ptr);
+}
+
+void GetHostByNameActor::update_refresh_timeout() {
+  double refresh_at = 0.0;
+  for (auto &cache : cache_) {
+    for (auto &it : cache) {
+      auto &value = it.second;
+      if (value.refresh_at != 0.0 && value.is_used && (refresh_at == 0.0 || value.refresh_at < refresh_at)) {
+        refresh_at = value.refresh_at;
+      }
+    }
+  }
+  if (refresh_at == 0.0) {
+    cancel_timeout();
+  } else {
+    set_timeout_at(refresh_at);
+  }
+}
+
+void GetHostByNameActor::timeout_expired() {
+  auto now = Time::now();
+  vector<std::pair<string, bool>> hosts;
+  for (int prefer_ipv6 = 0; prefer_ipv6 < 2; prefer_ipv6++) {
+    for (auto &it : cache_[prefer_ipv6]) {
+      auto &value = it.second;
+      if (value.refresh_at != 0.0 && value.is_used && value.refresh_at <= now) {
+        hosts.emplace_back(it.first, prefer_ipv6 != 0);
+      }
+    }
+  }
+  for (auto &host : hosts) {
+    start_refresh(host.first, host.second);
+  }
+  update_refresh_timeout();
+}
+
 void GetHostByNameActor::run_query(std::string host, bool prefer_ipv6, Query &query) {
-  auto promise = PromiseCreator::lambda([actor_id = actor_id(this), host, prefer_ipv6](Result<IPAddress> res) mutable {
-    send_closure(actor_id, &GetHostByNameActor::on_query_result, std::move(host), prefer_ipv6, std::move(res));
-  });
+  auto promise = PromiseCreator::lambda(
+      [actor_id = actor_id(this), host, prefer_ipv6](Result<detail::ResolvedIpAddress> res) mutable {
+        send_closure(actor_id, &GetHostByNameActor::on_query_result, std::move(host), prefer_ipv6, std::move(res));
+      });
 
   CHECK(query.query.empty());
   CHECK(query.pos < options_.resolver_types.size());
@@ -186,11 +280,11 @@ void GetHostByNameActor::run_query(std::string host, bool prefer_ipv6, Query &qu
   }();
 }
 
-void GetHostByNameActor::on_query_result(std::string host, bool prefer_ipv6, Result<IPAddress> result) {
+void GetHostByNameActor::on_query_result(std::string host, bool prefer_ipv6,
+                                         Result<detail::ResolvedIpAddress> result) {
   auto query_it = active_queries_[prefer_ipv6].find(host);
   CHECK(query_it != active_queries_[prefer_ipv6].end());
   auto &query = *query_it->second;
-  CHECK(!query.promises.empty());
   CHECK(!query.query.empty());
 
   if (result.is_error() && query.pos < options_.resolver_types.size()) {
@@ -200,17 +294,46 @@ void GetHostByNameActor::on_query_result(std::string host, bool prefer_ipv6, Res
 
   auto end_time = Time::now();
   VLOG(dns_resolver) << "Init host = " << query.real_host << " in total of " << end_time - query.begin_time
-                     << " seconds to " << (result.is_ok() ? (PSLICE() << result.ok()) : CSlice("[invalid]"));
+                     << " seconds to " << (result.is_ok() ? (PSLICE() << result.ok().ip_address) : CSlice("[invalid]"));
 
   auto promises = std::move(query.promises);
   auto value_it = cache_[prefer_ipv6].find(host);
   CHECK(value_it != cache_[prefer_ipv6].end());
-  auto cache_timeout = result.is_ok() ? options_.ok_timeout : options_.error_timeout;
-  value_it->second = Value{std::move(result), end_time + cache_timeout};
   active_queries_[prefer_ipv6].erase(query_it);
+  auto &value = value_it->second;
+  if (result.is_error()) {
+    if (value.ip.is_ok() && value.expires_at > end_time) {
+      // failed refresh; keep the previous address until it expires
+      value.refresh_at = 0.0;
+    } else {
+      value = Value{result.move_as_error(), end_time + options_.error_timeout};
+    }
+  } else {
+    auto resolved = result.move_as_ok();
+    auto cache_timeout = options_.ok_timeout;
+    if (resolved.ttl > 0 && resolved.ttl < cache_timeout) {
+      cache_timeout = resolved.ttl;
+    }
+    value = Value{resolved.ip_address, end_time + cache_timeout};
+    if (options_.refresh_before_expiration) {
+      // after a background refresh the address is refreshed again only if it is used
+      value.refresh_at = end_time + cache_timeout * REFRESH_TIME_PART;
+      value.is_used = !promises.empty();
+    }
+    if (options_.use_shared_cache) {
+      auto &shared_cache = detail::get_shared_dns_cache();
+      std::lock_guard<std::mutex> lock(shared_cache.mutex);
+      auto &shared_value = shared_cache.values[prefer_ipv6][host];
+      shared_value.ip_address = resolved.ip_address;
+      shared_value.expires_at = end_time + cache_timeout;
+    }
+  }
+  if (options_.refresh_before_expiration) {
+    update_refresh_timeout();
+  }
 
   for (auto &promise : promises) {
-    promise.second.set_result(value_it->second.get_ip_port(promise.first));
+    promise.second.set_result(value.get_ip_port(promise.first));
   }
 }
 
@@ -21,6 +21,13 @@ namespace td {
 
 extern int VERBOSITY_NAME(dns_resolver);
 
+namespace detail {
+struct ResolvedIpAddress {
+  IPAddress ip_address;
+  int32 ttl = 0;  // 0 if unknown
+};
+}  // namespace detail
+
 class GetHostByNameActor final : public Actor {
  public:
   enum class ResolverType { Native, Google };
@@ -33,6 +40,10 @@ class GetHostByNameActor final : public Actor {
     int32 scheduler_id{-1};
     int32 ok_timeout{DEFAULT_CACHE_TIME};
     int32 error_timeout{DEFAULT_ERROR_CACHE_TIME};
+    // successfully resolved addresses are shared with other actors in the process, which use the shared cache
+    bool use_shared_cache{false};
+    // used addresses are resolved again in background before they expire
+    bool refresh_before_expiration{false};
   };
 
   explicit GetHostByNameActor(Options options);
@@ -40,11 +51,16 @@ class GetHostByNameActor final : public Actor {
   void run(std::string host, int port, bool prefer_ipv6, Promise<IPAddress> promise);
 
  private:
-  void on_query_result(std::string host, bool prefer_ipv6, Result<IPAddress> result);
+  void on_query_result(std::string host, bool prefer_ipv6, Result<detail::ResolvedIpAddress> result);
+
+  // a part of the lifetime of a cached address after which it is resolved again if it was used
+  static constexpr double REFRESH_TIME_PART = 0.75;
 
   struct Value {
     Result<IPAddress> ip;
     double expires_at;
+    double refresh_at = 0.0;  // 0 if the address must not be refreshed
+    bool is_used = false;
 
     Value(Result<IPAddress> ip, double expires_at) : ip(std::move(ip)), expires_at(expires_at) {
     }
@@ -71,6 +87,12 @@ class GetHostByNameActor final : public Actor {
   Options options_;
 
   void run_query(std::string host, bool prefer_ipv6, Query &query);
+
+  void start_refresh(const string &host, bool prefer_ipv6);
+
+  void update_refresh_timeout();
+
+  void timeout_expired() final;
 };
 
 }  // namespace td
@@ -16,6 +16,8 @@
 namespace td {
 namespace detail {
 
+constexpr size_t HttpConnectionBase::MAX_READ_SIZE;
+
 HttpConnectionBase::HttpConnectionBase(State state, BufferedFd<SocketFd> fd, SslStream ssl_stream, size_t max_post_size,
                                        size_t max_files, int32 idle_timeout, int32 slow_scheduler_id)
     : state_(state)
@@ -98,9 +100,10 @@ void HttpConnectionBase::loop() {
     ssl_stream_.write_byte_flow().reset_need_size();
   }
   sync_with_poll(fd_);
+  bool has_unread_data = false;
   if (can_read_local(fd_)) {
     LOG(DEBUG) << "Can read from the connection";
-    auto r = fd_.flush_read();
+    auto r = fd_.flush_read(MAX_READ_SIZE);
     if (r.is_error()) {
       if (!begins_with(r.error().message(), "SSL error {336134278")) {  // if error is not yet outputted
         LOG(INFO) << "Receive flush_read error: " << r.error();
@@ -108,6 +111,7 @@ void HttpConnectionBase::loop() {
       on_error(Status::Error(r.error().public_message()));
       return stop();
     }
+    has_unread_data = r.ok() == MAX_READ_SIZE && can_read_local(fd_);
   }
   read_source_.wakeup();
 
@@ -195,6 +199,11 @@ void HttpConnectionBase::loop() {
     }
     return stop();
   }
+
+  if (has_unread_data && state_ == State::Read) {
+    // the socket isn't polled again until the rest of the data is read
+    yield();
+  }
 }
 
 void HttpConnectionBase::on_start_migrate(int32 sched_id) {
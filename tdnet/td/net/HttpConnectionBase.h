@@ -59,6 +59,10 @@ class HttpConnectionBase : public Actor {
 
   int32 slow_scheduler_id_{-1};
 
+  // maximum amount of data read from the socket at once; the rest is read after the read data is processed,
+  // so memory used by uploaded files doesn't depend on the speed of the client
+  static constexpr size_t MAX_READ_SIZE = 1 << 20;
+
   void live_event();
 
   void start_up() final;
@@ -163,10 +163,7 @@ Result<size_t> HttpReader::do_read_next(bool can_be_slow) {
       case State::ReadContent: {
         if (content_->size() > max_post_size_) {
           state_ = State::ReadContentToFile;
-          GzipByteFlow::Options options;
-          options.write_watermark.low = 4 << 20;
-          options.write_watermark.high = 8 << 20;
-          gzip_flow_.set_options(options);
+          set_file_write_watermark();
           continue;
         }
         if (flow_sink_.is_ready()) {
@@ -193,7 +190,7 @@ Result<size_t> HttpReader::do_read_next(bool can_be_slow) {
         auto size = content_->size();
         bool restart = false;
         if (size > (1 << 20) || flow_sink_.is_ready()) {
-          TRY_STATUS(save_file_part(content_->cut_head(size).move_as_buffer_slice()));
+          TRY_STATUS(save_file_part(content_->cut_head(size)));
           restart = true;
         }
         if (flow_sink_.is_ready()) {
@@ -423,6 +420,7 @@ Result<bool> HttpReader::parse_multipart_form_data(bool can_be_slow) {
             // don't need to save headers for files
             file_field_name_ = field_name_.str();
             form_data_parse_state_ = FormDataParseState::ReadFile;
+            set_file_write_watermark();
           } else {
             // save headers for query parameters. They contain header names
             query_->container_.push_back(std::move(headers));
@@ -481,7 +479,7 @@ Result<bool> HttpReader::parse_multipart_form_data(bool can_be_slow) {
           }
         }
         if (find_boundary(content_->clone(), boundary_, form_data_read_length_)) {
-          auto file_part = content_->cut_head(form_data_read_length_).move_as_buffer_slice();
+          auto file_part = content_->cut_head(form_data_read_length_);
           content_->advance(boundary_.size());
           form_data_skipped_length_ += form_data_read_length_ + boundary_.size();
           form_data_read_length_ = 0;
@@ -495,8 +493,7 @@ Result<bool> HttpReader::parse_multipart_form_data(bool can_be_slow) {
           continue;
         }
 
-        // TODO optimize?
-        auto file_part = content_->cut_head(form_data_read_length_).move_as_buffer_slice();
+        auto file_part = content_->cut_head(form_data_read_length_);
         form_data_skipped_length_ += form_data_read_length_;
         form_data_read_length_ = 0;
         CHECK(content_->size() < boundary_.size());
@@ -841,7 +838,15 @@ Status HttpReader::try_open_temp_file(Slice directory_name, CSlice desired_file_
   return Status::OK();
 }
 
-Status HttpReader::save_file_part(BufferSlice &&file_part) {
+void HttpReader::set_file_write_watermark() {
+  // the content is saved to a file as soon as it is decompressed, so there is no need to keep much of it in memory
+  GzipByteFlow::Options options;
+  options.write_watermark.low = 4 << 20;
+  options.write_watermark.high = 8 << 20;
+  gzip_flow_.set_options(options);
+}
+
+Status HttpReader::save_file_part(ChainBufferReader &&file_part) {
   file_size_ += narrow_cast<int64>(file_part.size());
   if (file_size_ > MAX_FILE_SIZE) {
     clean_temporary_file();
@@ -850,10 +855,15 @@ Status HttpReader::save_file_part(BufferSlice &&file_part) {
   }
 
   LOG(DEBUG) << "Save file part of size " << file_part.size() << " to file " << temp_file_name_;
-  auto result_written = temp_file_.write(file_part.as_slice());
-  if (result_written.is_error() || result_written.ok() != file_part.size()) {
-    clean_temporary_file();
-    return Status::Error(500, "Internal Server Error: can't upload the file");
+  // write the received chunks as is to avoid copying of the whole part into a contiguous buffer
+  while (!file_part.empty()) {
+    auto chunk = file_part.prepare_read();
+    auto result_written = temp_file_.write(chunk);
+    if (result_written.is_error() || result_written.ok() != chunk.size()) {
+      clean_temporary_file();
+      return Status::Error(500, "Internal Server Error: can't upload the file");
+    }
+    file_part.confirm_read(chunk.size());
   }
   return Status::OK();
 }
@@ -9,6 +9,7 @@
 #include "td/utils/common.h"
 #include "td/utils/crypto.h"
 #include "td/utils/FlatHashMap.h"
+#include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/port/path.h"
@@ -24,8 +25,10 @@
 #include <openssl/x509_vfy.h>
 
 #include <cstring>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 #if TD_PORT_WINDOWS
 #include <wincrypt.h>
@@ -151,6 +154,127 @@ X509_STORE *load_system_certificate_store() {
   return store;
 }
 
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+// TLS sessions for resumption of subsequent connections to the same host, which skips certificate verification and
+// saves a round trip; sessions are saved per SSL context, so a session can't be resumed with different verification
+// settings, and are forgotten when the context is destroyed
+class SslSessionCache {
+ public:
+  static SslSessionCache &get() {
+    // never destroyed, because static SSL contexts can be destroyed after it
+    static SslSessionCache *cache = new SslSessionCache();
+    return *cache;
+  }
+
+  void add(const SSL_CTX *ssl_ctx, string host, SSL_SESSION *session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (session_count_ >= MAX_SESSIONS) {
+      for (auto &it : sessions_) {
+        free_sessions(it.second);
+      }
+      sessions_.clear();
+      session_count_ = 0;
+    }
+    auto &sessions = sessions_[std::make_pair(ssl_ctx, std::move(host))];
+    if (sessions.size() == MAX_HOST_SESSIONS) {
+      SSL_SESSION_free(sessions[0]);
+      sessions.erase(sessions.begin());
+      session_count_--;
+    }
+    sessions.push_back(session);
+    session_count_++;
+    stats_.saved_session_count++;
+  }
+
+  // returns a new reference to a saved session or nullptr
+  SSL_SESSION *get_session(const SSL_CTX *ssl_ctx, string host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(std::make_pair(ssl_ctx, std::move(host)));
+    while (it != sessions_.end() && !it->second.empty()) {
+      auto &sessions = it->second;
+      auto *session = sessions.back();
+      if (!is_resumable(session)) {
+        SSL_SESSION_free(session);
+        sessions.pop_back();
+        session_count_--;
+        continue;
+      }
+#ifdef TLS1_3_VERSION
+      if (SSL_SESSION_get_protocol_version(session) >= TLS1_3_VERSION) {
+        // TLS 1.3 tickets must not be reused; the server sends new tickets after each handshake
+        sessions.pop_back();
+        session_count_--;
+        stats_.hit_count++;
+        return session;
+      }
+#endif
+      SSL_SESSION_up_ref(session);
+      stats_.hit_count++;
+      return session;
+    }
+    stats_.miss_count++;
+    return nullptr;
+  }
+
+  void remove_ssl_ctx(const SSL_CTX *ssl_ctx) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.lower_bound(std::make_pair(ssl_ctx, string()));
+    while (it != sessions_.end() && it->first.first == ssl_ctx) {
+      session_count_ -= it->second.size();
+      free_sessions(it->second);
+      it = sessions_.erase(it);
+    }
+  }
+
+  SslCtx::SessionCacheStats get_stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto result = stats_;
+    result.session_count = session_count_;
+    return result;
+  }
+
+ private:
+  static constexpr size_t MAX_SESSIONS = 1000;
+  static constexpr size_t MAX_HOST_SESSIONS = 4;
+
+  std::mutex mutex_;
+  std::map<std::pair<const SSL_CTX *, string>, vector<SSL_SESSION *>> sessions_;
+  size_t session_count_ = 0;
+  SslCtx::SessionCacheStats stats_;
+
+  static bool is_resumable(const SSL_SESSION *session) {
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    return SSL_SESSION_is_resumable(session) != 0;
+#else
+    return true;
+#endif
+  }
+
+  static void free_sessions(vector<SSL_SESSION *> &sessions) {
+    for (auto *session : sessions) {
+      SSL_SESSION_free(session);
+    }
+    sessions.clear();
+  }
+};
+
+int on_new_ssl_session(SSL *ssl, SSL_SESSION *session) {
+  auto host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+  if (host == nullptr) {
+    return 0;
+  }
+  SslSessionCache::get().add(SSL_get_SSL_CTX(ssl), string(host), session);
+  return 1;  // the cache took ownership of the session
+}
+#endif
+
+void free_ssl_ctx(SSL_CTX *ssl_ctx) {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+  SslSessionCache::get().remove_ssl_ctx(ssl_ctx);
+#endif
+  SSL_CTX_free(ssl_ctx);
+}
+
 using SslCtxPtr = std::shared_ptr<SSL_CTX>;
 
 Result<SslCtxPtr> do_create_ssl_ctx(CSlice cert_file, SslCtx::VerifyPeer verify_peer) {
@@ -167,7 +291,7 @@ Result<SslCtxPtr> do_create_ssl_ctx(CSlice cert_file, SslCtx::VerifyPeer verify_
   if (!ssl_ctx) {
     return create_openssl_error(-7, "Failed to create an SSL context");
   }
-  auto ssl_ctx_ptr = SslCtxPtr(ssl_ctx, SSL_CTX_free);
+  auto ssl_ctx_ptr = SslCtxPtr(ssl_ctx, free_ssl_ctx);
   long options = 0;
 #ifdef SSL_OP_NO_SSLv2
   options |= SSL_OP_NO_SSLv2;
@@ -180,6 +304,10 @@ Result<SslCtxPtr> do_create_ssl_ctx(CSlice cert_file, SslCtx::VerifyPeer verify_
   SSL_CTX_set_min_proto_version(ssl_ctx, TLS1_VERSION);
 #endif
   SSL_CTX_set_mode(ssl_ctx, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_ENABLE_PARTIAL_WRITE);
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+  SSL_CTX_set_session_cache_mode(ssl_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(ssl_ctx, on_new_ssl_session);
+#endif
 
   if (cert_file.empty()) {
     auto *store = load_system_certificate_store();
@@ -321,9 +449,35 @@ void *SslCtx::get_openssl_ctx() const {
   return impl_ == nullptr ? nullptr : impl_->get_openssl_ctx();
 }
 
+void *SslCtx::get_openssl_session(CSlice host) const {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+  if (impl_ == nullptr) {
+    return nullptr;
+  }
+  auto ssl_ctx = static_cast<const SSL_CTX *>(impl_->get_openssl_ctx());
+  return static_cast<void *>(detail::SslSessionCache::get().get_session(ssl_ctx, host.str()));
+#else
+  return nullptr;
+#endif
+}
+
+SslCtx::SessionCacheStats SslCtx::get_session_cache_stats() {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+  return detail::SslSessionCache::get().get_stats();
+#else
+  return SessionCacheStats();
+#endif
+}
+
 SslCtx::SslCtx(unique_ptr<detail::SslCtxImpl> impl) : impl_(std::move(impl)) {
 }
 
+StringBuilder &operator<<(StringBuilder &string_builder, const SslCtx::SessionCacheStats &stats) {
+  return string_builder << "TlsSessionCache[" << tag("sessions", stats.session_count)
+                        << tag("saved", stats.saved_session_count) << tag("hits", stats.hit_count)
+                        << tag("misses", stats.miss_count) << ']';
+}
+
 }  // namespace td
 
 #else
@@ -362,9 +516,21 @@ void *SslCtx::get_openssl_ctx() const {
   return nullptr;
 }
 
+void *SslCtx::get_openssl_session(CSlice host) const {
+  return nullptr;
+}
+
+SslCtx::SessionCacheStats SslCtx::get_session_cache_stats() {
+  return SessionCacheStats();
+}
+
 SslCtx::SslCtx(unique_ptr<detail::SslCtxImpl> impl) : impl_(std::move(impl)) {
 }
 
+StringBuilder &operator<<(StringBuilder &string_builder, const SslCtx::SessionCacheStats &stats) {
+  return string_builder << "TlsSessionCache[]";
+}
+
 }  // namespace td
 
 #endif
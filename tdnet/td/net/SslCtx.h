@@ -6,8 +6,10 @@
 //
 #pragma once
 
+#include "td/utils/common.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
+#include "td/utils/StringBuilder.h"
 
 namespace td {
 
@@ -30,8 +32,21 @@ class SslCtx {
 
   static Result<SslCtx> create(CSlice cert_file, VerifyPeer verify_peer);
 
+  struct SessionCacheStats {
+    size_t session_count = 0;
+    uint64 saved_session_count = 0;
+    uint64 hit_count = 0;
+    uint64 miss_count = 0;
+  };
+
+  // returns statistics of the process-wide cache of TLS sessions for resumption
+  static SessionCacheStats get_session_cache_stats();
+
   void *get_openssl_ctx() const;
 
+  // returns a new reference to a saved TLS session for the host, which can be resumed, or nullptr
+  void *get_openssl_session(CSlice host) const;
+
   explicit operator bool() const noexcept {
     return static_cast<bool>(impl_);
   }
@@ -42,4 +57,6 @@ class SslCtx {
   explicit SslCtx(unique_ptr<detail::SslCtxImpl> impl);
 };
 
+StringBuilder &operator<<(StringBuilder &string_builder, const SslCtx::SessionCacheStats &stats);
+
 }  // namespace td
@@ -173,6 +173,13 @@ class SslStreamImpl {
       LOG(DEBUG) << "Set SNI host name to " << host;
       auto host_str = host.str();
       SSL_set_tlsext_host_name(ssl_handle.get(), MutableCSlice(host_str).begin());
+
+      auto session = static_cast<SSL_SESSION *>(ssl_ctx.get_openssl_session(host));
+      if (session != nullptr) {
+        LOG(DEBUG) << "Try to resume TLS session with " << host;
+        SSL_set_session(ssl_handle.get(), session);
+        SSL_SESSION_free(session);
+      }
     }
 #endif
     SSL_set_connect_state(ssl_handle.get());
@@ -15,6 +15,8 @@
 
 namespace td {
 
+// listening sockets are opened with SO_REUSEPORT, so listeners for the same port can be created on several schedulers
+// to spread accepted connections between them
 class TcpListener final : public Actor {
  public:
   class Callback : public Actor {
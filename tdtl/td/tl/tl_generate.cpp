@@ -899,6 +899,90 @@ bool write_tl_to_file(const tl_config &config, const std::string &file_name, con
   return put_file_contents(file_name, out.get_result(), w.is_documentation_generated());
 }
 
+bool write_tl_to_split_files(const tl_config &config, const std::string &file_name_prefix,
+                             const std::string &file_name_suffix, int part_count, const TL_writer &w) {
+  assert(part_count >= 1);
+  find_complex_types(config, w);
+
+  tl_string_outputer common_out;
+  common_out.append(w.gen_output_begin(std::string()));
+  common_out.append(w.gen_output_begin_once());
+
+  std::set<std::string> request_types;
+  std::set<std::string> result_types;
+  for (std::size_t function = 0; function < config.get_function_count(); function++) {
+    const tl_combinator *t = config.get_function_by_num(function);
+    dfs_combinator(t, request_types, w);
+    dfs_tree(t->result, result_types, w);
+  }
+
+  write_base_object_classes(config, common_out, request_types, result_types, w);
+
+  write_base_function_class(config, common_out, request_types, result_types, w);
+
+  std::vector<std::string> definitions;
+  std::size_t total_size = 0;
+  for (std::size_t type = 0; type < config.get_type_count(); type++) {
+    tl_type *t = config.get_type_by_num(type);
+    if (t->constructors_num == 0 || w.is_built_in_simple_type(t->name) ||
+        w.is_built_in_complex_type(t->name)) {  // built-in dummy or complex types
+      continue;
+    }
+
+    if (t->flags & FLAG_COMPLEX) {
+      std::fprintf(stderr, "Can't generate class %s\n", t->name.c_str());
+      continue;
+    }
+
+    tl_string_outputer out;
+    write_class(out, t, request_types, result_types, w);
+    definitions.push_back(out.get_result());
+    total_size += definitions.back().size();
+  }
+
+  for (std::size_t function = 0; function < config.get_function_count(); function++) {
+    tl_combinator *t = config.get_function_by_num(function);
+    if (!w.is_combinator_supported(t)) {
+      continue;
+    }
+
+    tl_string_outputer out;
+    write_function(out, t, request_types, result_types, w);
+    definitions.push_back(out.get_result());
+    total_size += definitions.back().size();
+  }
+
+  for (std::size_t type = 0; type < config.get_type_count(); type++) {
+    tl_type *t = config.get_type_by_num(type);
+    if (t->flags & FLAG_COMPLEX) {
+      t->flags &= ~FLAG_COMPLEX;  // remove temporary flag
+    }
+  }
+
+  // definitions are kept in their original order and are distributed between the parts by their size
+  std::vector<std::string> parts(part_count);
+  parts[0] = common_out.get_result();
+  for (int i = 1; i < part_count; i++) {
+    parts[i] = w.gen_output_begin(std::string());
+  }
+  std::size_t written_size = 0;
+  for (std::size_t i = 0; i < definitions.size(); i++) {
+    auto part = static_cast<std::size_t>(part_count) * written_size / (total_size + 1);
+    parts[part] += definitions[i];
+    written_size += definitions[i].size();
+  }
+
+  for (int i = 0; i < part_count; i++) {
+    parts[i] += w.gen_output_end();
+    std::string file_name = file_name_prefix + (i == 0 ? std::string() : "_part" + TL_writer::int_to_string(i)) +
+                            file_name_suffix;
+    if (!put_file_contents(file_name, parts[i], w.is_documentation_generated())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 static std::string get_additional_imports(const std::map<std::string, bool> &types, const std::string base_class_name,
                                           const std::string &file_name_prefix, const std::string &file_name_suffix,
                                           const TL_writer &w) {
@@ -24,5 +24,11 @@ bool write_tl_to_file(const tl_config &config, const std::string &file_name, con
 bool write_tl_to_multiple_files(const tl_config &config, const std::string &file_name_prefix,
                                 const std::string &file_name_suffix, const TL_writer &w);
 
+// writes the same code as write_tl_to_file, but splits class definitions into part_count files of similar size;
+// the first part is written to file_name_prefix + file_name_suffix and contains also all common code,
+// the other parts are written to file_name_prefix + "_part<number>" + file_name_suffix
+bool write_tl_to_split_files(const tl_config &config, const std::string &file_name_prefix,
+                             const std::string &file_name_suffix, int part_count, const TL_writer &w);
+
 }  // namespace tl
 }  // namespace td
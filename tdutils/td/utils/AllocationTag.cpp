@@ -0,0 +1,95 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/AllocationTag.h"
+
+#include "td/utils/FlatHashMap.h"
+#include "td/utils/port/thread_local.h"
+
+#include <array>
+#include <mutex>
+#include <utility>
+
+namespace td {
+
+constexpr int32 AllocationTag::MAX_TAG_COUNT;
+
+std::atomic<bool> AllocationTag::is_enabled_{false};
+
+static TD_THREAD_LOCAL int32 current_allocation_tag;  // static zero-initialized
+
+// must be usable before and after all other static objects are initialized and destroyed
+static std::array<std::atomic<int64>, AllocationTag::MAX_TAG_COUNT> allocated_sizes;
+
+static std::mutex tags_mutex;
+
+struct AllocationTags {
+  FlatHashMap<string, int32> tag_ids;
+  vector<string> names{string()};
+};
+
+static AllocationTags &get_tags() {
+  // tags are never deleted, because memory allocated with them can be freed at any time
+  static auto *tags = new AllocationTags();
+  return *tags;
+}
+
+void AllocationTag::set_enabled(bool is_enabled) {
+  is_enabled_.store(is_enabled, std::memory_order_relaxed);
+}
+
+int32 AllocationTag::get_tag(Slice name) {
+  if (!is_enabled() || name.empty()) {
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(tags_mutex);
+  auto &tags = get_tags();
+  auto name_str = name.str();
+  auto it = tags.tag_ids.find(name_str);
+  if (it != tags.tag_ids.end()) {
+    return it->second;
+  }
+  if (tags.names.size() >= static_cast<size_t>(MAX_TAG_COUNT)) {
+    return 0;
+  }
+  auto tag = static_cast<int32>(tags.names.size());
+  tags.names.push_back(name_str);
+  tags.tag_ids.emplace(std::move(name_str), tag);
+  return tag;
+}
+
+int32 AllocationTag::get_current_tag() {
+  return current_allocation_tag;
+}
+
+void AllocationTag::set_current_tag(int32 tag) {
+  current_allocation_tag = tag;
+}
+
+void AllocationTag::on_memory_allocated(int32 tag, int64 size) {
+  if (0 <= tag && tag < MAX_TAG_COUNT) {
+    allocated_sizes[tag].fetch_add(size, std::memory_order_relaxed);
+  }
+}
+
+vector<AllocationTag::MemoryUsage> AllocationTag::get_memory_usage() {
+  vector<MemoryUsage> result;
+  std::lock_guard<std::mutex> lock(tags_mutex);
+  const auto &names = get_tags().names;
+  for (size_t tag = 0; tag < names.size(); tag++) {
+    auto size = allocated_sizes[tag].load(std::memory_order_relaxed);
+    if (size != 0) {
+      MemoryUsage usage;
+      usage.name = names[tag];
+      usage.size = size;
+      result.push_back(std::move(usage));
+    }
+  }
+  return result;
+}
+
+}  // namespace td
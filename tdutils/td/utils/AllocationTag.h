@@ -0,0 +1,76 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+#include <atomic>
+
+namespace td {
+
+// named tags for attribution of allocated memory to its owners by a memory profiler
+// the profiler must enable tagging, remember the current tag of each allocation and report its allocations and
+// deallocations; the tags are set by code, which owns the memory, for example, by actor scheduler
+class AllocationTag {
+ public:
+  static constexpr int32 MAX_TAG_COUNT = 4096;
+
+  struct MemoryUsage {
+    string name;
+    int64 size = 0;
+  };
+
+  static void set_enabled(bool is_enabled);
+
+  static bool is_enabled() {
+    return is_enabled_.load(std::memory_order_relaxed);
+  }
+
+  // returns 0 if tagging is disabled, the name is empty or there are too many different tags
+  static int32 get_tag(Slice name);
+
+  static int32 get_current_tag();
+
+  static void set_current_tag(int32 tag);
+
+  // must be called with negative size for deallocations; must not allocate memory
+  static void on_memory_allocated(int32 tag, int64 size);
+
+  // returns sizes of currently allocated memory for all tags with allocated memory;
+  // memory allocated without a tag is returned with an empty name
+  static vector<MemoryUsage> get_memory_usage();
+
+ private:
+  static std::atomic<bool> is_enabled_;
+};
+
+class AllocationTagGuard {
+ public:
+  explicit AllocationTagGuard(int32 tag) {
+    if (tag != 0) {
+      old_tag_ = AllocationTag::get_current_tag();
+      AllocationTag::set_current_tag(tag);
+      is_set_ = true;
+    }
+  }
+  AllocationTagGuard(const AllocationTagGuard &) = delete;
+  AllocationTagGuard &operator=(const AllocationTagGuard &) = delete;
+  AllocationTagGuard(AllocationTagGuard &&) = delete;
+  AllocationTagGuard &operator=(AllocationTagGuard &&) = delete;
+  ~AllocationTagGuard() {
+    if (is_set_) {
+      AllocationTag::set_current_tag(old_tag_);
+    }
+  }
+
+ private:
+  int32 old_tag_ = 0;
+  bool is_set_ = false;
+};
+
+}  // namespace td
@@ -10,13 +10,59 @@
 #include "td/utils/port/path.h"
 #include "td/utils/port/sleep.h"
 #include "td/utils/port/StdStreams.h"
+#include "td/utils/port/thread_local.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Time.h"
 
+#include <cstring>
+
 namespace td {
 
 #if !TD_THREAD_UNSUPPORTED
 
+// single-producer single-consumer ring buffer of log text
+struct AsyncFileLog::ThreadBuffer {
+  static constexpr size_t SIZE = 1 << 16;
+  static constexpr size_t MAX_LINE_SIZE = SIZE / 4;
+
+  std::atomic<uint64> write_pos{0};
+  char pad[TD_CONCURRENCY_PAD - sizeof(std::atomic<uint64>)];
+  std::atomic<uint64> read_pos{0};
+  char pad2[TD_CONCURRENCY_PAD - sizeof(std::atomic<uint64>)];
+  char data[SIZE];
+
+  bool is_empty() const {
+    return read_pos.load() == write_pos.load();
+  }
+
+  bool can_write(size_t size) const {
+    return write_pos.load(std::memory_order_relaxed) - read_pos.load(std::memory_order_acquire) + size <= SIZE;
+  }
+
+  void write(Slice slice) {
+    auto pos = write_pos.load(std::memory_order_relaxed);
+    auto offset = static_cast<size_t>(pos % SIZE);
+    auto first_size = min(slice.size(), SIZE - offset);
+    std::memcpy(data + offset, slice.data(), first_size);
+    std::memcpy(data, slice.data() + first_size, slice.size() - first_size);
+    write_pos.store(pos + slice.size());
+  }
+
+  void read_all(string &to) {
+    auto end_pos = write_pos.load(std::memory_order_acquire);
+    auto pos = read_pos.load(std::memory_order_relaxed);
+    if (pos == end_pos) {
+      return;
+    }
+    auto offset = static_cast<size_t>(pos % SIZE);
+    auto size = static_cast<size_t>(end_pos - pos);
+    auto first_size = min(size, SIZE - offset);
+    to.append(data + offset, first_size);
+    to.append(data, size - first_size);
+    read_pos.store(end_pos, std::memory_order_release);
+  }
+};
+
 Status AsyncFileLog::init(string path, int64 rotate_threshold, bool redirect_stderr) {
   CHECK(path_.empty());
   CHECK(!path.empty());
@@ -38,7 +84,8 @@ Status AsyncFileLog::init(string path, int64 rotate_threshold, bool redirect_std
   queue_->init();
 
   logging_thread_ = td::thread(
-      [queue = queue_.get(), fd = std::move(fd), path = path_, size, rotate_threshold, redirect_stderr]() mutable {
+      [this, fd = std::move(fd), path = path_, size, rotate_threshold, redirect_stderr]() mutable {
+        auto queue = queue_.get();
         auto after_rotation = [&] {
           fd.close();
           auto r_fd = FileFd::open(path, FileFd::Create | FileFd::Write | FileFd::Append);
@@ -80,10 +127,39 @@ Status AsyncFileLog::init(string path, int64 rotate_threshold, bool redirect_std
           }
         };
 
+        auto has_thread_buffer_data = [&] {
+          for (auto &thread_buffer_ptr : thread_buffers_) {
+            auto thread_buffer = thread_buffer_ptr.load(std::memory_order_acquire);
+            if (thread_buffer != nullptr && !thread_buffer->is_empty()) {
+              return true;
+            }
+          }
+          return false;
+        };
+
+        // all available lines are written at once
+        string batch;
+        auto flush_batch = [&] {
+          if (!batch.empty()) {
+            append(batch);
+            batch.clear();
+          }
+        };
+
         while (true) {
+          for (auto &thread_buffer_ptr : thread_buffers_) {
+            auto thread_buffer = thread_buffer_ptr.load(std::memory_order_acquire);
+            if (thread_buffer != nullptr) {
+              thread_buffer->read_all(batch);
+            }
+          }
           int ready_count = queue->reader_wait_nonblock();
-          if (ready_count == 0) {
-            queue->reader_get_event_fd().wait(1000);
+          if (ready_count == 0 && batch.empty()) {
+            is_logging_thread_sleeping_.store(true);
+            if (!has_thread_buffer_data()) {
+              queue->reader_get_event_fd().wait(1000);
+            }
+            is_logging_thread_sleeping_.store(false);
             continue;
           }
           bool need_close = false;
@@ -91,9 +167,10 @@ Status AsyncFileLog::init(string path, int64 rotate_threshold, bool redirect_std
             Query query = queue->reader_get_unsafe();
             switch (query.type_) {
               case Query::Type::Log:
-                append(query.data_);
+                batch += query.data_;
                 break;
               case Query::Type::AfterRotation:
+                flush_batch();
                 after_rotation();
                 break;
               case Query::Type::Close:
@@ -104,6 +181,7 @@ Status AsyncFileLog::init(string path, int64 rotate_threshold, bool redirect_std
             }
           }
           queue->reader_flush();
+          flush_batch();
 
           if (need_close) {
             fd.close();
@@ -123,6 +201,10 @@ AsyncFileLog::~AsyncFileLog() {
   query.type_ = Query::Type::Close;
   queue_->writer_put(std::move(query));
   logging_thread_.join();
+
+  for (auto &thread_buffer_ptr : thread_buffers_) {
+    delete thread_buffer_ptr.load(std::memory_order_relaxed);
+  }
 }
 
 vector<string> AsyncFileLog::get_file_paths() {
@@ -143,17 +225,61 @@ void AsyncFileLog::after_rotation() {
   queue_->writer_put(std::move(query));
 }
 
+AsyncFileLog::ThreadBuffer *AsyncFileLog::get_thread_buffer() {
+  auto thread_id = get_thread_id();
+  if (thread_id <= 0 || thread_id >= MAX_THREAD_ID) {
+    // the thread has no identifier or its identifier can be shared with other threads
+    return nullptr;
+  }
+  auto &thread_buffer_ptr = thread_buffers_[thread_id];
+  auto thread_buffer = thread_buffer_ptr.load(std::memory_order_relaxed);
+  if (thread_buffer == nullptr) {
+    thread_buffer = new ThreadBuffer();
+    thread_buffer_ptr.store(thread_buffer, std::memory_order_release);
+  }
+  return thread_buffer;
+}
+
+void AsyncFileLog::wakeup_logging_thread() {
+  if (is_logging_thread_sleeping_.load() && is_logging_thread_sleeping_.exchange(false)) {
+    queue_->reader_get_event_fd().release();
+  }
+}
+
 void AsyncFileLog::do_append(int log_level, CSlice slice) {
-  Query query;
-  query.data_ = slice.str();
   if (queue_ == nullptr) {
     process_fatal_error("AsyncFileLog is not inited");
   }
-  queue_->writer_put(std::move(query));
+  auto thread_buffer = get_thread_buffer();
+  if (thread_buffer != nullptr && slice.size() <= ThreadBuffer::MAX_LINE_SIZE) {
+    while (!thread_buffer->can_write(slice.size())) {
+      wakeup_logging_thread();
+      usleep_for(1);
+    }
+    thread_buffer->write(slice);
+    wakeup_logging_thread();
+  } else {
+    // too long lines are passed through the queue; the order of lines logged by the thread must be preserved
+    if (thread_buffer != nullptr) {
+      while (!thread_buffer->is_empty()) {
+        wakeup_logging_thread();
+        usleep_for(1);
+      }
+    }
+    Query query;
+    query.data_ = slice.str();
+    queue_->writer_put(std::move(query));
+    if (thread_buffer != nullptr) {
+      while (!queue_->is_empty()) {
+        usleep_for(1);
+      }
+    }
+  }
   if (log_level == VERBOSITY_NAME(FATAL)) {
     // it is not thread-safe to join logging_thread_ there, so just wait for the log line to be printed
     auto end_time = Time::now() + 1.0;
-    while (!queue_->is_empty() && Time::now() < end_time) {
+    while ((!queue_->is_empty() || (thread_buffer != nullptr && !thread_buffer->is_empty())) &&
+           Time::now() < end_time) {
       usleep_for(1000);
     }
     usleep_for(5000);  // allow some time for the log line to be actually printed
@@ -13,6 +13,9 @@
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 
+#include <array>
+#include <atomic>
+
 namespace td {
 
 #if !TD_THREAD_UNSUPPORTED
@@ -35,10 +38,20 @@ class AsyncFileLog final : public LogInterface {
     string data_;
   };
 
+  // lines logged by threads with an identifier are passed to the logging thread through per-thread ring buffers
+  struct ThreadBuffer;
+  static constexpr int32 MAX_THREAD_ID = 128;
+
   string path_;
   unique_ptr<MpscPollableQueue<Query>> queue_;
+  std::array<std::atomic<ThreadBuffer *>, MAX_THREAD_ID> thread_buffers_{};
+  std::atomic<bool> is_logging_thread_sleeping_{false};
   thread logging_thread_;
 
+  ThreadBuffer *get_thread_buffer();
+
+  void wakeup_logging_thread();
+
   vector<string> get_file_paths() final;
 
   void after_rotation() final;
@@ -0,0 +1,221 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace td {
+
+// sorted set of unique values, stored in a sorted list of contiguous blocks of at most MAX_BLOCK_SIZE values
+// insertions and erasures invalidate all iterators
+template <class T, size_t MAX_BLOCK_SIZE = 256>
+class BlockSortedSet {
+  static_assert(MAX_BLOCK_SIZE >= 2, "Too small block size");
+
+  // all blocks are non-empty
+  vector<vector<T>> blocks_;
+  size_t size_ = 0;
+
+  // returns the first block, which has a value not less than the given value
+  size_t get_lower_bound_block(const T &value) const {
+    return static_cast<size_t>(
+        std::lower_bound(blocks_.begin(), blocks_.end(), value,
+                         [](const vector<T> &block, const T &value) { return block.back() < value; }) -
+        blocks_.begin());
+  }
+
+  // returns the first block, which has a value greater than the given value
+  size_t get_upper_bound_block(const T &value) const {
+    return static_cast<size_t>(
+        std::upper_bound(blocks_.begin(), blocks_.end(), value,
+                         [](const T &value, const vector<T> &block) { return value < block.back(); }) -
+        blocks_.begin());
+  }
+
+ public:
+  class const_iterator {
+    const vector<vector<T>> *blocks_ = nullptr;
+    size_t block_ = 0;
+    size_t pos_ = 0;
+
+    friend class BlockSortedSet;
+
+    const_iterator(const vector<vector<T>> *blocks, size_t block, size_t pos)
+        : blocks_(blocks), block_(block), pos_(pos) {
+    }
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+
+    const_iterator() = default;
+
+    const T &operator*() const {
+      return (*blocks_)[block_][pos_];
+    }
+
+    const T *operator->() const {
+      return &(*blocks_)[block_][pos_];
+    }
+
+    const_iterator &operator++() {
+      if (++pos_ == (*blocks_)[block_].size()) {
+        block_++;
+        pos_ = 0;
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      auto result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return block_ == other.block_ && pos_ == other.pos_;
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+  };
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  const_iterator begin() const {
+    return const_iterator(&blocks_, 0, 0);
+  }
+
+  const_iterator end() const {
+    return const_iterator(&blocks_, blocks_.size(), 0);
+  }
+
+  const_iterator lower_bound(const T &value) const {
+    auto block = get_lower_bound_block(value);
+    if (block == blocks_.size()) {
+      return end();
+    }
+    const auto &values = blocks_[block];
+    auto pos = std::lower_bound(values.begin(), values.end(), value) - values.begin();
+    return const_iterator(&blocks_, block, static_cast<size_t>(pos));
+  }
+
+  const_iterator upper_bound(const T &value) const {
+    auto block = get_upper_bound_block(value);
+    if (block == blocks_.size()) {
+      return end();
+    }
+    const auto &values = blocks_[block];
+    auto pos = std::upper_bound(values.begin(), values.end(), value) - values.begin();
+    return const_iterator(&blocks_, block, static_cast<size_t>(pos));
+  }
+
+  const_iterator find(const T &value) const {
+    auto it = lower_bound(value);
+    if (it == end() || value < *it) {
+      return end();
+    }
+    return it;
+  }
+
+  // returns number of values, which are less than the given value
+  size_t get_rank(const T &value) const {
+    auto block = get_lower_bound_block(value);
+    size_t result = 0;
+    for (size_t i = 0; i < block; i++) {
+      result += blocks_[i].size();
+    }
+    if (block != blocks_.size()) {
+      const auto &values = blocks_[block];
+      result += static_cast<size_t>(std::lower_bound(values.begin(), values.end(), value) - values.begin());
+    }
+    return result;
+  }
+
+  std::pair<const_iterator, bool> insert(T value) {
+    if (blocks_.empty()) {
+      blocks_.emplace_back();
+      blocks_[0].reserve(MAX_BLOCK_SIZE);
+      blocks_[0].push_back(std::move(value));
+      size_ = 1;
+      return {const_iterator(&blocks_, 0, 0), true};
+    }
+    auto block = get_lower_bound_block(value);
+    if (block == blocks_.size()) {
+      block--;
+    }
+    auto &values = blocks_[block];
+    auto it = std::lower_bound(values.begin(), values.end(), value);
+    auto pos = static_cast<size_t>(it - values.begin());
+    if (it != values.end() && !(value < *it)) {
+      return {const_iterator(&blocks_, block, pos), false};
+    }
+    values.insert(it, std::move(value));
+    size_++;
+
+    if (values.size() > MAX_BLOCK_SIZE) {
+      auto half = values.size() / 2;
+      vector<T> new_values;
+      new_values.reserve(MAX_BLOCK_SIZE);
+      new_values.insert(new_values.end(), std::make_move_iterator(values.begin() + half),
+                        std::make_move_iterator(values.end()));
+      values.erase(values.begin() + half, values.end());
+      blocks_.insert(blocks_.begin() + block + 1, std::move(new_values));
+      if (pos >= half) {
+        block++;
+        pos -= half;
+      }
+    }
+    return {const_iterator(&blocks_, block, pos), true};
+  }
+
+  size_t erase(const T &value) {
+    auto block = get_lower_bound_block(value);
+    if (block == blocks_.size()) {
+      return 0;
+    }
+    auto &values = blocks_[block];
+    auto it = std::lower_bound(values.begin(), values.end(), value);
+    if (value < *it) {
+      return 0;
+    }
+    values.erase(it);
+    size_--;
+
+    if (values.empty()) {
+      blocks_.erase(blocks_.begin() + block);
+    } else if (block + 1 < blocks_.size() && values.size() + blocks_[block + 1].size() <= MAX_BLOCK_SIZE / 2) {
+      // merge small neighbouring blocks to keep the number of blocks proportional to the number of values
+      auto &next_values = blocks_[block + 1];
+      values.insert(values.end(), std::make_move_iterator(next_values.begin()),
+                    std::make_move_iterator(next_values.end()));
+      blocks_.erase(blocks_.begin() + block + 1);
+    }
+    return 1;
+  }
+
+  void clear() {
+    blocks_.clear();
+    size_ = 0;
+  }
+};
+
+}  // namespace td
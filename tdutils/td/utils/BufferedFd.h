@@ -84,6 +84,12 @@ class BufferedFd final : public BufferedFdBase<FdT> {
   Result<size_t> flush_read(size_t max_read = std::numeric_limits<size_t>::max()) TD_WARN_UNUSED_RESULT;
   Result<size_t> flush_write() TD_WARN_UNUSED_RESULT;
 
+  // ensures that the next size bytes will be read into a contiguous buffer;
+  // allocates a new buffer of the given size, if there is not enough space in the current one
+  void reserve_input_buffer(size_t size) {
+    input_writer_.prepare_append_at_least(size);
+  }
+
   // Yep, direct access to buffers. It is IO interface too.
   ChainBufferReader &input_buffer();
   ChainBufferWriter &output_buffer();
@@ -118,7 +124,7 @@ Result<size_t> BufferedFdBase<FdT>::flush_write() {
   write_->sync_with_writer();
   size_t result = 0;
   while (!write_->empty() && ::td::can_write_local(*this)) {
-    constexpr size_t BUF_SIZE = 20;
+    constexpr size_t BUF_SIZE = 128;
     IoSlice buf[BUF_SIZE];
 
     auto it = write_->clone();
@@ -47,6 +47,9 @@ class ChainScheduler final : public ChainSchedulerBase {
 
   void reset_task(TaskId task_id);
 
+  // maximum number of simultaneously active tasks in a chain; each of them waits only for its parent
+  void set_max_active_tasks(uint32 max_active_tasks);
+
   template <class F>
   void for_each(F &&f) {
     tasks_.for_each([&f](uint64, Task &task) { f(task.extra); });
@@ -142,6 +145,7 @@ class ChainScheduler final : public ChainSchedulerBase {
   };
   FlatHashMap<ChainId, unique_ptr<ChainInfo>> chains_;
   FlatHashMap<ChainId, TaskId> limited_tasks_;
+  uint32 max_active_tasks_{10};
   Container<Task> tasks_;
   VectorQueue<TaskId> pending_tasks_;
 
@@ -168,7 +172,7 @@ class ChainScheduler final : public ChainSchedulerBase {
         }
       }
 
-      if (task_chain_info.chain_info->active_tasks >= 10) {
+      if (task_chain_info.chain_info->active_tasks >= max_active_tasks_) {
         limited_tasks_[task_chain_info.chain_id] = task_id;
         return;
       }
@@ -316,6 +320,23 @@ optional<ChainSchedulerBase::TaskWithParents> ChainScheduler<ExtraT>::start_next
   return res;
 }
 
+template <class ExtraT>
+void ChainScheduler<ExtraT>::set_max_active_tasks(uint32 max_active_tasks) {
+  CHECK(max_active_tasks > 0);
+  CHECK(to_start_.empty());
+  bool is_increased = max_active_tasks > max_active_tasks_;
+  max_active_tasks_ = max_active_tasks;
+  if (!is_increased) {
+    return;
+  }
+
+  for (auto &it : limited_tasks_) {
+    try_start_task_later(it.second);
+  }
+  limited_tasks_.clear();
+  flush_try_start_task();
+}
+
 template <class ExtraT>
 void ChainScheduler<ExtraT>::finish_task(TaskId task_id) {
   auto *task = tasks_.get(task_id);
@@ -73,6 +73,10 @@ class ImmediateClosure {
   std::tuple<FunctionT, ArgsT...> args;
 
  public:
+  const FunctionT &get_function() const {
+    return std::get<0>(args);
+  }
+
   auto run(ActorT *actor) -> decltype(mem_call_tuple(actor, std::move(args))) {
     return mem_call_tuple(actor, std::move(args));
   }
@@ -105,6 +109,10 @@ class DelayedClosure {
   std::tuple<FunctionT, typename std::decay<ArgsT>::type...> args;
 
  public:
+  const FunctionT &get_function() const {
+    return std::get<0>(args);
+  }
+
   auto run(ActorT *actor) -> decltype(mem_call_tuple(actor, std::move(args))) {
     return mem_call_tuple(actor, std::move(args));
   }
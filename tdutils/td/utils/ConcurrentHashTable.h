@@ -170,11 +170,48 @@ class ConcurrentHashMap {
         continue;
       }
 
-      bool has_value = hash_map->with_value(
-          key, false, [&](auto &node_value) { value = node_value.load(std::memory_order_acquire); });
-      if (!has_value || value != migrate_value()) {
+      ValueT node_value = empty_value();
+      hash_map->with_value(key, false,
+                           [&](auto &node_value_ref) { node_value = node_value_ref.load(std::memory_order_acquire); });
+      if (node_value == empty_value()) {
+        // there is no value or it was erased
         return value;
       }
+      if (node_value != migrate_value()) {
+        return node_value;
+      }
+      do_migrate(hash_map);
+    }
+  }
+
+  // returns the erased value or empty_value() if there was no value for the key
+  // erased keys keep their slots until the next migration
+  ValueT erase(KeyT key) {
+    CHECK(key != empty_key());
+    typename HazardPointers<HashMap>::Holder holder(hp_, get_thread_id(), 0);
+    while (true) {
+      auto hash_map = holder.protect(hash_map_);
+      if (!hash_map) {
+        do_migrate(nullptr);
+        continue;
+      }
+
+      bool ok = true;
+      ValueT erased_value = empty_value();
+      hash_map->with_value(key, false, [&](auto &node_value) {
+        auto value = node_value.load(std::memory_order_acquire);
+        while (value != this->empty_value() && value != this->migrate_value()) {
+          if (node_value.compare_exchange_weak(value, this->empty_value(), std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+            erased_value = value;
+            return;
+          }
+        }
+        ok = value != this->migrate_value();
+      });
+      if (ok) {
+        return erased_value;
+      }
       do_migrate(hash_map);
     }
   }
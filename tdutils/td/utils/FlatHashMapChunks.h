@@ -32,6 +32,10 @@
 #include <emmintrin.h>
 #endif
 
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
 namespace td {
 template <int shift>
 struct MaskIterator {
@@ -110,12 +114,23 @@ struct MaskSse2 {
     return {static_cast<uint32>(_mm_movemask_epi8(match_mask)) & ((1u << 14) - 1)};
   }
 };
+#elif defined(__wasm_simd128__)
+struct MaskWasmSimd {
+  static MaskIterator<1> equal_mask(uint8 *bytes, uint8 needle) {
+    auto input_mask = wasm_v128_load(bytes);
+    auto needle_mask = wasm_i8x16_splat(static_cast<int8>(needle));
+    auto match_mask = wasm_i8x16_eq(needle_mask, input_mask);
+    return {static_cast<uint32>(wasm_i8x16_bitmask(match_mask)) & ((1u << 14) - 1)};
+  }
+};
 #endif
 
 #ifdef __aarch64__
 using MaskHelper = MaskNeonFolly;
 #elif TD_SSE2
 using MaskHelper = MaskSse2;
+#elif defined(__wasm_simd128__)
+using MaskHelper = MaskWasmSimd;
 #else
 using MaskHelper = MaskPortable;
 #endif
@@ -488,7 +503,9 @@ class FlatHashTableChunks {
 
   HashInfo calc_hash(const KeyT &key) {
     auto h = HashT()(key);
-    return {(h >> 8) % chunks_.size(), static_cast<uint8>(0x80 | h)};
+    // the number of chunks is always a power of 2
+    DCHECK((chunks_.size() & (chunks_.size() - 1)) == 0);
+    return {(h >> 8) & (chunks_.size() - 1), static_cast<uint8>(0x80 | h)};
   }
 
   void resize(size_t new_size) {
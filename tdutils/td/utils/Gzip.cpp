@@ -9,6 +9,7 @@
 char disable_linker_warning_about_empty_file_gzip_cpp TD_UNUSED;
 
 #if TD_HAVE_ZLIB
+#include "td/utils/port/thread_local.h"
 #include "td/utils/SliceBuilder.h"
 
 #include <cstring>
@@ -23,34 +24,124 @@ class Gzip::Impl {
  public:
   z_stream stream_;
 
+  // the stream is kept initialized after use, because resetting of a stream is much cheaper than its initialization
+  Mode stream_mode_ = Mode::Empty;
+  int32 stream_level_ = 0;
+
   // z_stream is not copyable nor movable
   Impl() = default;
   Impl(const Impl &) = delete;
   Impl &operator=(const Impl &) = delete;
   Impl(Impl &&) = delete;
   Impl &operator=(Impl &&) = delete;
-  ~Impl() = default;
+  ~Impl() {
+    end_stream();
+  }
+
+  void init_stream() {
+    end_stream();
+    std::memset(&stream_, 0, sizeof(stream_));
+    stream_.zalloc = Z_NULL;
+    stream_.zfree = Z_NULL;
+    stream_.opaque = Z_NULL;
+  }
+
+  void end_stream() {
+    if (stream_mode_ == Mode::Decode) {
+      inflateEnd(&stream_);
+    } else if (stream_mode_ == Mode::Encode) {
+      deflateEnd(&stream_);
+    }
+    stream_mode_ = Mode::Empty;
+  }
+
+  // replaces impl with a cached one with an initialized stream of the given mode if possible
+  static void acquire_stream(unique_ptr<Impl> &impl, Mode mode) {
+    if (impl->stream_mode_ == mode) {
+      return;
+    }
+    init_thread_local<StreamCache>(stream_cache_);
+    auto &impls = stream_cache_->impls_;
+    for (size_t i = 0; i < impls.size(); i++) {
+      if (impls[i]->stream_mode_ == mode) {
+        std::swap(impl, impls[i]);
+        if (impls[i]->stream_mode_ == Mode::Empty) {
+          impls.erase(impls.begin() + i);
+        }
+        return;
+      }
+    }
+  }
+
+  // saves the initialized stream for reuse by other Gzip objects of the current thread
+  static void release_stream(unique_ptr<Impl> &&impl) {
+    // the cache isn't created here, because Gzip objects can be destroyed during destruction of thread local objects
+    if (impl == nullptr || impl->stream_mode_ == Mode::Empty || stream_cache_ == nullptr) {
+      return;
+    }
+    auto &impls = stream_cache_->impls_;
+    size_t count = 0;
+    for (auto &cached_impl : impls) {
+      if (cached_impl->stream_mode_ == impl->stream_mode_) {
+        count++;
+      }
+    }
+    // encoding streams use about 400 KB of memory each, so only one of them is kept
+    if (count < (impl->stream_mode_ == Mode::Encode ? 1u : 4u)) {
+      impls.push_back(std::move(impl));
+    }
+  }
+
+ private:
+  struct StreamCache {
+    vector<unique_ptr<Impl>> impls_;
+  };
+  static TD_THREAD_LOCAL StreamCache *stream_cache_;
 };
 
-Status Gzip::init_encode() {
+TD_THREAD_LOCAL Gzip::Impl::StreamCache *Gzip::Impl::stream_cache_;  // static zero-initialized
+
+Status Gzip::init_encode(int32 level) {
   CHECK(mode_ == Mode::Empty);
-  init_common();
+  CHECK(1 <= level && level <= 9);
   mode_ = Mode::Encode;
-  int ret = deflateInit2(&impl_->stream_, 6, Z_DEFLATED, 15, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+  Impl::acquire_stream(impl_, Mode::Encode);
+  if (impl_->stream_mode_ == Mode::Encode && deflateReset(&impl_->stream_) == Z_OK &&
+      (impl_->stream_level_ == level || deflateParams(&impl_->stream_, level, Z_DEFAULT_STRATEGY) == Z_OK)) {
+    impl_->stream_level_ = level;
+    init_common();
+    return Status::OK();
+  }
+
+  impl_->init_stream();
+  init_common();
+  int ret = deflateInit2(&impl_->stream_, level, Z_DEFLATED, 15, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
   if (ret != Z_OK) {
+    mode_ = Mode::Empty;
     return Status::Error(PSLICE() << "zlib deflate init failed: " << ret);
   }
+  impl_->stream_mode_ = Mode::Encode;
+  impl_->stream_level_ = level;
   return Status::OK();
 }
 
 Status Gzip::init_decode() {
   CHECK(mode_ == Mode::Empty);
-  init_common();
   mode_ = Mode::Decode;
+  Impl::acquire_stream(impl_, Mode::Decode);
+  if (impl_->stream_mode_ == Mode::Decode && inflateReset(&impl_->stream_) == Z_OK) {
+    init_common();
+    return Status::OK();
+  }
+
+  impl_->init_stream();
+  init_common();
   int ret = inflateInit2(&impl_->stream_, MAX_WBITS + 32);
   if (ret != Z_OK) {
+    mode_ = Mode::Empty;
     return Status::Error(PSLICE() << "zlib inflate init failed: " << ret);
   }
+  impl_->stream_mode_ = Mode::Decode;
   return Status::OK();
 }
 
@@ -87,7 +178,8 @@ Result<Gzip::State> Gzip::run() {
     }
     if (ret == Z_STREAM_END) {
       // TODO(now): fail if input is not empty;
-      clear();
+      // the stream is kept for reuse
+      mode_ = Mode::Empty;
       return State::Done;
     }
     clear();
@@ -103,10 +195,6 @@ size_t Gzip::left_output() const {
 }
 
 void Gzip::init_common() {
-  std::memset(&impl_->stream_, 0, sizeof(impl_->stream_));
-  impl_->stream_.zalloc = Z_NULL;
-  impl_->stream_.zfree = Z_NULL;
-  impl_->stream_.opaque = Z_NULL;
   impl_->stream_.avail_in = 0;
   impl_->stream_.next_in = nullptr;
   impl_->stream_.avail_out = 0;
@@ -119,10 +207,9 @@ void Gzip::init_common() {
 }
 
 void Gzip::clear() {
-  if (mode_ == Mode::Decode) {
-    inflateEnd(&impl_->stream_);
-  } else if (mode_ == Mode::Encode) {
-    deflateEnd(&impl_->stream_);
+  if (mode_ != Mode::Empty) {
+    // the stream can't be reused if it wasn't finished successfully
+    impl_->end_stream();
   }
   mode_ = Mode::Empty;
 }
@@ -152,6 +239,7 @@ void Gzip::swap(Gzip &other) {
 
 Gzip::~Gzip() {
   clear();
+  Impl::release_stream(std::move(impl_));
 }
 
 BufferSlice gzdecode(Slice s) {
@@ -184,9 +272,9 @@ BufferSlice gzdecode(Slice s) {
   return message.extract_reader().move_as_buffer_slice();
 }
 
-BufferSlice gzencode(Slice s, double max_compression_ratio) {
+BufferSlice gzencode(Slice s, double max_compression_ratio, int32 level) {
   Gzip gzip;
-  gzip.init_encode().ensure();
+  gzip.init_encode(level).ensure();
   gzip.set_input(s);
   gzip.close_input();
   auto max_size = static_cast<size_t>(static_cast<double>(s.size()) * max_compression_ratio);
@@ -24,6 +24,8 @@ class Gzip {
   Gzip &operator=(Gzip &&other) noexcept;
   ~Gzip();
 
+  static constexpr int32 DEFAULT_COMPRESSION_LEVEL = 6;
+
   enum class Mode { Empty, Encode, Decode };
   Status init(Mode mode) TD_WARN_UNUSED_RESULT {
     if (mode == Mode::Encode) {
@@ -35,7 +37,8 @@ class Gzip {
     return Status::OK();
   }
 
-  Status init_encode() TD_WARN_UNUSED_RESULT;
+  // level is a zlib compression level from 1 (fastest) to 9 (best compression)
+  Status init_encode(int32 level = DEFAULT_COMPRESSION_LEVEL) TD_WARN_UNUSED_RESULT;
 
   Status init_decode() TD_WARN_UNUSED_RESULT;
 
@@ -99,7 +102,7 @@ class Gzip {
 
 BufferSlice gzdecode(Slice s);
 
-BufferSlice gzencode(Slice s, double max_compression_ratio);
+BufferSlice gzencode(Slice s, double max_compression_ratio, int32 level = Gzip::DEFAULT_COMPRESSION_LEVEL);
 
 }  // namespace td
 
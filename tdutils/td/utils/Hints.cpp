@@ -14,6 +14,7 @@
 #include "td/utils/utf8.h"
 
 #include <algorithm>
+#include <limits>
 
 namespace td {
 
@@ -40,23 +41,14 @@ vector<string> Hints::get_words(Slice name) {
   return fix_words(utf8_get_search_words(name));
 }
 
-void Hints::add_word(const string &word, KeyT key, std::map<string, vector<KeyT>> &word_to_keys) {
-  vector<KeyT> &keys = word_to_keys[word];
-  CHECK(!td::contains(keys, key));
-  keys.push_back(key);
+void Hints::add_word(const string &word, KeyT key, WordKeys &word_keys) {
+  auto is_inserted = word_keys.insert(WordKey(word, key)).second;
+  CHECK(is_inserted);
 }
 
-void Hints::delete_word(const string &word, KeyT key, std::map<string, vector<KeyT>> &word_to_keys) {
-  vector<KeyT> &keys = word_to_keys[word];
-  auto key_it = std::find(keys.begin(), keys.end(), key);
-  CHECK(key_it != keys.end());
-  if (keys.size() == 1) {
-    word_to_keys.erase(word);
-  } else {
-    CHECK(keys.size() > 1);
-    *key_it = keys.back();
-    keys.pop_back();
-  }
+void Hints::delete_word(const string &word, KeyT key, WordKeys &word_keys) {
+  auto erased_count = word_keys.erase(WordKey(word, key));
+  CHECK(erased_count == 1);
 }
 
 void Hints::add(KeyT key, Slice name) {
@@ -68,7 +60,7 @@ void Hints::add(KeyT key, Slice name) {
     }
     vector<string> old_transliterations;
     for (auto &old_word : get_words(it->second)) {
-      delete_word(old_word, key, word_to_keys_);
+      delete_word(old_word, key, word_keys_);
 
       for (auto &w : get_word_transliterations(old_word, false)) {
         if (w != old_word) {
@@ -77,7 +69,7 @@ void Hints::add(KeyT key, Slice name) {
       }
     }
     for (auto &word : fix_words(old_transliterations)) {
-      delete_word(word, key, translit_word_to_keys_);
+      delete_word(word, key, translit_word_keys_);
     }
   }
   if (name.empty()) {
@@ -90,7 +82,7 @@ void Hints::add(KeyT key, Slice name) {
 
   vector<string> transliterations;
   for (auto &word : get_words(name)) {
-    add_word(word, key, word_to_keys_);
+    add_word(word, key, word_keys_);
 
     for (auto &w : get_word_transliterations(word, false)) {
       if (w != word) {
@@ -99,7 +91,7 @@ void Hints::add(KeyT key, Slice name) {
     }
   }
   for (auto &word : fix_words(transliterations)) {
-    add_word(word, key, translit_word_to_keys_);
+    add_word(word, key, translit_word_keys_);
   }
 
   key_to_name_[key] = name.str();
@@ -110,21 +102,20 @@ void Hints::set_rating(KeyT key, RatingT rating) {
   key_to_rating_[key] = rating;
 }
 
-void Hints::add_search_results(vector<KeyT> &results, const string &word,
-                               const std::map<string, vector<KeyT>> &word_to_keys) {
+void Hints::add_search_results(vector<KeyT> &results, const string &word, const WordKeys &word_keys) {
   LOG(DEBUG) << "Search for word " << word;
-  auto it = word_to_keys.lower_bound(word);
-  while (it != word_to_keys.end() && begins_with(it->first, word)) {
-    append(results, it->second);
+  auto it = word_keys.lower_bound(WordKey(word, std::numeric_limits<KeyT>::min()));
+  while (it != word_keys.end() && begins_with(it->word, word)) {
+    results.push_back(it->key);
     ++it;
   }
 }
 
 vector<Hints::KeyT> Hints::search_word(const string &word) const {
   vector<KeyT> results;
-  add_search_results(results, word, translit_word_to_keys_);
+  add_search_results(results, word, translit_word_keys_);
   for (const auto &w : get_word_transliterations(word, true)) {
-    add_search_results(results, w, word_to_keys_);
+    add_search_results(results, w, word_keys_);
   }
 
   td::unique(results);
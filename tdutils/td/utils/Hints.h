@@ -6,11 +6,11 @@
 //
 #pragma once
 
+#include "td/utils/BlockSortedSet.h"
 #include "td/utils/common.h"
 #include "td/utils/HashTableUtils.h"
 #include "td/utils/Slice.h"
 
-#include <map>
 #include <unordered_map>
 #include <utility>
 
@@ -45,18 +45,33 @@ class Hints {
   static vector<string> fix_words(vector<string> words);
 
  private:
-  std::map<string, vector<KeyT>> word_to_keys_;
-  std::map<string, vector<KeyT>> translit_word_to_keys_;
+  struct WordKey {
+    string word;
+    KeyT key;
+
+    WordKey(string word, KeyT key) : word(std::move(word)), key(key) {
+    }
+
+    bool operator<(const WordKey &other) const {
+      return word < other.word || (word == other.word && key < other.key);
+    }
+  };
+
+  // all pairs (word, key) are stored in a single sorted sequence of contiguous blocks, so keys for words
+  // with the same prefix are adjacent and there is no separate allocation for each word
+  using WordKeys = BlockSortedSet<WordKey>;
+
+  WordKeys word_keys_;
+  WordKeys translit_word_keys_;
   std::unordered_map<KeyT, string, Hash<KeyT>> key_to_name_;
   std::unordered_map<KeyT, RatingT, Hash<KeyT>> key_to_rating_;
 
-  static void add_word(const string &word, KeyT key, std::map<string, vector<KeyT>> &word_to_keys);
-  static void delete_word(const string &word, KeyT key, std::map<string, vector<KeyT>> &word_to_keys);
+  static void add_word(const string &word, KeyT key, WordKeys &word_keys);
+  static void delete_word(const string &word, KeyT key, WordKeys &word_keys);
 
   static vector<string> get_words(Slice name);
 
-  static void add_search_results(vector<KeyT> &results, const string &word,
-                                 const std::map<string, vector<KeyT>> &word_to_keys);
+  static void add_search_results(vector<KeyT> &results, const string &word, const WordKeys &word_keys);
 
   vector<KeyT> search_word(const string &word) const;
 
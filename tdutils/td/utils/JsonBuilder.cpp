@@ -6,13 +6,55 @@
 //
 #include "td/utils/JsonBuilder.h"
 
+#include "td/utils/algorithm.h"
 #include "td/utils/misc.h"
+#include "td/utils/port/thread_local.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/utf8.h"
 
+#include <cstring>
+#include <iterator>
+
 namespace td {
 
+namespace {
+
+bool is_plain_json_char(unsigned char c, bool is_ascii_only) {
+  return c >= 0x20 && c != '"' && c != '\\' && (c < 0x80 || !is_ascii_only);
+}
+
+// returns length of the prefix of the string, which can be written to JSON string as is
+size_t get_plain_json_prefix_length(const char *s, size_t len, bool is_ascii_only) {
+  constexpr uint64 ONES = 0x0101010101010101;
+  constexpr uint64 HIGH_BITS = ONES * 0x80;
+  auto has_zero_byte = [](uint64 word) {
+    return (word - ONES) & ~word & HIGH_BITS;
+  };
+
+  // check 8 bytes at a time
+  size_t pos = 0;
+  while (pos + 8 <= len) {
+    uint64 word;
+    std::memcpy(&word, s + pos, 8);
+    auto special_bytes = ((word - ONES * 0x20) & ~word & HIGH_BITS) | has_zero_byte(word ^ (ONES * '"')) |
+                         has_zero_byte(word ^ (ONES * '\\'));
+    if (is_ascii_only) {
+      special_bytes |= word & HIGH_BITS;
+    }
+    if (special_bytes != 0) {
+      break;
+    }
+    pos += 8;
+  }
+  while (pos < len && is_plain_json_char(static_cast<unsigned char>(s[pos]), is_ascii_only)) {
+    pos++;
+  }
+  return pos;
+}
+
+}  // namespace
+
 StringBuilder &operator<<(StringBuilder &sb, const JsonRawString &val) {
   sb << '"';
   SCOPE_EXIT {
@@ -23,6 +65,12 @@ StringBuilder &operator<<(StringBuilder &sb, const JsonRawString &val) {
 
   for (size_t pos = 0; pos < len; pos++) {
     auto ch = static_cast<unsigned char>(s[pos]);
+    if (is_plain_json_char(ch, false)) {
+      auto plain_length = get_plain_json_prefix_length(s + pos, len - pos, false);
+      sb << Slice(s + pos, plain_length);
+      pos += plain_length - 1;
+      continue;
+    }
     switch (ch) {
       case '"':
         sb << '\\' << '"';
@@ -67,6 +115,12 @@ StringBuilder &operator<<(StringBuilder &sb, const JsonString &val) {
 
   for (size_t pos = 0; pos < len; pos++) {
     auto ch = static_cast<unsigned char>(s[pos]);
+    if (is_plain_json_char(ch, true)) {
+      auto plain_length = get_plain_json_prefix_length(s + pos, len - pos, true);
+      sb << Slice(s + pos, plain_length);
+      pos += plain_length - 1;
+      continue;
+    }
     switch (ch) {
       case '"':
         sb << '\\' << '"';
@@ -293,7 +347,20 @@ Status json_string_skip(Parser &parser) {
   return Status::OK();
 }
 
-Result<JsonValue> do_json_decode(Parser &parser, int32 max_depth) {
+namespace {
+
+// values of all arrays and objects being parsed are collected in common stacks to allocate memory for each of them once
+struct JsonDecodeStacks {
+  vector<JsonValue> values;
+  vector<std::pair<Slice, JsonValue>> field_values;
+};
+
+TD_THREAD_LOCAL JsonDecodeStacks *json_decode_stacks;  // static zero-initialized
+
+// stacks grown while parsing huge JSONs aren't kept
+constexpr size_t MAX_KEPT_JSON_DECODE_STACK_SIZE = 1 << 10;
+
+Result<JsonValue> do_json_decode_impl(Parser &parser, int32 max_depth, JsonDecodeStacks &stacks) {
   if (max_depth < 0) {
     return Status::Error("Too big object depth");
   }
@@ -322,16 +389,16 @@ Result<JsonValue> do_json_decode(Parser &parser, int32 max_depth) {
     case '[': {
       parser.skip('[');
       parser.skip_whitespaces();
-      vector<JsonValue> res;
       if (parser.try_skip(']')) {
-        return JsonValue::create_array(std::move(res));
+        return JsonValue::create_array(vector<JsonValue>());
       }
+      auto values_begin = stacks.values.size();
       while (true) {
         if (parser.empty()) {
           return Status::Error("Unexpected string end");
         }
-        TRY_RESULT(value, do_json_decode(parser, max_depth - 1));
-        res.emplace_back(std::move(value));
+        TRY_RESULT(value, do_json_decode_impl(parser, max_depth - 1, stacks));
+        stacks.values.push_back(std::move(value));
 
         parser.skip_whitespaces();
         if (parser.try_skip(']')) {
@@ -346,6 +413,9 @@ Result<JsonValue> do_json_decode(Parser &parser, int32 max_depth) {
         }
         return Status::Error("Unexpected symbol while parsing JSON Array");
       }
+      auto values_it = stacks.values.begin() + values_begin;
+      vector<JsonValue> res(std::make_move_iterator(values_it), std::make_move_iterator(stacks.values.end()));
+      stacks.values.erase(values_it, stacks.values.end());
       return JsonValue::create_array(std::move(res));
     }
     case '{': {
@@ -354,7 +424,7 @@ Result<JsonValue> do_json_decode(Parser &parser, int32 max_depth) {
       if (parser.try_skip('}')) {
         return JsonValue::make_object(JsonObject());
       }
-      vector<std::pair<Slice, JsonValue>> field_values;
+      auto field_values_begin = stacks.field_values.size();
       while (true) {
         if (parser.empty()) {
           return Status::Error("Unexpected string end");
@@ -364,8 +434,8 @@ Result<JsonValue> do_json_decode(Parser &parser, int32 max_depth) {
         if (!parser.try_skip(':')) {
           return Status::Error("':' expected");
         }
-        TRY_RESULT(value, do_json_decode(parser, max_depth - 1));
-        field_values.emplace_back(field, std::move(value));
+        TRY_RESULT(value, do_json_decode_impl(parser, max_depth - 1, stacks));
+        stacks.field_values.emplace_back(field, std::move(value));
 
         parser.skip_whitespaces();
         if (parser.try_skip('}')) {
@@ -380,6 +450,10 @@ Result<JsonValue> do_json_decode(Parser &parser, int32 max_depth) {
         }
         return Status::Error("Unexpected symbol while parsing JSON Object");
       }
+      auto field_values_it = stacks.field_values.begin() + field_values_begin;
+      vector<std::pair<Slice, JsonValue>> field_values(std::make_move_iterator(field_values_it),
+                                                       std::make_move_iterator(stacks.field_values.end()));
+      stacks.field_values.erase(field_values_it, stacks.field_values.end());
       return JsonValue::make_object(JsonObject(std::move(field_values)));
     }
     case '-':
@@ -413,6 +487,29 @@ Result<JsonValue> do_json_decode(Parser &parser, int32 max_depth) {
   UNREACHABLE();
 }
 
+template <class T>
+void truncate_json_decode_stack(vector<T> &stack, size_t size) {
+  if (size == 0 && stack.capacity() > MAX_KEPT_JSON_DECODE_STACK_SIZE) {
+    reset_to_empty(stack);
+  } else {
+    stack.erase(stack.begin() + size, stack.end());
+  }
+}
+
+}  // namespace
+
+Result<JsonValue> do_json_decode(Parser &parser, int32 max_depth) {
+  init_thread_local<JsonDecodeStacks>(json_decode_stacks);
+  auto &stacks = *json_decode_stacks;
+  auto values_size = stacks.values.size();
+  auto field_values_size = stacks.field_values.size();
+  auto result = do_json_decode_impl(parser, max_depth, stacks);
+  // in case of an error, the stacks can contain unused values
+  truncate_json_decode_stack(stacks.values, values_size);
+  truncate_json_decode_stack(stacks.field_values, field_values_size);
+  return result;
+}
+
 Status do_json_skip(Parser &parser, int32 max_depth) {
   if (max_depth < 0) {
     return Status::Error("Too big object depth");
@@ -403,6 +403,25 @@ class JsonObjectScope final : public JsonScope {
   }
   template <class T>
   JsonObjectScope &operator()(Slice field, T &&value) {
+    return add_field(JsonString(field), std::forward<T>(value));
+  }
+  // the field must be already escaped and enclosed in quotes, for example, JsonRaw("\"id\"")
+  template <class T>
+  JsonObjectScope &operator()(const JsonRaw &field, T &&value) {
+    return add_field(field, std::forward<T>(value));
+  }
+  JsonObjectScope &operator<<(const JsonRaw &field_value) {
+    CHECK(is_active());
+    is_first_ = true;
+    jb_->enter_value() << field_value;
+    return *this;
+  }
+
+ private:
+  bool is_first_ = false;
+
+  template <class FieldT, class T>
+  JsonObjectScope &add_field(const FieldT &field, T &&value) {
     CHECK(is_active());
     if (is_first_) {
       *sb_ << ",";
@@ -419,15 +438,6 @@ class JsonObjectScope final : public JsonScope {
     jb_->enter_value() << value;
     return *this;
   }
-  JsonObjectScope &operator<<(const JsonRaw &field_value) {
-    CHECK(is_active());
-    is_first_ = true;
-    jb_->enter_value() << field_value;
-    return *this;
-  }
-
- private:
-  bool is_first_ = false;
 };
 
 inline JsonArrayScope JsonValueScope::enter_array() {
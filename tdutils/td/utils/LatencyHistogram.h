@@ -0,0 +1,99 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/bits.h"
+#include "td/utils/common.h"
+
+#include <array>
+
+namespace td {
+
+// histogram of non-negative delays with microsecond precision and relative error of at most 1/8,
+// which uses constant memory and O(1) time per added value
+class LatencyHistogram {
+ public:
+  void add(double delay) {
+    auto value = delay <= 0 ? 0 : (delay >= MAX_DELAY ? MAX_VALUE : static_cast<uint64>(delay * 1e6));
+    buckets_[get_bucket(value)]++;
+    count_++;
+    total_ += value;
+    if (value > max_) {
+      max_ = value;
+    }
+  }
+
+  uint64 get_count() const {
+    return count_;
+  }
+
+  double get_average() const {
+    return count_ == 0 ? 0.0 : static_cast<double>(total_) * 1e-6 / static_cast<double>(count_);
+  }
+
+  double get_max() const {
+    return static_cast<double>(max_) * 1e-6;
+  }
+
+  // returns upper bound of the bucket containing the value with the given percentile
+  double get_percentile(double percentile) const {
+    if (count_ == 0) {
+      return 0.0;
+    }
+    auto rank = static_cast<uint64>(static_cast<double>(count_) * percentile / 100.0);
+    if (rank >= count_) {
+      rank = count_ - 1;
+    }
+    uint64 seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+      seen += buckets_[i];
+      if (seen > rank) {
+        auto upper_bound = get_bucket_upper_bound(i);
+        return static_cast<double>(upper_bound < max_ ? upper_bound : max_) * 1e-6;
+      }
+    }
+    return get_max();
+  }
+
+  void clear() {
+    *this = LatencyHistogram();
+  }
+
+ private:
+  // values below 2 * SUB_BUCKET_COUNT are stored exactly, larger values keep SUB_BUCKET_BITS + 1 significant bits
+  static constexpr int32 SUB_BUCKET_BITS = 3;
+  static constexpr uint64 SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+  static constexpr int32 MAX_VALUE_BITS = 40;
+  static constexpr uint64 MAX_VALUE = static_cast<uint64>(1) << MAX_VALUE_BITS;
+  static constexpr double MAX_DELAY = 1e6;  // in seconds, must be less than MAX_VALUE microseconds
+  static constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT;
+
+  std::array<uint64, BUCKET_COUNT> buckets_{};
+  uint64 count_ = 0;
+  uint64 total_ = 0;
+  uint64 max_ = 0;
+
+  static size_t get_bucket(uint64 value) {
+    if (value < 2 * SUB_BUCKET_COUNT) {
+      return static_cast<size_t>(value);
+    }
+    auto shift = 63 - count_leading_zeroes_non_zero64(value) - SUB_BUCKET_BITS;
+    auto top = value >> shift;
+    return static_cast<size_t>(SUB_BUCKET_COUNT * shift + top);
+  }
+
+  static uint64 get_bucket_upper_bound(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKET_COUNT) {
+      return bucket;
+    }
+    auto shift = static_cast<int32>(bucket / SUB_BUCKET_COUNT) - 1;
+    auto top = bucket % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+    return ((top + 1) << shift) - 1;
+  }
+};
+
+}  // namespace td
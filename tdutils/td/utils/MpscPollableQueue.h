@@ -13,7 +13,9 @@
 #if !TD_EVENTFD_UNSUPPORTED
 
 #include "td/utils/port/Mutex.h"
+#include "td/utils/port/thread.h"
 
+#include <atomic>
 #include <utility>
 
 namespace td {
@@ -29,19 +31,30 @@ class MpscPollableQueue {
       return narrow_cast<int>(ready);
     }
 
+    // a busy producer is likely to put new values soon, so spin a bit before going to sleep
+    // to avoid the event fd write and read
+    for (int i = 0; i < spin_count_ && !has_values_.load(std::memory_order_relaxed); i++) {
+    }
+
     for (int i = 0; i < 2; i++) {
       auto guard = lock_.lock();
       if (writer_vector_.empty()) {
-        if (i == 1) {
+        // the event fd needs to be acquired only if a producer has released it after the previous acquire;
+        // a repeated wakeup without values means that the event fd was released after it was acquired
+        if (i == 1 || !(is_event_fd_released_ || was_empty_)) {
           reader_vector_.clear();
           reader_pos_ = 0;
           wait_event_fd_ = true;
+          was_empty_ = true;
           return 0;
         }
+        is_event_fd_released_ = false;
       } else {
         reader_vector_.clear();
         reader_pos_ = 0;
         std::swap(writer_vector_, reader_vector_);
+        has_values_.store(false, std::memory_order_relaxed);
+        was_empty_ = false;
         return narrow_cast<int>(reader_vector_.size());
       }
       event_fd_.acquire();
@@ -57,8 +70,32 @@ class MpscPollableQueue {
   void writer_put(ValueType value) {
     auto guard = lock_.lock();
     writer_vector_.push_back(std::move(value));
+    has_values_.store(true, std::memory_order_relaxed);
     if (wait_event_fd_) {
       wait_event_fd_ = false;
+      is_event_fd_released_ = true;
+      guard.reset();
+      event_fd_.release();
+    }
+  }
+  // moves all values to the queue at once; the vector is left empty, but may receive a new buffer
+  void writer_put_all(std::vector<ValueType> &values) {
+    if (values.empty()) {
+      return;
+    }
+    auto guard = lock_.lock();
+    if (writer_vector_.empty()) {
+      std::swap(writer_vector_, values);
+    } else {
+      for (auto &value : values) {
+        writer_vector_.push_back(std::move(value));
+      }
+      values.clear();
+    }
+    has_values_.store(true, std::memory_order_relaxed);
+    if (wait_event_fd_) {
+      wait_event_fd_ = false;
+      is_event_fd_released_ = true;
       guard.reset();
       event_fd_.release();
     }
@@ -77,11 +114,18 @@ class MpscPollableQueue {
 
   void init() {
     event_fd_.init();
+#if !TD_THREAD_UNSUPPORTED
+    // spinning is useless if producers can't run in parallel with the consumer
+    spin_count_ = thread::hardware_concurrency() > 1 ? MAX_SPIN_COUNT : 0;
+#endif
   }
   void destroy() {
     if (!event_fd_.empty()) {
       event_fd_.close();
       wait_event_fd_ = false;
+      is_event_fd_released_ = false;
+      was_empty_ = false;
+      has_values_.store(false, std::memory_order_relaxed);
       writer_vector_.clear();
       reader_vector_.clear();
       reader_pos_ = 0;
@@ -98,8 +142,14 @@ class MpscPollableQueue {
   }
 
  private:
+  static constexpr int MAX_SPIN_COUNT = 1000;
+
   Mutex lock_;
   bool wait_event_fd_{false};
+  bool is_event_fd_released_{false};
+  bool was_empty_{false};  // accessed only by the consumer
+  std::atomic<bool> has_values_{false};
+  int spin_count_{0};
   EventFd event_fd_;
   std::vector<ValueType> writer_vector_;
   std::vector<ValueType> reader_vector_;
@@ -132,6 +182,10 @@ class MpscPollableQueue {
     UNREACHABLE();
   }
 
+  void writer_put_all(std::vector<ValueType> &values) {
+    UNREACHABLE();
+  }
+
   int reader_wait_nonblock() {
     UNREACHABLE();
     return 0;
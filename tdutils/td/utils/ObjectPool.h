@@ -8,9 +8,12 @@
 
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
+#include "td/utils/port/thread_local.h"
+#include "td/utils/ThreadLocalStorage.h"
 
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <utility>
 
 namespace td {
@@ -20,6 +23,9 @@ namespace td {
 // + WeakPtr are much faster. Just pointer copy. No barriers, no atomics.
 // - We can't destroy object, because we don't know if it is pointed to by some weak pointer
 //
+// Free storages are cached in per-thread magazines of MAGAZINE_SIZE storages, so threads don't contend
+// on a shared free list. Full magazines are exchanged with a shared depot under a mutex.
+//
 template <class DataT>
 class ObjectPool {
   struct Storage;
@@ -182,12 +188,14 @@ class ObjectPool {
   ObjectPool(ObjectPool &&) = delete;
   ObjectPool &operator=(ObjectPool &&) = delete;
   ~ObjectPool() {
-    while (head_.load()) {
-      auto to_delete = head_.load();
-      head_ = to_delete->next;
-      delete to_delete;
-      storage_count_--;
+    caches_.for_each([&](ThreadCache &cache) {
+      delete_magazine(cache.loaded);
+      delete_magazine(cache.previous);
+    });
+    for (auto &magazine : full_magazines_) {
+      delete_magazine(magazine);
     }
+    delete_magazine(shared_magazine_);
     LOG_CHECK(storage_count_.load() == 0) << storage_count_.load();
   }
 
@@ -211,38 +219,122 @@ class ObjectPool {
     }
   };
 
+  static constexpr int32 MAGAZINE_SIZE = 64;
+
+  struct Magazine {
+    Storage *head = nullptr;
+    int32 size = 0;
+
+    bool empty() const {
+      return size == 0;
+    }
+
+    bool full() const {
+      return size == MAGAZINE_SIZE;
+    }
+
+    void push(Storage *storage) {
+      storage->next = head;
+      head = storage;
+      size++;
+    }
+
+    Storage *pop() {
+      auto result = head;
+      head = result->next;
+      size--;
+      return result;
+    }
+  };
+
+  // previous magazine is always either empty or full
+  struct ThreadCache {
+    Magazine loaded;
+    Magazine previous;
+  };
+
   std::atomic<int32> storage_count_{0};
-  std::atomic<Storage *> head_{static_cast<Storage *>(nullptr)};
   bool check_empty_flag_ = false;
 
+  ThreadLocalStorage<ThreadCache> caches_;
+
+  std::mutex depot_mutex_;
+  vector<Magazine> full_magazines_;
+  Magazine shared_magazine_;  // used by threads without an identifier
+
   // TODO(perf): allocation Storages in chunks? Anyway, we won't be able to release them.
-  // TODO(perf): memory order
-  // TODO(perf): use another non lockfree list for release on the same thread
-  // only one thread, so no aba problem
+  static bool has_thread_cache() {
+    auto thread_id = get_thread_id();
+    return 0 < thread_id && thread_id < ThreadLocalStorage<ThreadCache>::MAX_THREAD_ID;
+  }
+
+  Storage *new_storage() {
+    storage_count_++;
+    return new Storage();
+  }
+
+  void delete_magazine(Magazine &magazine) {
+    while (!magazine.empty()) {
+      delete magazine.pop();
+      storage_count_--;
+    }
+  }
+
   Storage *get_storage() {
-    if (head_.load() == nullptr) {
-      storage_count_++;
-      return new Storage();
-    }
-    Storage *res;
-    while (true) {
-      res = head_.load();
-      auto *next = res->next;
-      if (head_.compare_exchange_weak(res, next)) {
-        break;
+    if (!has_thread_cache()) {
+      std::lock_guard<std::mutex> guard(depot_mutex_);
+      if (shared_magazine_.empty() && !full_magazines_.empty()) {
+        shared_magazine_ = full_magazines_.back();
+        full_magazines_.pop_back();
+      }
+      if (shared_magazine_.empty()) {
+        return new_storage();
+      }
+      return shared_magazine_.pop();
+    }
+
+    auto &cache = caches_.get();
+    if (cache.loaded.empty()) {
+      if (!cache.previous.empty()) {
+        std::swap(cache.loaded, cache.previous);
+      } else {
+        std::lock_guard<std::mutex> guard(depot_mutex_);
+        if (full_magazines_.empty()) {
+          return new_storage();
+        }
+        cache.loaded = full_magazines_.back();
+        full_magazines_.pop_back();
       }
     }
-    return res;
+    return cache.loaded.pop();
   }
+
   // release can be called from other thread
   void release_storage(Storage *storage) {
-    while (true) {
-      auto *save_head = head_.load();
-      storage->next = save_head;
-      if (head_.compare_exchange_weak(save_head, storage)) {
-        break;
+    if (!has_thread_cache()) {
+      std::lock_guard<std::mutex> guard(depot_mutex_);
+      shared_magazine_.push(storage);
+      if (shared_magazine_.full()) {
+        full_magazines_.push_back(shared_magazine_);
+        shared_magazine_ = Magazine();
+      }
+      return;
+    }
+
+    auto &cache = caches_.get();
+    if (cache.loaded.full()) {
+      if (cache.previous.empty()) {
+        std::swap(cache.loaded, cache.previous);
+      } else {
+        {
+          std::lock_guard<std::mutex> guard(depot_mutex_);
+          full_magazines_.push_back(cache.previous);
+        }
+        cache.previous = cache.loaded;
+        cache.loaded = Magazine();
       }
     }
+    cache.loaded.push(storage);
   }
 };
 }  // namespace td
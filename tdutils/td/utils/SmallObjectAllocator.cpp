@@ -0,0 +1,96 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/SmallObjectAllocator.h"
+
+#include "td/utils/port/thread_local.h"
+
+#include <array>
+#include <new>
+
+namespace td {
+
+constexpr size_t SmallObjectAllocator::MAX_SIZE;
+
+namespace {
+
+constexpr size_t SIZE_CLASS_STEP = 16;
+constexpr size_t SIZE_CLASS_COUNT = SmallObjectAllocator::MAX_SIZE / SIZE_CLASS_STEP;
+
+// maximum total size of free blocks of each size class kept by a thread
+constexpr size_t MAX_THREAD_CACHED_SIZE = 32 << 10;
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+struct SmallObjectThreadCache {
+  std::array<FreeBlock *, SIZE_CLASS_COUNT> free_blocks{};
+  std::array<size_t, SIZE_CLASS_COUNT> free_sizes{};
+
+  SmallObjectThreadCache() = default;
+  SmallObjectThreadCache(const SmallObjectThreadCache &) = delete;
+  SmallObjectThreadCache &operator=(const SmallObjectThreadCache &) = delete;
+  SmallObjectThreadCache(SmallObjectThreadCache &&) = delete;
+  SmallObjectThreadCache &operator=(SmallObjectThreadCache &&) = delete;
+  ~SmallObjectThreadCache() {
+    for (auto block : free_blocks) {
+      while (block != nullptr) {
+        auto next = block->next;
+        ::operator delete(block);
+        block = next;
+      }
+    }
+  }
+};
+
+TD_THREAD_LOCAL SmallObjectThreadCache *small_object_thread_cache;  // static zero-initialized
+
+size_t get_size_class(size_t size) {
+  return (size - 1) / SIZE_CLASS_STEP;
+}
+
+}  // namespace
+
+void *SmallObjectAllocator::allocate(size_t size) {
+  if (size == 0 || size > MAX_SIZE) {
+    return ::operator new(size);
+  }
+
+  init_thread_local<SmallObjectThreadCache>(small_object_thread_cache);
+  auto size_class = get_size_class(size);
+  auto block = small_object_thread_cache->free_blocks[size_class];
+  if (block == nullptr) {
+    return ::operator new((size_class + 1) * SIZE_CLASS_STEP);
+  }
+  small_object_thread_cache->free_blocks[size_class] = block->next;
+  small_object_thread_cache->free_sizes[size_class] -= (size_class + 1) * SIZE_CLASS_STEP;
+  return block;
+}
+
+void SmallObjectAllocator::deallocate(void *ptr, size_t size) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  // the thread cache isn't created here, because objects can be freed during destruction of thread local objects
+  if (size == 0 || size > MAX_SIZE || small_object_thread_cache == nullptr) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  auto size_class = get_size_class(size);
+  auto &free_size = small_object_thread_cache->free_sizes[size_class];
+  if (free_size >= MAX_THREAD_CACHED_SIZE) {
+    ::operator delete(ptr);
+    return;
+  }
+  free_size += (size_class + 1) * SIZE_CLASS_STEP;
+  auto block = static_cast<FreeBlock *>(ptr);
+  block->next = small_object_thread_cache->free_blocks[size_class];
+  small_object_thread_cache->free_blocks[size_class] = block;
+}
+
+}  // namespace td
@@ -0,0 +1,25 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+namespace td {
+
+// allocator for small objects, which are often created and destroyed in bulk, like fetched TL objects
+// freed memory is kept in thread local free lists of size classes and is reused by subsequent allocations
+// memory can be freed by any thread
+class SmallObjectAllocator {
+ public:
+  static constexpr size_t MAX_SIZE = 512;
+
+  static void *allocate(size_t size);
+
+  static void deallocate(void *ptr, size_t size) noexcept;
+};
+
+}  // namespace td
@@ -0,0 +1,185 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/port/EventFd.h"
+
+#if !TD_EVENTFD_UNSUPPORTED
+
+#include "td/utils/misc.h"
+#include "td/utils/port/thread_local.h"
+#include "td/utils/SpinLock.h"
+
+#include <atomic>
+#include <utility>
+
+namespace td {
+
+// interface like in MpscPollableQueue
+// writers put values to one of the stripes chosen by their thread identifier, so writers from different threads
+// don't share cache lines; values from the same thread are received in the order they were put,
+// but there is no order between values put from different threads
+template <class T>
+class StripedMpscPollableQueue {
+ public:
+  using ValueType = T;
+
+  static constexpr size_t DEFAULT_STRIPE_COUNT = 16;
+
+  explicit StripedMpscPollableQueue(size_t stripe_count = DEFAULT_STRIPE_COUNT)
+      : stripes_(max(stripe_count, static_cast<size_t>(1))) {
+  }
+
+  int reader_wait_nonblock() {
+    auto ready = reader_vector_.size() - reader_pos_;
+    if (ready != 0) {
+      return narrow_cast<int>(ready);
+    }
+
+    reader_vector_.clear();
+    reader_pos_ = 0;
+    if (collect_values()) {
+      return narrow_cast<int>(reader_vector_.size());
+    }
+
+    event_fd_.acquire();
+    is_reader_waiting_.store(true, std::memory_order_seq_cst);
+    if (collect_values()) {
+      // if a writer has already reset the flag, the event_fd will be acquired during the next wait
+      is_reader_waiting_.store(false, std::memory_order_relaxed);
+      return narrow_cast<int>(reader_vector_.size());
+    }
+    return 0;
+  }
+  ValueType reader_get_unsafe() {
+    return std::move(reader_vector_[reader_pos_++]);
+  }
+  void reader_flush() {
+    //nop
+  }
+  void writer_put(ValueType value) {
+    auto &stripe = stripes_[static_cast<size_t>(get_thread_id()) % stripes_.size()];
+    {
+      auto guard = stripe.lock.lock();
+      stripe.values.push_back(std::move(value));
+      stripe.has_values.store(true, std::memory_order_seq_cst);
+    }
+    if (is_reader_waiting_.load(std::memory_order_seq_cst) &&
+        is_reader_waiting_.exchange(false, std::memory_order_acq_rel)) {
+      event_fd_.release();
+    }
+  }
+  EventFd &reader_get_event_fd() {
+    return event_fd_;
+  }
+  void writer_flush() {
+    //nop
+  }
+
+  void init() {
+    event_fd_.init();
+  }
+  void destroy() {
+    if (!event_fd_.empty()) {
+      event_fd_.close();
+      is_reader_waiting_ = false;
+      for (auto &stripe : stripes_) {
+        stripe.values.clear();
+        stripe.has_values = false;
+      }
+      reader_vector_.clear();
+      reader_pos_ = 0;
+    }
+  }
+
+ private:
+  struct Stripe {
+    SpinLock lock;
+    std::atomic<bool> has_values{false};
+    std::vector<ValueType> values;
+    char pad[TD_CONCURRENCY_PAD - sizeof(std::vector<ValueType>)];
+  };
+
+  char pad_[TD_CONCURRENCY_PAD];
+  vector<Stripe> stripes_;
+  std::atomic<bool> is_reader_waiting_{false};
+  char pad2_[TD_CONCURRENCY_PAD - sizeof(std::atomic<bool>)];
+  EventFd event_fd_;
+  std::vector<ValueType> reader_vector_;
+  size_t reader_pos_{0};
+
+  bool collect_values() {
+    for (auto &stripe : stripes_) {
+      if (!stripe.has_values.load(std::memory_order_seq_cst)) {
+        continue;
+      }
+      auto guard = stripe.lock.lock();
+      if (reader_vector_.empty()) {
+        std::swap(reader_vector_, stripe.values);
+      } else {
+        for (auto &value : stripe.values) {
+          reader_vector_.push_back(std::move(value));
+        }
+        stripe.values.clear();
+      }
+      stripe.has_values.store(false, std::memory_order_relaxed);
+    }
+    return !reader_vector_.empty();
+  }
+};
+
+template <class T>
+constexpr size_t StripedMpscPollableQueue<T>::DEFAULT_STRIPE_COUNT;
+
+}  // namespace td
+
+#else
+
+namespace td {
+
+// dummy implementation which shouldn't be used
+
+template <class T>
+class StripedMpscPollableQueue {
+ public:
+  using ValueType = T;
+
+  explicit StripedMpscPollableQueue(size_t stripe_count = 0) {
+  }
+
+  void init() {
+    UNREACHABLE();
+  }
+
+  template <class PutValueType>
+  void writer_put(PutValueType &&value) {
+    UNREACHABLE();
+  }
+
+  void writer_flush() {
+    UNREACHABLE();
+  }
+
+  int reader_wait_nonblock() {
+    UNREACHABLE();
+    return 0;
+  }
+
+  ValueType reader_get_unsafe() {
+    UNREACHABLE();
+    return ValueType();
+  }
+
+  void reader_flush() {
+    UNREACHABLE();
+  }
+};
+
+}  // namespace td
+
+#endif
@@ -17,6 +17,8 @@ namespace td {
 template <class T>
 class ThreadLocalStorage {
  public:
+  static constexpr int32 MAX_THREAD_ID = 128;
+
   T &get() {
     return thread_local_node().value;
   }
@@ -41,7 +43,6 @@ class ThreadLocalStorage {
     T value;
     char padding[TD_CONCURRENCY_PAD];
   };
-  static constexpr int32 MAX_THREAD_ID = 128;
   std::atomic<int32> max_thread_id_{MAX_THREAD_ID};
   std::array<Node, MAX_THREAD_ID> nodes_;
 
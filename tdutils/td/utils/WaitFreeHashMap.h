@@ -6,11 +6,13 @@
 //
 #pragma once
 
+#include "td/utils/algorithm.h"
 #include "td/utils/common.h"
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/HashTableUtils.h"
 
 #include <functional>
+#include <utility>
 
 namespace td {
 
@@ -19,7 +21,11 @@ class WaitFreeHashMap {
   static constexpr size_t MAX_STORAGE_COUNT = 1 << 8;
   static_assert((MAX_STORAGE_COUNT & (MAX_STORAGE_COUNT - 1)) == 0, "");
   static constexpr uint32 DEFAULT_STORAGE_SIZE = 1 << 12;
+  static constexpr size_t MAX_SMALL_MAP_SIZE = 8;
 
+  // small maps are stored in a vector, because a hash table always allocates space for at least 8 elements;
+  // at most one of small_map_ and default_map_ is non-empty at any time
+  vector<std::pair<KeyT, ValueT>> small_map_;
   FlatHashMap<KeyT, ValueT, HashT, EqT> default_map_;
   struct WaitFreeStorage {
     WaitFreeHashMap maps_[MAX_STORAGE_COUNT];
@@ -40,6 +46,46 @@ class WaitFreeHashMap {
     return wait_free_storage_->maps_[get_wait_free_index(key)];
   }
 
+  ValueT *find_small(const KeyT &key) {
+    for (auto &it : small_map_) {
+      if (EqT()(it.first, key)) {
+        return &it.second;
+      }
+    }
+    return nullptr;
+  }
+
+  const ValueT *find_small(const KeyT &key) const {
+    for (auto &it : small_map_) {
+      if (EqT()(it.first, key)) {
+        return &it.second;
+      }
+    }
+    return nullptr;
+  }
+
+  bool is_small() const {
+    return wait_free_storage_ == nullptr && default_map_.empty();
+  }
+
+  // returns nullptr if the map has become too big to be small
+  ValueT *get_small(const KeyT &key) {
+    auto value = find_small(key);
+    if (value != nullptr) {
+      return value;
+    }
+    if (small_map_.size() < MAX_SMALL_MAP_SIZE) {
+      small_map_.emplace_back(key, ValueT());
+      return &small_map_.back().second;
+    }
+
+    for (auto &it : small_map_) {
+      default_map_.emplace(std::move(it.first), std::move(it.second));
+    }
+    reset_to_empty(small_map_);
+    return nullptr;
+  }
+
   void split_storage() {
     CHECK(wait_free_storage_ == nullptr);
     wait_free_storage_ = make_unique<WaitFreeStorage>();
@@ -60,6 +106,13 @@ class WaitFreeHashMap {
     if (wait_free_storage_ != nullptr) {
       return get_wait_free_storage(key).set(key, std::move(value));
     }
+    if (is_small()) {
+      auto small_value = get_small(key);
+      if (small_value != nullptr) {
+        *small_value = std::move(value);
+        return;
+      }
+    }
 
     default_map_[key] = std::move(value);
     if (default_map_.size() == max_storage_size_) {
@@ -71,6 +124,10 @@ class WaitFreeHashMap {
     if (wait_free_storage_ != nullptr) {
       return get_wait_free_storage(key).get(key);
     }
+    if (is_small()) {
+      auto value = find_small(key);
+      return value == nullptr ? ValueT() : *value;
+    }
 
     auto it = default_map_.find(key);
     if (it == default_map_.end()) {
@@ -83,6 +140,9 @@ class WaitFreeHashMap {
     if (wait_free_storage_ != nullptr) {
       return get_wait_free_storage(key).count(key);
     }
+    if (is_small()) {
+      return find_small(key) == nullptr ? 0 : 1;
+    }
 
     return default_map_.count(key);
   }
@@ -93,6 +153,10 @@ class WaitFreeHashMap {
     if (wait_free_storage_ != nullptr) {
       return get_wait_free_storage(key).get_pointer(key);
     }
+    if (is_small()) {
+      auto value = find_small(key);
+      return value == nullptr ? nullptr : value->get();
+    }
 
     auto it = default_map_.find(key);
     if (it == default_map_.end()) {
@@ -106,6 +170,10 @@ class WaitFreeHashMap {
     if (wait_free_storage_ != nullptr) {
       return get_wait_free_storage(key).get_pointer(key);
     }
+    if (is_small()) {
+      auto value = find_small(key);
+      return value == nullptr ? nullptr : value->get();
+    }
 
     auto it = default_map_.find(key);
     if (it == default_map_.end()) {
@@ -116,6 +184,13 @@ class WaitFreeHashMap {
 
   ValueT &operator[](const KeyT &key) {
     if (wait_free_storage_ == nullptr) {
+      if (is_small()) {
+        auto small_value = get_small(key);
+        if (small_value != nullptr) {
+          return *small_value;
+        }
+      }
+
       ValueT &result = default_map_[key];
       if (default_map_.size() != max_storage_size_) {
         return result;
@@ -131,12 +206,27 @@ class WaitFreeHashMap {
     if (wait_free_storage_ != nullptr) {
       return get_wait_free_storage(key).erase(key);
     }
+    if (is_small()) {
+      for (auto &it : small_map_) {
+        if (EqT()(it.first, key)) {
+          if (&it != &small_map_.back()) {
+            it = std::move(small_map_.back());
+          }
+          small_map_.pop_back();
+          return 1;
+        }
+      }
+      return 0;
+    }
 
     return default_map_.erase(key);
   }
 
   void foreach(const std::function<void(const KeyT &key, ValueT &value)> &callback) {
     if (wait_free_storage_ == nullptr) {
+      for (auto &it : small_map_) {
+        callback(it.first, it.second);
+      }
       for (auto &it : default_map_) {
         callback(it.first, it.second);
       }
@@ -150,6 +240,9 @@ class WaitFreeHashMap {
 
   void foreach(const std::function<void(const KeyT &key, const ValueT &value)> &callback) const {
     if (wait_free_storage_ == nullptr) {
+      for (auto &it : small_map_) {
+        callback(it.first, it.second);
+      }
       for (auto &it : default_map_) {
         callback(it.first, it.second);
       }
@@ -163,7 +256,7 @@ class WaitFreeHashMap {
 
   size_t calc_size() const {
     if (wait_free_storage_ == nullptr) {
-      return default_map_.size();
+      return small_map_.size() + default_map_.size();
     }
 
     size_t result = 0;
@@ -175,7 +268,7 @@ class WaitFreeHashMap {
 
   bool empty() const {
     if (wait_free_storage_ == nullptr) {
-      return default_map_.empty();
+      return small_map_.empty() && default_map_.empty();
     }
 
     for (size_t i = 0; i < MAX_STORAGE_COUNT; i++) {
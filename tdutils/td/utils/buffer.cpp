@@ -6,10 +6,13 @@
 //
 #include "td/utils/buffer.h"
 
+#include "td/utils/bits.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/thread_local.h"
 
+#include <array>
 #include <cstddef>
+#include <mutex>
 #include <new>
 
 // fixes https://bugs.llvm.org/show_bug.cgi?id=33723 for clang >= 3.6 + c++11 + libc++
@@ -25,6 +28,121 @@ TD_THREAD_LOCAL BufferAllocator::BufferRawTls *BufferAllocator::buffer_raw_tls;
 
 std::atomic<size_t> BufferAllocator::buffer_mem;
 
+namespace {
+
+// memory blocks of buffers with data size up to 64 KB are allocated in 7 size classes with data sizes
+// from 1 KB to 64 KB and are reused after the buffers are freed
+constexpr size_t MIN_CACHED_DATA_SIZE_LOG = 10;
+constexpr size_t MAX_CACHED_DATA_SIZE = static_cast<size_t>(1) << 16;
+constexpr size_t BUFFER_SIZE_CLASS_COUNT = 7;
+
+// maximum number of freed blocks of each size class kept by a thread
+constexpr size_t MAX_THREAD_CACHED_BLOCKS = 8;
+// maximum number of freed blocks of each size class kept for all threads
+constexpr size_t MAX_SHARED_CACHED_BLOCKS = 32;
+
+size_t get_buffer_size_class(size_t data_size) {
+  if (data_size > MAX_CACHED_DATA_SIZE) {
+    return BUFFER_SIZE_CLASS_COUNT;
+  }
+  if (data_size <= (static_cast<size_t>(1) << MIN_CACHED_DATA_SIZE_LOG)) {
+    return 0;
+  }
+  return 64 - count_leading_zeroes64(static_cast<uint64>(data_size - 1)) - MIN_CACHED_DATA_SIZE_LOG;
+}
+
+size_t get_buffer_block_size(size_t size_class) {
+  return TD_OFFSETOF(BufferRaw, data_) + (static_cast<size_t>(1) << (MIN_CACHED_DATA_SIZE_LOG + size_class));
+}
+
+using BufferBlockLists = std::array<vector<char *>, BUFFER_SIZE_CLASS_COUNT>;
+
+// blocks freed by threads with full caches; they can be reused by any thread
+struct SharedBufferBlockCache {
+  std::mutex mutex;
+  BufferBlockLists blocks;
+  size_t total_size = 0;
+
+  void add_block(size_t size_class, char *block) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (blocks[size_class].size() < MAX_SHARED_CACHED_BLOCKS) {
+        blocks[size_class].push_back(block);
+        total_size += get_buffer_block_size(size_class);
+        return;
+      }
+    }
+    delete[] block;
+  }
+};
+
+SharedBufferBlockCache &get_shared_buffer_block_cache() {
+  // the cache is never destroyed, because buffers can be freed by other threads during program exit
+  static auto *cache = new SharedBufferBlockCache();
+  return *cache;
+}
+
+struct BufferBlockThreadCache {
+  BufferBlockLists blocks;
+
+  ~BufferBlockThreadCache() {
+    auto &shared_cache = get_shared_buffer_block_cache();
+    for (size_t size_class = 0; size_class < BUFFER_SIZE_CLASS_COUNT; size_class++) {
+      for (auto block : blocks[size_class]) {
+        shared_cache.add_block(size_class, block);
+      }
+    }
+  }
+};
+
+TD_THREAD_LOCAL BufferBlockThreadCache *buffer_block_thread_cache;  // static zero-initialized
+
+char *allocate_buffer_block(size_t data_size, size_t buf_size) {
+  auto size_class = get_buffer_size_class(data_size);
+  if (size_class == BUFFER_SIZE_CLASS_COUNT) {
+    return new char[buf_size];
+  }
+
+  init_thread_local<BufferBlockThreadCache>(buffer_block_thread_cache);
+  auto &blocks = buffer_block_thread_cache->blocks[size_class];
+  if (blocks.empty()) {
+    auto &shared_cache = get_shared_buffer_block_cache();
+    std::lock_guard<std::mutex> lock(shared_cache.mutex);
+    auto &shared_blocks = shared_cache.blocks[size_class];
+    while (!shared_blocks.empty() && blocks.size() < MAX_THREAD_CACHED_BLOCKS / 2) {
+      blocks.push_back(shared_blocks.back());
+      shared_blocks.pop_back();
+      shared_cache.total_size -= get_buffer_block_size(size_class);
+    }
+  }
+  if (blocks.empty()) {
+    return new char[get_buffer_block_size(size_class)];
+  }
+  auto block = blocks.back();
+  blocks.pop_back();
+  return block;
+}
+
+void free_buffer_block(char *block, size_t data_size) {
+  auto size_class = get_buffer_size_class(data_size);
+  if (size_class == BUFFER_SIZE_CLASS_COUNT) {
+    delete[] block;
+    return;
+  }
+
+  // the thread cache isn't created here, because buffers can be freed during destruction of thread local objects
+  if (buffer_block_thread_cache != nullptr) {
+    auto &blocks = buffer_block_thread_cache->blocks[size_class];
+    if (blocks.size() < MAX_THREAD_CACHED_BLOCKS) {
+      blocks.push_back(block);
+      return;
+    }
+  }
+  get_shared_buffer_block_cache().add_block(size_class, block);
+}
+
+}  // namespace
+
 int64 BufferAllocator::get_buffer_slice_size() {
   return 0;
 }
@@ -33,6 +151,12 @@ size_t BufferAllocator::get_buffer_mem() {
   return buffer_mem;
 }
 
+size_t BufferAllocator::get_buffer_cache_mem() {
+  auto &shared_cache = get_shared_buffer_block_cache();
+  std::lock_guard<std::mutex> lock(shared_cache.mutex);
+  return shared_cache.total_size;
+}
+
 BufferAllocator::WriterPtr BufferAllocator::create_writer(size_t size) {
   if (size < 512) {
     size = 512;
@@ -91,8 +215,9 @@ void BufferAllocator::dec_ref_cnt(BufferRaw *ptr) {
   if (left == 1) {
     auto buf_size = max(sizeof(BufferRaw), TD_OFFSETOF(BufferRaw, data_) + ptr->data_size_);
     buffer_mem -= buf_size;
+    auto data_size = ptr->data_size_;
     ptr->~BufferRaw();
-    delete[] ptr;
+    free_buffer_block(reinterpret_cast<char *>(ptr), data_size);
   }
 }
 
@@ -110,7 +235,7 @@ BufferRaw *BufferAllocator::create_buffer_raw(size_t size) {
     buf_size = sizeof(BufferRaw);
   }
   buffer_mem += buf_size;
-  auto *buffer_raw = reinterpret_cast<BufferRaw *>(new char[buf_size]);
+  auto *buffer_raw = reinterpret_cast<BufferRaw *>(allocate_buffer_block(size, buf_size));
   return new (buffer_raw) BufferRaw(size);
 }
 
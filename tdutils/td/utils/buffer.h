@@ -69,6 +69,10 @@ class BufferAllocator {
   static size_t get_buffer_mem();
   static int64 get_buffer_slice_size();
 
+  // returns total size of freed buffer memory blocks kept for reuse by any thread;
+  // each thread additionally keeps up to 8 freed blocks of each size class
+  static size_t get_buffer_cache_mem();
+
   static void clear_thread_local();
 
  private:
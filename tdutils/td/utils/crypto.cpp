@@ -48,6 +48,17 @@
 #include "crc32c/crc32c.h"
 #endif
 
+#if TD_HAVE_ZLIB && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#if TD_HAVE_OPENSSL && (TD_GCC || TD_CLANG) && (defined(__x86_64__) || defined(__i386__)) && !TD_EMSCRIPTEN
+#define TD_HAVE_AES_NI 1
+#include <cpuid.h>
+#include <wmmintrin.h>
+#define TD_AES_NI_TARGET __attribute__((target("aes,sse2")))
+#endif
+
 #include <algorithm>
 #include <cerrno>
 #include <cstring>
@@ -589,6 +600,196 @@ void aes_ige_decrypt(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlic
   state.get_iv(aes_iv);
 }
 
+#if TD_HAVE_AES_NI
+static bool is_aes_ni_supported() {
+  static const bool is_supported = [] {
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & bit_AES) != 0 && (edx & bit_SSE2) != 0;
+  }();
+  return is_supported;
+}
+
+TD_AES_NI_TARGET static __m128i aes_ni_xor_prefixes(__m128i key) {
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, _mm_slli_si128(key, 4));
+}
+
+TD_AES_NI_TARGET static __m128i aes_ni_expand_key_even(__m128i key, __m128i assist) {
+  return _mm_xor_si128(aes_ni_xor_prefixes(key), _mm_shuffle_epi32(assist, 0xff));
+}
+
+TD_AES_NI_TARGET static __m128i aes_ni_expand_key_odd(__m128i key, __m128i previous_key) {
+  return _mm_xor_si128(aes_ni_xor_prefixes(key), _mm_shuffle_epi32(_mm_aeskeygenassist_si128(previous_key, 0), 0xaa));
+}
+
+// round keys for the equivalent inverse cipher in the order of their usage
+TD_AES_NI_TARGET static void aes_ni_init_decryption_keys(const uint8 *key, __m128i *decryption_keys) {
+  __m128i keys[15];
+  keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key));
+  keys[1] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + 16));
+  keys[2] = aes_ni_expand_key_even(keys[0], _mm_aeskeygenassist_si128(keys[1], 0x01));
+  keys[3] = aes_ni_expand_key_odd(keys[1], keys[2]);
+  keys[4] = aes_ni_expand_key_even(keys[2], _mm_aeskeygenassist_si128(keys[3], 0x02));
+  keys[5] = aes_ni_expand_key_odd(keys[3], keys[4]);
+  keys[6] = aes_ni_expand_key_even(keys[4], _mm_aeskeygenassist_si128(keys[5], 0x04));
+  keys[7] = aes_ni_expand_key_odd(keys[5], keys[6]);
+  keys[8] = aes_ni_expand_key_even(keys[6], _mm_aeskeygenassist_si128(keys[7], 0x08));
+  keys[9] = aes_ni_expand_key_odd(keys[7], keys[8]);
+  keys[10] = aes_ni_expand_key_even(keys[8], _mm_aeskeygenassist_si128(keys[9], 0x10));
+  keys[11] = aes_ni_expand_key_odd(keys[9], keys[10]);
+  keys[12] = aes_ni_expand_key_even(keys[10], _mm_aeskeygenassist_si128(keys[11], 0x20));
+  keys[13] = aes_ni_expand_key_odd(keys[11], keys[12]);
+  keys[14] = aes_ni_expand_key_even(keys[12], _mm_aeskeygenassist_si128(keys[13], 0x40));
+
+  decryption_keys[0] = keys[14];
+  for (int i = 1; i < 14; i++) {
+    decryption_keys[i] = _mm_aesimc_si128(keys[14 - i]);
+  }
+  decryption_keys[14] = keys[0];
+}
+
+struct AesNiIgeDecryptionLane {
+  __m128i decryption_keys[15];
+  __m128i encrypted_iv;
+  __m128i plaintext_iv;
+  const uint8 *in;
+  uint8 *out;
+  size_t left_block_count;
+  MutableSlice aes_iv;
+};
+
+TD_AES_NI_TARGET static void aes_ni_init_lane(AesNiIgeDecryptionLane &lane, const AesIgeDecryptionQuery &query) {
+  aes_ni_init_decryption_keys(query.aes_key.ubegin(), lane.decryption_keys);
+  lane.encrypted_iv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(query.aes_iv.ubegin()));
+  lane.plaintext_iv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(query.aes_iv.ubegin() + AES_BLOCK_SIZE));
+  lane.in = query.from.ubegin();
+  lane.out = query.to.ubegin();
+  lane.left_block_count = query.from.size() / AES_BLOCK_SIZE;
+  lane.aes_iv = query.aes_iv;
+}
+
+TD_AES_NI_TARGET static void aes_ni_finish_lane(AesNiIgeDecryptionLane &lane) {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(lane.aes_iv.ubegin()), lane.encrypted_iv);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(lane.aes_iv.ubegin() + AES_BLOCK_SIZE), lane.plaintext_iv);
+}
+
+// decrypts block_count blocks in each of the lanes; the lanes are processed by explicitly expanded code,
+// so that their states are kept in registers regardless of compiler loop unrolling
+template <size_t... I>
+TD_AES_NI_TARGET static void aes_ni_ige_decrypt_lanes(AesNiIgeDecryptionLane *lanes, size_t block_count,
+                                                      std::index_sequence<I...>) {
+  __m128i encrypted_iv[] = {lanes[I].encrypted_iv...};
+  __m128i plaintext_iv[] = {lanes[I].plaintext_iv...};
+  for (size_t offset = 0; offset < block_count * AES_BLOCK_SIZE; offset += AES_BLOCK_SIZE) {
+    __m128i encrypted[] = {_mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes[I].in + offset))...};
+    __m128i state[] = {_mm_xor_si128(_mm_xor_si128(encrypted[I], plaintext_iv[I]), lanes[I].decryption_keys[0])...};
+    for (int round = 1; round < 14; round++) {
+      int unused[] = {(state[I] = _mm_aesdec_si128(state[I], lanes[I].decryption_keys[round]), 0)...};
+      (void)unused;
+    }
+    int unused[] = {(plaintext_iv[I] = _mm_xor_si128(_mm_aesdeclast_si128(state[I], lanes[I].decryption_keys[14]),
+                                                     encrypted_iv[I]),
+                     encrypted_iv[I] = encrypted[I],
+                     _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes[I].out + offset), plaintext_iv[I]), 0)...};
+    (void)unused;
+  }
+  int unused[] = {(lanes[I].encrypted_iv = encrypted_iv[I], lanes[I].plaintext_iv = plaintext_iv[I], 0)...};
+  (void)unused;
+  for (size_t i = 0; i < sizeof...(I); i++) {
+    lanes[i].in += block_count * AES_BLOCK_SIZE;
+    lanes[i].out += block_count * AES_BLOCK_SIZE;
+    lanes[i].left_block_count -= block_count;
+  }
+}
+
+// a single message can't be decrypted faster than one block per AES latency, but AES instructions
+// for the blocks of different messages are independent and can be executed by the CPU simultaneously
+TD_AES_NI_TARGET static void aes_ni_ige_decrypt_multi(Span<AesIgeDecryptionQuery> queries) {
+  static constexpr size_t MAX_LANE_COUNT = 8;
+  AesNiIgeDecryptionLane lanes[MAX_LANE_COUNT];
+  size_t lane_count = 0;
+  size_t next_query = 0;
+  while (true) {
+    while (lane_count < MAX_LANE_COUNT && next_query < queries.size()) {
+      const auto &query = queries[next_query++];
+      if (!query.from.empty()) {
+        aes_ni_init_lane(lanes[lane_count++], query);
+      }
+    }
+    if (lane_count == 0) {
+      break;
+    }
+
+    // all lanes are advanced until the shortest of them is finished
+    auto block_count = lanes[0].left_block_count;
+    for (size_t i = 1; i < lane_count; i++) {
+      block_count = td::min(block_count, lanes[i].left_block_count);
+    }
+    switch (lane_count) {
+      case 1:
+        aes_ni_ige_decrypt_lanes(lanes, block_count, std::make_index_sequence<1>());
+        break;
+      case 2:
+        aes_ni_ige_decrypt_lanes(lanes, block_count, std::make_index_sequence<2>());
+        break;
+      case 3:
+        aes_ni_ige_decrypt_lanes(lanes, block_count, std::make_index_sequence<3>());
+        break;
+      case 4:
+        aes_ni_ige_decrypt_lanes(lanes, block_count, std::make_index_sequence<4>());
+        break;
+      case 5:
+        aes_ni_ige_decrypt_lanes(lanes, block_count, std::make_index_sequence<5>());
+        break;
+      case 6:
+        aes_ni_ige_decrypt_lanes(lanes, block_count, std::make_index_sequence<6>());
+        break;
+      case 7:
+        aes_ni_ige_decrypt_lanes(lanes, block_count, std::make_index_sequence<7>());
+        break;
+      case 8:
+        aes_ni_ige_decrypt_lanes(lanes, block_count, std::make_index_sequence<8>());
+        break;
+      default:
+        UNREACHABLE();
+    }
+
+    for (size_t i = 0; i < lane_count;) {
+      if (lanes[i].left_block_count == 0) {
+        aes_ni_finish_lane(lanes[i]);
+        lane_count--;
+        if (i != lane_count) {
+          lanes[i] = lanes[lane_count];
+        }
+      } else {
+        i++;
+      }
+    }
+  }
+}
+#endif
+
+void aes_ige_decrypt_multi(Span<AesIgeDecryptionQuery> queries) {
+  for (const auto &query : queries) {
+    CHECK(query.aes_key.size() == 32);
+    CHECK(query.aes_iv.size() == 32);
+    CHECK(query.from.size() % AES_BLOCK_SIZE == 0);
+    CHECK(query.to.size() >= query.from.size());
+  }
+#if TD_HAVE_AES_NI
+  if (is_aes_ni_supported()) {
+    return aes_ni_ige_decrypt_multi(queries);
+  }
+#endif
+  for (const auto &query : queries) {
+    aes_ige_decrypt(query.aes_key, query.aes_iv, query.from, query.to.substr(0, query.from.size()));
+  }
+}
+
 void aes_cbc_encrypt(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlice to) {
   CHECK(from.size() <= to.size());
   CHECK(from.size() % 16 == 0);
@@ -903,6 +1104,25 @@ void Sha256State::extract(MutableSlice output, bool destroy) {
   }
 }
 
+void aes_ige_decrypt_sha256(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlice to, Sha256State &state) {
+  CHECK(to.size() >= from.size());
+  // the chunk must fit into L1 cache, so it is still there when it is hashed
+  constexpr size_t CHUNK_SIZE = 1 << 14;
+  static_assert(CHUNK_SIZE % AES_BLOCK_SIZE == 0, "");
+
+  AesIgeStateImpl aes_state;
+  aes_state.init(aes_key, aes_iv, false);
+  while (!from.empty()) {
+    auto chunk_size = min(from.size(), CHUNK_SIZE);
+    auto to_chunk = to.substr(0, chunk_size);
+    aes_state.decrypt(from.substr(0, chunk_size), to_chunk);
+    state.feed(to_chunk);
+    from.remove_prefix(chunk_size);
+    to.remove_prefix(chunk_size);
+  }
+  aes_state.get_iv(aes_iv);
+}
+
 void md5(Slice input, MutableSlice output) {
   CHECK(output.size() >= 16);
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(LIBRESSL_VERSION_NUMBER)
@@ -1209,7 +1429,20 @@ void clear_openssl_errors(Slice source) {
 
 #if TD_HAVE_ZLIB
 uint32 crc32(Slice data) {
+#if defined(__ARM_FEATURE_CRC32)
+  // ARMv8 CRC instructions use the same polynomial as zlib
+  uint32 crc = 0xFFFFFFFF;
+  while (data.size() >= 8) {
+    crc = __crc32d(crc, as<uint64>(data.ubegin()));
+    data.remove_prefix(8);
+  }
+  for (auto c : data) {
+    crc = __crc32b(crc, static_cast<uint8>(c));
+  }
+  return ~crc;
+#else
   return static_cast<uint32>(::crc32(0, data.ubegin(), static_cast<uint32>(data.size())));
+#endif
 }
 #endif
 
@@ -10,6 +10,7 @@
 #include "td/utils/common.h"
 #include "td/utils/SharedSlice.h"
 #include "td/utils/Slice.h"
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 
 namespace td {
@@ -44,6 +45,23 @@ class AesState {
 void aes_ige_encrypt(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlice to);
 void aes_ige_decrypt(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlice to);
 
+struct AesIgeDecryptionQuery {
+  Slice aes_key;
+  MutableSlice aes_iv;
+  Slice from;
+  MutableSlice to;
+};
+
+// decrypts independent messages with their own keys; equivalent to aes_ige_decrypt for each query, but much faster
+// if AES-NI is available, because several messages are decrypted simultaneously
+void aes_ige_decrypt_multi(Span<AesIgeDecryptionQuery> queries);
+
+class Sha256State;
+
+// same as aes_ige_decrypt, but additionally feeds the decrypted data to the state;
+// the data is decrypted and hashed by chunks, so it is read from memory only once
+void aes_ige_decrypt_sha256(Slice aes_key, MutableSlice aes_iv, Slice from, MutableSlice to, Sha256State &state);
+
 class AesIgeStateImpl;
 
 class AesIgeState {
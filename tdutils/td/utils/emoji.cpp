@@ -14,7 +14,48 @@ namespace td {
 
 static constexpr size_t MAX_EMOJI_LENGTH = 28;
 
+// quickly checks whether the string can be an emoji element judging by its first two bytes;
+// all emoji elements start with a keycap base character, U+00A9, U+00AE, U+2000-U+2BFF, U+3030, U+3297, U+3299,
+// or U+1F000-U+1FFFF
+static bool can_be_emoji_element(Slice str) {
+  if (str.size() < 2) {
+    return false;
+  }
+  auto c = static_cast<unsigned char>(str[0]);
+  auto next = static_cast<unsigned char>(str[1]);
+  switch (c) {
+    case '#':
+    case '*':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+      return next == 0xE2 || next == 0xEF;
+    case 0xC2:
+      return next == 0xA9 || next == 0xAE;
+    case 0xE2:
+      return true;
+    case 0xE3:
+      return next == 0x80 || next == 0x8A;
+    case 0xF0:
+      return next == 0x9F;
+    default:
+      return false;
+  }
+}
+
 static bool is_emoji_element(Slice str) {
+  auto len = str.size();
+  if (len > MAX_EMOJI_LENGTH + 3 || !can_be_emoji_element(str)) {
+    return false;
+  }
+
   static const FlatHashSet<Slice, SliceHash> emojis = [max_emoji_length = MAX_EMOJI_LENGTH] {
 #if TD_HAVE_ZLIB
     Slice packed_emojis(
@@ -123,10 +164,6 @@ static bool is_emoji_element(Slice str) {
     CHECK(all_emojis.size() == EMOJI_COUNT);
     return all_emojis;
   }();
-  auto len = str.size();
-  if (len > MAX_EMOJI_LENGTH + 3) {
-    return false;
-  }
   if (emojis.count(str) != 0) {
     return true;
   }
@@ -160,12 +197,13 @@ bool is_emoji(Slice str) {
 }
 
 int get_fitzpatrick_modifier(Slice emoji) {
-  if (emoji.size() < 4 || emoji[emoji.size() - 4] != '\xF0' || emoji[emoji.size() - 3] != '\x9F' ||
-      emoji[emoji.size() - 2] != '\x8F') {
+  auto size = emoji.size();
+  if (size < 4) {
     return 0;
   }
-  auto c = static_cast<unsigned char>(emoji.back());
-  if (c < 0xBB || c > 0xBF) {
+  // the last byte is checked first, because it differs from the modifiers for most emoji
+  auto c = static_cast<unsigned char>(emoji[size - 1]);
+  if (c < 0xBB || c > 0xBF || emoji[size - 2] != '\x8F' || emoji[size - 3] != '\x9F' || emoji[size - 4] != '\xF0') {
     return 0;
   }
   return (c - 0xBB) + 2;
@@ -196,6 +234,12 @@ void remove_emoji_modifiers_in_place(string &emoji, bool remove_selectors) {
   const size_t start_index = remove_selectors ? 0 : 1;
   size_t j = 0;
   for (size_t i = 0; i < emoji.size();) {
+    auto c = emoji[i];
+    if (c != '\xEF' && c != '\xE2' && c != '\xF0') {
+      // all modifiers start with one of the bytes
+      emoji[j++] = emoji[i++];
+      continue;
+    }
     bool is_found = false;
     for (size_t k = start_index; k < sizeof(modifiers) / sizeof(*modifiers); k++) {
       auto length = modifiers[k].size();
@@ -16,33 +16,46 @@ bool find_boundary(ChainBufferReader range, Slice boundary, size_t &already_read
   const int MAX_BOUNDARY_LENGTH = 70;
   CHECK(boundary.size() <= MAX_BOUNDARY_LENGTH + 4);
   while (!range.empty()) {
+    // look for the boundary inside the current contiguous chunk without touching the range
     Slice ready = range.prepare_read();
-    if (ready[0] == boundary[0]) {
-      if (range.size() < boundary.size()) {
-        return false;
+    size_t pos = 0;
+    while (true) {
+      const auto *ptr = static_cast<const char *>(std::memchr(ready.data() + pos, boundary[0], ready.size() - pos));
+      if (ptr == nullptr) {
+        pos = ready.size();
+        break;
+      }
+      pos = ptr - ready.data();
+      if (ready.size() - pos < boundary.size()) {
+        break;
       }
-      auto save_range = range.clone();
-      char x[MAX_BOUNDARY_LENGTH + 4];
-      range.advance(boundary.size(), {x, sizeof(x)});
-      if (Slice(x, boundary.size()) == boundary) {
+      if (std::memcmp(ptr, boundary.data(), boundary.size()) == 0) {
+        already_read += pos;
         return true;
       }
+      pos++;
+    }
+    already_read += pos;
+    range.advance(pos);
+    if (pos == ready.size()) {
+      continue;
+    }
 
-      // not a boundary, restoring previous state and skip one symbol
-      range = std::move(save_range);
-      range.advance(1);
-      already_read++;
-    } else {
-      const auto *ptr = static_cast<const char *>(std::memchr(ready.data(), boundary[0], ready.size()));
-      size_t shift;
-      if (ptr == nullptr) {
-        shift = ready.size();
-      } else {
-        shift = ptr - ready.data();
-      }
-      already_read += shift;
-      range.advance(shift);
+    // the boundary can cross the chunk end
+    if (range.size() < boundary.size()) {
+      return false;
     }
+    auto save_range = range.clone();
+    char x[MAX_BOUNDARY_LENGTH + 4];
+    range.advance(boundary.size(), {x, sizeof(x)});
+    if (Slice(x, boundary.size()) == boundary) {
+      return true;
+    }
+
+    // not a boundary, restoring previous state and skip one symbol
+    range = std::move(save_range);
+    range.advance(1);
+    already_read++;
   }
 
   return false;
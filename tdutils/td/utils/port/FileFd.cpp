@@ -41,6 +41,10 @@
 #include <limits>
 #endif
 
+#if TD_LINUX
+#include <linux/falloc.h>
+#endif
+
 #if TD_PORT_WINDOWS && defined(WIN32_LEAN_AND_MEAN)
 #include <winioctl.h>
 #endif
@@ -555,6 +559,7 @@ uint64 filetime_to_unix_time_nsec(LONGLONG filetime) {
 struct FileSize {
   int64 size_;
   int64 real_size_;
+  int64 link_count_;
 };
 
 Result<FileSize> get_file_size(const FileFd &file_fd) {
@@ -566,6 +571,7 @@ Result<FileSize> get_file_size(const FileFd &file_fd) {
   FileSize res;
   res.size_ = standard_info.EndOfFile.QuadPart;
   res.real_size_ = standard_info.AllocationSize.QuadPart;
+  res.link_count_ = static_cast<int64>(standard_info.NumberOfLinks);
 
   if (res.size_ > 0 && res.real_size_ <= 0) {  // just in case
     LOG(ERROR) << "Fix real file size from " << res.real_size_ << " to " << res.size_;
@@ -628,6 +634,7 @@ Result<Stat> FileFd::stat() const {
   TRY_RESULT(file_size, get_file_size(*this));
   res.size_ = file_size.size_;
   res.real_size_ = file_size.real_size_;
+  res.link_count_ = file_size.link_count_;
 
   return res;
 #endif
@@ -686,6 +693,51 @@ Status FileFd::truncate_to_current_position(int64 current_position) {
   }
   return Status::OK();
 }
+
+Status FileFd::preallocate(int64 size) {
+  CHECK(!empty());
+  if (size <= 0) {
+    return Status::OK();
+  }
+#if TD_LINUX
+  TRY_RESULT(size_off_t, narrow_cast_safe<off_t>(size));
+  if (detail::skip_eintr([&] { return ::fallocate(get_native_fd().fd(), FALLOC_FL_KEEP_SIZE, 0, size_off_t); }) != 0) {
+    return OS_ERROR("Preallocate failed");
+  }
+  return Status::OK();
+#elif TD_DARWIN && defined(F_PREALLOCATE)
+  TRY_RESULT(size_off_t, narrow_cast_safe<off_t>(size));
+  TRY_RESULT(real_size, get_real_size());
+  if (real_size >= size) {
+    return Status::OK();
+  }
+  fstore_t store;
+  std::memset(&store, 0, sizeof(store));
+  store.fst_flags = F_ALLOCATECONTIG | F_ALLOCATEALL;
+  store.fst_posmode = F_PEOFPOSMODE;
+  store.fst_offset = 0;
+  store.fst_length = size_off_t - static_cast<off_t>(real_size);
+  if (detail::skip_eintr([&] { return fcntl(get_native_fd().fd(), F_PREALLOCATE, &store); }) == -1) {
+    // there is no enough contiguous space
+    store.fst_flags = F_ALLOCATEALL;
+    if (detail::skip_eintr([&] { return fcntl(get_native_fd().fd(), F_PREALLOCATE, &store); }) == -1) {
+      return OS_ERROR("Preallocate failed");
+    }
+  }
+  return Status::OK();
+#elif TD_PORT_WINDOWS
+  FILE_ALLOCATION_INFO allocation_info;
+  allocation_info.AllocationSize.QuadPart = size;
+  if (SetFileInformationByHandle(get_native_fd().fd(), FileAllocationInfo, &allocation_info,
+                                 sizeof(allocation_info)) == 0) {
+    return OS_ERROR("Preallocate failed");
+  }
+  return Status::OK();
+#else
+  return Status::Error("Preallocation isn't supported");
+#endif
+}
+
 PollableFdInfo &FileFd::get_poll_info() {
   CHECK(!empty());
   return impl_->info_;
@@ -68,6 +68,9 @@ class FileFd {
 
   Status truncate_to_current_position(int64 current_position) TD_WARN_UNUSED_RESULT;
 
+  // allocates disk space for the first size bytes of the file without changing its size
+  Status preallocate(int64 size) TD_WARN_UNUSED_RESULT;
+
   const NativeFd &get_native_fd() const;
   NativeFd move_as_native_fd();
 
@@ -9,6 +9,7 @@
 #include "td/utils/port/config.h"
 
 #include "td/utils/port/detail/Epoll.h"
+#include "td/utils/port/detail/IoUring.h"
 #include "td/utils/port/detail/KQueue.h"
 #include "td/utils/port/detail/Poll.h"
 #include "td/utils/port/detail/Select.h"
@@ -20,6 +21,8 @@ namespace td {
 
 #if TD_POLL_EPOLL
   using Poll = detail::Epoll;
+#elif TD_POLL_IO_URING
+  using Poll = detail::IoUring;
 #elif TD_POLL_KQUEUE
   using Poll = detail::KQueue;
 #elif TD_POLL_WINEVENT
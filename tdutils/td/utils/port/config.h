@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/utils/config.h"
 #include "td/utils/port/platform.h"
 
 // clang-format off
@@ -16,7 +17,10 @@
   #define TD_PORT_POSIX 1
 #endif
 
-#if TD_LINUX || TD_ANDROID || TD_TIZEN
+#if TD_LINUX && TD_USE_IO_URING
+  #define TD_POLL_IO_URING 1
+  #define TD_EVENTFD_LINUX 1
+#elif TD_LINUX || TD_ANDROID || TD_TIZEN
   #define TD_POLL_EPOLL 1
   #define TD_EVENTFD_LINUX 1
 #elif TD_FREEBSD || TD_OPENBSD || TD_NETBSD
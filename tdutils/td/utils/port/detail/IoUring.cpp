@@ -0,0 +1,284 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/port/detail/IoUring.h"
+
+char disable_linker_warning_about_empty_file_io_uring_cpp TD_UNUSED;
+
+#ifdef TD_POLL_IO_URING
+
+#include "td/utils/logging.h"
+#include "td/utils/Status.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+#include <endian.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace td {
+namespace detail {
+
+constexpr uint32 IoUring::SUBMISSION_QUEUE_SIZE;
+constexpr uint32 IoUring::COMPLETION_QUEUE_SIZE;
+
+IoUring::~IoUring() {
+  clear();
+}
+
+void IoUring::init() {
+  CHECK(!ring_fd_);
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = COMPLETION_QUEUE_SIZE;
+  ring_fd_ = NativeFd(static_cast<int>(syscall(__NR_io_uring_setup, SUBMISSION_QUEUE_SIZE, &params)));
+  auto io_uring_setup_errno = errno;
+  LOG_IF(FATAL, !ring_fd_) << Status::PosixError(io_uring_setup_errno, "io_uring_setup failed");
+  LOG_IF(FATAL, (params.features & IORING_FEAT_SINGLE_MMAP) == 0 || (params.features & IORING_FEAT_NODROP) == 0 ||
+                    (params.features & IORING_FEAT_EXT_ARG) == 0)
+      << "io_uring isn't supported by the kernel: " << params.features;
+
+  auto sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32);
+  auto cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  ring_size_ = max(sq_ring_size, cq_ring_size);
+  ring_ptr_ =
+      mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_.fd(), IORING_OFF_SQ_RING);
+  auto mmap_errno = errno;
+  LOG_IF(FATAL, ring_ptr_ == MAP_FAILED) << Status::PosixError(mmap_errno, "mmap of io_uring rings failed");
+
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  auto sqes_ptr =
+      mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_.fd(), IORING_OFF_SQES);
+  mmap_errno = errno;
+  LOG_IF(FATAL, sqes_ptr == MAP_FAILED) << Status::PosixError(mmap_errno, "mmap of io_uring entries failed");
+  sqes_ = static_cast<io_uring_sqe *>(sqes_ptr);
+
+  auto *ring = static_cast<char *>(ring_ptr_);
+  sq_head_ = reinterpret_cast<uint32 *>(ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32 *>(ring + params.sq_off.tail);
+  sq_flags_ = reinterpret_cast<uint32 *>(ring + params.sq_off.flags);
+  sq_mask_ = *reinterpret_cast<uint32 *>(ring + params.sq_off.ring_mask);
+  sq_entries_ = *reinterpret_cast<uint32 *>(ring + params.sq_off.ring_entries);
+  sq_local_tail_ = *sq_tail_;
+  auto *sq_array = reinterpret_cast<uint32 *>(ring + params.sq_off.array);
+  for (uint32 i = 0; i < sq_entries_; i++) {
+    sq_array[i] = i;
+  }
+
+  cq_head_ = reinterpret_cast<uint32 *>(ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32 *>(ring + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32 *>(ring + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(ring + params.cq_off.cqes);
+}
+
+void IoUring::clear() {
+  if (!ring_fd_) {
+    return;
+  }
+
+  munmap(sqes_, sqes_size_);
+  munmap(ring_ptr_, ring_size_);
+  sqes_ = nullptr;
+  ring_ptr_ = nullptr;
+  ring_fd_.close();
+  fds_.clear();
+
+  for (auto *list_node = list_root_.next; list_node != &list_root_;) {
+    auto pollable_fd = PollableFd::from_list_node(list_node);
+    list_node = list_node->next;
+  }
+}
+
+uint64 IoUring::get_user_data(int native_fd, uint32 generation) {
+  // zero user data is reserved for completions of POLL_REMOVE requests
+  return (static_cast<uint64>(generation) << 32) | (static_cast<uint64>(native_fd) + 1);
+}
+
+io_uring_sqe *IoUring::get_sqe() {
+  if (get_pending_submission_count() == sq_entries_) {
+    enter(sq_entries_, false, 0);
+    LOG_IF(FATAL, get_pending_submission_count() == sq_entries_) << "io_uring submission queue is full";
+  }
+  auto *sqe = &sqes_[sq_local_tail_ & sq_mask_];
+  std::memset(sqe, 0, sizeof(*sqe));
+  sq_local_tail_++;
+  return sqe;
+}
+
+void IoUring::add_poll(int native_fd) {
+  const auto &info = fds_[native_fd];
+  auto events = info.events;
+#if __BYTE_ORDER == __BIG_ENDIAN
+  events = (events << 16) | (events >> 16);
+#endif
+
+  auto *sqe = get_sqe();
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = native_fd;
+  sqe->poll32_events = events;
+  sqe->len = IORING_POLL_ADD_MULTI;
+  sqe->user_data = get_user_data(native_fd, info.generation);
+}
+
+void IoUring::remove_poll(int native_fd) {
+  const auto &info = fds_[native_fd];
+  auto *sqe = get_sqe();
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = get_user_data(native_fd, info.generation);
+  sqe->user_data = 0;
+}
+
+uint32 IoUring::get_pending_submission_count() const {
+  return sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+}
+
+void IoUring::enter(uint32 to_submit, bool wait, int timeout_ms) {
+  __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+
+  struct timespec timeout;
+  io_uring_getevents_arg arg;
+  std::memset(&arg, 0, sizeof(arg));
+  if (wait && timeout_ms >= 0) {
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000;
+    arg.ts = reinterpret_cast<uint64>(&timeout);
+  }
+  // IORING_ENTER_GETEVENTS also moves overflowed completions to the completion queue
+  auto flags = IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+  auto min_complete = wait ? 1 : 0;
+  auto result = syscall(__NR_io_uring_enter, ring_fd_.fd(), to_submit, min_complete, flags, &arg, sizeof(arg));
+  auto io_uring_enter_errno = errno;
+  LOG_IF(FATAL, result == -1 && io_uring_enter_errno != EINTR && io_uring_enter_errno != ETIME &&
+                    io_uring_enter_errno != EAGAIN && io_uring_enter_errno != EBUSY)
+      << Status::PosixError(io_uring_enter_errno, "io_uring_enter failed");
+}
+
+void IoUring::process_completions() {
+  auto head = *cq_head_;
+  auto tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) {
+    const auto *cqe = &cqes_[head & cq_mask_];
+    if (cqe->user_data == 0) {
+      continue;
+    }
+    auto native_fd = static_cast<int>((cqe->user_data & 0xFFFFFFFF) - 1);
+    auto generation = static_cast<uint32>(cqe->user_data >> 32);
+    if (static_cast<size_t>(native_fd) >= fds_.size() || fds_[native_fd].generation != generation ||
+        fds_[native_fd].list_node == nullptr) {
+      // the file descriptor has already been unsubscribed
+      continue;
+    }
+    LOG_IF(FATAL, cqe->res < 0) << Status::PosixError(-cqe->res, "io_uring poll failed") << ", fd = " << native_fd;
+
+    auto events = static_cast<uint32>(cqe->res);
+    PollFlags flags;
+    if (events & POLLIN) {
+      events &= ~POLLIN;
+      flags = flags | PollFlags::Read();
+    }
+    if (events & POLLOUT) {
+      events &= ~POLLOUT;
+      flags = flags | PollFlags::Write();
+    }
+#ifdef POLLRDHUP
+    if (events & POLLRDHUP) {
+      events &= ~POLLRDHUP;
+      flags = flags | PollFlags::Close();
+    }
+#endif
+    if (events & POLLHUP) {
+      events &= ~POLLHUP;
+      flags = flags | PollFlags::Close();
+    }
+    if (events & (POLLERR | POLLNVAL)) {
+      events &= ~(POLLERR | POLLNVAL);
+      flags = flags | PollFlags::Error();
+    }
+    if (events) {
+      LOG(FATAL) << "Unsupported io_uring poll events: " << static_cast<int32>(events);
+    }
+
+    auto pollable_fd = PollableFd::from_list_node(fds_[native_fd].list_node);
+    pollable_fd.add_flags(flags);
+    pollable_fd.release_as_list_node();
+
+    if ((cqe->flags & IORING_CQE_F_MORE) == 0) {
+      // the kernel has terminated the multishot request, for example, because the completion queue has overflowed
+      add_poll(native_fd);
+    }
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+void IoUring::subscribe(PollableFd fd, PollFlags flags) {
+  uint32 events = EPOLLHUP | EPOLLERR | EPOLLET;
+#ifdef EPOLLRDHUP
+  events |= EPOLLRDHUP;
+#endif
+  if (flags.can_read()) {
+    events |= EPOLLIN;
+  }
+  if (flags.can_write()) {
+    events |= EPOLLOUT;
+  }
+  auto native_fd = fd.native_fd().fd();
+  auto *list_node = fd.release_as_list_node();
+  list_root_.put(list_node);
+
+  CHECK(native_fd >= 0);
+  if (static_cast<size_t>(native_fd) >= fds_.size()) {
+    fds_.resize(max(static_cast<size_t>(native_fd) + 1, fds_.size() * 2));
+  }
+  auto &info = fds_[native_fd];
+  CHECK(info.list_node == nullptr);
+  info.list_node = list_node;
+  info.events = events;
+
+  // the request is submitted by the next run together with the wait for events
+  add_poll(native_fd);
+}
+
+void IoUring::unsubscribe(PollableFdRef fd_ref) {
+  auto fd = fd_ref.lock();
+  auto native_fd = fd.native_fd().fd();
+  CHECK(static_cast<size_t>(native_fd) < fds_.size());
+  auto &info = fds_[native_fd];
+  CHECK(info.list_node != nullptr);
+  remove_poll(native_fd);
+  info.list_node = nullptr;
+  info.generation++;
+
+  // the poll request holds a reference to the file, so it must be removed before the file descriptor is closed
+  enter(get_pending_submission_count(), false, 0);
+}
+
+void IoUring::unsubscribe_before_close(PollableFdRef fd) {
+  unsubscribe(fd);
+}
+
+void IoUring::run(int timeout_ms) {
+  auto to_submit = get_pending_submission_count();
+  bool has_completions = *cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  bool has_overflow = (__atomic_load_n(sq_flags_, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) != 0;
+  bool wait = timeout_ms != 0 && !has_completions;
+  if (to_submit != 0 || wait || has_overflow) {
+    enter(to_submit, wait, timeout_ms);
+  }
+  process_completions();
+}
+
+}  // namespace detail
+}  // namespace td
+
+#endif
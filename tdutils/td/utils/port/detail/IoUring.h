@@ -0,0 +1,103 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/port/config.h"
+
+#ifdef TD_POLL_IO_URING
+
+#include "td/utils/common.h"
+#include "td/utils/List.h"
+#include "td/utils/port/detail/NativeFd.h"
+#include "td/utils/port/detail/PollableFd.h"
+#include "td/utils/port/PollBase.h"
+#include "td/utils/port/PollFlags.h"
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace td {
+namespace detail {
+
+// edge-triggered poll, which uses multishot IORING_OP_POLL_ADD requests instead of epoll_ctl calls,
+// so subscriptions made between two run calls are submitted to the kernel in one system call together with the wait
+class IoUring final : public PollBase {
+ public:
+  IoUring() = default;
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+  IoUring(IoUring &&) = delete;
+  IoUring &operator=(IoUring &&) = delete;
+  ~IoUring() final;
+
+  void init() final;
+
+  void clear() final;
+
+  void subscribe(PollableFd fd, PollFlags flags) final;
+
+  void unsubscribe(PollableFdRef fd) final;
+
+  void unsubscribe_before_close(PollableFdRef fd) final;
+
+  void run(int timeout_ms) final;
+
+  static bool is_edge_triggered() {
+    return true;
+  }
+
+ private:
+  static constexpr uint32 SUBMISSION_QUEUE_SIZE = 1024;
+  static constexpr uint32 COMPLETION_QUEUE_SIZE = 16384;
+
+  struct FdInfo {
+    ListNode *list_node = nullptr;
+    uint32 events = 0;
+    uint32 generation = 0;
+  };
+
+  NativeFd ring_fd_;
+
+  void *ring_ptr_ = nullptr;
+  size_t ring_size_ = 0;
+  io_uring_sqe *sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  uint32 *sq_head_ = nullptr;
+  uint32 *sq_tail_ = nullptr;
+  uint32 *sq_flags_ = nullptr;
+  uint32 sq_mask_ = 0;
+  uint32 sq_entries_ = 0;
+  uint32 sq_local_tail_ = 0;
+
+  uint32 *cq_head_ = nullptr;
+  uint32 *cq_tail_ = nullptr;
+  uint32 cq_mask_ = 0;
+  io_uring_cqe *cqes_ = nullptr;
+
+  vector<FdInfo> fds_;  // indexed by native file descriptor
+  ListNode list_root_;
+
+  static uint64 get_user_data(int native_fd, uint32 generation);
+
+  io_uring_sqe *get_sqe();
+
+  void add_poll(int native_fd);
+
+  void remove_poll(int native_fd);
+
+  uint32 get_pending_submission_count() const;
+
+  void enter(uint32 to_submit, bool wait, int timeout_ms);
+
+  void process_completions();
+};
+
+}  // namespace detail
+}  // namespace td
+
+#endif
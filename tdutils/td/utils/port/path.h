@@ -23,6 +23,9 @@ Status mkpath(CSlice path, int32 mode = 0700) TD_WARN_UNUSED_RESULT;
 
 Status rename(CSlice from, CSlice to) TD_WARN_UNUSED_RESULT;
 
+// creates a hard link "to" to the existing file "from"
+Status link(CSlice from, CSlice to) TD_WARN_UNUSED_RESULT;
+
 Result<string> realpath(CSlice slice, bool ignore_access_denied = false) TD_WARN_UNUSED_RESULT;
 
 Status chdir(CSlice dir) TD_WARN_UNUSED_RESULT;
@@ -12,6 +12,7 @@
 #include "td/utils/utf8.h"
 
 #include <algorithm>
+#include <mutex>
 #include <utility>
 
 namespace td {
@@ -102,7 +103,61 @@ static void add_word_transliterations(vector<string> &result, Slice word, bool a
   }
 }
 
-vector<string> get_word_transliterations(Slice word, bool allow_partial) {
+namespace {
+
+// names of different chats and users share many words, so the same words are transliterated many times;
+// recently used words are kept in two generations of bounded size, which approximates an LRU cache
+class TransliterationCache {
+  static constexpr size_t MAX_GENERATION_SIZE = 10000;
+
+  std::mutex mutex_;
+  FlatHashMap<string, vector<string>> current_generation_[2];
+  FlatHashMap<string, vector<string>> old_generation_[2];
+
+ public:
+  bool get(const string &word, bool allow_partial, vector<string> &result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &current_generation = current_generation_[allow_partial];
+    auto it = current_generation.find(word);
+    if (it != current_generation.end()) {
+      result = it->second;
+      return true;
+    }
+
+    auto &old_generation = old_generation_[allow_partial];
+    auto old_it = old_generation.find(word);
+    if (old_it == old_generation.end()) {
+      return false;
+    }
+    result = old_it->second;
+    add_to_current_generation(allow_partial, word, std::move(old_it->second));
+    return true;
+  }
+
+  void add(string word, bool allow_partial, vector<string> transliterations) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    add_to_current_generation(allow_partial, std::move(word), std::move(transliterations));
+  }
+
+ private:
+  void add_to_current_generation(bool allow_partial, string word, vector<string> transliterations) {
+    auto &current_generation = current_generation_[allow_partial];
+    if (current_generation.size() >= MAX_GENERATION_SIZE) {
+      old_generation_[allow_partial] = std::move(current_generation);
+      current_generation = {};
+    }
+    current_generation[std::move(word)] = std::move(transliterations);
+  }
+};
+
+TransliterationCache &get_transliteration_cache() {
+  static TransliterationCache cache;
+  return cache;
+}
+
+}  // namespace
+
+static vector<string> do_get_word_transliterations(Slice word, bool allow_partial) {
   vector<string> result;
 
   add_word_transliterations(result, word, allow_partial, get_en_to_ru_simple_rules(), get_en_to_ru_complex_rules());
@@ -112,4 +167,21 @@ vector<string> get_word_transliterations(Slice word, bool allow_partial) {
   return result;
 }
 
+vector<string> get_word_transliterations(Slice word, bool allow_partial) {
+  if (word.empty()) {
+    return do_get_word_transliterations(word, allow_partial);
+  }
+
+  vector<string> result;
+  auto &cache = get_transliteration_cache();
+  auto word_str = word.str();
+  if (cache.get(word_str, allow_partial, result)) {
+    return result;
+  }
+
+  result = do_get_word_transliterations(word, allow_partial);
+  cache.add(std::move(word_str), allow_partial, result);
+  return result;
+}
+
 }  // namespace td
@@ -8,6 +8,8 @@
 
 #include "td/utils/logging.h"
 
+#include <map>
+
 namespace td {
 
 // list of [(range_begin << 5) + range_type]
@@ -1316,28 +1318,82 @@ static uint32 binary_search_ranges(const int32 (&ranges)[N], uint32 code) {
   }
 }
 
+namespace {
+
+/**
+ * Two-level lookup table for the replacements of characters from the Basic Multilingual Plane.
+ * Each block of BLOCK_SIZE consecutive characters is mapped to a block of differences between replacement and
+ * original characters, and equal blocks of differences, for example, identity blocks, are stored only once.
+ */
+class BmpReplacementTable {
+  static constexpr uint32 BMP_SIZE = 0x10000;
+  static constexpr uint32 BLOCK_SIZE = 256;
+
+  uint8 block_ids_[BMP_SIZE / BLOCK_SIZE];
+  vector<int32> deltas_;
+
+ public:
+  template <size_t N>
+  explicit BmpReplacementTable(const int32 (&ranges)[N]) {
+    std::map<vector<int32>, uint8> block_to_id;
+    vector<int32> block(BLOCK_SIZE);
+    for (uint32 block_begin = 0; block_begin < BMP_SIZE; block_begin += BLOCK_SIZE) {
+      for (uint32 i = 0; i < BLOCK_SIZE; i++) {
+        auto code = block_begin + i;
+        block[i] = static_cast<int32>(binary_search_ranges(ranges, code)) - static_cast<int32>(code);
+      }
+      auto it = block_to_id.find(block);
+      if (it == block_to_id.end()) {
+        it = block_to_id.emplace(block, static_cast<uint8>(block_to_id.size())).first;
+        deltas_.insert(deltas_.end(), block.begin(), block.end());
+      }
+      block_ids_[block_begin / BLOCK_SIZE] = it->second;
+    }
+  }
+
+  static bool is_supported(uint32 code) {
+    return code < BMP_SIZE;
+  }
+
+  uint32 get(uint32 code) const {
+    return static_cast<uint32>(static_cast<int32>(code) +
+                               deltas_[block_ids_[code / BLOCK_SIZE] * BLOCK_SIZE + code % BLOCK_SIZE]);
+  }
+};
+
+}  // namespace
+
 uint32 prepare_search_character(uint32 code) {
   if (code < TABLE_SIZE) {
     return prepare_search_character_table[code];
-  } else {
-    return binary_search_ranges(prepare_search_character_ranges, code);
   }
+  if (BmpReplacementTable::is_supported(code)) {
+    static const BmpReplacementTable table(prepare_search_character_ranges);
+    return table.get(code);
+  }
+  return binary_search_ranges(prepare_search_character_ranges, code);
 }
 
 uint32 unicode_to_lower(uint32 code) {
   if (code < TABLE_SIZE) {
     return to_lower_table[code];
-  } else {
-    return binary_search_ranges(to_lower_ranges, code);
   }
+  if (BmpReplacementTable::is_supported(code)) {
+    static const BmpReplacementTable table(to_lower_ranges);
+    return table.get(code);
+  }
+  return binary_search_ranges(to_lower_ranges, code);
 }
 
 uint32 remove_diacritics(uint32 code) {
   if (code < TABLE_SIZE) {
     return without_diacritics_table[code];
-  } else {
-    return binary_search_ranges(without_diacritics_ranges, code);
   }
+  if (BmpReplacementTable::is_supported(code)) {
+    static const BmpReplacementTable table(without_diacritics_ranges);
+    return table.get(code);
+  }
+  return binary_search_ranges(without_diacritics_ranges, code);
 }
 
 }  // namespace td
@@ -6,16 +6,43 @@
 //
 #include "td/utils/utf8.h"
 
+#include "td/utils/as.h"
+#include "td/utils/bits.h"
 #include "td/utils/misc.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/unicode.h"
 
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
 namespace td {
 
+// strings are processed 8 bytes at a time; a byte has its high bit set in the mask if the condition holds for it
+static constexpr uint64 HIGH_BITS = 0x8080808080808080ULL;
+
+static uint64 get_continuation_code_unit_mask(uint64 word) {
+  return word & ~(word << 1) & HIGH_BITS;
+}
+
+static uint64 get_4_byte_first_code_unit_mask(uint64 word) {
+  return word & (word << 1) & (word << 2) & (word << 3) & ~(word << 4) & HIGH_BITS;
+}
+
 bool check_utf8(CSlice str) {
   const char *data = str.data();
   const char *data_end = data + str.size();
   do {
+    // skip ASCII characters
+#ifdef __wasm_simd128__
+    while (data_end - data >= 16 && wasm_i8x16_bitmask(wasm_v128_load(data)) == 0) {
+      data += 16;
+    }
+#endif
+    while (data_end - data >= 8 && (as<uint64>(data) & HIGH_BITS) == 0) {
+      data += 8;
+    }
+
     uint32 a = static_cast<unsigned char>(*data++);
     if ((a & 0x80) == 0) {
       if (data == data_end + 1) {
@@ -146,7 +173,31 @@ vector<string> utf8_get_search_words(Slice str) {
 }
 
 string utf8_prepare_search_string(Slice str) {
-  return implode(utf8_get_search_words(str));
+  // the same as implode(utf8_get_search_words(str)), but without creating intermediate words
+  string result;
+  result.reserve(str.size());
+  bool in_word = false;
+  auto pos = str.ubegin();
+  auto end = str.uend();
+  while (pos != end) {
+    uint32 code;
+    pos = next_utf8_unsafe(pos, &code);
+
+    code = prepare_search_character(code);
+    if (code == 0) {
+      continue;
+    }
+    if (code == ' ') {
+      in_word = false;
+    } else {
+      if (!in_word && !result.empty()) {
+        result += ' ';
+      }
+      in_word = true;
+      append_utf8_character(result, remove_diacritics(code));
+    }
+  }
+  return result;
 }
 
 string utf8_encode(CSlice data) {
@@ -156,10 +207,46 @@ string utf8_encode(CSlice data) {
   return PSTRING() << "url_decode(" << url_encode(data) << ')';
 }
 
+size_t utf8_length(Slice str) {
+  const char *data = str.data();
+  size_t size = str.size();
+  size_t result = size;
+#ifdef __wasm_simd128__
+  // continuation code units are exactly the bytes less than -64 if treated as signed
+  const auto continuation_code_unit_bound = wasm_i8x16_splat(-64);
+  for (; size >= 16; data += 16, size -= 16) {
+    auto is_continuation_code_unit = wasm_i8x16_lt(wasm_v128_load(data), continuation_code_unit_bound);
+    result -= static_cast<size_t>(count_bits32(static_cast<uint32>(wasm_i8x16_bitmask(is_continuation_code_unit))));
+  }
+#endif
+  for (; size >= 8; data += 8, size -= 8) {
+    uint64 word = as<uint64>(data);
+    if ((word & HIGH_BITS) != 0) {
+      result -= static_cast<size_t>(count_bits64(get_continuation_code_unit_mask(word)));
+    }
+  }
+  for (; size > 0; data++, size--) {
+    result -= !is_utf8_character_first_code_unit(static_cast<unsigned char>(*data));
+  }
+  return result;
+}
+
 size_t utf8_utf16_length(Slice str) {
-  size_t result = 0;
-  for (auto c : str) {
-    result += is_utf8_character_first_code_unit(c) + ((c & 0xf8) == 0xf0);
+  const char *data = str.data();
+  size_t size = str.size();
+  size_t result = size;
+  for (; size >= 8; data += 8, size -= 8) {
+    uint64 word = as<uint64>(data);
+    if ((word & HIGH_BITS) != 0) {
+      // each 4-byte character has 3 continuation code units, but takes 2 UTF-16 code units
+      result -= static_cast<size_t>(count_bits64(get_continuation_code_unit_mask(word)));
+      result += static_cast<size_t>(count_bits64(get_4_byte_first_code_unit_mask(word)));
+    }
+  }
+  for (; size > 0; data++, size--) {
+    auto c = static_cast<unsigned char>(*data);
+    result -= !is_utf8_character_first_code_unit(c);
+    result += (c & 0xf8) == 0xf0;
   }
   return result;
 }
@@ -193,4 +280,19 @@ Slice utf8_utf16_substr(Slice str, size_t offset, size_t length) {
   return utf8_utf16_truncate(utf8_utf16_substr(str, offset), length);
 }
 
+Slice Utf8Utf16SubstrFinder::substr(size_t offset, size_t length) {
+  if (offset < utf16_pos_) {
+    pos_ = 0;
+    utf16_pos_ = 0;
+  }
+  while (utf16_pos_ < offset && pos_ < str_.size()) {
+    auto c = static_cast<unsigned char>(str_[pos_++]);
+    utf16_pos_ += 1 + (c >= 0xf0);  // >= 4 bytes in symbol => surrogate pair
+    while (pos_ < str_.size() && !is_utf8_character_first_code_unit(static_cast<unsigned char>(str_[pos_]))) {
+      pos_++;
+    }
+  }
+  return utf8_utf16_truncate(str_.substr(pos_), length);
+}
+
 }  // namespace td
@@ -20,13 +20,7 @@ inline bool is_utf8_character_first_code_unit(unsigned char c) {
 }
 
 /// returns length of UTF-8 string in characters
-inline size_t utf8_length(Slice str) {
-  size_t result = 0;
-  for (auto c : str) {
-    result += is_utf8_character_first_code_unit(c);
-  }
-  return result;
-}
+size_t utf8_length(Slice str);
 
 /// returns length of UTF-8 string in UTF-16 code units
 size_t utf8_utf16_length(Slice str);
@@ -103,6 +97,21 @@ Slice utf8_utf16_substr(Slice str, size_t offset);
 
 Slice utf8_utf16_substr(Slice str, size_t offset, size_t length);
 
+/// returns substrings of a UTF-8 string by offsets and lengths in UTF-16 code units;
+/// if offsets don't decrease between calls, then total time is linear in the string size
+class Utf8Utf16SubstrFinder {
+ public:
+  explicit Utf8Utf16SubstrFinder(Slice str) : str_(str) {
+  }
+
+  Slice substr(size_t offset, size_t length);
+
+ private:
+  Slice str_;
+  size_t pos_ = 0;
+  size_t utf16_pos_ = 0;
+};
+
 /// Returns UTF-8 string converted to lower case.
 string utf8_to_lower(Slice str);
 
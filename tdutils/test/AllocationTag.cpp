@@ -0,0 +1,49 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/AllocationTag.h"
+#include "td/utils/common.h"
+#include "td/utils/tests.h"
+
+static td::int64 get_allocated_size(td::Slice name) {
+  for (auto &usage : td::AllocationTag::get_memory_usage()) {
+    if (usage.name == name) {
+      return usage.size;
+    }
+  }
+  return 0;
+}
+
+TEST(AllocationTag, simple) {
+  ASSERT_EQ(0, td::AllocationTag::get_tag("AllocationTagTest"));
+
+  td::AllocationTag::set_enabled(true);
+  auto tag = td::AllocationTag::get_tag("AllocationTagTest");
+  ASSERT_TRUE(tag > 0);
+  ASSERT_EQ(tag, td::AllocationTag::get_tag("AllocationTagTest"));
+  ASSERT_TRUE(tag != td::AllocationTag::get_tag("AllocationTagTest2"));
+  ASSERT_EQ(0, td::AllocationTag::get_tag(""));
+
+  auto old_size = get_allocated_size("AllocationTagTest");
+  ASSERT_EQ(0, td::AllocationTag::get_current_tag());
+  {
+    td::AllocationTagGuard guard(tag);
+    ASSERT_EQ(tag, td::AllocationTag::get_current_tag());
+    {
+      td::AllocationTagGuard empty_guard(0);
+      ASSERT_EQ(tag, td::AllocationTag::get_current_tag());
+    }
+    td::AllocationTag::on_memory_allocated(td::AllocationTag::get_current_tag(), 100);
+  }
+  ASSERT_EQ(0, td::AllocationTag::get_current_tag());
+
+  ASSERT_EQ(old_size + 100, get_allocated_size("AllocationTagTest"));
+  td::AllocationTag::on_memory_allocated(tag, 20);
+  ASSERT_EQ(old_size + 120, get_allocated_size("AllocationTagTest"));
+  td::AllocationTag::on_memory_allocated(tag, -120);
+  ASSERT_EQ(old_size, get_allocated_size("AllocationTagTest"));
+  td::AllocationTag::set_enabled(false);
+}
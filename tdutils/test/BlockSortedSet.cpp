@@ -0,0 +1,58 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/BlockSortedSet.h"
+#include "td/utils/common.h"
+#include "td/utils/Random.h"
+#include "td/utils/tests.h"
+
+#include <iterator>
+#include <set>
+
+TEST(BlockSortedSet, empty) {
+  td::BlockSortedSet<int> set;
+  ASSERT_TRUE(set.empty());
+  ASSERT_EQ(0u, set.size());
+  ASSERT_TRUE(set.begin() == set.end());
+  ASSERT_TRUE(set.upper_bound(0) == set.end());
+  ASSERT_TRUE(set.find(0) == set.end());
+  ASSERT_EQ(0u, set.erase(0));
+  ASSERT_EQ(0u, set.get_rank(0));
+}
+
+TEST(BlockSortedSet, stress) {
+  td::Random::Xorshift128plus rnd(123);
+  for (int test = 0; test < 10; test++) {
+    td::BlockSortedSet<int, 4> set;
+    std::set<int> expected;
+    int max_value = rnd.fast(1, 1000);
+    for (int i = 0; i < 10000; i++) {
+      auto value = rnd.fast(0, max_value);
+      if (rnd.fast(0, 2) != 0) {
+        auto result = set.insert(value);
+        ASSERT_EQ(expected.insert(value).second, result.second);
+        ASSERT_EQ(value, *result.first);
+      } else {
+        ASSERT_EQ(expected.erase(value), set.erase(value));
+      }
+      ASSERT_EQ(expected.size(), set.size());
+
+      auto query = rnd.fast(-1, max_value + 1);
+      auto it = set.upper_bound(query);
+      auto expected_it = expected.upper_bound(query);
+      ASSERT_EQ(expected_it == expected.end(), it == set.end());
+      if (expected_it != expected.end()) {
+        ASSERT_EQ(*expected_it, *it);
+      }
+      ASSERT_EQ(static_cast<size_t>(std::distance(expected.begin(), expected.lower_bound(query))),
+                set.get_rank(query));
+      ASSERT_EQ(expected.count(query) != 0, set.find(query) != set.end());
+    }
+
+    td::vector<int> values(set.begin(), set.end());
+    ASSERT_EQ(td::vector<int>(expected.begin(), expected.end()), values);
+  }
+}
@@ -60,6 +60,32 @@ TEST(ChainScheduler, SendAfterRestart) {
   ASSERT_TRUE(!scheduler.start_next_task());
 }
 
+TEST(ChainScheduler, MaxActiveTasks) {
+  td::ChainScheduler<int> scheduler;
+  std::vector<td::ChainScheduler<int>::ChainId> chains{1};
+  scheduler.set_max_active_tasks(2);
+
+  td::vector<td::ChainScheduler<int>::TaskId> task_ids;
+  for (int i = 0; i < 5; i++) {
+    task_ids.push_back(scheduler.create_task(chains, i));
+  }
+  ASSERT_EQ(task_ids[0], scheduler.start_next_task().unwrap().task_id);
+  auto second_task = scheduler.start_next_task().unwrap();
+  ASSERT_EQ(task_ids[1], second_task.task_id);
+  ASSERT_EQ(1u, second_task.parents.size());
+  ASSERT_EQ(task_ids[0], second_task.parents[0]);
+  ASSERT_TRUE(!scheduler.start_next_task());
+
+  scheduler.finish_task(task_ids[0]);
+  ASSERT_EQ(task_ids[2], scheduler.start_next_task().unwrap().task_id);
+  ASSERT_TRUE(!scheduler.start_next_task());
+
+  scheduler.set_max_active_tasks(4);
+  ASSERT_EQ(task_ids[3], scheduler.start_next_task().unwrap().task_id);
+  ASSERT_EQ(task_ids[4], scheduler.start_next_task().unwrap().task_id);
+  ASSERT_TRUE(!scheduler.start_next_task());
+}
+
 TEST(ChainScheduler, Basic) {
   td::ChainScheduler<int> scheduler;
   for (int i = 0; i < 100; i++) {
@@ -11,6 +11,7 @@
 #include "td/utils/misc.h"
 #include "td/utils/port/Mutex.h"
 #include "td/utils/port/thread.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/SpinLock.h"
 #include "td/utils/tests.h"
 
@@ -228,10 +229,90 @@ class HashMapBenchmark final : public td::Benchmark {
   }
 };
 
+// registries are mostly read, so measure lookups in a filled map
+template <class HashMap>
+class HashMapFindBenchmark final : public td::Benchmark {
+  static constexpr int KEY_COUNT = 10000;
+
+  std::size_t threads_n = 16;
+  td::unique_ptr<HashMap> hash_map;
+
+ public:
+  explicit HashMapFindBenchmark(std::size_t threads_n) : threads_n(threads_n) {
+  }
+  td::string get_description() const final {
+    return PSTRING() << HashMap::get_name() << " find";
+  }
+  void start_up() final {
+    hash_map = td::make_unique<HashMap>(KEY_COUNT * 2);
+    for (int i = 1; i <= KEY_COUNT; i++) {
+      hash_map->insert(i, i + 1);
+    }
+  }
+
+  void run(int n) final {
+    td::vector<td::thread> threads;
+    for (std::size_t i = 0; i < threads_n; i++) {
+      threads.emplace_back([n, this] {
+        int result = 0;
+        for (int i = 0; i < n; i++) {
+          result += hash_map->find(i % KEY_COUNT + 1, -1);
+        }
+        td::do_not_optimize_away(result);
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  void tear_down() final {
+    hash_map.reset();
+  }
+};
+
 template <class HashMap>
 static void bench_hash_map() {
   td::bench(HashMapBenchmark<HashMap>(16));
   td::bench(HashMapBenchmark<HashMap>(1));
+  td::bench(HashMapFindBenchmark<HashMap>(16));
+  td::bench(HashMapFindBenchmark<HashMap>(1));
+}
+
+TEST(ConcurrentHashMap, erase) {
+  td::ConcurrentHashMap<td::int32, td::int32> hash_map;
+  constexpr td::int32 KEY_COUNT = 1000;
+  td::vector<td::thread> threads;
+  for (td::int32 thread_id = 0; thread_id < 4; thread_id++) {
+    threads.emplace_back([&hash_map, thread_id] {
+      for (td::int32 step = 0; step < 10; step++) {
+        for (td::int32 i = 1; i <= KEY_COUNT; i++) {
+          auto key = thread_id * KEY_COUNT + i;
+          ASSERT_EQ(step + 2, hash_map.insert(key, step + 2));
+        }
+        for (td::int32 i = 1; i <= KEY_COUNT; i++) {
+          auto key = thread_id * KEY_COUNT + i;
+          ASSERT_EQ(step + 2, hash_map.find(key, -1));
+          if (i % 2 == 0 || step != 9) {
+            ASSERT_EQ(step + 2, hash_map.erase(key));
+            ASSERT_EQ(-1, hash_map.find(key, -1));
+            ASSERT_EQ(0, hash_map.erase(key));
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::size_t count = 0;
+  hash_map.for_each([&](td::int32 key, td::int32 value) {
+    ASSERT_EQ(1, key % 2);
+    ASSERT_EQ(11, value);
+    count++;
+  });
+  ASSERT_EQ(static_cast<std::size_t>(2 * KEY_COUNT), count);
 }
 
 TEST(ConcurrentHashMap, Benchmark) {
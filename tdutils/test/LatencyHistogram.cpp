@@ -0,0 +1,58 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/common.h"
+#include "td/utils/LatencyHistogram.h"
+#include "td/utils/Random.h"
+#include "td/utils/tests.h"
+
+#include <algorithm>
+
+TEST(LatencyHistogram, empty) {
+  td::LatencyHistogram histogram;
+  ASSERT_EQ(0u, histogram.get_count());
+  ASSERT_TRUE(histogram.get_average() == 0.0);
+  ASSERT_TRUE(histogram.get_max() == 0.0);
+  ASSERT_TRUE(histogram.get_percentile(50) == 0.0);
+}
+
+TEST(LatencyHistogram, small_values) {
+  td::LatencyHistogram histogram;
+  for (int i = 0; i < 10; i++) {
+    histogram.add(i * 1e-6);
+  }
+  histogram.add(-1.0);
+  ASSERT_EQ(11u, histogram.get_count());
+  ASSERT_EQ(9, static_cast<int>(histogram.get_max() * 1e6 + 0.5));
+  ASSERT_EQ(4, static_cast<int>(histogram.get_percentile(50) * 1e6 + 0.5));
+  ASSERT_EQ(9, static_cast<int>(histogram.get_percentile(100) * 1e6 + 0.5));
+
+  histogram.clear();
+  ASSERT_EQ(0u, histogram.get_count());
+  ASSERT_TRUE(histogram.get_max() == 0.0);
+}
+
+TEST(LatencyHistogram, relative_error) {
+  td::LatencyHistogram histogram;
+  td::vector<double> delays;
+  for (int i = 0; i < 100000; i++) {
+    auto delay = td::Random::fast(1, 1000000000) * 1e-6;
+    delays.push_back(delay);
+    histogram.add(delay);
+  }
+  histogram.add(1e9);
+  delays.push_back(1e6);
+  std::sort(delays.begin(), delays.end());
+
+  ASSERT_EQ(delays.size(), histogram.get_count());
+  ASSERT_TRUE(histogram.get_max() >= 1e6 && histogram.get_max() < 1.2e6);
+  for (auto percentile : {1.0, 10.0, 50.0, 90.0, 99.0, 99.9}) {
+    auto expected = delays[static_cast<size_t>(static_cast<double>(delays.size()) * percentile / 100.0)];
+    auto result = histogram.get_percentile(percentile);
+    ASSERT_TRUE(result >= expected - 1e-6);
+    ASSERT_TRUE(result <= expected * 1.125 + 1e-6);
+  }
+}
@@ -0,0 +1,124 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/benchmark.h"
+#include "td/utils/common.h"
+#include "td/utils/ObjectPool.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/tests.h"
+
+namespace {
+
+struct Node {
+  int value = 0;
+
+  Node() = default;
+  explicit Node(int value) : value(value) {
+  }
+
+  void clear() {
+    value = 0;
+  }
+};
+
+}  // namespace
+
+TEST(ObjectPool, simple) {
+  td::ObjectPool<Node> pool;
+  auto ptr = pool.create(1);
+  ASSERT_EQ(1, ptr->value);
+  auto weak_ptr = ptr.get_weak();
+  ASSERT_TRUE(weak_ptr.is_alive());
+  ASSERT_EQ(1, weak_ptr->value);
+
+  ptr.reset();
+  ASSERT_TRUE(!weak_ptr.is_alive());
+
+  td::vector<td::ObjectPool<Node>::OwnerPtr> ptrs;
+  for (int i = 0; i < 1000; i++) {
+    ptrs.push_back(pool.create(i));
+  }
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(i, ptrs[i]->value);
+  }
+  ASSERT_TRUE(!weak_ptr.is_alive());
+  ptrs.clear();
+}
+
+TEST(ObjectPool, threads) {
+  td::ObjectPool<Node> pool;
+  static constexpr int THREAD_COUNT = 4;
+  static constexpr int OBJECT_COUNT = 1000;
+  td::vector<td::vector<td::ObjectPool<Node>::OwnerPtr>> created(THREAD_COUNT);
+  td::vector<td::thread> threads;
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < 100 * OBJECT_COUNT; j++) {
+        auto ptr = pool.create(j);
+        CHECK(ptr->value == j);
+        if (j % 100 == 0) {
+          created[i].push_back(std::move(ptr));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  // release the objects on other threads
+  for (int i = 0; i < THREAD_COUNT; i++) {
+    threads.emplace_back([&, i] {
+      auto &ptrs = created[(i + 1) % THREAD_COUNT];
+      for (int j = 0; j < OBJECT_COUNT; j++) {
+        CHECK(ptrs[j]->value == j * 100);
+        auto weak_ptr = ptrs[j].get_weak();
+        ptrs[j].reset();
+        CHECK(!weak_ptr.is_alive());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+class ObjectPoolBenchmark final : public td::Benchmark {
+  int thread_count_;
+
+ public:
+  explicit ObjectPoolBenchmark(int thread_count) : thread_count_(thread_count) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "ObjectPool create/reset with " << thread_count_ << " threads";
+  }
+
+  void run(int n) final {
+    td::ObjectPool<Node> pool;
+    td::vector<td::thread> threads;
+    for (int i = 0; i < thread_count_; i++) {
+      threads.emplace_back([&] {
+        td::vector<td::ObjectPool<Node>::OwnerPtr> ptrs(16);
+        for (int j = 0; j < n; j++) {
+          auto &ptr = ptrs[j & 15];
+          ptr.reset();
+          ptr = pool.create(j);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+};
+
+TEST(ObjectPool, bench) {
+  td::bench(ObjectPoolBenchmark(1));
+  td::bench(ObjectPoolBenchmark(4));
+}
@@ -0,0 +1,66 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/common.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/StripedMpscPollableQueue.h"
+#include "td/utils/tests.h"
+
+#include <utility>
+
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+TEST(StripedMpscPollableQueue, simple) {
+  td::StripedMpscPollableQueue<int> queue(4);
+  queue.init();
+  ASSERT_EQ(0, queue.reader_wait_nonblock());
+  for (int i = 0; i < 10; i++) {
+    queue.writer_put(i);
+  }
+  ASSERT_EQ(10, queue.reader_wait_nonblock());
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(i, queue.reader_get_unsafe());
+  }
+  ASSERT_EQ(0, queue.reader_wait_nonblock());
+  queue.destroy();
+}
+
+TEST(StripedMpscPollableQueue, multithreaded) {
+  constexpr int WRITER_COUNT = 8;
+  constexpr int VALUE_COUNT = 100000;
+  td::StripedMpscPollableQueue<std::pair<int, int>> queue(3);
+  queue.init();
+
+  td::vector<td::thread> writers;
+  for (int writer_id = 0; writer_id < WRITER_COUNT; writer_id++) {
+    writers.emplace_back([&queue, writer_id] {
+      for (int i = 0; i < VALUE_COUNT; i++) {
+        queue.writer_put({writer_id, i});
+      }
+    });
+  }
+
+  td::vector<int> next_values(WRITER_COUNT, 0);
+  int received_count = 0;
+  while (received_count < WRITER_COUNT * VALUE_COUNT) {
+    auto ready_count = queue.reader_wait_nonblock();
+    if (ready_count == 0) {
+      queue.reader_get_event_fd().wait(1000);
+      continue;
+    }
+    for (int i = 0; i < ready_count; i++) {
+      auto value = queue.reader_get_unsafe();
+      ASSERT_EQ(next_values[value.first], value.second);
+      next_values[value.first]++;
+    }
+    received_count += ready_count;
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  ASSERT_EQ(0, queue.reader_wait_nonblock());
+  queue.destroy();
+}
+#endif
@@ -93,3 +93,37 @@ TEST(WaitFreeHashMap, stress_test) {
     }
   }
 }
+
+TEST(WaitFreeHashMap, small_maps) {
+  td::Random::Xorshift128plus rnd(123);
+  for (int test = 0; test < 1000; test++) {
+    td::FlatHashMap<td::uint64, td::uint64> reference;
+    td::WaitFreeHashMap<td::uint64, td::uint64> map;
+    for (int i = 0; i < 100; i++) {
+      auto key = rnd() % 12 + 1;
+      switch (rnd() % 4) {
+        case 0:
+          reference[key] = i;
+          map.set(key, i);
+          break;
+        case 1:
+          ASSERT_EQ(reference[key], map[key]);
+          break;
+        case 2:
+          ASSERT_EQ(reference.erase(key), map.erase(key));
+          break;
+        case 3:
+          ASSERT_EQ(reference.count(key), map.count(key));
+          break;
+      }
+      ASSERT_EQ(reference.size(), map.calc_size());
+      ASSERT_EQ(reference.empty(), map.empty());
+      td::uint64 result = 0;
+      for (auto &it : reference) {
+        result += it.first * 101 + it.second;
+      }
+      map.foreach([&](const td::uint64 &key, const td::uint64 &value) { result -= key * 101 + value; });
+      ASSERT_EQ(0u, result);
+    }
+  }
+}
@@ -7,6 +7,9 @@
 #include "td/utils/tests.h"
 
 #include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/find_boundary.h"
+#include "td/utils/port/thread.h"
 #include "td/utils/Random.h"
 
 TEST(Buffer, buffer_builder) {
@@ -54,3 +57,62 @@ TEST(Buffer, buffer_builder) {
     ASSERT_EQ(builder.extract().as_slice(), str);
   }
 }
+
+TEST(Buffer, reuse_memory) {
+  auto start_mem = td::BufferAllocator::get_buffer_mem();
+  td::vector<td::BufferSlice> slices;
+  for (int i = 0; i < 1000; i++) {
+    auto size = static_cast<size_t>(td::Random::fast(0, 100000));
+    td::BufferSlice slice(size);
+    ASSERT_EQ(size, slice.size());
+    slice.as_mutable_slice().fill('a');
+    slices.push_back(std::move(slice));
+    if (td::Random::fast_bool()) {
+      slices.erase(slices.begin() + td::Random::fast(0, static_cast<int>(slices.size()) - 1));
+    }
+  }
+
+  // free the buffers in another thread
+  td::thread thread([slices = std::move(slices)]() mutable { slices.clear(); });
+  thread.join();
+  ASSERT_EQ(start_mem, td::BufferAllocator::get_buffer_mem());
+
+  auto cache_mem = td::BufferAllocator::get_buffer_cache_mem();
+  for (int i = 0; i < 1000; i++) {
+    td::BufferSlice slice(static_cast<size_t>(td::Random::fast(513, 65536)));
+    slice.as_mutable_slice().fill('b');
+  }
+  ASSERT_EQ(start_mem, td::BufferAllocator::get_buffer_mem());
+  ASSERT_TRUE(td::BufferAllocator::get_buffer_cache_mem() <= cache_mem);
+}
+
+TEST(Buffer, find_boundary) {
+  td::Slice boundary("\r\n\r\n");
+  for (int i = 0; i < 10000; i++) {
+    td::string str;
+    auto length = td::Random::fast(0, 40);
+    for (int j = 0; j < length; j++) {
+      str += "\r\nab"[td::Random::fast(0, 3)];
+    }
+
+    // split the string into chunks, so that the boundary can cross chunk borders
+    td::ChainBufferWriter writer;
+    size_t pos = 0;
+    while (pos < str.size()) {
+      auto chunk_size = td::min(static_cast<size_t>(td::Random::fast(1, 6)), str.size() - pos);
+      writer.append(td::BufferSlice(td::Slice(str).substr(pos, chunk_size)));
+      pos += chunk_size;
+    }
+    auto reader = writer.extract_reader();
+    reader.sync_with_writer();
+
+    size_t already_read = 0;
+    auto expected_pos = str.find(boundary.str());
+    if (expected_pos == td::string::npos) {
+      ASSERT_TRUE(!td::find_boundary(reader.clone(), boundary, already_read));
+    } else {
+      ASSERT_TRUE(td::find_boundary(reader.clone(), boundary, already_read));
+      ASSERT_EQ(expected_pos, already_read);
+    }
+  }
+}
@@ -160,6 +160,68 @@ TEST(Crypto, AesIgeState) {
   }
 }
 
+TEST(Crypto, AesIgeDecryptMulti) {
+  for (int query_count : {0, 1, 2, 7, 8, 9, 30}) {
+    td::vector<td::string> keys;
+    td::vector<td::string> ivs;
+    td::vector<td::string> expected_ivs;
+    td::vector<td::string> encrypted;
+    td::vector<td::string> expected;
+    for (int i = 0; i < query_count; i++) {
+      keys.push_back(td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(), 32));
+      ivs.push_back(td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(), 32));
+      auto length = 16 * td::Random::fast(0, 100);
+      encrypted.push_back(td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(), length));
+      expected_ivs.push_back(ivs.back());
+      expected.push_back(td::string(length, '\0'));
+      td::aes_ige_decrypt(keys.back(), expected_ivs.back(), encrypted.back(), expected.back());
+    }
+
+    td::vector<td::string> decrypted(encrypted.size());
+    td::vector<td::AesIgeDecryptionQuery> queries;
+    for (int i = 0; i < query_count; i++) {
+      // decrypt odd messages in place
+      if (i % 2 == 0) {
+        decrypted[i] = td::string(encrypted[i].size(), '\0');
+      } else {
+        decrypted[i] = encrypted[i];
+      }
+      queries.push_back({keys[i], ivs[i], i % 2 == 0 ? td::Slice(encrypted[i]) : td::Slice(decrypted[i]), decrypted[i]});
+    }
+    td::aes_ige_decrypt_multi(queries);
+    for (int i = 0; i < query_count; i++) {
+      ASSERT_STREQ(td::base64_encode(expected[i]), td::base64_encode(decrypted[i]));
+      ASSERT_STREQ(td::base64_encode(expected_ivs[i]), td::base64_encode(ivs[i]));
+    }
+  }
+}
+
+TEST(Crypto, AesIgeDecryptSha256) {
+  for (int length : {0, 16, 1 << 14, (1 << 14) + 16, 1 << 16, 100000 * 16}) {
+    auto key = td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(), 32);
+    auto iv = td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(), 32);
+    auto prefix = td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(), 32);
+    auto encrypted = td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(), length);
+
+    auto expected_iv = iv;
+    td::string expected(length, '\0');
+    td::aes_ige_decrypt(key, expected_iv, encrypted, expected);
+    td::string expected_hash(32, '\0');
+    td::sha256(prefix + expected, expected_hash);
+
+    td::string decrypted = encrypted;
+    td::Sha256State state;
+    state.init();
+    state.feed(prefix);
+    td::aes_ige_decrypt_sha256(key, iv, decrypted, decrypted, state);
+    td::string hash(32, '\0');
+    state.extract(hash);
+    ASSERT_STREQ(td::base64_encode(expected), td::base64_encode(decrypted));
+    ASSERT_STREQ(td::base64_encode(expected_iv), td::base64_encode(iv));
+    ASSERT_STREQ(td::base64_encode(expected_hash), td::base64_encode(hash));
+  }
+}
+
 TEST(Crypto, AesCbcState) {
   td::vector<td::uint32> answers1{0u, 3617355989u, 3449188102u, 186999968u, 4244808847u, 2626031206u};
 
@@ -46,6 +46,15 @@ TEST(Emoji, is_emoji) {
   ASSERT_TRUE(!td::is_emoji("👩‍a‍👨"));
   ASSERT_TRUE(!td::is_emoji("👩‍🤝‍a"));
   ASSERT_TRUE(td::is_emoji("👩‍🤝‍👨"));  // not in RGI emoji ZWJ sequence set
+  ASSERT_TRUE(!td::is_emoji("a"));
+  ASSERT_TRUE(!td::is_emoji("2"));
+  ASSERT_TRUE(!td::is_emoji("22"));
+  ASSERT_TRUE(!td::is_emoji("©a"));
+  ASSERT_TRUE(!td::is_emoji("〰a"));
+  ASSERT_TRUE(td::is_emoji("〰"));
+  ASSERT_TRUE(td::is_emoji("㊙"));
+  ASSERT_TRUE(td::is_emoji("#️⃣"));
+  ASSERT_TRUE(td::is_emoji("*⃣"));
 }
 
 static void test_get_fitzpatrick_modifier(td::string emoji, int result) {
@@ -5,6 +5,7 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 #include "td/utils/algorithm.h"
+#include "td/utils/benchmark.h"
 #include "td/utils/buffer.h"
 #include "td/utils/ByteFlow.h"
 #include "td/utils/common.h"
@@ -13,6 +14,7 @@
 #include "td/utils/logging.h"
 #include "td/utils/port/thread_local.h"
 #include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
 #include "td/utils/tests.h"
 #include "td/utils/Time.h"
@@ -45,6 +47,47 @@ TEST(Gzip, gzencode) {
   }
 }
 
+TEST(Gzip, gzencode_level) {
+  auto s = td::rand_string('a', 'd', 100000);
+  for (int level = 1; level <= 9; level++) {
+    auto r = td::gzencode(s, 0.5, level);
+    ASSERT_TRUE(!r.empty());
+    ASSERT_EQ(s, td::gzdecode(r.as_slice()));
+  }
+}
+
+class GzipBenchmark final : public td::Benchmark {
+  td::string str_;
+  td::BufferSlice encoded_str_;
+
+ public:
+  explicit GzipBenchmark(size_t size) {
+    for (size_t i = 0; str_.size() < size; i++) {
+      str_ += PSTRING() << "{\"id\":" << i << ",\"text\":\"" << td::rand_string('a', 'e', 10) << "\"}";
+    }
+    encoded_str_ = td::gzencode(str_, 2);
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "gzencode and gzdecode of " << str_.size() << " bytes";
+  }
+
+  void run(int n) final {
+    size_t size = 0;
+    for (int i = 0; i < n; i++) {
+      size += td::gzencode(str_, 2).size();
+      size += td::gzdecode(encoded_str_.as_slice()).size();
+    }
+    td::do_not_optimize_away(size);
+  }
+};
+
+TEST(Gzip, bench) {
+  td::bench(GzipBenchmark(100));
+  td::bench(GzipBenchmark(1000));
+  td::bench(GzipBenchmark(100000));
+}
+
 TEST(Gzip, flow) {
   auto str = td::rand_string('a', 'z', 1000000);
   auto parts = td::rand_split(str);
@@ -249,6 +249,89 @@ TEST(JSON, bench_json_string_decode) {
   td::bench(JsonStringDecodeBenchmark(str));
 }
 
+class JsonStringEncodeBenchmark final : public td::Benchmark {
+  td::string str_;
+
+ public:
+  explicit JsonStringEncodeBenchmark(td::string str) : str_(std::move(str)) {
+  }
+
+  td::string get_description() const final {
+    return td::string("JsonStringEncodeBenchmark") + str_.substr(0, 6);
+  }
+
+  void run(int n) final {
+    std::size_t length = 0;
+    for (int i = 0; i < n; i++) {
+      length += td::json_encode<td::string>(td::JsonString(str_)).size();
+    }
+    td::do_not_optimize_away(length);
+  }
+};
+
+TEST(JSON, bench_json_string_encode) {
+  td::bench(JsonStringEncodeBenchmark(td::string(1000, 'a')));
+  td::bench(JsonStringEncodeBenchmark(td::string(1000, '"')));
+  td::string str;
+  for (int i = 0; i < 100; i++) {
+    str += "Hello, world! \xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82!\n";
+  }
+  td::bench(JsonStringEncodeBenchmark(str));
+}
+
+TEST(JSON, string_encode) {
+  auto encode = [](td::Slice str) {
+    return td::json_encode<td::string>(td::JsonString(str));
+  };
+  auto encode_raw = [](td::Slice str) {
+    return td::json_encode<td::string>(td::JsonRawString(str));
+  };
+  ASSERT_EQ("\"\"", encode(""));
+  ASSERT_EQ("\"abacaba\"", encode("abacaba"));
+  ASSERT_EQ("\"0123456789abcdef0123456789abcdef\"", encode("0123456789abcdef0123456789abcdef"));
+  ASSERT_EQ("\"0123456789abcd\\\"ef\\\\01\\n23\\u001f\"", encode("0123456789abcd\"ef\\01\n23\x1f"));
+  ASSERT_EQ("\"01234567\\u0442\"", encode("01234567\xD1\x82"));
+  ASSERT_EQ("\"01234567\xD1\x82\\t 0123456789\"", encode_raw("01234567\xD1\x82\t 0123456789"));
+
+  for (int i = 0; i < 128; i++) {
+    td::string str(20, 'a');
+    str[i % 20] = static_cast<char>(i);
+    decode_encode(encode(str));
+  }
+
+  auto jo = td::json_encode<td::string>(td::json_object([](auto &o) {
+    o(td::JsonRaw("\"@type\""), td::JsonRaw("\"test\""));
+    o("key", "value");
+  }));
+  ASSERT_EQ("{\"@type\":\"test\",\"key\":\"value\"}", jo);
+}
+
+class JsonDecodeBenchmark final : public td::Benchmark {
+ public:
+  td::string get_description() const final {
+    return "JsonDecodeBenchmark";
+  }
+
+  void run(int n) final {
+    const td::string request =
+        "{\"@type\":\"sendMessage\",\"chat_id\":123456789,\"message_thread_id\":0,\"input_message_content\":{"
+        "\"@type\":\"inputMessageText\",\"text\":{\"@type\":\"formattedText\",\"text\":\"Hello, world!\","
+        "\"entities\":[{\"@type\":\"textEntity\",\"offset\":0,\"length\":5,\"type\":{\"@type\":"
+        "\"textEntityTypeBold\"}},{\"@type\":\"textEntity\",\"offset\":7,\"length\":5,\"type\":{\"@type\":"
+        "\"textEntityTypeItalic\"}}]},\"clear_draft\":true},\"@extra\":42}";
+    std::size_t field_count = 0;
+    for (int i = 0; i < n; i++) {
+      auto str = request;
+      field_count += td::json_decode(str).move_as_ok().get_object().field_count();
+    }
+    td::do_not_optimize_away(field_count);
+  }
+};
+
+TEST(JSON, bench_json_decode) {
+  td::bench(JsonDecodeBenchmark());
+}
+
 static void test_string_decode(td::string str, const td::string &result) {
   auto str_copy = str;
   td::Parser skip_parser(str_copy);
@@ -8,9 +8,11 @@
 #include "td/utils/benchmark.h"
 #include "td/utils/CombinedLog.h"
 #include "td/utils/FileLog.h"
+#include "td/utils/filesystem.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/MemoryLog.h"
+#include "td/utils/misc.h"
 #include "td/utils/NullLog.h"
 #include "td/utils/port/path.h"
 #include "td/utils/port/thread.h"
@@ -184,4 +186,46 @@ TEST(Log, Bench) {
   });
 #endif
 }
+
+#if !TD_EVENTFD_UNSUPPORTED
+TEST(Log, AsyncFileLog) {
+  static constexpr int THREAD_COUNT = 4;
+  static constexpr int LINE_COUNT = 20000;
+  td::string path = "tmplog_async";
+  td::unlink(path).ignore();
+  {
+    td::AsyncFileLog log;
+    log.init(path, std::numeric_limits<td::int64>::max(), false).ensure();
+    td::vector<td::thread> threads;
+    for (int i = 0; i < THREAD_COUNT; i++) {
+      threads.emplace_back([&log, i] {
+        for (int j = 0; j < LINE_COUNT; j++) {
+          // some lines are too long to be passed through the thread buffer
+          td::string padding(j % 1000 == 0 ? 100000 : j % 100, 'a');
+          log.append(VERBOSITY_NAME(DEBUG), PSLICE() << i << ' ' << j << ' ' << padding << '\n');
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  auto content = td::read_file_str(path).move_as_ok();
+  auto lines = td::full_split(td::Slice(content), '\n');
+  ASSERT_EQ(THREAD_COUNT * LINE_COUNT + 1, static_cast<int>(lines.size()));
+  ASSERT_TRUE(lines.back().empty());
+  lines.pop_back();
+  td::vector<int> next_line(THREAD_COUNT);
+  for (auto &line : lines) {
+    auto parts = td::full_split(line, ' ');
+    ASSERT_EQ(3u, parts.size());
+    auto thread_id = td::to_integer<int>(parts[0]);
+    auto line_id = td::to_integer<int>(parts[1]);
+    ASSERT_EQ(next_line[thread_id], line_id);
+    next_line[thread_id]++;
+  }
+  td::unlink(path).ignore();
+}
+#endif
 #endif
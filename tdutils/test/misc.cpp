@@ -33,6 +33,7 @@
 #include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/SmallObjectAllocator.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/tests.h"
@@ -727,6 +728,21 @@ TEST(Misc, unicode) {
   test_unicode(td::remove_diacritics);
 }
 
+TEST(Misc, Utf8Utf16SubstrFinder) {
+  td::string text = "a\xd0\x91\xf0\x9f\x98\x80" "bc\xe2\x82\xac";
+  td::Utf8Utf16SubstrFinder finder(text);
+  for (size_t offset = 0; offset <= 7; offset++) {
+    if (offset == 3) {
+      continue;  // the middle of a surrogate pair
+    }
+    for (size_t length = 0; length <= 7 - offset; length++) {
+      ASSERT_EQ(td::utf8_utf16_substr(text, offset, length), finder.substr(offset, length));
+    }
+  }
+  ASSERT_EQ("a", finder.substr(0, 1));
+  ASSERT_EQ("\xe2\x82\xac", finder.substr(6, 5));
+}
+
 TEST(Misc, get_unicode_simple_category) {
   td::uint32 result = 0;
   for (size_t t = 0; t < 100; t++) {
@@ -1391,3 +1407,40 @@ TEST(UniqueValuePtr, Basic) {
   ASSERT_TRUE(c == d);
   ASSERT_TRUE(6 == **d);
 }
+
+TEST(Misc, SmallObjectAllocator) {
+  td::vector<std::pair<td::uint8 *, size_t>> blocks;
+  for (int i = 0; i < 10000; i++) {
+    if (!blocks.empty() && td::Random::fast_bool()) {
+      auto pos = td::Random::fast(0, static_cast<int>(blocks.size()) - 1);
+      std::swap(blocks[pos], blocks.back());
+      auto block = blocks.back();
+      blocks.pop_back();
+      for (size_t j = 0; j < block.second; j++) {
+        ASSERT_EQ(static_cast<td::uint8>(block.second + j), block.first[j]);
+      }
+      td::SmallObjectAllocator::deallocate(block.first, block.second);
+    } else {
+      auto size = static_cast<size_t>(td::Random::fast(1, static_cast<int>(td::SmallObjectAllocator::MAX_SIZE) + 100));
+      auto ptr = static_cast<td::uint8 *>(td::SmallObjectAllocator::allocate(size));
+      for (size_t j = 0; j < size; j++) {
+        ptr[j] = static_cast<td::uint8>(size + j);
+      }
+      blocks.emplace_back(ptr, size);
+    }
+  }
+
+#if !TD_THREAD_UNSUPPORTED
+  // memory can be freed by another thread
+  td::thread thread([&blocks] {
+    for (auto &block : blocks) {
+      td::SmallObjectAllocator::deallocate(block.first, block.second);
+    }
+  });
+  thread.join();
+#else
+  for (auto &block : blocks) {
+    td::SmallObjectAllocator::deallocate(block.first, block.second);
+  }
+#endif
+}
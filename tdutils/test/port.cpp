@@ -124,6 +124,47 @@ TEST(Port, SparseFiles) {
   td::unlink(path).ensure();
 }
 
+TEST(Port, Preallocate) {
+  td::CSlice path = "preallocated.txt";
+  td::unlink(path).ignore();
+  auto fd = td::FileFd::open(path, td::FileFd::Write | td::FileFd::Read | td::FileFd::CreateNew).move_as_ok();
+  td::int64 size = 1 << 20;
+  auto status = fd.preallocate(size);
+  if (status.is_error()) {
+    LOG(ERROR) << "File system doesn't support preallocation: " << status;
+  } else {
+    ASSERT_TRUE(fd.get_real_size().move_as_ok() >= size);
+  }
+  ASSERT_EQ(0, fd.get_size().move_as_ok());
+  ASSERT_EQ(4u, fd.pwrite("abcd", size - 4).move_as_ok());
+  ASSERT_EQ(size, fd.get_size().move_as_ok());
+  fd.close();
+  td::unlink(path).ensure();
+}
+
+TEST(Port, Link) {
+  td::CSlice path = "link_source.txt";
+  td::CSlice link_path = "link_target.txt";
+  td::unlink(path).ignore();
+  td::unlink(link_path).ignore();
+  auto fd = td::FileFd::open(path, td::FileFd::Write | td::FileFd::CreateNew).move_as_ok();
+  ASSERT_EQ(4u, fd.write("abcd").move_as_ok());
+  fd.close();
+  auto status = td::link(path, link_path);
+  if (status.is_error()) {
+    LOG(ERROR) << "File system doesn't support hard links: " << status;
+    td::unlink(path).ensure();
+    return;
+  }
+  ASSERT_EQ(2, td::stat(path).move_as_ok().link_count_);
+  ASSERT_TRUE(td::link(path, link_path).is_error());
+  td::unlink(path).ensure();
+  auto link_stat = td::stat(link_path).move_as_ok();
+  ASSERT_EQ(1, link_stat.link_count_);
+  ASSERT_EQ(4, link_stat.size_);
+  td::unlink(link_path).ensure();
+}
+
 TEST(Port, LargeFiles) {
   td::CSlice path = "large.txt";
   td::unlink(path).ignore();
@@ -9,24 +9,30 @@
 #include "td/db/binlog/BinlogHelper.h"
 #include "td/db/binlog/ConcurrentBinlog.h"
 #include "td/db/BinlogKeyValue.h"
+#include "td/db/BlobCompression.h"
 #include "td/db/DbKey.h"
 #include "td/db/SeqKeyValue.h"
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteKeyValue.h"
+#include "td/db/SqliteKeyValueAsync.h"
 #include "td/db/SqliteKeyValueSafe.h"
+#include "td/db/SqliteStatement.h"
+#include "td/db/SqliteStatementStats.h"
 #include "td/db/TsSeqKeyValue.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
 
 #include "td/utils/base64.h"
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
 #include "td/utils/filesystem.h"
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/FileFd.h"
 #include "td/utils/port/thread.h"
+#include "td/utils/Promise.h"
 #include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
@@ -66,6 +72,30 @@ TEST(DB, binlog_encryption_bug) {
   td::Binlog::destroy(binlog_name).ignore();
 }
 
+TEST(DB, binlog_crc32c) {
+  td::CSlice binlog_name = "test_binlog";
+  td::Binlog::destroy(binlog_name).ignore();
+
+  {
+    td::Binlog binlog;
+    binlog.init(binlog_name.str(), [](const td::BinlogEvent &x) {}).ensure();
+    binlog.add_raw_event(td::BinlogEvent::create_raw(binlog.next_event_id(), 1, 0, td::create_storer("AAAA")),
+                         td::BinlogDebugInfo{__FILE__, __LINE__});
+    td::BinlogEvent::set_use_crc32c(true);
+    binlog.add_raw_event(td::BinlogEvent::create_raw(binlog.next_event_id(), 1, 0, td::create_storer("BBBB")),
+                         td::BinlogDebugInfo{__FILE__, __LINE__});
+    td::BinlogEvent::set_use_crc32c(false);
+    binlog.close().ensure();
+  }
+  {
+    td::vector<td::string> v;
+    td::Binlog binlog;
+    binlog.init(binlog_name.str(), [&](const td::BinlogEvent &x) { v.push_back(x.get_data().str()); }).ensure();
+    CHECK(v == td::vector<td::string>({"AAAA", "BBBB"}));
+  }
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
 TEST(DB, binlog_encryption) {
   td::CSlice binlog_name = "test_binlog";
   td::Binlog::destroy(binlog_name).ignore();
@@ -138,6 +168,98 @@ TEST(DB, binlog_encryption) {
   td::Binlog::destroy(binlog_name).ignore();
 }
 
+TEST(DB, binlog_idle_reindex) {
+  td::CSlice binlog_name = "test_binlog";
+  td::Binlog::destroy(binlog_name).ignore();
+
+  auto data = td::string(4000, 'A');
+  td::vector<td::uint64> event_ids;
+  {
+    td::Binlog binlog;
+    binlog.init(binlog_name.str(), [](const td::BinlogEvent &x) {}).ensure();
+    for (int i = 0; i < 400; i++) {
+      event_ids.push_back(binlog.add(1, td::create_storer(data)));
+    }
+    ASSERT_TRUE(!binlog.need_idle_reindex());
+    for (int i = 0; i < 150; i++) {
+      binlog.erase(event_ids[i]);
+    }
+    ASSERT_TRUE(binlog.need_idle_reindex());
+    auto old_size = td::FileFd::open(binlog_name, td::FileFd::Flags::Read).move_as_ok().get_size().move_as_ok();
+    binlog.reindex();
+    ASSERT_TRUE(!binlog.need_idle_reindex());
+    auto new_size = td::FileFd::open(binlog_name, td::FileFd::Flags::Read).move_as_ok().get_size().move_as_ok();
+    ASSERT_TRUE(new_size * 3 < old_size * 2);
+    binlog.close().ensure();
+  }
+  {
+    size_t event_count = 0;
+    td::Binlog binlog;
+    binlog
+        .init(
+            binlog_name.str(), [&](const td::BinlogEvent &x) {
+              ASSERT_EQ(data, x.get_data().str());
+              event_count++;
+            })
+        .ensure();
+    ASSERT_EQ(250u, event_count);
+  }
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
+TEST(DB, concurrent_binlog_group_sync) {
+  td::CSlice binlog_name = "test_binlog";
+  td::Binlog::destroy(binlog_name).ignore();
+
+  class Main final : public td::Actor {
+   public:
+    explicit Main(td::string path) : path_(std::move(path)) {
+    }
+
+    void start_up() final {
+      td::ConcurrentBinlog::set_force_sync_delay(0.05);
+      old_statistics_ = td::ConcurrentBinlog::get_sync_statistics();
+      binlog_.init(path_, [](const td::BinlogEvent &) {}).ensure();
+      for (int i = 0; i < SYNC_COUNT; i++) {
+        binlog_.add(1, td::create_storer(td::string(100, 'A')));
+        binlog_.force_sync(td::PromiseCreator::lambda([actor_id = actor_id(this)](td::Unit) {
+                             send_closure(actor_id, &Main::on_synced);
+                           }),
+                           "test");
+      }
+    }
+
+    void on_synced() {
+      if (++synced_count_ != SYNC_COUNT) {
+        return;
+      }
+      auto statistics = td::ConcurrentBinlog::get_sync_statistics();
+      ASSERT_EQ(old_statistics_.synced_promise_count + SYNC_COUNT, statistics.synced_promise_count);
+      ASSERT_TRUE(statistics.sync_count < old_statistics_.sync_count + SYNC_COUNT);
+      td::ConcurrentBinlog::set_force_sync_delay(0.003);
+      binlog_.close(td::PromiseCreator::lambda([](td::Unit) { td::Scheduler::instance()->finish(); }));
+      stop();
+    }
+
+   private:
+    const int SYNC_COUNT = 10;
+
+    td::string path_;
+    td::ConcurrentBinlog binlog_;
+    td::ConcurrentBinlog::SyncStatistics old_statistics_;
+    int synced_count_ = 0;
+  };
+
+  td::ConcurrentScheduler sched(1, 0);
+  sched.create_actor_unsafe<Main>(0, "Main", binlog_name.str()).release();
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
 TEST(DB, sqlite_lfs) {
   td::string path = "test_sqlite_db";
   td::SqliteDb::destroy(path).ignore();
@@ -411,6 +533,121 @@ class BaselineKV {
   SeqNo current_tid_ = 0;
 };
 
+TEST(DB, sqlite_parameters) {
+  td::CSlice sqlite_db_name = "test_sqlite_parameters";
+  td::SqliteDb::destroy(sqlite_db_name).ignore();
+
+  td::SqliteDb::Parameters parameters;
+  parameters.mmap_size = 1 << 20;
+  parameters.cache_size = 2048;
+  parameters.page_size = 8192;
+  parameters.use_memory_temp_store = true;
+
+  auto get_pragma = [](td::SqliteDb &db, td::Slice name) {
+    auto stmt = db.get_statement(PSLICE() << "PRAGMA " << name).move_as_ok();
+    stmt.step().ensure();
+    CHECK(stmt.has_row());
+    return stmt.view_int64(0);
+  };
+
+  for (auto key : {td::DbKey::empty(), td::DbKey::password("key")}) {
+    auto db = td::SqliteDb::change_key(sqlite_db_name, true, key, td::DbKey::empty()).move_as_ok();
+    db.apply_parameters(parameters).ensure();
+    db.exec("PRAGMA journal_mode=WAL").ensure();
+    db.exec("CREATE TABLE t (k INT8 PRIMARY KEY)").ensure();
+    ASSERT_EQ(-2048, get_pragma(db, "cache_size"));
+    ASSERT_EQ(2, get_pragma(db, "temp_store"));
+    if (key.is_empty()) {
+      ASSERT_EQ(8192, get_pragma(db, "page_size"));
+      ASSERT_EQ(1 << 20, get_pragma(db, "mmap_size"));
+    } else {
+      ASSERT_EQ(0, get_pragma(db, "mmap_size"));
+    }
+    db.close();
+    td::SqliteDb::destroy(sqlite_db_name).ignore();
+  }
+}
+
+TEST(DB, sqlite_statement_cache) {
+  td::CSlice sqlite_db_name = "test_sqlite_statements";
+  td::SqliteDb::destroy(sqlite_db_name).ignore();
+  auto db = td::SqliteDb::open_with_key(sqlite_db_name, true, td::DbKey::empty()).move_as_ok();
+  db.exec("CREATE TABLE t (k INT8 PRIMARY KEY, v BLOB)").ensure();
+
+  td::SqliteStatementStats::set_enabled(true);
+  td::CSlice insert_query = "INSERT INTO t VALUES(?1, ?2)";
+  td::CSlice select_query = "SELECT v FROM t WHERE v IS NOT NULL";
+  for (int i = 0; i < 10; i++) {
+    auto stmt = db.get_statement(insert_query).move_as_ok();
+    stmt.bind_int64(1, i).ensure();
+    if (i % 2 == 0) {
+      td::string value(static_cast<size_t>(i + 1), 'a');
+      stmt.bind_blob(2, value).ensure();
+    }
+    stmt.step().ensure();
+  }
+  for (int i = 0; i < 2; i++) {
+    // a cached statement must not keep bindings and state of the previous user
+    auto stmt = db.get_statement(select_query).move_as_ok();
+    size_t row_count = 0;
+    for (stmt.step().ensure(); stmt.has_row(); stmt.step().ensure()) {
+      ASSERT_EQ(row_count * 2 + 1, stmt.view_blob(0).size());
+      row_count++;
+    }
+    ASSERT_EQ(5u, row_count);
+  }
+  td::SqliteStatementStats::set_enabled(false);
+
+  size_t found_count = 0;
+  for (auto &statistics : td::SqliteStatementStats::get_statistics(true)) {
+    if (statistics.query == insert_query) {
+      ASSERT_EQ(10u, statistics.execution_count);
+      ASSERT_EQ(0u, statistics.row_count);
+      found_count++;
+    } else if (statistics.query == select_query) {
+      ASSERT_EQ(2u, statistics.execution_count);
+      ASSERT_EQ(10u, statistics.row_count);
+      ASSERT_TRUE(statistics.full_scan_step_count > 0);
+      found_count++;
+    }
+  }
+  ASSERT_EQ(2u, found_count);
+  ASSERT_TRUE(td::SqliteStatementStats::get_statistics(false).empty());
+
+  db.close();
+  td::SqliteDb::destroy(sqlite_db_name).ignore();
+}
+
+TEST(DB, blob_compression) {
+  td::string small_data(100, 'a');
+  ASSERT_TRUE(td::compress_blob(small_data).empty());
+  ASSERT_EQ(small_data, td::decompress_blob(small_data).as_slice());
+
+  auto random_data = td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(), 1000);
+  ASSERT_TRUE(td::compress_blob(random_data).empty());
+
+  td::string data;
+  for (int i = 0; i < 100; i++) {
+    data += PSTRING() << "message text " << i << ' ';
+  }
+  // serialized objects start with non-negative version or flags
+  data[0] = '\x05';
+  data[3] = '\0';
+  ASSERT_TRUE(!td::is_compressed_blob(data));
+  auto compressed = td::compress_blob(data);
+  ASSERT_TRUE(!compressed.empty());
+  ASSERT_TRUE(compressed.size() < data.size() / 2);
+  ASSERT_TRUE(td::is_compressed_blob(compressed.as_slice()));
+  ASSERT_EQ(data, td::decompress_blob(compressed.as_slice()).as_slice());
+
+  auto truncated = compressed.as_slice().substr(0, compressed.size() - 10);
+  ASSERT_TRUE(td::decompress_blob(truncated).empty());
+
+  td::string unknown_codec = compressed.as_slice().str();
+  unknown_codec[0] = '\x7f';
+  ASSERT_TRUE(td::decompress_blob(unknown_codec).empty());
+}
+
 TEST(DB, key_value) {
   td::vector<td::string> keys;
   td::vector<td::string> values;
@@ -524,6 +761,106 @@ TEST(DB, key_value_set_all) {
   td::SqliteDb::destroy(sqlite_kv_name).ignore();
 }
 
+TEST(DB, sqlite_key_value_get_by_prefix) {
+  td::CSlice sqlite_kv_name = "test_sqlite_kv";
+  td::SqliteDb::destroy(sqlite_kv_name).ignore();
+  auto db = td::SqliteDb::open_with_key(sqlite_kv_name, true, td::DbKey::empty()).move_as_ok();
+  td::SqliteKeyValue sqlite_kv;
+  sqlite_kv.init_with_connection(std::move(db), "KV").ensure();
+
+  td::string max_prefix(2, '\xff');
+  sqlite_kv.set("a", "1");
+  sqlite_kv.set("ab", "2");
+  sqlite_kv.set("b", "3");
+  sqlite_kv.set(max_prefix + "c", "4");
+
+  auto get_by_prefix = [&](td::Slice prefix) {
+    td::string result;
+    sqlite_kv.get_by_prefix(prefix, [&](td::Slice key, td::Slice value) {
+      result += PSTRING() << key << '=' << value << ';';
+      return true;
+    });
+    return result;
+  };
+  ASSERT_EQ("=1;b=2;", get_by_prefix("a"));
+  ASSERT_EQ("c=4;", get_by_prefix(max_prefix));
+
+  size_t count = 0;
+  sqlite_kv.get_all([&](td::Slice key, td::Slice value) {
+    ASSERT_EQ(sqlite_kv.get(key), value);
+    return ++count < 3;
+  });
+  ASSERT_EQ(3u, count);
+  ASSERT_EQ(4u, sqlite_kv.get_all().size());
+
+  sqlite_kv.close();
+  td::SqliteDb::destroy(sqlite_kv_name).ignore();
+}
+
+TEST(DB, sqlite_key_value_async_batching) {
+  td::CSlice sqlite_kv_name = "test_sqlite_kv";
+  td::SqliteDb::destroy(sqlite_kv_name).ignore();
+
+  class Main final : public td::Actor {
+   public:
+    explicit Main(td::string path) : path_(std::move(path)) {
+    }
+
+    void start_up() final {
+      td::SqliteDb::open_with_key(path_, true, td::DbKey::empty()).ensure();
+      auto sql_connection = std::make_shared<td::SqliteConnectionSafe>(path_, td::DbKey::empty());
+      auto kv_safe = std::make_shared<td::SqliteKeyValueSafe>("kv", sql_connection);
+      td::SqliteKeyValueAsyncInterface::Parameters parameters;
+      parameters.max_flush_delay = 100;
+      parameters.max_pending_query_count = 1000;
+      parameters.max_transaction_size = 2;
+      kv_async_ = td::create_sqlite_key_value_async(std::move(kv_safe), 0, parameters);
+
+      for (int i = 0; i < 5; i++) {
+        kv_async_->set("a", td::to_string(i), td::Promise<td::Unit>());
+      }
+      kv_async_->set("b", "b", td::Promise<td::Unit>());
+      kv_async_->set("c", "c", td::Promise<td::Unit>());
+      kv_async_->erase("d", td::Promise<td::Unit>());
+      kv_async_->erase("c", td::Promise<td::Unit>());
+      kv_async_->get("a", td::PromiseCreator::lambda([](td::string value) { ASSERT_EQ("4", value); }));
+      kv_async_->get_statistics(
+          td::PromiseCreator::lambda([](td::SqliteKeyValueAsyncInterface::Statistics statistics) {
+            ASSERT_EQ(0u, statistics.flush_count);
+            ASSERT_EQ(5u, statistics.coalesced_query_count);
+          }));
+      // erase_by_prefix forces the buffered queries to be written
+      kv_async_->erase_by_prefix("z", td::Promise<td::Unit>());
+      kv_async_->get_statistics(td::PromiseCreator::lambda(
+          [actor_id = actor_id(this)](td::SqliteKeyValueAsyncInterface::Statistics statistics) {
+            ASSERT_EQ(1u, statistics.flush_count);
+            ASSERT_EQ(2u, statistics.transaction_count);
+            ASSERT_EQ(9u, statistics.query_count);
+            send_closure(actor_id, &Main::on_flushed);
+          }));
+    }
+
+    void on_flushed() {
+      kv_async_->get("c", td::PromiseCreator::lambda([](td::string value) { ASSERT_EQ("", value); }));
+      kv_async_->close(td::PromiseCreator::lambda([](td::Unit) { td::Scheduler::instance()->finish(); }));
+      stop();
+    }
+
+   private:
+    td::string path_;
+    td::unique_ptr<td::SqliteKeyValueAsyncInterface> kv_async_;
+  };
+
+  td::ConcurrentScheduler sched(1, 0);
+  sched.create_actor_unsafe<Main>(0, "Main", sqlite_kv_name.str()).release();
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+  td::SqliteDb::destroy(sqlite_kv_name).ignore();
+}
+
 #if !TD_THREAD_UNSUPPORTED
 TEST(DB, thread_key_value) {
   td::vector<td::string> keys;
@@ -725,6 +725,24 @@ TEST(MessageEntities, url) {
   check_url("_.test.com", {"_.test.com"});
 }
 
+TEST(MessageEntities, find_entities) {
+  const td::vector<td::string> parts = {"a", "Z", "1", "1234", " ", "\n", "@", "/", "#", "$", ":", ".",
+                                        "-", "_", "com", "t.me", "tg://", "\xd0\x91"};
+  for (int i = 0; i < 10000; i++) {
+    td::string text;
+    auto part_count = td::Random::fast(0, 30);
+    for (int j = 0; j < part_count; j++) {
+      text += parts[td::Random::fast(0, static_cast<int>(parts.size()) - 1)];
+    }
+
+    size_t expected_count = td::find_mentions(text).size() + td::find_bot_commands(text).size() +
+                            td::find_hashtags(text).size() + td::find_cashtags(text).size() +
+                            td::find_bank_card_numbers(text).size() + td::find_tg_urls(text).size() +
+                            td::find_urls(text).size() + td::find_media_timestamps(text).size();
+    ASSERT_EQ(expected_count, td::find_entities(text, false, false).size());
+  }
+}
+
 static void check_fix_formatted_text(td::string str, td::vector<td::MessageEntity> entities,
                                      const td::string &expected_str,
                                      const td::vector<td::MessageEntity> &expected_entities, bool allow_empty = true,
@@ -20,6 +20,7 @@
 #include "td/mtproto/RawConnection.h"
 #include "td/mtproto/RSA.h"
 #include "td/mtproto/TlsInit.h"
+#include "td/mtproto/TlsReaderByteFlow.h"
 #include "td/mtproto/TransportType.h"
 
 #include "td/net/GetHostByNameActor.h"
@@ -30,7 +31,9 @@
 #include "td/actor/ConcurrentScheduler.h"
 
 #include "td/utils/base64.h"
+#include "td/utils/buffer.h"
 #include "td/utils/BufferedFd.h"
+#include "td/utils/ByteFlow.h"
 #include "td/utils/common.h"
 #include "td/utils/crypto.h"
 #include "td/utils/HttpDate.h"
@@ -45,6 +48,7 @@
 #include "td/utils/Status.h"
 #include "td/utils/tests.h"
 #include "td/utils/Time.h"
+#include "td/utils/UInt.h"
 
 #include <memory>
 
@@ -671,6 +675,62 @@ TEST(Mtproto, Grease) {
   }
 }
 
+TEST(Mtproto, TlsAesCtrReaderByteFlow) {
+  for (int test_n = 0; test_n < 100; test_n++) {
+    td::string data = td::rand_string('a', 'z', td::Random::fast(0, 100000));
+
+    td::UInt256 key;
+    td::UInt128 iv;
+    td::Random::secure_bytes(key.raw, sizeof(key));
+    td::Random::secure_bytes(iv.raw, sizeof(iv));
+    td::AesCtrState state;
+    state.init(td::as_slice(key), td::as_slice(iv));
+    td::string encrypted_data(data.size(), '\0');
+    state.encrypt(data, encrypted_data);
+
+    td::string stream;
+    td::Slice left_data = encrypted_data;
+    while (!left_data.empty()) {
+      auto record_size = td::min(static_cast<size_t>(td::Random::fast(0, 16384)), left_data.size());
+      stream += "\x17\x03\x03";
+      stream += static_cast<char>(record_size >> 8);
+      stream += static_cast<char>(record_size & 255);
+      stream += left_data.substr(0, record_size).str();
+      left_data.remove_prefix(record_size);
+    }
+
+    td::ChainBufferWriter input_writer;
+    auto input = input_writer.extract_reader();
+    td::ByteFlowSource source(&input);
+    td::mtproto::TlsAesCtrReaderByteFlow reader;
+    reader.init(key, iv);
+    td::ByteFlowSink sink;
+    source >> reader >> sink;
+
+    td::Slice left_stream = stream;
+    while (!left_stream.empty()) {
+      auto part_size = td::min(static_cast<size_t>(td::Random::fast(1, 10000)), left_stream.size());
+      input_writer.append(left_stream.substr(0, part_size));
+      left_stream.remove_prefix(part_size);
+      source.wakeup();
+    }
+    ASSERT_TRUE(!sink.is_ready());
+    ASSERT_EQ(data, sink.get_output()->move_as_buffer_slice().as_slice());
+  }
+
+  td::ChainBufferWriter input_writer;
+  auto input = input_writer.extract_reader();
+  td::ByteFlowSource source(&input);
+  td::mtproto::TlsAesCtrReaderByteFlow reader;
+  reader.init(td::UInt256(), td::UInt128());
+  td::ByteFlowSink sink;
+  source >> reader >> sink;
+  input_writer.append(td::Slice("\x16\x03\x03\x00\x01\x00"));
+  source.wakeup();
+  ASSERT_TRUE(sink.is_ready());
+  ASSERT_TRUE(sink.status().is_error());
+}
+
 TEST(Mtproto, TlsTransport) {
   int threads_n = 1;
   td::ConcurrentScheduler sched(threads_n, 0);
@@ -0,0 +1,67 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/net/DcId.h"
+#include "td/telegram/net/NetQueryRateLimiter.h"
+
+#include "td/utils/common.h"
+#include "td/utils/tests.h"
+
+TEST(NetQueryRateLimiter, flood_wait) {
+  td::NetQueryRateLimiter rate_limiter;
+  auto key = td::NetQueryRateLimiter::get_key(td::DcId::internal(2), 12345);
+  auto other_key = td::NetQueryRateLimiter::get_key(td::DcId::internal(3), 12345);
+  double now = 1000.0;
+  ASSERT_EQ(0.0, rate_limiter.get_query_delay(key, now, 60.0));
+
+  rate_limiter.on_flood_wait(key, 2, now);
+  ASSERT_EQ(0.0, rate_limiter.get_query_delay(other_key, now, 60.0));
+  ASSERT_EQ(2.0, rate_limiter.get_query_delay(key, now, 1.0));
+  ASSERT_EQ(2.0, rate_limiter.get_query_delay(key, now, 60.0));
+  ASSERT_EQ(4.0, rate_limiter.get_query_delay(key, now, 60.0));
+
+  auto limits = rate_limiter.get_network_rate_limits_object(now);
+  ASSERT_EQ(1u, limits->limits_.size());
+  ASSERT_EQ(2, limits->limits_[0]->dc_id_);
+  ASSERT_EQ(12345, limits->limits_[0]->method_id_);
+  ASSERT_EQ(2, limits->limits_[0]->delayed_query_count_);
+
+  rate_limiter.on_delayed_query_sent(key);
+  rate_limiter.on_delayed_query_sent(key);
+  ASSERT_EQ(0, rate_limiter.get_network_rate_limits_object(now)->limits_[0]->delayed_query_count_);
+
+  // queries are paced and the rate slowly grows while there are no flood waits
+  now += 10.0;
+  double last_send_time = now;
+  int delayed_query_count = 0;
+  for (int i = 0; i < 100; i++) {
+    auto delay = rate_limiter.get_query_delay(key, now, 1000.0);
+    if (delay > 0) {
+      delayed_query_count++;
+    }
+    auto send_time = now + delay;
+    ASSERT_TRUE(send_time >= last_send_time);
+    last_send_time = send_time;
+  }
+  ASSERT_EQ(99, delayed_query_count);
+  ASSERT_EQ(99, rate_limiter.get_network_rate_limits_object(now)->limits_[0]->delayed_query_count_);
+  auto rate = rate_limiter.get_network_rate_limits_object(now)->limits_[0]->rate_;
+  ASSERT_TRUE(rate > 1.0);
+  ASSERT_TRUE(last_send_time - now < 100.0);
+
+  // a new flood wait reduces the rate
+  now = last_send_time;
+  rate_limiter.on_flood_wait(key, 1, now);
+  ASSERT_TRUE(rate_limiter.get_network_rate_limits_object(now)->limits_[0]->rate_ < rate);
+
+  // unused limits are forgotten
+  for (int i = 0; i < delayed_query_count; i++) {
+    rate_limiter.on_delayed_query_sent(key);
+  }
+  now += 10000.0;
+  ASSERT_EQ(0.0, rate_limiter.get_query_delay(key, now, 60.0));
+  ASSERT_TRUE(rate_limiter.get_network_rate_limits_object(now)->limits_.empty());
+}
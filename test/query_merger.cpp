@@ -21,6 +21,13 @@
 #include <queue>
 
 class TestQueryMerger final : public td::Actor {
+ public:
+  explicit TestQueryMerger(double max_delay)
+      : max_delay_(max_delay)
+      , query_merger_("QueryMerger", MAX_CONCURRENT_QUERY_COUNT, MAX_MERGED_QUERY_COUNT, max_delay) {
+  }
+
+ private:
   void start_up() final {
     query_merger_.set_merge_function([this](td::vector<td::int64> query_ids, td::Promise<td::Unit> &&promise) {
       ASSERT_TRUE(!query_ids.empty());
@@ -32,7 +39,7 @@ class TestQueryMerger final : public td::Actor {
       }
       current_query_count_++;
       ASSERT_TRUE(current_query_count_ <= MAX_CONCURRENT_QUERY_COUNT);
-      if (!next_query_ids_.empty()) {
+      if (!next_query_ids_.empty() && max_delay_ == 0.0) {
         ASSERT_EQ(current_query_count_, MAX_CONCURRENT_QUERY_COUNT);
       }
       td::create_actor<td::SleepActor>("CompleteMergeQuery", 0.02,
@@ -79,7 +86,8 @@ class TestQueryMerger final : public td::Actor {
   static constexpr std::size_t MAX_MERGED_QUERY_COUNT = 3;
   static constexpr std::size_t MAX_QUERY_COUNT = 1000;
 
-  td::QueryMerger query_merger_{"QueryMerger", MAX_CONCURRENT_QUERY_COUNT, MAX_MERGED_QUERY_COUNT};
+  double max_delay_;
+  td::QueryMerger query_merger_;
   std::size_t current_query_count_ = 0;
   std::size_t total_query_count_ = 0;
   std::size_t completed_query_count_ = 0;
@@ -92,12 +100,20 @@ constexpr std::size_t TestQueryMerger::MAX_CONCURRENT_QUERY_COUNT;
 constexpr std::size_t TestQueryMerger::MAX_MERGED_QUERY_COUNT;
 constexpr std::size_t TestQueryMerger::MAX_QUERY_COUNT;
 
-TEST(QueryMerger, stress) {
+static void run_query_merger_test(double max_delay) {
   td::ConcurrentScheduler sched(0, 0);
-  sched.create_actor_unsafe<TestQueryMerger>(0, "TestQueryMerger").release();
+  sched.create_actor_unsafe<TestQueryMerger>(0, "TestQueryMerger", max_delay).release();
   sched.start();
   while (sched.run_main(10)) {
     // empty
   }
   sched.finish();
 }
+
+TEST(QueryMerger, stress) {
+  run_query_merger_test(0.0);
+}
+
+TEST(QueryMerger, stress_with_delay) {
+  run_query_merger_test(0.001);
+}
@@ -6,8 +6,11 @@
 //
 #include "td/telegram/misc.h"
 
+#include "td/utils/benchmark.h"
 #include "td/utils/common.h"
+#include "td/utils/logging.h"
 #include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/tests.h"
 
 TEST(StringCleaning, clean_name) {
@@ -71,6 +74,47 @@ TEST(StringCleaning, clean_input_string) {
       "\xe2\x80\x8f",
       true);
   check_clean_input_string("\xcc\xb3\xcc\xbf\xcc\x8a", "", true);
+  check_clean_input_string(
+      "0123456789abcdef\r0123456789\x01"
+      "abcdef\xcc\xb3_0123456789abcdef\x7f\xe2\x80\xa8-0123456789ab",
+      "0123456789abcdef0123456789 abcdef_0123456789abcdef\x7f-0123456789ab", true);
+  check_clean_input_string("\r" + td::string(50000, 'a'), td::string(34996, 'a'), true);
+  check_clean_input_string(td::string(34995, 'a') + "\xd0\x81", td::string(34995, 'a') + "\xd0\x81", true);
+  check_clean_input_string(td::string(34996, 'a') + "\xd0\x81", td::string(34996, 'a'), true);
+}
+
+class CleanInputStringBenchmark final : public td::Benchmark {
+  td::string name_;
+  td::string str_;
+
+ public:
+  CleanInputStringBenchmark(td::string name, td::string str) : name_(std::move(name)), str_(std::move(str)) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "CleanInputStringBenchmark " << name_;
+  }
+
+  void run(int n) final {
+    for (int i = 0; i < n; i++) {
+      auto str = str_;
+      CHECK(td::clean_input_string(str));
+    }
+  }
+};
+
+TEST(StringCleaning, bench_clean_input_string) {
+  td::string text;
+  for (int i = 0; i < 100; i++) {
+    text += "Hello, world! How are you? ";
+  }
+  td::bench(CleanInputStringBenchmark("ASCII", text));
+  td::bench(CleanInputStringBenchmark("ASCII with a removed character", td::string("\r\n") + text));
+  td::string unicode_text;
+  for (int i = 0; i < 100; i++) {
+    unicode_text += "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82, \xd0\xbc\xd0\xb8\xd1\x80!\n";
+  }
+  td::bench(CleanInputStringBenchmark("Cyrillic", unicode_text));
 }
 
 static void check_strip_empty_characters(td::string str, std::size_t max_length, const td::string &expected,
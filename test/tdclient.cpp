@@ -8,6 +8,7 @@
 
 #include "td/telegram/Client.h"
 #include "td/telegram/ClientActor.h"
+#include "td/telegram/files/DownloadWindowController.h"
 #include "td/telegram/files/PartsManager.h"
 #include "td/telegram/td_api.h"
 
@@ -970,6 +971,64 @@ TEST(Client, Manager) {
   }
 }
 
+TEST(Client, ManagerReceiveMany) {
+  td::ClientManager client;
+  int clients_n = 100;
+  for (int i = 0; i < clients_n; i++) {
+    auto id = client.create_client_id();
+    client.send(id, 3, td::make_tl_object<td::td_api::testSquareInt>(3));
+  }
+
+  std::set<td::int32> ids;
+  while (ids.size() != static_cast<size_t>(clients_n)) {
+    auto responses = client.receive_many(16, 10);
+    ASSERT_TRUE(responses.size() <= 16u);
+    for (auto &response : responses) {
+      ASSERT_TRUE(response.object != nullptr);
+      if (response.request_id == 3) {
+        ASSERT_EQ(td::td_api::testInt::ID, response.object->get_id());
+        ASSERT_TRUE(ids.insert(response.client_id).second);
+      }
+    }
+  }
+}
+
+TEST(Client, ManagerSendMany) {
+  td::ClientManager client;
+  auto id = client.create_client_id();
+  int requests_n = 100;
+  td::vector<td::ClientManager::Request> requests;
+  for (int i = 1; i <= requests_n; i++) {
+    td::ClientManager::RequestId request_id = i;
+    requests.push_back({request_id, td::make_tl_object<td::td_api::testSquareInt>(i)});
+  }
+  client.send_many(id, std::move(requests));
+
+  requests.clear();
+  requests.push_back({1, td::make_tl_object<td::td_api::testSquareInt>(1)});
+  client.send_many(-1, std::move(requests));
+
+  std::set<td::ClientManager::RequestId> request_ids;
+  bool have_error = false;
+  while (request_ids.size() != static_cast<size_t>(requests_n) || !have_error) {
+    auto responses = client.receive_many(16, 10);
+    for (auto &response : responses) {
+      if (response.client_id == -1) {
+        ASSERT_EQ(td::td_api::error::ID, response.object->get_id());
+        ASSERT_EQ(400, static_cast<td::td_api::error &>(*response.object).code_);
+        have_error = true;
+        continue;
+      }
+      if (response.request_id != 0) {
+        ASSERT_EQ(td::td_api::testInt::ID, response.object->get_id());
+        auto value = static_cast<td::uint64>(static_cast<td::td_api::testInt &>(*response.object).value_);
+        ASSERT_EQ(response.request_id * response.request_id, value);
+        ASSERT_TRUE(request_ids.insert(response.request_id).second);
+      }
+    }
+  }
+}
+
 #if !TD_EVENTFD_UNSUPPORTED  // Client must be used from a single thread if there is no EventFd
 TEST(Client, Close) {
   std::atomic<bool> stop_send{false};
@@ -1190,3 +1249,28 @@ TEST(PartsManager, hands) {
     pm.init(1, 100000, true, 10, {0, 1, 2}, false, true).ensure_error();
   }
 }
+
+TEST(DownloadWindowController, hands) {
+  size_t part_size = 128 << 10;
+  td::DownloadWindowController controller(td::DcId::internal(2), part_size);
+  auto initial_window = controller.get_window();
+  ASSERT_EQ(static_cast<td::int64>(part_size) * td::DownloadWindowController::INITIAL_WINDOW_PARTS, initial_window);
+  ASSERT_TRUE(controller.can_start_part(0, part_size));
+  ASSERT_TRUE(controller.can_start_part(initial_window - static_cast<td::int64>(part_size), part_size));
+  ASSERT_TRUE(!controller.can_start_part(initial_window, part_size));
+
+  double now = 1.0;
+  controller.on_part_started(now);
+  for (int i = 0; i < 4; i++) {
+    now += 0.1;
+    controller.on_part_ok(part_size, 0.1, now);
+  }
+  ASSERT_EQ(initial_window + 4 * static_cast<td::int64>(part_size), controller.get_window());
+
+  auto window = controller.get_window();
+  now += 1.0;
+  controller.on_part_ok(part_size, 1.0, now);
+  ASSERT_TRUE(controller.get_window() < window);
+  ASSERT_EQ(1, controller.get_stats().decrease_count);
+  ASSERT_EQ(5, controller.get_stats().part_count);
+}
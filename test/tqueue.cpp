@@ -54,6 +54,8 @@ class TestTQueue {
   TestTQueue() {
     baseline_ = td::TQueue::create();
 
+    ring_ = td::TQueue::create(true);
+
     memory_ = td::TQueue::create();
     auto memory_storage = td::make_unique<td::TQueueMemoryStorage>();
     memory_storage_ = memory_storage.get();
@@ -81,6 +83,9 @@ class TestTQueue {
     if (rnd.fast(0, 10) == 0) {
       baseline_->run_gc(now);
     }
+    if (rnd.fast(0, 10) == 0) {
+      ring_->run_gc(now);
+    }
 
     memory_->extract_callback().release();
     auto memory_storage = td::unique_ptr<td::TQueueMemoryStorage>(memory_storage_);
@@ -112,6 +117,8 @@ class TestTQueue {
 
   EventId push(td::TQueue::QueueId queue_id, const td::string &data, td::int32 expires_at, EventId new_id = EventId()) {
     auto a_id = baseline_->push(queue_id, data, expires_at, 0, new_id).move_as_ok();
+    auto r_id = ring_->push(queue_id, data, expires_at, 0, new_id).move_as_ok();
+    ASSERT_EQ(a_id, r_id);
     auto b_id = memory_->push(queue_id, data, expires_at, 0, new_id).move_as_ok();
     auto c_id = binlog_->push(queue_id, data, expires_at, 0, new_id).move_as_ok();
     ASSERT_EQ(a_id, b_id);
@@ -122,6 +129,7 @@ class TestTQueue {
   void check_head_tail(td::TQueue::QueueId qid) {
     //ASSERT_EQ(baseline_->get_head(qid), memory_->get_head(qid));
     //ASSERT_EQ(baseline_->get_head(qid), binlog_->get_head(qid));
+    ASSERT_EQ(baseline_->get_tail(qid), ring_->get_tail(qid));
     ASSERT_EQ(baseline_->get_tail(qid), memory_->get_tail(qid));
     ASSERT_EQ(baseline_->get_tail(qid), binlog_->get_tail(qid));
   }
@@ -133,6 +141,8 @@ class TestTQueue {
     td::MutableSpan<td::TQueue::Event> b_span(b, 10);
     td::TQueue::Event c[10];
     td::MutableSpan<td::TQueue::Event> c_span(c, 10);
+    td::TQueue::Event r[10];
+    td::MutableSpan<td::TQueue::Event> r_span(r, 10);
 
     auto a_from = baseline_->get_head(qid);
     //auto b_from = memory_->get_head(qid);
@@ -145,13 +155,17 @@ class TestTQueue {
       a_from = tmp.move_as_ok();
     }
     baseline_->get(qid, a_from, true, now, a_span).move_as_ok();
+    ring_->get(qid, a_from, true, now, r_span).move_as_ok();
     memory_->get(qid, a_from, true, now, b_span).move_as_ok();
     binlog_->get(qid, a_from, true, now, c_span).move_as_ok();
+    ASSERT_EQ(a_span.size(), r_span.size());
     ASSERT_EQ(a_span.size(), b_span.size());
     ASSERT_EQ(a_span.size(), c_span.size());
     for (size_t i = 0; i < a_span.size(); i++) {
+      ASSERT_EQ(a_span[i].id, r_span[i].id);
       ASSERT_EQ(a_span[i].id, b_span[i].id);
       ASSERT_EQ(a_span[i].id, c_span[i].id);
+      ASSERT_EQ(a_span[i].data, r_span[i].data);
       ASSERT_EQ(a_span[i].data, b_span[i].data);
       ASSERT_EQ(a_span[i].data, c_span[i].data);
     }
@@ -159,6 +173,7 @@ class TestTQueue {
 
  private:
   td::unique_ptr<td::TQueue> baseline_;
+  td::unique_ptr<td::TQueue> ring_;
   td::unique_ptr<td::TQueue> memory_;
   td::unique_ptr<td::TQueue> binlog_;
   td::TQueueMemoryStorage *memory_storage_{nullptr};
@@ -237,24 +252,60 @@ TEST(TQueue, memory_leak) {
 }
 
 TEST(TQueue, clear) {
-  auto tqueue = td::TQueue::create();
+  for (auto use_ring_buffers : {false, true}) {
+    auto tqueue = td::TQueue::create(use_ring_buffers);
 
-  auto start_time = td::Time::now();
-  td::int32 now = 0;
-  td::vector<td::TQueue::EventId> ids;
+    auto start_time = td::Time::now();
+    td::int32 now = 0;
+    td::vector<td::TQueue::EventId> ids;
+    td::Random::Xorshift128plus rnd(123);
+    for (size_t i = 0; i < 100000; i++) {
+      tqueue->push(1, td::string(td::Random::fast(100, 500), 'a'), now + 600000, 0, {}).ensure();
+    }
+    auto tail_id = tqueue->get_tail(1);
+    auto clear_start_time = td::Time::now();
+    size_t keep_count = td::Random::fast(0, 2);
+    auto deleted_events = tqueue->clear(1, keep_count);
+    auto finish_time = td::Time::now();
+    LOG(INFO) << "Added TQueue events in " << clear_start_time - start_time << " seconds and cleared them in "
+              << finish_time - clear_start_time << " seconds";
+    CHECK(tqueue->get_size(1) == keep_count);
+    CHECK(tqueue->get_head(1).advance(keep_count).ok() == tail_id);
+    CHECK(tqueue->get_tail(1) == tail_id);
+    CHECK(deleted_events.size() == 100000 - keep_count);
+  }
+}
+
+TEST(TQueue, ring_forget) {
+  auto baseline = td::TQueue::create();
+  auto ring = td::TQueue::create(true);
   td::Random::Xorshift128plus rnd(123);
-  for (size_t i = 0; i < 100000; i++) {
-    tqueue->push(1, td::string(td::Random::fast(100, 500), 'a'), now + 600000, 0, {}).ensure();
+  td::vector<td::TQueue::EventId> ids;
+  for (int i = 0; i < 100000; i++) {
+    auto id = baseline->push(1, "a", 1000000, 0, {}).move_as_ok();
+    ASSERT_EQ(id, ring->push(1, "a", 1000000, 0, id).move_as_ok());
+    ids.push_back(id);
+    if (rnd.fast(0, 2) != 0) {
+      auto pos = static_cast<size_t>(rnd()) % ids.size();
+      std::swap(ids.back(), ids[pos]);
+      baseline->forget(1, ids.back());
+      ring->forget(1, ids.back());
+      ids.pop_back();
+    }
+    if (i % 1000 == 0 && !ids.empty()) {
+      ASSERT_EQ(baseline->get_size(1), ring->get_size(1));
+      ASSERT_EQ(baseline->get_head(1), ring->get_head(1));
+      td::TQueue::Event a[10];
+      td::MutableSpan<td::TQueue::Event> a_span(a, 10);
+      td::TQueue::Event b[10];
+      td::MutableSpan<td::TQueue::Event> b_span(b, 10);
+      auto from_id = ids[static_cast<size_t>(rnd()) % ids.size()];
+      baseline->get(1, from_id, false, 0, a_span).ensure();
+      ring->get(1, from_id, false, 0, b_span).ensure();
+      ASSERT_EQ(a_span.size(), b_span.size());
+      for (size_t j = 0; j < a_span.size(); j++) {
+        ASSERT_EQ(a_span[j].id, b_span[j].id);
+      }
+    }
   }
-  auto tail_id = tqueue->get_tail(1);
-  auto clear_start_time = td::Time::now();
-  size_t keep_count = td::Random::fast(0, 2);
-  auto deleted_events = tqueue->clear(1, keep_count);
-  auto finish_time = td::Time::now();
-  LOG(INFO) << "Added TQueue events in " << clear_start_time - start_time << " seconds and cleared them in "
-            << finish_time - clear_start_time << " seconds";
-  CHECK(tqueue->get_size(1) == keep_count);
-  CHECK(tqueue->get_head(1).advance(keep_count).ok() == tail_id);
-  CHECK(tqueue->get_tail(1) == tail_id);
-  CHECK(deleted_events.size() == 100000 - keep_count);
 }